@@ -32,6 +32,8 @@ LOCAL_SRC_FILES := \
     src/cp/Connection.cpp \
     src/cp/CpCall.cpp \
     src/cp/CpCallManager.cpp \
+    src/cp/CpCallTable.cpp \
+    src/cp/CpCallWorkerPool.cpp \
     src/cp/CpGatewayManager.cpp \
     src/cp/CpGhostConnection.cpp \
     src/cp/CpIntMessage.cpp \
@@ -133,6 +135,7 @@ LOCAL_MODULE := sipxcallunit
 
 LOCAL_SRC_FILES := \
     src/test/cp/CallManagerTest.cpp \
+    src/test/cp/CpCallTableTest.cpp \
     src/test/cp/CpTestSupport.cpp \
 
 LOCAL_C_INCLUDES += \
@@ -20,6 +20,7 @@
 
 // APPLICATION INCLUDES
 #include <cp/CpCallManager.h>
+#include <cp/CpCallTable.h>
 #include <cp/Connection.h>
 #include <mi/CpMediaInterfaceFactoryImpl.h>
 #include <net/QoS.h>
@@ -51,6 +52,7 @@
 // FORWARD DECLARATIONS
 class SdpCodec;
 class CpCall;
+class CpCallWorkerPool;
 class SipUserAgent;
 class OsConfigDb;
 class PtMGCP;
@@ -286,6 +288,13 @@ public:
     virtual void setMaxCalls(int maxCalls);
     //:Set the maximum number of calls to admit to the system.
 
+    virtual void setCallWorkerPoolSize(int numWorkers);
+    //:Run calls on a pool of numWorkers threads instead of a task per call.
+    // Calls then only cost a message queue each, which lets a conference
+    // or IVR server run more calls than it could run threads.  May only
+    // be set once, before any call is created.  The default is a task
+    // per call.
+
     virtual void enableStun(const char* szStunServer, 
                             int iStunPort,
                             int iKeepAlivePeriodSecs,
@@ -422,6 +431,7 @@ public:
    int getTotalNumberIncomingCalls() { return mnTotalIncomingCalls;}
 
    virtual void onCallDestroy(CpCall* pCall);
+   virtual void onCallIdAdded(CpCall* pCall, const char* callId);
    virtual void yieldFocus(CpCall* call);
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
@@ -439,6 +449,7 @@ private:
     int mSipSessionReinviteTimer;
     CpCall* infocusCall;
     UtlSList callStack;
+    CpCallTable mCallTable; // Indexes infocusCall and callStack.
     UtlString mDialString;
     int mOutGoingCallType;
     PtMGCP* mpMgcpStackTask;
@@ -467,6 +478,7 @@ private:
     int mTurnKeepAlivePeriodSecs ;
 
     CpMediaInterfaceFactory* mpMediaFactory;
+    CpCallWorkerPool* mpCallWorkerPool; // NULL to start a task per call.
 
     // Private accessors
     void pushCall(CpCall* call);
@@ -477,6 +489,8 @@ private:
     CpCall* findHandlingCall(const char* callId);
     CpCall* findHandlingCall(int callIndex);
     CpCall* findHandlingCall(const OsMsg& eventMessage);
+    CpCall* findHandlingCallInStack(const char* callId);
+    CpCall* findHandlingCallInStack(const OsMsg& eventMessage);
     CpCall* findFirstQueuedCall();
     void getCodecs(int& numCodecs, SdpCodec**& codecArray);
     void addHistoryEvent(const char* messageLogString);
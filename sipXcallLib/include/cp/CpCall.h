@@ -48,9 +48,28 @@ struct DtmfEvent {
 
 // TYPEDEFS
 // FORWARD DECLARATIONS
+class CpCall;
 class CpCallManager;
+class CpCallWorkerPool;
 class CpMediaInterface;
 
+//:Dispatcher of media notifications to the message queue of a call
+// Lets the worker pool know about the notification if the call is run
+// by one.
+class CpCallMediaMsgDispatcher : public OsMsgDispatcher
+{
+public:
+    CpCallMediaMsgDispatcher(CpCall* pCall, OsMsgQ* msgQ);
+
+    virtual OsStatus post(const OsMsg& msg);
+
+private:
+    CpCall* mpCall;
+
+    CpCallMediaMsgDispatcher(const CpCallMediaMsgDispatcher& rDispatcher);
+    CpCallMediaMsgDispatcher& operator=(const CpCallMediaMsgDispatcher& rhs);
+};
+
 //:Class short description which may consist of multiple lines (note the ':')
 // Class detailed description which may extend to multiple lines
 class CpCall : public OsServerTask
@@ -125,6 +144,24 @@ public:
 
     /* ============================ MANIPULATORS ============================== */
 
+    void setWorkerPool(CpCallWorkerPool* pPool);
+    //: Runs this call on a pool of worker threads rather than on its own task
+    // Must be set before start() and is ignored after.  The pool is then
+    // kept until the call is deleted.  NULL (the default) starts a task.
+
+    virtual UtlBoolean start(void);
+    //: Starts the task of this call, or adds it to its worker pool
+
+    virtual OsStatus postMessage(const OsMsg& rMsg,
+                                 const OsTime& rTimeout=OsTime::OS_INFINITY,
+                                 UtlBoolean sentFromISR=FALSE);
+    //: Posts a message to this call and queues it on its worker pool
+
+    int handleQueuedMessages(int maxMessages);
+    //: Handles up to maxMessages messages which are in the queue already
+    // Used by the worker pool in place of the message loop of the task.
+    // Returns the number of messages taken from the queue.
+
     void setDropState(UtlBoolean state);
 
     void postMetaEvent(int state, int remoteIsCallee = -1);  // remoteIsCallee = -1 means not set
@@ -242,6 +279,12 @@ protected:
     void addHistoryEvent(const int msgSubType,
         const CpMultiStringMessage* multiStringMessage);
 
+    void leaveWorkerPool();
+    //: Waits until the worker pool is done with this call and removes it
+    // Must be called by the destructors before anything is torn down.
+
+    friend class CpCallMediaMsgDispatcher;
+
     CpCallManager* mpManager;
     UtlString mCallId;
     volatile UtlBoolean mCallInFocus;
@@ -256,7 +299,8 @@ protected:
     int mLocalTermConnectionState;
     UtlBoolean mLocalHeld;
 
-    OsMsgDispatcher mMediaMsgDispatcher;
+    CpCallMediaMsgDispatcher mMediaMsgDispatcher;
+    CpCallWorkerPool* mpWorkerPool; // Fixed once the call is started.
 
     UtlBoolean mDropping;
     int mMetaEventId;
@@ -788,6 +788,10 @@ public:
 /* ============================ INQUIRY =================================== */
 
     virtual void onCallDestroy(CpCall* pCall) = 0;
+
+    //: Tell the call manager that a call also answers to another Call-ID,
+    //: e.g. after a transfer or join.
+    virtual void onCallIdAdded(CpCall* pCall, const char* callId) = 0;
     
    virtual void yieldFocus(CpCall* call) = 0;
     
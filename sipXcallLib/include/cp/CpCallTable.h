@@ -0,0 +1,113 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CpCallTable_h_
+#define _CpCallTable_h_
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "os/OsMutex.h"
+#include "utl/UtlHashBag.h"
+#include "utl/UtlHashMap.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+class CpCall;
+
+/**
+*  @brief Hash indexes of the calls of a call manager by Call-ID and by
+*         call index.
+*
+*  A call answers to its own Call-ID and to the Call-ID of each of its
+*  connections, which can change when calls are transferred or joined.
+*  The call manager adds a call when it creates it, the call reports
+*  every Call-ID it picks up later with addCallId(), and the call is
+*  removed again before it is deleted.  When a Call-ID moves to another
+*  call, the call which reported it last is found.
+*
+*  The table never calls into the calls, so it can be updated from the
+*  call threads while the call manager holds its own locks.  Callers
+*  which need to be sure a call still has a Call-ID should ask the call.
+*/
+class CpCallTable
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor
+   CpCallTable();
+
+     /// Destructor
+   ~CpCallTable();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Start indexing a call.
+   void addCall(CpCall* call, int callIndex, const char* callId);
+
+     /// Add another Call-ID of a call which is in the table.
+   void addCallId(CpCall* call, const char* callId);
+     /**<
+     *  Ignored for calls which have not been added, or have been removed.
+     */
+
+     /// Stop indexing a call, before it is deleted.
+   void removeCall(CpCall* call);
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Find the call which reported a Call-ID last.
+   CpCall* findCall(const char* callId);
+
+     /// Find a call by its call index.
+   CpCall* findCall(int callIndex);
+
+     /// Return number of calls in the table.
+   int getCallCount();
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   OsMutex mLock;            ///< Guards all of the members.
+   UtlHashBag mCalls;        ///< CpCallTableEntry of each call.
+   UtlHashMap mCallsById;    ///< Call (UtlVoidPtr) of each Call-ID (UtlString).
+   UtlHashMap mCallsByIndex; ///< Call (UtlVoidPtr) of each call index (UtlInt).
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   CpCallTable(const CpCallTable& rCpCallTable);
+
+     /// Assignment operator (not implemented for this class)
+   CpCallTable& operator=(const CpCallTable& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _CpCallTable_h_
@@ -0,0 +1,153 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _CpCallWorkerPool_h_
+#define _CpCallWorkerPool_h_
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "os/OsCSem.h"
+#include "os/OsMutex.h"
+#include "os/OsTask.h"
+#include "os/OsTime.h"
+#include "utl/UtlHashBag.h"
+#include "utl/UtlSList.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+class CpCall;
+class CpCallWorker;
+
+/**
+*  @brief Runs the message loops of many calls on a few worker threads.
+*
+*  A call which is added to the pool does not start a task of its own.
+*  Its message queue stays the mailbox of the call, and posting a message
+*  to it queues the call on the pool.  A worker takes the next queued
+*  call, lets it handle up to MAX_MESSAGES_PER_TURN messages with
+*  CpCall::handleQueuedMessages() and queues it again at the back if it
+*  has more.  A call is queued at most once and run by at most one
+*  worker at a time, so its messages are handled one after another and
+*  in order, just like on its own task.
+*
+*  A message handler which blocks holds up its worker.  When calls are
+*  queued while every worker has been busy for BLOCKED_TURN_MS without
+*  finishing a turn, the pool starts another worker, up to
+*  MAX_EXTRA_WORKERS of them, so the other calls keep running.  Extra
+*  workers stay until the pool is destroyed.
+*/
+class CpCallWorkerPool
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      DEFAULT_NUM_WORKERS = 4,
+      MAX_MESSAGES_PER_TURN = 16, ///< Messages a call handles before the
+                                  ///< next queued call gets a turn.
+      BLOCKED_TURN_MS = 1000,     ///< Time without a finished turn after
+                                  ///< which busy workers count as blocked.
+      MAX_EXTRA_WORKERS = 4       ///< Workers started for blocked ones.
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor, starts the workers.
+   CpCallWorkerPool(int numWorkers = DEFAULT_NUM_WORKERS);
+
+     /// Destructor, stops the workers.
+   ~CpCallWorkerPool();
+     /**<
+     *  Calls must have been removed before, as a call keeps its pool for
+     *  its whole life.
+     */
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Start running a call, in place of CpCall::start().
+   void addCall(CpCall* call);
+
+     /// Stop running a call, before it is deleted.
+   void removeCall(CpCall* call);
+     /**<
+     *  Waits until a worker is done with the call's turn, so the call can
+     *  be deleted when this returns.  Must not be called from a message
+     *  handler of the call itself.
+     */
+
+     /// Queue a call which has been sent a message.
+   void scheduleCall(CpCall* call);
+     /**<
+     *  Does nothing for calls which are queued or running already, or
+     *  are not in the pool.  Starts an extra worker if the others are
+     *  blocked.
+     */
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return number of calls in the pool.
+   int getCallCount();
+
+     /// Return number of worker threads, including extra ones.
+   int getNumWorkers();
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+   friend class CpCallWorker;
+
+     /// Wait for the next queued call and give it a turn.
+   UtlBoolean runNextCall();
+     /**<
+     *  @returns FALSE when the pool is being destroyed.
+     */
+
+     /// Start another worker if all of them are blocked, with mLock held.
+   void startWorkerIfBlocked();
+
+   OsMutex mLock;          ///< Guards mCalls, mReadyCalls and the entries.
+   OsCSem mReady;          ///< Counts the entries in mReadyCalls.
+   UtlHashBag mCalls;      ///< Entry of each call in the pool.
+   UtlSList mReadyCalls;   ///< Entries of the queued calls, in order.
+   OsTask** mpWorkers;     ///< Room for the extra workers too.
+   int mNumWorkers;
+   int mMaxWorkers;
+   int mNumRunning;        ///< Workers in the middle of a turn.
+   OsTime mLastProgress;   ///< When a worker last started or ended a turn.
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   CpCallWorkerPool(const CpCallWorkerPool& rCpCallWorkerPool);
+
+     /// Assignment operator (not implemented for this class)
+   CpCallWorkerPool& operator=(const CpCallWorkerPool& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _CpCallWorkerPool_h_
@@ -43,6 +43,7 @@
 #include <os/OsWriteLock.h>
 #include <utl/UtlNameValueTokenizer.h>
 #include <cp/CpPeerCall.h>
+#include <cp/CpCallWorkerPool.h>
 #include "tao/TaoMessage.h"
 #include "tao/TaoProviderAdaptor.h"
 #include "tao/TaoString.h"
@@ -116,6 +117,7 @@ CallManager::CallManager(UtlBoolean isRequredUserIdMatch,
                 publicAddress, internalSamplerate)
 , mIsEarlyMediaFor180(TRUE)
 , mpMediaFactory(NULL)
+, mpCallWorkerPool(NULL)
 {
     OsStackTraceLogger(FAC_CP, PRI_DEBUG, "CallManager");
 
@@ -287,6 +289,9 @@ CallManager::~CallManager()
 
     waitUntilShutDown();   
 
+    // Only after the calls, which leave the pool when they are deleted
+    delete mpCallWorkerPool;
+
     // do not delete the codecFactory it is not owned here
 
 }
@@ -482,6 +487,13 @@ UtlBoolean CallManager::handleMessage(OsMsg& eventMessage)
                     // If we created a new call
                     if(handlingCall)
                     {
+                        // Index it before its task can pick up new Call-IDs
+                        UtlString newCallId;
+                        handlingCall->getCallId(newCallId);
+                        handlingCall->setWorkerPool(mpCallWorkerPool);
+                        mCallTable.addCall(handlingCall,
+                                           handlingCall->getCallIndex(),
+                                           newCallId.data());
                         handlingCall->start();
                         pushCall(handlingCall);
                         newCallCreated = TRUE;
@@ -535,6 +547,7 @@ UtlBoolean CallManager::handleMessage(OsMsg& eventMessage)
                 call->stopMetaEvent();
 
                 mCallListMutex.acquireWrite() ;                                                
+                mCallTable.removeCall(call);
                 releaseCallIndex(call->getCallIndex());
                 if(infocusCall == call)
                 {
@@ -3181,6 +3194,22 @@ void CallManager::setMaxCalls(int maxCalls)
     mMaxCalls = maxCalls;
 }
 
+void CallManager::setCallWorkerPoolSize(int numWorkers)
+{
+    // Calls keep the pool they were started on
+    if (numWorkers > 0 && mpCallWorkerPool == NULL)
+    {
+        mpCallWorkerPool = new CpCallWorkerPool(numWorkers);
+    }
+    else
+    {
+        OsSysLog::add(FAC_CP, PRI_WARNING,
+                      "CallManager::setCallWorkerPoolSize(%d) ignored, "
+                      "pool exists: %s", numWorkers,
+                      mpCallWorkerPool ? "yes" : "no");
+    }
+}
+
 // Enable STUN for NAT/Firewall traversal
 void CallManager::enableStun(const char* szStunServer, 
                              int iServerPort,
@@ -3440,6 +3469,19 @@ void CallManager::addHistoryEvent(const char* messageLogString)
 }
 
 CpCall* CallManager::findHandlingCall(const char* callId)
+{
+    CpCall* handlingCall = mCallTable.findCall(callId);
+
+    // The Call-ID may have moved on to a call which has not reported it
+    if(handlingCall && !handlingCall->hasCallId(callId))
+    {
+        handlingCall = findHandlingCallInStack(callId);
+    }
+
+    return(handlingCall);
+}
+
+CpCall* CallManager::findHandlingCallInStack(const char* callId)
 {
     CpCall* handlingCall = NULL;
 
@@ -3475,40 +3517,68 @@ CpCall* CallManager::findHandlingCall(const char* callId)
 
 CpCall* CallManager::findHandlingCall(int callIndex)
 {
-    CpCall* handlingCall = NULL;
+    return(mCallTable.findCall(callIndex));
+}
 
-    if(infocusCall)
+
+CpCall* CallManager::findHandlingCall(const OsMsg& eventMessage)
+{
+    if(eventMessage.getMsgType() != OsMsg::PHONE_APP ||
+       eventMessage.getMsgSubType() != CP_SIP_MESSAGE)
     {
-        if(infocusCall->getCallIndex() == callIndex)
-        {
-            handlingCall = infocusCall;
-        }
+        return(findHandlingCallInStack(eventMessage));
     }
 
-    if(!handlingCall)
+    // A call only takes a SIP message for one of its Call-IDs, or an
+    // INVITE replacing one of its dialogs, so only those calls are asked.
+    CpCall* handlingCall = NULL;
+    CpCall::handleWillingness handlingWeight = CpCall::CP_WILL_NOT_HANDLE;
+    const SipMessage* sipMsg = ((SipMessageEvent&)eventMessage).getMessage();
+    if(sipMsg)
     {
-        UtlSListIterator iterator(callStack);
-        UtlVoidPtr* callCollectable;
-        CpCall* call;
-        callCollectable = (UtlVoidPtr*)iterator();
-        while(callCollectable &&
-            !handlingCall)
+        UtlString callId;
+        sipMsg->getCallIdField(&callId);
+        CpCall* call = findHandlingCall(callId.data());
+        if(call)
         {
-            call = (CpCall*)callCollectable->getValue();
-            if(call && call->getCallIndex() == callIndex)
+            handlingWeight = call->willHandleMessage(eventMessage);
+            if(handlingWeight != CpCall::CP_WILL_NOT_HANDLE)
             {
                 handlingCall = call;
             }
-            callCollectable = (UtlVoidPtr*)iterator();
         }
 
+        UtlString method;
+        if(!sipMsg->isResponse())
+        {
+            sipMsg->getRequestMethod(&method);
+        }
+        if(handlingWeight != CpCall::CP_DEFINITELY_WILL_HANDLE &&
+           method.compareTo(SIP_INVITE_METHOD) == 0)
+        {
+            UtlString toTag;
+            UtlString fromTag;
+            if(sipMsg->getReplacesData(callId, toTag, fromTag))
+            {
+                call = findHandlingCall(callId.data());
+                if(call)
+                {
+                    CpCall::handleWillingness thisCallHandlingWeight =
+                        call->willHandleMessage(eventMessage);
+                    if(thisCallHandlingWeight > handlingWeight)
+                    {
+                        handlingWeight = thisCallHandlingWeight;
+                        handlingCall = call;
+                    }
+                }
+            }
+        }
     }
 
     return(handlingCall);
 }
 
-
-CpCall* CallManager::findHandlingCall(const OsMsg& eventMessage)
+CpCall* CallManager::findHandlingCallInStack(const OsMsg& eventMessage)
 {
     CpCall* handlingCall = NULL;
     CpCall::handleWillingness handlingWeight = CpCall::CP_WILL_NOT_HANDLE;
@@ -4033,6 +4103,8 @@ OsStatus CallManager::doCreateCall(const char* callId,
             // Short term kludge: createCall invoked, this
             // implys the phone is off hook
             call->enableDtmf();
+            call->setWorkerPool(mpCallWorkerPool);
+            mCallTable.addCall(call, call->getCallIndex(), callId);
             call->start();
 
             if(metaEventId > 0)
@@ -4234,6 +4306,7 @@ void CallManager::onCallDestroy(CpCall* call)
         call->stopMetaEvent();
 
         mCallListMutex.acquireWrite() ;                                                
+        mCallTable.removeCall(call);
         releaseCallIndex(call->getCallIndex());
         if(infocusCall == call)
         {
@@ -4250,6 +4323,12 @@ void CallManager::onCallDestroy(CpCall* call)
     }
 }
 
+void CallManager::onCallIdAdded(CpCall* call, const char* callId)
+{
+    // Called from the call tasks, so only the table's own lock is taken
+    mCallTable.addCallId(call, callId);
+}
+
 void CallManager::yieldFocus(CpCall* call)
 {
     OsWriteLock lock(mCallListMutex);
@@ -553,18 +553,25 @@ void Connection::getCallId(UtlString* callId)
 
 void Connection::setCallId(const char* callId)
 {
-    OsLock lock(callIdMutex);
+    {
+        OsLock lock(callIdMutex);
+
+        connectionCallId = callId;
 
-    connectionCallId = callId;
+        UtlString callCallId;
+        if(mpCall)
+        {
+            mpCall->getCallId(callCallId);
+        }
+        OsSysLog::add(FAC_CP, PRI_DEBUG,
+                "Connection::setCallId(%s) Call callId: %s for call thread: %s",
+                callId, callCallId.data(), mpCall ? mpCall->getName().data() : "null call");
+    }
 
-    UtlString callCallId;
-    if(mpCall)
+    if(mpCallManager && mpCall && callId && callId[0])
     {
-        mpCall->getCallId(callCallId);
+        mpCallManager->onCallIdAdded(mpCall, callId);
     }
-    OsSysLog::add(FAC_CP, PRI_DEBUG,
-            "Connection::setCallId(%s) Call callId: %s for call thread: %s",
-            callId, callCallId.data(), mpCall ? mpCall->getName().data() : "null call");
 }
 
 void Connection::getCallerId(UtlString* callerId)
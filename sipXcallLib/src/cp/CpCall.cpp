@@ -23,6 +23,7 @@
 #include <os/OsEventMsg.h>
 #include "os/OsSysLog.h"
 #include <cp/CpCall.h>
+#include <cp/CpCallWorkerPool.h>
 #include <mi/CpMediaInterface.h>
 #include <cp/CpMultiStringMessage.h>
 #include <cp/CpIntMessage.h>
@@ -53,6 +54,24 @@ OsLockingList *CpCall::spCallTrackingList = NULL;
 
 /* ============================ CREATORS ================================== */
 
+CpCallMediaMsgDispatcher::CpCallMediaMsgDispatcher(CpCall* pCall, OsMsgQ* msgQ)
+: OsMsgDispatcher(msgQ)
+, mpCall(pCall)
+{
+}
+
+OsStatus CpCallMediaMsgDispatcher::post(const OsMsg& msg)
+{
+    OsStatus res = OsMsgDispatcher::post(msg);
+    // The pool of a call does not change once it has started, so it is
+    // read here without a lock
+    if (res == OS_SUCCESS && mpCall->mpWorkerPool)
+    {
+        mpCall->mpWorkerPool->scheduleCall(mpCall);
+    }
+    return res;
+}
+
 // Constructor
 CpCall::CpCall(CpCallManager* manager,
                CpMediaInterface* callMediaInterface,
@@ -61,7 +80,7 @@ CpCall::CpCall(CpCallManager* manager,
                int holdType)
 : OsServerTask("Call-%d", NULL, DEF_MAX_MSGS, DEF_PRIO, DEF_OPTIONS, CALL_STACK_SIZE)
 , mCallIdMutex(OsMutex::Q_FIFO)
-, mMediaMsgDispatcher(&mIncomingQ)
+, mMediaMsgDispatcher(this, &mIncomingQ)
 {
     // add the call task name to a list so we can track leaked calls.
     UtlString strCallTaskName = getName();
@@ -77,6 +96,7 @@ CpCall::CpCall(CpCallManager* manager,
     mDtmfEnabled = FALSE;
 
     mpManager = manager;
+    mpWorkerPool = NULL;
 
     mDropping = FALSE;
     mLocalHeld = FALSE;
@@ -122,6 +142,7 @@ CpCall::CpCall(CpCallManager* manager,
 // Destructor
 CpCall::~CpCall()
 {
+    leaveWorkerPool();
     if (isStarted())
     {
         waitUntilShutDown();
@@ -161,6 +182,66 @@ CpCall::~CpCall()
 
 /* ============================ MANIPULATORS ============================== */
 
+void CpCall::setWorkerPool(CpCallWorkerPool* pPool)
+{
+    // Other threads post messages without a lock once the call is started
+    if (mpWorkerPool || isStarted())
+    {
+        OsSysLog::add(FAC_CP, PRI_ERR,
+                      "CpCall::setWorkerPool ignored, call already started");
+        return;
+    }
+    mpWorkerPool = pPool;
+}
+
+UtlBoolean CpCall::start()
+{
+    if (mpWorkerPool)
+    {
+        mpWorkerPool->addCall(this);
+        return TRUE;
+    }
+    return OsServerTask::start();
+}
+
+OsStatus CpCall::postMessage(const OsMsg& rMsg, const OsTime& rTimeout,
+                             UtlBoolean sentFromISR)
+{
+    OsStatus res = OsServerTask::postMessage(rMsg, rTimeout, sentFromISR);
+    if (res == OS_SUCCESS && mpWorkerPool)
+    {
+        mpWorkerPool->scheduleCall(this);
+    }
+    return res;
+}
+
+// Does for the worker pool what OsServerTask::run() does for the task
+int CpCall::handleQueuedMessages(int maxMessages)
+{
+    int numMessages = 0;
+    OsMsg* pMsg = NULL;
+
+    while (numMessages < maxMessages &&
+           receiveMessage(pMsg, OsTime::NO_WAIT_TIME) == OS_SUCCESS)
+    {
+        // Messages left after a shutdown request are dropped
+        if (!isShuttingDown() && !isShutDown())
+        {
+            if (!handleMessage(*pMsg))
+            {
+                OsServerTask::handleMessage(*pMsg);
+            }
+        }
+        if (!pMsg->getSentFromISR())
+        {
+            pMsg->releaseMsg();
+        }
+        numMessages++;
+    }
+
+    return numMessages;
+}
+
 void CpCall::setDropState(UtlBoolean state)
 {
     mDropping = state;
@@ -643,9 +724,18 @@ void CpCall::getCallId(UtlString& callId)
 
 void CpCall::setCallId(const char* callId)
 {
-    OsWriteLock lock(mCallIdMutex);
-    mCallId.remove(0);
-    if(callId) mCallId.append(callId);
+    {
+        OsWriteLock lock(mCallIdMutex);
+        mCallId.remove(0);
+        if(callId) mCallId.append(callId);
+    }
+
+    // Not under mCallIdMutex, the call manager holds its own locks
+    // while it asks calls for their Call-IDs.
+    if(mpManager && callId && callId[0])
+    {
+        mpManager->onCallIdAdded(this, callId);
+    }
 }
 
 void CpCall::enableDtmf()
@@ -998,6 +1088,14 @@ UtlBoolean CpCall::isLocalHeld()
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
+void CpCall::leaveWorkerPool()
+{
+    if (mpWorkerPool)
+    {
+        mpWorkerPool->removeCall(this);
+    }
+}
+
 void CpCall::addHistoryEvent(const char* messageLogString)
 {
     mMessageEventCount++;
@@ -0,0 +1,183 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "cp/CpCallTable.h"
+#include "os/OsLock.h"
+#include "utl/UtlInt.h"
+#include "utl/UtlSList.h"
+#include "utl/UtlSListIterator.h"
+#include "utl/UtlString.h"
+#include "utl/UtlVoidPtr.h"
+
+// DEFINES
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/**
+*  Keys a call has in the table.  The value is the call.
+*/
+class CpCallTableEntry : public UtlVoidPtr
+{
+public:
+   CpCallTableEntry(CpCall* call, int callIndex)
+      : UtlVoidPtr(call)
+      , mCallIndex(callIndex)
+   {
+   }
+
+   virtual ~CpCallTableEntry()
+   {
+      mCallIds.destroyAll();
+   }
+
+   int mCallIndex;
+   UtlSList mCallIds;   ///< Every Call-ID (UtlString) reported for the call.
+};
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+CpCallTable::CpCallTable()
+: mLock(OsMutex::Q_FIFO)
+{
+}
+
+CpCallTable::~CpCallTable()
+{
+   mCallsById.destroyAll();
+   mCallsByIndex.destroyAll();
+   mCalls.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void CpCallTable::addCall(CpCall* call, int callIndex, const char* callId)
+{
+   OsLock lock(mLock);
+
+   UtlVoidPtr key(call);
+   if (mCalls.find(&key) == NULL)
+   {
+      mCalls.insert(new CpCallTableEntry(call, callIndex));
+
+      UtlInt index(callIndex);
+      mCallsByIndex.destroy(&index);
+      mCallsByIndex.insertKeyAndValue(new UtlInt(callIndex),
+                                      new UtlVoidPtr(call));
+   }
+
+   if (callId && callId[0])
+   {
+      addCallId(call, callId);
+   }
+}
+
+void CpCallTable::addCallId(CpCall* call, const char* callId)
+{
+   OsLock lock(mLock);
+
+   UtlVoidPtr key(call);
+   CpCallTableEntry* entry = (CpCallTableEntry*) mCalls.find(&key);
+   if (entry == NULL || callId == NULL || callId[0] == '\0')
+   {
+      return;
+   }
+
+   UtlString id(callId);
+   UtlVoidPtr* holder = (UtlVoidPtr*) mCallsById.findValue(&id);
+   if (holder)
+   {
+      // The Call-ID moves to the call which reported it last
+      holder->setValue(call);
+   }
+   else
+   {
+      mCallsById.insertKeyAndValue(new UtlString(id), new UtlVoidPtr(call));
+   }
+
+   if (entry->mCallIds.find(&id) == NULL)
+   {
+      entry->mCallIds.append(new UtlString(id));
+   }
+}
+
+void CpCallTable::removeCall(CpCall* call)
+{
+   OsLock lock(mLock);
+
+   UtlVoidPtr key(call);
+   CpCallTableEntry* entry = (CpCallTableEntry*) mCalls.remove(&key);
+   if (entry == NULL)
+   {
+      return;
+   }
+
+   // Only drop the keys which still lead to this call
+   {
+      UtlSListIterator iterator(entry->mCallIds);
+      UtlString* callId;
+      while ((callId = (UtlString*) iterator()))
+      {
+         UtlVoidPtr* holder = (UtlVoidPtr*) mCallsById.findValue(callId);
+         if (holder && holder->getValue() == call)
+         {
+            mCallsById.destroy(callId);
+         }
+      }
+   }
+
+   UtlInt index(entry->mCallIndex);
+   UtlVoidPtr* holder = (UtlVoidPtr*) mCallsByIndex.findValue(&index);
+   if (holder && holder->getValue() == call)
+   {
+      mCallsByIndex.destroy(&index);
+   }
+
+   delete entry;
+}
+
+/* ============================ ACCESSORS ================================= */
+
+CpCall* CpCallTable::findCall(const char* callId)
+{
+   if (callId == NULL)
+   {
+      return NULL;
+   }
+
+   OsLock lock(mLock);
+
+   UtlString id(callId);
+   UtlVoidPtr* holder = (UtlVoidPtr*) mCallsById.findValue(&id);
+   return holder ? (CpCall*) holder->getValue() : NULL;
+}
+
+CpCall* CpCallTable::findCall(int callIndex)
+{
+   OsLock lock(mLock);
+
+   UtlInt index(callIndex);
+   UtlVoidPtr* holder = (UtlVoidPtr*) mCallsByIndex.findValue(&index);
+   return holder ? (CpCall*) holder->getValue() : NULL;
+}
+
+int CpCallTable::getCallCount()
+{
+   OsLock lock(mLock);
+   return mCalls.entries();
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
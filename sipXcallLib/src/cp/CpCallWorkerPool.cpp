@@ -0,0 +1,312 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "cp/CpCallWorkerPool.h"
+#include "cp/CpCall.h"
+#include "os/OsBSem.h"
+#include "os/OsDateTime.h"
+#include "os/OsLock.h"
+#include "os/OsSysLog.h"
+#include "utl/UtlSListIterator.h"
+#include "utl/UtlVoidPtr.h"
+
+// DEFINES
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+#define MAX_READY_COUNT 0x7fffffff
+// STATIC VARIABLE INITIALIZATIONS
+
+/**
+*  State of a call in the pool.  The value is the call, or NULL once the
+*  call has been removed while it was queued or running.
+*/
+class CpCallWorkerEntry : public UtlVoidPtr
+{
+public:
+   enum State
+   {
+      IDLE,      ///< Not queued, no messages to handle.
+      QUEUED,    ///< Waiting in mReadyCalls.
+      RUNNING    ///< A worker is handling its messages.
+   };
+
+   CpCallWorkerEntry(CpCall* call)
+      : UtlVoidPtr(call)
+      , mState(IDLE)
+      , mDone(OsBSem::Q_FIFO, OsBSem::EMPTY)
+   {
+   }
+
+   State mState;
+   OsBSem mDone;   ///< Given by the worker to a removeCall() waiting for it.
+};
+
+/**
+*  Worker thread of a CpCallWorkerPool.
+*/
+class CpCallWorker : public OsTask
+{
+public:
+   CpCallWorker(CpCallWorkerPool* pPool)
+      : OsTask("CallWorker-%d")
+      , mpPool(pPool)
+   {
+   }
+
+   virtual ~CpCallWorker()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void*)
+   {
+      while (mpPool->runNextCall())
+      {
+      }
+      return 0;
+   }
+
+private:
+   CpCallWorkerPool* mpPool;
+};
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+CpCallWorkerPool::CpCallWorkerPool(int numWorkers)
+: mLock(OsMutex::Q_FIFO)
+, mReady(OsCSem::Q_FIFO, MAX_READY_COUNT, 0)
+, mpWorkers(NULL)
+, mNumWorkers(numWorkers > 0 ? numWorkers : DEFAULT_NUM_WORKERS)
+, mMaxWorkers(mNumWorkers + MAX_EXTRA_WORKERS)
+, mNumRunning(0)
+{
+   OsDateTime::getCurTime(mLastProgress);
+   mpWorkers = new OsTask*[mMaxWorkers];
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      mpWorkers[i] = new CpCallWorker(this);
+      mpWorkers[i]->start();
+   }
+}
+
+CpCallWorkerPool::~CpCallWorkerPool()
+{
+   // A worker stops when it wakes up and finds no queued call
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      mReady.release();
+   }
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      delete mpWorkers[i];
+   }
+   delete[] mpWorkers;
+
+   // Entries of removed calls belong to the queue
+   UtlSListIterator readyIterator(mReadyCalls);
+   CpCallWorkerEntry* entry;
+   while ((entry = (CpCallWorkerEntry*) readyIterator()))
+   {
+      if (entry->getValue() == NULL)
+      {
+         delete entry;
+      }
+   }
+   mReadyCalls.removeAll();
+
+   if (!mCalls.isEmpty())
+   {
+      OsSysLog::add(FAC_CP, PRI_ERR,
+                    "CpCallWorkerPool::~CpCallWorkerPool %d calls not removed",
+                    (int) mCalls.entries());
+   }
+   mCalls.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void CpCallWorkerPool::addCall(CpCall* call)
+{
+   OsLock lock(mLock);
+
+   UtlVoidPtr key(call);
+   if (mCalls.find(&key) == NULL)
+   {
+      CpCallWorkerEntry* entry = new CpCallWorkerEntry(call);
+      mCalls.insert(entry);
+
+      // Messages may have been posted before the call was started
+      if (!call->getMessageQueue()->isEmpty())
+      {
+         entry->mState = CpCallWorkerEntry::QUEUED;
+         mReadyCalls.append(entry);
+         mReady.release();
+      }
+   }
+}
+
+void CpCallWorkerPool::removeCall(CpCall* call)
+{
+   mLock.acquire();
+
+   UtlVoidPtr key(call);
+   CpCallWorkerEntry* entry = (CpCallWorkerEntry*) mCalls.remove(&key);
+   if (entry == NULL)
+   {
+      mLock.release();
+      return;
+   }
+
+   entry->setValue(NULL);
+   CpCallWorkerEntry::State state = entry->mState;
+
+   mLock.release();
+
+   switch (state)
+   {
+   case CpCallWorkerEntry::IDLE:
+      delete entry;
+      break;
+
+   case CpCallWorkerEntry::RUNNING:
+      entry->mDone.acquire();
+      delete entry;
+      break;
+
+   case CpCallWorkerEntry::QUEUED:
+      // The worker which takes it off the queue deletes it
+      break;
+   }
+}
+
+void CpCallWorkerPool::scheduleCall(CpCall* call)
+{
+   OsLock lock(mLock);
+
+   UtlVoidPtr key(call);
+   CpCallWorkerEntry* entry = (CpCallWorkerEntry*) mCalls.find(&key);
+
+   // A running call is queued again by its worker if it has more messages
+   if (entry && entry->mState == CpCallWorkerEntry::IDLE)
+   {
+      entry->mState = CpCallWorkerEntry::QUEUED;
+      mReadyCalls.append(entry);
+      mReady.release();
+   }
+
+   if (entry && !mReadyCalls.isEmpty())
+   {
+      startWorkerIfBlocked();
+   }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int CpCallWorkerPool::getCallCount()
+{
+   OsLock lock(mLock);
+   return mCalls.entries();
+}
+
+int CpCallWorkerPool::getNumWorkers()
+{
+   OsLock lock(mLock);
+   return mNumWorkers;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+UtlBoolean CpCallWorkerPool::runNextCall()
+{
+   mReady.acquire();
+
+   mLock.acquire();
+   CpCallWorkerEntry* entry = (CpCallWorkerEntry*) mReadyCalls.get();
+   if (entry == NULL)
+   {
+      mLock.release();
+      return FALSE;
+   }
+
+   CpCall* call = (CpCall*) entry->getValue();
+   if (call == NULL)
+   {
+      mLock.release();
+      delete entry;
+      return TRUE;
+   }
+   entry->mState = CpCallWorkerEntry::RUNNING;
+   mNumRunning++;
+   OsDateTime::getCurTime(mLastProgress);
+   mLock.release();
+
+   call->handleQueuedMessages(MAX_MESSAGES_PER_TURN);
+
+   mLock.acquire();
+   mNumRunning--;
+   OsDateTime::getCurTime(mLastProgress);
+   UtlBoolean removed = entry->getValue() == NULL;
+   if (!removed)
+   {
+      // Messages posted during the turn did not queue the call
+      if (!call->getMessageQueue()->isEmpty())
+      {
+         entry->mState = CpCallWorkerEntry::QUEUED;
+         mReadyCalls.append(entry);
+         mReady.release();
+      }
+      else
+      {
+         entry->mState = CpCallWorkerEntry::IDLE;
+      }
+   }
+   mLock.release();
+
+   if (removed)
+   {
+      // removeCall() deletes the entry
+      entry->mDone.release();
+   }
+
+   return TRUE;
+}
+
+void CpCallWorkerPool::startWorkerIfBlocked()
+{
+   if (mNumRunning < mNumWorkers || mNumWorkers >= mMaxWorkers)
+   {
+      return;
+   }
+
+   OsTime now;
+   OsDateTime::getCurTime(now);
+   if ((now - mLastProgress).cvtToMsecs() < BLOCKED_TURN_MS)
+   {
+      return;
+   }
+
+   OsSysLog::add(FAC_CP, PRI_WARNING,
+                 "CpCallWorkerPool::startWorkerIfBlocked "
+                 "all %d workers blocked, starting another one",
+                 mNumWorkers);
+   mpWorkers[mNumWorkers] = new CpCallWorker(this);
+   mpWorkers[mNumWorkers]->start();
+   mNumWorkers++;
+
+   // The new worker counts as progress, so the next one is started only
+   // if it is blocked as well.
+   mLastProgress = now;
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
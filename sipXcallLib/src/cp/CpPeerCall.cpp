@@ -203,6 +203,7 @@ CpPeerCall::~CpPeerCall()
    {
       mpManager->onCallDestroy(this);
    }
+   leaveWorkerPool();
    waitUntilShutDown(20000) ;
 #ifdef TEST_PRINT
     if (!mCallId.isNull())
@@ -4896,8 +4897,21 @@ void CpPeerCall::addConnection(Connection* connection)
 {
     connection->setLocalAddress(mLocalAddress.data());
     
-	OsWriteLock lock(mConnectionMutex);
-    mConnections.append(connection);
+    {
+        OsWriteLock lock(mConnectionMutex);
+        mConnections.append(connection);
+    }
+
+    // A joined connection brings its Call-ID along
+    if(mpManager)
+    {
+        UtlString callId;
+        connection->getCallId(&callId);
+        if(!callId.isNull())
+        {
+            mpManager->onCallIdAdded(this, callId.data());
+        }
+    }
 }
 
 // Assumed lock is head externally
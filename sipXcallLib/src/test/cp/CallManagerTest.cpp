@@ -12,12 +12,16 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include <sipxunittests.h>
 
+#include <os/OsDateTime.h>
 #include <cp/CallManager.h>
+#include <cp/CpCall.h>
+#include <cp/CpCallWorkerPool.h>
 #include <ps/PsMsg.h>
 #include <ps/PsHookswTask.h>
 #include <net/SipUserAgent.h>
 #include <cp/CpTestSupport.h>
 #include <net/SipMessage.h>
+#include <net/SipDialog.h>
 #include <net/SipLineMgr.h>
 #include <net/SipRefreshMgr.h>
 #include <mi/CpMediaInterfaceFactoryFactory.h>
@@ -36,6 +40,12 @@ _CrtMemState MemStateDiff;
 #define SAMPLE_RATE    8000
 
 #define NUM_OF_RUNS 10
+#define NUM_RATE_CALLS 200
+#define RATE_PORT 5190
+#define LOOKUP_PORT_A 5290
+#define LOOKUP_PORT_B 5390
+#define LOOKUP_PORT_C 5490
+#define LOOKUP_MAX_CALLS 8
 /**
  * Unittest for CallManager
  */
@@ -52,6 +62,8 @@ class CallManangerTest : public SIPX_UNIT_BASE_CLASS
   //CPPUNIT_TEST(testLineMgrUATeardown);
   //CPPUNIT_TEST(testRefreshMgrUATeardown);
     CPPUNIT_TEST(testGetNewCallId);
+    CPPUNIT_TEST(testCallSetupTeardownRate);
+    CPPUNIT_TEST(testCallLookup);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -532,6 +544,401 @@ public:
        testGetNewCallId_validate(callId3, "prefix3", &counter, &suffix);
     }
 
+
+    /* Creates and drops NUM_RATE_CALLS calls, which run on their own tasks
+     * if numWorkers is 0 or on a worker pool otherwise, and returns the
+     * number of calls per second.
+     */
+    int testCallSetupTeardownRate_run(int numWorkers)
+    {
+       // Calls get their Via from the user agent, without local audio
+       // they run on machines without sound devices
+       SipUserAgent* pUa = new SipUserAgent(RATE_PORT, RATE_PORT, RATE_PORT+1,
+                                            NULL, NULL, "127.0.0.1");
+       pUa->start();
+       CallManager *pCallManager = CpTestSupport::newCallManager(pUa, FALSE);
+       pCallManager->setMaxCalls(NUM_RATE_CALLS);
+       if (numWorkers > 0)
+       {
+          pCallManager->setCallWorkerPoolSize(numWorkers);
+       }
+       pCallManager->start();
+
+       OsTime start;
+       OsDateTime::getCurTime(start);
+
+       int i;
+       for (i = 0; i < NUM_RATE_CALLS; i++)
+       {
+          UtlString callId;
+          pCallManager->createCall(&callId, 0, PtEvent::META_EVENT_NONE,
+                                   0, NULL, FALSE);
+          pCallManager->drop(callId);
+       }
+
+       // Answered by the call manager after it has created all of the calls
+       UtlString callIds[1];
+       int numCalls = 0;
+       for (i = 0; i < 30000; i++)
+       {
+          pCallManager->getCalls(1, numCalls, callIds);
+          if (numCalls == 0)
+          {
+             break;
+          }
+          OsTask::delay(1);
+       }
+
+       OsTime end;
+       OsDateTime::getCurTime(end);
+
+       CPPUNIT_ASSERT_EQUAL(0, numCalls);
+
+       pUa->shutdown(TRUE);
+       pCallManager->requestShutdown();
+       delete pCallManager;
+       delete pUa;
+       sipxDestroyMediaFactoryFactory();
+
+       // Every call object is gone
+       CPPUNIT_ASSERT_EQUAL(0, CpCall::getCallTrackingListCount());
+
+       OsTime elapsed = end - start;
+       long usecs = elapsed.seconds() * 1000000 + elapsed.usecs();
+       return (int) (NUM_RATE_CALLS * 1000000.0 / (usecs > 0 ? usecs : 1));
+    }
+
+    /* Compares how fast calls are set up and torn down with a task per call
+     * and on a worker pool.
+     */
+    void testCallSetupTeardownRate()
+    {
+       int taskRate = testCallSetupTeardownRate_run(0);
+       int poolRate =
+          testCallSetupTeardownRate_run(CpCallWorkerPool::DEFAULT_NUM_WORKERS);
+
+       printf("%d calls set up and torn down: %d calls/sec with a task per call, "
+              "%d calls/sec with %d workers\n",
+              NUM_RATE_CALLS, taskRate, poolRate,
+              CpCallWorkerPool::DEFAULT_NUM_WORKERS);
+    }
+
+    /* Creates a user agent and a call manager without local audio, which
+     * listen on 127.0.0.1 at the given port.
+     */
+    CallManager* testCallLookup_newCallManager(int port, SipUserAgent*& pUa)
+    {
+       pUa = new SipUserAgent(port, port, port+1,
+                              NULL, NULL, "127.0.0.1");
+       pUa->start();
+       CallManager* pCallManager = CpTestSupport::newCallManager(pUa, FALSE);
+       pCallManager->start();
+       return pCallManager;
+    }
+
+    /* Waits until a call manager has numCalls calls, and returns the
+     * number of calls it has then.
+     */
+    int testCallLookup_waitForCalls(CallManager* pCallManager, int numCalls,
+                                    UtlString callIds[])
+    {
+       int currentCalls = -1;
+       for (int i = 0; i < 500 && currentCalls != numCalls; i++)
+       {
+          if (i > 0)
+          {
+             OsTask::delay(20);
+          }
+          pCallManager->getCalls(LOOKUP_MAX_CALLS, currentCalls, callIds);
+       }
+       return currentCalls;
+    }
+
+    /* Returns the addresses of the connections of a call, the local one
+     * first, separated by spaces.
+     */
+    UtlString testCallLookup_getConnections(CallManager* pCallManager,
+                                            const char* callId)
+    {
+       UtlString addresses[LOOKUP_MAX_CALLS];
+       int numConnections = 0;
+       pCallManager->getConnections(callId, LOOKUP_MAX_CALLS, numConnections,
+                                    addresses);
+       UtlString connections;
+       for (int i = 0; i < numConnections; i++)
+       {
+          connections.append(addresses[i]);
+          connections.append(" ");
+       }
+       return connections;
+    }
+
+    /* Returns the address of the only remote connection of a call. */
+    UtlString testCallLookup_getAddress(CallManager* pCallManager,
+                                        const char* callId)
+    {
+       UtlString addresses[LOOKUP_MAX_CALLS];
+       int numConnections = 0;
+       pCallManager->getConnections(callId, LOOKUP_MAX_CALLS, numConnections,
+                                    addresses);
+       CPPUNIT_ASSERT_EQUAL(2, numConnections);
+       return addresses[1];
+    }
+
+    /* Waits until the dialog of a call with one remote connection has both
+     * its local and its remote tag.  The address of the connection gets
+     * the remote tag when the remote side answers.
+     */
+    void testCallLookup_waitForTags(CallManager* pCallManager,
+                                    const char* callId)
+    {
+       UtlString localTag;
+       UtlString remoteTag;
+       for (int i = 0;
+            i < 500 && (localTag.isNull() || remoteTag.isNull());
+            i++)
+       {
+          if (i > 0)
+          {
+             OsTask::delay(20);
+          }
+          UtlString addresses[LOOKUP_MAX_CALLS];
+          int numConnections = 0;
+          pCallManager->getConnections(callId, LOOKUP_MAX_CALLS,
+                                       numConnections, addresses);
+          SipDialog dialog;
+          if (numConnections == 2 &&
+              pCallManager->getSipDialog(callId, addresses[1],
+                                         dialog) == OS_SUCCESS)
+          {
+             Url field;
+             dialog.getLocalField(field);
+             field.getFieldParameter("tag", localTag);
+             dialog.getRemoteField(field);
+             field.getFieldParameter("tag", remoteTag);
+          }
+       }
+       CPPUNIT_ASSERT(!localTag.isNull());
+       CPPUNIT_ASSERT(!remoteTag.isNull());
+    }
+
+    /* Returns the SIP Call-ID of the dialog of a call with an address. */
+    UtlString testCallLookup_getDialogCallId(CallManager* pCallManager,
+                                             const char* callId,
+                                             const char* address)
+    {
+       SipDialog dialog;
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                            pCallManager->getSipDialog(callId, address, dialog));
+       UtlString dialogCallId;
+       dialog.getCallId(dialogCallId);
+       CPPUNIT_ASSERT(!dialogCallId.isNull());
+       return dialogCallId;
+    }
+
+    /* Waits for a new call on a call manager, which has numKnown calls
+     * in knownIds, answers it and returns its call ID.  The new call is
+     * added to knownIds.
+     */
+    UtlString testCallLookup_answer(CallManager* pCallManager,
+                                    UtlString knownIds[], int numKnown)
+    {
+       UtlString callIds[LOOKUP_MAX_CALLS];
+       CPPUNIT_ASSERT_EQUAL(numKnown + 1,
+                            testCallLookup_waitForCalls(pCallManager,
+                                                        numKnown + 1, callIds));
+       UtlString callId;
+       for (int i = 0; i <= numKnown && callId.isNull(); i++)
+       {
+          int j;
+          for (j = 0; j < numKnown && callIds[i] != knownIds[j]; j++)
+             ;
+          if (j == numKnown)
+          {
+             callId = callIds[i];
+          }
+       }
+       CPPUNIT_ASSERT(!callId.isNull());
+       knownIds[numKnown] = callId;
+
+       UtlString address = testCallLookup_getAddress(pCallManager, callId);
+       pCallManager->acceptConnection(callId, address);
+       pCallManager->answerTerminalConnection(callId, address, "unused");
+       return callId;
+    }
+
+    /* Returns the URL of the call manager at a port. */
+    UtlString testCallLookup_getUrl(int port)
+    {
+       char url[64];
+       sprintf(url, "sip:user@127.0.0.1:%d", port);
+       return url;
+    }
+
+    /* Drops every call of a call manager and waits until they are gone. */
+    void testCallLookup_dropAll(CallManager* pCallManager)
+    {
+       UtlString callIds[LOOKUP_MAX_CALLS];
+       int numCalls = 0;
+       pCallManager->getCalls(LOOKUP_MAX_CALLS, numCalls, callIds);
+       for (int i = 0; i < numCalls; i++)
+       {
+          pCallManager->drop(callIds[i]);
+       }
+       CPPUNIT_ASSERT_EQUAL(0, testCallLookup_waitForCalls(pCallManager, 0,
+                                                           callIds));
+    }
+
+    /* Sets up calls between three call managers, transfers and joins them,
+     * and checks that calls are found by their own call IDs and by the SIP
+     * Call-IDs of their dialogs, and that every call is gone after they are
+     * dropped.
+     */
+    void testCallLookup()
+    {
+       SipUserAgent* pUaA;
+       SipUserAgent* pUaB;
+       SipUserAgent* pUaC;
+       CallManager* pA = testCallLookup_newCallManager(LOOKUP_PORT_A, pUaA);
+       CallManager* pB = testCallLookup_newCallManager(LOOKUP_PORT_B, pUaB);
+       CallManager* pC = testCallLookup_newCallManager(LOOKUP_PORT_C, pUaC);
+       UtlString callIds[LOOKUP_MAX_CALLS];
+       UtlString callIdsB[LOOKUP_MAX_CALLS];
+       UtlString callIdsC[LOOKUP_MAX_CALLS];
+       int numConnections;
+
+       // Create: a1 calls b1, a2 calls b2
+       UtlString a1;
+       pA->createCall(&a1);
+       CPPUNIT_ASSERT_EQUAL(PT_SUCCESS,
+                            pA->connect(a1, testCallLookup_getUrl(LOOKUP_PORT_B)));
+       UtlString b1 = testCallLookup_answer(pB, callIdsB, 0);
+
+       UtlString a2;
+       pA->createCall(&a2);
+       CPPUNIT_ASSERT_EQUAL(PT_SUCCESS,
+                            pA->connect(a2, testCallLookup_getUrl(LOOKUP_PORT_B)));
+       UtlString b2 = testCallLookup_answer(pB, callIdsB, 1);
+
+       CPPUNIT_ASSERT_EQUAL(2, testCallLookup_waitForCalls(pA, 2, callIds));
+       CPPUNIT_ASSERT_EQUAL(2, testCallLookup_waitForCalls(pB, 2, callIds));
+       testCallLookup_waitForTags(pA, a1);
+       testCallLookup_waitForTags(pA, a2);
+       testCallLookup_waitForTags(pB, b1);
+       testCallLookup_waitForTags(pB, b2);
+
+       // Calls are found by their call IDs and by the SIP Call-IDs of their
+       // dialogs, which differ on both sides.
+       UtlString addressA2 = testCallLookup_getAddress(pB, b2);
+       UtlString dialog1 =
+          testCallLookup_getDialogCallId(pA, a1,
+                                         testCallLookup_getAddress(pA, a1));
+       UtlString dialog2 =
+          testCallLookup_getDialogCallId(pA, a2,
+                                         testCallLookup_getAddress(pA, a2));
+       CPPUNIT_ASSERT(dialog1 != dialog2);
+       CPPUNIT_ASSERT(dialog1 != a1 && dialog1 != b1);
+       CPPUNIT_ASSERT(dialog2 != a2 && dialog2 != b2);
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pA, a1),
+                            testCallLookup_getConnections(pA, dialog1));
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pB, b1),
+                            testCallLookup_getConnections(pB, dialog1));
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pB, b2),
+                            testCallLookup_getConnections(pB, dialog2));
+       CPPUNIT_ASSERT(testCallLookup_getConnections(pB, b1) !=
+                      testCallLookup_getConnections(pB, b2));
+
+       // Calls of one call manager are not found by the other
+       pB->getNumConnections(a1, numConnections);
+       CPPUNIT_ASSERT_EQUAL(0, numConnections);
+       pA->getNumConnections(b1, numConnections);
+       CPPUNIT_ASSERT_EQUAL(0, numConnections);
+
+       // Transfer: A transfers B from dialog 1 to C, so B creates b3 which
+       // calls c1.
+       UtlString transferCallId;
+       CPPUNIT_ASSERT_EQUAL(PT_SUCCESS,
+                            pA->transfer_blind(a1,
+                                               testCallLookup_getUrl(LOOKUP_PORT_C),
+                                               &transferCallId));
+       UtlString c1 = testCallLookup_answer(pC, callIdsC, 0);
+       testCallLookup_waitForTags(pC, c1);
+       UtlString dialog3 =
+          testCallLookup_getDialogCallId(pC, c1,
+                                         testCallLookup_getAddress(pC, c1));
+       CPPUNIT_ASSERT_EQUAL(3, testCallLookup_waitForCalls(pB, 3, callIdsB));
+       UtlString b3;
+       for (int i = 0; i < 3; i++)
+       {
+          if (callIdsB[i] != b1 && callIdsB[i] != b2)
+          {
+             b3 = callIdsB[i];
+          }
+       }
+       CPPUNIT_ASSERT(!b3.isNull());
+       testCallLookup_waitForTags(pB, b3);
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pB, b3),
+                            testCallLookup_getConnections(pB, dialog3));
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pC, c1),
+                            testCallLookup_getConnections(pC, dialog3));
+
+       // Join: move the connection of b2 to b3 once it is held
+       pB->holdTerminalConnection(b2, addressA2, NULL);
+       PtStatus splitStatus = PT_FAILED;
+       for (int i = 0; i < 50 && splitStatus != PT_SUCCESS; i++)
+       {
+          OsTask::delay(100);
+          splitStatus = pB->split(b2, addressA2, b3);
+       }
+       CPPUNIT_ASSERT_EQUAL(PT_SUCCESS, splitStatus);
+       for (int i = 0; i < 500; i++)
+       {
+          pB->getNumConnections(b3, numConnections);
+          if (numConnections == 3)
+          {
+             break;
+          }
+          OsTask::delay(20);
+       }
+       CPPUNIT_ASSERT_EQUAL(3, numConnections);
+       pB->getNumConnections(b2, numConnections);
+       CPPUNIT_ASSERT_EQUAL(1, numConnections);
+       CPPUNIT_ASSERT_EQUAL(3, testCallLookup_waitForCalls(pB, 3, callIds));
+
+       // The joined dialog is found in the call it was moved to
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pB, b3),
+                            testCallLookup_getConnections(pB, dialog2));
+       CPPUNIT_ASSERT_EQUAL(testCallLookup_getConnections(pB, b3),
+                            testCallLookup_getConnections(pB, dialog3));
+
+       // Drop: every call is gone from the call managers
+       testCallLookup_dropAll(pA);
+       testCallLookup_dropAll(pB);
+       testCallLookup_dropAll(pC);
+       pB->getNumConnections(dialog2, numConnections);
+       CPPUNIT_ASSERT_EQUAL(0, numConnections);
+       pB->getNumConnections(b3, numConnections);
+       CPPUNIT_ASSERT_EQUAL(0, numConnections);
+
+       pUaA->shutdown(TRUE);
+       pUaB->shutdown(TRUE);
+       pUaC->shutdown(TRUE);
+       pA->requestShutdown();
+       pB->requestShutdown();
+       pC->requestShutdown();
+       delete pA;
+       delete pB;
+       delete pC;
+       delete pUaA;
+       delete pUaB;
+       delete pUaC;
+       sipxDestroyMediaFactoryFactory();
+       sipxDestroyMediaFactoryFactory();
+       sipxDestroyMediaFactoryFactory();
+
+       // Every call object is gone
+       CPPUNIT_ASSERT_EQUAL(0, CpCall::getCallTrackingListCount());
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(CallManangerTest);
@@ -0,0 +1,156 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <stdio.h>
+#include <os/OsDefs.h>
+#include <os/OsDateTime.h>
+#include <cp/CpCallTable.h>
+
+#define NUM_PERF_CALLS 10000
+
+/**
+ * Unittest for CpCallTable
+ */
+class CpCallTableTest : public SIPX_UNIT_BASE_CLASS
+{
+      CPPUNIT_TEST_SUITE(CpCallTableTest);
+      CPPUNIT_TEST(testFindCall);
+      CPPUNIT_TEST(testAddCallId);
+      CPPUNIT_TEST(testRemoveCall);
+      CPPUNIT_TEST(testFindCallPerformance);
+      CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   // The table never calls into the calls, so any distinct address will do.
+   CpCall* fakeCall(int n)
+   {
+      return (CpCall*) (((char*) this) + n + 1);
+   }
+
+   void testFindCall()
+   {
+      CpCallTable table;
+      CpCall* call1 = fakeCall(1);
+      CpCall* call2 = fakeCall(2);
+
+      table.addCall(call1, 1, "call-id-1");
+      table.addCall(call2, 2, "call-id-2");
+      CPPUNIT_ASSERT_EQUAL(2, table.getCallCount());
+
+      CPPUNIT_ASSERT(table.findCall("call-id-1") == call1);
+      CPPUNIT_ASSERT(table.findCall("call-id-2") == call2);
+      CPPUNIT_ASSERT(table.findCall("call-id-3") == NULL);
+      CPPUNIT_ASSERT(table.findCall((const char*) NULL) == NULL);
+
+      CPPUNIT_ASSERT(table.findCall(1) == call1);
+      CPPUNIT_ASSERT(table.findCall(2) == call2);
+      CPPUNIT_ASSERT(table.findCall(3) == NULL);
+
+      // Adding a call again does not add another entry
+      table.addCall(call1, 1, "call-id-1");
+      CPPUNIT_ASSERT_EQUAL(2, table.getCallCount());
+   }
+
+   void testAddCallId()
+   {
+      CpCallTable table;
+      CpCall* call1 = fakeCall(1);
+      CpCall* call2 = fakeCall(2);
+
+      // A call created without a Call-ID gets one later
+      table.addCall(call1, 1, NULL);
+      CPPUNIT_ASSERT(table.findCall(1) == call1);
+      table.addCallId(call1, "call-id-1");
+      CPPUNIT_ASSERT(table.findCall("call-id-1") == call1);
+
+      // A transferred connection brings its own Call-ID along
+      table.addCallId(call1, "transfer-id");
+      CPPUNIT_ASSERT(table.findCall("transfer-id") == call1);
+      CPPUNIT_ASSERT(table.findCall("call-id-1") == call1);
+
+      // Calls which are not in the table are ignored
+      table.addCallId(call2, "call-id-2");
+      CPPUNIT_ASSERT(table.findCall("call-id-2") == NULL);
+
+      // A joined connection moves its Call-ID to the other call
+      table.addCall(call2, 2, "call-id-2");
+      table.addCallId(call2, "transfer-id");
+      CPPUNIT_ASSERT(table.findCall("transfer-id") == call2);
+
+      // Removing the old call leaves the Call-ID with the new one
+      table.removeCall(call1);
+      CPPUNIT_ASSERT(table.findCall("transfer-id") == call2);
+      CPPUNIT_ASSERT(table.findCall("call-id-1") == NULL);
+      CPPUNIT_ASSERT(table.findCall(1) == NULL);
+   }
+
+   void testRemoveCall()
+   {
+      CpCallTable table;
+      CpCall* call1 = fakeCall(1);
+      CpCall* call2 = fakeCall(2);
+
+      table.addCall(call1, 1, "call-id-1");
+      table.addCallId(call1, "call-id-1b");
+      table.addCall(call2, 2, "call-id-2");
+
+      table.removeCall(call1);
+      CPPUNIT_ASSERT_EQUAL(1, table.getCallCount());
+      CPPUNIT_ASSERT(table.findCall("call-id-1") == NULL);
+      CPPUNIT_ASSERT(table.findCall("call-id-1b") == NULL);
+      CPPUNIT_ASSERT(table.findCall(1) == NULL);
+      CPPUNIT_ASSERT(table.findCall("call-id-2") == call2);
+
+      // Removing it again, or adding to it afterwards, has no effect
+      table.removeCall(call1);
+      table.addCallId(call1, "call-id-1c");
+      CPPUNIT_ASSERT(table.findCall("call-id-1c") == NULL);
+      CPPUNIT_ASSERT_EQUAL(1, table.getCallCount());
+
+      table.removeCall(call2);
+      CPPUNIT_ASSERT_EQUAL(0, table.getCallCount());
+      CPPUNIT_ASSERT(table.findCall("call-id-2") == NULL);
+   }
+
+   // Finding a call should not depend on the number of calls.
+   void testFindCallPerformance()
+   {
+      CpCallTable table;
+      char callId[40];
+      int i;
+
+      for (i = 0; i < NUM_PERF_CALLS; i++)
+      {
+         sprintf(callId, "%d-call-table-test", i);
+         table.addCall(fakeCall(i), i, callId);
+      }
+      CPPUNIT_ASSERT_EQUAL(NUM_PERF_CALLS, table.getCallCount());
+
+      const int numRuns = 100000;
+
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < numRuns; i++)
+      {
+         int n = (i * 7919) % NUM_PERF_CALLS;
+         sprintf(callId, "%d-call-table-test", n);
+         CPPUNIT_ASSERT(table.findCall(callId) == fakeCall(n));
+      }
+      OsTime end;
+      OsDateTime::getCurTime(end);
+
+      OsTime elapsed = end - start;
+      printf("findCall with %d calls: %.3f us per lookup\n",
+             NUM_PERF_CALLS,
+             (elapsed.seconds() * 1000000.0 + elapsed.usecs()) / numRuns);
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CpCallTableTest);
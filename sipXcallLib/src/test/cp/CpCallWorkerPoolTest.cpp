@@ -0,0 +1,294 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <os/OsAtomics.h>
+#include <os/OsBSem.h>
+#include <os/OsIntPtrMsg.h>
+#include <os/OsTask.h>
+#include <cp/CpCall.h>
+#include <cp/CpCallWorkerPool.h>
+
+#define NUM_TEST_CALLS 8
+#define NUM_TEST_MESSAGES 500
+#define TEST_MSG_SEQUENCE 1
+#define TEST_MSG_BLOCK 2
+
+/// Call which checks the order of the messages the pool lets it handle.
+class CpCallWorkerPoolTestCall : public CpCall
+{
+public:
+   CpCallWorkerPoolTestCall()
+   : CpCall(NULL, NULL, 0, NULL, CallManager::NEAR_END_HOLD)
+   , mNumHandled(0)
+   , mInHandler(0)
+   , mOverlaps(0)
+   , mOutOfOrder(0)
+   , mNextSequence(0)
+   , mBlocked(OsBSem::Q_FIFO, OsBSem::EMPTY)
+   , mGate(OsBSem::Q_FIFO, OsBSem::EMPTY)
+   {
+   }
+
+   virtual ~CpCallWorkerPoolTestCall()
+   {
+      leaveWorkerPool();
+   }
+
+   void postSequence(int sequence)
+   {
+      postMessage(OsIntPtrMsg(OsMsg::USER_START, TEST_MSG_SEQUENCE, sequence));
+   }
+
+   void postBlock()
+   {
+      postMessage(OsIntPtrMsg(OsMsg::USER_START, TEST_MSG_BLOCK));
+   }
+
+   UtlBoolean hasCallId(const char*) {return FALSE;}
+
+   enum handleWillingness willHandleMessage(const OsMsg&)
+   {
+      return CP_WILL_NOT_HANDLE;
+   }
+
+   UtlBoolean canDisconnectConnection(Connection*) {return FALSE;}
+
+   OsAtomicInt mNumHandled;
+   OsAtomicInt mInHandler;
+   OsAtomicInt mOverlaps;     ///< Messages handled while another one was.
+   int mOutOfOrder;
+   intptr_t mNextSequence;
+   OsBSem mBlocked;           ///< Given when a block message is handled.
+   OsBSem mGate;              ///< Ends the block message when given.
+
+protected:
+   UtlBoolean handleMessage(OsMsg& rMsg)
+   {
+      if (mInHandler++ > 0)
+      {
+         mOverlaps++;
+      }
+
+      if (rMsg.getMsgSubType() == TEST_MSG_BLOCK)
+      {
+         mBlocked.release();
+         mGate.acquire();
+      }
+      else
+      {
+         intptr_t sequence = ((OsIntPtrMsg&) rMsg).getData1();
+         if (sequence != mNextSequence)
+         {
+            mOutOfOrder++;
+         }
+         mNextSequence = sequence + 1;
+      }
+
+      mInHandler--;
+      mNumHandled++;
+      return TRUE;
+   }
+
+   UtlBoolean handleCallMessage(OsMsg&) {return FALSE;}
+   UtlBoolean handleMiNotificationMessage(MiNotification&) {return FALSE;}
+   void onHook() {}
+   UtlBoolean getConnectionState(const char*, int&) {return FALSE;}
+   UtlBoolean getTermConnectionState(const char*, const char*, int&)
+   {
+      return FALSE;
+   }
+};
+
+/// Task which removes a call from a pool.
+class CpCallWorkerPoolTestRemover : public OsTask
+{
+public:
+   CpCallWorkerPoolTestRemover(CpCallWorkerPool* pPool, CpCall* pCall)
+   : OsTask("CpCallWorkerPoolTestRemover")
+   , mpPool(pPool)
+   , mpCall(pCall)
+   , mDone(OsBSem::Q_FIFO, OsBSem::EMPTY)
+   {
+   }
+
+   virtual ~CpCallWorkerPoolTestRemover()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void*)
+   {
+      mpPool->removeCall(mpCall);
+      mDone.release();
+      return 0;
+   }
+
+   CpCallWorkerPool* mpPool;
+   CpCall* mpCall;
+   OsBSem mDone;              ///< Given when removeCall() returned.
+};
+
+/**
+ * Unittest for CpCallWorkerPool
+ */
+class CpCallWorkerPoolTest : public SIPX_UNIT_BASE_CLASS
+{
+      CPPUNIT_TEST_SUITE(CpCallWorkerPoolTest);
+      CPPUNIT_TEST(testOrdering);
+      CPPUNIT_TEST(testRemoveRunningCall);
+      CPPUNIT_TEST(testBlockedWorkers);
+      CPPUNIT_TEST(testShutdown);
+      CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   void waitForHandled(CpCallWorkerPoolTestCall* pCall, int numHandled)
+   {
+      for (int i = 0; i < 500 && pCall->mNumHandled < numHandled; i++)
+      {
+         OsTask::delay(10);
+      }
+   }
+
+   void testOrdering()
+   {
+      CpCallWorkerPool pool;
+      CpCallWorkerPoolTestCall* calls[NUM_TEST_CALLS];
+      for (int i = 0; i < NUM_TEST_CALLS; i++)
+      {
+         calls[i] = new CpCallWorkerPoolTestCall();
+         calls[i]->setWorkerPool(&pool);
+         calls[i]->start();
+      }
+      CPPUNIT_ASSERT_EQUAL(NUM_TEST_CALLS, pool.getCallCount());
+
+      // Messages of all the calls are interleaved, so every worker is busy
+      for (int n = 0; n < NUM_TEST_MESSAGES; n++)
+      {
+         for (int i = 0; i < NUM_TEST_CALLS; i++)
+         {
+            calls[i]->postSequence(n);
+         }
+      }
+
+      for (int i = 0; i < NUM_TEST_CALLS; i++)
+      {
+         waitForHandled(calls[i], NUM_TEST_MESSAGES);
+         CPPUNIT_ASSERT_EQUAL(NUM_TEST_MESSAGES, (int) calls[i]->mNumHandled);
+         CPPUNIT_ASSERT_EQUAL(0, calls[i]->mOutOfOrder);
+         CPPUNIT_ASSERT_EQUAL(0, (int) calls[i]->mOverlaps);
+      }
+
+      for (int i = 0; i < NUM_TEST_CALLS; i++)
+      {
+         delete calls[i];
+      }
+      CPPUNIT_ASSERT_EQUAL(0, pool.getCallCount());
+      CPPUNIT_ASSERT_EQUAL((int) CpCallWorkerPool::DEFAULT_NUM_WORKERS,
+                           pool.getNumWorkers());
+   }
+
+   void testRemoveRunningCall()
+   {
+      CpCallWorkerPool pool(1);
+      CpCallWorkerPoolTestCall call;
+      call.setWorkerPool(&pool);
+      call.start();
+
+      call.postBlock();
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, call.mBlocked.acquire(OsTime(5, 0)));
+
+      // removeCall() waits until the worker is done with the call
+      CpCallWorkerPoolTestRemover remover(&pool, &call);
+      remover.start();
+      CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT,
+                           remover.mDone.acquire(OsTime(0, 200000)));
+      CPPUNIT_ASSERT_EQUAL(0, pool.getCallCount());
+
+      call.mGate.release();
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, remover.mDone.acquire(OsTime(5, 0)));
+      CPPUNIT_ASSERT_EQUAL(1, (int) call.mNumHandled);
+
+      // A removed call is not run any more
+      call.postSequence(0);
+      OsTask::delay(100);
+      CPPUNIT_ASSERT_EQUAL(1, (int) call.mNumHandled);
+   }
+
+   void testBlockedWorkers()
+   {
+      CpCallWorkerPool pool(1);
+      CpCallWorkerPoolTestCall blockedCall;
+      CpCallWorkerPoolTestCall call;
+      blockedCall.setWorkerPool(&pool);
+      blockedCall.start();
+      call.setWorkerPool(&pool);
+      call.start();
+
+      blockedCall.postBlock();
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           blockedCall.mBlocked.acquire(OsTime(5, 0)));
+
+      // The only worker is blocked, the other call waits for it
+      call.postSequence(0);
+      OsTask::delay(100);
+      CPPUNIT_ASSERT_EQUAL(0, (int) call.mNumHandled);
+      CPPUNIT_ASSERT_EQUAL(1, pool.getNumWorkers());
+
+      // Once it has been blocked for long, the pool starts another worker
+      OsTask::delay(CpCallWorkerPool::BLOCKED_TURN_MS);
+      call.postSequence(1);
+      waitForHandled(&call, 2);
+      CPPUNIT_ASSERT_EQUAL(2, (int) call.mNumHandled);
+      CPPUNIT_ASSERT_EQUAL(0, call.mOutOfOrder);
+      CPPUNIT_ASSERT_EQUAL(2, pool.getNumWorkers());
+
+      // Workers which are not blocked do not start more of them
+      OsTask::delay(CpCallWorkerPool::BLOCKED_TURN_MS);
+      call.postSequence(2);
+      waitForHandled(&call, 3);
+      CPPUNIT_ASSERT_EQUAL(2, pool.getNumWorkers());
+
+      blockedCall.mGate.release();
+      waitForHandled(&blockedCall, 1);
+      CPPUNIT_ASSERT_EQUAL(1, (int) blockedCall.mNumHandled);
+   }
+
+   void testShutdown()
+   {
+      CpCallWorkerPool* pPool = new CpCallWorkerPool(1);
+      CpCallWorkerPoolTestCall* pBlockedCall = new CpCallWorkerPoolTestCall();
+      CpCallWorkerPoolTestCall* pQueuedCall = new CpCallWorkerPoolTestCall();
+      pBlockedCall->setWorkerPool(pPool);
+      pBlockedCall->start();
+      pQueuedCall->setWorkerPool(pPool);
+      pQueuedCall->start();
+
+      pBlockedCall->postBlock();
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pBlockedCall->mBlocked.acquire(OsTime(5, 0)));
+
+      // A queued call is removed at once, its messages are not handled
+      pQueuedCall->postSequence(0);
+      pPool->removeCall(pQueuedCall);
+      CPPUNIT_ASSERT_EQUAL(1, pPool->getCallCount());
+      delete pQueuedCall;
+
+      // Deleting a running call waits for its turn to end
+      pBlockedCall->mGate.release();
+      delete pBlockedCall;
+      CPPUNIT_ASSERT_EQUAL(0, pPool->getCallCount());
+
+      // The workers stop, whether or not they took the removed call off
+      // the queue
+      delete pPool;
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CpCallWorkerPoolTest);
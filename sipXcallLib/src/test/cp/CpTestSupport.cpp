@@ -48,7 +48,8 @@ SipUserAgent *CpTestSupport::newSipUserAgent()
    return ua;
 }
 
-CallManager *CpTestSupport::newCallManager(SipUserAgent* sua)
+CallManager *CpTestSupport::newCallManager(SipUserAgent* sua,
+                                           UtlBoolean enableLocalAudio)
 {
         UtlString localAddress;
         OsSocket::getHostIp(&localAddress);
@@ -88,7 +89,7 @@ CallManager *CpTestSupport::newCallManager(SipUserAgent* sua)
           CP_MAXIMUM_RINGING_EXPIRE_SECONDS, //inviteExpireSeconds
           QOS_LAYER3_LOW_DELAY_IP_TOS, // expeditedIpTos
           10, //maxCalls
-          sipXmediaFactoryFactory(NULL),
+          sipXmediaFactoryFactory(NULL, 0, 0, 0, enableLocalAudio),
           8000); //pMediaFactory
 
     return callManager;
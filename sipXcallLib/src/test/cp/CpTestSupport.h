@@ -13,6 +13,8 @@
 
 // SYSTEM INCLUDES
 // APPLICATION INCLUDES
+#include <utl/UtlDefs.h>
+
 // DEFINES
 // MACROS
 // EXTERNAL FUNCTIONS
@@ -30,9 +32,12 @@ class CpTestSupport
 public:
 
     /**
-     * A testable call manager initialized to testable defaults
+     * A testable call manager initialized to testable defaults.  Without
+     * local audio media is clocked by a timer, so calls work on machines
+     * without sound devices.
      */
-    static CallManager *newCallManager(SipUserAgent *ua);
+    static CallManager *newCallManager(SipUserAgent *ua,
+                                       UtlBoolean enableLocalAudio = TRUE);
 
     /**
      * A testable user agent initialized to testable defaults
@@ -142,17 +142,27 @@ sipXmediaFactoryImpl::sipXmediaFactoryImpl(OsConfigDb* pConfigDb,
    }
 
    int maxFlowGraph = -1; 
+   int mediaWorkers = 0;
    UtlString strInBandDTMF;
+   UtlString strPinWorkers;
    if (pConfigDb)
    {
       pConfigDb->get("PHONESET_MAX_ACTIVE_CALLS_ALLOWED", maxFlowGraph);
       pConfigDb->get("PHONESET_SEND_INBAND_DTMF", strInBandDTMF);
       strInBandDTMF.toUpper();
+      pConfigDb->get("PHONESET_MEDIA_WORKER_THREADS", mediaWorkers);
+      pConfigDb->get("PHONESET_MEDIA_WORKER_PIN", strPinWorkers);
+      strPinWorkers.toUpper();
 
       OsSysLog::add(FAC_MP, PRI_DEBUG, 
                     "sipXmediaFactoryImpl::sipXmediaFactoryImpl"
-                    " maxFlowGraph = %d",
-                    maxFlowGraph);
+                    " maxFlowGraph = %d mediaWorkers = %d",
+                    maxFlowGraph, mediaWorkers);
+   }
+
+   if (mediaWorkers < 0)
+   {
+      mediaWorkers = 0;
    }
 
    // Max Flow graphs
@@ -179,7 +189,9 @@ sipXmediaFactoryImpl::sipXmediaFactoryImpl(OsConfigDb* pConfigDb,
    }
 
    // init the media processing task
-   mpMediaTask = MpMediaTask::createMediaTask(maxFlowGraph, enableLocalAudio); 
+   mpMediaTask = MpMediaTask::createMediaTask(maxFlowGraph, enableLocalAudio,
+                                              mediaWorkers,
+                                              strPinWorkers.compareTo("ENABLE") == 0);
 
 #ifdef INCLUDE_RTCP /* [ */
    mpiRTCPControl = CRTCManager::getRTCPControl();
@@ -63,11 +63,16 @@ LOCAL_SRC_FILES := \
     src/mp/MpDecoderBase.cpp \
     src/mp/MpDecoderPayloadMap.cpp \
     src/mp/MpDspUtils.cpp \
+    src/mp/MpDspUtilsAvx2.cpp \
+    src/mp/MpDspUtilsNeon.cpp \
+    src/mp/MpDspUtilsSse2.cpp \
     src/mp/MpDTMFDetector.cpp \
+    src/mp/MpEncodedFrameCache.cpp \
     src/mp/MpEncoderBase.cpp \
     src/mp/MpFlowGraphBase.cpp \
     src/mp/MpFlowGraphMsg.cpp \
     src/mp/mpG711.cpp \
+    src/mp/MpGoertzelBank.cpp \
     src/mp/MpidAndroid.cpp \
     src/mp/MpInputDeviceDriver.cpp \
     src/mp/MpInputDeviceManager.cpp \
@@ -76,6 +81,7 @@ LOCAL_SRC_FILES := \
     src/mp/MpJitterBufferEstimation.cpp \
     src/mp/MprHook.cpp \
     src/mp/MpMediaTask.cpp \
+    src/mp/MpMediaTaskWorker.cpp \
     src/mp/MpMediaTaskMsg.cpp \
     src/mp/MpMisc.cpp \
     src/mp/MpMMTimer.cpp \
@@ -86,13 +92,16 @@ LOCAL_SRC_FILES := \
     src/mp/MpOutputDeviceManager.cpp \
     src/mp/MpPlayer.cpp \
     src/mp/MpPlayerEvent.cpp \
+    src/mp/MpPromptCache.cpp \
     src/mp/MprBridge.cpp \
     src/mp/MprDecode.cpp \
     src/mp/MprDejitter.cpp \
     src/mp/MprDelay.cpp \
     src/mp/MprEchoSuppress.cpp \
     src/mp/MprEncode.cpp \
+    src/mp/MpRecorderWriter.cpp \
     src/mp/MpResampler.cpp \
+    src/mp/MpResamplerPolyphase.cpp \
     src/mp/MpResamplerSpeex.cpp \
     src/mp/MpResource.cpp \
     src/mp/MpResourceFactory.cpp \
@@ -470,6 +479,7 @@ LOCAL_SRC_FILES := \
     src/test/mp/MpTestResource.cpp \
     src/test/mp/MprBridgeTest.cpp \
     src/test/mp/MprBridgeTestWB.cpp \
+    src/test/mp/MprDejitterTest.cpp \
     src/test/mp/MprFromMicTest.cpp \
     src/test/mp/MprMixerTest.cpp \
     src/test/mp/MprRecorderTest.cpp \
@@ -565,6 +575,7 @@ LOCAL_SRC_FILES := \
     src/mp/codecs/plgpcmapcmu/CodecPcmaWrapper.c \
     src/mp/codecs/plgpcmapcmu/CodecPcmuWrapper.c \
     src/mp/codecs/plgpcmapcmu/G711.c \
+    src/mp/codecs/plgpcmapcmu/G711Tables.c \
     src/mp/codecs/plgpcmapcmu/PlgPcmaPcmu.c \
     contrib/libspandsp/src/g711.c
 
@@ -738,6 +749,7 @@ LOCAL_SRC_FILES := \
     src/test/mp/MpTestResource.cpp \
     src/test/mp/MprBridgeTest.cpp \
     src/test/mp/MprBridgeTestWB.cpp \
+    src/test/mp/MprDejitterTest.cpp \
     src/test/mp/MprFromMicTest.cpp \
     src/test/mp/MprMixerTest.cpp \
     src/test/mp/MprSpeakerSelectorTest.cpp \
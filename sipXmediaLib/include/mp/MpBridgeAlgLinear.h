@@ -46,13 +46,27 @@ class MpBridgeAlgLinear : public MpBridgeAlgBase
 /* //////////////////////////////// PUBLIC //////////////////////////////// */
 public:
 
+   enum
+   {
+      SPEAKER_HANGOVER_FRAMES = 25 ///< Number of frames a talker keeps its
+                                   ///< place after it stops being one of
+                                   ///< the loudest.
+   };
+
 /* =============================== CREATORS =============================== */
 ///@name Creators
 //@{
 
      /// Constructor.
    MpBridgeAlgLinear(int inputs, int outputs, UtlBoolean mixSilence,
-                     int samplesPerFrame);
+                     int samplesPerFrame, int maxActiveSpeakers = 0);
+     /**<
+     *  @param[in] maxActiveSpeakers - maximum number of inputs mixed in
+     *             one frame, 0 to mix all of them. If set, only the loudest
+     *             talkers are mixed (see selectActiveSpeakers()), so each
+     *             of them hears the others and everybody else hears the
+     *             same mix of all of them.
+     */
 
      /// Destructor.
    ~MpBridgeAlgLinear();
@@ -331,6 +345,36 @@ protected:
 
 //@}
 
+/* ============================ Active speakers =========================== */
+///@name Active speakers
+//@{
+
+   int            mMaxActiveSpeakers;  ///< Maximum number of inputs to mix,
+                    ///< 0 if not limited.
+   UtlBoolean*    mpSpeakerSelected;   ///< Is original input mixed in this frame?
+   int*           mpSpeakerHangover;   ///< Frames left before a selected
+                    ///< talker gives its place up.
+   int*           mpSpeakerCandidates; ///< List of original inputs which could
+                    ///< be mixed. Used in selectActiveSpeakers() only.
+
+     /// Select original inputs to mix in this frame.
+   void selectActiveSpeakers(MpBufPtr inBufs[], int inBufsSize);
+     /**<
+     *  Inputs are ranked by speech type (active audio first), then by
+     *  speaker rank of MprSpeakerSelector, if it is used in front of the
+     *  bridge, and then by frame energy (or amplitude, if energy is not
+     *  known). Up to mMaxActiveSpeakers top ranked inputs are mixed.
+     *  A talker keeps its place for SPEAKER_HANGOVER_FRAMES frames after
+     *  it drops out of the top, so pauses between words do not cut it off
+     *  and a louder talker gets in when a place is free.
+     */
+
+     /// Should input \p pFirst be mixed rather than \p pSecond?
+   static inline UtlBoolean isLouderSpeaker(const MpAudioBufPtr &pFirst,
+                                            const MpAudioBufPtr &pSecond);
+
+//@}
+
 /* ============================== Mix Engine ============================== */
 ///@name Mix Engine
 //@{
@@ -360,6 +404,8 @@ protected:
    MpBridgeAccum* mpMixDataStack;
    MpSpeechType*  mpMixDataSpeechType; ///< Speech type of data frames in mpMixDataStack
    MpBridgeAccum* mpMixDataAmplitude; ///< Amplitude of data frames in mpMixDataStack
+   int*           mpMixDataOutput; ///< First output a data frame in mpMixDataStack
+                                   ///< was copied to in this frame, or -1.
    int            mMixDataInfoStackStep;
    int            mMixDataInfoStackLength;
    int*           mpMixDataInfoStackTop;
@@ -659,4 +705,28 @@ private:
 
 /* ============================ INLINE METHODS ============================ */
 
+UtlBoolean MpBridgeAlgLinear::isLouderSpeaker(const MpAudioBufPtr &pFirst,
+                                              const MpAudioBufPtr &pSecond)
+{
+   UtlBoolean firstActive = isActiveAudio(pFirst->getSpeechType());
+   UtlBoolean secondActive = isActiveAudio(pSecond->getSpeechType());
+   if (firstActive != secondActive)
+   {
+      return firstActive;
+   }
+
+   const MpSpeechParams &firstParams = pFirst->getSpeechParams();
+   const MpSpeechParams &secondParams = pSecond->getSpeechParams();
+   if (firstParams.mSpeakerRank != secondParams.mSpeakerRank)
+   {
+      return firstParams.mSpeakerRank < secondParams.mSpeakerRank;
+   }
+
+   if (firstParams.mFrameEnergy >= 0 && secondParams.mFrameEnergy >= 0)
+   {
+      return firstParams.mFrameEnergy > secondParams.mFrameEnergy;
+   }
+   return firstParams.mAmplitude > secondParams.mAmplitude;
+}
+
 #endif  // _MpBridgeAlgLinear_h_
@@ -123,7 +123,7 @@ public:
 protected:
 
     MP_BUFFERS_TREE mType;     ///< Buffer class type. Used for type safety.
-    int mRefCounter;           ///< Reference counter for use with MpBufPtr.
+    OsAtomicInt mRefCounter;   ///< Reference counter for use with MpBufPtr.
     MpBufPool* mpPool;         ///< Parent memory pool.
     MpFlowGraphBase* mpFlowGraph; ///< Debug pointer to flowgraph in which this buf is used
     void (*mpDestroy)(MpBuf*); ///< Pointer to deinitialization method. Used as
@@ -13,6 +13,7 @@
 // SYSTEM INCLUDES
 // APPLICATION INCLUDES
 #include <os/OsMutex.h>
+#include <os/OsAtomics.h>
 #include <utl/UtlString.h>
 
 // DEFINES
@@ -29,6 +30,21 @@ class MpFlowGraphBase;
 class UtlString;
 
 /// Pool of buffers.
+/**
+*  Free blocks are kept in a lock-free stack (Treiber stack). Its head is
+*  a 64-bit word holding index of the top free block and a tag, which is
+*  incremented on every change of the head to protect against ABA problem.
+*  Index of the next free block is stored in MpBuf::mpPool of the free block.
+*  Thus getBuffer() and releaseBuffer() never take a lock and could be called
+*  concurrently from any number of threads.
+*
+*  Blocks are allocated in chunks of the initial pool size. If maximum number
+*  of blocks is greater then initial one, the pool grows by one chunk when
+*  it runs out of free blocks, until the maximum is reached. Chunks are never
+*  freed before the pool is destroyed, so block pointers stay valid for
+*  the whole pool lifetime. Growth itself is serialized by a mutex, but it
+*  does not block concurrent getBuffer() and releaseBuffer() calls.
+*/
 class MpBufPool {
 
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -38,7 +54,13 @@ public:
 //@{
 
     /// Creates pool with numBlocks in it. Each block have size blockSize.
-    MpBufPool(unsigned blockSize, unsigned numBlocks, const UtlString& poolName);
+    MpBufPool(unsigned blockSize, unsigned numBlocks, const UtlString& poolName,
+              unsigned maxBlocks = 0);
+    /**<
+    *  @param[in] maxBlocks - maximum number of blocks this pool could grow to.
+    *             Pool grows by numBlocks at once. 0 or any value not greater
+    *             then numBlocks means this pool never grows.
+    */
 
     /// Destroys pool.
     virtual
@@ -53,7 +75,10 @@ public:
     /// Get free block from pool.
     MpBuf *getBuffer();
     /**<
-    * @return If there are no free blocks in pool invalid pointer returned.
+    * If there are no free blocks, pool tries to grow.
+    *
+    * @return If there are no free blocks in pool and it can't grow anymore
+    *         invalid pointer returned.
     */
 
     /// Bring this buffer back to pool.
@@ -68,11 +93,20 @@ public:
     /// Return size of the one block in the pool (in bytes).
     unsigned getBlockSize() const {return mBlockSize;};
 
-    /// Return number of blocks in the pool.
+    /// Return number of blocks currently allocated in the pool.
     unsigned getNumBlocks() const {return mNumBlocks;};
 
+    /// Return maximum number of blocks this pool could grow to.
+    unsigned getMaxBlocks() const {return mMaxChunks*mBlocksPerChunk;};
+
+    /// Return number of times this pool has grown.
+    unsigned getNumGrows() const {return mNumChunks-1;};
+
     /// Return number of the buffer in the pool. Use this for debug output.
     int getBufferNumber(MpBuf *pBuf) const;
+    /**<
+    * @return Index of the block or -1 if this buffer is not from this pool.
+    */
 
     /// Return the number of free buffers
     int getFreeBufferCount();
@@ -97,33 +131,69 @@ public:
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
-    /// Return pointer to the byte after end of the pool data.
-    void *getPoolDataEnd() {return mpPoolData + mBlockSpan*mNumBlocks;}
+    enum {
+       MAX_CHUNKS = 32  ///< Maximum number of chunks in one pool.
+    };
+
+    /// Return pointer to the block with given index.
+    inline MpBuf *getBlock(unsigned index) const;
+
+    /// Return pointer to the first block of the given chunk.
+    char *getChunk(int chunk) const {return mpChunks[chunk];}
 
     /// Return pointer to the block, next to this.
-    char *getNextBlock(char *pBlock) {return pBlock + mBlockSpan;}
-    
-    void appendFreeList(MpBuf *pBuf);
+    char *getNextBlock(char *pBlock) const {return pBlock + mBlockSpan;}
+
+    /// Allocate new chunk of blocks and put them to the free list.
+    UtlBoolean grow();
+    /**<
+    * @returns TRUE if free list is not empty when this function returns.
+    */
+
+    /// Push buffer with given index to the free list.
+    void pushFreeList(MpBuf *pBuf, unsigned index);
+
+    /// Pack index of the top block and tag to the free list head.
+    static int64_t makeHead(unsigned topIndex, unsigned tag)
+    {return (int64_t)(((uint64_t)tag << 32) | (uint64_t)topIndex);}
+
+    /// Get index of the top block (+1) from the free list head.
+    static unsigned headTop(int64_t head) {return (unsigned)((uint64_t)head & 0xffffffff);}
+
+    /// Get tag from the free list head.
+    static unsigned headTag(int64_t head) {return (unsigned)((uint64_t)head >> 32);}
+
+    /// Log pool exhaustion.
+    void reportEmpty();
 
     UtlString  mPoolName;      ///< label or name for debug
     unsigned   mBlockSize;     ///< Requested size of each block in pool (in bytes).
     unsigned   mBlockSpan;     ///< Actual size of each block.  >= mBlockSize for alignment
-    unsigned   mNumBlocks;     ///< Number of blocks in pool.
-    unsigned   mPoolBytes;     ///< Size of all pool in bytes.
-    char      *mpPoolData;     ///< Pointer to allocated memory.
-                               ///<  May be padded to match align rules.
-    MpBufList *mpFreeList;     ///< Begin of the free blocks list.
-                               ///<  NULL if there are no free blocks availiable.
-    OsMutex    mMutex;         ///< Mutex to avoid concurrent access to the pool.
+    unsigned   mBlocksPerChunk;///< Number of blocks in one chunk.
+    unsigned   mChunkBytes;    ///< Size of one chunk in bytes.
+    int        mMaxChunks;     ///< Maximum number of chunks.
+    char     **mpChunks;       ///< Array of mMaxChunks pointers to chunks.
+    OsAtomicInt mNumChunks;    ///< Number of allocated chunks.
+    OsAtomicInt mNumBlocks;    ///< Number of blocks in pool.
+    OsAtomic<int64_t> mFreeHead;///< Head of the free list. Top index is 1-based,
+                               ///<  0 means there are no free blocks available.
+    OsMutex    mGrowMutex;     ///< Mutex to serialize pool growth.
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
-    unsigned   mNumGets;       ///For statistics
-    unsigned   mNumFrees;      ///For statistics
-    unsigned   mNumFree;       ///For statistics
-    unsigned   mMinFree;       ///For statistics
+    OsAtomicInt mNumGets;      ///< For statistics
+    OsAtomicInt mNumFrees;     ///< For statistics
+    OsAtomicInt mNumFree;      ///< For statistics
+    int        mMinFree;       ///< For statistics (approximate)
  
 };
 
+/* ============================ INLINE METHODS ============================ */
+
+MpBuf *MpBufPool::getBlock(unsigned index) const
+{
+    return (MpBuf*)(mpChunks[index/mBlocksPerChunk]
+                    + (index%mBlocksPerChunk)*mBlockSpan);
+}
 
 #endif // _INCLUDED_MPBUFPOOL_H ]
@@ -99,6 +99,13 @@ public:
    static
    MpCodecCallInfoV1* addStaticCodec(MpCodecCallInfoV1* sStaticCode);   
 
+     /// Find added static codec by its codec module name.
+   static
+   MpCodecCallInfoV1* findStaticCodec(const char* codecModuleName);
+     /**<
+     *  @returns NULL if no static codec with given name has been added.
+     */
+
 //@}
 
 /* ============================ ACCESSORS ================================= */
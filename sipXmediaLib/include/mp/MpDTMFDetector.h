@@ -18,6 +18,7 @@
 #include <os/OsIntTypes.h>
 #include <mp/MpTypes.h>
 #include <utl/UtlDefs.h>  // UtlBoolean
+#include <mp/MpGoertzelBank.h>
 
 // DEFINES
 // EXTERNAL FUNCTIONS
@@ -45,11 +46,18 @@
 *  Usage:
 *  To use this, construct it with your sample rate and an adequate value for 
 *  number of samples to do the goertzel algorithm on.  
-*  Then just call processSample repeatedly as you get samples.  It will return 
-*  /p FALSE, until /p nProcessSamples samples have been processed, after 
-*  which time it will return /p TRUE.
+*  Then just call processFrame() with every frame of samples you get (or
+*  processSample() with every sample).  It will return /p FALSE, until
+*  /p nProcessSamples samples have been processed, after which time it will
+*  return /p TRUE.
 *  You then can get the detected DTMF using getLastDetectedDTMF(). If no DTMF 
 *  was properly detected, NULL will be returned.
+*
+*  Samples are collected into blocks of /p nProcessSamples and the filters
+*  of all frequencies are run over a whole block at once with
+*  MpGoertzelBank. Blocks which are too quiet to pass the minimum energy
+*  check are found with MpGoertzelBank::isBelowPower() and skipped without
+*  running the filters.
 *  
 */
 class MpDtmfDetector
@@ -100,6 +108,17 @@ public:
      *  before running the goertzel algorithm.
      */
 
+     /// Process a frame of samples through the detector.
+   UtlBoolean processFrame(const MpAudioSample *pSamples, unsigned numSamples);
+     /**<
+     *  Same as calling processSample() for every sample of the frame, but
+     *  much faster.
+     *
+     *  @return /p TRUE if a multiple of getNumProcessSamples() samples was
+     *          reached within this frame, i.e. detection was run, /p FALSE
+     *          otherwise.
+     */
+
      /// Process a sample through the detector.
    UtlBoolean processSample(const MpAudioSample sample);
      /**<
@@ -167,6 +186,9 @@ private:
      * More simply: coef = 2.0 * cos( (2.0 * PI * target_freq) / SAMPLING_RATE );
      */
 
+     /// Run the filters over a full block of samples and validate the result.
+   void processBlock();
+
      /// Validate the detected frequencies detected by processSample.
    void dtmfValidation();
      /**<
@@ -183,11 +205,9 @@ private:
    static double sFreqs_to_detect[]; 
    static uint8_t snFreqsToDetect;
 
-   double* mQ1;
-   double* mQ2;
-   double* mR;
-
-   double* mCoefs;
+   MpGoertzelBank mBank;   ///< Filters of all frequencies to detect.
+   double mR[MpGoertzelBank::MAX_FREQS]; ///< Power of each frequency in last block.
+   MpAudioSample* mpBlock; ///< Samples of the current block.
 
    char mLastDetectedDTMF;
 };
@@ -105,6 +105,28 @@ public:
      *  @returns Number of decoded samples.
      */
 
+     /// Decode payloads of several channels in one call
+   int decodeBatch(int numFrames,
+                   const uint8_t* const pPayloads[],
+                   unsigned payloadSize,
+                   unsigned decodedBufferLength,
+                   MpAudioSample* const pSamplesBuffers[]);
+     /**<
+     *  Decodes \p numFrames independent RTP payloads of the same size,
+     *  e.g. the packets of many channels, with one call to the codec.
+     *  Only codecs which keep no state between packets support it, see
+     *  supportsBatch().
+     *
+     *  @param[in]  numFrames - Number of payloads to decode.
+     *  @param[in]  pPayloads - Payloads to decode.
+     *  @param[in]  payloadSize - Size of each payload (in bytes).
+     *  @param[in]  decodedBufferLength - Length of each buffer (in samples).
+     *  @param[out] pSamplesBuffers - Buffers for decoded samples.
+     *
+     *  @returns Number of samples decoded into each buffer, 0 if the codec
+     *           does not support batch decoding or failed.
+     */
+
 //@}
 
 /* ============================ ACCESSORS ================================= */
@@ -153,6 +175,12 @@ public:
 ///@name Inquiry
 //@{
 
+     /// Can this decoder decode several payloads in one call?
+   UtlBoolean supportsBatch() const;
+     /**<
+     *  @see decodeBatch()
+     */
+
 //@}
 
 protected:
@@ -27,9 +27,11 @@
 // APPLICATION INCLUDES
 #include <os/OsStatus.h>
 #include <os/OsIntTypes.h>
+#include <utl/UtlDefs.h>
 #ifdef MP_FIXED_POINT // [
 #  include <math.h>
 #endif // MP_FIXED_POINT ]
+#include <mp/MpDspUtilsSimd.h>
 
 // DEFINES
 #define MPF_SIGN_BIT16  (1<<15)
@@ -115,7 +117,18 @@
 *  When creating new function, do not forget to provide clean C implementation
 *  for convenience.
 *
+*  <H3>SIMD versions.</H3>
+*
+*  Vector functions have SSE2, AVX2 and NEON versions which are selected
+*  at startup according to CPU features (see detectSimdLevel()). Generic C
+*  versions are still used for short vectors and for functions without
+*  optimized version. MpDspUtilsTest compares every SIMD version available
+*  on the current CPU against generic C code, so run it after touching any
+*  of them.
+*
 *  @warning Please, keep all methods of this class static and stateless!
+*           The only exception is the table of selected SIMD versions,
+*           which is set once at startup.
 */
 class MpDspUtils
 {
@@ -516,6 +529,47 @@ public:
 
 //@}
 
+/* ======================= SIMD Versions Selection ======================== */
+///@name SIMD Versions Selection
+//@{
+
+     /// Detect the best SIMD level supported by this CPU and this build.
+   static
+   MpDspSimdLevel detectSimdLevel();
+
+     /// Select SIMD versions of vector functions to use.
+   static
+   OsStatus setSimdLevel(MpDspSimdLevel level);
+     /**<
+     *  Best supported level is selected automatically at startup, so this
+     *  is meant for unittests and benchmarks. It is not safe to call this
+     *  while other threads use vector functions.
+     *
+     *  @retval OS_SUCCESS if level has been selected.
+     *  @retval OS_NOT_SUPPORTED if this CPU or this build does not support
+     *          requested level. Selection is not changed in this case.
+     */
+
+     /// Return currently selected SIMD level.
+   static
+   MpDspSimdLevel getSimdLevel();
+
+     /// Is given SIMD level supported by this CPU and this build?
+   static
+   UtlBoolean isSimdLevelSupported(MpDspSimdLevel level);
+
+     /// Return human readable name of the given SIMD level.
+   static
+   const char *getSimdLevelName(MpDspSimdLevel level);
+
+//@}
+
+/* /////////////////////////////// PRIVATE //////////////////////////////// */
+private:
+
+   static const MpDspSimdKernels *spSimdKernels; ///< Selected SIMD versions.
+   static MpDspSimdLevel sSimdLevel;             ///< Selected SIMD level.
+
 };
 
 /* ============================ INLINE METHODS ============================ */
@@ -26,6 +26,8 @@
 
 OsStatus MpDspUtils::convert(const int32_t *pSrc, int16_t *pDst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(convert32to16, dataLength, (pSrc, pDst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]));
@@ -35,6 +37,8 @@ OsStatus MpDspUtils::convert(const int32_t *pSrc, int16_t *pDst, int dataLength)
 
 OsStatus MpDspUtils::convert_Gain(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(convert_Gain32to16, dataLength, (pSrc, pDst, dataLength, srcScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = MPF_EXTRACRT16(shl16(pSrc[i], srcScaleFactor));
@@ -44,6 +48,8 @@ OsStatus MpDspUtils::convert_Gain(const int32_t *pSrc, int16_t *pDst, int dataLe
 
 OsStatus MpDspUtils::convert_Att(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(convert_Att32to16, dataLength, (pSrc, pDst, dataLength, srcScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]>>srcScaleFactor));
@@ -53,6 +59,8 @@ OsStatus MpDspUtils::convert_Att(const int32_t *pSrc, int16_t *pDst, int dataLen
 
 OsStatus MpDspUtils::convert(const int16_t *pSrc, int32_t *pDst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(convert16to32, dataLength, (pSrc, pDst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = pSrc[i];
@@ -62,6 +70,8 @@ OsStatus MpDspUtils::convert(const int16_t *pSrc, int32_t *pDst, int dataLength)
 
 OsStatus MpDspUtils::convert_Gain(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(convert_Gain16to32, dataLength, (pSrc, pDst, dataLength, srcScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = shl32((int32_t)pSrc[i], srcScaleFactor);
@@ -71,6 +81,8 @@ OsStatus MpDspUtils::convert_Gain(const int16_t *pSrc, int32_t *pDst, int dataLe
 
 OsStatus MpDspUtils::convert_Att(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(convert_Att16to32, dataLength, (pSrc, pDst, dataLength, srcScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = pSrc[i]>>srcScaleFactor;
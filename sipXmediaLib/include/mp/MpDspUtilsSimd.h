@@ -0,0 +1,106 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpDspUtilsSimd_h_
+#define _MpDspUtilsSimd_h_
+
+/**
+*  @file
+*
+*  DO NOT INCLUDE THIS FILE DIRECTLY! This files is designed to be included
+*  to <mp/MpDspUtils.h> and should not be used outside of it.
+*/
+
+// DEFINES
+
+/// Define MP_DSP_DISABLE_SIMD to build generic C versions only.
+#if defined(MP_FIXED_POINT) && !defined(MP_DSP_DISABLE_SIMD) // [
+#  if (defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))) \
+   || defined(_M_IX86) || defined(_M_X64) // [
+#     define MP_DSP_SIMD_USE_X86
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) // x86 ][
+#     define MP_DSP_SIMD_USE_NEON
+#  endif // ARM NEON ]
+#  if defined(MP_DSP_SIMD_USE_X86) || defined(MP_DSP_SIMD_USE_NEON) // [
+#     define MP_DSP_SIMD
+#  endif // MP_DSP_SIMD_USE_X86 || MP_DSP_SIMD_USE_NEON ]
+#endif // MP_FIXED_POINT && !MP_DSP_DISABLE_SIMD ]
+
+/// Vectors shorter than this are always processed by generic C code.
+#define MP_DSP_SIMD_MIN_LENGTH 16
+
+// MACROS
+
+#ifdef MP_DSP_SIMD // [
+  /// Call SIMD version of a vector function if one is selected.
+  /**
+  *  Must be used at the beginning of a vector function. \p kernel is the
+  *  name of the MpDspSimdKernels field and \p args is parenthesized list
+  *  of arguments to pass to it.
+  */
+#  define MP_DSP_SIMD_DISPATCH(kernel, dataLength, args)                    \
+   if ((dataLength) >= MP_DSP_SIMD_MIN_LENGTH &&                            \
+       spSimdKernels->kernel != NULL)                                       \
+   {                                                                        \
+      return spSimdKernels->kernel args;                                    \
+   }
+#else // MP_DSP_SIMD ][
+#  define MP_DSP_SIMD_DISPATCH(kernel, dataLength, args)
+#endif // MP_DSP_SIMD ]
+
+// TYPEDEFS
+
+  /// Instruction set used for vector functions of MpDspUtils.
+typedef enum
+{
+   MP_DSP_SIMD_NONE = 0, ///< Generic C code.
+   MP_DSP_SIMD_SSE2,     ///< x86 SSE2 (128-bit).
+   MP_DSP_SIMD_AVX2,     ///< x86 AVX2 (256-bit), falls back to SSE2.
+   MP_DSP_SIMD_NEON,     ///< ARM NEON (128-bit).
+
+   MP_DSP_SIMD_LEVELS_NUM ///< Number of SIMD levels. Not a valid level.
+} MpDspSimdLevel;
+
+// STRUCTS
+
+/**
+*  @brief Table of optimized versions of MpDspUtils vector functions.
+*
+*  Every field has exactly the signature and the semantics of the
+*  MpDspUtils function with the same name (the suffix tells the types of
+*  overloaded functions). NULL field means that there is no optimized
+*  version and generic C code is used. Optimized versions must produce
+*  bit-exact results, including saturation of corner values.
+*/
+struct MpDspSimdKernels
+{
+#ifdef MP_FIXED_POINT // [
+   OsStatus (*add_I)(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength);
+   OsStatus (*add_IGain)(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor);
+   OsStatus (*add_IAtt)(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor);
+   OsStatus (*add)(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pDst, int dataLength);
+   OsStatus (*addMul_I)(const int16_t *pSrc1, int16_t val, int32_t *pSrc2Dst, int dataLength);
+   OsStatus (*addMulLinear_I)(const int16_t *pSrc1, int16_t valStart, int16_t valEnd, int32_t *pSrc2Dst, int dataLength);
+   OsStatus (*mul)(const int16_t *pSrc, const int16_t val, int32_t *pDst, int dataLength);
+   OsStatus (*mul_I)(int16_t *pSrcDst, const int16_t val, int dataLength);
+   OsStatus (*mulLinear)(const int16_t *pSrc, int16_t valStart, int16_t valEnd, int32_t *pDst, int dataLength);
+   OsStatus (*convert32to16)(const int32_t *pSrc, int16_t *pDst, int dataLength);
+   OsStatus (*convert_Gain32to16)(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor);
+   OsStatus (*convert_Att32to16)(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor);
+   OsStatus (*convert16to32)(const int16_t *pSrc, int32_t *pDst, int dataLength);
+   OsStatus (*convert_Gain16to32)(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor);
+   OsStatus (*convert_Att16to32)(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor);
+#endif // MP_FIXED_POINT ]
+   int (*maxAbs16)(const int16_t *pSrc, int dataLength);
+   int16_t (*maximum16)(const int16_t *pSrc, int dataLength);
+   int32_t (*maximum32)(const int32_t *pSrc, int dataLength);
+   int16_t (*minimum16)(const int16_t *pSrc, int dataLength);
+   int32_t (*minimum32)(const int32_t *pSrc, int dataLength);
+   int32_t (*countClippedValues16)(const int16_t *pSrc, int dataLength);
+};
+
+#endif  // _MpDspUtilsSimd_h_
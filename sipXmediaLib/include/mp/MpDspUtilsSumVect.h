@@ -25,6 +25,8 @@
 
 OsStatus MpDspUtils::add_I(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(add_I, dataLength, (pSrc1, pSrc2Dst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       add_I(pSrc2Dst[i], (int32_t)pSrc1[i]);
@@ -34,6 +36,8 @@ OsStatus MpDspUtils::add_I(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLeng
 
 OsStatus MpDspUtils::add_IGain(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(add_IGain, dataLength, (pSrc1, pSrc2Dst, dataLength, src1ScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       add_I(pSrc2Dst[i], ((int32_t)pSrc1[i])<<src1ScaleFactor);
@@ -44,6 +48,8 @@ OsStatus MpDspUtils::add_IGain(const int16_t *pSrc1, int32_t *pSrc2Dst, int data
 
 OsStatus MpDspUtils::add_IAtt(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
 {
+   MP_DSP_SIMD_DISPATCH(add_IAtt, dataLength, (pSrc1, pSrc2Dst, dataLength, src1ScaleFactor));
+
    for (int i=0; i<dataLength; i++)
    {
       add_I(pSrc2Dst[i], (int32_t)pSrc1[i]>>src1ScaleFactor);
@@ -54,6 +60,8 @@ OsStatus MpDspUtils::add_IAtt(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataL
 
 OsStatus MpDspUtils::add(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pDst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(add, dataLength, (pSrc1, pSrc2, pDst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = add(pSrc1[i], pSrc2[i]);
@@ -63,6 +71,8 @@ OsStatus MpDspUtils::add(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pD
 
 OsStatus MpDspUtils::addMul_I(const int16_t *pSrc1, int16_t val, int32_t *pSrc2Dst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(addMul_I, dataLength, (pSrc1, val, pSrc2Dst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       addMul_I(pSrc2Dst[i], pSrc1[i], val);
@@ -74,6 +84,8 @@ OsStatus MpDspUtils::addMul_I(const int16_t *pSrc1, int16_t val, int32_t *pSrc2D
 OsStatus MpDspUtils::addMulLinear_I(const int16_t *pSrc1, int16_t valStart, int16_t valEnd,
                                     int32_t *pSrc2Dst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(addMulLinear_I, dataLength, (pSrc1, valStart, valEnd, pSrc2Dst, dataLength));
+
    // TODO:: This works fine only when (dataLength << (valStart - valEnd)).
    //        In other case we need smarter step value calculation, e.g.
    //        http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
@@ -91,6 +103,8 @@ OsStatus MpDspUtils::addMulLinear_I(const int16_t *pSrc1, int16_t valStart, int1
 
 OsStatus MpDspUtils::mul(const int16_t *pSrc, const int16_t val, int32_t *pDst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(mul, dataLength, (pSrc, val, pDst, dataLength));
+
    for (int i=0; i<dataLength; i++)
    {
       pDst[i] = pSrc[i]*val;
@@ -101,6 +115,8 @@ OsStatus MpDspUtils::mul(const int16_t *pSrc, const int16_t val, int32_t *pDst,
 
 OsStatus MpDspUtils::mul_I(int16_t *pSrcDst, const int16_t val, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(mul_I, dataLength, (pSrcDst, val, dataLength));
+
    const int16_t thresold = INT16_MAX/val;
    for (int i=0; i<dataLength; i++)
    {
@@ -124,6 +140,8 @@ OsStatus MpDspUtils::mul_I(int16_t *pSrcDst, const int16_t val, int dataLength)
 OsStatus MpDspUtils::mulLinear(const int16_t *pSrc, int16_t valStart, int16_t valEnd,
                                int32_t *pDst, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(mulLinear, dataLength, (pSrc, valStart, valEnd, pDst, dataLength));
+
    // TODO:: This works fine only when (dataLength << (valStart - valEnd)).
    //        In other case we need smarter step value calculation, e.g.
    //        http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
@@ -216,6 +234,8 @@ OsStatus MpDspUtils::mulLinear(const int16_t *pSrc, float valStart, float valEnd
 
 int MpDspUtils::maxAbs(const int16_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(maxAbs16, dataLength, (pSrc, dataLength));
+
    int16_t startValue = pSrc[0];
    if (startValue < 0)
       startValue = -startValue;
@@ -230,6 +250,8 @@ int MpDspUtils::maxAbs(const int16_t *pSrc, int dataLength)
 
 int16_t MpDspUtils::maximum(const int16_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(maximum16, dataLength, (pSrc, dataLength));
+
    int16_t val = pSrc[0];
    for (int i = 0; i < dataLength; i++)
       if (pSrc[i] > val) 
@@ -240,6 +262,8 @@ int16_t MpDspUtils::maximum(const int16_t *pSrc, int dataLength)
 
 int32_t MpDspUtils::maximum(const int32_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(maximum32, dataLength, (pSrc, dataLength));
+
    int32_t val = pSrc[0];
    for (int i = 0; i < dataLength; i++)
       if (pSrc[i] > val) 
@@ -250,6 +274,8 @@ int32_t MpDspUtils::maximum(const int32_t *pSrc, int dataLength)
 
 int16_t MpDspUtils::minimum(const int16_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(minimum16, dataLength, (pSrc, dataLength));
+
    int16_t val = pSrc[0];
    for (int16_t i = 0; i < dataLength; i++)
       if (pSrc[i] < val) 
@@ -260,6 +286,8 @@ int16_t MpDspUtils::minimum(const int16_t *pSrc, int dataLength)
 
 int32_t MpDspUtils::minimum(const int32_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(minimum32, dataLength, (pSrc, dataLength));
+
    int32_t val = pSrc[0];
    for (int32_t i = 0; i < dataLength; i++)
       if (pSrc[i] < val) 
@@ -270,6 +298,8 @@ int32_t MpDspUtils::minimum(const int32_t *pSrc, int dataLength)
 
 int32_t MpDspUtils::countClippedValues(const int16_t *pSrc, int dataLength)
 {
+   MP_DSP_SIMD_DISPATCH(countClippedValues16, dataLength, (pSrc, dataLength));
+
    int32_t clippedCount = 0;
    for (int32_t i = 0; i < dataLength; i++)
    {
@@ -0,0 +1,157 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpEncodedFrameCache_h_
+#define _MpEncodedFrameCache_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsDefs.h"
+#include "mp/MpBuf.h"
+#include "utl/UtlString.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Encoded audio frames of one flowgraph, shared by its encoders.
+*
+*  The conference bridge hands one buffer to all of the outputs which get
+*  the same mix, so in a large conference most of the encoders are fed the
+*  same buffer. Encoders of stateless codecs look the buffer up here
+*  before encoding it: the first one stores its encoding and the others
+*  copy it, so each distinct mix is encoded once per codec and packet
+*  size. Encoders with different packet times do not share frames. Every
+*  encoder still packs the data into its own packets, with its own
+*  timestamps, and sends them with its own MprToNet.
+*
+*  Entries are keyed by source buffer, codec key and frame number. An
+*  entry holds a reference to its source buffer, so the buffer can not be
+*  freed and reused for other audio while it is in the cache. Entries of
+*  older frames are replaced first.
+*
+*  The cache is only used while the flowgraph processes a frame, so it is
+*  not locked.
+*/
+class MpEncodedFrameCache
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      MAX_ENTRIES = 16 ///< Number of encodings kept.
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor.
+   MpEncodedFrameCache();
+
+     /// Destructor.
+   ~MpEncodedFrameCache();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Find the encoding of a buffer made during the given frame.
+   const unsigned char* find(const MpBufPtr& pSource,
+                             const UtlString& codecKey,
+                             int frameNum,
+                             int& rBytes);
+     /**<
+     *  @param[in]  pSource - buffer which was encoded.
+     *  @param[in]  codecKey - identifies the codec and its settings.
+     *  @param[in]  frameNum - number of the frame being processed.
+     *  @param[out] rBytes - size of the encoded data.
+     *
+     *  @returns Encoded data or NULL, if the buffer has not been encoded
+     *           with this codec yet.
+     */
+
+     /// Get space to store the encoding of a buffer.
+   unsigned char* store(const MpBufPtr& pSource,
+                        const UtlString& codecKey,
+                        int frameNum,
+                        int bytes);
+     /**<
+     *  The returned space is valid until the next call to store() or
+     *  reset() and should be filled before find() is called for the same
+     *  buffer.
+     */
+
+     /// Drop all entries and release their buffers.
+   void reset();
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Get number of encodings found in the cache.
+   inline int getHits() const;
+
+     /// Get number of encodings stored in the cache.
+   inline int getStores() const;
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   struct Entry
+   {
+      MpBufPtr mpSource;       ///< Buffer which was encoded.
+      UtlString mCodecKey;     ///< Codec it was encoded with.
+      int mFrameNum;           ///< Frame it was encoded in.
+      unsigned char* mpData;   ///< Encoded data.
+      int mDataSize;           ///< Allocated size of mpData.
+      int mBytes;              ///< Size of encoded data.
+   };
+
+   Entry mEntries[MAX_ENTRIES];
+   int mNextEntry;             ///< Entry to replace when all are current.
+   int mHits;
+   int mStores;
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   MpEncodedFrameCache(const MpEncodedFrameCache& rMpEncodedFrameCache);
+
+     /// Assignment operator (not implemented for this class)
+   MpEncodedFrameCache& operator=(const MpEncodedFrameCache& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+int MpEncodedFrameCache::getHits() const
+{
+   return mHits;
+}
+
+int MpEncodedFrameCache::getStores() const
+{
+   return mStores;
+}
+
+#endif  // _MpEncodedFrameCache_h_
@@ -118,6 +118,31 @@ public:
      *  @retval OS_SUCCESS - Success.
      */
 
+     /// Encode frames of several channels in one call
+   OsStatus encodeBatch(int numFrames,
+                        const MpAudioSample* const pAudioFrames[],
+                        int numSamples,
+                        unsigned char* const pCodeBufs[],
+                        int bytesLeft,
+                        int& rSizeInBytes);
+     /**<
+     *  Encodes \p numFrames independent frames of the same length, e.g.
+     *  the frames of many channels, with one call to the codec. Only
+     *  codecs which keep no state between frames support it, see
+     *  supportsBatch().
+     *
+     *  @param[in]  numFrames - Number of frames to encode.
+     *  @param[in]  pAudioFrames - Frames of PCM samples.
+     *  @param[in]  numSamples - Number of samples in each frame.
+     *  @param[out] pCodeBufs - Arrays for encoded data of each frame.
+     *  @param[in]  bytesLeft - Number of bytes available in each array.
+     *  @param[out] rSizeInBytes - Number of bytes written to each array.
+     *
+     *  @retval OS_SUCCESS - Success.
+     *  @retval OS_NOT_SUPPORTED - Codec does not support batch encoding.
+     *  @retval OS_INVALID_STATE - Encoder is not initialized.
+     *  @retval OS_FAILED - Codec failed to encode the frames.
+     */
 
 //@}
 
@@ -141,6 +166,12 @@ public:
 ///@name Inquiry
 //@{
 
+     /// Can this encoder encode several frames in one call?
+   UtlBoolean supportsBatch() const;
+     /**<
+     *  @see encodeBatch()
+     */
+
 //@}
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
@@ -45,6 +45,7 @@
 // FORWARD DECLARATIONS
 class MpFlowGraphMsg;
 class OsMsg;
+class MpEncodedFrameCache;
 
 /**
 *  @brief Flow graph for coordinating the execution of media processing resources.
@@ -387,6 +388,9 @@ public:
      /// Returns the current notification dispatcher, if any.  If none, returns NULL.
    inline OsMsgDispatcher* getNotificationDispatcher() const;
 
+     /// Returns the cache of encoded frames shared by the encoders.
+   inline MpEncodedFrameCache* getEncodedFrameCache();
+
      /// @brief Sets \p rpResource to point to the resource that corresponds
      /// to \p name or to NULL if no matching resource is found.
    OsStatus lookupResource(const UtlString& name,
@@ -651,6 +655,8 @@ private:
    int       mSamplesPerSec;   ///< number of samples per second
    MpResource* mpResourceInProcess; ///< @brief For debugging, keep track of what
                                ///< resource we are working on in processNextFrame().
+   MpEncodedFrameCache* mpEncodedFrameCache; ///< Frames encoded in this flow
+                               ///< graph, shared by encoders of the same mix.
    static const OsTime smProcessMessagesTimeout; ///< Timeout for receiving messages
                                ///< from the flowgraph queue.
 
@@ -820,6 +826,11 @@ OsMsgDispatcher* MpFlowGraphBase::getNotificationDispatcher(void) const
    return mNotifyDispatcher;
 }
 
+MpEncodedFrameCache* MpFlowGraphBase::getEncodedFrameCache()
+{
+   return mpEncodedFrameCache;
+}
+
 int MpFlowGraphBase::numLinks(void) const
 {
    return mLinkCnt;
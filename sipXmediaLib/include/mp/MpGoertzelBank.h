@@ -0,0 +1,144 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpGoertzelBank_h_
+#define _MpGoertzelBank_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsIntTypes.h"
+#include "mp/MpTypes.h"
+#include "utl/UtlDefs.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Bank of Goertzel filters, run over blocks of samples.
+*
+*  Runs the Goertzel recurrence for up to MAX_FREQS frequencies over a
+*  whole block of samples at once. Filters are processed in groups of
+*  FREQS_PER_GROUP, with the state of a group kept in local variables for
+*  the whole block, so the compiler can keep it in registers and run the
+*  independent filters of a group in SIMD lanes. The arithmetic of every
+*  filter is done in the same order as the classic per-sample code:
+*  q0 = coef*q1 - q2 + x, so results are exactly the same.
+*
+*  isBelowPower() is a cheap energy gate: it tells without running the
+*  filters that no frequency can reach a given power, so detectors can
+*  skip silent blocks.
+*/
+class MpGoertzelBank
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      MAX_FREQS = 16,      ///< Maximum number of frequencies in a bank.
+      FREQS_PER_GROUP = 4  ///< Number of filters run together.
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor.
+   MpGoertzelBank();
+     /**<
+     *  The bank has no frequencies until setCoefficients() is called.
+     */
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Set filter coefficients and reset the filters.
+   void setCoefficients(int numFreqs, const double coefs[]);
+     /**<
+     *  @param[in] numFreqs - number of frequencies, at most MAX_FREQS.
+     *  @param[in] coefs - coefficient of each frequency, i.e.
+     *             2*cos(2*pi*freq/samplesPerSec).
+     */
+
+     /// Reset filter state to start a new block.
+   void reset();
+
+     /// Run all filters over the given samples.
+   void process(const MpAudioSample *pSamples, int numSamples);
+     /**<
+     *  May be called several times for one block.
+     */
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Get number of frequencies in the bank.
+   inline int getNumFreqs() const;
+
+     /// Get power of every frequency over the samples processed since reset().
+   void getPowers(double powers[]) const;
+     /**<
+     *  @param[out] powers - array of getNumFreqs() values to fill.
+     */
+
+//@}
+
+/* ============================ INQUIRY =================================== */
+///@name Inquiry
+//@{
+
+     /// Is power of every frequency over these samples surely below given one?
+   static
+   UtlBoolean isBelowPower(const MpAudioSample *pSamples, int numSamples,
+                           double power);
+     /**<
+     *  Power of any frequency over a block is at most the square of the
+     *  sum of absolute sample values. This sum is compared against the
+     *  given power with a safety margin for rounding errors of the
+     *  filters, so when this returns TRUE the filters would give powers
+     *  below \p power. Loud blocks return FALSE after a few samples.
+     *
+     *  With \p power equal to zero it returns TRUE for blocks of zero
+     *  samples only, which give zero power at every frequency.
+     */
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   int mNumFreqs;             ///< Number of frequencies in use.
+   double mCoefs[MAX_FREQS];  ///< Filter coefficients, unused ones are 0.
+   double mQ1[MAX_FREQS];     ///< Last filter output.
+   double mQ2[MAX_FREQS];     ///< Filter output before the last one.
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+int MpGoertzelBank::getNumFreqs() const
+{
+   return mNumFreqs;
+}
+
+#endif  // _MpGoertzelBank_h_
@@ -19,6 +19,7 @@
 #include "utl/UtlHistogram.h"
 #include "os/OsDefs.h"
 #include "os/OsRWMutex.h"
+#include "os/OsCSem.h"
 #include "os/OsServerTask.h"
 #include "os/OsMsgPool.h"
 #include "os/OsCallback.h"
@@ -37,6 +38,7 @@
 
 // FORWARD DECLARATIONS
 class MpFlowGraphBase;
+class MpMediaTaskWorker;
 class OsNotification;
 
 /**
@@ -91,6 +93,17 @@ class OsNotification;
 *  time to finish the frame processing for the current interval and then wait
 *  for the "start" signal for the next frame before processing any more messages.
 *
+*  <H3>Worker threads</H3>
+*  By default all started flow graphs are processed one after another by the
+*  media processing task itself. If the task is created with a non-zero
+*  number of workers, each managed flow graph is bound to one
+*  MpMediaTaskWorker (the least loaded one at the time it is managed) and the
+*  frame processing is fanned out to the workers. Frame processing ends only
+*  when every worker has processed all its started flow graphs, so messages
+*  to the media task are still handled between frames while no flow graph is
+*  being processed. In this mode the frame processing time limit is checked
+*  by every worker separately, see getWorkerLimitExceededCnt().
+*
 *  @nosubgrouping
 */
 class MpMediaTask : public OsServerTask
@@ -110,7 +123,17 @@ public:
 
      /// Create the media processing task
    static MpMediaTask* createMediaTask(int maxFlowGraph,
-                                       UtlBoolean enableLocalAudio = true);
+                                       UtlBoolean enableLocalAudio = true,
+                                       int numWorkers = 0,
+                                       UtlBoolean pinWorkers = FALSE);
+     /**<
+     *  @param[in] maxFlowGraph - maximum number of managed flow graphs.
+     *  @param[in] enableLocalAudio - affects setFocus().
+     *  @param[in] numWorkers - number of worker threads to process flow
+     *             graphs in parallel. If 0, all flow graphs are processed
+     *             by the media task itself.
+     *  @param[in] pinWorkers - if TRUE, worker N is pinned to CPU N.
+     */
 
      /// Return a pointer to the media processing task if exists.
    static MpMediaTask* getMediaTask();
@@ -241,6 +264,24 @@ public:
      /// @brief Returns the number of times that the frame processing time limit 
      /// has been exceeded.
    int getLimitExceededCnt(void) const;
+     /**<
+     *  If worker threads are used, this is the sum of the counts of all
+     *  workers.
+     */
+
+     /// @brief Returns the number of times that the frame processing time limit
+     /// has been exceeded by the given worker thread.
+   int getWorkerLimitExceededCnt(int workerIndex) const;
+     /**<
+     *  @returns Count for the worker or -1 if there is no such worker.
+     */
+
+     /// Returns the number of worker threads processing flow graphs.
+   int numWorkers(void) const;
+
+     /// @brief Returns the index of the worker the flow graph is bound to or
+     /// -1 if it is not managed or worker threads are not used.
+   int getFlowGraphWorker(MpFlowGraphBase* pFlowGraph);
 
      /// @brief Returns an array of MpFlowGraphBase pointers that are presently
      /// managed by the media processing task.
@@ -330,7 +371,8 @@ public:
 protected:
 
      /// Default constructor
-   MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio);
+   MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio,
+               int numWorkers, UtlBoolean pinWorkers);
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
@@ -348,6 +390,11 @@ private:
                              ///< msgs until a FrameStart signal has been received
    MpFlowGraphBase* mpFocus; ///< FlowGraph that has the focus (may be NULL)
    MpFlowGraphBase** mManagedFGs; ///< The set of flow graphs presently managed
+   int*      mManagedFGWorkers; ///< Index of the worker each managed flow graph
+                             ///< is bound to (parallel to mManagedFGs).
+   int       mNumWorkers;    ///< Number of worker threads (0 if none)
+   MpMediaTaskWorker** mpWorkers; ///< Worker threads processing flow graphs
+   OsCSem*   mpWorkersDoneSem; ///< Released by workers when frame is processed
    static int mMaxFlowGraph;
    int       mLimitUsecs;    ///< Frame processing time limit (in usecs)
    int       mHandleMsgErrs; ///< @brief Number of message handling problems
@@ -442,6 +489,12 @@ private:
      *  @returns <b>FALSE</b> - otherwise.
      */
 
+     /// Process the next frame of all started flow graphs by worker threads.
+   void processFrameByWorkers();
+
+     /// Return index of the least loaded worker.
+   int selectWorker() const;
+
      /// Callback for flowgraph ticker.
    static
    void flowgraphTickerCallback(const intptr_t userData, const  intptr_t eventData);
@@ -0,0 +1,203 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpMediaTaskWorker_h_
+#define _MpMediaTaskWorker_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsDefs.h"
+#include "os/OsTask.h"
+#include "os/OsBSem.h"
+#include "os/OsCSem.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+
+// FORWARD DECLARATIONS
+class MpFlowGraphBase;
+
+/**
+*  @brief Worker thread used by MpMediaTask to process flow graphs in parallel.
+*
+*  When MpMediaTask is created with a non-zero number of workers, every
+*  managed flow graph is bound to one worker for its whole managed lifetime.
+*  On each frame tick the media task fills the frame list of every worker
+*  with its started flow graphs, releases the workers and waits until all
+*  of them have posted the shared "done" semaphore. Thus a flow graph is
+*  never processed by two threads at once and all flow graph control
+*  messages are still handled by the media task between ticks, while
+*  workers are idle.
+*
+*  Each worker measures its own frame processing time and keeps its own
+*  count of frames in which the time limit was exceeded.
+*/
+class MpMediaTaskWorker : public OsTask
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor
+   MpMediaTaskWorker(int workerIndex,
+                     int maxFlowGraphs,
+                     OsCSem &rDoneSem,
+                     int cpu = -1);
+     /**<
+     *  @param[in] workerIndex - index of this worker in the media task pool.
+     *  @param[in] maxFlowGraphs - maximum number of flow graphs that could
+     *             be processed by this worker in one frame.
+     *  @param[in] rDoneSem - semaphore released when the frame is processed.
+     *  @param[in] cpu - CPU to pin this worker to, -1 to not pin.
+     */
+
+     /// Destructor
+   virtual
+   ~MpMediaTaskWorker();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Remove all flow graphs from the list of the next frame.
+   void clearFrameList();
+     /**<
+     *  Must be called by the media task only while the worker is idle.
+     */
+
+     /// Add flow graph to the list of the next frame.
+   void addToFrameList(MpFlowGraphBase *pFlowGraph);
+     /**<
+     *  Must be called by the media task only while the worker is idle.
+     */
+
+     /// Start processing of the current frame list.
+   void signalFrameStart(int limitUsecs, UtlBoolean checkLimit);
+     /**<
+     *  Worker releases done semaphore when all flow graphs from the frame
+     *  list have been processed.
+     *
+     *  @param[in] limitUsecs - frame processing time limit (in usecs).
+     *  @param[in] checkLimit - if FALSE, do not check the time limit
+     *             (debug mode).
+     */
+
+     /// Note that a flow graph has been bound to this worker.
+   inline void incAssignedCnt();
+
+     /// Note that a flow graph has been unbound from this worker.
+   inline void decAssignedCnt();
+
+     /// @copydoc OsTask::requestShutdown()
+   virtual void requestShutdown(void);
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return index of this worker in the media task pool.
+   inline int getIndex() const;
+
+     /// Return number of flow graphs bound to this worker.
+   inline int getAssignedCnt() const;
+
+     /// Return number of flow graphs in the current frame list.
+   inline int getFrameListCnt() const;
+
+     /// @brief Returns the number of times that the frame processing time
+     /// limit has been exceeded by this worker.
+   inline int getLimitExceededCnt() const;
+
+     /// Return time (in usecs) spent processing the last frame.
+   inline int getLastFrameUsecs() const;
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+     /// @copydoc OsTask::run()
+   int run(void* pArg);
+
+     /// Pin the calling thread to mCpu if requested.
+   void pinToCpu();
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+   int       mIndex;         ///< Index of this worker in the pool
+   int       mCpu;           ///< CPU to pin this worker to, -1 if none
+   OsBSem    mStartSem;      ///< Released by the media task to start a frame
+   OsCSem   &mrDoneSem;      ///< Released by this worker when frame is done
+   MpFlowGraphBase **mpFrameFGs; ///< Flow graphs to process in current frame
+   int       mMaxFrameFGs;   ///< Size of mpFrameFGs array
+   int       mFrameFGsCnt;   ///< Number of flow graphs in the current frame
+   int       mAssignedCnt;   ///< Number of flow graphs bound to this worker
+   int       mLimitUsecs;    ///< Frame processing time limit (in usecs)
+   UtlBoolean mCheckLimit;   ///< Should we check the time limit?
+   int       mTimeLimitCnt;  ///< Number of frames where time limit was exceeded
+   int       mLastFrameUsecs;///< Time spent processing the last frame
+
+     /// Copy constructor (not implemented for this class)
+   MpMediaTaskWorker(const MpMediaTaskWorker& rMpMediaTaskWorker);
+
+     /// Assignment operator (not implemented for this class)
+   MpMediaTaskWorker& operator=(const MpMediaTaskWorker& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+void MpMediaTaskWorker::incAssignedCnt()
+{
+   mAssignedCnt++;
+}
+
+void MpMediaTaskWorker::decAssignedCnt()
+{
+   mAssignedCnt--;
+}
+
+int MpMediaTaskWorker::getIndex() const
+{
+   return mIndex;
+}
+
+int MpMediaTaskWorker::getAssignedCnt() const
+{
+   return mAssignedCnt;
+}
+
+int MpMediaTaskWorker::getFrameListCnt() const
+{
+   return mFrameFGsCnt;
+}
+
+int MpMediaTaskWorker::getLimitExceededCnt() const
+{
+   return mTimeLimitCnt;
+}
+
+int MpMediaTaskWorker::getLastFrameUsecs() const
+{
+   return mLastFrameUsecs;
+}
+
+#endif  // _MpMediaTaskWorker_h_
@@ -117,6 +117,11 @@ public:
 ///@name Manipulators
 //@{
 
+     /// Set optional batch functions (see DECLARE_BATCH_FUNCS_V1()).
+   inline
+   void setBatchFunctions(const dlPlgDecodeBatchV1 plgDecodeBatch,
+                          const dlPlgEncodeBatchV1 plgEncodeBatch);
+
 //@}
 
 /* ============================== ACCESSORS =============================== */
@@ -131,6 +136,10 @@ public:
    inline
    const UtlString& getModuleName() const;
 
+     /// Return name of the codec within its module.
+   inline
+   const UtlString& getCodecModuleName() const;
+
 //@}
 
 /* =============================== INQUIRY ================================ */
@@ -155,6 +164,8 @@ public:
    const dlPlgEncodeV1 mPlgEncode;
    const dlPlgFreeV1 mPlgFree;
    const dlPlgGetSignalingDataV1 mPlgSignaling;
+   dlPlgDecodeBatchV1 mPlgDecodeBatch; ///< NULL if codec has no batch decode.
+   dlPlgEncodeBatchV1 mPlgEncodeBatch; ///< NULL if codec has no batch encode.
 
 //@}
 
@@ -162,6 +173,7 @@ public:
 protected:
    UtlBoolean mbStatic;   ///< Is codec compiled-in or dynamically loaded?
    UtlString mModuleName; ///< Dynamic module name. Empty string for compiled-in codecs.
+   UtlString mCodecModuleName; ///< Codec name within the module, e.g. "sipxPcmu".
 
 /* /////////////////////////////// PRIVATE //////////////////////////////// */
 private:
@@ -206,10 +218,20 @@ MpCodecCallInfoV1::MpCodecCallInfoV1(const char* moduleName,
 , mPlgEncode(plgEncode)
 , mPlgFree(plgFree)
 , mPlgSignaling(plgSignaling)
+, mPlgDecodeBatch(NULL)
+, mPlgEncodeBatch(NULL)
 , mbStatic(bStatic)
 , mModuleName(moduleName)
+, mCodecModuleName(codecModuleName)
 {}
 
+void MpCodecCallInfoV1::setBatchFunctions(const dlPlgDecodeBatchV1 plgDecodeBatch,
+                                          const dlPlgEncodeBatchV1 plgEncodeBatch)
+{
+   mPlgDecodeBatch = plgDecodeBatch;
+   mPlgEncodeBatch = plgEncodeBatch;
+}
+
 const UtlBoolean MpCodecCallInfoV1::isStatic() const
 {
    return mbStatic;
@@ -225,4 +247,9 @@ const UtlString& MpCodecCallInfoV1::getModuleName() const
    return mModuleName;
 }
 
+const UtlString& MpCodecCallInfoV1::getCodecModuleName() const
+{
+   return mCodecModuleName;
+}
+
 #endif //_PlgStaff_h_
@@ -0,0 +1,281 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpPromptCache_h_
+#define _MpPromptCache_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsAtomics.h"
+#include "os/OsDefs.h"
+#include "os/OsIntTypes.h"
+#include "os/OsMutex.h"
+#include "os/OsStatus.h"
+#include "utl/UtlHashMap.h"
+#include "utl/UtlString.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Process-wide cache of decoded audio files.
+*
+*  Audio files played by MprFromFile are decoded, converted to mono and
+*  resampled to the flowgraph rate on every play request. When the same
+*  prompts are played to many callers, this cache keeps the result of
+*  the conversion, keyed by file path, file modification time and
+*  flowgraph sample rate, so every file is read and resampled only once
+*  per rate. A changed file gets a new key and is loaded again.
+*
+*  Cached audio is shared by all players - Prompt is reference counted and
+*  players read its data directly, without a private copy. Prompts which
+*  are not referenced are kept until the total size of cached audio
+*  exceeds the configured limit, then the least recently used ones are
+*  freed. Referenced prompts are never freed, so the limit could be
+*  exceeded while they are played.
+*
+*  If a cache directory is set, converted audio is also stored there as
+*  a raw PCM file with a small header and is memory-mapped instead of
+*  being kept on the heap. Such files survive restarts and could be shared
+*  by several processes. On platforms without mmap() the directory is
+*  ignored.
+*
+*  The cache is disabled unless its size limit is set to a non-zero value.
+*/
+class MpPromptCache
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+     /// Function to read and convert an audio file.
+   typedef OsStatus (*LoadFunc)(uint32_t sampleRate,
+                                UtlString*& pAudioBuffer,
+                                const char* fileName);
+     /**<
+     *  Has the same semantics as MprFromFile::readAudioFile().
+     */
+
+     /// Reference counted cached audio.
+   class Prompt
+   {
+   public:
+
+        /// Return pointer to audio samples (16 bit signed, native byte order).
+      inline const char* getData() const;
+
+        /// Return size of audio data in bytes.
+      inline unsigned getDataSize() const;
+
+        /// Add a reference to this prompt.
+      void addRef();
+
+        /// Release a reference to this prompt.
+      void release();
+        /**<
+        *  Never frees memory, so it is safe to be called from the media task.
+        *  Unreferenced prompts are freed by the cache later.
+        */
+
+   protected:
+      friend class MpPromptCache;
+
+      UtlString mKey;              ///< Cache key.
+      const char* mpData;          ///< Audio data.
+      unsigned mDataSize;          ///< Size of mpData in bytes.
+      UtlString* mpAudio;          ///< Loaded audio, if it is kept on the heap.
+      void* mpMapping;             ///< Start of the mapped file, if audio
+                                   ///< is mapped from the on-disk store.
+      size_t mMappingSize;         ///< Size of the mapped region.
+      OsAtomicInt mRefCount;       ///< Number of references.
+      int32_t mLastUsed;           ///< Cache use counter at the last access.
+
+        /// Constructor
+      Prompt(const UtlString& key);
+
+        /// Destructor
+      ~Prompt();
+
+   private:
+
+        /// Copy constructor (not implemented for this class)
+      Prompt(const Prompt& rPrompt);
+
+        /// Assignment operator (not implemented for this class)
+      Prompt& operator=(const Prompt& rhs);
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Return a pointer to the cache, creating it if needed.
+   static MpPromptCache* getPromptCache();
+
+     /// Destroy the cache.
+   static void destroyPromptCache();
+     /**<
+     *  Must not be called while any prompt is referenced.
+     */
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Set the limit of the total size of cached audio in bytes.
+   static void setMaxSize(size_t maxSize);
+     /**<
+     *  Zero disables the cache.
+     */
+
+     /// Set directory to store converted audio in.
+   static void setCacheDirectory(const UtlString& directory);
+     /**<
+     *  Empty string disables the on-disk store. Directory must exist.
+     */
+
+     /// Get a referenced prompt for the file, loading it on miss.
+   OsStatus acquire(const UtlString& fileName,
+                    uint32_t sampleRate,
+                    LoadFunc loadFunc,
+                    Prompt*& pPrompt);
+     /**<
+     *  File is loaded without holding the cache lock, so slow loads do not
+     *  block hits for other files.
+     *
+     *  @param[in] fileName - audio file to play.
+     *  @param[in] sampleRate - sample rate to convert audio to.
+     *  @param[in] loadFunc - function to load the file on miss.
+     *  @param[out] pPrompt - referenced prompt. Must be released by caller.
+     *
+     *  @returns OS_FILE_NOT_FOUND if the file does not exist.
+     *  @returns Result of \p loadFunc if it fails.
+     *  @returns OS_SUCCESS otherwise.
+     */
+
+     /// Free unreferenced prompts exceeding the size limit.
+   void trim();
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return the limit of the total size of cached audio.
+   static size_t getMaxSize();
+
+     /// Return total size of cached audio in bytes.
+   size_t getCachedSize() const;
+
+     /// Return number of cached prompts.
+   int getNumPrompts() const;
+
+     /// Return number of acquire() calls served from the cache.
+   inline int getNumHits() const;
+
+     /// Return number of acquire() calls which have loaded the file.
+   inline int getNumMisses() const;
+
+//@}
+
+/* ============================ INQUIRY =================================== */
+///@name Inquiry
+//@{
+
+     /// Is the cache enabled?
+   static UtlBoolean isEnabled();
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   static MpPromptCache* spInstance; ///< Cache singleton.
+   static OsMutex sLock;             ///< Guard for spInstance.
+   static size_t sMaxSize;           ///< Limit of cached audio size.
+   static UtlString sCacheDirectory; ///< Directory for converted audio.
+
+   mutable OsMutex mLock;   ///< Guard for the cache contents.
+   UtlHashMap mPrompts;     ///< Prompts, keyed by cache key.
+   size_t mCachedSize;      ///< Total size of cached audio.
+   int32_t mUseCounter;     ///< Counter used to order prompts by last use.
+   int mNumHits;            ///< Number of cache hits.
+   int mNumMisses;          ///< Number of cache misses.
+
+     /// Constructor
+   MpPromptCache();
+
+     /// Destructor
+   ~MpPromptCache();
+
+     /// Find prompt and add reference to it. Must be called with mLock held.
+   Prompt* findPrompt(const UtlString& key);
+
+     /// Add prompt to the cache. Must be called with mLock held.
+   void addPrompt(Prompt* pPrompt);
+
+     /// Free unreferenced prompts. Must be called with mLock held.
+   void trimLocked(size_t maxSize);
+
+     /// Build name of the on-disk file for the key.
+   static void getCacheFileName(const UtlString& key, UtlString& fileName);
+
+     /// Map converted audio from the on-disk store.
+   static Prompt* mapCacheFile(const UtlString& key);
+     /**<
+     *  @returns NULL if there is no valid file for the key.
+     */
+
+     /// Store converted audio to the on-disk store and map it.
+   static Prompt* storeCacheFile(const UtlString& key, const UtlString& audio);
+     /**<
+     *  @returns NULL if the file could not be written.
+     */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   MpPromptCache(const MpPromptCache& rMpPromptCache);
+
+     /// Assignment operator (not implemented for this class)
+   MpPromptCache& operator=(const MpPromptCache& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+const char* MpPromptCache::Prompt::getData() const
+{
+   return mpData;
+}
+
+unsigned MpPromptCache::Prompt::getDataSize() const
+{
+   return mDataSize;
+}
+
+int MpPromptCache::getNumHits() const
+{
+   return mNumHits;
+}
+
+int MpPromptCache::getNumMisses() const
+{
+   return mNumMisses;
+}
+
+#endif  // _MpPromptCache_h_
@@ -0,0 +1,291 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpRecorderWriter_h_
+#define _MpRecorderWriter_h_
+
+// SYSTEM INCLUDES
+
+// APPLICATION INCLUDES
+#include "os/OsDefs.h"
+#include "os/OsAtomics.h"
+#include "os/OsTask.h"
+#include "os/OsBSem.h"
+#include "os/OsRWMutex.h"
+#include "utl/UtlHashMap.h"
+#include "mp/MprRecorder.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+
+// FORWARD DECLARATIONS
+class MpFlowGraphBase;
+class MpResNotificationMsg;
+
+/**
+*  @brief Background task writing MprRecorder data to files.
+*
+*  When MprRecorder records to a file in asynchronous mode, it does not call
+*  write() from the media task. Instead every encoded frame is interlaced
+*  into a cell of a bounded lock-free queue and the per-process writer task
+*  drains the queue, collects data of every file in a large buffer and writes
+*  it out in chunks ending at WRITE_ALIGNMENT boundary of the file offset.
+*
+*  Queue has multiple producers (media task and its workers) and a single
+*  consumer (this task). Frames are never blocked on - if the queue is full,
+*  the frame is dropped and the overflow counter is incremented. Control
+*  commands (closing file and posting notifications) must never be dropped,
+*  so they do not take queue cells. They are pushed onto a separate
+*  lock-free list instead, which never makes the media task wait, even when
+*  the writer falls behind.
+*
+*  Every command remembers the queue position at the time it was queued and
+*  is processed once all cells before that position are processed, so WAV
+*  header is updated, file is closed and recorder notifications are posted
+*  only when all data recorded before has been written.
+*/
+class MpRecorderWriter : public OsTask
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum {
+      DEF_QUEUE_LENGTH = 1024,     ///< Default number of cells in the queue.
+      CELL_DATA_SIZE = 2048,       ///< Max amount of data in one queue cell.
+      WRITE_CHUNK_SIZE = 64*1024,  ///< Amount of data to collect before write.
+      WRITE_ALIGNMENT = 4096,      ///< File offset alignment of chunk ends.
+      FLUSH_INTERVAL_MS = 20       ///< Queue polling interval while files
+                                   ///< are open.
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Return a pointer to the writer task, creating and starting it if needed.
+   static MpRecorderWriter* getRecorderWriter();
+
+     /// Write out all queued data and destroy the writer task.
+   static void destroyRecorderWriter();
+     /**<
+     *  Files which have not been closed are left open, so the writer could
+     *  be created again and recording could continue.
+     */
+
+     /// Destructor
+   virtual
+   ~MpRecorderWriter();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Set number of cells in the queue of the writer to be created.
+   static void setQueueLength(int queueLength);
+     /**<
+     *  Must be called before the writer is created. Length is rounded up
+     *  to a power of 2.
+     */
+
+     /// Queue data to be written to a file.
+   OsStatus writeData(int fd, char* channelData[], int numChannels,
+                      int dataSize, int bytesPerSample);
+     /**<
+     *  Data of all channels is interlaced the same way synchronous
+     *  MprRecorder::writeFile() does this.
+     *
+     *  @param[in] fd - file to write to.
+     *  @param[in] channelData - data of every channel.
+     *  @param[in] numChannels - number of channels in \p channelData.
+     *  @param[in] dataSize - number of bytes in every channel.
+     *  @param[in] bytesPerSample - size of sample to interlace channels by.
+     *
+     *  @returns OS_SUCCESS if data has been queued.
+     *  @returns OS_LIMIT_REACHED if queue is full and data was dropped.
+     */
+
+     /// Post notification once all data queued for the file is written.
+   OsStatus postNotification(int fd,
+                             MpFlowGraphBase* pFlowGraph,
+                             MpResNotificationMsg* pMsg,
+                             OsAtomicInt* pPendingCnt);
+     /**<
+     *  @param[in] fd - file to flush or -1 to just wait until previously
+     *             queued commands are processed.
+     *  @param[in] pFlowGraph - flowgraph to post notification to.
+     *  @param[in] pMsg - notification to post. Writer takes ownership of it.
+     *  @param[in] pPendingCnt - counter which is incremented now and
+     *             decremented when the notification is posted.
+     */
+
+     /// Close file once all data queued for it is written.
+   OsStatus closeFile(int fd,
+                      MprRecorder::RecordFileFormat format,
+                      OsAtomicInt* pPendingCnt);
+     /**<
+     *  WAV header is updated before closing file, if \p format is not
+     *  MprRecorder::RAW_PCM_16.
+     *
+     *  @param[in] pPendingCnt - counter which is incremented now and
+     *             decremented when the file is closed.
+     */
+
+     /// @copydoc OsTask::requestShutdown()
+   virtual void requestShutdown(void);
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return number of frames dropped because the queue was full.
+   static int32_t getOverflowCount();
+
+     /// Return number of cells in the queue.
+   inline int getQueueLength() const;
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   typedef enum
+   {
+      CMD_NOTIFY, ///< Flush file and post notification.
+      CMD_CLOSE   ///< Flush file, update WAV header and close.
+   } CommandType;
+
+     /// Queue cell with data to be written to a file.
+   struct Cell
+   {
+      OsAtomicInt mSeq;      ///< Position in the queue this cell is ready for.
+      int mFd;
+      int mDataSize;
+      char mData[CELL_DATA_SIZE];
+   };
+
+     /// Control command.
+   struct Command
+   {
+      CommandType mType;
+      int mFd;
+      MprRecorder::RecordFileFormat mFormat;
+      MpFlowGraphBase* mpFlowGraph;
+      MpResNotificationMsg* mpMsg;
+      OsAtomicInt* mpPendingCnt;
+      int32_t mQueuePos;     ///< Queue position to process the command at.
+      Command* mpNext;
+   };
+
+     /// Data collected for one file.
+   struct FileState;
+
+   static MpRecorderWriter* spInstance; ///< Writer singleton.
+   static OsRWMutex sLock;              ///< Guard for spInstance.
+   static int sQueueLength;             ///< Length of the queue to create.
+   static OsAtomicInt sOverflowCnt;     ///< Number of dropped frames.
+
+   Cell* mpCells;             ///< Queue cells.
+   int mQueueMask;            ///< Number of cells minus 1.
+   OsAtomicInt mEnqueuePos;   ///< Next position to queue to.
+   OsAtomicInt mDequeuePos;   ///< Next position to dequeue from.
+   OsAtomic<Command*> mpNewCommands; ///< Stack of commands not taken yet.
+   Command* mpCommands;       ///< Taken commands in the order of queuing.
+   Command* mpLastCommand;    ///< Last of the taken commands.
+   OsAtomicInt mIsIdle;       ///< Is writer waiting for a wakeup?
+   OsBSem mWakeupSem;         ///< Semaphore to wake up the writer.
+   UtlHashMap mFiles;         ///< Files with collected data, keyed by fd.
+
+     /// Constructor
+   MpRecorderWriter(int queueLength);
+
+     /// Reserve consecutive cells to fill.
+   Cell* reserveCells(int32_t& pos, int numCells);
+     /**<
+     *  @param[out] pos - position of the first reserved cell. Cells must be
+     *              committed in order of their positions.
+     *  @param[in] numCells - number of cells to reserve, at most the queue
+     *             length.
+     *
+     *  @returns First reserved cell or NULL if there is no room for
+     *           \p numCells cells.
+     */
+
+     /// Make filled cell available to the writer.
+   void commitCell(Cell* pCell, int32_t pos);
+
+     /// Queue a control command.
+   OsStatus queueCommand(CommandType type, int fd,
+                         MprRecorder::RecordFileFormat format,
+                         MpFlowGraphBase* pFlowGraph,
+                         MpResNotificationMsg* pMsg,
+                         OsAtomicInt* pPendingCnt);
+
+     /// Process all cells in the queue and the commands due.
+   int processQueue();
+     /**<
+     *  @returns Number of processed cells and commands.
+     */
+
+     /// Move newly queued commands to the end of the taken ones.
+   void takeNewCommands();
+
+     /// Process commands queued before the current queue position.
+   int processCommands();
+     /**<
+     *  @returns Number of processed commands.
+     */
+
+     /// Collect data of one cell.
+   void processCell(Cell* pCell);
+
+     /// Process one command.
+   void processCommand(Command* pCommand);
+
+     /// Find or create collected data of the file.
+   FileState* getFileState(int fd);
+
+     /// Write collected data out.
+   void flushFile(FileState* pFile, UtlBoolean all);
+     /**<
+     *  @param[in] all - if FALSE, only write data up to the last
+     *             WRITE_ALIGNMENT boundary.
+     */
+
+     /// Write collected data of all files out.
+   void flushAll();
+
+     /// @copydoc OsTask::run()
+   int run(void* pArg);
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   MpRecorderWriter(const MpRecorderWriter& rMpRecorderWriter);
+
+     /// Assignment operator (not implemented for this class)
+   MpRecorderWriter& operator=(const MpRecorderWriter& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+int MpRecorderWriter::getQueueLength() const
+{
+   return mQueueMask + 1;
+}
+
+#endif  // _MpRecorderWriter_h_
@@ -85,6 +85,35 @@ public:
      *  @copydoc MpResamplerBase::resampleInterleavedStereo()
      */
 
+     /// Resample audio data of several channels at once.
+   virtual OsStatus resampleChannels(uint32_t numChannels,
+                                     const MpAudioSample* const pInBufs[],
+                                     uint32_t inBufLength,
+                                     uint32_t& inSamplesProcessed,
+                                     MpAudioSample* const pOutBufs[],
+                                     uint32_t outBufLength,
+                                     uint32_t& outSamplesWritten);
+     /**<
+     *  Channels 0 to \p numChannels-1 are processed, each from its own
+     *  input buffer to its own output buffer. All channels are converted
+     *  with the same rates and have the same amount of input, so the same
+     *  number of samples is processed and written for every one of them.
+     *  Channels processed this way should not be passed to resample(), so
+     *  they stay in step.
+     *
+     *  The default implementation calls resample() for every channel.
+     *
+     *  @param[in] numChannels - The number of channels to process.
+     *  @param[in] pInBufs - Audio of every channel to resample.
+     *  @param[out] pOutBufs - Buffers for resampled audio of every channel.
+     *  @see resampleInterleavedStereo() for the other parameters.
+     *
+     *  @retval OS_INVALID_ARGUMENT if \p numChannels is more than the number
+     *          of channels of the resampler.
+     *  @retval OS_INVALID_STATE if the channels are not in step.
+     *  @retval OS_SUCCESS if the audio was resampled successfully.
+     */
+
      /// Resample interleaved stereo audio data.
    virtual OsStatus resampleInterleavedStereo(const MpAudioSample* pInBuf,
                                               uint32_t inBufLength,
@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _MpResamplerPolyphase_h_
+#define _MpResamplerPolyphase_h_
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "mp/MpResampler.h"
+#include "os/OsMutex.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Polyphase FIR resampler for small rational rate ratios.
+*
+*  Converts between rates whose ratio reduces to up/down with both factors
+*  at most MAX_FACTOR, i.e. between any of 8000, 16000, 24000, 32000 and
+*  48000 Hz. The filter is a Kaiser windowed sinc with Q15 coefficients,
+*  split into one phase per up factor. Each phase is normalized to unity
+*  DC gain. The inner loop is a 16-bit dot product, which is done with
+*  SSE2 or NEON when available. Integer arithmetic never overflows here, so
+*  all versions give exactly the same output.
+*
+*  Filter tables are built once per rate ratio and shared by all instances
+*  for the life of the process. An instance keeps only the input history
+*  and the position of every channel.
+*
+*  resampleChannels() runs all channels with the same rate pair in one
+*  call. Channels share the position, so every output sample is computed
+*  for BATCH_CHANNELS channels at once: coefficients are loaded once and
+*  the sums are reduced and rounded together.
+*
+*  Other ratios are handled by MpResamplerBase::resample().
+*/
+class MpResamplerPolyphase : public MpResamplerBase
+{
+/* //////////////////////////////// PUBLIC //////////////////////////////// */
+public:
+
+   enum
+   {
+      MAX_FACTOR = 6,        ///< Maximum up and down factors of a ratio.
+      ZERO_CROSSINGS = 8,    ///< Zero crossings of the sinc on each side.
+      BATCH_CHANNELS = 4     ///< Channels filtered together.
+   };
+
+/* =============================== CREATORS =============================== */
+///@name Creators
+//@{
+
+   MpResamplerPolyphase(uint32_t numChannels,
+                        uint32_t inputRate,
+                        uint32_t outputRate,
+                        int32_t quality = -1);
+     /**<
+     *  @copydoc MpResamplerBase::MpResamplerBase(uint32_t,uint32_t,uint32_t,int32_t)
+     *  Quality is not used. Latency is ZERO_CROSSINGS samples of the lower
+     *  of the rates.
+     */
+
+   ~MpResamplerPolyphase();
+     /**<
+     *  @copydoc MpResamplerBase::~MpResamplerBase()
+     */
+
+//@}
+
+/* ============================= MANIPULATORS ============================= */
+///@name Manipulators
+//@{
+
+   OsStatus resetStream();
+     /**<
+     *  @copydoc MpResamplerBase::resetStream()
+     */
+
+   OsStatus resample(uint32_t channelIndex,
+                     const MpAudioSample* pInBuf,
+                     uint32_t inBufLength,
+                     uint32_t& inSamplesProcessed,
+                     MpAudioSample* pOutBuf,
+                     uint32_t outBufLength,
+                     uint32_t& outSamplesWritten);
+     /**<
+     *  @copydoc MpResamplerBase::resample()
+     */
+
+   OsStatus resampleChannels(uint32_t numChannels,
+                             const MpAudioSample* const pInBufs[],
+                             uint32_t inBufLength,
+                             uint32_t& inSamplesProcessed,
+                             MpAudioSample* const pOutBufs[],
+                             uint32_t outBufLength,
+                             uint32_t& outSamplesWritten);
+     /**<
+     *  @copydoc MpResamplerBase::resampleChannels()
+     */
+
+   OsStatus setInputRate(const uint32_t inputRate);
+     /**<
+     *  @copydoc MpResamplerBase::setInputRate()
+     *  Resets the stream.
+     */
+
+   OsStatus setOutputRate(const uint32_t outputRate);
+     /**<
+     *  @copydoc MpResamplerBase::setOutputRate()
+     *  Resets the stream.
+     */
+
+//@}
+
+/* =============================== INQUIRY ================================ */
+///@name Inquiry
+//@{
+
+     /// Is conversion between these rates done by the polyphase filter?
+   static
+   UtlBoolean isRatioSupported(uint32_t inputRate, uint32_t outputRate);
+
+//@}
+
+/* ////////////////////////////// PROTECTED /////////////////////////////// */
+protected:
+
+     /// Polyphase filter of one rate ratio, shared by all resamplers.
+   struct Filter
+   {
+      uint32_t mUpFactor;     ///< Number of phases.
+      uint32_t mDownFactor;   ///< Input step of one output sample, in phases.
+      int mTapsPerPhase;      ///< Multiple of 8.
+      int16_t *mpCoefs;       ///< Coefficients of every phase, in the order
+                              ///< they multiply input samples.
+   };
+
+     /// Get the shared filter of a ratio, build it on first use.
+   static
+   const Filter *getFilter(uint32_t upFactor, uint32_t downFactor);
+
+     /// Build the filter of a ratio.
+   static
+   Filter *createFilter(uint32_t upFactor, uint32_t downFactor);
+
+     /// Select filter for current rates and reallocate channel state.
+   void initFilter();
+
+     /// Copy history of a channel and a chunk of its input to a slot of mpWork.
+   void loadChunk(uint32_t channelIndex, const MpAudioSample* pInBuf,
+                  uint32_t numSamples, uint32_t slot);
+
+     /// Filter chunks in the first slots of mpWork, starting at given position.
+   uint32_t filterChunk(uint32_t& position,
+                        uint32_t numSamples,
+                        uint32_t numSlots,
+                        MpAudioSample* const pOutBufs[],
+                        uint32_t outBufLength) const;
+     /**<
+     *  @param[in,out] position - position of next output sample, it is
+     *                 advanced past the written samples.
+     *  @param[in] numSamples - number of input samples in every chunk.
+     *  @param[in] numSlots - number of slots to filter, at most
+     *             BATCH_CHANNELS.
+     *  @param[out] pOutBufs - output buffer of every slot.
+     *
+     *  @returns Number of samples written to every buffer.
+     */
+
+     /// Store history of a channel after consuming samples of a slot.
+   void saveHistory(uint32_t channelIndex, uint32_t numConsumed,
+                    uint32_t slot);
+
+   const Filter *mpFilter;     ///< Filter of current rates or NULL.
+   MpAudioSample *mpHistory;   ///< Last (taps-1) input samples of every channel.
+   uint32_t *mpPositions;      ///< Position of next output sample of every
+                               ///< channel, in phases from the oldest
+                               ///< history sample.
+   MpAudioSample *mpWork;      ///< BATCH_CHANNELS slots of history followed
+                               ///< by a chunk of input.
+   uint32_t mWorkSlotLength;   ///< Length of one slot of mpWork.
+
+   static Filter *spFilters[MAX_FACTOR][MAX_FACTOR]; ///< Filters by ratio.
+   static OsMutex sFiltersLock; ///< Guard for spFilters.
+
+/* /////////////////////////////// PRIVATE //////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   MpResamplerPolyphase(const MpResamplerPolyphase& rMpResamplerPolyphase);
+
+     /// Assignment operator (not implemented for this class)
+   MpResamplerPolyphase& operator=(const MpResamplerPolyphase& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _MpResamplerPolyphase_h_
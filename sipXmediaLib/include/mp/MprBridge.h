@@ -74,7 +74,16 @@ public:
    MprBridge(const UtlString& rName,
              int maxInOutputs,
              UtlBoolean mixSilence=TRUE,
-             AlgType algorithm=ALG_LINEAR);
+             AlgType algorithm=ALG_LINEAR,
+             int maxActiveSpeakers=0);
+     /**<
+     *  @param[in] maxActiveSpeakers - maximum number of inputs mixed in one
+     *             frame, 0 to mix all of them. In a large conference only
+     *             a few participants talk at once, so limiting mixing to
+     *             the loudest talkers makes its cost depend on the number
+     *             of talkers rather than on the number of participants.
+     *             Supported by ALG_LINEAR only.
+     */
 
      /// Destructor
    virtual
@@ -171,6 +180,7 @@ protected:
    AlgType mAlgType;              ///< Type of the bridge algorithm to use.
    MpBridgeAlgBase *mpBridgeAlg;  ///< Instance of algorithm, used to mix data.
    UtlBoolean mMixSilence;        ///< Should Bridge ignore or mix frames marked as silence?
+   int mMaxActiveSpeakers;        ///< Maximum number of inputs to mix, 0 if not limited.
 
 #ifdef PRINT_CLIPPING_STATS
    int mClippedFramesCounted;
@@ -45,12 +45,14 @@ public:
     MprBridgeConstructor(int minInOutputs = 1,
                          int maxInOutputs = DEFAULT_BRIDGE_MAX_IN_OUTPUTS,
                          UtlBoolean mixSilence=TRUE,
-                         MprBridge::AlgType algorithm=MprBridge::ALG_LINEAR)
+                         MprBridge::AlgType algorithm=MprBridge::ALG_LINEAR,
+                         int maxActiveSpeakers=0)
     : MpAudioResourceConstructor(DEFAULT_BRIDGE_RESOURCE_TYPE,
                                  minInOutputs, maxInOutputs, //minInputs, maxInputs,
                                  minInOutputs, maxInOutputs) //minOutputs, maxOutputs
     , mMixSilence(mixSilence)
     , mAlgorithm(algorithm)
+    , mMaxActiveSpeakers(maxActiveSpeakers)
     {
     };
 
@@ -68,7 +70,8 @@ public:
         assert(maxResourcesToCreate >= 1);
         numResourcesCreated = 1;
         resourceArray[0] = new MprBridge(resourceName, mMaxInputs,
-                                         mMixSilence, mAlgorithm);
+                                         mMixSilence, mAlgorithm,
+                                         mMaxActiveSpeakers);
         resourceArray[0]->enable();
         return(OS_SUCCESS);
     }
@@ -82,6 +85,7 @@ protected:
 
    UtlBoolean         mMixSilence;
    MprBridge::AlgType mAlgorithm;
+   int                mMaxActiveSpeakers;
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
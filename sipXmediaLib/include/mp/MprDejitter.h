@@ -35,6 +35,14 @@
 *
 *  This class is not thread-safe. For thread-safety it relies on external
 *  synchronization mechanisms in MprDecode.
+*
+*  Packets are stored in a ring indexed by RTP sequence number modulo
+*  MAX_RTP_PACKETS. As long as all stored packets fit into a window of
+*  MAX_RTP_PACKETS sequence numbers, ring order is the same as sequence order,
+*  so index of the packet with minimum sequence number (head of the ring)
+*  is maintained incrementally and push/pull are O(1). Only when the stream
+*  jumps so that the window is exceeded we fall back to a full scan of the
+*  ring until the window is restored.
 */
 class MprDejitter
 {
@@ -140,6 +148,14 @@ public:
 
       /// Get RTP header info. for first sequentially available packet
    OsStatus getFirstPacketInfo(RtpSeq& packetSeq, RtpTimestamp& packetTime) const;
+     /**<
+     *  First packet is the one which will be returned by next call to
+     *  pullPacket(), i.e. sequence numbers are compared with respect to
+     *  wrap around.
+     *
+     *  @return OS_SUCCESS if buffer is not empty.
+     *  @return OS_FAILED if buffer is empty.
+     */
 
 //@}
 
@@ -175,6 +191,30 @@ protected:
    UtlString     mFlowgraphName;
                   /// Resource name for debug purposes.
    UtlString     mResourceName;
+                  /// Index of the packet with minimum sequence number,
+                  /// -1 if buffer is empty.
+   int           mHeadIdx;
+                  /// Maximum sequence number in the buffer. Valid only if
+                  /// mIsRingOrdered is TRUE.
+   RtpSeq        mTailSeq;
+                  /// Are all packets in the buffer within MAX_RTP_PACKETS
+                  /// sequence numbers from the head?
+   UtlBoolean    mIsRingOrdered;
+
+     /// Find index of the packet with minimum sequence number by full scan.
+   int findMinSeqIndex() const;
+     /**<
+     *  @returns Index of the found packet or -1 if buffer is empty.
+     */
+
+     /// Recalculate head and tail of the ring by full scan.
+   void rescanRing();
+
+     /// Update head and tail of the ring after the packet has been stored.
+   void updateRingOnPush(int index);
+
+     /// Update head and tail of the ring after the head has been pulled.
+   void updateRingOnPull();
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
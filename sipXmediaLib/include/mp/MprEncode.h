@@ -176,6 +176,12 @@ private:
    UtlBoolean mDoG722Hack;       ///< Should we apply RTP clock rate halving to
                                  ///< workaround G.722 spec bug? See mEnableG722Hack
                                  ///< for better description.
+   UtlString mSharedCodecKey;    ///< Key of the codec and packet size in
+                                 ///< the flowgraph's MpEncodedFrameCache,
+                                 ///< empty if encoding can not be shared
+                                 ///< with other encoders.
+   int   mSharedBytesPerSample;  ///< Encoded size of one sample of a codec
+                                 ///< with mSharedCodecKey.
 //@}
 
 ///@name Resampler-related variables.
@@ -242,6 +248,17 @@ private:
      /// Encode audio buffer and send it.
    void doPrimaryCodec(MpAudioBufPtr in);
 
+     /// Get the encoding of a frame from the flowgraph's MpEncodedFrameCache.
+   const unsigned char* encodeShared(const MpAudioBufPtr& in,
+                                     const MpAudioSample* pSamples,
+                                     int numSamples);
+     /**<
+     *  Encodes the frame and stores the encoding if no other encoder has
+     *  done it during this frame yet.
+     *
+     *  @returns Encoded samples or NULL on failure.
+     */
+
      /// Encode and send DTMF tone.
    void doDtmfCodec(int samplesPerFrame, int samplesPerSecond);
 
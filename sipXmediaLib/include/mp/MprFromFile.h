@@ -21,6 +21,7 @@
 #include "os/OsProtectEvent.h"
 #include "mp/MpResourceMsg.h"
 #include "mp/MpResNotificationMsg.h"
+#include "mp/MpPromptCache.h"
 
 // DEFINES
 // MACROS
@@ -105,6 +106,10 @@ public:
      *  is received, the above resource will then begin playing the file
      *  specified.
      *
+     *  If MpPromptCache is enabled, converted audio is taken from the cache
+     *  and shared with other players of the same file instead of reading
+     *  and resampling the file again.
+     *
      *  @param[in]  namedResource - the name of the resource to send a message to.
      *  @param[in]  fgQ - the queue of the flowgraph containing the resource which
      *              the message is to be received by.
@@ -227,7 +232,11 @@ private:
 
    static const unsigned int sFromFileReadBufferSize;
 
-   UtlString* mpFileBuffer;
+   UtlString* mpFileBuffer;     ///< Private audio buffer, if any.
+   MpPromptCache::Prompt* mpPrompt; ///< Shared cached audio, if any.
+   const char* mpPlayData;      ///< Audio being played, either from
+                                ///< mpFileBuffer or from mpPrompt.
+   int mPlayDataLength;         ///< Size of mpPlayData in bytes.
    int mFileBufferIndex;
    UtlBoolean mFileRepeat;
    State mState;
@@ -329,8 +338,17 @@ private:
                                      int samplesPerSecond);
 
      /// Initialize things to start playing the given buffer, upon receiving request to start.
-   UtlBoolean handlePlay(UtlString* pBuffer, UtlBoolean repeat,
+   UtlBoolean handlePlay(UtlString* pBuffer,
+                         MpPromptCache::Prompt* pPrompt,
+                         UtlBoolean repeat,
                          UtlBoolean autoStopAfterFinish);
+     /**<
+     *  Either \p pBuffer or \p pPrompt should be set. Resource takes
+     *  ownership of \p pBuffer and of the reference to \p pPrompt.
+     */
+
+     /// Free audio buffer being played.
+   void freePlayData();
 
      /// Handle playback finish when the end of file/buffer is reached.
    UtlBoolean handleFinish();
@@ -24,6 +24,7 @@
 #endif /* _WIN32 ] */
 
 // APPLICATION INCLUDES
+#include "os/OsAtomics.h"
 #include "os/OsMutex.h"
 #include "mp/MpResourceMsg.h"
 #include "mp/MpAudioResource.h"
@@ -46,10 +47,23 @@
 // FORWARD DECLARATIONS
 class MpEncoderBase;
 class MpResamplerBase;
-
-/// The "Recorder" media processing resource
+class MpRecorderWriter;
+
+/**
+*  @brief The "Recorder" media processing resource
+*
+*  By default recording to a file calls write() right from doProcessFrame().
+*  In asynchronous file write mode (see setAsyncFileWrite()) recorded data
+*  is passed to MpRecorderWriter task instead, which writes it out in large
+*  chunks. In this mode WAV header is updated and the file is closed by the
+*  writer, and recorder notifications are posted only after all data recorded
+*  before has been written. If the writer queue is full, frames are dropped
+*  and counted by MpRecorderWriter::getOverflowCount().
+*/
 class MprRecorder : public MpAudioResource
 {
+   friend class MpRecorderWriter;
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 public:
 
@@ -171,6 +185,12 @@ public:
      *  @param[in] fgQ - flowgraph queue to send command to.
      */
 
+     /// Enable or disable asynchronous file write mode.
+   static void setAsyncFileWrite(UtlBoolean enable);
+     /**<
+     *  Takes effect for recordings started after this call.
+     */
+
 //@}
 
 /* ============================ ACCESSORS ================================= */
@@ -183,6 +203,9 @@ public:
 ///@name Inquiry
 //@{
 
+     /// Is asynchronous file write mode enabled?
+   static UtlBoolean isAsyncFileWrite();
+
 //@}
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
@@ -234,6 +257,12 @@ protected:
 //@{
    int mFileDescriptor;     ///< File descriptor to write to.
    RecordFileFormat mRecFormat; ///< Should data be written in WAV or RAW PCM format.
+   UtlBoolean mAsyncFileWrite; ///< Is current file written by MpRecorderWriter?
+   int mDroppedFrames;      ///< Frames dropped because writer queue was full.
+   OsAtomicInt mPendingAsyncOps; ///< Number of commands queued to
+                            ///< MpRecorderWriter which refer to this recorder.
+   static UtlBoolean sAsyncFileWrite; ///< Should new files be written
+                            ///< asynchronously?
 //@}
 
 ///@name Buffer-related variables
@@ -311,6 +340,13 @@ protected:
      /// Close file if it is opened and  update WAV header if needed.
    void closeFile(const char* fromWhereLabel);
 
+     /// Send notification after all data recorded so far is written.
+   void sendNotificationAfterFlush(MpResNotificationMsg& msg);
+     /**<
+     *  Sends notification immediately, unless asynchronous file write is
+     *  in progress.
+     */
+
    typedef int (MprRecorder::*WriteMethod)(char * channelBuffers[], int);
 
      /// Write silence to the file
@@ -13,6 +13,7 @@
 #include <mp/MpFlowGraphMsg.h>
 #include <mp/MpResourceMsg.h>
 #include <mp/MpAudioResource.h>
+#include <mp/MpGoertzelBank.h>
 
 // DEFINES
 // MACROS
@@ -26,6 +27,10 @@
 /**
 *  @brief The "Tone Detector" media processing resource
 *
+*  Samples are collected into blocks of mBlockSize samples. A window is
+*  applied to a full block and the Goertzel filter (MpGoertzelBank) is run
+*  over it at once. Blocks of silence (zero samples or no input buffer)
+*  have zero magnitude, so the window and the filter are skipped for them.
 */
 class MprToneDetect : public MpAudioResource
 {
@@ -127,9 +132,8 @@ private:
    static const unsigned DEFAULT_BLOCK_SIZE;
    static const int DEFAULT_WINDOW_SIZE;
 
-   double mCoeff;
-   double mQ1;
-   double mQ2;
+   MpGoertzelBank mBank;   ///< Filter of the target frequency.
+   MpAudioSample *mpBlock; ///< Samples of the current block.
    double mThreshold;
    double mTargetFreq;
    unsigned mBlockCnt;
@@ -142,10 +146,9 @@ private:
    MpFlowGraphBase* mpFlowGraph;
 
    double *mFilterData;
-   void resetGoertzel(void);
    void initGoertzel(void);
-   void processSample(MpAudioSample sample);
-   double getMagnitudeSquared(void);
+     /// Run the filter over a full block, returns magnitude of the block.
+   double processBlock(void);
    void initFilter();
    double filterSample(MpAudioSample sample, uint32_t n);
 };
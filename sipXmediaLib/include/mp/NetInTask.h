@@ -37,6 +37,12 @@
 #define RTP_MTU  (UDP_MTU-12) ///< Maximum Transmission Unit for RTP packet.
 #define RTCP_MTU (UDP_MTU-12)
 
+/// @brief Use epoll()/recvmmsg() based receive engine with optional
+/// several receive threads instead of select() over a fixed socket table.
+#if defined(__linux__) && !defined(ANDROID) // [
+#  define NET_IN_TASK_USE_EPOLL
+#endif // __linux__ && !ANDROID ]
+
 #define RTP_DIR_IN  1
 #define RTP_DIR_OUT 2
 #define RTP_DIR_NEW 4
@@ -47,6 +53,7 @@
 // CONSTANTS
 // FORWARD DECLARATIONS
 class MprFromNet;
+class NetInReceiver;
 class OsConnectionSocket;
 class OsServerSocket;
 class OsSocket;
@@ -90,10 +97,26 @@ extern void FinishRtpSession(rtpHandle h);
 /**
 *  @brief Task that listen for packets in incoming RTP streams.
 *
+*  Sockets are added and removed by messages sent over the internal command
+*  connection, so all changes of the set of sockets are done by the thread
+*  which reads from them.
+*
+*  When NET_IN_TASK_USE_EPOLL is defined (Linux), sockets are watched with
+*  epoll and every ready socket is drained with recvmmsg() directly into
+*  MpUdpBuf buffers. There is no limit on the number of sockets and adding or
+*  removing a socket pair takes constant time. Sockets could be spread over
+*  several receive threads (see setNumReceiveThreads()). Both sockets of one
+*  MprFromNet are always served by the same thread, so MprFromNet::pushPacket()
+*  is never called concurrently for one resource. A thread reads at most its
+*  share of the buffers left in MpMisc.UdpPool at once, so one busy thread
+*  never starves the others. On other platforms select() over a fixed table
+*  of socket pairs is used.
+*
 *  @nosubgrouping
 */
 class NetInTask : public OsTask
 {
+   friend class NetInReceiver;
 
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 public:
@@ -131,12 +154,22 @@ public:
 
    OsStatus removeNetInputSources(MprFromNet* fwdTo, OsNotification* note);
 
+     /// Set number of receive threads to use.
+   static void setNumReceiveThreads(int numThreads);
+     /**<
+     *  Takes effect only if called before the NetInTask instance is created.
+     *  Ignored when NET_IN_TASK_USE_EPOLL is not defined.
+     */
+
 //@}
 
 /* ============================ ACCESSORS ================================= */
 ///@name Accessors
 //@{
 
+     /// Return number of receive threads, including this task.
+   int getNumReceiveThreads() const;
+
 //@}
 
 /* ============================ INQUIRY =================================== */
@@ -154,10 +187,16 @@ protected:
    static OsRWMutex  sLock;         ///< semaphore used to ensure that there
                                     ///<  is only one instance of this class
 
-   OsConnectionSocket* mpWriteSocket;
-   OsConnectionSocket* mpReadSocket;
+   static int        sNumReceiveThreads; ///< Number of receive threads
+                                    ///<  to create with the next instance.
+
+   OsConnectionSocket* mpWriteSocket; ///< Not used in epoll mode.
+   OsConnectionSocket* mpReadSocket;  ///< Not used in epoll mode.
    int                 mCmdPort;    ///< internal socket port number
    OsMutex             mEventMutex;
+   int                 mNumReceivers; ///< Number of receive threads.
+   NetInReceiver     **mpReceivers; ///< Receive engines (epoll mode only).
+                                    ///<  The first one is run by this task.
 
      /// Default constructor
    NetInTask(
@@ -168,6 +207,16 @@ protected:
      /// Return sLock object.
    static OsRWMutex& getLockObj() { return sLock; }
 
+     /// Return write side of the command connection serving given resource.
+   OsConnectionSocket* getWriteSocket(MprFromNet* fwdTo);
+
+     /// Create loopback connection used to send commands to a receive loop.
+   static int createCommandConnection(OsConnectionSocket*& rpReadSocket,
+                                      OsConnectionSocket*& rpWriteSocket);
+     /**<
+     *  @returns Port number of the listening side of the connection.
+     */
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
 
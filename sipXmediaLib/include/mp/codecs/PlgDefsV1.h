@@ -182,6 +182,27 @@ struct MppCodecFmtpInfoV1_2
 #define CPP_DECLARE_FUNCS_V1(x)  \
 extern "C"  DECLARE_FUNCS_V1(x)
 
+/**
+*  Optional batch functions of sample based codecs, which keep no state
+*  between calls (like G.711). They encode or decode several independent
+*  buffers of the same length in one call, e.g. frames of many channels.
+*  Declared and registered in addition to DECLARE_FUNCS_V1() functions,
+*  see PLG_ENUM_CODEC_BATCH().
+*/
+#define DECLARE_BATCH_FUNCS_V1(x)                                                   \
+ CODEC_API int   PLG_DECODE_BATCH_V1(x)(void* handle, unsigned numBuffers,          \
+                                        const void* const pCodedData[],             \
+                                        unsigned cbCodedPacketSize,                 \
+                                        void* const pAudioBuffers[],                \
+                                        unsigned cbBufferSize,                      \
+                                        unsigned *pcbDecodedSize);                  \
+ CODEC_API int   PLG_ENCODE_BATCH_V1(x)(void* handle, unsigned numBuffers,          \
+                                        const void* const pAudioBuffers[],          \
+                                        unsigned cbAudioSamples,                    \
+                                        void* const pCodedData[],                   \
+                                        unsigned cbMaxCodedData,                    \
+                                        int* pcbCodedSize);
+
 #define PLG_GET_CODEC_NAME             get_codecs_v1
 #define PLG_GET_INFO_V1_1(x)           x##_get_info_v1_1
 #define PLG_INIT_V1_2(x)               x##_init_v1_2
@@ -190,6 +211,8 @@ extern "C"  DECLARE_FUNCS_V1(x)
 #define PLG_ENCODE_V1(x)               x##_encode_v1
 #define PLG_FREE_V1(x)                 x##_free_v1
 #define PLG_SIGNALING_V1(x)            x##_signaling_v1
+#define PLG_DECODE_BATCH_V1(x)         x##_decode_batch_v1
+#define PLG_ENCODE_BATCH_V1(x)         x##_encode_batch_v1
 
 #define MSK_GET_CODEC_NAME_V1          "get_codecs_v1"
 #define MSK_GET_INFO_V1_1              "_get_info_v1_1"
@@ -199,6 +222,8 @@ extern "C"  DECLARE_FUNCS_V1(x)
 #define MSK_ENCODE_V1                  "_encode_v1"
 #define MSK_FREE_V1                    "_free_v1"
 #define MSK_SIGNALING_V1               "_signaling_v1"
+#define MSK_DECODE_BATCH_V1            "_decode_batch_v1"
+#define MSK_ENCODE_BATCH_V1            "_encode_batch_v1"
 
 typedef int   (*dlGetCodecsV1)(int iNum, const char** pCodecModuleName);
 
@@ -218,6 +243,14 @@ typedef int   (*dlPlgEncodeV1)(void* handle, const void* pAudioBuffer, unsigned
                                int* rSamplesConsumed, void* pCodedData, unsigned cbMaxCodedData, 
                                int* pcbCodedSize, unsigned* pbSendNow);
 typedef int   (*dlPlgFreeV1)(void* handle, int isDecoder);
+typedef int   (*dlPlgDecodeBatchV1)(void* handle, unsigned numBuffers,
+                                    const void* const pCodedData[], unsigned cbCodedPacketSize,
+                                    void* const pAudioBuffers[], unsigned cbBufferSize,
+                                    unsigned *pcbDecodedSize);
+typedef int   (*dlPlgEncodeBatchV1)(void* handle, unsigned numBuffers,
+                                    const void* const pAudioBuffers[], unsigned cbAudioSamples,
+                                    void* const pCodedData[], unsigned cbMaxCodedData,
+                                    int* pcbCodedSize);
 
 
 #define IPLG_ENUM_CODEC_NAME       plugin_enum_codec
@@ -242,7 +275,10 @@ typedef int   (*dlPlgFreeV1)(void* handle, int isDecoder);
                                     dlPlgEncodeV1 plgEncode,                  \
                                     dlPlgFreeV1 plgFree,                      \
                                     dlPlgGetPacketSamplesV1_2 plgGetPacketSamples, \
-                                    dlPlgGetSignalingDataV1 plgSignaling);
+                                    dlPlgGetSignalingDataV1 plgSignaling); \
+   void callbackRegisterStaticCodecBatch(const char* codecModuleName,         \
+                                         dlPlgDecodeBatchV1 plgDecodeBatch,   \
+                                         dlPlgEncodeBatchV1 plgEncodeBatch);
  
 #define REG_STATIC_NAME(y)          registerStatic_##y
 
@@ -266,6 +302,10 @@ typedef int   (*dlPlgFreeV1)(void* handle, int isDecoder);
                                PLG_SIGNALING_V1(x));
 #define SPLG_ENUM_CODEC_NO_SIGNALING(x)                         \
                                NULL);
+#define SPLG_ENUM_CODEC_BATCH(x)                                \
+   callbackRegisterStaticCodecBatch(#x,                         \
+                                    PLG_DECODE_BATCH_V1(x),     \
+                                    PLG_ENCODE_BATCH_V1(x));
 #define SPLG_ENUM_CODEC_END  }
 
 #ifdef CODEC_DYNAMIC
@@ -275,6 +315,7 @@ typedef int   (*dlPlgFreeV1)(void* handle, int isDecoder);
 #  define PLG_ENUM_CODEC_NO_SPECIAL_PACKING(x)
 #  define PLG_ENUM_CODEC_SIGNALING(x)
 #  define PLG_ENUM_CODEC_NO_SIGNALING(x)
+#  define PLG_ENUM_CODEC_BATCH(x)
 #  define PLG_ENUM_CODEC_END                   IPLG_ENUM_CODEC_END  \
                                                IPLG_ENUM_CODEC_FUNC
 #else
@@ -285,6 +326,7 @@ typedef int   (*dlPlgFreeV1)(void* handle, int isDecoder);
 #  define PLG_ENUM_CODEC_NO_SPECIAL_PACKING(x) SPLG_ENUM_CODEC_NO_SPECIAL_PACKING(x)
 #  define PLG_ENUM_CODEC_SIGNALING(x)          SPLG_ENUM_CODEC_SIGNALING(x)
 #  define PLG_ENUM_CODEC_NO_SIGNALING(x)       SPLG_ENUM_CODEC_NO_SIGNALING(x)
+#  define PLG_ENUM_CODEC_BATCH(x)              SPLG_ENUM_CODEC_BATCH(x)
 #  define PLG_ENUM_CODEC_END                   SPLG_ENUM_CODEC_END
 #endif
 
@@ -43,10 +43,15 @@
 
 MpBridgeAlgLinear::MpBridgeAlgLinear(int inputs, int outputs,
                                      UtlBoolean mixSilence,
-                                     int samplesPerFrame)
+                                     int samplesPerFrame,
+                                     int maxActiveSpeakers)
 : MpBridgeAlgBase(inputs, outputs, mixSilence)
 , mActiveInputsListSize(0)
 , mpActiveInputsList(NULL)
+, mMaxActiveSpeakers(maxActiveSpeakers)
+, mpSpeakerSelected(NULL)
+, mpSpeakerHangover(NULL)
+, mpSpeakerCandidates(NULL)
 , mMixActionsStackLength(0)
 , mMixActionsStackTop(0)
 , mpMixActionsStack(NULL)
@@ -74,6 +79,18 @@ MpBridgeAlgLinear::MpBridgeAlgLinear(int inputs, int outputs,
    // Allocate array for list of active inputs.
    mActiveInputsListSize = maxInputs()*maxOutputs();
    mpActiveInputsList = new int[mActiveInputsListSize];
+   // Allocate arrays for speaker selection.
+   if (mMaxActiveSpeakers > 0)
+   {
+      mpSpeakerSelected = new UtlBoolean[maxInputs()];
+      mpSpeakerHangover = new int[maxInputs()];
+      mpSpeakerCandidates = new int[maxInputs()];
+      for (int i=0; i<maxInputs(); i++)
+      {
+         mpSpeakerSelected[i] = FALSE;
+         mpSpeakerHangover[i] = 0;
+      }
+   }
    // Allocate array for mix action stack.
    mMixActionsStackLength = maxInputs()*maxOutputs();
    mpMixActionsStack = new MixAction[mMixActionsStackLength];
@@ -83,6 +100,7 @@ MpBridgeAlgLinear::MpBridgeAlgLinear(int inputs, int outputs,
    mpMixDataStack = new MpBridgeAccum[mMixDataStackLength];
    mpMixDataSpeechType = new MpSpeechType[maxInputs()*maxOutputs()];
    mpMixDataAmplitude = new MpBridgeAccum[maxInputs()*maxOutputs()];
+   mpMixDataOutput = new int[maxInputs()*maxOutputs()];
    // Allocate array for mix temporary data info.
    mMixDataInfoStackStep = maxInputs()*maxOutputs();
    mMixDataInfoStackLength = maxInputs()*maxOutputs()*mMixDataInfoStackStep;
@@ -95,10 +113,14 @@ MpBridgeAlgLinear::MpBridgeAlgLinear(int inputs, int outputs,
 MpBridgeAlgLinear::~MpBridgeAlgLinear()
 {
    delete[] mpActiveInputsList;
+   delete[] mpSpeakerSelected;
+   delete[] mpSpeakerHangover;
+   delete[] mpSpeakerCandidates;
    delete[] mpMixActionsStack;
    delete[] mpMixDataStack;
    delete[] mpMixDataSpeechType;
    delete[] mpMixDataAmplitude;
+   delete[] mpMixDataOutput;
    delete[] mpMixDataInfoStack;
    delete[] mpMixDataInfoProcessedStack;
 }
@@ -115,6 +137,12 @@ UtlBoolean MpBridgeAlgLinear::doMix(MpBufPtr inBufs[], int inBufsSize,
    assert(inBufsSize == maxInputs());
    assert(outBufsSize == maxOutputs());
 
+   // Select the talkers to mix, if their number is limited.
+   if (mMaxActiveSpeakers > 0)
+   {
+      selectActiveSpeakers(inBufs, inBufsSize);
+   }
+
    //
    //  Build list of active inputs (stored in mpActiveInputsList).
    //
@@ -133,7 +161,8 @@ UtlBoolean MpBridgeAlgLinear::doMix(MpBufPtr inBufs[], int inBufsSize,
          contributorDumpString.appendFormat("(%d)i:%dNM",extInput, origInput);
 #endif // TEST_PRINT_MIXING_CONTRIBUTORS ]
 
-         if (inBufs[origInput].isValid())
+         if (inBufs[origInput].isValid() &&
+             (mMaxActiveSpeakers <= 0 || mpSpeakerSelected[origInput]))
          {
 
 #ifdef TEST_PRINT_MIXING_CONTRIBUTORS // [
@@ -519,6 +548,10 @@ UtlBoolean MpBridgeAlgLinear::doMix(MpBufPtr inBufs[], int inBufsSize,
    //  Apply mix actions from stack.
    //
    initMixDataStack();
+   for (int i=0; i<mMixDataInfoProcessedStackTop; i++)
+   {
+      mpMixDataOutput[i] = -1;
+   }
 
 #ifdef RTL_ENABLED
    char ampLabel[32];
@@ -633,9 +666,17 @@ UtlBoolean MpBridgeAlgLinear::doMix(MpBufPtr inBufs[], int inBufsSize,
                       mpMixActionsStack[action].mDst);
 #endif // TEST_PRINT_MIXING ]
             } 
+            else if (mpMixDataOutput[src] >= 0)
+            {
+               // Another output gets the same mix. Share its buffer, so
+               // the mix is converted once and its encoders can see that
+               // it is the same audio.
+               outBufs[mpMixActionsStack[action].mDst] = outBufs[mpMixDataOutput[src]];
+            }
             else
             {
                // This is mixed data. Convert it and copy to buffer.
+               mpMixDataOutput[src] = mpMixActionsStack[action].mDst;
 
                // Get buffer for output data.
                MpAudioBufPtr pOutBuf = MpMisc.RawAudioPool->getBuffer();
@@ -886,6 +927,111 @@ void MpBridgeAlgLinear::dumpOutputMix(UtlString& dumpString)
 
 /* ////////////////////////////// PROTECTED /////////////////////////////// */
 
+void MpBridgeAlgLinear::selectActiveSpeakers(MpBufPtr inBufs[], int inBufsSize)
+{
+   int input;
+   int i;
+
+   // Inputs nobody listens to must not take places of talkers.
+   for (input=0; input<inBufsSize; input++)
+   {
+      mpSpeakerCandidates[input] = 0;
+   }
+   for (int extInput=mExtendedInputs.getExtendedInputsNum()-1; extInput>=0; extInput--)
+   {
+      if (mExtendedInputs.isNotMuted(extInput))
+      {
+         mpSpeakerCandidates[mExtendedInputs.getOrigin(extInput)] = 1;
+      }
+   }
+
+   // Collect inputs which could be mixed. The others lose their places.
+   int numCandidates = 0;
+   for (input=0; input<inBufsSize; input++)
+   {
+      UtlBoolean isCandidate = FALSE;
+      if (mpSpeakerCandidates[input] && inBufs[input].isValid())
+      {
+         MpAudioBufPtr pAudio = inBufs[input];
+         isCandidate = (mMixSilence || isActiveAudio(pAudio->getSpeechType())) &&
+                       pAudio->getSpeechType() != MP_SPEECH_MUTED;
+      }
+
+      // Note, that numCandidates <= input here, so we do not overwrite
+      // flags of inputs not processed yet.
+      if (isCandidate)
+      {
+         mpSpeakerCandidates[numCandidates] = input;
+         numCandidates++;
+      }
+      else
+      {
+         mpSpeakerSelected[input] = FALSE;
+         mpSpeakerHangover[input] = 0;
+      }
+   }
+
+   // Move the loudest candidates to the beginning of the list. Talking ones
+   // restart their hangover.
+   const int numTop = sipx_min(mMaxActiveSpeakers, numCandidates);
+   for (i=0; i<numTop; i++)
+   {
+      int best = i;
+      for (int j=i+1; j<numCandidates; j++)
+      {
+         if (isLouderSpeaker(inBufs[mpSpeakerCandidates[j]],
+                             inBufs[mpSpeakerCandidates[best]]))
+         {
+            best = j;
+         }
+      }
+      input = mpSpeakerCandidates[best];
+      mpSpeakerCandidates[best] = mpSpeakerCandidates[i];
+      mpSpeakerCandidates[i] = input;
+
+      MpAudioBufPtr pAudio = inBufs[input];
+      if (isActiveAudio(pAudio->getSpeechType()))
+      {
+         mpSpeakerHangover[input] = SPEAKER_HANGOVER_FRAMES + 1;
+      }
+   }
+
+   // Selected talkers keep their places until their hangover is over.
+   int numSelected = 0;
+   for (i=0; i<numCandidates; i++)
+   {
+      input = mpSpeakerCandidates[i];
+      if (mpSpeakerSelected[input])
+      {
+         if (mpSpeakerHangover[input] > 0)
+         {
+            mpSpeakerHangover[input]--;
+            numSelected++;
+         }
+         else
+         {
+            mpSpeakerSelected[input] = FALSE;
+         }
+      }
+   }
+   assert(numSelected <= mMaxActiveSpeakers);
+
+   // Give free places to the loudest of the others.
+   for (i=0; i<numTop && numSelected<mMaxActiveSpeakers; i++)
+   {
+      input = mpSpeakerCandidates[i];
+      if (!mpSpeakerSelected[input])
+      {
+         mpSpeakerSelected[input] = TRUE;
+         if (mpSpeakerHangover[input] > 0)
+         {
+            mpSpeakerHangover[input]--;
+         }
+         numSelected++;
+      }
+   }
+}
+
 
 /* /////////////////////////////// PRIVATE //////////////////////////////// */
 
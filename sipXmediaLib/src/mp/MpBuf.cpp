@@ -27,7 +27,7 @@ void MpBuf::attach()
     osPrintf( "Buffer %d from pool %x have %d references now (++)\n"
             , mpPool->getBufferNumber(this)
             , mpPool
-            , mRefCounter);
+            , (int)mRefCounter);
 #endif
 }
 
@@ -37,14 +37,11 @@ void MpBuf::detach()
     osPrintf( "Buffer %d from pool %x have %d references now (--)\n"
             , mpPool->getBufferNumber(this)
             , mpPool
-            , mRefCounter-1);
+            , (int)mRefCounter-1);
 #endif
 
-    mRefCounter--;
-    // If other thread decremented mRefCounter in this execution point then
-    // buffer will be freed twice. We try to fix this in the releaseBuffer()
-    // code checking is buffer already free or not.
-    if (mRefCounter == 0) 
+    // Only the thread which dropped the last reference frees the buffer.
+    if (--mRefCounter == 0) 
     {
         if (mpDestroy != NULL) {
             mpDestroy(this);
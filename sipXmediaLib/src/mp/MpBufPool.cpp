@@ -47,29 +47,19 @@
 /// Class for internal MpBufPool use.
 /**
 *  This class provides single linked list interface for MpBuf class. It uses
-*  MpBuf::mpPool to store pointer to next buffer.
+*  MpBuf::mpPool to store 1-based index of next buffer (0 marks end of
+*  the list). Index is stored instead of pointer to allow ABA-safe lock-free
+*  free list with a 64-bit head.
 */
 struct MpBufList : public MpBuf {
     friend class MpBufPool;
 public:
 
-    /// Get buffer next to current.
-    MpBufList *getNextBuf() {return (MpBufList*)mpPool;}
+    /// Get 1-based index of buffer next to current.
+    unsigned getNextIndex() const {return (unsigned)(size_t)mpPool;}
 
-    /// Set buffer next to current.
-    void setNextBuf(MpBuf *pNext) {mpPool = (MpBufPool*)pNext;}
-
-    int length() const
-    {
-        int length = 0;
-        MpBufList* next = (MpBufList*) mpPool;
-        while(next)
-        {
-            length++;
-            next = (MpBufList*) next->mpPool;
-        }
-        return(length);
-    }
+    /// Set 1-based index of buffer next to current.
+    void setNextIndex(unsigned next) {mpPool = (MpBufPool*)(size_t)next;}
 
 private:
 
@@ -90,94 +80,117 @@ private:
 
 /* ============================ CREATORS ================================== */
 
-MpBufPool::MpBufPool(unsigned blockSize, unsigned numBlocks, const UtlString& poolName)
+MpBufPool::MpBufPool(unsigned blockSize, unsigned numBlocks,
+                     const UtlString& poolName, unsigned maxBlocks)
 : mPoolName(poolName)
 , mBlockSize(blockSize)
 , mBlockSpan(MP_ALIGN(blockSize,MP_ALIGN_SIZE))
-, mNumBlocks(numBlocks)
-, mPoolBytes(mBlockSpan*mNumBlocks)
-, mpPoolData(new char[mPoolBytes])
-, mpFreeList(NULL)
-, mMutex(OsMutex::Q_PRIORITY)
+, mBlocksPerChunk(numBlocks)
+, mChunkBytes(mBlockSpan*numBlocks)
+, mMaxChunks(1)
+, mpChunks(NULL)
+, mNumChunks(0)
+, mNumBlocks(0)
+, mFreeHead(makeHead(0, 0))
+, mGrowMutex(OsMutex::Q_PRIORITY)
 , mNumGets(0)
 , mNumFrees(0)
-, mNumFree(numBlocks)
+, mNumFree(0)
 , mMinFree(numBlocks)
 {
     assert(mBlockSize >= sizeof(MpBuf));
-    memset(mpPoolData, 0xff, mPoolBytes);
-    
-    // Init buffers
-    char *pBlock = mpPoolData;
-    for (int i=mNumBlocks; i>0; i--) {
-        MpBuf *pBuf = (MpBufList *)pBlock;
-        pBuf->mRefCounter = 0;
-        // Don't set mpPool cause it is used by current implementation of free list
-        //pBuf->mpPool = this;
+    assert(mBlocksPerChunk > 0);
 
-        // Add buffer to the end of free list
-        appendFreeList(pBuf);
-        
-        // Jump to next block
-        pBlock = getNextBlock(pBlock);
+    if (maxBlocks > numBlocks)
+    {
+        mMaxChunks = (maxBlocks + numBlocks - 1) / numBlocks;
+        if (mMaxChunks > MAX_CHUNKS)
+        {
+            mMaxChunks = MAX_CHUNKS;
+        }
     }
+    mpChunks = new char*[mMaxChunks];
+    for (int i=0; i<mMaxChunks; i++)
+    {
+        mpChunks[i] = NULL;
+    }
+
+    // Allocate initial chunk.
+    grow();
 
 #ifdef MPBUF_DEBUG
-    osPrintf("Data start: %X\n", mpPoolData);
+    osPrintf("Data start: %X\n", mpChunks[0]);
 #endif
 }
 
 MpBufPool::~MpBufPool()
 {
 #ifdef MPBUF_CLEAR_EXIT_CHECK
-    char *pBlock = mpPoolData;
-    for (int i=mNumBlocks; i>0; i--) {
-        MpBuf *pBuf = (MpBuf *)pBlock;
-        if (pBuf->mRefCounter > 0 || pBuf->mpPool == this) {
-            osPrintf( "Buffer %d from pool %p was not correctly freed!!!\n"
-                    , getBufferNumber(pBuf)
-                    , this);
+    for (int chunk=0; chunk<mNumChunks; chunk++) {
+        char *pBlock = getChunk(chunk);
+        for (int i=mBlocksPerChunk; i>0; i--) {
+            MpBuf *pBuf = (MpBuf *)pBlock;
+            if (pBuf->mRefCounter > 0 || pBuf->mpPool == this) {
+                osPrintf( "Buffer %d from pool %p was not correctly freed!!!\n"
+                        , getBufferNumber(pBuf)
+                        , this);
+            }
+            pBlock = getNextBlock(pBlock);
         }
-        pBlock = getNextBlock(pBlock);
     }
 #endif
 
-    delete[] mpPoolData;
+    for (int chunk=0; chunk<mNumChunks; chunk++) {
+        delete[] mpChunks[chunk];
+    }
+    delete[] mpChunks;
 }
 
 /* ============================ MANIPULATORS ============================== */
 
 MpBuf *MpBufPool::getBuffer()
 {
-    OsLock lock(mMutex);
+    MpBufList *pFreeBuffer;
 
-    // No free blocks found.
-    if (mpFreeList == NULL) 
+    while (1)
     {
-        profileFlowgraphPoolUsage();
-        OsSysLog::add(FAC_MP, PRI_ERR,
-                "MpBufPool::getBuffer pool: %s is empty.  %d buffers outstanding.",
-                mPoolName.data(), mNumBlocks);
-#ifdef _DEBUG
-       osPrintf("!!!! Buffer pool %x is full !!!!\n", this);
-#endif
-        return NULL;
+        int64_t head = mFreeHead;
+        unsigned top = headTop(head);
+
+        // No free blocks found.
+        if (top == 0)
+        {
+            if (grow())
+            {
+                continue;
+            }
+            reportEmpty();
+            return NULL;
+        }
+
+        // Block memory is never freed, so it is safe to read next index even
+        // if this block has been taken by other thread already. In this case
+        // the tag in the head has changed and CAS below will fail.
+        pFreeBuffer = (MpBufList*)getBlock(top-1);
+        unsigned next = pFreeBuffer->getNextIndex();
+        if (mFreeHead.compare_exchange(head, makeHead(next, headTag(head)+1)))
+        {
+            break;
+        }
     }
-    
-    MpBuf *pFreeBuffer = mpFreeList;
-    mpFreeList = mpFreeList->getNextBuf();
+
     pFreeBuffer->mpPool = this;
     pFreeBuffer->mpFlowGraph = NULL;
     mNumGets++;
-    mNumFree--;
-    if (mNumFree < mMinFree)
+    int numFree = --mNumFree;
+    if (numFree < mMinFree)
     {
-        mMinFree = mNumFree;
-        if (0 == (0x3f&mNumFree))
+        mMinFree = numFree;
+        if (0 == (0x3f&numFree))
         {
             OsSysLog::add(FAC_MP, PRI_DEBUG,
                 "MpBufPool::getBuffer pool: %s (%p), NumFree dropped to %d",
-                mPoolName.data(), this, mNumFree); 
+                mPoolName.data(), this, numFree); 
         }
     }
 
@@ -192,60 +205,67 @@ MpBuf *MpBufPool::getBuffer()
 
 void MpBufPool::releaseBuffer(MpBuf *pBuffer)
 {
-    OsLock lock(mMutex);
 #ifdef MPBUF_DEBUG
     osPrintf("Buffer %d from pool %x have been freed.\n",
              getBufferNumber(pBuffer), this);
 #endif
     assert(pBuffer->mRefCounter == 0);
 
-    // This check is need cause we don't synchronize MpBuf's reference counter.
-    // See note in MpBuf::detach().
-    if (pBuffer->mpPool == this) {
-        appendFreeList(pBuffer);
-        pBuffer->mpFlowGraph = NULL;
-        mNumFrees++;
-        mNumFree++;
-    } else {
+    // Only the thread which dropped the last reference gets here, so there is
+    // no race on the pool pointer. Check it to catch freeing buffer twice or
+    // freeing buffer to the wrong pool.
+    if (pBuffer->mpPool != this)
+    {
 #ifdef MPBUF_DEBUG
         osPrintf("Error: freeing buffer with wrong pool or freeing buffer twice!");
 #endif
+        return;
     }
+
+    pBuffer->mpPool = NULL;
+
+    int index = getBufferNumber(pBuffer);
+    assert(index >= 0);
+    pBuffer->mpFlowGraph = NULL;
+    pushFreeList(pBuffer, index);
+    mNumFrees++;
+    mNumFree++;
 }
 
 /* ============================ ACCESSORS ================================= */
 
 int MpBufPool::getBufferNumber(MpBuf *pBuf) const
 {
-    return ((char*)pBuf-mpPoolData)/mBlockSpan;
+    int numChunks = mNumChunks;
+    for (int chunk=0; chunk<numChunks; chunk++)
+    {
+        char *pChunk = getChunk(chunk);
+        if ((char*)pBuf >= pChunk && (char*)pBuf < pChunk + mChunkBytes)
+        {
+            return chunk*mBlocksPerChunk + ((char*)pBuf-pChunk)/mBlockSpan;
+        }
+    }
+    return -1;
 };
 
 int MpBufPool::getFreeBufferCount()
 {
-    OsLock lock(mMutex);
-    int count = 0;
-    if(mpFreeList)
-    {
-       count = mpFreeList->length();
-    }
-
-    return(count);
+    return mNumFree;
 }
 
 int MpBufPool::scanBufPool(MpFlowGraphBase *pFG)
 {
-    char *pBlock = mpPoolData;
+    int numBlocks = mNumBlocks;
     int bads = 0;
-    for (int i=mNumBlocks; i>0; i--) {
-        MpBuf *pBuf = (MpBuf *)pBlock;
+    for (int i=0; i<numBlocks; i++) {
+        MpBuf *pBuf = getBlock(i);
         if (pBuf->mRefCounter != 0 || pBuf->mpPool == this) {
             if (pFG == pBuf->mpFlowGraph) {
                 bads++;
                 OsSysLog::add(FAC_MP, PRI_ERR, "Buffer %d from pool %p (flowgraph=%p) was not correctly freed!!!\n",
-                    getBufferNumber(pBuf), this, pFG);
+                    i, this, pFG);
             }
         }
-        pBlock = getNextBlock(pBlock);
     }
     return bads;
 }
@@ -254,10 +274,10 @@ int MpBufPool::profileFlowgraphPoolUsage()
 {
     UtlHashMap flowgraphBufferCount;
 
-    char *pBlock = mpPoolData;
-    for (int i=mNumBlocks; i>0; i--) 
+    int numBlocks = mNumBlocks;
+    for (int i=0; i<numBlocks; i++) 
     {
-        MpBuf *pBuf = (MpBuf *)pBlock;
+        MpBuf *pBuf = getBlock(i);
         if (pBuf->mRefCounter != 0 || pBuf->mpPool == this)
         {
             UtlVoidPtr pointerKey(pBuf->mpFlowGraph);
@@ -271,12 +291,11 @@ int MpBufPool::profileFlowgraphPoolUsage()
                 flowgraphBufferCount.insertKeyAndValue(new UtlVoidPtr(pBuf->mpFlowGraph), new UtlInt(1));
             }
         }
-        pBlock = getNextBlock(pBlock);
     }
 
     OsSysLog::add(FAC_MP, PRI_ERR,
             "MpBufPool::profileFlowgraphPoolUsage pool: %p, buffer size: %d+%d, free buffer count: %d/%d",
-            this, mBlockSize, mBlockSpan-mBlockSize, mNumFree, mNumBlocks); 
+            this, mBlockSize, mBlockSpan-mBlockSize, (int)mNumFree, numBlocks); 
 
     UtlHashMapIterator iterator(flowgraphBufferCount);
     UtlInt* countPtr = NULL;
@@ -307,10 +326,82 @@ const UtlString& MpBufPool::getName()
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
-void MpBufPool::appendFreeList(MpBuf *pBuffer)
+UtlBoolean MpBufPool::grow()
+{
+    OsLock lock(mGrowMutex);
+
+    // Other thread may have grown the pool or released some buffers
+    // while we were waiting for the lock.
+    if (headTop(mFreeHead) != 0)
+    {
+        return TRUE;
+    }
+
+    int chunk = mNumChunks;
+    if (chunk >= mMaxChunks)
+    {
+        return FALSE;
+    }
+
+    char *pChunk = new char[mChunkBytes];
+    memset(pChunk, 0xff, mChunkBytes);
+
+    // Init buffers and link them into a list in the order of their placement
+    // in memory.
+    unsigned firstIndex = chunk*mBlocksPerChunk;
+    char *pBlock = pChunk;
+    for (unsigned i=0; i<mBlocksPerChunk; i++) {
+        MpBufList *pBuf = (MpBufList *)pBlock;
+        pBuf->mRefCounter = 0;
+        pBuf->mpFlowGraph = NULL;
+        // Next index is 1-based, so index i+1 points to the block i+1.
+        pBuf->setNextIndex(firstIndex + i + 2);
+        pBlock = getNextBlock(pBlock);
+    }
+
+    // Publish the chunk before any of its blocks become reachable.
+    mpChunks[chunk] = pChunk;
+    mNumChunks = chunk+1;
+    mNumBlocks += mBlocksPerChunk;
+    mNumFree += mBlocksPerChunk;
+
+    // Push the whole chain to the free list at once.
+    MpBufList *pLast = (MpBufList *)getBlock(firstIndex + mBlocksPerChunk - 1);
+    int64_t head = mFreeHead;
+    do
+    {
+        pLast->setNextIndex(headTop(head));
+    } while (!mFreeHead.compare_exchange(head, makeHead(firstIndex+1, headTag(head)+1)));
+
+    if (chunk > 0)
+    {
+        OsSysLog::add(FAC_MP, PRI_INFO,
+                      "MpBufPool::grow pool: %s (%p) grown to %d buffers",
+                      mPoolName.data(), this, (int)mNumBlocks);
+    }
+
+    return TRUE;
+}
+
+void MpBufPool::pushFreeList(MpBuf *pBuffer, unsigned index)
+{
+    MpBufList *pBuf = (MpBufList*)pBuffer;
+    int64_t head = mFreeHead;
+    do
+    {
+        pBuf->setNextIndex(headTop(head));
+    } while (!mFreeHead.compare_exchange(head, makeHead(index+1, headTag(head)+1)));
+}
+
+void MpBufPool::reportEmpty()
 {
-    ((MpBufList*)pBuffer)->setNextBuf(mpFreeList);
-    mpFreeList = (MpBufList*)pBuffer;
+    profileFlowgraphPoolUsage();
+    OsSysLog::add(FAC_MP, PRI_ERR,
+            "MpBufPool::getBuffer pool: %s is empty.  %d buffers outstanding.",
+            mPoolName.data(), (int)mNumBlocks);
+#ifdef _DEBUG
+    osPrintf("!!!! Buffer pool %x is full !!!!\n", this);
+#endif
 }
 
 
@@ -191,6 +191,8 @@ OsStatus MpCodecFactory::loadDynCodec(const char* name)
       UtlString dlNameEncdoe = strCodecName + MSK_ENCODE_V1;
       UtlString dlNameFree = strCodecName + MSK_FREE_V1;
       UtlString dlNameSignaling = strCodecName + MSK_SIGNALING_V1;
+      UtlString dlNameDecodeBatch = strCodecName + MSK_DECODE_BATCH_V1;
+      UtlString dlNameEncodeBatch = strCodecName + MSK_ENCODE_BATCH_V1;
       
       dlPlgInitV1_2 plgInitAddr;
       dlPlgGetInfoV1_1 plgGetInfoAddr;
@@ -199,6 +201,8 @@ OsStatus MpCodecFactory::loadDynCodec(const char* name)
       dlPlgEncodeV1 plgEncodeAddr;
       dlPlgFreeV1 plgFreeAddr;
       dlPlgGetSignalingDataV1 plgSignaling;
+      dlPlgDecodeBatchV1 plgDecodeBatch;
+      dlPlgEncodeBatchV1 plgEncodeBatch;
 
       st = TRUE 
          && (pShrMgr->getSharedLibSymbol(name, dlNameInit,
@@ -244,6 +248,17 @@ OsStatus MpCodecFactory::loadDynCodec(const char* name)
          if (!pCallInfo)
             continue;         
 
+         // Batch functions are optional and come in pairs.
+         if (  (pShrMgr->getSharedLibSymbol(name, dlNameDecodeBatch,
+                                            (void*&)plgDecodeBatch) == OS_SUCCESS)
+            && (plgDecodeBatch != NULL)
+            && (pShrMgr->getSharedLibSymbol(name, dlNameEncodeBatch,
+                                            (void*&)plgEncodeBatch) == OS_SUCCESS)
+            && (plgEncodeBatch != NULL))
+         {
+            pCallInfo->setBatchFunctions(plgDecodeBatch, plgEncodeBatch);
+         }
+
          if (addCodecWrapperV1(pCallInfo) != OS_SUCCESS)
          {
             delete pCallInfo;
@@ -310,6 +325,19 @@ MpCodecCallInfoV1* MpCodecFactory::addStaticCodec(MpCodecCallInfoV1* sStaticCode
     return sStaticCodecsV1;
 }
 
+MpCodecCallInfoV1* MpCodecFactory::findStaticCodec(const char* codecModuleName)
+{
+   MpCodecCallInfoV1* codecCallInfo;
+   for (codecCallInfo = sStaticCodecsV1; codecCallInfo; codecCallInfo = codecCallInfo->getNext())
+   {
+      if (codecCallInfo->getCodecModuleName() == codecModuleName)
+      {
+         return codecCallInfo;
+      }
+   }
+   return NULL;
+}
+
 /* ============================== ACCESSORS =============================== */
 
 OsStatus MpCodecFactory::createDecoder(const UtlString &mime,
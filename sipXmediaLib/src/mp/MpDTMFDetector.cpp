@@ -13,11 +13,16 @@
 // SYSTEM INCLUDES
 #include <mp/MpTypes.h>
 #include <math.h>
+#include <string.h>
 
 // APPLICATION INCLUDES
 #include "mp/MpDTMFDetector.h"
 
 
+// CONSTANTS
+  /// Minimum power of both row and column frequencies of a DTMF tone.
+#define DTMF_MIN_POWER 4.0e5
+
 // Class data allocation
 double MpDtmfDetector::sFreqs_to_detect[] = 
 { 
@@ -36,20 +41,14 @@ MpDtmfDetector::MpDtmfDetector(const unsigned samplesPerSec, const unsigned numP
 : mSamplesPerSec(samplesPerSec)
 , mNumProcessSamples(numProcessSamples)
 {
-   mQ1 = new double[snFreqsToDetect];
-   mQ2 = new double[snFreqsToDetect];
-   mR = new double[snFreqsToDetect];
-   mCoefs = new double[snFreqsToDetect];
+   mpBlock = new MpAudioSample[mNumProcessSamples];
    reset();
 }
 
 // Destructor
 MpDtmfDetector::~MpDtmfDetector()
 {
-   delete[] mQ1;
-   delete[] mQ2;
-   delete[] mR;
-   delete[] mCoefs;
+   delete[] mpBlock;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -61,10 +60,7 @@ void MpDtmfDetector::reset()
    int i;
    for(i=0; i< snFreqsToDetect; i++)
    {
-      mQ1[i] = 0;
-      mQ2[i] = 0;
       mR[i] = 0;
-      mCoefs[i] = 0;
    }
 
    // Now calculate new coefficients 
@@ -79,38 +75,48 @@ void MpDtmfDetector::setSamplesPerSec(const unsigned samplesPerSec)
 
 void MpDtmfDetector::setNumProcessSamples(const unsigned numProcessSamples)
 {
-   mNumProcessSamples = numProcessSamples; 
+   if (numProcessSamples != mNumProcessSamples)
+   {
+      delete[] mpBlock;
+      mpBlock = new MpAudioSample[numProcessSamples];
+      mNumProcessSamples = numProcessSamples; 
+   }
+   // Start a new block
+   mSampleCount = 0;
 }
 
-UtlBoolean MpDtmfDetector::processSample(const MpAudioSample sample)
+UtlBoolean MpDtmfDetector::processFrame(const MpAudioSample *pSamples,
+                                        unsigned numSamples)
 {
    UtlBoolean ret = FALSE;
-   double q0;
-   uint32_t i;
 
-   mSampleCount++;
-   for ( i=0; i<snFreqsToDetect; i++ )
+   while (numSamples > 0)
    {
-      q0 = mCoefs[i] * mQ1[i] - mQ2[i] + sample;
-      mQ2[i] = mQ1[i];
-      mQ1[i] = q0;
-   }
+      unsigned toCopy = mNumProcessSamples - mSampleCount;
+      if (toCopy > numSamples)
+      {
+         toCopy = numSamples;
+      }
+      memcpy(mpBlock + mSampleCount, pSamples, toCopy*sizeof(MpAudioSample));
+      mSampleCount += toCopy;
+      pSamples += toCopy;
+      numSamples -= toCopy;
 
-   if (mSampleCount == mNumProcessSamples)
-   {
-      for ( i=0; i<snFreqsToDetect; i++ )
+      if (mSampleCount == mNumProcessSamples)
       {
-         mR[i] = (mQ1[i] * mQ1[i]) + (mQ2[i] * mQ2[i]) - (mCoefs[i] * mQ1[i] * mQ2[i]);
-         mQ1[i] = 0.0;
-         mQ2[i] = 0.0;
+         processBlock();
+         mSampleCount = 0;
+         ret = TRUE;
       }
-      dtmfValidation();
-      mSampleCount = 0;
-      ret = TRUE;
    }
    return ret;
 }
 
+UtlBoolean MpDtmfDetector::processSample(const MpAudioSample sample)
+{
+   return processFrame(&sample, 1);
+}
+
 /* ============================ ACCESSORS ================================= */
 
 unsigned MpDtmfDetector::getSamplesPerSec() const
@@ -136,12 +142,29 @@ char MpDtmfDetector::getLastDetectedDTMF() const
 
 void MpDtmfDetector::calcCoeffs()
 {
+   double coefs[MpGoertzelBank::MAX_FREQS];
    int n;
 
    for(n = 0; n < snFreqsToDetect; n++)
    {
-      mCoefs[n] = 2.0 * cos(2.0 * 3.141592654 * sFreqs_to_detect[n] / mSamplesPerSec);
+      coefs[n] = 2.0 * cos(2.0 * 3.141592654 * sFreqs_to_detect[n] / mSamplesPerSec);
    }
+   mBank.setCoefficients(snFreqsToDetect, coefs);
+}
+
+void MpDtmfDetector::processBlock()
+{
+   // Quiet block would fail minimum energy check in dtmfValidation(),
+   // which keeps last detected DTMF then, so there is nothing to do.
+   if (MpGoertzelBank::isBelowPower(mpBlock, mNumProcessSamples, DTMF_MIN_POWER))
+   {
+      return;
+   }
+
+   mBank.reset();
+   mBank.process(mpBlock, mNumProcessSamples);
+   mBank.getPowers(mR);
+   dtmfValidation();
 }
 
 void MpDtmfDetector::dtmfValidation()
@@ -183,11 +206,11 @@ void MpDtmfDetector::dtmfValidation()
    }
 
    // Check for minimum energy
-   if ( mR[row] < 4.0e5 )   // 2.0e5 ... 1.0e8 no change
+   if ( mR[row] < DTMF_MIN_POWER )   // 2.0e5 ... 1.0e8 no change
    {
       // row frequency energy is not high enough
    }
-   else if ( mR[col] < 4.0e5 )
+   else if ( mR[col] < DTMF_MIN_POWER )
    {
       // column frequency energy is not high enough
    }
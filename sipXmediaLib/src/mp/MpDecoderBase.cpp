@@ -145,6 +145,30 @@ int MpDecoderBase::decode(const MpRtpBufPtr &pPacket,
    return decodedSize;
 }
 
+int MpDecoderBase::decodeBatch(int numFrames,
+                               const uint8_t* const pPayloads[],
+                               unsigned payloadSize,
+                               unsigned decodedBufferLength,
+                               MpAudioSample* const pSamplesBuffers[])
+{
+   unsigned decodedSize = 0;
+
+   if (!supportsBatch() || !isInitialized())
+   {
+      return 0;
+   }
+
+   if (mCallInfo.mPlgDecodeBatch(plgHandle, numFrames,
+                                 (const void* const*)pPayloads, payloadSize,
+                                 (void* const*)pSamplesBuffers,
+                                 decodedBufferLength,
+                                 &decodedSize) != RPLG_SUCCESS)
+   {
+      return 0;
+   }
+   return decodedSize;
+}
+
 /* ============================ ACCESSORS ================================= */
 
 const MpCodecInfo* MpDecoderBase::getInfo() const
@@ -198,5 +222,10 @@ OsStatus MpDecoderBase::getSignalingData(uint8_t &event,
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean MpDecoderBase::supportsBatch() const
+{
+   return mCallInfo.mPlgDecodeBatch != NULL;
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
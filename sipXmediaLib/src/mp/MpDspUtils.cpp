@@ -11,13 +11,81 @@
 // Author: Alexander Chemeris <Alexander DOT Chemeris AT SIPez DOT com>
 
 // SYSTEM INCLUDES
+#ifdef _MSC_VER // [
+#  include <intrin.h>
+#endif // _MSC_VER ]
+
 // APPLICATION INCLUDES
 #include <mp/MpDspUtils.h>
 
 // EXTERNAL FUNCTIONS
+#ifdef MP_DSP_SIMD_USE_X86 // [
+extern const MpDspSimdKernels *mpDspGetSse2Kernels();
+extern const MpDspSimdKernels *mpDspGetAvx2Kernels();
+#endif // MP_DSP_SIMD_USE_X86 ]
+#ifdef MP_DSP_SIMD_USE_NEON // [
+extern const MpDspSimdKernels *mpDspGetNeonKernels();
+#endif // MP_DSP_SIMD_USE_NEON ]
+
 // EXTERNAL VARIABLES
 // CONSTANTS
+static const char *sSimdLevelNames[MP_DSP_SIMD_LEVELS_NUM] =
+{
+   "none",
+   "SSE2",
+   "AVX2",
+   "NEON"
+};
+
 // STATIC VARIABLE INITIALIZATIONS
+  /// All NULLs - generic C code is used for all functions.
+static const MpDspSimdKernels sGenericKernels =
+{
+#ifdef MP_FIXED_POINT // [
+   NULL, // add_I
+   NULL, // add_IGain
+   NULL, // add_IAtt
+   NULL, // add
+   NULL, // addMul_I
+   NULL, // addMulLinear_I
+   NULL, // mul
+   NULL, // mul_I
+   NULL, // mulLinear
+   NULL, // convert32to16
+   NULL, // convert_Gain32to16
+   NULL, // convert_Att32to16
+   NULL, // convert16to32
+   NULL, // convert_Gain16to32
+   NULL, // convert_Att16to32
+#endif // MP_FIXED_POINT ]
+   NULL, // maxAbs16
+   NULL, // maximum16
+   NULL, // maximum32
+   NULL, // minimum16
+   NULL, // minimum32
+   NULL  // countClippedValues16
+};
+const MpDspSimdKernels *MpDspUtils::spSimdKernels = &sGenericKernels;
+MpDspSimdLevel MpDspUtils::sSimdLevel = MP_DSP_SIMD_NONE;
+
+#ifdef MP_DSP_SIMD_USE_X86 // [
+  /// AVX2 kernels with the holes filled by SSE2 ones.
+static MpDspSimdKernels sAvx2Kernels;
+#endif // MP_DSP_SIMD_USE_X86 ]
+
+/**
+*  Selects the best SIMD level on library load. Until then generic C
+*  versions are used, which give the same results.
+*/
+class MpDspUtilsSimdInit
+{
+public:
+   MpDspUtilsSimdInit()
+   {
+      MpDspUtils::setSimdLevel(MpDspUtils::detectSimdLevel());
+   }
+};
+static MpDspUtilsSimdInit sSimdInit;
 
 /* //////////////////////////////// PUBLIC //////////////////////////////// */
 
@@ -26,6 +94,152 @@
 #  include <mp/MpDspUtilsSumVect.h>
 #endif // !MP_DSP_INLINE_VECTOR_FUNCTIONS ]
 
+MpDspSimdLevel MpDspUtils::detectSimdLevel()
+{
+   if (isSimdLevelSupported(MP_DSP_SIMD_AVX2))
+   {
+      return MP_DSP_SIMD_AVX2;
+   }
+   if (isSimdLevelSupported(MP_DSP_SIMD_SSE2))
+   {
+      return MP_DSP_SIMD_SSE2;
+   }
+   if (isSimdLevelSupported(MP_DSP_SIMD_NEON))
+   {
+      return MP_DSP_SIMD_NEON;
+   }
+   return MP_DSP_SIMD_NONE;
+}
+
+OsStatus MpDspUtils::setSimdLevel(MpDspSimdLevel level)
+{
+   const MpDspSimdKernels *pKernels = NULL;
+
+   if (!isSimdLevelSupported(level))
+   {
+      return OS_NOT_SUPPORTED;
+   }
+
+   switch (level)
+   {
+   case MP_DSP_SIMD_NONE:
+      pKernels = &sGenericKernels;
+      break;
+#ifdef MP_DSP_SIMD_USE_X86 // [
+   case MP_DSP_SIMD_SSE2:
+      pKernels = mpDspGetSse2Kernels();
+      break;
+   case MP_DSP_SIMD_AVX2:
+      {
+         // Take SSE2 version for every function which has no AVX2 version.
+         const MpDspSimdKernels *pSse2 = mpDspGetSse2Kernels();
+         const MpDspSimdKernels *pAvx2 = mpDspGetAvx2Kernels();
+#define MERGE_KERNEL(name) \
+         sAvx2Kernels.name = (pAvx2->name != NULL) ? pAvx2->name : pSse2->name
+         MERGE_KERNEL(add_I);
+         MERGE_KERNEL(add_IGain);
+         MERGE_KERNEL(add_IAtt);
+         MERGE_KERNEL(add);
+         MERGE_KERNEL(addMul_I);
+         MERGE_KERNEL(addMulLinear_I);
+         MERGE_KERNEL(mul);
+         MERGE_KERNEL(mul_I);
+         MERGE_KERNEL(mulLinear);
+         MERGE_KERNEL(convert32to16);
+         MERGE_KERNEL(convert_Gain32to16);
+         MERGE_KERNEL(convert_Att32to16);
+         MERGE_KERNEL(convert16to32);
+         MERGE_KERNEL(convert_Gain16to32);
+         MERGE_KERNEL(convert_Att16to32);
+         MERGE_KERNEL(maxAbs16);
+         MERGE_KERNEL(maximum16);
+         MERGE_KERNEL(maximum32);
+         MERGE_KERNEL(minimum16);
+         MERGE_KERNEL(minimum32);
+         MERGE_KERNEL(countClippedValues16);
+#undef MERGE_KERNEL
+         pKernels = &sAvx2Kernels;
+      }
+      break;
+#endif // MP_DSP_SIMD_USE_X86 ]
+#ifdef MP_DSP_SIMD_USE_NEON // [
+   case MP_DSP_SIMD_NEON:
+      pKernels = mpDspGetNeonKernels();
+      break;
+#endif // MP_DSP_SIMD_USE_NEON ]
+   default:
+      return OS_NOT_SUPPORTED;
+   }
+
+   spSimdKernels = pKernels;
+   sSimdLevel = level;
+   return OS_SUCCESS;
+}
+
+MpDspSimdLevel MpDspUtils::getSimdLevel()
+{
+   return sSimdLevel;
+}
+
+UtlBoolean MpDspUtils::isSimdLevelSupported(MpDspSimdLevel level)
+{
+   switch (level)
+   {
+   case MP_DSP_SIMD_NONE:
+      return TRUE;
+#ifdef MP_DSP_SIMD_USE_X86 // [
+#  ifdef _MSC_VER // [
+   case MP_DSP_SIMD_SSE2:
+   case MP_DSP_SIMD_AVX2:
+      {
+         int cpuInfo[4];
+         __cpuid(cpuInfo, 0);
+         const int maxLeaf = cpuInfo[0];
+         __cpuid(cpuInfo, 1);
+         const UtlBoolean sse2 = (cpuInfo[3] & (1<<26)) != 0;
+         if (level == MP_DSP_SIMD_SSE2)
+         {
+            return sse2;
+         }
+         // AVX2 needs OSXSAVE and OS support for saving YMM registers.
+         const UtlBoolean osxsave = (cpuInfo[2] & (1<<27)) != 0;
+         if (!sse2 || !osxsave || maxLeaf < 7 || (_xgetbv(0) & 0x6) != 0x6)
+         {
+            return FALSE;
+         }
+         __cpuidex(cpuInfo, 7, 0);
+         return (cpuInfo[1] & (1<<5)) != 0;
+      }
+#  else // _MSC_VER ][
+   case MP_DSP_SIMD_SSE2:
+      // We may be called from static initializer, before libgcc has
+      // initialized CPU model data.
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2") ? TRUE : FALSE;
+   case MP_DSP_SIMD_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") ? TRUE : FALSE;
+#  endif // !_MSC_VER ]
+#endif // MP_DSP_SIMD_USE_X86 ]
+#ifdef MP_DSP_SIMD_USE_NEON // [
+   case MP_DSP_SIMD_NEON:
+      // NEON presence is known at compile time.
+      return TRUE;
+#endif // MP_DSP_SIMD_USE_NEON ]
+   default:
+      return FALSE;
+   }
+}
+
+const char *MpDspUtils::getSimdLevelName(MpDspSimdLevel level)
+{
+   if (level < MP_DSP_SIMD_NONE || level >= MP_DSP_SIMD_LEVELS_NUM)
+   {
+      return "unknown";
+   }
+   return sSimdLevelNames[level];
+}
+
 /* ////////////////////////////// PROTECTED /////////////////////////////// */
 
 
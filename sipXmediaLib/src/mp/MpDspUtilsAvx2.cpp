@@ -0,0 +1,395 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include <mp/MpDspUtils.h>
+
+#ifdef MP_DSP_SIMD_USE_X86 // [
+
+#include <immintrin.h>
+
+// DEFINES
+#ifdef _MSC_VER // [
+#  define MP_DSP_AVX2_TARGET
+#else // _MSC_VER ][
+#  define MP_DSP_AVX2_TARGET __attribute__((target("avx2")))
+#endif // !_MSC_VER ]
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* ============================== FUNCTIONS =============================== */
+
+// Functions, which are not here, are taken from SSE2 version.
+
+  /// Same as MpDspUtils::add(int32_t,int32_t), but for 8 values at once.
+static inline MP_DSP_AVX2_TARGET
+__m256i avx2Add32(__m256i a, __m256i b)
+{
+   const __m256i c = _mm256_add_epi32(a, b);
+   // Addition wrapped if a and b have same sign and c have different one.
+   const __m256i wrapped = _mm256_srai_epi32(_mm256_andnot_si256(_mm256_xor_si256(a, b),
+                                                                 _mm256_xor_si256(a, c)),
+                                             31);
+   // (a<0) ? INT32_MIN : INT32_MAX. INT32_MIN is fixed below.
+   const __m256i sat = _mm256_xor_si256(_mm256_srai_epi32(a, 31),
+                                        _mm256_set1_epi32(INT32_MAX));
+   const __m256i res = _mm256_blendv_epi8(c, sat, wrapped);
+   return _mm256_max_epi32(res, _mm256_set1_epi32(INT32_MIN+1));
+}
+
+  /// Load 8 16-bit values and sign-extend them to 32 bits.
+static inline MP_DSP_AVX2_TARGET
+__m256i avx2Load16to32(const int16_t *pSrc)
+{
+   return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)pSrc));
+}
+
+  /// Pack two 32-bit vectors to 16 bits with MPF_SATURATE16() semantics.
+static inline MP_DSP_AVX2_TARGET
+__m256i avx2Saturate32to16(__m256i lo, __m256i hi)
+{
+   // packs works within 128-bit lanes, so restore order of 64-bit parts.
+   const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi),
+                                                   _MM_SHUFFLE(3, 1, 2, 0));
+   return _mm256_max_epi16(packed, _mm256_set1_epi16(-INT16_MAX));
+}
+
+  /// Same as MpDspUtils::shl16() and MpDspUtils::shl32() for 8 values at once.
+static inline MP_DSP_AVX2_TARGET
+__m256i avx2Shl(__m256i a, __m128i scale, __m256i thrMinusOne,
+                __m256i minusThr, __m256i maxVal)
+{
+   const __m256i over = _mm256_cmpgt_epi32(a, thrMinusOne);
+   const __m256i under = _mm256_cmpgt_epi32(minusThr, a);
+   __m256i res = _mm256_sll_epi32(a, scale);
+   res = _mm256_blendv_epi8(res, maxVal, over);
+   return _mm256_blendv_epi8(res, _mm256_sub_epi32(_mm256_setzero_si256(), maxVal),
+                             under);
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Add_I(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m256i acc = _mm256_loadu_si256((const __m256i*)(pSrc2Dst+i));
+      _mm256_storeu_si256((__m256i*)(pSrc2Dst+i),
+                          avx2Add32(acc, avx2Load16to32(pSrc1+i)));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Add_IGain(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(src1ScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m256i acc = _mm256_loadu_si256((const __m256i*)(pSrc2Dst+i));
+      const __m256i src = _mm256_sll_epi32(avx2Load16to32(pSrc1+i), scale);
+      _mm256_storeu_si256((__m256i*)(pSrc2Dst+i), avx2Add32(acc, src));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], ((int32_t)pSrc1[i])<<src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Add_IAtt(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(src1ScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m256i acc = _mm256_loadu_si256((const __m256i*)(pSrc2Dst+i));
+      const __m256i src = _mm256_sra_epi32(avx2Load16to32(pSrc1+i), scale);
+      _mm256_storeu_si256((__m256i*)(pSrc2Dst+i), avx2Add32(acc, src));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]>>src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Add(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m256i a = _mm256_loadu_si256((const __m256i*)(pSrc1+i));
+      const __m256i b = _mm256_loadu_si256((const __m256i*)(pSrc2+i));
+      _mm256_storeu_si256((__m256i*)(pDst+i), avx2Add32(a, b));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MpDspUtils::add(pSrc1[i], pSrc2[i]);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2AddMul_I(const int16_t *pSrc1, int16_t val, int32_t *pSrc2Dst, int dataLength)
+{
+   // Product of two 16-bit values always fits 32 bits.
+   const __m256i mult = _mm256_set1_epi32(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m256i acc = _mm256_loadu_si256((const __m256i*)(pSrc2Dst+i));
+      const __m256i prod = _mm256_mullo_epi32(avx2Load16to32(pSrc1+i), mult);
+      _mm256_storeu_si256((__m256i*)(pSrc2Dst+i), avx2Add32(acc, prod));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::addMul_I(pSrc2Dst[i], pSrc1[i], val);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Mul(const int16_t *pSrc, const int16_t val, int32_t *pDst, int dataLength)
+{
+   const __m256i mult = _mm256_set1_epi32(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      _mm256_storeu_si256((__m256i*)(pDst+i),
+                          _mm256_mullo_epi32(avx2Load16to32(pSrc+i), mult));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]*val;
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert32to16(const int32_t *pSrc, int16_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+16 <= dataLength; i += 16)
+   {
+      const __m256i src0 = _mm256_loadu_si256((const __m256i*)(pSrc+i));
+      const __m256i src1 = _mm256_loadu_si256((const __m256i*)(pSrc+i+8));
+      _mm256_storeu_si256((__m256i*)(pDst+i), avx2Saturate32to16(src0, src1));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert_Gain32to16(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32_t thresold = INT16_MAX>>srcScaleFactor;
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   const __m256i thrMinusOne = _mm256_set1_epi32(thresold-1);
+   const __m256i minusThr = _mm256_set1_epi32(-thresold);
+   const __m256i maxVal = _mm256_set1_epi32(INT16_MAX);
+   int i = 0;
+   for (; i+16 <= dataLength; i += 16)
+   {
+      const __m256i src0 = _mm256_loadu_si256((const __m256i*)(pSrc+i));
+      const __m256i src1 = _mm256_loadu_si256((const __m256i*)(pSrc+i+8));
+      // Values are already in 16-bit range, so packs does not saturate.
+      _mm256_storeu_si256((__m256i*)(pDst+i),
+                          avx2Saturate32to16(avx2Shl(src0, scale, thrMinusOne, minusThr, maxVal),
+                                             avx2Shl(src1, scale, thrMinusOne, minusThr, maxVal)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MpDspUtils::shl16(pSrc[i], srcScaleFactor));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert_Att32to16(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   int i = 0;
+   for (; i+16 <= dataLength; i += 16)
+   {
+      const __m256i src0 = _mm256_loadu_si256((const __m256i*)(pSrc+i));
+      const __m256i src1 = _mm256_loadu_si256((const __m256i*)(pSrc+i+8));
+      _mm256_storeu_si256((__m256i*)(pDst+i),
+                          avx2Saturate32to16(_mm256_sra_epi32(src0, scale),
+                                             _mm256_sra_epi32(src1, scale)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]>>srcScaleFactor));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert16to32(const int16_t *pSrc, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      _mm256_storeu_si256((__m256i*)(pDst+i), avx2Load16to32(pSrc+i));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i];
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert_Gain16to32(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32_t thresold = INT32_MAX>>srcScaleFactor;
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   const __m256i thrMinusOne = _mm256_set1_epi32(thresold-1);
+   const __m256i minusThr = _mm256_set1_epi32(-thresold);
+   const __m256i maxVal = _mm256_set1_epi32(INT32_MAX);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      _mm256_storeu_si256((__m256i*)(pDst+i),
+                          avx2Shl(avx2Load16to32(pSrc+i), scale, thrMinusOne,
+                                  minusThr, maxVal));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MpDspUtils::shl32((int32_t)pSrc[i], srcScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+OsStatus avx2Convert_Att16to32(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      _mm256_storeu_si256((__m256i*)(pDst+i),
+                          _mm256_sra_epi32(avx2Load16to32(pSrc+i), scale));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]>>srcScaleFactor;
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_AVX2_TARGET
+int avx2MaxAbs16(const int16_t *pSrc, int dataLength)
+{
+   // Note, that generic version wraps -INT16_MIN to INT16_MIN, and so do we.
+   // _mm256_abs_epi16() does the same.
+   __m256i maxVal = _mm256_set1_epi16(INT16_MIN);
+   int i = 0;
+   for (; i+16 <= dataLength; i += 16)
+   {
+      const __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc+i));
+      maxVal = _mm256_max_epi16(maxVal, _mm256_abs_epi16(src));
+   }
+   __m128i maxVal128 = _mm_max_epi16(_mm256_castsi256_si128(maxVal),
+                                     _mm256_extracti128_si256(maxVal, 1));
+   maxVal128 = _mm_max_epi16(maxVal128, _mm_shuffle_epi32(maxVal128, _MM_SHUFFLE(1, 0, 3, 2)));
+   maxVal128 = _mm_max_epi16(maxVal128, _mm_shuffle_epi32(maxVal128, _MM_SHUFFLE(2, 3, 0, 1)));
+   maxVal128 = _mm_max_epi16(maxVal128, _mm_shufflelo_epi16(maxVal128, _MM_SHUFFLE(2, 3, 0, 1)));
+   int16_t res = (int16_t)_mm_cvtsi128_si32(maxVal128);
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::maximum(res,
+         (int16_t)( (pSrc[i] > 0) ? pSrc[i] : -(pSrc[i]) ));
+   }
+   return res;
+}
+
+static MP_DSP_AVX2_TARGET
+int32_t avx2CountClippedValues16(const int16_t *pSrc, int dataLength)
+{
+   const __m256i upper = _mm256_set1_epi16(INT16_MAX-1);
+   const __m256i lower = _mm256_set1_epi16(-INT16_MAX+1);
+   const __m256i ones = _mm256_set1_epi16(1);
+   __m256i total = _mm256_setzero_si256();
+   int i = 0;
+   while (i+16 <= dataLength)
+   {
+      // 16-bit counters could not overflow in INT16_MAX iterations.
+      __m256i counts = _mm256_setzero_si256();
+      for (int j = 0; j < INT16_MAX && i+16 <= dataLength; j++, i += 16)
+      {
+         const __m256i src = _mm256_loadu_si256((const __m256i*)(pSrc+i));
+         const __m256i clipped = _mm256_or_si256(_mm256_cmpgt_epi16(src, upper),
+                                                 _mm256_cmpgt_epi16(lower, src));
+         // Mask is -1 for clipped values.
+         counts = _mm256_sub_epi16(counts, clipped);
+      }
+      total = _mm256_add_epi32(total, _mm256_madd_epi16(counts, ones));
+   }
+   int32_t vals[8];
+   _mm256_storeu_si256((__m256i*)vals, total);
+   int32_t clippedCount = 0;
+   for (int j = 0; j < 8; j++)
+   {
+      clippedCount += vals[j];
+   }
+   for (; i<dataLength; i++)
+   {
+      if(pSrc[i] >= INT16_MAX || pSrc[i] <= -INT16_MAX)
+      {
+         clippedCount++;
+      }
+   }
+   return clippedCount;
+}
+
+static const MpDspSimdKernels sAvx2Kernels =
+{
+   avx2Add_I,
+   avx2Add_IGain,
+   avx2Add_IAtt,
+   avx2Add,
+   avx2AddMul_I,
+   NULL, // addMulLinear_I
+   avx2Mul,
+   NULL, // mul_I
+   NULL, // mulLinear
+   avx2Convert32to16,
+   avx2Convert_Gain32to16,
+   avx2Convert_Att32to16,
+   avx2Convert16to32,
+   avx2Convert_Gain16to32,
+   avx2Convert_Att16to32,
+   avx2MaxAbs16,
+   NULL, // maximum16
+   NULL, // maximum32
+   NULL, // minimum16
+   NULL, // minimum32
+   avx2CountClippedValues16
+};
+
+const MpDspSimdKernels *mpDspGetAvx2Kernels()
+{
+   return &sAvx2Kernels;
+}
+
+#endif // MP_DSP_SIMD_USE_X86 ]
@@ -0,0 +1,294 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include <mp/MpDspUtils.h>
+
+#ifdef MP_DSP_SIMD_USE_NEON // [
+
+#include <arm_neon.h>
+
+// DEFINES
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* ============================== FUNCTIONS =============================== */
+
+  /// Same as MpDspUtils::add(int32_t,int32_t), but for 4 values at once.
+static inline
+int32x4_t neonAdd32(int32x4_t a, int32x4_t b)
+{
+   // qadd saturates to INT32_MIN, while we want (INT32_MIN+1).
+   return vmaxq_s32(vqaddq_s32(a, b), vdupq_n_s32(INT32_MIN+1));
+}
+
+  /// Pack two 32-bit vectors to 16 bits with MPF_SATURATE16() semantics.
+static inline
+int16x8_t neonSaturate32to16(int32x4_t lo, int32x4_t hi)
+{
+   const int16x8_t packed = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+   return vmaxq_s16(packed, vdupq_n_s16(-INT16_MAX));
+}
+
+static OsStatus neonAdd_I(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc1+i);
+      vst1q_s32(pSrc2Dst+i, neonAdd32(vld1q_s32(pSrc2Dst+i),
+                                      vmovl_s16(vget_low_s16(src))));
+      vst1q_s32(pSrc2Dst+i+4, neonAdd32(vld1q_s32(pSrc2Dst+i+4),
+                                        vmovl_s16(vget_high_s16(src))));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]);
+   }
+   return OS_SUCCESS;
+}
+
+  /// Add source vector shifted by \p shift (left if positive) to accumulator.
+static inline
+void neonAddShifted(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength,
+                    int shift, int &i)
+{
+   const int32x4_t shiftVect = vdupq_n_s32(shift);
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc1+i);
+      const int32x4_t src0 = vshlq_s32(vmovl_s16(vget_low_s16(src)), shiftVect);
+      const int32x4_t src1 = vshlq_s32(vmovl_s16(vget_high_s16(src)), shiftVect);
+      vst1q_s32(pSrc2Dst+i, neonAdd32(vld1q_s32(pSrc2Dst+i), src0));
+      vst1q_s32(pSrc2Dst+i+4, neonAdd32(vld1q_s32(pSrc2Dst+i+4), src1));
+   }
+}
+
+static OsStatus neonAdd_IGain(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   int i = 0;
+   neonAddShifted(pSrc1, pSrc2Dst, dataLength, (int)src1ScaleFactor, i);
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], ((int32_t)pSrc1[i])<<src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonAdd_IAtt(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   int i = 0;
+   // Shift by negative value is arithmetic right shift for signed vectors.
+   neonAddShifted(pSrc1, pSrc2Dst, dataLength, -(int)src1ScaleFactor, i);
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]>>src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonAdd(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+4 <= dataLength; i += 4)
+   {
+      vst1q_s32(pDst+i, neonAdd32(vld1q_s32(pSrc1+i), vld1q_s32(pSrc2+i)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MpDspUtils::add(pSrc1[i], pSrc2[i]);
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonAddMul_I(const int16_t *pSrc1, int16_t val, int32_t *pSrc2Dst, int dataLength)
+{
+   const int16x4_t mult = vdup_n_s16(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc1+i);
+      vst1q_s32(pSrc2Dst+i, neonAdd32(vld1q_s32(pSrc2Dst+i),
+                                      vmull_s16(vget_low_s16(src), mult)));
+      vst1q_s32(pSrc2Dst+i+4, neonAdd32(vld1q_s32(pSrc2Dst+i+4),
+                                        vmull_s16(vget_high_s16(src), mult)));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::addMul_I(pSrc2Dst[i], pSrc1[i], val);
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonMul(const int16_t *pSrc, const int16_t val, int32_t *pDst, int dataLength)
+{
+   const int16x4_t mult = vdup_n_s16(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc+i);
+      vst1q_s32(pDst+i, vmull_s16(vget_low_s16(src), mult));
+      vst1q_s32(pDst+i+4, vmull_s16(vget_high_s16(src), mult));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]*val;
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonConvert32to16(const int32_t *pSrc, int16_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      vst1q_s16(pDst+i, neonSaturate32to16(vld1q_s32(pSrc+i), vld1q_s32(pSrc+i+4)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]));
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonConvert_Att32to16(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32x4_t shift = vdupq_n_s32(-(int)srcScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      vst1q_s16(pDst+i, neonSaturate32to16(vshlq_s32(vld1q_s32(pSrc+i), shift),
+                                           vshlq_s32(vld1q_s32(pSrc+i+4), shift)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]>>srcScaleFactor));
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonConvert16to32(const int16_t *pSrc, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc+i);
+      vst1q_s32(pDst+i, vmovl_s16(vget_low_s16(src)));
+      vst1q_s32(pDst+i+4, vmovl_s16(vget_high_s16(src)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i];
+   }
+   return OS_SUCCESS;
+}
+
+static OsStatus neonConvert_Att16to32(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32x4_t shift = vdupq_n_s32(-(int)srcScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const int16x8_t src = vld1q_s16(pSrc+i);
+      vst1q_s32(pDst+i, vshlq_s32(vmovl_s16(vget_low_s16(src)), shift));
+      vst1q_s32(pDst+i+4, vshlq_s32(vmovl_s16(vget_high_s16(src)), shift));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]>>srcScaleFactor;
+   }
+   return OS_SUCCESS;
+}
+
+static int neonMaxAbs16(const int16_t *pSrc, int dataLength)
+{
+   // Note, that generic version wraps -INT16_MIN to INT16_MIN. Non-saturating
+   // vabsq_s16() does the same.
+   int16x8_t maxVal = vdupq_n_s16(INT16_MIN);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      maxVal = vmaxq_s16(maxVal, vabsq_s16(vld1q_s16(pSrc+i)));
+   }
+   int16x4_t maxVal64 = vpmax_s16(vget_low_s16(maxVal), vget_high_s16(maxVal));
+   maxVal64 = vpmax_s16(maxVal64, maxVal64);
+   maxVal64 = vpmax_s16(maxVal64, maxVal64);
+   int16_t res = vget_lane_s16(maxVal64, 0);
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::maximum(res,
+         (int16_t)( (pSrc[i] > 0) ? pSrc[i] : -(pSrc[i]) ));
+   }
+   return res;
+}
+
+static int32_t neonCountClippedValues16(const int16_t *pSrc, int dataLength)
+{
+   const int16x8_t upper = vdupq_n_s16(INT16_MAX-1);
+   const int16x8_t lower = vdupq_n_s16(-INT16_MAX+1);
+   uint32x4_t total = vdupq_n_u32(0);
+   int i = 0;
+   while (i+8 <= dataLength)
+   {
+      // 16-bit counters could not overflow in INT16_MAX iterations.
+      uint16x8_t counts = vdupq_n_u16(0);
+      for (int j = 0; j < INT16_MAX && i+8 <= dataLength; j++, i += 8)
+      {
+         const int16x8_t src = vld1q_s16(pSrc+i);
+         const uint16x8_t clipped = vorrq_u16(vcgtq_s16(src, upper),
+                                              vcltq_s16(src, lower));
+         // Mask is all ones for clipped values, so subtraction adds one.
+         counts = vsubq_u16(counts, clipped);
+      }
+      total = vaddq_u32(total, vpaddlq_u16(counts));
+   }
+   int32_t clippedCount = vgetq_lane_u32(total, 0) + vgetq_lane_u32(total, 1)
+                        + vgetq_lane_u32(total, 2) + vgetq_lane_u32(total, 3);
+   for (; i<dataLength; i++)
+   {
+      if(pSrc[i] >= INT16_MAX || pSrc[i] <= -INT16_MAX)
+      {
+         clippedCount++;
+      }
+   }
+   return clippedCount;
+}
+
+static const MpDspSimdKernels sNeonKernels =
+{
+   neonAdd_I,
+   neonAdd_IGain,
+   neonAdd_IAtt,
+   neonAdd,
+   neonAddMul_I,
+   NULL, // addMulLinear_I
+   neonMul,
+   NULL, // mul_I
+   NULL, // mulLinear
+   neonConvert32to16,
+   NULL, // convert_Gain32to16
+   neonConvert_Att32to16,
+   neonConvert16to32,
+   NULL, // convert_Gain16to32
+   neonConvert_Att16to32,
+   neonMaxAbs16,
+   NULL, // maximum16
+   NULL, // maximum32
+   NULL, // minimum16
+   NULL, // minimum32
+   neonCountClippedValues16
+};
+
+const MpDspSimdKernels *mpDspGetNeonKernels()
+{
+   return &sNeonKernels;
+}
+
+#endif // MP_DSP_SIMD_USE_NEON ]
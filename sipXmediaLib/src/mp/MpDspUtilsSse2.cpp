@@ -0,0 +1,637 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include <mp/MpDspUtils.h>
+
+#ifdef MP_DSP_SIMD_USE_X86 // [
+
+#include <emmintrin.h>
+
+// DEFINES
+#ifdef _MSC_VER // [
+#  define MP_DSP_SSE2_TARGET
+#else // _MSC_VER ][
+#  define MP_DSP_SSE2_TARGET __attribute__((target("sse2")))
+#endif // !_MSC_VER ]
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* ============================== FUNCTIONS =============================== */
+
+  /// Same as MpDspUtils::add(int32_t,int32_t), but for 4 values at once.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Add32(__m128i a, __m128i b)
+{
+   const __m128i c = _mm_add_epi32(a, b);
+   // Addition wrapped if a and b have same sign and c have different one.
+   const __m128i wrapped = _mm_srai_epi32(_mm_andnot_si128(_mm_xor_si128(a, b),
+                                                           _mm_xor_si128(a, c)),
+                                          31);
+   // (a<0) ? INT32_MIN : INT32_MAX. INT32_MIN is fixed below.
+   const __m128i sat = _mm_xor_si128(_mm_srai_epi32(a, 31),
+                                     _mm_set1_epi32(INT32_MAX));
+   const __m128i res = _mm_or_si128(_mm_and_si128(wrapped, sat),
+                                    _mm_andnot_si128(wrapped, c));
+   // Saturate INT32_MIN to (INT32_MIN+1): subtracting -1 adds one.
+   return _mm_sub_epi32(res, _mm_cmpeq_epi32(res, _mm_set1_epi32(INT32_MIN)));
+}
+
+  /// Sign-extend lower 4 values of 16-bit vector to 32 bits.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Lo16to32(__m128i a)
+{
+   return _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+}
+
+  /// Sign-extend upper 4 values of 16-bit vector to 32 bits.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Hi16to32(__m128i a)
+{
+   return _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16);
+}
+
+  /// Select values from a where mask is set and from b elsewhere.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+  /// Pack two 32-bit vectors to 16 bits with MPF_SATURATE16() semantics.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Saturate32to16(__m128i lo, __m128i hi)
+{
+   // packs saturates to [INT16_MIN;INT16_MAX], we need [-INT16_MAX;INT16_MAX].
+   return _mm_max_epi16(_mm_packs_epi32(lo, hi), _mm_set1_epi16(-INT16_MAX));
+}
+
+  /// Same as MpDspUtils::shl16() for 4 values at once.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Shl16(__m128i a, __m128i scale, __m128i thrMinusOne,
+                  __m128i minusThr)
+{
+   const __m128i over = _mm_cmpgt_epi32(a, thrMinusOne);
+   const __m128i under = _mm_cmplt_epi32(a, minusThr);
+   __m128i res = _mm_sll_epi32(a, scale);
+   res = sse2Select(over, _mm_set1_epi32(INT16_MAX), res);
+   return sse2Select(under, _mm_set1_epi32(-INT16_MAX), res);
+}
+
+  /// Same as MpDspUtils::shl32() for 4 values at once.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Shl32(__m128i a, __m128i scale, __m128i thrMinusOne,
+                  __m128i minusThr)
+{
+   const __m128i over = _mm_cmpgt_epi32(a, thrMinusOne);
+   const __m128i under = _mm_cmplt_epi32(a, minusThr);
+   __m128i res = _mm_sll_epi32(a, scale);
+   res = sse2Select(over, _mm_set1_epi32(INT32_MAX), res);
+   return sse2Select(under, _mm_set1_epi32(-INT32_MAX), res);
+}
+
+  /// Horizontal maximum of 16-bit vector.
+static inline MP_DSP_SSE2_TARGET
+int16_t sse2HMax16(__m128i a)
+{
+   a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+   a = _mm_max_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+   a = _mm_max_epi16(a, _mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 3, 0, 1)));
+   return (int16_t)_mm_cvtsi128_si32(a);
+}
+
+  /// Horizontal minimum of 16-bit vector.
+static inline MP_DSP_SSE2_TARGET
+int16_t sse2HMin16(__m128i a)
+{
+   a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+   a = _mm_min_epi16(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+   a = _mm_min_epi16(a, _mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 3, 0, 1)));
+   return (int16_t)_mm_cvtsi128_si32(a);
+}
+
+  /// Per-value multiply of 16-bit vectors giving full 32-bit products.
+static inline MP_DSP_SSE2_TARGET
+void sse2Mul16to32(__m128i a, __m128i b, __m128i &lo, __m128i &hi)
+{
+   const __m128i prodLo = _mm_mullo_epi16(a, b);
+   const __m128i prodHi = _mm_mulhi_epi16(a, b);
+   lo = _mm_unpacklo_epi16(prodLo, prodHi);
+   hi = _mm_unpackhi_epi16(prodLo, prodHi);
+}
+
+  /// Vector with values (val, val+step, ..., val+7*step) wrapped to 16 bits.
+static inline MP_DSP_SSE2_TARGET
+__m128i sse2Ramp16(int16_t val, int16_t step)
+{
+   int16_t vals[8];
+   for (int i = 0; i < 8; i++, val += step)
+   {
+      vals[i] = val;
+   }
+   return _mm_loadu_si128((const __m128i*)vals);
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Add_I(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc1+i));
+      const __m128i acc0 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i));
+      const __m128i acc1 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i+4));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i), sse2Add32(acc0, sse2Lo16to32(src)));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i+4), sse2Add32(acc1, sse2Hi16to32(src)));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Add_IGain(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(src1ScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc1+i));
+      const __m128i acc0 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i));
+      const __m128i acc1 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i+4));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i),
+                       sse2Add32(acc0, _mm_sll_epi32(sse2Lo16to32(src), scale)));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i+4),
+                       sse2Add32(acc1, _mm_sll_epi32(sse2Hi16to32(src), scale)));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], ((int32_t)pSrc1[i])<<src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Add_IAtt(const int16_t *pSrc1, int32_t *pSrc2Dst, int dataLength, unsigned src1ScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(src1ScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc1+i));
+      const __m128i acc0 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i));
+      const __m128i acc1 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i+4));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i),
+                       sse2Add32(acc0, _mm_sra_epi32(sse2Lo16to32(src), scale)));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i+4),
+                       sse2Add32(acc1, _mm_sra_epi32(sse2Hi16to32(src), scale)));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::add_I(pSrc2Dst[i], (int32_t)pSrc1[i]>>src1ScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Add(const int32_t *pSrc1, const int32_t *pSrc2, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+4 <= dataLength; i += 4)
+   {
+      const __m128i a = _mm_loadu_si128((const __m128i*)(pSrc1+i));
+      const __m128i b = _mm_loadu_si128((const __m128i*)(pSrc2+i));
+      _mm_storeu_si128((__m128i*)(pDst+i), sse2Add32(a, b));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MpDspUtils::add(pSrc1[i], pSrc2[i]);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2AddMul_I(const int16_t *pSrc1, int16_t val, int32_t *pSrc2Dst, int dataLength)
+{
+   const __m128i mult = _mm_set1_epi16(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      __m128i prod0;
+      __m128i prod1;
+      sse2Mul16to32(_mm_loadu_si128((const __m128i*)(pSrc1+i)), mult, prod0, prod1);
+      const __m128i acc0 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i));
+      const __m128i acc1 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i+4));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i), sse2Add32(acc0, prod0));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i+4), sse2Add32(acc1, prod1));
+   }
+   for (; i<dataLength; i++)
+   {
+      MpDspUtils::addMul_I(pSrc2Dst[i], pSrc1[i], val);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2AddMulLinear_I(const int16_t *pSrc1, int16_t valStart, int16_t valEnd,
+                            int32_t *pSrc2Dst, int dataLength)
+{
+   // See MpDspUtils::addMulLinear_I() for the limitations of this approach.
+   const int16_t step = (valEnd - valStart) / dataLength;
+   __m128i mult = sse2Ramp16(valStart, step);
+   const __m128i multStep = _mm_set1_epi16((int16_t)(step*8));
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      __m128i prod0;
+      __m128i prod1;
+      sse2Mul16to32(_mm_loadu_si128((const __m128i*)(pSrc1+i)), mult, prod0, prod1);
+      const __m128i acc0 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i));
+      const __m128i acc1 = _mm_loadu_si128((const __m128i*)(pSrc2Dst+i+4));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i), sse2Add32(acc0, prod0));
+      _mm_storeu_si128((__m128i*)(pSrc2Dst+i+4), sse2Add32(acc1, prod1));
+      mult = _mm_add_epi16(mult, multStep);
+   }
+   int16_t val = (int16_t)_mm_cvtsi128_si32(mult);
+   for (; i<dataLength; i++, val += step)
+   {
+      MpDspUtils::addMul_I(pSrc2Dst[i], pSrc1[i], val);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Mul(const int16_t *pSrc, const int16_t val, int32_t *pDst, int dataLength)
+{
+   const __m128i mult = _mm_set1_epi16(val);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      __m128i prod0;
+      __m128i prod1;
+      sse2Mul16to32(_mm_loadu_si128((const __m128i*)(pSrc+i)), mult, prod0, prod1);
+      _mm_storeu_si128((__m128i*)(pDst+i), prod0);
+      _mm_storeu_si128((__m128i*)(pDst+i+4), prod1);
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]*val;
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Mul_I(int16_t *pSrcDst, const int16_t val, int dataLength)
+{
+   const int16_t thresold = INT16_MAX/val;
+   const __m128i mult = _mm_set1_epi16(val);
+   const __m128i thr = _mm_set1_epi16(thresold);
+   const __m128i minusThr = _mm_set1_epi16(-thresold);
+   const __m128i maxVal = _mm_set1_epi16(INT16_MAX);
+   const __m128i minVal = _mm_set1_epi16(-INT16_MAX);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrcDst+i));
+      __m128i res = _mm_mullo_epi16(src, mult);
+      res = sse2Select(_mm_cmplt_epi16(src, minusThr), minVal, res);
+      res = sse2Select(_mm_cmpgt_epi16(src, thr), maxVal, res);
+      _mm_storeu_si128((__m128i*)(pSrcDst+i), res);
+   }
+   for (; i<dataLength; i++)
+   {
+      if (pSrcDst[i] > thresold)
+      {
+         pSrcDst[i] = INT16_MAX;
+      }
+      else if (pSrcDst[i] < -thresold)
+      {
+         pSrcDst[i] = -INT16_MAX;
+      }
+      else
+      {
+         pSrcDst[i] *= val;
+      }
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2MulLinear(const int16_t *pSrc, int16_t valStart, int16_t valEnd,
+                       int32_t *pDst, int dataLength)
+{
+   // See MpDspUtils::mulLinear() for the limitations of this approach.
+   const int16_t step = (valEnd - valStart) / dataLength;
+   __m128i mult = sse2Ramp16(valStart, step);
+   const __m128i multStep = _mm_set1_epi16((int16_t)(step*8));
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      __m128i prod0;
+      __m128i prod1;
+      sse2Mul16to32(_mm_loadu_si128((const __m128i*)(pSrc+i)), mult, prod0, prod1);
+      _mm_storeu_si128((__m128i*)(pDst+i), prod0);
+      _mm_storeu_si128((__m128i*)(pDst+i+4), prod1);
+      mult = _mm_add_epi16(mult, multStep);
+   }
+   int16_t val = (int16_t)_mm_cvtsi128_si32(mult);
+   for (; i<dataLength; i++, val += step)
+   {
+      pDst[i] = pSrc[i] * val;
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert32to16(const int32_t *pSrc, int16_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src0 = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      const __m128i src1 = _mm_loadu_si128((const __m128i*)(pSrc+i+4));
+      _mm_storeu_si128((__m128i*)(pDst+i), sse2Saturate32to16(src0, src1));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert_Gain32to16(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32_t thresold = INT16_MAX>>srcScaleFactor;
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   const __m128i thrMinusOne = _mm_set1_epi32(thresold-1);
+   const __m128i minusThr = _mm_set1_epi32(-thresold);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src0 = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      const __m128i src1 = _mm_loadu_si128((const __m128i*)(pSrc+i+4));
+      // Values are already in 16-bit range, so packs does not saturate.
+      _mm_storeu_si128((__m128i*)(pDst+i),
+                       _mm_packs_epi32(sse2Shl16(src0, scale, thrMinusOne, minusThr),
+                                       sse2Shl16(src1, scale, thrMinusOne, minusThr)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MpDspUtils::shl16(pSrc[i], srcScaleFactor));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert_Att32to16(const int32_t *pSrc, int16_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src0 = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      const __m128i src1 = _mm_loadu_si128((const __m128i*)(pSrc+i+4));
+      _mm_storeu_si128((__m128i*)(pDst+i),
+                       sse2Saturate32to16(_mm_sra_epi32(src0, scale),
+                                          _mm_sra_epi32(src1, scale)));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MPF_EXTRACRT16(MPF_SATURATE16(pSrc[i]>>srcScaleFactor));
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert16to32(const int16_t *pSrc, int32_t *pDst, int dataLength)
+{
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      _mm_storeu_si128((__m128i*)(pDst+i), sse2Lo16to32(src));
+      _mm_storeu_si128((__m128i*)(pDst+i+4), sse2Hi16to32(src));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i];
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert_Gain16to32(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const int32_t thresold = INT32_MAX>>srcScaleFactor;
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   const __m128i thrMinusOne = _mm_set1_epi32(thresold-1);
+   const __m128i minusThr = _mm_set1_epi32(-thresold);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      _mm_storeu_si128((__m128i*)(pDst+i),
+                       sse2Shl32(sse2Lo16to32(src), scale, thrMinusOne, minusThr));
+      _mm_storeu_si128((__m128i*)(pDst+i+4),
+                       sse2Shl32(sse2Hi16to32(src), scale, thrMinusOne, minusThr));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = MpDspUtils::shl32((int32_t)pSrc[i], srcScaleFactor);
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+OsStatus sse2Convert_Att16to32(const int16_t *pSrc, int32_t *pDst, int dataLength, unsigned srcScaleFactor)
+{
+   const __m128i scale = _mm_cvtsi32_si128(srcScaleFactor);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      _mm_storeu_si128((__m128i*)(pDst+i), _mm_sra_epi32(sse2Lo16to32(src), scale));
+      _mm_storeu_si128((__m128i*)(pDst+i+4), _mm_sra_epi32(sse2Hi16to32(src), scale));
+   }
+   for (; i<dataLength; i++)
+   {
+      pDst[i] = pSrc[i]>>srcScaleFactor;
+   }
+   return OS_SUCCESS;
+}
+
+static MP_DSP_SSE2_TARGET
+int sse2MaxAbs16(const int16_t *pSrc, int dataLength)
+{
+   // Note, that generic version wraps -INT16_MIN to INT16_MIN, and so do we.
+   const __m128i zero = _mm_setzero_si128();
+   __m128i maxVal = _mm_set1_epi16(INT16_MIN);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      const __m128i absVal = _mm_max_epi16(src, _mm_sub_epi16(zero, src));
+      maxVal = _mm_max_epi16(maxVal, absVal);
+   }
+   int16_t res = sse2HMax16(maxVal);
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::maximum(res,
+         (int16_t)( (pSrc[i] > 0) ? pSrc[i] : -(pSrc[i]) ));
+   }
+   return res;
+}
+
+static MP_DSP_SSE2_TARGET
+int16_t sse2Maximum16(const int16_t *pSrc, int dataLength)
+{
+   __m128i maxVal = _mm_set1_epi16(INT16_MIN);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      maxVal = _mm_max_epi16(maxVal, _mm_loadu_si128((const __m128i*)(pSrc+i)));
+   }
+   int16_t res = sse2HMax16(maxVal);
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::maximum(res, pSrc[i]);
+   }
+   return res;
+}
+
+static MP_DSP_SSE2_TARGET
+int16_t sse2Minimum16(const int16_t *pSrc, int dataLength)
+{
+   __m128i minVal = _mm_set1_epi16(INT16_MAX);
+   int i = 0;
+   for (; i+8 <= dataLength; i += 8)
+   {
+      minVal = _mm_min_epi16(minVal, _mm_loadu_si128((const __m128i*)(pSrc+i)));
+   }
+   int16_t res = sse2HMin16(minVal);
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::minimum(res, pSrc[i]);
+   }
+   return res;
+}
+
+static MP_DSP_SSE2_TARGET
+int32_t sse2Maximum32(const int32_t *pSrc, int dataLength)
+{
+   __m128i maxVal = _mm_set1_epi32(INT32_MIN);
+   int i = 0;
+   for (; i+4 <= dataLength; i += 4)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      maxVal = sse2Select(_mm_cmpgt_epi32(src, maxVal), src, maxVal);
+   }
+   int32_t vals[4];
+   _mm_storeu_si128((__m128i*)vals, maxVal);
+   int32_t res = MpDspUtils::maximum(MpDspUtils::maximum(vals[0], vals[1]),
+                                     MpDspUtils::maximum(vals[2], vals[3]));
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::maximum(res, pSrc[i]);
+   }
+   return res;
+}
+
+static MP_DSP_SSE2_TARGET
+int32_t sse2Minimum32(const int32_t *pSrc, int dataLength)
+{
+   __m128i minVal = _mm_set1_epi32(INT32_MAX);
+   int i = 0;
+   for (; i+4 <= dataLength; i += 4)
+   {
+      const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+      minVal = sse2Select(_mm_cmplt_epi32(src, minVal), src, minVal);
+   }
+   int32_t vals[4];
+   _mm_storeu_si128((__m128i*)vals, minVal);
+   int32_t res = MpDspUtils::minimum(MpDspUtils::minimum(vals[0], vals[1]),
+                                     MpDspUtils::minimum(vals[2], vals[3]));
+   for (; i<dataLength; i++)
+   {
+      res = MpDspUtils::minimum(res, pSrc[i]);
+   }
+   return res;
+}
+
+static MP_DSP_SSE2_TARGET
+int32_t sse2CountClippedValues16(const int16_t *pSrc, int dataLength)
+{
+   const __m128i upper = _mm_set1_epi16(INT16_MAX-1);
+   const __m128i lower = _mm_set1_epi16(-INT16_MAX+1);
+   const __m128i ones = _mm_set1_epi16(1);
+   __m128i total = _mm_setzero_si128();
+   int i = 0;
+   while (i+8 <= dataLength)
+   {
+      // 16-bit counters could not overflow in INT16_MAX iterations.
+      __m128i counts = _mm_setzero_si128();
+      for (int j = 0; j < INT16_MAX && i+8 <= dataLength; j++, i += 8)
+      {
+         const __m128i src = _mm_loadu_si128((const __m128i*)(pSrc+i));
+         const __m128i clipped = _mm_or_si128(_mm_cmpgt_epi16(src, upper),
+                                              _mm_cmplt_epi16(src, lower));
+         // Mask is -1 for clipped values.
+         counts = _mm_sub_epi16(counts, clipped);
+      }
+      total = _mm_add_epi32(total, _mm_madd_epi16(counts, ones));
+   }
+   int32_t vals[4];
+   _mm_storeu_si128((__m128i*)vals, total);
+   int32_t clippedCount = vals[0] + vals[1] + vals[2] + vals[3];
+   for (; i<dataLength; i++)
+   {
+      if(pSrc[i] >= INT16_MAX || pSrc[i] <= -INT16_MAX)
+      {
+         clippedCount++;
+      }
+   }
+   return clippedCount;
+}
+
+static const MpDspSimdKernels sSse2Kernels =
+{
+   sse2Add_I,
+   sse2Add_IGain,
+   sse2Add_IAtt,
+   sse2Add,
+   sse2AddMul_I,
+   sse2AddMulLinear_I,
+   sse2Mul,
+   sse2Mul_I,
+   sse2MulLinear,
+   sse2Convert32to16,
+   sse2Convert_Gain32to16,
+   sse2Convert_Att32to16,
+   sse2Convert16to32,
+   sse2Convert_Gain16to32,
+   sse2Convert_Att16to32,
+   sse2MaxAbs16,
+   sse2Maximum16,
+   sse2Maximum32,
+   sse2Minimum16,
+   sse2Minimum32,
+   sse2CountClippedValues16
+};
+
+const MpDspSimdKernels *mpDspGetSse2Kernels()
+{
+   return &sSse2Kernels;
+}
+
+#endif // MP_DSP_SIMD_USE_X86 ]
@@ -0,0 +1,118 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "mp/MpEncodedFrameCache.h"
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+MpEncodedFrameCache::MpEncodedFrameCache()
+: mNextEntry(0)
+, mHits(0)
+, mStores(0)
+{
+   for (int i = 0; i < MAX_ENTRIES; i++)
+   {
+      mEntries[i].mFrameNum = -1;
+      mEntries[i].mpData = NULL;
+      mEntries[i].mDataSize = 0;
+      mEntries[i].mBytes = 0;
+   }
+}
+
+MpEncodedFrameCache::~MpEncodedFrameCache()
+{
+   for (int i = 0; i < MAX_ENTRIES; i++)
+   {
+      delete[] mEntries[i].mpData;
+   }
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+const unsigned char* MpEncodedFrameCache::find(const MpBufPtr& pSource,
+                                               const UtlString& codecKey,
+                                               int frameNum,
+                                               int& rBytes)
+{
+   for (int i = 0; i < MAX_ENTRIES; i++)
+   {
+      Entry& entry = mEntries[i];
+      if (entry.mFrameNum == frameNum &&
+          entry.mpSource == pSource &&
+          entry.mCodecKey == codecKey)
+      {
+         mHits++;
+         rBytes = entry.mBytes;
+         return entry.mpData;
+      }
+   }
+   return NULL;
+}
+
+unsigned char* MpEncodedFrameCache::store(const MpBufPtr& pSource,
+                                          const UtlString& codecKey,
+                                          int frameNum,
+                                          int bytes)
+{
+   // Replace an entry of an older frame, if there is one.
+   int i;
+   for (i = 0; i < MAX_ENTRIES; i++)
+   {
+      if (mEntries[i].mFrameNum != frameNum)
+      {
+         break;
+      }
+   }
+   if (i == MAX_ENTRIES)
+   {
+      i = mNextEntry;
+      mNextEntry = (mNextEntry + 1) % MAX_ENTRIES;
+   }
+
+   Entry& entry = mEntries[i];
+   if (entry.mDataSize < bytes)
+   {
+      delete[] entry.mpData;
+      entry.mpData = new unsigned char[bytes];
+      entry.mDataSize = bytes;
+   }
+   entry.mpSource = pSource;
+   entry.mCodecKey = codecKey;
+   entry.mFrameNum = frameNum;
+   entry.mBytes = bytes;
+   mStores++;
+
+   return entry.mpData;
+}
+
+void MpEncodedFrameCache::reset()
+{
+   for (int i = 0; i < MAX_ENTRIES; i++)
+   {
+      mEntries[i].mpSource.release();
+      mEntries[i].mFrameNum = -1;
+   }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
@@ -143,6 +143,32 @@ OsStatus MpEncoderBase::encode(const MpAudioSample* pAudioSamples,
    return OS_SUCCESS;
 }
 
+OsStatus MpEncoderBase::encodeBatch(int numFrames,
+                                    const MpAudioSample* const pAudioFrames[],
+                                    int numSamples,
+                                    unsigned char* const pCodeBufs[],
+                                    int bytesLeft,
+                                    int& rSizeInBytes)
+{
+   if (!supportsBatch())
+   {
+      return OS_NOT_SUPPORTED;
+   }
+   if (!mInitialized)
+   {
+      return OS_INVALID_STATE;
+   }
+
+   if (mCallInfo.mPlgEncodeBatch(plgHandle, numFrames,
+                                 (const void* const*)pAudioFrames, numSamples,
+                                 (void* const*)pCodeBufs, bytesLeft,
+                                 &rSizeInBytes) != RPLG_SUCCESS)
+   {
+      return OS_FAILED;
+   }
+   return OS_SUCCESS;
+}
+
 
 /* ============================ ACCESSORS ================================= */
 
@@ -162,4 +188,9 @@ int MpEncoderBase::getPayloadType()
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean MpEncoderBase::supportsBatch() const
+{
+   return mCallInfo.mPlgEncodeBatch != NULL;
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
@@ -26,6 +26,7 @@
 #include "mp/MpFlowGraphMsg.h"
 #include "mp/MpResourceMsg.h"
 #include "mp/MpSyncFlowgraphMsg.h"
+#include "mp/MpEncodedFrameCache.h"
 #include "mp/MpResourceSortAlg.h"
 #include "mp/MpMediaTask.h"
 #include <mp/MpMisc.h>
@@ -70,6 +71,7 @@ CBaseClass(CBASECLASS_CALL_ARGS("MpFlowGraphBase", __LINE__)),
 , mSamplesPerFrame(samplesPerFrame)
 , mSamplesPerSec(samplesPerSec)
 , mpResourceInProcess(NULL)
+, mpEncodedFrameCache(new MpEncodedFrameCache())
 #ifdef INCLUDE_RTCP /* [ */
 , mulEventInterest(LOCAL_SSRC_COLLISION | REMOTE_SSRC_COLLISION)
 , mRtcpConnMutex(OsMutex::Q_FIFO)
@@ -166,6 +168,8 @@ MpFlowGraphBase::~MpFlowGraphBase()
    mRtcpConnMap.destroyAll();
    OsSysLog::add(FAC_MP, PRI_DEBUG, "MpFlowGraphBase::~(): Conn Map contains %ld items", mRtcpConnMap.entries());
 #endif /* INCLUDE_RTCP ] */
+
+   delete mpEncodedFrameCache;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <math.h>
+#include <assert.h>
+
+// APPLICATION INCLUDES
+#include "mp/MpGoertzelBank.h"
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+  /// Part of the power which isBelowPower() allows for the sum bound.
+#define POWER_GATE_MARGIN 0.5
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+MpGoertzelBank::MpGoertzelBank()
+: mNumFreqs(0)
+{
+   for (int i = 0; i < MAX_FREQS; i++)
+   {
+      mCoefs[i] = 0.0;
+   }
+   reset();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void MpGoertzelBank::setCoefficients(int numFreqs, const double coefs[])
+{
+   assert(numFreqs >= 0 && numFreqs <= MAX_FREQS);
+
+   mNumFreqs = numFreqs;
+   for (int i = 0; i < MAX_FREQS; i++)
+   {
+      mCoefs[i] = (i < numFreqs) ? coefs[i] : 0.0;
+   }
+   reset();
+}
+
+void MpGoertzelBank::reset()
+{
+   for (int i = 0; i < MAX_FREQS; i++)
+   {
+      mQ1[i] = 0.0;
+      mQ2[i] = 0.0;
+   }
+}
+
+void MpGoertzelBank::process(const MpAudioSample *pSamples, int numSamples)
+{
+   // Unused filters of the last group have zero coefficients, they are
+   // run along with the others and their output is ignored.
+   for (int f = 0; f < mNumFreqs; f += FREQS_PER_GROUP)
+   {
+      const double c0 = mCoefs[f];
+      const double c1 = mCoefs[f+1];
+      const double c2 = mCoefs[f+2];
+      const double c3 = mCoefs[f+3];
+      double q1_0 = mQ1[f];
+      double q1_1 = mQ1[f+1];
+      double q1_2 = mQ1[f+2];
+      double q1_3 = mQ1[f+3];
+      double q2_0 = mQ2[f];
+      double q2_1 = mQ2[f+1];
+      double q2_2 = mQ2[f+2];
+      double q2_3 = mQ2[f+3];
+
+      for (int n = 0; n < numSamples; n++)
+      {
+         const double x = pSamples[n];
+         const double q0_0 = c0 * q1_0 - q2_0 + x;
+         const double q0_1 = c1 * q1_1 - q2_1 + x;
+         const double q0_2 = c2 * q1_2 - q2_2 + x;
+         const double q0_3 = c3 * q1_3 - q2_3 + x;
+         q2_0 = q1_0;
+         q2_1 = q1_1;
+         q2_2 = q1_2;
+         q2_3 = q1_3;
+         q1_0 = q0_0;
+         q1_1 = q0_1;
+         q1_2 = q0_2;
+         q1_3 = q0_3;
+      }
+
+      mQ1[f] = q1_0;
+      mQ1[f+1] = q1_1;
+      mQ1[f+2] = q1_2;
+      mQ1[f+3] = q1_3;
+      mQ2[f] = q2_0;
+      mQ2[f+1] = q2_1;
+      mQ2[f+2] = q2_2;
+      mQ2[f+3] = q2_3;
+   }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+void MpGoertzelBank::getPowers(double powers[]) const
+{
+   for (int i = 0; i < mNumFreqs; i++)
+   {
+      powers[i] = (mQ1[i] * mQ1[i]) + (mQ2[i] * mQ2[i]) - (mCoefs[i] * mQ1[i] * mQ2[i]);
+   }
+}
+
+/* ============================ INQUIRY =================================== */
+
+UtlBoolean MpGoertzelBank::isBelowPower(const MpAudioSample *pSamples,
+                                        int numSamples,
+                                        double power)
+{
+   // Limit is kept well below INT32_MAX, so the sum can not overflow.
+   const double maxSum = sqrt(power * POWER_GATE_MARGIN);
+   const int32_t limit = (maxSum < (double)(1 << 30)) ? (int32_t)maxSum : (1 << 30);
+   int32_t sum = 0;
+
+   for (int n = 0; n < numSamples; n++)
+   {
+      sum += (pSamples[n] >= 0) ? pSamples[n] : -(int32_t)pSamples[n];
+      if (sum > limit)
+      {
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
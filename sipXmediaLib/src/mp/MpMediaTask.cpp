@@ -26,6 +26,7 @@
 #include <mp/MpMisc.h>
 #include <mp/MpMediaTask.h>
 #include <mp/MpMediaTaskMsg.h>
+#include <mp/MpMediaTaskWorker.h>
 #include <mp/MpBufferMsg.h>
 
 #ifdef __pingtel_on_posix__ // [
@@ -76,7 +77,10 @@ int sSignalStartsQueued = 0;
 
 /* ============================ CREATORS ================================== */
 
-MpMediaTask* MpMediaTask::createMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio)
+MpMediaTask* MpMediaTask::createMediaTask(int maxFlowGraph,
+                                          UtlBoolean enableLocalAudio,
+                                          int numWorkers,
+                                          UtlBoolean pinWorkers)
 {
    UtlBoolean isStarted;
 
@@ -86,7 +90,8 @@ MpMediaTask* MpMediaTask::createMediaTask(int maxFlowGraph, UtlBoolean enableLoc
    assert(spInstance == NULL);
 
    if (spInstance == NULL)
-       spInstance = new MpMediaTask(maxFlowGraph, enableLocalAudio);
+       spInstance = new MpMediaTask(maxFlowGraph, enableLocalAudio,
+                                    numWorkers, pinWorkers);
 
    isStarted = spInstance->isStarted();
    if (!isStarted)
@@ -117,7 +122,16 @@ MpMediaTask::~MpMediaTask()
    // $$$ need to figure out how to cleanly shut down this task after
    // $$$ unmanaging and destroying all of its flow graphs
 
+   // Stop and destroy worker threads.
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      delete mpWorkers[i];
+   }
+   delete[] mpWorkers;
+   delete mpWorkersDoneSem;
+
    delete[] mManagedFGs;
+   delete[] mManagedFGWorkers;
 
    if (mpBufferMsgPool != NULL)
       delete mpBufferMsgPool;
@@ -414,7 +428,50 @@ MpFlowGraphBase* MpMediaTask::getFocus(void) const
 // has been exceeded.
 int MpMediaTask::getLimitExceededCnt(void) const
 {
-   return mTimeLimitCnt;
+   int cnt = mTimeLimitCnt;
+   for (int i = 0; i < mNumWorkers; i++)
+   {
+      cnt += mpWorkers[i]->getLimitExceededCnt();
+   }
+   return cnt;
+}
+
+// Returns the number of times that the frame processing time limit
+// has been exceeded by the given worker thread.
+int MpMediaTask::getWorkerLimitExceededCnt(int workerIndex) const
+{
+   if (workerIndex < 0 || workerIndex >= mNumWorkers)
+   {
+      return -1;
+   }
+   return mpWorkers[workerIndex]->getLimitExceededCnt();
+}
+
+// Returns the number of worker threads processing flow graphs.
+int MpMediaTask::numWorkers(void) const
+{
+   return mNumWorkers;
+}
+
+// Returns the index of the worker the flow graph is bound to.
+int MpMediaTask::getFlowGraphWorker(MpFlowGraphBase* pFlowGraph)
+{
+   OsLock lock(mMutex);
+
+   if (mNumWorkers == 0)
+   {
+      return -1;
+   }
+
+   for (int i = 0; i < mManagedCnt; i++)
+   {
+      if (mManagedFGs[i] == pFlowGraph)
+      {
+         return mManagedFGWorkers[i];
+      }
+   }
+
+   return -1;
 }
 
 // Returns an array of MpFlowGraphBase pointers that are presently managed 
@@ -488,6 +545,12 @@ MpFlowGraphBase* MpMediaTask::mediaInfo(void)
    osPrintf("  Processing Limit Exceeded Count: %d\n",
              pMediaTask->getLimitExceededCnt());
 
+   osPrintf("  Worker Threads:                  %d\n",
+             pMediaTask->numWorkers());
+   for (i=0; i < pMediaTask->numWorkers(); i++)
+      osPrintf("    Worker[%d] Limit Exceeded Count: %d\n",
+               i, pMediaTask->getWorkerLimitExceededCnt(i));
+
    i = pMediaTask->getWaitTimeout();
    if (i < 0)
       osPrintf("  Frame Start Wait Timeout:        INFINITE\n");
@@ -570,7 +633,8 @@ void MpMediaTask::getQueueUsage(int& numMsgs, int& softLimit, int& hardLimit)
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 // Default constructor (called only indirectly via getMediaTask())
-MpMediaTask::MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio)
+MpMediaTask::MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio,
+                         int numWorkers, UtlBoolean pinWorkers)
 : OsServerTask("MpMedia", NULL, MPMEDIA_DEF_MAX_MSGS,
                MEDIA_TASK_PRIORITY)
 , mMutex(OsMutex::Q_PRIORITY)  // create mutex for protecting data
@@ -583,6 +647,11 @@ MpMediaTask::MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio)
 , mSemTimeoutCnt(0)
 , mWaitForSignal(TRUE)
 , mpFocus(NULL)
+, mManagedFGs(NULL)
+, mManagedFGWorkers(NULL)
+, mNumWorkers(0)
+, mpWorkers(NULL)
+, mpWorkersDoneSem(NULL)
 , mHandleMsgErrs(0)
 , mpBufferMsgPool(NULL)
 //, numQueuedMsgs(0)
@@ -610,14 +679,33 @@ MpMediaTask::MpMediaTask(int maxFlowGraph, UtlBoolean enableLocalAudio)
    if (mMaxFlowGraph > 0)
    {
       mManagedFGs = new MpFlowGraphBase*[mMaxFlowGraph];
+      mManagedFGWorkers = new int[mMaxFlowGraph];
       if (mManagedFGs)
       {
          for (i=0; i < mMaxFlowGraph; i++)
          {
             mManagedFGs[i] = NULL;
+            mManagedFGWorkers[i] = -1;
          }
       }
    }
+
+   assert(numWorkers >= 0);
+   if (numWorkers > 0 && mMaxFlowGraph > 0)
+   {
+      mNumWorkers = numWorkers;
+      mpWorkersDoneSem = new OsCSem(OsCSem::Q_PRIORITY, mNumWorkers, 0);
+      mpWorkers = new MpMediaTaskWorker*[mNumWorkers];
+      for (i=0; i < mNumWorkers; i++)
+      {
+         mpWorkers[i] = new MpMediaTaskWorker(i, mMaxFlowGraph,
+                                              *mpWorkersDoneSem,
+                                              pinWorkers ? i : -1);
+         UtlBoolean isStarted = mpWorkers[i]->start();
+         assert(isStarted);
+         SIPX_UNUSED(isStarted);
+      }
+   }
    {
       int totalNumBufs = MpMisc.AudioHeadersPool->getNumBlocks()
                        + MpMisc.RtpHeadersPool->getNumBlocks()
@@ -772,6 +860,14 @@ UtlBoolean MpMediaTask::handleManage(MpFlowGraphBase* pFlowGraph)
 
    // PRINTF("MpMediaTask::handleManage: Adding flow graph # %d!\n", mManagedCnt, 0,0,0,0,0);
    mManagedFGs[mManagedCnt] = pFlowGraph;
+   mManagedFGWorkers[mManagedCnt] = -1;
+   if (mNumWorkers > 0)
+   {
+      // Bind the flow graph to a worker for its whole managed lifetime.
+      int worker = selectWorker();
+      mManagedFGWorkers[mManagedCnt] = worker;
+      mpWorkers[worker]->incAssignedCnt();
+   }
    mManagedCnt++;
 
    return TRUE;
@@ -894,13 +990,19 @@ UtlBoolean MpMediaTask::handleUnmanage(MpFlowGraphBase* pFlowGraph)
       if (found)
       {                           // compact the managed flow graphs array
          mManagedFGs[i-1] = mManagedFGs[i];
+         mManagedFGWorkers[i-1] = mManagedFGWorkers[i];
       }
 
       if (mManagedFGs[i] == pFlowGraph)
       {
          // PRINTF("MpMediaTask::handleUnmanage: Removing flow graph # %d!\n", i, 0,0,0,0,0);
          found = TRUE;
+         if (mManagedFGWorkers[i] >= 0)
+         {
+            mpWorkers[mManagedFGWorkers[i]]->decAssignedCnt();
+         }
          mManagedFGs[i] = NULL;
+         mManagedFGWorkers[i] = -1;
       }
    }
 
@@ -976,20 +1078,28 @@ UtlBoolean MpMediaTask::handleWaitForSignal(MpMediaTaskMsg* pMsg)
          mManagedCnt);
 #endif
 
-   // Call processNextFrame() for each of the "started" flow graphs
-   for (i=0; i < mManagedCnt; i++)
+   if (mNumWorkers > 0)
+   {
+      // Fan out processNextFrame() calls to the worker threads
+      processFrameByWorkers();
+   }
+   else
    {
+      // Call processNextFrame() for each of the "started" flow graphs
+      for (i=0; i < mManagedCnt; i++)
+      {
 #ifdef TEST_PRINT
-      OsSysLog::add(FAC_MP, PRI_DEBUG,
-         "MpMediaTask::handleWaitForSignal about to processNextFrame on flowgraph: %d",
-         i);
+         OsSysLog::add(FAC_MP, PRI_DEBUG,
+            "MpMediaTask::handleWaitForSignal about to processNextFrame on flowgraph: %d",
+            i);
 #endif
-      RTL_EVENT("MpMediaTask::handleWaitForSignal", i+1);
-      pFlowGraph = mManagedFGs[i];
-      if (pFlowGraph->isStarted())
-      {
-         res = pFlowGraph->processNextFrame();
-         assert(res == OS_SUCCESS);
+         RTL_EVENT("MpMediaTask::handleWaitForSignal", i+1);
+         pFlowGraph = mManagedFGs[i];
+         if (pFlowGraph->isStarted())
+         {
+            res = pFlowGraph->processNextFrame();
+            assert(res == OS_SUCCESS);
+         }
       }
    }
    RTL_EVENT("MpMediaTask::handleWaitForSignal", 0);
@@ -1030,7 +1140,8 @@ UtlBoolean MpMediaTask::handleWaitForSignal(MpMediaTaskMsg* pMsg)
       // Record the processing stop time.
       mStopTicks = (t.tv_sec * 1000000) + t.tv_usec;
       // if not debugging, determine whether the processing limit was exceeded
-      if (!mDebugEnabled)
+      // (workers check the limit themselves, so don't count a frame twice)
+      if (!mDebugEnabled && mNumWorkers == 0)
       {
          if ((mStopTicks - mStartTicks) >= mLimitTicks) {
             mTimeLimitCnt++;
@@ -1101,6 +1212,66 @@ UtlBoolean MpMediaTask::handleWaitForSignal(MpMediaTaskMsg* pMsg)
    return TRUE;
 }
 
+// Process the next frame of all started flow graphs by worker threads.
+// Returns when all workers have finished processing the frame.
+void MpMediaTask::processFrameByWorkers()
+{
+   int i;
+   int activeWorkers = 0;
+
+   // Workers are idle now, so we could safely fill their frame lists.
+   for (i=0; i < mNumWorkers; i++)
+   {
+      mpWorkers[i]->clearFrameList();
+   }
+
+   for (i=0; i < mManagedCnt; i++)
+   {
+      MpFlowGraphBase* pFlowGraph = mManagedFGs[i];
+      if (pFlowGraph->isStarted())
+      {
+         assert(mManagedFGWorkers[i] >= 0 && mManagedFGWorkers[i] < mNumWorkers);
+         mpWorkers[mManagedFGWorkers[i]]->addToFrameList(pFlowGraph);
+      }
+   }
+
+   // Wake up only workers which have something to do.
+   for (i=0; i < mNumWorkers; i++)
+   {
+      if (mpWorkers[i]->getFrameListCnt() > 0)
+      {
+         RTL_EVENT("MpMediaTask::processFrameByWorkers", i+1);
+         mpWorkers[i]->signalFrameStart(mLimitUsecs, !mDebugEnabled);
+         activeWorkers++;
+      }
+   }
+
+   // Wait until every worker finishes its part of the frame.
+   for (i=0; i < activeWorkers; i++)
+   {
+      OsStatus res = mpWorkersDoneSem->acquire();
+      assert(res == OS_SUCCESS);
+      SIPX_UNUSED(res);
+   }
+   RTL_EVENT("MpMediaTask::processFrameByWorkers", 0);
+}
+
+// Return index of the worker with the least number of bound flow graphs.
+int MpMediaTask::selectWorker() const
+{
+   int bestWorker = 0;
+
+   for (int i=1; i < mNumWorkers; i++)
+   {
+      if (mpWorkers[i]->getAssignedCnt() < mpWorkers[bestWorker]->getAssignedCnt())
+      {
+         bestWorker = i;
+      }
+   }
+
+   return bestWorker;
+}
+
 // Returns TRUE if the indicated flow graph is presently being managed 
 // by the media processing task, otherwise FALSE.
 UtlBoolean MpMediaTask::isManagedFlowGraph(MpFlowGraphBase* pFlowGraph)
@@ -0,0 +1,167 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <assert.h>
+#if defined(__linux__) && !defined(ANDROID) // [
+#  include <pthread.h>
+#  include <sched.h>
+#endif // __linux__ && !ANDROID ]
+
+// APPLICATION INCLUDES
+#include <os/OsDateTime.h>
+#include <os/OsSysLog.h>
+#include <mp/MpFlowGraphBase.h>
+#include <mp/MpMediaTask.h>
+#include <mp/MpMediaTaskWorker.h>
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+MpMediaTaskWorker::MpMediaTaskWorker(int workerIndex,
+                                     int maxFlowGraphs,
+                                     OsCSem &rDoneSem,
+                                     int cpu)
+: OsTask("MpMediaWorker-%d", NULL, MpMediaTask::MEDIA_TASK_PRIORITY)
+, mIndex(workerIndex)
+, mCpu(cpu)
+, mStartSem(OsBSem::Q_PRIORITY, OsBSem::EMPTY)
+, mrDoneSem(rDoneSem)
+, mpFrameFGs(NULL)
+, mMaxFrameFGs(maxFlowGraphs)
+, mFrameFGsCnt(0)
+, mAssignedCnt(0)
+, mLimitUsecs(MpMediaTask::DEF_TIME_LIMIT_USECS)
+, mCheckLimit(TRUE)
+, mTimeLimitCnt(0)
+, mLastFrameUsecs(0)
+{
+   assert(mMaxFrameFGs > 0);
+   mpFrameFGs = new MpFlowGraphBase*[mMaxFrameFGs];
+   for (int i = 0; i < mMaxFrameFGs; i++)
+   {
+      mpFrameFGs[i] = NULL;
+   }
+}
+
+MpMediaTaskWorker::~MpMediaTaskWorker()
+{
+   if (isStarted())
+   {
+      requestShutdown();
+   }
+   waitUntilShutDown();
+
+   delete[] mpFrameFGs;
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void MpMediaTaskWorker::clearFrameList()
+{
+   mFrameFGsCnt = 0;
+}
+
+void MpMediaTaskWorker::addToFrameList(MpFlowGraphBase *pFlowGraph)
+{
+   assert(mFrameFGsCnt < mMaxFrameFGs);
+   if (mFrameFGsCnt < mMaxFrameFGs)
+   {
+      mpFrameFGs[mFrameFGsCnt] = pFlowGraph;
+      mFrameFGsCnt++;
+   }
+}
+
+void MpMediaTaskWorker::signalFrameStart(int limitUsecs, UtlBoolean checkLimit)
+{
+   mLimitUsecs = limitUsecs;
+   mCheckLimit = checkLimit;
+   mStartSem.release();
+}
+
+void MpMediaTaskWorker::requestShutdown(void)
+{
+   OsTask::requestShutdown();
+   // Unblock run() so it could notice the shutdown request.
+   mStartSem.release();
+}
+
+/* ============================ ACCESSORS ================================= */
+
+/* ============================ INQUIRY =================================== */
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+int MpMediaTaskWorker::run(void* pArg)
+{
+   pinToCpu();
+
+   while (TRUE)
+   {
+      mStartSem.acquire();
+      if (isShuttingDown())
+      {
+         break;
+      }
+
+      OsTime startTime;
+      OsDateTime::getCurTime(startTime);
+
+      for (int i = 0; i < mFrameFGsCnt; i++)
+      {
+         OsStatus res = mpFrameFGs[i]->processNextFrame();
+         assert(res == OS_SUCCESS);
+      }
+
+      OsTime stopTime;
+      OsDateTime::getCurTime(stopTime);
+      OsTime processTime = stopTime - startTime;
+      mLastFrameUsecs = processTime.seconds()*1000000 + processTime.usecs();
+      if (mCheckLimit && mLastFrameUsecs >= mLimitUsecs)
+      {
+         mTimeLimitCnt++;
+      }
+
+      mrDoneSem.release();
+   }
+
+   return 0;
+}
+
+void MpMediaTaskWorker::pinToCpu()
+{
+   if (mCpu < 0)
+   {
+      return;
+   }
+
+#if defined(__linux__) && !defined(ANDROID) // [
+   cpu_set_t cpuSet;
+   CPU_ZERO(&cpuSet);
+   CPU_SET(mCpu, &cpuSet);
+   int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+   if (err != 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_WARNING,
+                    "MpMediaTaskWorker::pinToCpu worker %d failed to pin to CPU %d, error: %d",
+                    mIndex, mCpu, err);
+   }
+#else // __linux__ && !ANDROID ][
+   OsSysLog::add(FAC_MP, PRI_INFO,
+                 "MpMediaTaskWorker::pinToCpu CPU pinning is not supported on this platform");
+#endif // __linux__ && !ANDROID ]
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
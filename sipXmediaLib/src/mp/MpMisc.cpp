@@ -51,6 +51,9 @@
 #include "mp/MpBufferMsg.h"
 #include "mp/MpMisc.h"
 #include "mp/NetInTask.h"
+#include "mp/MpRecorderWriter.h"
+#include "mp/MpPromptCache.h"
+#include "mp/MprRecorder.h"
 #include "mp/MprFromMic.h"
 #include "mp/MprToSpkr.h"
 #include "mp/MprDejitter.h"
@@ -95,6 +98,8 @@
 //#define RTP_BUFS (MprDejitter::MAX_RTP_PACKETS + 20)
 #define RTCP_BUFS 16
 #define UDP_BUFS 10
+/// Network pools may grow up to this number of times their initial size.
+#define NET_POOL_GROW_FACTOR 4
 
 // STATIC VARIABLE INITIALIZATIONS
 
@@ -595,7 +600,8 @@ OsStatus mpStartUp(int sampleRate, int samplesPerFrame,
         // sufficient buffers to backup and then catch up.
         MpMisc.RtpPool = new MpBufPool( RTP_MTU+MpArrayBuf::getHeaderSize(),
                                       50 * maxCalls + 70,
-                                      "RtpPool");
+                                      "RtpPool",
+                                      (50 * maxCalls + 70) * NET_POOL_GROW_FACTOR);
         Nprintf("mpStartUp: MpMisc.RtpPool = 0x%X\n",
                 (int) MpMisc.RtpPool, 0,0,0,0,0);
         if (NULL == MpMisc.RtpPool) {
@@ -622,7 +628,9 @@ OsStatus mpStartUp(int sampleRate, int samplesPerFrame,
         MpMisc.RtpHeadersPool = new MpBufPool( sizeof(MpRtpBuf),
                                              MpMisc.RtpPool->getNumBlocks()
                                                + MpMisc.RtcpPool->getNumBlocks(),
-                                               "RtpHeadersPool");
+                                               "RtpHeadersPool",
+                                             MpMisc.RtpPool->getMaxBlocks()
+                                               + MpMisc.RtcpPool->getMaxBlocks());
         Nprintf( "mpStartUp: MpMisc.RtpHeadersPool = 0x%X\n"
                , (int) MpMisc.RtpHeadersPool, 0,0,0,0,0);
         if (NULL == MpMisc.RtpHeadersPool) {
@@ -632,9 +640,11 @@ OsStatus mpStartUp(int sampleRate, int samplesPerFrame,
         MpRtpBuf::smpDefaultPool = MpMisc.RtpHeadersPool;
 
         // Create buffer for UDP packets
+        // NetInTask drops packets when this pool runs dry, so let it grow.
         MpMisc.UdpPool = new MpBufPool( UDP_MTU+MpArrayBuf::getHeaderSize(),
                                       UDP_BUFS,
-                                      "UdpPool");
+                                      "UdpPool",
+                                      UDP_BUFS * NET_POOL_GROW_FACTOR);
         Nprintf("mpStartUp: MpMisc.UdpPool = 0x%X\n",
                 (int) MpMisc.UdpPool, 0,0,0,0,0);
         if (NULL == MpMisc.UdpPool) {
@@ -645,7 +655,8 @@ OsStatus mpStartUp(int sampleRate, int samplesPerFrame,
         // Create buffer for UDP packet headers
         MpMisc.UdpHeadersPool = new MpBufPool( sizeof(MpUdpBuf),
                                               MpMisc.UdpPool->getNumBlocks(),
-                                              "UdpHeadersPool");
+                                              "UdpHeadersPool",
+                                              MpMisc.UdpPool->getMaxBlocks());
         Nprintf( "mpStartUp: MpMisc.UdpHeadersPool = 0x%X\n"
                , (int) MpMisc.UdpHeadersPool, 0,0,0,0,0);
         if (NULL == MpMisc.UdpHeadersPool) {
@@ -676,6 +687,49 @@ OsStatus mpStartUp(int sampleRate, int samplesPerFrame,
            {
               silenceSuppressLevel = defSilenceSuppressLevel;
            }
+
+           // Number of threads receiving RTP/RTCP packets.
+           int netInThreads;
+           resCode = pConfigDb->get("PHONESET_NET_IN_THREADS", netInThreads);
+           if (resCode == OS_SUCCESS && netInThreads > 0)
+           {
+              NetInTask::setNumReceiveThreads(netInThreads);
+           }
+
+           // Write recordings to files from a background task.
+           UtlString recorderAsyncWrite;
+           resCode = pConfigDb->get("PHONESET_RECORDER_ASYNC_WRITE",
+                                    recorderAsyncWrite);
+           if (resCode == OS_SUCCESS)
+           {
+              MprRecorder::setAsyncFileWrite(
+                 recorderAsyncWrite.compareTo("enable", UtlString::ignoreCase) == 0);
+           }
+
+           int recorderQueueLength;
+           resCode = pConfigDb->get("PHONESET_RECORDER_WRITE_QUEUE_LENGTH",
+                                    recorderQueueLength);
+           if (resCode == OS_SUCCESS && recorderQueueLength > 0)
+           {
+              MpRecorderWriter::setQueueLength(recorderQueueLength);
+           }
+
+           // Share converted audio files between all players.
+           int promptCacheSizeKb;
+           resCode = pConfigDb->get("PHONESET_PROMPT_CACHE_SIZE_KB",
+                                    promptCacheSizeKb);
+           if (resCode == OS_SUCCESS && promptCacheSizeKb >= 0)
+           {
+              MpPromptCache::setMaxSize((size_t)promptCacheSizeKb*1024);
+           }
+
+           UtlString promptCacheDir;
+           resCode = pConfigDb->get("PHONESET_PROMPT_CACHE_DIR",
+                                    promptCacheDir);
+           if (resCode == OS_SUCCESS)
+           {
+              MpPromptCache::setCacheDirectory(promptCacheDir);
+           }
         }
 
 #ifdef WIN32 /* [ */
@@ -756,6 +810,12 @@ OsStatus mpShutdown(void)
            delete MpMediaTask::getMediaTask();
         }
 
+        // Write out recordings which are still in the queue.
+        MpRecorderWriter::destroyRecorderWriter();
+
+        // All players are gone with the media task, so nobody uses prompts.
+        MpPromptCache::destroyPromptCache();
+
         if (NULL != MpMisc.pMicQ) {
             OsMsgQ* q = MpMisc.pMicQ;
             MpMisc.pMicQ = NULL;
@@ -40,6 +40,19 @@ extern "C" void callbackRegisterStaticCodec(const char* moduleName,
    MpCodecFactory::addStaticCodec(pCodecInfo);
 }
 
+extern "C" void callbackRegisterStaticCodecBatch(const char* codecModuleName,
+                                                 dlPlgDecodeBatchV1 plgDecodeBatch,
+                                                 dlPlgEncodeBatchV1 plgEncodeBatch)
+{
+   // Batch functions are registered after the codec itself.
+   MpCodecCallInfoV1* pCodecInfo = MpCodecFactory::findStaticCodec(codecModuleName);
+   assert(pCodecInfo);
+   if (pCodecInfo != NULL)
+   {
+      pCodecInfo->setBatchFunctions(plgDecodeBatch, plgEncodeBatch);
+   }
+}
+
 extern "C" void mppLogError(const char* format, ...)
 {
     va_list varArgs;
@@ -0,0 +1,461 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <assert.h>
+#include <string.h>
+#ifdef __pingtel_on_posix__ // [
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  define MP_PROMPT_CACHE_USE_MMAP
+#endif // __pingtel_on_posix__ ]
+
+// APPLICATION INCLUDES
+#include <os/OsFS.h>
+#include <os/OsLock.h>
+#include <os/OsSysLog.h>
+#include <utl/UtlCrc32.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlVoidPtr.h>
+#include <mp/MpPromptCache.h>
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+#define CACHE_FILE_MAGIC     "SIPXPCM1"
+#define CACHE_FILE_EXTENSION ".pcm"
+
+// STRUCTS
+
+/// Header of a file in the on-disk store.
+/**
+*  Header is followed by the cache key, padded to 16 bytes, and the
+*  audio samples.
+*/
+struct MpPromptCacheFileHeader
+{
+   char mMagic[8];       ///< CACHE_FILE_MAGIC
+   uint32_t mDataOffset; ///< Offset of the audio samples from the file start.
+   uint32_t mDataSize;   ///< Size of the audio samples in bytes.
+   uint32_t mKeyLength;  ///< Length of the cache key.
+   uint32_t mReserved;   ///< Must be zero.
+};
+
+// STATIC VARIABLE INITIALIZATIONS
+MpPromptCache* MpPromptCache::spInstance = NULL;
+OsMutex MpPromptCache::sLock(OsMutex::Q_FIFO);
+size_t MpPromptCache::sMaxSize = 0;
+UtlString MpPromptCache::sCacheDirectory;
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+MpPromptCache* MpPromptCache::getPromptCache()
+{
+   if (spInstance != NULL)
+      return spInstance;
+
+   OsLock lock(sLock);
+   if (spInstance == NULL)
+   {
+      spInstance = new MpPromptCache();
+   }
+   return spInstance;
+}
+
+void MpPromptCache::destroyPromptCache()
+{
+   OsLock lock(sLock);
+   if (spInstance != NULL)
+   {
+      delete spInstance;
+      spInstance = NULL;
+   }
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void MpPromptCache::setMaxSize(size_t maxSize)
+{
+   sMaxSize = maxSize;
+   if (spInstance != NULL)
+   {
+      spInstance->trim();
+   }
+}
+
+void MpPromptCache::setCacheDirectory(const UtlString& directory)
+{
+   OsLock lock(sLock);
+   sCacheDirectory = directory;
+}
+
+OsStatus MpPromptCache::acquire(const UtlString& fileName,
+                                uint32_t sampleRate,
+                                LoadFunc loadFunc,
+                                Prompt*& pPrompt)
+{
+   pPrompt = NULL;
+
+   // Key includes modification time and size, so a changed file is
+   // never played from the stale cached copy.
+   OsFile file(fileName);
+   OsFileInfo fileInfo;
+   OsTime modifiedTime;
+   unsigned long fileSize = 0;
+   if (file.getFileInfo(fileInfo) != OS_SUCCESS ||
+       fileInfo.getModifiedTime(modifiedTime) != OS_SUCCESS ||
+       fileInfo.getSize(fileSize) != OS_SUCCESS)
+   {
+      return OS_FILE_NOT_FOUND;
+   }
+
+   UtlString key;
+   key.appendFormat("%u:%ld.%06ld:%lu:", sampleRate, modifiedTime.seconds(),
+                    modifiedTime.usecs(), fileSize);
+   key.append(fileName);
+
+   {
+      OsLock lock(mLock);
+      pPrompt = findPrompt(key);
+      if (pPrompt != NULL)
+      {
+         mNumHits++;
+         return OS_SUCCESS;
+      }
+      mNumMisses++;
+   }
+
+   UtlString cacheDirectory;
+   {
+      OsLock lock(sLock);
+      cacheDirectory = sCacheDirectory;
+   }
+
+   // Try converted audio stored by us or by another process first.
+   Prompt* pNewPrompt = NULL;
+   if (!cacheDirectory.isNull())
+   {
+      pNewPrompt = mapCacheFile(key);
+   }
+
+   if (pNewPrompt == NULL)
+   {
+      UtlString* pAudio = NULL;
+      OsStatus stat = loadFunc(sampleRate, pAudio, fileName);
+      if (stat != OS_SUCCESS || pAudio == NULL)
+      {
+         delete pAudio;
+         return stat != OS_SUCCESS ? stat : OS_FAILED;
+      }
+
+      if (!cacheDirectory.isNull())
+      {
+         pNewPrompt = storeCacheFile(key, *pAudio);
+      }
+      if (pNewPrompt != NULL)
+      {
+         delete pAudio;
+      }
+      else
+      {
+         pNewPrompt = new Prompt(key);
+         pNewPrompt->mpAudio = pAudio;
+         pNewPrompt->mpData = pAudio->data();
+         pNewPrompt->mDataSize = pAudio->length();
+      }
+   }
+
+   OsLock lock(mLock);
+   // Somebody could have loaded the same file while we were loading it.
+   pPrompt = findPrompt(key);
+   if (pPrompt != NULL)
+   {
+      delete pNewPrompt;
+      return OS_SUCCESS;
+   }
+
+   pNewPrompt->mRefCount = 1;
+   addPrompt(pNewPrompt);
+   trimLocked(sMaxSize);
+   pPrompt = pNewPrompt;
+
+   return OS_SUCCESS;
+}
+
+void MpPromptCache::trim()
+{
+   OsLock lock(mLock);
+   trimLocked(sMaxSize);
+}
+
+void MpPromptCache::Prompt::addRef()
+{
+   mRefCount++;
+}
+
+void MpPromptCache::Prompt::release()
+{
+   int32_t refCount = --mRefCount;
+   assert(refCount >= 0);
+}
+
+/* ============================ ACCESSORS ================================= */
+
+size_t MpPromptCache::getMaxSize()
+{
+   return sMaxSize;
+}
+
+size_t MpPromptCache::getCachedSize() const
+{
+   OsLock lock(mLock);
+   return mCachedSize;
+}
+
+int MpPromptCache::getNumPrompts() const
+{
+   OsLock lock(mLock);
+   return mPrompts.entries();
+}
+
+/* ============================ INQUIRY =================================== */
+
+UtlBoolean MpPromptCache::isEnabled()
+{
+   return sMaxSize > 0;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+MpPromptCache::Prompt::Prompt(const UtlString& key)
+: mKey(key)
+, mpData(NULL)
+, mDataSize(0)
+, mpAudio(NULL)
+, mpMapping(NULL)
+, mMappingSize(0)
+, mRefCount(0)
+, mLastUsed(0)
+{
+}
+
+MpPromptCache::Prompt::~Prompt()
+{
+#ifdef MP_PROMPT_CACHE_USE_MMAP // [
+   if (mpMapping != NULL)
+   {
+      munmap(mpMapping, mMappingSize);
+   }
+#endif // MP_PROMPT_CACHE_USE_MMAP ]
+   delete mpAudio;
+}
+
+MpPromptCache::MpPromptCache()
+: mLock(OsMutex::Q_FIFO)
+, mCachedSize(0)
+, mUseCounter(0)
+, mNumHits(0)
+, mNumMisses(0)
+{
+}
+
+MpPromptCache::~MpPromptCache()
+{
+   UtlHashMapIterator prompts(mPrompts);
+   while (prompts() != NULL)
+   {
+      Prompt* pPrompt = (Prompt*)((UtlVoidPtr*)prompts.value())->getValue();
+      if (pPrompt->mRefCount > 0)
+      {
+         // Somebody is still playing it - leak it rather than crash.
+         OsSysLog::add(FAC_MP, PRI_ERR,
+                       "MpPromptCache::~MpPromptCache() prompt '%s' is still referenced",
+                       pPrompt->mKey.data());
+         continue;
+      }
+      delete pPrompt;
+   }
+   mPrompts.destroyAll();
+}
+
+MpPromptCache::Prompt* MpPromptCache::findPrompt(const UtlString& key)
+{
+   UtlVoidPtr* pValue = (UtlVoidPtr*)mPrompts.findValue(&key);
+   if (pValue == NULL)
+   {
+      return NULL;
+   }
+
+   Prompt* pPrompt = (Prompt*)pValue->getValue();
+   pPrompt->addRef();
+   pPrompt->mLastUsed = ++mUseCounter;
+   return pPrompt;
+}
+
+void MpPromptCache::addPrompt(Prompt* pPrompt)
+{
+   pPrompt->mLastUsed = ++mUseCounter;
+   mPrompts.insertKeyAndValue(new UtlString(pPrompt->mKey),
+                              new UtlVoidPtr(pPrompt));
+   mCachedSize += pPrompt->mDataSize;
+}
+
+void MpPromptCache::trimLocked(size_t maxSize)
+{
+   while (mCachedSize > maxSize)
+   {
+      // Prompt references are added with mLock held only, so an unreferenced
+      // prompt could not become referenced while we are here.
+      Prompt* pOldest = NULL;
+      UtlHashMapIterator prompts(mPrompts);
+      while (prompts() != NULL)
+      {
+         Prompt* pPrompt = (Prompt*)((UtlVoidPtr*)prompts.value())->getValue();
+         if (pPrompt->mRefCount == 0 &&
+             (pOldest == NULL ||
+              (int32_t)(pPrompt->mLastUsed - pOldest->mLastUsed) < 0))
+         {
+            pOldest = pPrompt;
+         }
+      }
+      if (pOldest == NULL)
+      {
+         // Everything left is being played.
+         break;
+      }
+
+      mCachedSize -= pOldest->mDataSize;
+      mPrompts.destroy(&pOldest->mKey);
+      delete pOldest;
+   }
+}
+
+void MpPromptCache::getCacheFileName(const UtlString& key, UtlString& fileName)
+{
+   UtlCrc32 crc;
+   crc.calc(key);
+
+   fileName = sCacheDirectory;
+   fileName.append(OsPathBase::separator);
+   fileName.appendFormat("%08lx%s", crc.getValue(), CACHE_FILE_EXTENSION);
+}
+
+MpPromptCache::Prompt* MpPromptCache::mapCacheFile(const UtlString& key)
+{
+#ifdef MP_PROMPT_CACHE_USE_MMAP // [
+   UtlString fileName;
+   {
+      OsLock lock(sLock);
+      getCacheFileName(key, fileName);
+   }
+
+   int fd = open(fileName.data(), O_RDONLY);
+   if (fd < 0)
+   {
+      return NULL;
+   }
+   struct stat fileStat;
+   if (fstat(fd, &fileStat) != 0 ||
+       (size_t)fileStat.st_size < sizeof(MpPromptCacheFileHeader))
+   {
+      close(fd);
+      return NULL;
+   }
+   size_t mappingSize = fileStat.st_size;
+   void* pMapping = mmap(NULL, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if (pMapping == MAP_FAILED)
+   {
+      return NULL;
+   }
+
+   // Files are named by the key hash, so the key itself must match too.
+   const MpPromptCacheFileHeader* pHeader = (const MpPromptCacheFileHeader*)pMapping;
+   if (memcmp(pHeader->mMagic, CACHE_FILE_MAGIC, sizeof(pHeader->mMagic)) != 0 ||
+       pHeader->mKeyLength != key.length() ||
+       sizeof(MpPromptCacheFileHeader) + pHeader->mKeyLength > pHeader->mDataOffset ||
+       (size_t)pHeader->mDataOffset + pHeader->mDataSize != mappingSize ||
+       memcmp(pHeader + 1, key.data(), key.length()) != 0)
+   {
+      munmap(pMapping, mappingSize);
+      return NULL;
+   }
+
+   Prompt* pPrompt = new Prompt(key);
+   pPrompt->mpMapping = pMapping;
+   pPrompt->mMappingSize = mappingSize;
+   pPrompt->mpData = (const char*)pMapping + pHeader->mDataOffset;
+   pPrompt->mDataSize = pHeader->mDataSize;
+   return pPrompt;
+#else // MP_PROMPT_CACHE_USE_MMAP ][
+   return NULL;
+#endif // MP_PROMPT_CACHE_USE_MMAP ]
+}
+
+MpPromptCache::Prompt* MpPromptCache::storeCacheFile(const UtlString& key,
+                                                     const UtlString& audio)
+{
+#ifdef MP_PROMPT_CACHE_USE_MMAP // [
+   UtlString fileName;
+   {
+      OsLock lock(sLock);
+      getCacheFileName(key, fileName);
+   }
+   // Write to a temporary file and rename it, so other processes never
+   // map a partially written file.
+   UtlString tmpFileName(fileName);
+   tmpFileName.appendFormat(".%d.tmp", (int)getpid());
+
+   int fd = open(tmpFileName.data(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+   if (fd < 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_WARNING,
+                    "MpPromptCache::storeCacheFile() can't create '%s'",
+                    tmpFileName.data());
+      return NULL;
+   }
+
+   MpPromptCacheFileHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.mMagic, CACHE_FILE_MAGIC, sizeof(header.mMagic));
+   header.mKeyLength = key.length();
+   header.mDataOffset = (sizeof(header) + header.mKeyLength + 15) & ~15;
+   header.mDataSize = audio.length();
+
+   char padding[16];
+   memset(padding, 0, sizeof(padding));
+   size_t paddingSize = header.mDataOffset - sizeof(header) - header.mKeyLength;
+
+   UtlBoolean written =
+      write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header) &&
+      write(fd, key.data(), key.length()) == (ssize_t)key.length() &&
+      write(fd, padding, paddingSize) == (ssize_t)paddingSize &&
+      write(fd, audio.data(), audio.length()) == (ssize_t)audio.length();
+   close(fd);
+
+   if (!written || rename(tmpFileName.data(), fileName.data()) != 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_WARNING,
+                    "MpPromptCache::storeCacheFile() can't write '%s'",
+                    fileName.data());
+      unlink(tmpFileName.data());
+      return NULL;
+   }
+
+   return mapCacheFile(key);
+#else // MP_PROMPT_CACHE_USE_MMAP ][
+   return NULL;
+#endif // MP_PROMPT_CACHE_USE_MMAP ]
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
@@ -0,0 +1,551 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <assert.h>
+#include <string.h>
+#ifdef __pingtel_on_posix__
+#  include <unistd.h>
+#elif defined(WIN32) && !defined(WINCE) /* [ */
+#  include <io.h>
+#endif /* WIN32 && !WINCE ] */
+
+// APPLICATION INCLUDES
+#include <os/OsWriteLock.h>
+#include <os/OsSysLog.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlInt.h>
+#include <utl/UtlVoidPtr.h>
+#include <mp/MpFlowGraphBase.h>
+#include <mp/MpResNotificationMsg.h>
+#include <mp/MpRecorderWriter.h>
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+MpRecorderWriter* MpRecorderWriter::spInstance = NULL;
+OsRWMutex MpRecorderWriter::sLock(OsBSem::Q_PRIORITY);
+int MpRecorderWriter::sQueueLength = MpRecorderWriter::DEF_QUEUE_LENGTH;
+OsAtomicInt MpRecorderWriter::sOverflowCnt(0);
+
+struct MpRecorderWriter::FileState
+{
+   int mFd;            ///< File to write to.
+   long mOffset;       ///< File offset of the first byte in mpBuffer.
+   int mSize;          ///< Number of bytes collected in mpBuffer.
+   char* mpBuffer;     ///< Collected data.
+   UtlBoolean mFailed; ///< Has write to this file failed?
+};
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+MpRecorderWriter* MpRecorderWriter::getRecorderWriter()
+{
+   // If the task object already exists, and the corresponding low-level task
+   // has been started, then use it
+   if (spInstance != NULL && spInstance->isStarted())
+      return spInstance;
+
+   OsWriteLock lock(sLock);
+   if (spInstance == NULL)
+   {
+      spInstance = new MpRecorderWriter(sQueueLength);
+   }
+   if (!spInstance->isStarted())
+   {
+      UtlBoolean isStarted = spInstance->start();
+      assert(isStarted);
+   }
+   return spInstance;
+}
+
+void MpRecorderWriter::destroyRecorderWriter()
+{
+   OsWriteLock lock(sLock);
+   if (spInstance != NULL)
+   {
+      delete spInstance;
+      spInstance = NULL;
+   }
+}
+
+MpRecorderWriter::MpRecorderWriter(int queueLength)
+: OsTask("MpRecorderWriter")
+, mpCells(NULL)
+, mQueueMask(0)
+, mEnqueuePos(0)
+, mDequeuePos(0)
+, mpNewCommands(NULL)
+, mpCommands(NULL)
+, mpLastCommand(NULL)
+, mIsIdle(0)
+, mWakeupSem(OsBSem::Q_PRIORITY, OsBSem::EMPTY)
+{
+   int length = 2;
+   while (length < queueLength)
+   {
+      length *= 2;
+   }
+   mQueueMask = length - 1;
+
+   mpCells = new Cell[length];
+   for (int i = 0; i < length; i++)
+   {
+      mpCells[i].mSeq = i;
+   }
+}
+
+MpRecorderWriter::~MpRecorderWriter()
+{
+   if (isStarted())
+   {
+      requestShutdown();
+   }
+   waitUntilShutDown();
+
+   // Write out whatever has been queued after the task has stopped.
+   processQueue();
+   flushAll();
+
+   UtlHashMapIterator files(mFiles);
+   UtlContainable* pKey;
+   while ((pKey = files()) != NULL)
+   {
+      FileState* pFile = (FileState*)((UtlVoidPtr*)files.value())->getValue();
+      delete[] pFile->mpBuffer;
+      delete pFile;
+   }
+   mFiles.destroyAll();
+
+   delete[] mpCells;
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void MpRecorderWriter::setQueueLength(int queueLength)
+{
+   if (queueLength > 0)
+   {
+      sQueueLength = queueLength;
+   }
+}
+
+OsStatus MpRecorderWriter::writeData(int fd, char* channelData[],
+                                     int numChannels, int dataSize,
+                                     int bytesPerSample)
+{
+   // Number of bytes to take from each channel before switching to the next.
+   if (numChannels == 1 || bytesPerSample <= 0)
+   {
+      bytesPerSample = dataSize;
+   }
+   int totalSize = dataSize * numChannels;
+
+   // Take all cells of the frame at once, so that the frame is either
+   // queued whole or dropped whole.
+   int cellsNeeded = sipx_max(1, (totalSize + CELL_DATA_SIZE - 1) / CELL_DATA_SIZE);
+   int32_t pos;
+   Cell* pCell = NULL;
+   if (cellsNeeded <= mQueueMask + 1)
+   {
+      pCell = reserveCells(pos, cellsNeeded);
+   }
+   if (pCell == NULL)
+   {
+      int32_t overflows = ++sOverflowCnt;
+      if (overflows == 1 || overflows % 1000 == 0)
+      {
+         OsSysLog::add(FAC_MP, PRI_WARNING,
+                       "MpRecorderWriter::writeData queue is full, "
+                       "%d frames dropped so far", overflows);
+      }
+      return OS_LIMIT_REACHED;
+   }
+
+   int cellFill = 0;
+   for (int dataIndex = 0; dataIndex < dataSize; dataIndex += bytesPerSample)
+   {
+      int sampleSize = sipx_min(bytesPerSample, dataSize - dataIndex);
+      for (int channelIndex = 0; channelIndex < numChannels; channelIndex++)
+      {
+         const char* pSrc = &channelData[channelIndex][dataIndex];
+         int left = sampleSize;
+         while (left > 0)
+         {
+            if (cellFill == CELL_DATA_SIZE)
+            {
+               pCell->mFd = fd;
+               pCell->mDataSize = cellFill;
+               commitCell(pCell, pos);
+               pos = (uint32_t)pos + 1;
+               pCell = &mpCells[pos & mQueueMask];
+               cellFill = 0;
+            }
+            int toCopy = sipx_min(left, CELL_DATA_SIZE - cellFill);
+            memcpy(pCell->mData + cellFill, pSrc, toCopy);
+            cellFill += toCopy;
+            pSrc += toCopy;
+            left -= toCopy;
+         }
+      }
+   }
+   pCell->mFd = fd;
+   pCell->mDataSize = cellFill;
+   commitCell(pCell, pos);
+
+   return OS_SUCCESS;
+}
+
+OsStatus MpRecorderWriter::postNotification(int fd,
+                                            MpFlowGraphBase* pFlowGraph,
+                                            MpResNotificationMsg* pMsg,
+                                            OsAtomicInt* pPendingCnt)
+{
+   return queueCommand(CMD_NOTIFY, fd, MprRecorder::UNINITIALIZED_FORMAT,
+                       pFlowGraph, pMsg, pPendingCnt);
+}
+
+OsStatus MpRecorderWriter::closeFile(int fd,
+                                     MprRecorder::RecordFileFormat format,
+                                     OsAtomicInt* pPendingCnt)
+{
+   return queueCommand(CMD_CLOSE, fd, format, NULL, NULL, pPendingCnt);
+}
+
+void MpRecorderWriter::requestShutdown(void)
+{
+   OsTask::requestShutdown();
+   // Unblock run() so it could notice the shutdown request.
+   mWakeupSem.release();
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int32_t MpRecorderWriter::getOverflowCount()
+{
+   return sOverflowCnt;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+MpRecorderWriter::Cell* MpRecorderWriter::reserveCells(int32_t& pos,
+                                                       int numCells)
+{
+   pos = mEnqueuePos.load(memory_order_acquire);
+   while (TRUE)
+   {
+      // Writer frees cells in order, so if the last cell is free, all
+      // cells before it are free too.
+      int32_t last = (uint32_t)pos + numCells - 1;
+      int32_t seq = mpCells[last & mQueueMask].mSeq.load(memory_order_acquire);
+      int32_t diff = (uint32_t)seq - (uint32_t)last;
+      if (diff == 0)
+      {
+         // Cells are free, try to take them.
+         // On failure pos is updated with the current value.
+         if (mEnqueuePos.compare_exchange(pos, (uint32_t)pos + numCells))
+         {
+            return &mpCells[pos & mQueueMask];
+         }
+         continue;
+      }
+      else if (diff < 0)
+      {
+         // Queue is full.
+         return NULL;
+      }
+      pos = mEnqueuePos.load(memory_order_acquire);
+   }
+}
+
+void MpRecorderWriter::commitCell(Cell* pCell, int32_t pos)
+{
+   pCell->mSeq.store((uint32_t)pos + 1, memory_order_release);
+
+   // Wake up the writer if it sleeps without a timeout. Fence orders our
+   // store above with the load of the idle flag, writer does the opposite.
+   mIsIdle.fence(memory_order_seq_cst);
+   int32_t idle = 1;
+   if (mIsIdle.load(memory_order_relaxed) && mIsIdle.compare_exchange(idle, 0))
+   {
+      mWakeupSem.release();
+   }
+}
+
+OsStatus MpRecorderWriter::queueCommand(CommandType type, int fd,
+                                        MprRecorder::RecordFileFormat format,
+                                        MpFlowGraphBase* pFlowGraph,
+                                        MpResNotificationMsg* pMsg,
+                                        OsAtomicInt* pPendingCnt)
+{
+   if (pPendingCnt != NULL)
+   {
+      (*pPendingCnt)++;
+   }
+
+   Command* pCommand = new Command;
+   pCommand->mType = type;
+   pCommand->mFd = fd;
+   pCommand->mFormat = format;
+   pCommand->mpFlowGraph = pFlowGraph;
+   pCommand->mpMsg = pMsg;
+   pCommand->mpPendingCnt = pPendingCnt;
+   // Data queued before the command has positions below this one.
+   pCommand->mQueuePos = mEnqueuePos.load(memory_order_acquire);
+
+   Command* pHead = mpNewCommands;
+   do
+   {
+      pCommand->mpNext = pHead;
+   } while (!mpNewCommands.compare_exchange(pHead, pCommand));
+
+   // Do not wait for the poll interval with control commands.
+   mWakeupSem.release();
+   return OS_SUCCESS;
+}
+
+int MpRecorderWriter::processQueue()
+{
+   takeNewCommands();
+
+   int processed = 0;
+   while (TRUE)
+   {
+      processed += processCommands();
+
+      Cell* pCell = &mpCells[mDequeuePos & mQueueMask];
+      int32_t seq = pCell->mSeq.load(memory_order_acquire);
+      if (seq != (int32_t)((uint32_t)mDequeuePos + 1))
+      {
+         // Queue is empty.
+         break;
+      }
+
+      processCell(pCell);
+      pCell->mSeq.store((uint32_t)mDequeuePos + mQueueMask + 1,
+                        memory_order_release);
+      mDequeuePos = (uint32_t)mDequeuePos + 1;
+      processed++;
+   }
+   return processed;
+}
+
+void MpRecorderWriter::takeNewCommands()
+{
+   Command* pCommand = mpNewCommands.exchange(NULL);
+   if (pCommand == NULL)
+   {
+      return;
+   }
+
+   // The stack has the latest command on top, reverse it.
+   Command* pFirst = NULL;
+   Command* pLast = pCommand;
+   while (pCommand != NULL)
+   {
+      Command* pNext = pCommand->mpNext;
+      pCommand->mpNext = pFirst;
+      pFirst = pCommand;
+      pCommand = pNext;
+   }
+
+   if (mpLastCommand != NULL)
+   {
+      mpLastCommand->mpNext = pFirst;
+   }
+   else
+   {
+      mpCommands = pFirst;
+   }
+   mpLastCommand = pLast;
+}
+
+int MpRecorderWriter::processCommands()
+{
+   // Commands are taken in the order they have been queued. Commands queued
+   // concurrently may be due in a slightly different order, but then they
+   // come from different recorders, so waiting for the first one is harmless.
+   int processed = 0;
+   while (mpCommands != NULL &&
+          (int32_t)((uint32_t)mDequeuePos - (uint32_t)mpCommands->mQueuePos) >= 0)
+   {
+      Command* pCommand = mpCommands;
+      mpCommands = pCommand->mpNext;
+      if (mpCommands == NULL)
+      {
+         mpLastCommand = NULL;
+      }
+      processCommand(pCommand);
+      delete pCommand;
+      processed++;
+   }
+   return processed;
+}
+
+void MpRecorderWriter::processCell(Cell* pCell)
+{
+   FileState* pFile = getFileState(pCell->mFd);
+   memcpy(pFile->mpBuffer + pFile->mSize, pCell->mData, pCell->mDataSize);
+   pFile->mSize += pCell->mDataSize;
+   if (pFile->mSize >= WRITE_CHUNK_SIZE)
+   {
+      flushFile(pFile, FALSE);
+   }
+}
+
+void MpRecorderWriter::processCommand(Command* pCommand)
+{
+   switch (pCommand->mType)
+   {
+   case CMD_NOTIFY:
+      if (pCommand->mFd > -1)
+      {
+         UtlInt key(pCommand->mFd);
+         UtlVoidPtr* pValue = (UtlVoidPtr*)mFiles.findValue(&key);
+         if (pValue != NULL)
+         {
+            flushFile((FileState*)pValue->getValue(), TRUE);
+         }
+      }
+      pCommand->mpFlowGraph->postNotification(*pCommand->mpMsg);
+      delete pCommand->mpMsg;
+      break;
+
+   case CMD_CLOSE:
+      {
+         UtlInt key(pCommand->mFd);
+         UtlContainable* pValue;
+         UtlContainable* pKey = mFiles.removeKeyAndValue(&key, pValue);
+         if (pKey != NULL)
+         {
+            FileState* pFile = (FileState*)((UtlVoidPtr*)pValue)->getValue();
+            flushFile(pFile, TRUE);
+            delete[] pFile->mpBuffer;
+            delete pFile;
+            delete pKey;
+            delete pValue;
+         }
+
+         if (pCommand->mFormat != MprRecorder::RAW_PCM_16)
+         {
+            MprRecorder::updateWaveHeaderLengths(pCommand->mFd,
+                                                 pCommand->mFormat);
+         }
+         close(pCommand->mFd);
+      }
+      break;
+   }
+
+   // Recorder may be destroyed right after this, so do not touch it anymore.
+   if (pCommand->mpPendingCnt != NULL)
+   {
+      (*pCommand->mpPendingCnt)--;
+   }
+}
+
+MpRecorderWriter::FileState* MpRecorderWriter::getFileState(int fd)
+{
+   UtlInt key(fd);
+   UtlVoidPtr* pValue = (UtlVoidPtr*)mFiles.findValue(&key);
+   if (pValue != NULL)
+   {
+      return (FileState*)pValue->getValue();
+   }
+
+   FileState* pFile = new FileState;
+   pFile->mFd = fd;
+   // Media task has written the WAV header (if any) before queuing any data,
+   // so current position is where our data goes.
+   pFile->mOffset = lseek(fd, 0, SEEK_CUR);
+   pFile->mSize = 0;
+   pFile->mpBuffer = new char[WRITE_CHUNK_SIZE + CELL_DATA_SIZE];
+   pFile->mFailed = FALSE;
+   mFiles.insertKeyAndValue(new UtlInt(fd), new UtlVoidPtr(pFile));
+   return pFile;
+}
+
+void MpRecorderWriter::flushFile(FileState* pFile, UtlBoolean all)
+{
+   int toWrite = pFile->mSize;
+   if (!all)
+   {
+      // Make the chunk end at an aligned file offset.
+      toWrite -= (pFile->mOffset + pFile->mSize) % WRITE_ALIGNMENT;
+   }
+   if (toWrite <= 0)
+   {
+      return;
+   }
+
+   int written = 0;
+   while (written < toWrite && !pFile->mFailed)
+   {
+      int res = write(pFile->mFd, pFile->mpBuffer + written, toWrite - written);
+      if (res < 1)
+      {
+         OsSysLog::add(FAC_MP, PRI_ERR,
+                       "MpRecorderWriter::flushFile fd: %d wrote %d of %d bytes,"
+                       " errno: %d", pFile->mFd, written, toWrite, errno);
+         // Do not retry, recorded data of this file is dropped from now on.
+         pFile->mFailed = TRUE;
+         break;
+      }
+      written += res;
+   }
+
+   pFile->mOffset += toWrite;
+   pFile->mSize -= toWrite;
+   memmove(pFile->mpBuffer, pFile->mpBuffer + toWrite, pFile->mSize);
+}
+
+void MpRecorderWriter::flushAll()
+{
+   UtlHashMapIterator files(mFiles);
+   while (files() != NULL)
+   {
+      flushFile((FileState*)((UtlVoidPtr*)files.value())->getValue(), TRUE);
+   }
+}
+
+int MpRecorderWriter::run(void* pArg)
+{
+   while (!isShuttingDown())
+   {
+      if (processQueue() > 0)
+      {
+         continue;
+      }
+
+      if (mFiles.isEmpty())
+      {
+         // Nothing is being recorded - sleep until data is queued. Set the
+         // flag first and re-check the queue, so we do not miss a wakeup.
+         // Sequentially consistent store orders the flag with the queue
+         // loads below.
+         mIsIdle = 1;
+         if (processQueue() > 0)
+         {
+            mIsIdle = 0;
+            continue;
+         }
+         mWakeupSem.acquire();
+         mIsIdle = 0;
+      }
+      else
+      {
+         mWakeupSem.acquire(OsTime(0, FLUSH_INTERVAL_MS*1000));
+      }
+   }
+
+   // Queued data is written out by the destructor.
+   return 0;
+}
+
+/* ============================ FUNCTIONS ================================= */
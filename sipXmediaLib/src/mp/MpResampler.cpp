@@ -15,6 +15,8 @@
 #include <mp/MpAudioUtils.h>
 #if defined(HAVE_SPEEX) || defined(HAVE_SPEEX_RESAMPLER)
 #  include "mp/MpResamplerSpeex.h"
+#else
+#  include "mp/MpResamplerPolyphase.h"
 #endif
 
 
@@ -35,11 +37,13 @@ MpResamplerBase *MpResamplerBase::createResampler(uint32_t numChannels,
                                                   uint32_t outputRate, 
                                                   int32_t quality)
 {
+   // Without Speex the polyphase resampler handles common rates itself
+   // and falls back to MpResamplerBase for the others.
    return new 
 #if defined(HAVE_SPEEX) || defined(HAVE_SPEEX_RESAMPLER)
       MpResamplerSpeex
 #else
-      MpResamplerBase
+      MpResamplerPolyphase
 #endif
                         (numChannels, inputRate, outputRate, quality);
 }
@@ -126,6 +130,48 @@ OsStatus MpResamplerBase::resample(uint32_t channelIndex,
    return ret;
 }
 
+OsStatus MpResamplerBase::resampleChannels(uint32_t numChannels,
+                                           const MpAudioSample* const pInBufs[],
+                                           uint32_t inBufLength,
+                                           uint32_t& inSamplesProcessed,
+                                           MpAudioSample* const pOutBufs[],
+                                           uint32_t outBufLength,
+                                           uint32_t& outSamplesWritten)
+{
+   if(numChannels > mNumChannels)
+   {
+      return OS_INVALID_ARGUMENT;
+   }
+
+   inSamplesProcessed = 0;
+   outSamplesWritten = 0;
+   for(uint32_t channel = 0; channel < numChannels; channel++)
+   {
+      uint32_t channelProcessed = 0;
+      uint32_t channelWritten = 0;
+      OsStatus stat = resample(channel, pInBufs[channel], inBufLength,
+                               channelProcessed, pOutBufs[channel],
+                               outBufLength, channelWritten);
+      if(stat != OS_SUCCESS)
+      {
+         return stat;
+      }
+
+      if(channel == 0)
+      {
+         inSamplesProcessed = channelProcessed;
+         outSamplesWritten = channelWritten;
+      }
+      else if(channelProcessed != inSamplesProcessed ||
+              channelWritten != outSamplesWritten)
+      {
+         // Channel state differs from the first one.
+         return OS_INVALID_STATE;
+      }
+   }
+   return OS_SUCCESS;
+}
+
 OsStatus MpResamplerBase::resampleInterleavedStereo(const MpAudioSample* pInBuf, 
                                                     uint32_t inBufLength, 
                                                     uint32_t& inSamplesProcessed, 
@@ -0,0 +1,535 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <math.h>
+#include <string.h>
+
+// APPLICATION INCLUDES
+#include "os/OsIntTypes.h"
+#include <os/OsLock.h>
+#include "mp/MpResamplerPolyphase.h"
+#include <mp/MpAudioUtils.h>
+
+// DEFINES
+/// Define MP_DSP_DISABLE_SIMD to build generic C dot product only.
+#ifndef MP_DSP_DISABLE_SIMD // [
+#  if defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2) // [
+#     define MP_RESAMPLER_USE_SSE2
+#     include <emmintrin.h>
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) // SSE2 ][
+#     define MP_RESAMPLER_USE_NEON
+#     include <arm_neon.h>
+#  endif // NEON ]
+#endif // !MP_DSP_DISABLE_SIMD ]
+
+/// Number of input samples filtered at once.
+#define POLYPHASE_CHUNK          1024
+/// Cutoff frequency relative to the Nyquist frequency of the lower rate.
+#define POLYPHASE_CUTOFF         0.9
+/// Kaiser window shape parameter.
+#define POLYPHASE_KAISER_BETA    8.0
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// TYPEDEFS
+// MACROS
+// STATIC VARIABLE INITIALIZATIONS
+MpResamplerPolyphase::Filter *MpResamplerPolyphase::spFilters[MAX_FACTOR][MAX_FACTOR];
+OsMutex MpResamplerPolyphase::sFiltersLock(OsMutex::Q_FIFO);
+
+/* ============================== FUNCTIONS =============================== */
+
+  /// Zeroth order modified Bessel function of the first kind.
+static double besselI0(double x)
+{
+   double sum = 1.0;
+   double term = 1.0;
+   for (int k = 1; term > sum * 1e-12; k++)
+   {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+   }
+   return sum;
+}
+
+  /// Round Q15 sum to a sample, with saturation.
+static inline
+MpAudioSample roundQ15(int32_t acc)
+{
+   acc = (acc + (1 << 14)) >> 15;
+   if (acc > INT16_MAX)
+   {
+      acc = INT16_MAX;
+   }
+   else if (acc < INT16_MIN)
+   {
+      acc = INT16_MIN;
+   }
+   return (MpAudioSample)acc;
+}
+
+  /// Dot product of Q15 coefficients and samples, rounded to a sample.
+static inline
+MpAudioSample dotProductQ15(const int16_t *pCoefs, const MpAudioSample *pSamples,
+                            int numTaps)
+{
+   int32_t acc;
+#if defined(MP_RESAMPLER_USE_SSE2) // [
+   __m128i sum = _mm_setzero_si128();
+   for (int i = 0; i < numTaps; i += 8)
+   {
+      sum = _mm_add_epi32(sum,
+                          _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(pCoefs + i)),
+                                         _mm_loadu_si128((const __m128i*)(pSamples + i))));
+   }
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+   acc = _mm_cvtsi128_si32(sum);
+#elif defined(MP_RESAMPLER_USE_NEON) // SSE2 ][
+   int32x4_t sum = vdupq_n_s32(0);
+   for (int i = 0; i < numTaps; i += 8)
+   {
+      sum = vmlal_s16(sum, vld1_s16(pCoefs + i), vld1_s16(pSamples + i));
+      sum = vmlal_s16(sum, vld1_s16(pCoefs + i + 4), vld1_s16(pSamples + i + 4));
+   }
+   int32x2_t sum2 = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+   acc = vget_lane_s32(vpadd_s32(sum2, sum2), 0);
+#else // NEON ][
+   acc = 0;
+   for (int i = 0; i < numTaps; i++)
+   {
+      acc += (int32_t)pCoefs[i] * pSamples[i];
+   }
+#endif // !SSE2 && !NEON ]
+
+   return roundQ15(acc);
+}
+
+  /// dotProductQ15() of the same coefficients and 4 windows at once.
+static inline
+void dotProductQ15x4(const int16_t *pCoefs, const MpAudioSample *pSamples,
+                     uint32_t windowStride, int numTaps,
+                     MpAudioSample* const pOutBufs[], uint32_t outIndex)
+{
+#if defined(MP_RESAMPLER_USE_SSE2) // [
+   const MpAudioSample *pSamples1 = pSamples + windowStride;
+   const MpAudioSample *pSamples2 = pSamples1 + windowStride;
+   const MpAudioSample *pSamples3 = pSamples2 + windowStride;
+   __m128i sum0 = _mm_setzero_si128();
+   __m128i sum1 = _mm_setzero_si128();
+   __m128i sum2 = _mm_setzero_si128();
+   __m128i sum3 = _mm_setzero_si128();
+   for (int i = 0; i < numTaps; i += 8)
+   {
+      const __m128i coefs = _mm_loadu_si128((const __m128i*)(pCoefs + i));
+      sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(coefs, _mm_loadu_si128((const __m128i*)(pSamples + i))));
+      sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(coefs, _mm_loadu_si128((const __m128i*)(pSamples1 + i))));
+      sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(coefs, _mm_loadu_si128((const __m128i*)(pSamples2 + i))));
+      sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(coefs, _mm_loadu_si128((const __m128i*)(pSamples3 + i))));
+   }
+
+   // Transpose and add, so lane n holds the whole sum of window n.
+   const __m128i sum01 = _mm_add_epi32(_mm_unpacklo_epi32(sum0, sum1),
+                                       _mm_unpackhi_epi32(sum0, sum1));
+   const __m128i sum23 = _mm_add_epi32(_mm_unpacklo_epi32(sum2, sum3),
+                                       _mm_unpackhi_epi32(sum2, sum3));
+   __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(sum01, sum23),
+                               _mm_unpackhi_epi64(sum01, sum23));
+
+   // Round and saturate like roundQ15().
+   sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 14)), 15);
+   sum = _mm_packs_epi32(sum, sum);
+   pOutBufs[0][outIndex] = (MpAudioSample)_mm_extract_epi16(sum, 0);
+   pOutBufs[1][outIndex] = (MpAudioSample)_mm_extract_epi16(sum, 1);
+   pOutBufs[2][outIndex] = (MpAudioSample)_mm_extract_epi16(sum, 2);
+   pOutBufs[3][outIndex] = (MpAudioSample)_mm_extract_epi16(sum, 3);
+#else // SSE2 ][
+   for (int n = 0; n < 4; n++)
+   {
+      pOutBufs[n][outIndex] = dotProductQ15(pCoefs, pSamples + n * windowStride,
+                                            numTaps);
+   }
+#endif // !SSE2 ]
+}
+
+/* //////////////////////////////// PUBLIC //////////////////////////////// */
+
+/* =============================== CREATORS =============================== */
+
+MpResamplerPolyphase::MpResamplerPolyphase(uint32_t numChannels,
+                                           uint32_t inputRate,
+                                           uint32_t outputRate,
+                                           int32_t quality)
+: MpResamplerBase(numChannels, inputRate, outputRate, quality)
+, mpFilter(NULL)
+, mpHistory(NULL)
+, mpPositions(NULL)
+, mpWork(NULL)
+, mWorkSlotLength(0)
+{
+   initFilter();
+}
+
+MpResamplerPolyphase::~MpResamplerPolyphase()
+{
+   delete[] mpHistory;
+   delete[] mpPositions;
+   delete[] mpWork;
+}
+
+/* ============================= MANIPULATORS ============================= */
+
+OsStatus MpResamplerPolyphase::resetStream()
+{
+   if (mpFilter != NULL)
+   {
+      memset(mpHistory, 0,
+             mNumChannels * (mpFilter->mTapsPerPhase - 1) * sizeof(MpAudioSample));
+      memset(mpPositions, 0, mNumChannels * sizeof(uint32_t));
+   }
+   return OS_SUCCESS;
+}
+
+OsStatus MpResamplerPolyphase::resample(uint32_t channelIndex,
+                                        const MpAudioSample* pInBuf,
+                                        uint32_t inBufLength,
+                                        uint32_t& inSamplesProcessed,
+                                        MpAudioSample* pOutBuf,
+                                        uint32_t outBufLength,
+                                        uint32_t& outSamplesWritten)
+{
+   if (channelIndex >= mNumChannels)
+   {
+      // Specified a channel number that was outside the defined number of channels!
+      return OS_INVALID_ARGUMENT;
+   }
+
+   if (mpFilter == NULL)
+   {
+      if (mInputRate == mOutputRate)
+      {
+         // Nothing to convert, just copy.
+         outSamplesWritten = sipx_min(inBufLength, outBufLength);
+         inSamplesProcessed = outSamplesWritten;
+         memcpy(pOutBuf, pInBuf, outSamplesWritten * sizeof(MpAudioSample));
+         return OS_SUCCESS;
+      }
+      return MpResamplerBase::resample(channelIndex, pInBuf, inBufLength,
+                                       inSamplesProcessed, pOutBuf,
+                                       outBufLength, outSamplesWritten);
+   }
+
+   uint32_t position = mpPositions[channelIndex];
+   for (inSamplesProcessed = 0, outSamplesWritten = 0;
+        inSamplesProcessed < inBufLength && outSamplesWritten < outBufLength;
+       )
+   {
+      uint32_t numSamples = sipx_min((uint32_t)POLYPHASE_CHUNK, inBufLength - inSamplesProcessed);
+      MpAudioSample *pOut = pOutBuf + outSamplesWritten;
+      loadChunk(channelIndex, pInBuf + inSamplesProcessed, numSamples, 0);
+      outSamplesWritten += filterChunk(position, numSamples, 1, &pOut,
+                                       outBufLength - outSamplesWritten);
+
+      // Samples before the first one of the next window are consumed.
+      uint32_t numConsumed = sipx_min(numSamples, position / mpFilter->mUpFactor);
+      saveHistory(channelIndex, numConsumed, 0);
+      position -= numConsumed * mpFilter->mUpFactor;
+      inSamplesProcessed += numConsumed;
+   }
+   mpPositions[channelIndex] = position;
+
+   return OS_SUCCESS;
+}
+
+OsStatus MpResamplerPolyphase::resampleChannels(uint32_t numChannels,
+                                                const MpAudioSample* const pInBufs[],
+                                                uint32_t inBufLength,
+                                                uint32_t& inSamplesProcessed,
+                                                MpAudioSample* const pOutBufs[],
+                                                uint32_t outBufLength,
+                                                uint32_t& outSamplesWritten)
+{
+   if (numChannels > mNumChannels)
+   {
+      return OS_INVALID_ARGUMENT;
+   }
+   if (mpFilter == NULL || numChannels == 0)
+   {
+      return MpResamplerBase::resampleChannels(numChannels, pInBufs, inBufLength,
+                                               inSamplesProcessed, pOutBufs,
+                                               outBufLength, outSamplesWritten);
+   }
+
+   // All channels must be at the same position to share it.
+   uint32_t channel;
+   for (channel = 1; channel < numChannels; channel++)
+   {
+      if (mpPositions[channel] != mpPositions[0])
+      {
+         return OS_INVALID_STATE;
+      }
+   }
+
+   uint32_t position = mpPositions[0];
+   for (inSamplesProcessed = 0, outSamplesWritten = 0;
+        inSamplesProcessed < inBufLength && outSamplesWritten < outBufLength;
+       )
+   {
+      uint32_t numSamples = sipx_min((uint32_t)POLYPHASE_CHUNK, inBufLength - inSamplesProcessed);
+      uint32_t chunkPosition = position;
+      uint32_t numWritten = 0;
+      uint32_t numConsumed = 0;
+      for (channel = 0; channel < numChannels; channel += BATCH_CHANNELS)
+      {
+         // Every group starts at the same position and so writes the
+         // same number of samples.
+         const uint32_t numSlots = sipx_min((uint32_t)BATCH_CHANNELS,
+                                            numChannels - channel);
+         MpAudioSample *pOut[BATCH_CHANNELS];
+         uint32_t slot;
+         for (slot = 0; slot < numSlots; slot++)
+         {
+            loadChunk(channel + slot, pInBufs[channel + slot] + inSamplesProcessed,
+                      numSamples, slot);
+            pOut[slot] = pOutBufs[channel + slot] + outSamplesWritten;
+         }
+
+         chunkPosition = position;
+         numWritten = filterChunk(chunkPosition, numSamples, numSlots, pOut,
+                                  outBufLength - outSamplesWritten);
+
+         numConsumed = sipx_min(numSamples, chunkPosition / mpFilter->mUpFactor);
+         for (slot = 0; slot < numSlots; slot++)
+         {
+            saveHistory(channel + slot, numConsumed, slot);
+         }
+      }
+
+      position = chunkPosition - numConsumed * mpFilter->mUpFactor;
+      outSamplesWritten += numWritten;
+      inSamplesProcessed += numConsumed;
+   }
+   for (channel = 0; channel < numChannels; channel++)
+   {
+      mpPositions[channel] = position;
+   }
+
+   return OS_SUCCESS;
+}
+
+OsStatus MpResamplerPolyphase::setInputRate(const uint32_t inputRate)
+{
+   OsStatus stat = MpResamplerBase::setInputRate(inputRate);
+   if (stat == OS_SUCCESS)
+   {
+      initFilter();
+   }
+   return stat;
+}
+
+OsStatus MpResamplerPolyphase::setOutputRate(const uint32_t outputRate)
+{
+   OsStatus stat = MpResamplerBase::setOutputRate(outputRate);
+   if (stat == OS_SUCCESS)
+   {
+      initFilter();
+   }
+   return stat;
+}
+
+/* =============================== INQUIRY ================================ */
+
+UtlBoolean MpResamplerPolyphase::isRatioSupported(uint32_t inputRate,
+                                                  uint32_t outputRate)
+{
+   if (inputRate == 0 || outputRate == 0 || inputRate == outputRate)
+   {
+      return FALSE;
+   }
+   uint32_t rateGcd = gcd(inputRate, outputRate);
+   return outputRate / rateGcd <= MAX_FACTOR && inputRate / rateGcd <= MAX_FACTOR;
+}
+
+/* ////////////////////////////// PROTECTED /////////////////////////////// */
+
+const MpResamplerPolyphase::Filter *
+MpResamplerPolyphase::getFilter(uint32_t upFactor, uint32_t downFactor)
+{
+   OsLock lock(sFiltersLock);
+
+   Filter *&pFilter = spFilters[upFactor - 1][downFactor - 1];
+   if (pFilter == NULL)
+   {
+      pFilter = createFilter(upFactor, downFactor);
+   }
+   return pFilter;
+}
+
+MpResamplerPolyphase::Filter *
+MpResamplerPolyphase::createFilter(uint32_t upFactor, uint32_t downFactor)
+{
+   // Keep the same number of zero crossings when the cutoff is set by the
+   // output rate: the filter gets longer with the down factor.
+   const int tapsPerPhase = 2 * ZERO_CROSSINGS *
+                            ((downFactor + upFactor - 1) / upFactor);
+   const int length = upFactor * tapsPerPhase;
+   // Cutoff in cycles per sample at the upsampled rate.
+   const double cutoff = POLYPHASE_CUTOFF * 0.5 / sipx_max(upFactor, downFactor);
+   const double center = (length - 1) / 2.0;
+   const double windowNorm = besselI0(POLYPHASE_KAISER_BETA);
+
+   double *pPrototype = new double[length];
+   int n;
+   for (n = 0; n < length; n++)
+   {
+      const double x = n - center;
+      const double sinc = (x == 0.0) ? 2.0 * cutoff
+                                     : sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+      const double r = x / (center + 1.0);
+      const double window = besselI0(POLYPHASE_KAISER_BETA * sqrt(1.0 - r * r)) / windowNorm;
+      pPrototype[n] = sinc * window;
+   }
+
+   Filter *pFilter = new Filter;
+   pFilter->mUpFactor = upFactor;
+   pFilter->mDownFactor = downFactor;
+   pFilter->mTapsPerPhase = tapsPerPhase;
+   pFilter->mpCoefs = new int16_t[length];
+
+   for (uint32_t phase = 0; phase < upFactor; phase++)
+   {
+      // Tap k of the phase multiplies the k-th newest sample of the window,
+      // store it reversed to multiply samples in the memory order.
+      int16_t *pCoefs = pFilter->mpCoefs + phase * tapsPerPhase;
+      double sum = 0.0;
+      int k;
+      for (k = 0; k < tapsPerPhase; k++)
+      {
+         sum += pPrototype[phase + k * upFactor];
+      }
+
+      // Quantize to Q15 with unity DC gain, put the rounding error on the
+      // largest tap.
+      int32_t quantizedSum = 0;
+      int largest = 0;
+      for (k = 0; k < tapsPerPhase; k++)
+      {
+         const double coef = pPrototype[phase + k * upFactor] / sum;
+         const int i = tapsPerPhase - 1 - k;
+         pCoefs[i] = (int16_t)floor(coef * 32768.0 + 0.5);
+         quantizedSum += pCoefs[i];
+         if (k == 0 || pCoefs[i] > pCoefs[largest])
+         {
+            largest = i;
+         }
+      }
+      pCoefs[largest] += (int16_t)(32768 - quantizedSum);
+   }
+
+   delete[] pPrototype;
+   return pFilter;
+}
+
+void MpResamplerPolyphase::initFilter()
+{
+   delete[] mpHistory;
+   delete[] mpPositions;
+   delete[] mpWork;
+   mpHistory = NULL;
+   mpPositions = NULL;
+   mpWork = NULL;
+   mpFilter = NULL;
+
+   if (!isRatioSupported(mInputRate, mOutputRate))
+   {
+      return;
+   }
+
+   uint32_t rateGcd = gcd(mInputRate, mOutputRate);
+   mpFilter = getFilter(mOutputRate / rateGcd, mInputRate / rateGcd);
+
+   const int historyLength = mpFilter->mTapsPerPhase - 1;
+   mpHistory = new MpAudioSample[mNumChannels * historyLength];
+   mpPositions = new uint32_t[mNumChannels];
+   mWorkSlotLength = historyLength + POLYPHASE_CHUNK;
+   mpWork = new MpAudioSample[BATCH_CHANNELS * mWorkSlotLength];
+   resetStream();
+}
+
+void MpResamplerPolyphase::loadChunk(uint32_t channelIndex,
+                                     const MpAudioSample* pInBuf,
+                                     uint32_t numSamples,
+                                     uint32_t slot)
+{
+   const int historyLength = mpFilter->mTapsPerPhase - 1;
+   MpAudioSample *pSlot = mpWork + slot * mWorkSlotLength;
+   memcpy(pSlot, mpHistory + channelIndex * historyLength,
+          historyLength * sizeof(MpAudioSample));
+   memcpy(pSlot + historyLength, pInBuf, numSamples * sizeof(MpAudioSample));
+}
+
+uint32_t MpResamplerPolyphase::filterChunk(uint32_t& position,
+                                           uint32_t numSamples,
+                                           uint32_t numSlots,
+                                           MpAudioSample* const pOutBufs[],
+                                           uint32_t outBufLength) const
+{
+   const uint32_t upFactor = mpFilter->mUpFactor;
+   const uint32_t downFactor = mpFilter->mDownFactor;
+   const int tapsPerPhase = mpFilter->mTapsPerPhase;
+
+   // Position is split into the first sample of the window and the phase,
+   // both are advanced without division.
+   uint32_t start = position / upFactor;
+   uint32_t phase = position % upFactor;
+   uint32_t numWritten = 0;
+   while (start < numSamples && numWritten < outBufLength)
+   {
+      const int16_t *pCoefs = mpFilter->mpCoefs + phase * tapsPerPhase;
+      if (numSlots == BATCH_CHANNELS)
+      {
+         dotProductQ15x4(pCoefs, mpWork + start, mWorkSlotLength, tapsPerPhase,
+                         pOutBufs, numWritten);
+      }
+      else
+      {
+         for (uint32_t slot = 0; slot < numSlots; slot++)
+         {
+            pOutBufs[slot][numWritten] =
+               dotProductQ15(pCoefs, mpWork + slot * mWorkSlotLength + start,
+                             tapsPerPhase);
+         }
+      }
+      numWritten++;
+      phase += downFactor;
+      while (phase >= upFactor)
+      {
+         phase -= upFactor;
+         start++;
+      }
+   }
+
+   position = start * upFactor + phase;
+   return numWritten;
+}
+
+void MpResamplerPolyphase::saveHistory(uint32_t channelIndex,
+                                       uint32_t numConsumed,
+                                       uint32_t slot)
+{
+   const int historyLength = mpFilter->mTapsPerPhase - 1;
+   memcpy(mpHistory + channelIndex * historyLength,
+          mpWork + slot * mWorkSlotLength + numConsumed,
+          historyLength * sizeof(MpAudioSample));
+}
+
+/* /////////////////////////////// PRIVATE //////////////////////////////// */
+
+/* ============================== FUNCTIONS =============================== */
@@ -149,7 +149,8 @@ private:
 MprBridge::MprBridge(const UtlString& rName,
                      int maxInOutputs,
                      UtlBoolean mixSilence,
-                     AlgType algorithm)
+                     AlgType algorithm,
+                     int maxActiveSpeakers)
 :  MpAudioResource(rName, 
                    1, maxInOutputs, 
                    1, maxInOutputs)
@@ -160,6 +161,7 @@ MprBridge::MprBridge(const UtlString& rName,
 , mAlgType(algorithm)
 , mpBridgeAlg(NULL)
 , mMixSilence(mixSilence)
+, mMaxActiveSpeakers(maxActiveSpeakers)
 #ifdef PRINT_CLIPPING_STATS
 , mClippedFramesCounted(0)
 , mpOutputClippingCount(NULL)
@@ -321,7 +323,8 @@ OsStatus MprBridge::setFlowGraph(MpFlowGraphBase* pFlowGraph)
          case ALG_LINEAR:
             mpBridgeAlg = new MpBridgeAlgLinear(maxInputs(), maxOutputs(),
                                                 mMixSilence,
-                                                mpFlowGraph->getSamplesPerFrame());
+                                                mpFlowGraph->getSamplesPerFrame(),
+                                                mMaxActiveSpeakers);
             break;
          default:
             assert(!"Unknown bridge algorithm type!");
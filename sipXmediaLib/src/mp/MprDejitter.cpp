@@ -66,6 +66,9 @@ MprDejitter::MprDejitter(MpConnectionID connId, int streamId)
 // mMaxPulledSeqNo will be initialized on first arrived packet
 , mConnectionId(connId)
 , mStreamId(streamId)
+, mHeadIdx(-1)
+, mTailSeq(0)
+, mIsRingOrdered(TRUE)
 {
    mResourceName.appendFormat("MpDejitter-%d-%d", mConnectionId, mStreamId);
 }
@@ -93,6 +96,8 @@ void MprDejitter::reset()
    mLastPushed = 0;
    mIsFirstPulledPacket = TRUE;
    // mMaxPulledSeqNo will be initialized on first arrived packet
+   mHeadIdx = -1;
+   mIsRingOrdered = TRUE;
 }
 
 OsStatus MprDejitter::pushPacket(MpRtpBufPtr &pRtp)
@@ -138,6 +143,10 @@ OsStatus MprDejitter::pushPacket(MpRtpBufPtr &pRtp)
 
          mpPackets[index].swap(pRtp);
          mLastPushed = index;  
+
+         // Overwritten packet may have been the head of the ring. This happens
+         // on sequence number jumps only, so it's ok to do a full scan here.
+         rescanRing();
       } else {
          // Don't insert the new packet - it is an old delayed packet
          RTL_EVENT(mResourceName+"_push_result", 0);
@@ -159,6 +168,7 @@ OsStatus MprDejitter::pushPacket(MpRtpBufPtr &pRtp)
       }
       mLastPushed = index;
       mpPackets[index] = pRtp;
+      updateRingOnPush(index);
    }
 
    RTL_EVENT(mResourceName+"_numPackets", mNumPackets);
@@ -205,33 +215,17 @@ MpRtpBufPtr MprDejitter::pullPacket(RtpTimestamp maxTimestamp,
    if (mNumPackets==0 && mNumLatePackets==0)
       return found;
 
-   // Search for first available packet
-   int minSeqIdx = 0;
-   for (; minSeqIdx < MAX_RTP_PACKETS; minSeqIdx++)
-      if (mpPackets[minSeqIdx].isValid())
-         break;
-
-   // Search for packet with minimum sequence number
-   for (int i = minSeqIdx+1; i < MAX_RTP_PACKETS; i++)
-   {
-      if (!mpPackets[i].isValid())
-         continue;
-
-      if (MpDspUtils::compareSerials(mpPackets[minSeqIdx]->getRtpSequenceNumber(),
-                                     mpPackets[i]->getRtpSequenceNumber()) > 0)
-      {
-         minSeqIdx = i;
-      }
-   }
+   // Packet with minimum sequence number is the head of the ring.
+   int minSeqIdx = mIsRingOrdered ? mHeadIdx : findMinSeqIndex();
+   if (minSeqIdx < 0)
+      return found;
 
    RTL_EVENT(mResourceName+"_pop_minSeqIndex", minSeqIdx);
    RTL_EVENT(mResourceName+"_pop_minSeq", mpPackets[minSeqIdx]->getRtpSequenceNumber());
 
-   if (  minSeqIdx < MAX_RTP_PACKETS
-      && (!lockToTimestamp
-         || MpDspUtils::compareSerials(mpPackets[minSeqIdx]->getRtpTimestamp(),
-                                       maxTimestamp) <= 0
-         )
+   if (  !lockToTimestamp
+      || MpDspUtils::compareSerials(mpPackets[minSeqIdx]->getRtpTimestamp(),
+                                    maxTimestamp) <= 0
       )
    {
       // Retrieve packet 
@@ -256,6 +250,16 @@ MpRtpBufPtr MprDejitter::pullPacket(RtpTimestamp maxTimestamp,
          }
       }
 
+      // Move head to the next packet
+      if (mIsRingOrdered)
+      {
+         updateRingOnPull();
+      }
+      else
+      {
+         rescanRing();
+      }
+
       // Check for next packet
       if (nextFrameAvailable)
       {
@@ -326,35 +330,143 @@ void MprDejitter::setFlowgrapName(const UtlString &fgName)
 
 OsStatus MprDejitter::getFirstPacketInfo(RtpSeq& firstSeq, RtpTimestamp& firstTime) const
 {
-   OsStatus foundStatus = OS_FAILED;
+   int firstPacketIndex = mIsRingOrdered ? mHeadIdx : findMinSeqIndex();
+   if (firstPacketIndex < 0)
+   {
+      return OS_FAILED;
+   }
+
+   firstSeq = mpPackets[firstPacketIndex]->getRtpSequenceNumber();
+   firstTime = mpPackets[firstPacketIndex]->getRtpTimestamp();
+
+   return OS_SUCCESS;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+int MprDejitter::findMinSeqIndex() const
+{
+   // Search for first available packet
+   int minSeqIdx = 0;
+   for (; minSeqIdx < MAX_RTP_PACKETS; minSeqIdx++)
+      if (mpPackets[minSeqIdx].isValid())
+         break;
+
+   if (minSeqIdx >= MAX_RTP_PACKETS)
+      return -1;
+
+   // Search for packet with minimum sequence number
+   for (int i = minSeqIdx+1; i < MAX_RTP_PACKETS; i++)
+   {
+      if (!mpPackets[i].isValid())
+         continue;
+
+      if (MpDspUtils::compareSerials(mpPackets[minSeqIdx]->getRtpSequenceNumber(),
+                                     mpPackets[i]->getRtpSequenceNumber()) > 0)
+      {
+         minSeqIdx = i;
+      }
+   }
+
+   return minSeqIdx;
+}
+
+void MprDejitter::rescanRing()
+{
+   mHeadIdx = findMinSeqIndex();
+   mIsRingOrdered = TRUE;
+   if (mHeadIdx < 0)
+   {
+      return;
+   }
+
+   // Check that all packets are within the window and find the tail.
+   RtpSeq headSeq = mpPackets[mHeadIdx]->getRtpSequenceNumber();
+   RtpSeq maxOffset = 0;
+   for (int i = 0; i < MAX_RTP_PACKETS; i++)
+   {
+      if (!mpPackets[i].isValid())
+         continue;
+
+      RtpSeq offset = mpPackets[i]->getRtpSequenceNumber() - headSeq;
+      if (offset >= MAX_RTP_PACKETS)
+      {
+         mIsRingOrdered = FALSE;
+         return;
+      }
+      if (offset > maxOffset)
+      {
+         maxOffset = offset;
+      }
+   }
+   mTailSeq = headSeq + maxOffset;
+}
+
+void MprDejitter::updateRingOnPush(int index)
+{
+   if (!mIsRingOrdered)
+   {
+      // Do not try to restore order here - we will rescan on next pull.
+      return;
+   }
 
-   int firstPacketIndex = 0;
-   for (; firstPacketIndex < MAX_RTP_PACKETS; firstPacketIndex++)
-   if (mpPackets[firstPacketIndex].isValid())
+   RtpSeq newSeq = mpPackets[index]->getRtpSequenceNumber();
+   if (mHeadIdx < 0)
    {
-      foundStatus = OS_SUCCESS;
-      break;
+      // Buffer was empty.
+      mHeadIdx = index;
+      mTailSeq = newSeq;
+      return;
    }
 
-   for(int packetIndex = firstPacketIndex + 1; packetIndex < MAX_RTP_PACKETS; packetIndex++)
+   RtpSeq headSeq = mpPackets[mHeadIdx]->getRtpSequenceNumber();
+   if (MpDspUtils::compareSerials(newSeq, headSeq) < 0)
+   {
+      // New packet becomes the head if it does not push the tail out of
+      // the window.
+      if ((RtpSeq)(mTailSeq - newSeq) < MAX_RTP_PACKETS)
+      {
+         mHeadIdx = index;
+         return;
+      }
+   }
+   else
    {
-      if(mpPackets[packetIndex].isValid() &&
-         (mpPackets[packetIndex]->getRtpSequenceNumber() <
-          mpPackets[firstPacketIndex]->getRtpSequenceNumber()))
+      // Packet is in the window or moves the tail forward.
+      if (MpDspUtils::compareSerials(newSeq, mTailSeq) <= 0)
+      {
+         return;
+      }
+      if ((RtpSeq)(newSeq - headSeq) < MAX_RTP_PACKETS)
       {
-         firstPacketIndex = packetIndex;
+         mTailSeq = newSeq;
+         return;
       }
    }
 
-   if(foundStatus == OS_SUCCESS)
+   // Stream has jumped and packets do not fit into the window anymore.
+   mIsRingOrdered = FALSE;
+}
+
+void MprDejitter::updateRingOnPull()
+{
+   // Head packet has been already removed from the ring, mTailSeq still holds
+   // sequence number of the last packet.
+   int tailIdx = mTailSeq % MAX_RTP_PACKETS;
+   if (mHeadIdx == tailIdx)
    {
-      firstSeq = mpPackets[firstPacketIndex]->getRtpSequenceNumber();
-      firstTime = mpPackets[firstPacketIndex]->getRtpTimestamp();
+      // It was the last packet.
+      mHeadIdx = -1;
+      return;
    }
 
-   return(foundStatus);
+   // All packets are in the window, so the next valid slot is the next head.
+   // There is no more than MAX_RTP_PACKETS-1 slots to check.
+   do
+   {
+      mHeadIdx = (mHeadIdx+1) % MAX_RTP_PACKETS;
+   } while (!mpPackets[mHeadIdx].isValid());
 }
-/* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
@@ -37,6 +37,7 @@
 #include <mp/MpMediaTask.h>
 #include <mp/MpCodecFactory.h>
 #include <mp/MpFlowGraphBase.h>
+#include <mp/MpEncodedFrameCache.h>
 #include <mp/MprnRtpStreamActivityMsg.h>
 #include <mp/MprDecodeSelectCodecsMsg.h>
 #include <mp/MpIntResourceMsg.h>
@@ -85,6 +86,7 @@ MprEncode::MprEncode(const UtlString& rName)
    mDisableDTX(TRUE),
    mEnableG722Hack(TRUE),
    mDoG722Hack(FALSE),
+   mSharedBytesPerSample(0),
 
    mNeedResample(FALSE),
    mpResampler(MpResamplerBase::createResampler(1, 8000, 8000)),
@@ -186,6 +188,22 @@ UtlContainableType MprEncode::getContainableType() const
 
 /* ============================ FUNCTIONS ================================= */
 
+// Does the codec encode each sample on its own, without any history?
+static UtlBoolean isStatelessCodec(const MpCodecInfo& rInfo)
+{
+   if (rInfo.getCodecType() != CODEC_TYPE_SAMPLE_BASED ||
+       rInfo.getNumSamplesPerFrame() != 1 ||
+       rInfo.getMinFrameBytes() != rInfo.getMaxFrameBytes())
+   {
+      return FALSE;
+   }
+
+   // Sample based ADPCM codecs (G.722, G.726) do keep state.
+   UtlString mime(rInfo.getMimeSubtype());
+   mime.toUpper();
+   return mime == "PCMU" || mime == "PCMA" || mime == "L16";
+}
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
 OsStatus MprEncode::allocPacketBuffer(const MpEncoderBase& rEncoder,
@@ -221,6 +239,7 @@ void MprEncode::handleDeselectCodecs(void)
    if (NULL != mpPrimaryCodec) {
       delete mpPrimaryCodec;
       mpPrimaryCodec = NULL;
+      mSharedCodecKey.remove(0);
       if (NULL != mpPacket1Payload) {
          delete[] mpPacket1Payload;
          mpPacket1Payload = NULL;
@@ -321,6 +340,18 @@ void MprEncode::handleSelectCodecs(int newCodecsCount, SdpCodec** newCodecs)
       mMaxPacketSamples = mMaxPacketTime*codecSamplesPerSec/1000;
       mMarkNext1 = TRUE;
 
+      // A stateless codec encodes the same frame to the same data, so
+      // encoders fed the same mix can share it.  Resamplers keep state.
+      // Only encoders with the same packet size share frames.
+      if (!mNeedResample && isStatelessCodec(*mpPrimaryCodec->getInfo()))
+      {
+         mSharedCodecKey = mime;
+         mSharedCodecKey.toUpper();
+         mSharedCodecKey.appendFormat("/%u/%d", codecSamplesPerSec,
+                                      mMaxPacketSamples);
+         mSharedBytesPerSample = mpPrimaryCodec->getInfo()->getMaxFrameBytes();
+      }
+
       OsSysLog::add(FAC_MP, PRI_DEBUG,
                     "MprEncode::handleSelectCodecs "
                     "pPrimary->getEncodingName() = %s, "
@@ -591,6 +622,13 @@ void MprEncode::doPrimaryCodec(MpAudioBufPtr in)
       pSamplesIn = in->getSamplesPtr();
    }
 
+   // Encoders fed the same mix share its encoding.
+   const unsigned char* pShared = NULL;
+   if (!mSharedCodecKey.isNull())
+   {
+      pShared = encodeShared(in, pSamplesIn, numSamplesIn);
+   }
+
    while (numSamplesIn > 0)
    {
       if (mPayloadBytesUsed == 0)
@@ -606,9 +644,24 @@ void MprEncode::doPrimaryCodec(MpAudioBufPtr in)
       pDest = mpPacket1Payload + mPayloadBytesUsed;
 
       bytesAdded = 0;
-      ret = mpPrimaryCodec->encode(pSamplesIn, numSamplesIn, numSamplesOut,
-                                   pDest, payloadBytesLeft, bytesAdded,
-                                   isPacketReady, isPacketSilent, codecWantsMarkerSet);
+      if (pShared != NULL)
+      {
+         // Take as much as the codec would have encoded into this packet.
+         numSamplesOut = sipx_min((int)numSamplesIn,
+                                  payloadBytesLeft/mSharedBytesPerSample);
+         bytesAdded = numSamplesOut*mSharedBytesPerSample;
+         memcpy(pDest, pShared, bytesAdded);
+         pShared += bytesAdded;
+         isPacketReady = FALSE;
+         isPacketSilent = FALSE;
+         codecWantsMarkerSet = mpPrimaryCodec->getInfo()->shouldSetMarker();
+      }
+      else
+      {
+         ret = mpPrimaryCodec->encode(pSamplesIn, numSamplesIn, numSamplesOut,
+                                      pDest, payloadBytesLeft, bytesAdded,
+                                      isPacketReady, isPacketSilent, codecWantsMarkerSet);
+      }
       mPayloadBytesUsed += bytesAdded;
       assert (mPacket1PayloadBytes >= mPayloadBytesUsed);
 
@@ -689,6 +742,49 @@ void MprEncode::doPrimaryCodec(MpAudioBufPtr in)
    }
 }
 
+const unsigned char* MprEncode::encodeShared(const MpAudioBufPtr& in,
+                                             const MpAudioSample* pSamples,
+                                             int numSamples)
+{
+   MpEncodedFrameCache* pCache = mpFlowGraph->getEncodedFrameCache();
+   const int frameNum = mpFlowGraph->numFramesProcessed();
+   const int frameBytes = numSamples*mSharedBytesPerSample;
+   int bytes;
+
+   const unsigned char* pData = pCache->find(in, mSharedCodecKey, frameNum,
+                                             bytes);
+   if (pData != NULL)
+   {
+      return bytes == frameBytes ? pData : NULL;
+   }
+
+   // The codec is stateless, so the whole frame is encoded at once.
+   unsigned char* pDest = pCache->store(in, mSharedCodecKey, frameNum,
+                                        frameBytes);
+   int bytesUsed = 0;
+   while (numSamples > 0)
+   {
+      int samplesConsumed = 0;
+      int bytesAdded = 0;
+      UtlBoolean isPacketReady;
+      UtlBoolean isPacketSilent;
+      UtlBoolean shouldSetMarker;
+      if (mpPrimaryCodec->encode(pSamples, numSamples, samplesConsumed,
+                                 pDest + bytesUsed, frameBytes - bytesUsed,
+                                 bytesAdded, isPacketReady, isPacketSilent,
+                                 shouldSetMarker) != OS_SUCCESS
+          || samplesConsumed <= 0)
+      {
+         pCache->reset();
+         return NULL;
+      }
+      pSamples += samplesConsumed;
+      numSamples -= samplesConsumed;
+      bytesUsed += bytesAdded;
+   }
+   return pDest;
+}
+
 void MprEncode::doDtmfCodec(int samplesPerFrame, int samplesPerSecond)
 {
    int numSampleTimes;
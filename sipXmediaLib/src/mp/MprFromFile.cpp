@@ -67,6 +67,10 @@ extern int      samplesPerFrame;
 MprFromFile::MprFromFile(const UtlString& rName)
 : MpAudioResource(rName, 0, 1, 1, 1)
 , mpFileBuffer(NULL)
+, mpPrompt(NULL)
+, mpPlayData(NULL)
+, mPlayDataLength(0)
+, mFileBufferIndex(0)
 , mFileRepeat(FALSE)
 , mState(STATE_IDLE)
 , mAutoStopAfterFinish(TRUE)
@@ -76,7 +80,7 @@ MprFromFile::MprFromFile(const UtlString& rName)
 
 MprFromFile::~MprFromFile()
 {
-   if(mpFileBuffer) delete mpFileBuffer;
+   freePlayData();
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -106,6 +110,8 @@ OsStatus MprFromFile::playBuffer(const UtlString& namedResource, OsMsgQ& fgQ,
       UtlSerialized &msgData = msg.getData();
       stat = msgData.serialize(fgAudBuffer);
       assert(stat == OS_SUCCESS);
+      stat = msgData.serialize((void*)NULL);
+      assert(stat == OS_SUCCESS);
       stat = msgData.serialize(repeat);
       assert(stat == OS_SUCCESS);
       stat = msgData.serialize(autoStopAfterFinish);
@@ -130,7 +136,17 @@ OsStatus MprFromFile::playFile(const UtlString& namedResource,
                                UtlBoolean autoStopAfterFinish)
 {
    UtlString* audioBuffer = NULL;
-   OsStatus stat = readAudioFile(fgSampleRate, audioBuffer, filename);
+   MpPromptCache::Prompt* pPrompt = NULL;
+   OsStatus stat;
+   if (MpPromptCache::isEnabled())
+   {
+      stat = MpPromptCache::getPromptCache()->acquire(filename, fgSampleRate,
+                                                      readAudioFile, pPrompt);
+   }
+   else
+   {
+      stat = readAudioFile(fgSampleRate, audioBuffer, filename);
+   }
    if(stat == OS_SUCCESS)
    {
       MpPackedResourceMsg msg((MpResourceMsg::MpResourceMsgType)MPRM_FROMFILE_START,
@@ -138,12 +154,19 @@ OsStatus MprFromFile::playFile(const UtlString& namedResource,
       UtlSerialized &msgData = msg.getData();
       stat = msgData.serialize(audioBuffer);
       assert(stat == OS_SUCCESS);
+      stat = msgData.serialize((void*)pPrompt);
+      assert(stat == OS_SUCCESS);
       stat = msgData.serialize(repeat);
       assert(stat == OS_SUCCESS);
       stat = msgData.serialize(autoStopAfterFinish);
       assert(stat == OS_SUCCESS);
       msgData.finishSerialize();
       stat = fgQ.send(msg, sOperationQueueTimeout);
+      if (stat != OS_SUCCESS && pPrompt != NULL)
+      {
+         // Resource will never get this reference.
+         pPrompt->release();
+      }
    }
    else
    {
@@ -701,7 +724,7 @@ UtlBoolean MprFromFile::doProcessFrame(MpBufPtr inBufs[],
    // otherwise pass through.
    if (isEnabled && mState == STATE_PLAYING)
    {
-      if (mpFileBuffer)
+      if (mpPlayData)
       {
          // Get new buffer
          out = MpMisc.RawAudioPool->getBuffer();
@@ -715,14 +738,14 @@ UtlBoolean MprFromFile::doProcessFrame(MpBufPtr inBufs[],
          outbuf = out->getSamplesWritePtr();
 
          int bytesPerFrame = count * sizeof(MpAudioSample);
-         int bufferLength = mpFileBuffer->length();
+         int bufferLength = mPlayDataLength;
          int totalBytesRead = 0;
 
          if(mFileBufferIndex < bufferLength)
          {
             totalBytesRead = bufferLength - mFileBufferIndex;
             totalBytesRead = sipx_min(totalBytesRead, bytesPerFrame);
-            memcpy(outbuf, &(mpFileBuffer->data()[mFileBufferIndex]),
+            memcpy(outbuf, &mpPlayData[mFileBufferIndex],
                    totalBytesRead);
             mFileBufferIndex += totalBytesRead;
          }
@@ -736,7 +759,7 @@ UtlBoolean MprFromFile::doProcessFrame(MpBufPtr inBufs[],
                bytesLeft = sipx_min(bufferLength - mFileBufferIndex,
                                bytesPerFrame - totalBytesRead);
                memcpy(&outbuf[(totalBytesRead/sizeof(MpAudioSample))],
-                      &(mpFileBuffer->data()[mFileBufferIndex]), bytesLeft);
+                      &mpPlayData[mFileBufferIndex], bytesLeft);
                totalBytesRead += bytesLeft;
                mFileBufferIndex += bytesLeft;
             }
@@ -774,7 +797,7 @@ UtlBoolean MprFromFile::doProcessFrame(MpBufPtr inBufs[],
             unsigned amountPlayedMS = 
                mFileBufferIndex / sizeof(MpAudioSample) / samplesPerSecond;
             unsigned totalBufferMS = 
-               mpFileBuffer->length() / sizeof(MpAudioSample) / samplesPerSecond;
+               mPlayDataLength / sizeof(MpAudioSample) / samplesPerSecond;
 
             MprnProgressMsg progressMsg(MpResNotificationMsg::MPRNM_FROMFILE_PROGRESS,
                                         getName(), amountPlayedMS, totalBufferMS);
@@ -796,7 +819,9 @@ UtlBoolean MprFromFile::doProcessFrame(MpBufPtr inBufs[],
 
 // This is used in both old and new messaging schemes to initialize everything
 // and start playing a buffer, when a play is requested.
-UtlBoolean MprFromFile::handlePlay(UtlString* pBuffer, UtlBoolean repeat,
+UtlBoolean MprFromFile::handlePlay(UtlString* pBuffer,
+                                   MpPromptCache::Prompt* pPrompt,
+                                   UtlBoolean repeat,
                                    UtlBoolean autoStopAfterFinish)
 {
    // Stop previous playback if still playing it.
@@ -807,12 +832,21 @@ UtlBoolean MprFromFile::handlePlay(UtlString* pBuffer, UtlBoolean repeat,
    // We must be in STATE_IDLE at this point.
    assert(mState == STATE_IDLE);
 
+   freePlayData();
+   mpFileBuffer = pBuffer;
+   mpPrompt = pPrompt;
    if (mpFileBuffer)
    {
-      delete mpFileBuffer;
+      mpPlayData = mpFileBuffer->data();
+      mPlayDataLength = mpFileBuffer->length();
    }
-   mpFileBuffer = pBuffer;
-   if (mpFileBuffer) 
+   else if (mpPrompt)
+   {
+      // Cached audio is read in place, no private copy is made.
+      mpPlayData = mpPrompt->getData();
+      mPlayDataLength = mpPrompt->getDataSize();
+   }
+   if (mpPlayData)
    {
       mFileBufferIndex = 0;
       mFileRepeat = repeat;
@@ -835,12 +869,7 @@ UtlBoolean MprFromFile::handleFinish()
       sendNotification(MpResNotificationMsg::MPRNM_FROMFILE_FINISHED);
 
       // Cleanup.
-      if (mpFileBuffer)
-      {
-         delete mpFileBuffer;
-         mpFileBuffer = NULL;
-         mFileBufferIndex = 0;
-      }
+      freePlayData();
 
       // Set state.
       mState = STATE_FINISHED;
@@ -865,12 +894,7 @@ UtlBoolean MprFromFile::handleStop()
    if (mState != STATE_IDLE)
    {
       // Cleanup if not done yet.
-      if (mpFileBuffer)
-      {
-         delete mpFileBuffer;
-         mpFileBuffer = NULL;
-         mFileBufferIndex = 0;
-      }
+      freePlayData();
 
       // Set state.
       mState = STATE_IDLE;
@@ -883,6 +907,24 @@ UtlBoolean MprFromFile::handleStop()
    return TRUE;
 }
 
+void MprFromFile::freePlayData()
+{
+   if (mpFileBuffer)
+   {
+      delete mpFileBuffer;
+      mpFileBuffer = NULL;
+   }
+   if (mpPrompt)
+   {
+      // Cache frees the audio later, outside of the media task.
+      mpPrompt->release();
+      mpPrompt = NULL;
+   }
+   mpPlayData = NULL;
+   mPlayDataLength = 0;
+   mFileBufferIndex = 0;
+}
+
 UtlBoolean MprFromFile::handlePause()
 {
    if (mState == STATE_PLAYING || mState == STATE_PAUSED)
@@ -936,18 +978,22 @@ UtlBoolean MprFromFile::handleMessage(MpResourceMsg& rMsg)
       {
          OsStatus stat;
          UtlString *pAudioBuffer;
+         MpPromptCache::Prompt *pPrompt;
          UtlBoolean isRepeating;
          UtlBoolean autoStopAfterFinish;
 
          UtlSerialized &msgData = ((MpPackedResourceMsg*)(&rMsg))->getData();
          stat = msgData.deserialize((void*&)pAudioBuffer);
          assert(stat == OS_SUCCESS);
+         stat = msgData.deserialize((void*&)pPrompt);
+         assert(stat == OS_SUCCESS);
          stat = msgData.deserialize(isRepeating);
          assert(stat == OS_SUCCESS);
          stat = msgData.deserialize(autoStopAfterFinish);
          assert(stat == OS_SUCCESS);
 
-         msgHandled = handlePlay(pAudioBuffer, isRepeating, autoStopAfterFinish);
+         msgHandled = handlePlay(pAudioBuffer, pPrompt, isRepeating,
+                                 autoStopAfterFinish);
       }
       break;
 
@@ -35,11 +35,13 @@
 #include <mp/MpEncoderBase.h>
 #include <mp/MpResampler.h>
 #include <mp/MpCodecFactory.h>
+#include <mp/MpRecorderWriter.h>
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
 // CONSTANTS
 // STATIC VARIABLE INITIALIZATIONS
+UtlBoolean MprRecorder::sAsyncFileWrite = FALSE;
 
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
@@ -58,6 +60,9 @@ MprRecorder::MprRecorder(const UtlString& rName)
 , mSilenceLength(0)
 , mFileDescriptor(-1)
 , mRecFormat(UNINITIALIZED_FORMAT)
+, mAsyncFileWrite(FALSE)
+, mDroppedFrames(0)
+, mPendingAsyncOps(0)
 , mpBuffer(NULL)
 , mBufferSize(0)
 , mpEncoder(NULL)
@@ -78,6 +83,12 @@ MprRecorder::~MprRecorder()
    // then close it now.
    closeFile("~MprRecorder");
 
+   // Writer must be done with all our commands before we go away.
+   while (mPendingAsyncOps > 0)
+   {
+      OsTask::delay(1);
+   }
+
    if(mpEncoder)
    {
        delete mpEncoder;
@@ -357,10 +368,20 @@ OsStatus MprRecorder::stop(const UtlString& namedResource, OsMsgQ& fgQ)
    return(status);
 }
 
+void MprRecorder::setAsyncFileWrite(UtlBoolean enable)
+{
+   sAsyncFileWrite = enable;
+}
+
 /* ============================ ACCESSORS ================================= */
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean MprRecorder::isAsyncFileWrite()
+{
+   return sAsyncFileWrite;
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 UtlBoolean MprRecorder::doProcessFrame(MpBufPtr inBufs[],
@@ -690,6 +711,8 @@ UtlBoolean MprRecorder::handleStartFile(int file,
     }
     mFileDescriptor = file;
     mRecordDestination = TO_FILE;
+    mAsyncFileWrite = sAsyncFileWrite;
+    mDroppedFrames = 0;
 
     mChannels = numChannels;
     if(numChannels < 1)
@@ -887,7 +910,7 @@ UtlBoolean MprRecorder::handleMessage(MpResourceMsg& rMsg)
           MprnIntMsg msg(MpResNotificationMsg::MPRNM_RECORDER_PAUSED,
                          getName(),
                          mSamplesRecorded);
-          sendNotification(msg);
+          sendNotificationAfterFlush(msg);
           return(TRUE);
       }
       else
@@ -903,7 +926,10 @@ UtlBoolean MprRecorder::handleMessage(MpResourceMsg& rMsg)
       if(mState == STATE_PAUSED)
       {
           mState = STATE_RECORDING;
-          sendNotification(MpResNotificationMsg::MPRNM_RECORDER_RESUMED);
+          // Must not overtake pause notification.
+          MpResNotificationMsg msg(MpResNotificationMsg::MPRNM_RECORDER_RESUMED,
+                                   getName());
+          sendNotificationAfterFlush(msg);
           return(TRUE);
       }
       else
@@ -952,7 +978,10 @@ void MprRecorder::startRecording(int time, int silenceLength)
    mState = STATE_RECORDING;
 
    handleEnable();
-   sendNotification(MpResNotificationMsg::MPRNM_RECORDER_STARTED);
+   // Must not overtake stop notification of the previous recording.
+   MpResNotificationMsg msg(MpResNotificationMsg::MPRNM_RECORDER_STARTED,
+                            getName());
+   sendNotificationAfterFlush(msg);
 }
 
 UtlBoolean MprRecorder::finish(FinishCause cause)
@@ -982,7 +1011,7 @@ UtlBoolean MprRecorder::finish(FinishCause cause)
          MprnIntMsg msg(MpResNotificationMsg::MPRNM_RECORDER_FINISHED,
                         getName(),
                         mSamplesRecorded);
-         sendNotification(msg);
+         sendNotificationAfterFlush(msg);
       }
       break;
    case FINISHED_MANUAL:
@@ -990,13 +1019,18 @@ UtlBoolean MprRecorder::finish(FinishCause cause)
          MprnIntMsg msg(MpResNotificationMsg::MPRNM_RECORDER_STOPPED,
                         getName(),
                         mSamplesRecorded);
-         sendNotification(msg);
+         sendNotificationAfterFlush(msg);
       }
       break;
    case FINISHED_ERROR:
-      sendNotification(MpResNotificationMsg::MPRNM_RECORDER_ERROR);
+      {
+         MpResNotificationMsg msg(MpResNotificationMsg::MPRNM_RECORDER_ERROR,
+                                  getName());
+         sendNotificationAfterFlush(msg);
+      }
       break;
    }
+   mAsyncFileWrite = FALSE;
 
    return res;
 }
@@ -1049,7 +1083,10 @@ void MprRecorder::closeFile(const char* fromWhereLabel)
                    break;
            }
 
-           updateWaveHeaderLengths(mFileDescriptor, mRecFormat);
+           if(!mAsyncFileWrite)
+           {
+               updateWaveHeaderLengths(mFileDescriptor, mRecFormat);
+           }
            if(mRecFormat == WAV_GSM && mLastEncodedFrameSize != 33)
            {
                    OsSysLog::add(FAC_MP, PRI_ERR,
@@ -1057,7 +1094,25 @@ void MprRecorder::closeFile(const char* fromWhereLabel)
                            mLastEncodedFrameSize);
            }
         }
-        close(mFileDescriptor);
+
+        if(mAsyncFileWrite)
+        {
+            if(mDroppedFrames > 0)
+            {
+                OsSysLog::add(FAC_MP, PRI_WARNING,
+                        "MprRecorder::closeFile(%s) this: %p fd: %d %d frames dropped because writer queue was full",
+                        fromWhereLabel, this, mFileDescriptor, mDroppedFrames);
+            }
+            // Writer updates WAV header and closes the file when all
+            // queued data is written.
+            MpRecorderWriter::getRecorderWriter()->closeFile(mFileDescriptor,
+                                                             mRecFormat,
+                                                             &mPendingAsyncOps);
+        }
+        else
+        {
+            close(mFileDescriptor);
+        }
         mFileDescriptor = -1;
     }
 
@@ -1072,6 +1127,27 @@ void MprRecorder::closeFile(const char* fromWhereLabel)
 }
 
 
+void MprRecorder::sendNotificationAfterFlush(MpResNotificationMsg& msg)
+{
+    // Notifications sent earlier could be still waiting in the writer queue.
+    if(!mAsyncFileWrite && mPendingAsyncOps == 0)
+    {
+        sendNotification(msg);
+        return;
+    }
+
+    if(areNotificationsEnabled())
+    {
+        // Same as MpResource::sendNotification() does.
+        msg.setConnectionId(mConnectionId);
+        msg.setStreamId(mStreamId);
+        MpRecorderWriter::getRecorderWriter()->postNotification(mFileDescriptor,
+                                                                getFlowGraph(),
+                                                                (MpResNotificationMsg*)msg.createCopy(),
+                                                                &mPendingAsyncOps);
+    }
+}
+
 int MprRecorder::writeFileSilence(int numSamples)
 {
     assert(((int)MpMisc.mpFgSilence->getSamplesNumber()) >= numSamples);
@@ -1247,6 +1323,21 @@ int MprRecorder::writeFile(char* channelData[], int dataSize)
     int totalWritten = 0;
     int bytesPerSample = getBytesPerSample(mRecFormat);
 
+    if(mAsyncFileWrite)
+    {
+        // Dropped frames are counted and reported on close rather than
+        // reported as write errors on every frame.
+        if(MpRecorderWriter::getRecorderWriter()->writeData(mFileDescriptor,
+                                                            channelData,
+                                                            mChannels,
+                                                            dataSize,
+                                                            bytesPerSample) != OS_SUCCESS)
+        {
+            mDroppedFrames++;
+        }
+        return(dataSize * mChannels);
+    }
+
     // For single channel audio, we can short circuit the channel interlace
     // and write in one big chunk.
     if(mChannels == 1)
@@ -3,7 +3,7 @@
 //
 // $$
 // Simple implementation of a Tone Detector using the Goertzel
-// algorithm with a window.  Target is 2175 Hz, block size (N) is 
+// algorithm (MpGoertzelBank) with a window.  Target is 2175 Hz, block size (N) is 
 // 160 (2 buffers worth), debouncing is done by computing average of last 3 
 // and requring this to be above the threshold to send notification.  If 
 // below the threshold and we've sent an "on", send and off.
@@ -12,6 +12,7 @@
 
 // SYSTEM INCLUDES
 #include <assert.h>
+#include <string.h>
 #include <cmath>
 #include <limits>
 
@@ -47,9 +48,6 @@ const int MprToneDetect::DEFAULT_WINDOW_SIZE=3;
 // Constructor
 MprToneDetect::MprToneDetect(const UtlString& rName)
 : MpAudioResource(rName, 0, 1, 1, 1)
-, mCoeff(0.0)
-, mQ1(0.0)
-, mQ2(0.0)
 , mThreshold(DEFAULT_THRESHOLD)
 , mTargetFreq(DEFAULT_TARGET_FREQ)
 , mBlockCnt(0)
@@ -62,6 +60,7 @@ MprToneDetect::MprToneDetect(const UtlString& rName)
 , mpFlowGraph(NULL)
 {
     mFilterData = new double[mBlockSize];
+    mpBlock = new MpAudioSample[mBlockSize];
     initFilter();
     initGoertzel();
 }
@@ -70,6 +69,7 @@ MprToneDetect::MprToneDetect(const UtlString& rName)
 MprToneDetect::~MprToneDetect()
 {
     delete [] mFilterData;
+    delete [] mpBlock;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -90,7 +90,8 @@ UtlBoolean MprToneDetect::doProcessFrame(MpBufPtr inBufs[],
                                          int samplesPerSecond)
 {
    MpAudioBufPtr out;
-   const MpAudioSample* pBuf;
+   const MpAudioSample* pBuf = NULL;
+   unsigned numSamples = samplesPerFrame;
 
    // We're disabled or have nothing to process.
    if ( outBufsSize == 0 || inBufsSize == 0 )
@@ -104,23 +105,43 @@ UtlBoolean MprToneDetect::doProcessFrame(MpBufPtr inBufs[],
       return TRUE;
    }
 
-   // We're not modifying the buffers, simply running them through the algorithm
-   pBuf = out->getSamplesPtr();
+   // We're not modifying the buffers, simply running them through the algorithm.
+   // No buffer means silence.
+   if (out.isValid())
+   {
+       pBuf = out->getSamplesPtr();
+       numSamples = out->getSamplesNumber();
+   }
 
-   for (unsigned i = 0; i < out->getSamplesNumber(); i++)
+   unsigned i = 0;
+   while (i < numSamples)
    {
-       processSample((MpAudioSample)filterSample(pBuf[i], mBlockCnt));
-       mBlockCnt++; // this is "n" in the block
+       // Collect samples of the block, mBlockCnt is "n" in the block
+       unsigned toCopy = mBlockSize - mBlockCnt;
+       if (toCopy > numSamples - i)
+       {
+           toCopy = numSamples - i;
+       }
+       if (pBuf != NULL)
+       {
+           memcpy(mpBlock + mBlockCnt, pBuf + i, toCopy * sizeof(MpAudioSample));
+       }
+       else
+       {
+           memset(mpBlock + mBlockCnt, 0, toCopy * sizeof(MpAudioSample));
+       }
+       mBlockCnt += toCopy;
+       i += toCopy;
+
        if (mBlockCnt == mBlockSize)
        {
            double tMag = 0;
-           // ok, we've computed a full block, start
+           // ok, we've got a full block, start
            // seeing if we've detected tone
-           tMag = sqrt(getMagnitudeSquared());
+           tMag = processBlock();
            mAvg3Mag += (tMag - mAvg3Mag) / mWindowSize;
            mCurTd = (mAvg3Mag > mThreshold) ? true : false;
            mBlockCnt = 0;
-           resetGoertzel();
            OsSysLog::add(FAC_MP, PRI_DEBUG,"MprToneDetect cur %d avg3 %d", (int)tMag, (int)mAvg3Mag);
            if (mCurTd && !mToneSignaled)
            {
@@ -205,13 +226,6 @@ OsStatus MprToneDetect::setFlowGraph(MpFlowGraphBase* pFlowGraph)
    return res;
 }
 
-// reset the algorithm for the next block
-void MprToneDetect::resetGoertzel(void)
-{
-    mQ2 = 0;
-    mQ1 = 0;
-}
-
 // this initializes the constants based on the target frequency
 // resets counters, history and min/max
 // call on ctor() or change in frequency/threshold
@@ -220,38 +234,45 @@ void MprToneDetect::initGoertzel(void)
 #if 1
     int        k;
     double omega;
+    double coeff;
 
     k = (int) (0.5 + ((mBlockSize * mTargetFreq) / mSampleRate));
     omega = (2.0 * M_PI * k) / mBlockSize;
-    mCoeff = 2.0 * cos(omega);
+    coeff = 2.0 * cos(omega);
 #else
     // the above simplifies to this, but the truncate to integer of k
     // gives better results than leaving it all floats
-    mCoeff = 2.0 * cos((2.0 * M_PI * mTargetFreq / mSampleRate));
+    double coeff = 2.0 * cos((2.0 * M_PI * mTargetFreq / mSampleRate));
 #endif
     mBlockCnt = 0;
     mCurTd = false;
     mAvg3Mag = 0.0;
 
-    resetGoertzel();
-}
-
-// calculate the values for this sample
-void MprToneDetect::processSample(MpAudioSample sample)
-{
-    double Q0;
-    Q0 = mCoeff * mQ1 - mQ2 + (double) sample;
-    mQ2 = mQ1;
-    mQ1 = Q0;
+    // This resets the filter too
+    mBank.setCoefficients(1, &coeff);
 }
 
 // Magnitude of the block
-double MprToneDetect::getMagnitudeSquared(void)
+double MprToneDetect::processBlock(void)
 {
     double result;
 
-    result = mQ1 * mQ1 + mQ2 * mQ2 - mQ1 * mQ2 * mCoeff;
-    return result;
+    // Energy gate: zero samples give zero magnitude
+    if (MpGoertzelBank::isBelowPower(mpBlock, mBlockSize, 0.0))
+    {
+        return 0.0;
+    }
+
+    unsigned n;
+    for (n = 0; n < mBlockSize; n++)
+    {
+        mpBlock[n] = (MpAudioSample)filterSample(mpBlock[n], n);
+    }
+
+    mBank.reset();
+    mBank.process(mpBlock, mBlockSize);
+    mBank.getPowers(&result);
+    return sqrt(result);
 } 
 
 #define HAMM
@@ -271,7 +292,7 @@ void MprToneDetect::initFilter()
     }
 }
 
-// apply the filter to the sample before calling processSample()
+// apply the filter to the sample before running the Goertzel filter
 double MprToneDetect::filterSample(MpAudioSample sample, uint32_t n)
 {
     return mFilterData[n]*double(sample);
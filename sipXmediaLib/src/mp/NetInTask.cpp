@@ -50,6 +50,15 @@
 #include <mp/MpUdpBuf.h>
 #include <mp/MprFromNet.h>
 #include <utl/UtlRandom.h>
+#include <utl/UtlHashMap.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlVoidPtr.h>
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#endif /* NET_IN_TASK_USE_EPOLL ] */
 #ifdef _VXWORKS /* [ */
 #ifdef CPU_XSCALE /* [ */
 #include <mp/pxa255.h">
@@ -99,6 +108,7 @@ static  int numPairs;
 
 NetInTask* NetInTask::spInstance = 0;
 OsRWMutex     NetInTask::sLock(OsBSem::Q_PRIORITY);
+int           NetInTask::sNumReceiveThreads = 1;
 
 const int NetInTask::DEF_NET_IN_TASK_PRIORITY  = 0;   // default task priority: HIGHEST
 const int NetInTask::DEF_NET_IN_TASK_OPTIONS   = 0;   // default task options
@@ -344,6 +354,488 @@ int findPoisonFds(int pipeFD)
         return n;
 }
 
+/************************************************************************/
+
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+
+#define NET_IN_EPOLL_MAX_EVENTS 64   ///< Events processed per epoll_wait()
+#define NET_IN_RECV_BATCH       16   ///< Datagrams read per recvmmsg()
+#define NET_IN_MAX_RECV_BATCHES 4    ///< recvmmsg() calls per ready socket
+                                     ///<  per wakeup, for fairness.
+
+struct netInPair;
+
+/// One socket registered with a receive loop.
+struct netInSource {
+   OsSocket*  pSocket;   ///< NULL if socket was removed due to read error.
+   netInPair* pPair;     ///< Pair this source belongs to.
+   bool       isRtcp;
+};
+
+/// Pair of RTP and RTCP sockets, forwarding to one MprFromNet.
+struct netInPair {
+   netInSource rtp;
+   netInSource rtcp;
+   MprFromNet* fwdTo;
+};
+
+/**
+*  @brief epoll based receive loop for a shard of NetInTask sockets.
+*
+*  Each receive loop has its own epoll set, its own command connection and
+*  its own table of socket pairs keyed by MprFromNet. Only the thread running
+*  the loop touches the table and the epoll set, so no locking is needed
+*  besides the NetInTask command socket lock.
+*/
+class NetInReceiver
+{
+public:
+   NetInReceiver(int index, int numReceivers);
+   ~NetInReceiver();
+
+     /// Start own thread running this loop.
+   void startThread();
+
+     /// Run receive loop until exit message is received.
+   void run();
+
+     /// Return write side of the command connection.
+   OsConnectionSocket* getWriteSocket() {return mpWriteSocket;}
+
+     /// Close and free write side of the command connection.
+   void closeWriteSocket();
+
+     /// Return port number of the command connection.
+   int getCmdPort() const {return mCmdPort;}
+
+private:
+
+     /// Process one message from the command connection.
+   void handleCommand();
+
+     /// Add pair of sockets from the message.
+   void addPair(const netInTaskMsg& msg);
+
+     /// Remove pair of sockets forwarding to given resource.
+   void removePair(MprFromNet* fwdTo);
+
+     /// Register socket with epoll set.
+   void addSource(netInSource* pSrc);
+
+     /// Unregister socket from epoll set.
+   void removeSource(netInSource* pSrc);
+
+     /// Read all pending datagrams from ready socket.
+   OsStatus receiveAll(netInSource* pSrc, int ostc);
+
+   int                 mIndex;
+   int                 mNumReceivers; ///< Number of loops sharing UdpPool.
+   int                 mEpollFd;
+   OsConnectionSocket* mpReadSocket;
+   OsConnectionSocket* mpWriteSocket;
+   int                 mCmdPort;
+   UtlHashMap          mPairs;    ///< MprFromNet* -> netInPair*
+   OsTask*             mpTask;    ///< Own thread, NULL for the loop run by
+                                  ///<  NetInTask itself.
+};
+
+/// Task running a NetInReceiver loop in its own thread.
+class NetInReceiverTask : public OsTask
+{
+public:
+   NetInReceiverTask(NetInReceiver* pReceiver)
+   : OsTask("NetInReceiver-%d", NULL,
+            NetInTask::DEF_NET_IN_TASK_PRIORITY,
+            NetInTask::DEF_NET_IN_TASK_OPTIONS,
+            NetInTask::DEF_NET_IN_TASK_STACKSIZE)
+   , mpReceiver(pReceiver)
+   {
+   }
+
+   ~NetInReceiverTask()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void*)
+   {
+      mpReceiver->run();
+      return 0;
+   }
+
+private:
+   NetInReceiver* mpReceiver;
+};
+
+NetInReceiver::NetInReceiver(int index, int numReceivers)
+: mIndex(index)
+, mNumReceivers(numReceivers)
+, mEpollFd(-1)
+, mpReadSocket(NULL)
+, mpWriteSocket(NULL)
+, mCmdPort(-1)
+, mpTask(NULL)
+{
+   mCmdPort = NetInTask::createCommandConnection(mpReadSocket, mpWriteSocket);
+
+   mEpollFd = epoll_create(NET_IN_EPOLL_MAX_EVENTS);
+   if (mEpollFd < 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_ERR,
+                    "NetInReceiver::NetInReceiver(%d) epoll_create failed, errno: %d",
+                    mIndex, errno);
+      assert(!"NetInReceiver: epoll_create failed!");
+      return;
+   }
+
+   // Command connection is marked by NULL pointer.
+   struct epoll_event ev;
+   memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN;
+   ev.data.ptr = NULL;
+   if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD,
+                 mpReadSocket->getSocketDescriptor(), &ev) < 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_ERR,
+                    "NetInReceiver::NetInReceiver(%d) can't watch command socket %d, errno: %d",
+                    mIndex, mpReadSocket->getSocketDescriptor(), errno);
+   }
+}
+
+NetInReceiver::~NetInReceiver()
+{
+   // Wait for the loop to exit.
+   delete mpTask;
+
+   // Free pairs which were not removed by their owners.
+   UtlHashMapIterator iter(mPairs);
+   while (iter())
+   {
+      delete (netInPair*)((UtlVoidPtr*)iter.value())->getValue();
+   }
+   mPairs.destroyAll();
+
+   if (mEpollFd >= 0)
+   {
+      close(mEpollFd);
+   }
+   if (mpReadSocket)
+   {
+      mpReadSocket->close();
+      delete mpReadSocket;
+   }
+   delete mpWriteSocket;
+}
+
+void NetInReceiver::startThread()
+{
+   assert(mpTask == NULL);
+   mpTask = new NetInReceiverTask(this);
+   UtlBoolean isStarted = mpTask->start();
+   assert(isStarted);
+}
+
+void NetInReceiver::closeWriteSocket()
+{
+   if (mpWriteSocket)
+   {
+      mpWriteSocket->close();
+      delete mpWriteSocket;
+      mpWriteSocket = NULL;
+   }
+}
+
+void NetInReceiver::run()
+{
+   struct epoll_event events[NET_IN_EPOLL_MAX_EVENTS];
+
+   while (mpReadSocket && mpReadSocket->isOk())
+   {
+      RTL_EVENT("NetInTask.run", 0);
+      int numReady = epoll_wait(mEpollFd, events, NET_IN_EPOLL_MAX_EVENTS, -1);
+      RTL_EVENT("NetInTask.run", 1);
+      int ostc = *pOsTC;
+      if (numReady < 0)
+      {
+         if (errno != EINTR)
+         {
+            OsSysLog::add(FAC_MP, PRI_ERR,
+                          " *** NetInReceiver(%d): epoll_wait returned %d, errno=%d\n",
+                          mIndex, numReady, errno);
+            OsTask::delay(1);
+         }
+         continue;
+      }
+
+      // Read data first and process commands after that. Thus a pair
+      // removed by a command is never accessed by the rest of this batch.
+      UtlBoolean isCommandReady = FALSE;
+      for (int i = 0; i < numReady; i++)
+      {
+         netInSource* pSrc = (netInSource*)events[i].data.ptr;
+         if (pSrc == NULL)
+         {
+            isCommandReady = TRUE;
+            continue;
+         }
+
+         // Socket may have been removed by previous event of this batch.
+         if (pSrc->pSocket == NULL)
+         {
+            continue;
+         }
+
+         if (receiveAll(pSrc, ostc) != OS_SUCCESS)
+         {
+            OsSysLog::add(FAC_MP, PRI_ERR,
+                          " *** NetInReceiver(%d): removing %s pSkt=%p due"
+                          " to read error.\n", mIndex,
+                          pSrc->isRtcp ? "RTCP" : "RTP", pSrc->pSocket);
+            removeSource(pSrc);
+         }
+      }
+
+      if (isCommandReady)
+      {
+         handleCommand();
+      }
+   }
+
+   OsSysLog::add(FAC_MP, PRI_DEBUG, 
+                 "NetInReceiver::run(%d) exiting mpReadSocket: %p",
+                 mIndex, mpReadSocket);
+}
+
+void NetInReceiver::handleCommand()
+{
+   netInTaskMsg msg;
+   int readBytes;
+
+   NetInTask::getLockObj().acquireWrite();
+   readBytes = mpReadSocket->read((char *) &msg, NET_TASK_MAX_MSG_LEN);
+   NetInTask::getLockObj().releaseWrite();
+
+   if (NET_TASK_MAX_MSG_LEN != readBytes)
+   {
+      OsSysLog::add(FAC_MP, PRI_DEBUG,
+                    "NetInReceiver::handleCommand(%d) read %d from mpReadSocket socket: %p descriptor: %d errno: %d",
+                    mIndex, readBytes, mpReadSocket,
+                    mpReadSocket->getSocketDescriptor(), errno);
+   }
+   else if (-2 == (intptr_t) msg.pRtpSocket)
+   {
+      /* request to exit... */
+      OsSysLog::add(FAC_MP, PRI_DEBUG,
+                    " *** NetInReceiver(%d): closing pipeFd (%d)\n",
+                    mIndex, mpReadSocket->getSocketDescriptor());
+      NetInTask::getLockObj().acquireWrite();
+      mpReadSocket->close();
+      delete mpReadSocket;
+      mpReadSocket = NULL;
+      NetInTask::getLockObj().releaseWrite();
+   }
+   else if (NULL != msg.fwdTo)
+   {
+      if ((NULL != msg.pRtpSocket) || (NULL != msg.pRtcpSocket))
+      {
+         addPair(msg);
+      }
+      else
+      {
+         removePair(msg.fwdTo);
+      }
+
+      if (NULL != msg.notify)
+      {
+         msg.notify->signal(0);
+      }
+   }
+   else // NULL FromNet, not good
+   {
+      osPrintf("NetInReceiver::handleCommand msg with NULL FromNet\n");
+   }
+}
+
+void NetInReceiver::addPair(const netInTaskMsg& msg)
+{
+   UtlVoidPtr key(msg.fwdTo);
+   if (mPairs.findValue(&key) != NULL)
+   {
+      OsSysLog::add(FAC_MP, PRI_WARNING,
+                    " *** NetInReceiver(%d): receiver %p added twice,"
+                    " replacing old sockets\n", mIndex, msg.fwdTo);
+      removePair(msg.fwdTo);
+   }
+
+   netInPair* pPair = new netInPair;
+   pPair->fwdTo = msg.fwdTo;
+   pPair->rtp.pSocket = msg.pRtpSocket;
+   pPair->rtp.pPair = pPair;
+   pPair->rtp.isRtcp = false;
+   pPair->rtcp.pSocket = msg.pRtcpSocket;
+   pPair->rtcp.pPair = pPair;
+   pPair->rtcp.isRtcp = true;
+
+   // Clear out any packets residing in the socket's buffer to prevent
+   // our dejitter from a burst of packets on startup.
+   if (msg.pRtpSocket)
+      flushReadQueue(msg.pRtpSocket);
+   if (msg.pRtcpSocket)
+      flushReadQueue(msg.pRtcpSocket);
+
+   addSource(&pPair->rtp);
+   addSource(&pPair->rtcp);
+   mPairs.insertKeyAndValue(new UtlVoidPtr(msg.fwdTo), new UtlVoidPtr(pPair));
+
+   OsSysLog::add(FAC_MP, PRI_DEBUG,
+                 " *** NetInReceiver(%d): Add socket Fds:"
+                 " RTP=%p, RTCP=%p, receiver=%p\n",
+                 mIndex, msg.pRtpSocket, msg.pRtcpSocket, msg.fwdTo);
+}
+
+void NetInReceiver::removePair(MprFromNet* fwdTo)
+{
+   UtlVoidPtr key(fwdTo);
+   UtlContainable* pValue = NULL;
+   UtlContainable* pKey = mPairs.removeKeyAndValue(&key, pValue);
+   if (pKey == NULL)
+   {
+      return;
+   }
+
+   netInPair* pPair = (netInPair*)((UtlVoidPtr*)pValue)->getValue();
+   OsSysLog::add(FAC_MP, PRI_DEBUG,
+                 " *** NetInReceiver(%d): Remove socket Fds:"
+                 " RTP=%p, RTCP=%p, receiver=%p\n",
+                 mIndex, pPair->rtp.pSocket, pPair->rtcp.pSocket, fwdTo);
+   removeSource(&pPair->rtp);
+   removeSource(&pPair->rtcp);
+   delete pPair;
+   delete pKey;
+   delete pValue;
+}
+
+void NetInReceiver::addSource(netInSource* pSrc)
+{
+   if (pSrc->pSocket == NULL)
+   {
+      return;
+   }
+
+   struct epoll_event ev;
+   memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN;
+   ev.data.ptr = pSrc;
+   int fd = pSrc->pSocket->getSocketDescriptor();
+   if (fd < 0 || epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+   {
+      OsSysLog::add(FAC_MP, PRI_ERR,
+                    " *** NetInReceiver(%d): can't watch %s socket %p,"
+                    " descriptor: %d, errno: %d\n",
+                    mIndex, pSrc->isRtcp ? "RTCP" : "RTP",
+                    pSrc->pSocket, fd, errno);
+      pSrc->pSocket = NULL;
+   }
+}
+
+void NetInReceiver::removeSource(netInSource* pSrc)
+{
+   if (pSrc->pSocket == NULL)
+   {
+      return;
+   }
+
+   // Closed descriptors are removed from epoll set automatically, so
+   // failure here is not an error.
+   int fd = pSrc->pSocket->getSocketDescriptor();
+   if (fd >= 0)
+   {
+      epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL);
+   }
+   pSrc->pSocket = NULL;
+}
+
+OsStatus NetInReceiver::receiveAll(netInSource* pSrc, int ostc)
+{
+   MprFromNet* fwdTo = pSrc->pPair->fwdTo;
+   int fd = pSrc->pSocket->getSocketDescriptor();
+   MpUdpBufPtr bufs[NET_IN_RECV_BATCH];
+   struct mmsghdr msgs[NET_IN_RECV_BATCH];
+   struct iovec iovs[NET_IN_RECV_BATCH];
+   struct sockaddr_in addrs[NET_IN_RECV_BATCH];
+
+   for (int batch = 0; batch < NET_IN_MAX_RECV_BATCHES; batch++)
+   {
+      // All receive loops fill their batches from UdpPool, so each one takes
+      // no more than its share of the buffers the pool can still give out.
+      MpBufPool* pPool = MpMisc.UdpPool;
+      int numAvailable = pPool->getFreeBufferCount()
+                       + (int)(pPool->getMaxBlocks() - pPool->getNumBlocks());
+      int batchSize = sipx_min(NET_IN_RECV_BATCH,
+                               sipx_max(1, numAvailable / mNumReceivers));
+
+      int numBufs;
+      for (numBufs = 0; numBufs < batchSize; numBufs++)
+      {
+         bufs[numBufs] = MpMisc.UdpPool->getBuffer();
+         if (!bufs[numBufs].isValid())
+         {
+            break;
+         }
+         iovs[numBufs].iov_base = bufs[numBufs]->getDataWritePtr();
+         iovs[numBufs].iov_len = bufs[numBufs]->getMaximumPacketSize();
+         memset(&msgs[numBufs], 0, sizeof(msgs[numBufs]));
+         msgs[numBufs].msg_hdr.msg_name = &addrs[numBufs];
+         msgs[numBufs].msg_hdr.msg_namelen = sizeof(addrs[numBufs]);
+         msgs[numBufs].msg_hdr.msg_iov = &iovs[numBufs];
+         msgs[numBufs].msg_hdr.msg_iovlen = 1;
+      }
+
+      // Out of buffers - flush one packet the old way.
+      if (numBufs == 0)
+      {
+         return get1Msg(pSrc->pSocket, fwdTo, pSrc->isRtcp, ostc);
+      }
+
+      int numRead = recvmmsg(fd, msgs, numBufs, MSG_DONTWAIT, NULL);
+      if (numRead < 0)
+      {
+         if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+         {
+            return OS_SUCCESS;
+         }
+         OsSysLog::add(FAC_MP, PRI_DEBUG,
+                       "NetInReceiver::receiveAll recvmmsg returned %d from socket: %p descriptor: %d errno: %d",
+                       numRead, pSrc->pSocket, fd, errno);
+         return pSrc->pSocket->isOk() ? OS_SUCCESS : OS_NO_MORE_DATA;
+      }
+
+      for (int i = 0; i < numBufs; i++)
+      {
+         if (i < numRead && msgs[i].msg_len > 0)
+         {
+            bufs[i]->setPacketSize(msgs[i].msg_len);
+            bufs[i]->setIP(addrs[i].sin_addr);
+            bufs[i]->setUdpPort(ntohs(addrs[i].sin_port));
+            bufs[i]->setTimecode(ostc);
+            RTL_BLOCK("NetInTask.pushPacket");
+            fwdTo->pushPacket(bufs[i], pSrc->isRtcp);
+         }
+         bufs[i].release();
+      }
+
+      // Socket is drained.
+      if (numRead < numBufs)
+      {
+         break;
+      }
+   }
+
+   return OS_SUCCESS;
+}
+
+#endif /* NET_IN_TASK_USE_EPOLL ] */
+
 OsStatus NetInTask::destroy()
 {
    int wrote;
@@ -356,19 +848,32 @@ OsStatus NetInTask::destroy()
    requestShutdown();
 
    // Write message to socket to release sockets.
+   netInTaskMsg msg;
+   msg.pRtpSocket = (OsSocket*) -2;
+   msg.pRtcpSocket = (OsSocket*) -1;
+   msg.fwdTo = NULL;
+   msg.notify = NULL;
+
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+   // Every receive loop must get its own exit message.
+   wrote = NET_TASK_MAX_MSG_LEN;
+   for (int i = 0; i < mNumReceivers; i++)
    {
-      netInTaskMsg msg;
-      msg.pRtpSocket = (OsSocket*) -2;
-      msg.pRtcpSocket = (OsSocket*) -1;
-      msg.fwdTo = NULL;
-      msg.notify = NULL;
-
-      wrote = mpWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
+      int res = mpReceivers[i]->getWriteSocket()->write((char*)&msg,
+                                                        NET_TASK_MAX_MSG_LEN);
+      if (res != NET_TASK_MAX_MSG_LEN)
+      {
+         wrote = res;
+      }
+      mpReceivers[i]->closeWriteSocket();
    }
+#else /* NET_IN_TASK_USE_EPOLL ][ */
+   wrote = mpWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
 
    // Close write side of the command socket.
    mpWriteSocket->close();
    delete mpWriteSocket;
+#endif /* NET_IN_TASK_USE_EPOLL ] */
 
    getLockObj().releaseWrite();
 
@@ -379,6 +884,15 @@ OsStatus NetInTask::destroy()
 
 int NetInTask::run(void *pNotUsed)
 {
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+        // Start additional receive threads and serve the first shard
+        // in this task.
+        for (int i = 1; i < mNumReceivers; i++) {
+            mpReceivers[i]->startThread();
+        }
+        mpReceivers[0]->run();
+        return 0;
+#else /* NET_IN_TASK_USE_EPOLL ][ */
         fd_set fdset;
         fd_set *fds;
         int     last;
@@ -669,6 +1183,7 @@ int NetInTask::run(void *pNotUsed)
                 "NetInTask::run exiting mpReadSocket: %p mpReadSocket->isOk() = %s",
                 mpReadSocket, mpReadSocket ? (mpReadSocket->isOk() ? "true" : "false") : "N/A");
         return 0;
+#endif /* NET_IN_TASK_USE_EPOLL ] */
 }
 
 NetInTask* NetInTask::getNetInTask()
@@ -709,44 +1224,39 @@ NetInTask::NetInTask(int prio, int options, int stack)
 :  OsTask("NetInTask", NULL, prio, options, stack),
    mpWriteSocket(NULL),
    mpReadSocket(NULL),
-   mEventMutex(0)
+   mCmdPort(-1),
+   mEventMutex(0),
+   mNumReceivers(0),
+   mpReceivers(NULL)
 {
-    // Create temporary listening socket.
-    OsServerSocket *pBindSocket = new OsServerSocket(1, PORT_DEFAULT, "127.0.0.1");
-    RTL_EVENT("NetInTask::NetInTask", 1);
-    mCmdPort = pBindSocket->getLocalHostPort();
-    assert(-1 != mCmdPort);
-
-    // Start our helper thread to go open the socket
-    RTL_EVENT("NetInTask::NetInTask", 2);
-    NetInTaskHelper* pHelper = new NetInTaskHelper(mCmdPort);
-    if (!pHelper->isStarted()) {
-       RTL_EVENT("NetInTask::NetInTask", 3);
-       pHelper->start();
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+    mNumReceivers = sipx_max(1, sNumReceiveThreads);
+    mpReceivers = new NetInReceiver*[mNumReceivers];
+    for (int i = 0; i < mNumReceivers; i++)
+    {
+       mpReceivers[i] = new NetInReceiver(i, mNumReceivers);
     }
-
-    RTL_EVENT("NetInTask::NetInTask", 4);
-    mpReadSocket = pBindSocket->accept();
-    mpReadSocket->makeNonblocking();
-
-    RTL_EVENT("NetInTask::NetInTask", 5);
-    pBindSocket->close();
-
-    RTL_EVENT("NetInTask::NetInTask", 6);
-    delete pBindSocket;
-
-    // Create socket for write side of connection.
-    mpWriteSocket = pHelper->getSocket();
-    assert(mpWriteSocket != NULL && mpWriteSocket->isConnected());
-
-    RTL_EVENT("NetInTask::NetInTask", 7);
-    delete pHelper;
+    mCmdPort = mpReceivers[0]->getCmdPort();
+    OsSysLog::add(FAC_MP, PRI_INFO,
+                  "NetInTask::NetInTask using epoll with %d receive thread(s)",
+                  mNumReceivers);
+#else /* NET_IN_TASK_USE_EPOLL ][ */
+    mNumReceivers = 1;
+    mCmdPort = createCommandConnection(mpReadSocket, mpWriteSocket);
+#endif /* NET_IN_TASK_USE_EPOLL ] */
 }
 
 // Destructor
 NetInTask::~NetInTask()
 {
    waitUntilShutDown();
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+   for (int i = 0; i < mNumReceivers; i++)
+   {
+      delete mpReceivers[i];
+   }
+   delete[] mpReceivers;
+#endif /* NET_IN_TASK_USE_EPOLL ] */
    spInstance = NULL;
 }
 
@@ -766,15 +1276,16 @@ OsStatus NetInTask::addNetInputSources(OsSocket* pRtpSocket, OsSocket* pRtcpSock
       msg.fwdTo = fwdTo;
       msg.notify = notify;
 
+      OsConnectionSocket* pWriteSocket = getWriteSocket(fwdTo);
       getLockObj().acquireWrite();
-      wrote = mpWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
+      wrote = pWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
       getLockObj().releaseWrite();
 
       if (wrote != NET_TASK_MAX_MSG_LEN)
       {
          OsSysLog::add(FAC_MP, PRI_ERR,
                        "addNetInputSources - writeSocket error: %p,%d wrote %d",
-                       mpWriteSocket, mpWriteSocket->getSocketDescriptor(),
+                       pWriteSocket, pWriteSocket->getSocketDescriptor(),
                        wrote);
       }
    }
@@ -798,15 +1309,16 @@ OsStatus NetInTask::removeNetInputSources(MprFromNet* fwdTo, OsNotification* not
       msg.fwdTo = fwdTo;
       msg.notify = notify;
 
+      OsConnectionSocket* pWriteSocket = getWriteSocket(fwdTo);
       getLockObj().acquireWrite();
-      wrote = mpWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
+      wrote = pWriteSocket->write((char*)&msg, NET_TASK_MAX_MSG_LEN);
       getLockObj().releaseWrite();
 
       if (wrote != NET_TASK_MAX_MSG_LEN)
       {
          OsSysLog::add(FAC_MP, PRI_ERR,
                        "removeNetInputSources - writeSocket error: %p,%d wrote %d",
-                       mpWriteSocket, mpWriteSocket->getSocketDescriptor(),
+                       pWriteSocket, pWriteSocket->getSocketDescriptor(),
                        wrote);
       }
    }
@@ -820,6 +1332,65 @@ OsStatus NetInTask::removeNetInputSources(MprFromNet* fwdTo, OsNotification* not
    return ((NET_TASK_MAX_MSG_LEN == wrote) ? OS_SUCCESS : OS_BUSY);
 }
 
+void NetInTask::setNumReceiveThreads(int numThreads)
+{
+   sNumReceiveThreads = sipx_max(1, numThreads);
+}
+
+int NetInTask::getNumReceiveThreads() const
+{
+   return mNumReceivers;
+}
+
+OsConnectionSocket* NetInTask::getWriteSocket(MprFromNet* fwdTo)
+{
+#ifdef NET_IN_TASK_USE_EPOLL /* [ */
+   // Shard by resource, so both its sockets are served by the same thread
+   // and removal request goes to the thread which owns them.
+   int shard = (int)(((uintptr_t)fwdTo >> 4) % mNumReceivers);
+   return mpReceivers[shard]->getWriteSocket();
+#else /* NET_IN_TASK_USE_EPOLL ][ */
+   return mpWriteSocket;
+#endif /* NET_IN_TASK_USE_EPOLL ] */
+}
+
+int NetInTask::createCommandConnection(OsConnectionSocket*& rpReadSocket,
+                                       OsConnectionSocket*& rpWriteSocket)
+{
+    // Create temporary listening socket.
+    OsServerSocket *pBindSocket = new OsServerSocket(1, PORT_DEFAULT, "127.0.0.1");
+    RTL_EVENT("NetInTask::NetInTask", 1);
+    int cmdPort = pBindSocket->getLocalHostPort();
+    assert(-1 != cmdPort);
+
+    // Start our helper thread to go open the socket
+    RTL_EVENT("NetInTask::NetInTask", 2);
+    NetInTaskHelper* pHelper = new NetInTaskHelper(cmdPort);
+    if (!pHelper->isStarted()) {
+       RTL_EVENT("NetInTask::NetInTask", 3);
+       pHelper->start();
+    }
+
+    RTL_EVENT("NetInTask::NetInTask", 4);
+    rpReadSocket = pBindSocket->accept();
+    rpReadSocket->makeNonblocking();
+
+    RTL_EVENT("NetInTask::NetInTask", 5);
+    pBindSocket->close();
+
+    RTL_EVENT("NetInTask::NetInTask", 6);
+    delete pBindSocket;
+
+    // Create socket for write side of connection.
+    rpWriteSocket = pHelper->getSocket();
+    assert(rpWriteSocket != NULL && rpWriteSocket->isConnected());
+
+    RTL_EVENT("NetInTask::NetInTask", 7);
+    delete pHelper;
+
+    return cmdPort;
+}
+
 /************************************************************************/
 
 // return something random (32 bits)
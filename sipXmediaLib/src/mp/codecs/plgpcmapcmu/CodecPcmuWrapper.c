@@ -11,12 +11,6 @@
 
 // APPLICATION INCLUDES
 #include <mp/codecs/PlgDefsV1.h>
-#ifndef USE_BUGGY_G711 // [
-#  ifdef _MSC_VER // [
-#     define __inline__ __inline // For gcc compatibility
-#   endif // _MSC_VER ]
-#  include <spandsp/g711.h>
-#endif // !USE_BUGGY_G711 ]
 
 // EXTERNAL VARIABLES
 // CONSTANTS
@@ -25,6 +19,13 @@
 #ifdef USE_BUGGY_G711 // [
    extern int G711U_Decoder(int numSamples, const uint8_t* inBuff, MpAudioSample* outBuf);
    extern int G711U_Encoder(int numSamples, const MpAudioSample* inBuff, uint8_t* outBuf);
+#else // USE_BUGGY_G711 ][
+   // Table based SpanDSP G.711, see G711Tables.c
+   extern void G711_InitTables();
+   extern int G711U_TableDecoder(int numSamples, const uint8_t* inBuff, MpAudioSample* outBuf);
+   extern int G711U_TableEncoder(int numSamples, const MpAudioSample* inBuff, uint8_t* outBuf);
+#  define G711U_Decoder G711U_TableDecoder
+#  define G711U_Encoder G711U_TableEncoder
 #endif // USE_BUGGY_G711 ]
 
 // DEFINES
@@ -51,6 +52,7 @@ static const struct MppCodecInfoV1_1 sgCodecInfo =
 };
 
 DECLARE_FUNCS_V1(sipxPcmu)
+DECLARE_BATCH_FUNCS_V1(sipxPcmu)
 
 /* ============================== FUNCTIONS =============================== */
 
@@ -80,6 +82,10 @@ CODEC_API void *PLG_INIT_V1_2(sipxPcmu)(const char* fmtp, int isDecoder,
    pCodecInfo->vadCng = CODEC_CNG_NONE;
    pCodecInfo->algorithmicDelay = 0;
 
+#ifndef USE_BUGGY_G711 // [
+   G711_InitTables();
+#endif // !USE_BUGGY_G711 ]
+
    if (isDecoder)
       return DECODER_HANDLE;
    else
@@ -111,19 +117,7 @@ CODEC_API int PLG_DECODE_V1(sipxPcmu)(void* handle, const void* pCodedData,
       return RPLG_INVALID_ARGUMENT;
 
    samples = PLG_MIN(cbCodedPacketSize, cbBufferSize);
-#ifdef USE_BUGGY_G711 // [
    G711U_Decoder(samples, (uint8_t*)pCodedData, (MpAudioSample *)pAudioBuffer);
-#else // USE_BUGGY_G711 ][
-   {
-      int16_t *pSamples = (int16_t*)pAudioBuffer;
-      uint8_t *pEncoded = (uint8_t*)pCodedData;
-      int i;
-      for (i=0; i<samples; i++)
-      {
-         pSamples[i] = ulaw_to_linear(pEncoded[i]);
-      }
-   }
-#endif // USE_BUGGY_G711 ]
    *pcbCodedSize = samples;
 
    return RPLG_SUCCESS;
@@ -138,19 +132,7 @@ CODEC_API int PLG_ENCODE_V1(sipxPcmu)(void* handle, const void* pAudioBuffer,
    if (handle != ENCODER_HANDLE)
       return RPLG_INVALID_ARGUMENT;
 
-#ifdef USE_BUGGY_G711 // [
    G711U_Encoder(cbAudioSamples, (MpAudioSample *)pAudioBuffer, (uint8_t*)pCodedData);
-#else // USE_BUGGY_G711 ][
-   {
-      int16_t *pSamples = (int16_t*)pAudioBuffer;
-      uint8_t *pEncoded = (uint8_t*)pCodedData;
-      unsigned i;
-      for (i=0; i<cbAudioSamples; i++)
-      {
-         pEncoded[i] = linear_to_ulaw(pSamples[i]);
-      }
-   }
-#endif // USE_BUGGY_G711 ]
    *pcbCodedSize = cbAudioSamples;
 
    *pbSendNow = FALSE;
@@ -158,3 +140,58 @@ CODEC_API int PLG_ENCODE_V1(sipxPcmu)(void* handle, const void* pAudioBuffer,
 
    return RPLG_SUCCESS;
 }
+
+CODEC_API int PLG_DECODE_BATCH_V1(sipxPcmu)(void* handle, unsigned numBuffers,
+                                            const void* const pCodedData[],
+                                            unsigned cbCodedPacketSize,
+                                            void* const pAudioBuffers[],
+                                            unsigned cbBufferSize,
+                                            unsigned *pcbDecodedSize)
+{
+   unsigned i;
+
+   if (handle != DECODER_HANDLE)
+      return RPLG_INVALID_ARGUMENT;
+
+   // Assert that available buffer size is enough for the packets.
+   if (cbCodedPacketSize > cbBufferSize || cbBufferSize == 0)
+   {
+      return RPLG_INVALID_ARGUMENT;
+   }
+
+   for (i=0; i<numBuffers; i++)
+   {
+      G711U_Decoder(cbCodedPacketSize, (uint8_t*)pCodedData[i],
+                    (MpAudioSample *)pAudioBuffers[i]);
+   }
+   *pcbDecodedSize = cbCodedPacketSize;
+
+   return RPLG_SUCCESS;
+}
+
+CODEC_API int PLG_ENCODE_BATCH_V1(sipxPcmu)(void* handle, unsigned numBuffers,
+                                            const void* const pAudioBuffers[],
+                                            unsigned cbAudioSamples,
+                                            void* const pCodedData[],
+                                            unsigned cbMaxCodedData,
+                                            int* pcbCodedSize)
+{
+   unsigned i;
+
+   if (handle != ENCODER_HANDLE)
+      return RPLG_INVALID_ARGUMENT;
+
+   if (cbAudioSamples > cbMaxCodedData)
+   {
+      return RPLG_INVALID_ARGUMENT;
+   }
+
+   for (i=0; i<numBuffers; i++)
+   {
+      G711U_Encoder(cbAudioSamples, (MpAudioSample *)pAudioBuffers[i],
+                    (uint8_t*)pCodedData[i]);
+   }
+   *pcbCodedSize = cbAudioSamples;
+
+   return RPLG_SUCCESS;
+}
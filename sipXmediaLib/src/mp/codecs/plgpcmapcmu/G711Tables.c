@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef USE_BUGGY_G711 // [
+
+// SYSTEM INCLUDES
+#ifdef _MSC_VER // [
+#  include <windows.h>
+#else // _MSC_VER ][
+#  include <sched.h>
+#endif // _MSC_VER ]
+
+// APPLICATION INCLUDES
+#include <mp/codecs/PlgDefsV1.h>
+#ifdef _MSC_VER // [
+#  define __inline__ __inline // For gcc compatibility
+#endif // _MSC_VER ]
+#include <spandsp/g711.h>
+
+// DEFINES
+/// Number of u-law encoder table entries: 13 bits of magnitude and a sign.
+#define ULAW_ENCODE_TABLE_SIZE   (1 << 14)
+/// Number of A-law encoder table entries: the 12 upper bits of a sample.
+#define ALAW_ENCODE_TABLE_SIZE   (1 << 12)
+
+/// Tables are not filled yet.
+#define TABLES_EMPTY     0
+/// One thread fills the tables, others wait for it.
+#define TABLES_FILLING   1
+/// Tables are filled and could be used.
+#define TABLES_READY     2
+
+// MACROS
+#ifdef _MSC_VER // [
+/// Set *p to n if it is o, return the old value. Full memory barrier.
+#  define TABLES_CAS(p, o, n)  InterlockedCompareExchange((p), (n), (o))
+#  define TABLES_YIELD()       Sleep(0)
+#else // _MSC_VER ][
+#  define TABLES_CAS(p, o, n)  __sync_val_compare_and_swap((p), (o), (n))
+#  define TABLES_YIELD()       sched_yield()
+#endif // _MSC_VER ]
+
+/**
+*  u-law encoder table index of a sample.
+*
+*  The u-law bias (0x84) is a multiple of 4 and the encoder never looks at
+*  the two lowest bits of the biased magnitude, so samples with the same
+*  sign and the same magnitude/4 have the same code. -32768 is clipped
+*  to the largest magnitude, as the encoder does.
+*/
+#define ULAW_ENCODE_INDEX(s) \
+   ((s) >= 0 ? ((s) >> 2) : (0x2000 | PLG_MIN((-(s)) >> 2, 0x1FFF)))
+
+/**
+*  A-law encoder table index of a sample.
+*
+*  The A-law encoder never looks at the four lowest bits of a sample (or of
+*  its one's complement for negative samples), so the upper 12 bits of the
+*  sample select its code.
+*/
+#define ALAW_ENCODE_INDEX(s)   (((uint16_t)(s)) >> 4)
+
+// STATIC VARIABLE INITIALIZATIONS
+static volatile long sTablesState = TABLES_EMPTY;
+static uint8_t sUlawEncodeTable[ULAW_ENCODE_TABLE_SIZE];
+static uint8_t sAlawEncodeTable[ALAW_ENCODE_TABLE_SIZE];
+static int16_t sUlawDecodeTable[256];
+static int16_t sAlawDecodeTable[256];
+
+/* ============================== FUNCTIONS =============================== */
+
+/**
+*  Fill the encoder and decoder tables from the SpanDSP G.711 functions.
+*
+*  Called from the codecs' init function. Every sample value is encoded
+*  into the entry of its index, so the tables give exactly the same codes
+*  as SpanDSP does.
+*
+*  Codecs are initialized from several media threads, so the first caller
+*  fills the tables and the others wait until it is done. Compare-and-swap
+*  is a full barrier, so the filled tables are seen once the state is
+*  TABLES_READY.
+*/
+void G711_InitTables()
+{
+   int i;
+
+   if (TABLES_CAS(&sTablesState, TABLES_READY, TABLES_READY) == TABLES_READY)
+   {
+      return;
+   }
+   if (TABLES_CAS(&sTablesState, TABLES_EMPTY, TABLES_FILLING) != TABLES_EMPTY)
+   {
+      // Another thread fills the tables, it takes well under a millisecond.
+      while (TABLES_CAS(&sTablesState, TABLES_READY, TABLES_READY) != TABLES_READY)
+      {
+         TABLES_YIELD();
+      }
+      return;
+   }
+
+   for (i = -32768; i <= 32767; i++)
+   {
+      sUlawEncodeTable[ULAW_ENCODE_INDEX(i)] = linear_to_ulaw(i);
+      sAlawEncodeTable[ALAW_ENCODE_INDEX(i)] = linear_to_alaw(i);
+   }
+   for (i = 0; i < 256; i++)
+   {
+      sUlawDecodeTable[i] = ulaw_to_linear((uint8_t)i);
+      sAlawDecodeTable[i] = alaw_to_linear((uint8_t)i);
+   }
+
+   TABLES_CAS(&sTablesState, TABLES_FILLING, TABLES_READY);
+}
+
+int G711U_TableDecoder(int numSamples, const uint8_t* inBuff, MpAudioSample* outBuf)
+{
+   int i;
+   for (i = 0; i < numSamples; i++)
+   {
+      outBuf[i] = sUlawDecodeTable[inBuff[i]];
+   }
+   return numSamples;
+}
+
+int G711U_TableEncoder(int numSamples, const MpAudioSample* inBuff, uint8_t* outBuf)
+{
+   int i;
+   for (i = 0; i < numSamples; i++)
+   {
+      int s = inBuff[i];
+      outBuf[i] = sUlawEncodeTable[ULAW_ENCODE_INDEX(s)];
+   }
+   return numSamples;
+}
+
+int G711A_TableDecoder(int numSamples, const uint8_t* inBuff, MpAudioSample* outBuf)
+{
+   int i;
+   for (i = 0; i < numSamples; i++)
+   {
+      outBuf[i] = sAlawDecodeTable[inBuff[i]];
+   }
+   return numSamples;
+}
+
+int G711A_TableEncoder(int numSamples, const MpAudioSample* inBuff, uint8_t* outBuf)
+{
+   int i;
+   for (i = 0; i < numSamples; i++)
+   {
+      outBuf[i] = sAlawEncodeTable[ALAW_ENCODE_INDEX(inBuff[i])];
+   }
+   return numSamples;
+}
+
+#endif // !USE_BUGGY_G711 ]
@@ -17,14 +17,18 @@
 #include <mp/codecs/PlgDefsV1.h>
 
 DECLARE_FUNCS_V1(sipxPcmu);
+DECLARE_BATCH_FUNCS_V1(sipxPcmu);
 DECLARE_FUNCS_V1(sipxPcma);
+DECLARE_BATCH_FUNCS_V1(sipxPcma);
 
 PLG_ENUM_CODEC_START(sipXpcmapcmu)
   PLG_ENUM_CODEC(sipxPcmu)
   PLG_ENUM_CODEC_NO_SPECIAL_PACKING(sipxPcmu)
   PLG_ENUM_CODEC_NO_SIGNALING(sipxPcmu)
+  PLG_ENUM_CODEC_BATCH(sipxPcmu)
 
   PLG_ENUM_CODEC(sipxPcma)
   PLG_ENUM_CODEC_NO_SPECIAL_PACKING(sipxPcma)
   PLG_ENUM_CODEC_NO_SIGNALING(sipxPcma)
+  PLG_ENUM_CODEC_BATCH(sipxPcma)
 PLG_ENUM_CODEC_END 
@@ -104,6 +104,10 @@ SOURCE=.\G711.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\G711Tables.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\PlgPcmaPcmu.c
 # End Source File
 # End Group
@@ -12,11 +12,99 @@
 
 #include <sipxunittests.h>
 
+#include <os/OsAtomics.h>
+#include <os/OsTask.h>
 #include <mp/MpBuf.h>
 #include <mp/MpArrayBuf.h>
 #include <mp/MpDataBuf.h>
 #include <mp/MpAudioBuf.h>
 
+#define STRESS_TASKS       8
+#define STRESS_HELD        4
+#define STRESS_ITERATIONS  20000
+
+/// Task taking buffers from a pool and giving them back in a loop.
+class MpBufPoolStressTask : public OsTask
+{
+public:
+   MpBufPoolStressTask(MpBufPool* pPool, OsAtomicInt* pOwners, int taskId,
+                       const MpBufPtr& shared)
+   : mpPool(pPool)
+   , mpOwners(pOwners)
+   , mTaskId(taskId)
+   , mShared(shared)
+   , mNumFailed(0)
+   {
+   }
+
+   ~MpBufPoolStressTask()
+   {
+      waitUntilShutDown();
+   }
+
+   int run(void* pArg)
+   {
+      MpArrayBufPtr held[STRESS_HELD];
+      for (int iter = 0; iter < STRESS_ITERATIONS; iter++)
+      {
+         int num = 1 + iter % STRESS_HELD;
+         int i;
+         for (i = 0; i < num; i++)
+         {
+            held[i] = mpPool->getBuffer();
+            if (!held[i].isValid())
+            {
+               mNumFailed++;
+               continue;
+            }
+            // No other task may own this buffer now.
+            int owner = 0;
+            if (!mpOwners[held[i].getBufferNumber()].compare_exchange(owner, mTaskId))
+            {
+               mNumFailed++;
+            }
+            *(int*)held[i]->getDataWritePtr() = mTaskId;
+         }
+
+         // Take and drop references to a buffer all tasks share.
+         MpBufPtr ref1 = mShared;
+         MpBufPtr ref2 = ref1;
+         ref1.release();
+
+         for (i = 0; i < num; i++)
+         {
+            if (!held[i].isValid())
+            {
+               continue;
+            }
+            int owner = mTaskId;
+            if (*(int*)held[i]->getDataWritePtr() != mTaskId ||
+                !mpOwners[held[i].getBufferNumber()].compare_exchange(owner, 0))
+            {
+               mNumFailed++;
+            }
+            held[i].release();
+         }
+      }
+      mShared.release();
+      return 0;
+   }
+
+   UtlBoolean waitUntilShutDown()
+   {
+      return OsTask::waitUntilShutDown();
+   }
+
+   int getNumFailed() const { return mNumFailed; }
+
+protected:
+   MpBufPool* mpPool;
+   OsAtomicInt* mpOwners;
+   int mTaskId;
+   MpBufPtr mShared;
+   int mNumFailed;
+};
+
 /**
  * Unittest for MpBuf and its successors
  */
@@ -24,6 +112,8 @@ class MpBufTest : public SIPX_UNIT_BASE_CLASS
 {
    CPPUNIT_TEST_SUITE(MpBufTest);
    CPPUNIT_TEST(testCreators);
+   CPPUNIT_TEST(testPoolGrowth);
+   CPPUNIT_TEST(testPoolConcurrency);
    CPPUNIT_TEST(testAudioBuffersWriteData);
    CPPUNIT_TEST(testDataBuffersExchangeData);
    CPPUNIT_TEST(testDataBuffersAssignment);
@@ -85,6 +175,116 @@ public:
       CPPUNIT_ASSERT(!p6.isValid());
    }
 
+   void testPoolGrowth()
+   {
+      // Pool, which can grow up to 3 times of its initial size.
+      MpBufPool pool(BUFFER_SIZE, BUFFER_NUM, "MpBufTestGrowing", 3*BUFFER_NUM);
+      CPPUNIT_ASSERT_EQUAL(BUFFER_NUM, (int)pool.getNumBlocks());
+      CPPUNIT_ASSERT_EQUAL(3*BUFFER_NUM, (int)pool.getMaxBlocks());
+      CPPUNIT_ASSERT_EQUAL(BUFFER_NUM, pool.getFreeBufferCount());
+
+      MpBufPtr bufs[3*BUFFER_NUM];
+      int i;
+      for (i=0; i<3*BUFFER_NUM; i++)
+      {
+         bufs[i] = pool.getBuffer();
+         CPPUNIT_ASSERT(bufs[i].isValid());
+      }
+      CPPUNIT_ASSERT_EQUAL(3*BUFFER_NUM, (int)pool.getNumBlocks());
+      CPPUNIT_ASSERT_EQUAL(2, (int)pool.getNumGrows());
+      CPPUNIT_ASSERT_EQUAL(0, pool.getFreeBufferCount());
+
+      // Every buffer must have a unique number.
+      for (i=0; i<3*BUFFER_NUM; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(i, bufs[i].getBufferNumber());
+      }
+
+      // Pool must not grow above its maximum.
+      MpBufPtr extra = pool.getBuffer();
+      CPPUNIT_ASSERT(!extra.isValid());
+
+      // Released buffers from all chunks must be reused, but pool must
+      // not shrink.
+      for (i=0; i<3*BUFFER_NUM; i++)
+      {
+         bufs[i].release();
+      }
+      CPPUNIT_ASSERT_EQUAL(3*BUFFER_NUM, pool.getFreeBufferCount());
+      CPPUNIT_ASSERT_EQUAL(3*BUFFER_NUM, (int)pool.getNumBlocks());
+      CPPUNIT_ASSERT_EQUAL(0, pool.scanBufPool(NULL));
+
+      for (i=0; i<3*BUFFER_NUM; i++)
+      {
+         bufs[i] = pool.getBuffer();
+         CPPUNIT_ASSERT(bufs[i].isValid());
+      }
+      CPPUNIT_ASSERT_EQUAL(2, (int)pool.getNumGrows());
+   }
+
+   void testPoolConcurrency()
+   {
+      // Start small, so the pool grows while tasks hammer it. Tasks hold
+      // STRESS_HELD buffers at most, plus one buffer shared by all of them,
+      // so they must never find the pool empty.
+      int maxBlocks = STRESS_TASKS*STRESS_HELD + 1;
+      MpBufPool pool(BUFFER_SIZE, STRESS_TASKS, "MpBufTestStress", maxBlocks);
+      maxBlocks = pool.getMaxBlocks();
+      OsAtomicInt* pOwners = new OsAtomicInt[maxBlocks];
+      int i;
+      for (i = 0; i < maxBlocks; i++)
+      {
+         pOwners[i] = 0;
+      }
+
+      MpBufPtr shared = pool.getBuffer();
+      CPPUNIT_ASSERT(shared.isValid());
+      MpBufPoolStressTask* tasks[STRESS_TASKS];
+      for (i = 0; i < STRESS_TASKS; i++)
+      {
+         tasks[i] = new MpBufPoolStressTask(&pool, pOwners, i+1, shared);
+      }
+      for (i = 0; i < STRESS_TASKS; i++)
+      {
+         CPPUNIT_ASSERT(tasks[i]->start());
+      }
+      for (i = 0; i < STRESS_TASKS; i++)
+      {
+         tasks[i]->waitUntilShutDown();
+         CPPUNIT_ASSERT_EQUAL(0, tasks[i]->getNumFailed());
+         delete tasks[i];
+      }
+      delete[] pOwners;
+
+      // Tasks have dropped their references, so the shared buffer is ours.
+      CPPUNIT_ASSERT(shared.isWritable());
+      shared.release();
+
+      // No buffer is lost or linked twice: the free list holds every block
+      // exactly once.
+      int numBlocks = pool.getNumBlocks();
+      CPPUNIT_ASSERT_EQUAL(numBlocks, pool.getFreeBufferCount());
+      CPPUNIT_ASSERT_EQUAL(0, pool.scanBufPool(NULL));
+      MpBufPtr* pAll = new MpBufPtr[maxBlocks];
+      int* pTaken = new int[maxBlocks];
+      for (i = 0; i < maxBlocks; i++)
+      {
+         pTaken[i] = 0;
+      }
+      for (i = 0; i < numBlocks; i++)
+      {
+         pAll[i] = pool.getBuffer();
+         CPPUNIT_ASSERT(pAll[i].isValid());
+         int number = pAll[i].getBufferNumber();
+         CPPUNIT_ASSERT(number >= 0 && number < numBlocks);
+         CPPUNIT_ASSERT_EQUAL(0, pTaken[number]++);
+      }
+      CPPUNIT_ASSERT_EQUAL(numBlocks, (int)pool.getNumBlocks());
+      CPPUNIT_ASSERT_EQUAL(0, pool.getFreeBufferCount());
+      delete[] pAll;
+      delete[] pTaken;
+   }
+
    void testAudioBuffersWriteData()
    {
       // Allocate two audio buffers and write data to them.
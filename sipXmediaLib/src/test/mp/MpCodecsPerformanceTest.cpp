@@ -17,6 +17,12 @@
 
 #include <sipxunittests.h>
 
+// Reference G.711 implementation
+#ifdef _MSC_VER // [
+#  define __inline__ __inline // For gcc compatibility
+#endif // _MSC_VER ]
+#include <spandsp/g711.h>
+
 // Setup codec paths..
 #include <../test/mp/MpTestCodecPaths.h>
 
@@ -30,24 +36,30 @@
 #define NUM_PACKETS_TO_TEST      3
 /// Maximum number of milliseconds in packet.
 #define MAX_PACKET_TIME          20
+/// Number of frames to encode/decode when measuring frames per second.
+#define NUM_FRAMES_TO_TIME       10000
+/// Number of channels to encode/decode at once with batch capable codecs.
+#define NUM_BATCH_CHANNELS       50
 
 ///  Unit test for testing performance of supported codecs.
 class MpCodecsPerformanceTest : public SIPX_UNIT_BASE_CLASS
 {
    CPPUNIT_TEST_SUITE(MpCodecsPerformanceTest);
    CPPUNIT_TEST(testCodecsPreformance);
+   CPPUNIT_TEST(testG711BitExact);
    CPPUNIT_TEST_SUITE_END();
 
 public:
 
    void setUp()
    {
-      // Create pool for data buffers
-      mpPool = new MpBufPool(ENCODED_FRAME_MAX_SIZE + MpArrayBuf::getHeaderSize(), 1, "MpCodecsPerformanceTest");
+      // Create pool for data buffers. Last packet is kept for throughput
+      // test while the next one is coded, so we need two buffers.
+      mpPool = new MpBufPool(ENCODED_FRAME_MAX_SIZE + MpArrayBuf::getHeaderSize(), 2, "MpCodecsPerformanceTest");
       CPPUNIT_ASSERT(mpPool != NULL);
 
       // Create pool for buffer headers
-      mpHeadersPool = new MpBufPool(sizeof(MpRtpBuf), 1, "MpCodecsPerformanceTestHeaders");
+      mpHeadersPool = new MpBufPool(sizeof(MpRtpBuf), 2, "MpCodecsPerformanceTestHeaders");
       CPPUNIT_ASSERT(mpHeadersPool != NULL);
 
       // Set mpHeadersPool as default pool for audio and data pools.
@@ -72,18 +84,7 @@ public:
       const MppCodecInfoV1_1 **pCodecInfo;
       unsigned         codecInfoNum;
 
-      // Get/create codec factory
-      pCodecFactory = MpCodecFactory::getMpCodecFactory();
-      CPPUNIT_ASSERT(pCodecFactory != NULL);
-
-      // Load all available codecs
-      size_t i;
-      for(i = 0; i < sNumCodecPaths; i++)
-      {
-         printf("MpCodecsPerformanceTest loading codecs from: %s\n", sCodecPaths[i].data());
-         pCodecFactory->loadAllDynCodecs(sCodecPaths[i],
-                                         CODEC_PLUGINS_FILTER);
-      }
+      pCodecFactory = loadCodecs();
 
       printf("mediaFrame size: %d mSec\n", FRAME_MS);
 
@@ -127,10 +128,233 @@ public:
       MpCodecFactory::freeSingletonHandle();
    }
 
+   void testG711BitExact()
+   {
+      MpCodecFactory *pCodecFactory = loadCodecs();
+
+      checkG711BitExact(pCodecFactory, "PCMU", linear_to_ulaw, ulaw_to_linear);
+      checkG711BitExact(pCodecFactory, "PCMA", linear_to_alaw, alaw_to_linear);
+
+      // Free codec factory
+      MpCodecFactory::freeSingletonHandle();
+   }
+
 protected:
    MpBufPool *mpPool;         ///< Pool for data buffers
    MpBufPool *mpHeadersPool;  ///< Pool for buffers headers
 
+   MpCodecFactory *loadCodecs()
+   {
+      // Get/create codec factory
+      MpCodecFactory *pCodecFactory = MpCodecFactory::getMpCodecFactory();
+      CPPUNIT_ASSERT(pCodecFactory != NULL);
+
+      // Load all available codecs
+      size_t i;
+      for(i = 0; i < sNumCodecPaths; i++)
+      {
+         printf("MpCodecsPerformanceTest loading codecs from: %s\n", sCodecPaths[i].data());
+         pCodecFactory->loadAllDynCodecs(sCodecPaths[i],
+                                         CODEC_PLUGINS_FILTER);
+      }
+      return pCodecFactory;
+   }
+
+   static double toSeconds(const OsTime &time)
+   {
+      return time.seconds() + time.usecs()/1000000.0;
+   }
+
+     /// Compare G.711 codec with SpanDSP for every sample and every code.
+   void checkG711BitExact(MpCodecFactory *pCodecFactory,
+                          const UtlString &codecMime,
+                          uint8_t (*linearToCode)(int),
+                          int16_t (*codeToLinear)(uint8_t))
+   {
+      MpDecoderBase *pDecoder;
+      MpEncoderBase *pEncoder;
+      const int frameSize = 160;
+      MpAudioSample samples[frameSize];
+      unsigned char encoded[frameSize];
+      unsigned char batchEncoded[frameSize];
+      MpAudioSample decoded[256];
+      MpAudioSample batchDecoded[256];
+      uint8_t codes[256];
+      int i;
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pCodecFactory->createEncoder(codecMime, "", 8000, 1,
+                                                        0, pEncoder));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pEncoder->initEncode());
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pCodecFactory->createDecoder(codecMime, "", 8000, 1,
+                                                        0, pDecoder));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pDecoder->initDecode());
+      CPPUNIT_ASSERT(pEncoder->supportsBatch());
+      CPPUNIT_ASSERT(pDecoder->supportsBatch());
+
+      // Encode every 16 bit sample value
+      for (int first = -32768; first < 32768; first += frameSize)
+      {
+         int tmpSamplesConsumed;
+         int tmpEncodedSize;
+         int batchEncodedSize;
+         UtlBoolean tmpIsPacketReady;
+         UtlBoolean tmpIsPacketSilent;
+         UtlBoolean setMarkerBit;
+         const MpAudioSample *pFrame = samples;
+         unsigned char *pBatchEncoded = batchEncoded;
+
+         for (i = 0; i < frameSize; i++)
+         {
+            samples[i] = (MpAudioSample)(first + i);
+         }
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pEncoder->encode(samples, frameSize,
+                                               tmpSamplesConsumed, encoded,
+                                               frameSize, tmpEncodedSize,
+                                               tmpIsPacketReady,
+                                               tmpIsPacketSilent,
+                                               setMarkerBit));
+         CPPUNIT_ASSERT_EQUAL(frameSize, tmpEncodedSize);
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pEncoder->encodeBatch(1, &pFrame, frameSize,
+                                                    &pBatchEncoded, frameSize,
+                                                    batchEncodedSize));
+         CPPUNIT_ASSERT_EQUAL(frameSize, batchEncodedSize);
+         for (i = 0; i < frameSize; i++)
+         {
+            CPPUNIT_ASSERT_EQUAL((int)linearToCode(samples[i]), (int)encoded[i]);
+            CPPUNIT_ASSERT_EQUAL((int)encoded[i], (int)batchEncoded[i]);
+         }
+      }
+
+      // Decode every code
+      MpRtpBufPtr pRtpPacket = mpPool->getBuffer();
+      for (i = 0; i < 256; i++)
+      {
+         codes[i] = (uint8_t)i;
+      }
+      memcpy(pRtpPacket->getDataWritePtr(), codes, 256);
+      pRtpPacket->setPayloadSize(256);
+      CPPUNIT_ASSERT_EQUAL(256, pDecoder->decode(pRtpPacket, 256, decoded));
+      const uint8_t *pCodes = codes;
+      MpAudioSample *pBatchDecoded = batchDecoded;
+      CPPUNIT_ASSERT_EQUAL(256, pDecoder->decodeBatch(1, &pCodes, 256, 256,
+                                                      &pBatchDecoded));
+      for (i = 0; i < 256; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL((int)codeToLinear(codes[i]), (int)decoded[i]);
+         CPPUNIT_ASSERT_EQUAL((int)decoded[i], (int)batchDecoded[i]);
+      }
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pDecoder->freeDecode());
+      delete pDecoder;
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pEncoder->freeEncode());
+      delete pEncoder;
+   }
+
+     /// Measure and print how many frames per second a codec encodes and decodes.
+   void testOneCodecThroughput(MpEncoderBase *pEncoder,
+                               MpDecoderBase *pDecoder,
+                               const MpAudioSample *pOriginal,
+                               int frameSize,
+                               const MpRtpBufPtr &pRtpPacket,
+                               const char *codecName)
+   {
+      unsigned char  encoded[ENCODED_FRAME_MAX_SIZE];
+      MpAudioSample  decoded[DECODED_FRAME_MAX_SIZE];
+      OsTime         start;
+      OsTime         stop;
+      double         seconds;
+      int            decodedSamples = 0;
+      int            i;
+
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < NUM_FRAMES_TO_TIME; i++)
+      {
+         int        tmpSamplesConsumed;
+         int        tmpEncodedSize;
+         UtlBoolean tmpIsPacketReady;
+         UtlBoolean tmpIsPacketSilent;
+         UtlBoolean setMarkerBit;
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pEncoder->encode(pOriginal, frameSize,
+                                               tmpSamplesConsumed, encoded,
+                                               ENCODED_FRAME_MAX_SIZE,
+                                               tmpEncodedSize, tmpIsPacketReady,
+                                               tmpIsPacketSilent, setMarkerBit));
+      }
+      OsDateTime::getCurTime(stop);
+      seconds = toSeconds(stop - start);
+      printf("encode-rate %s;%f frames/sec\n", codecName,
+             seconds > 0 ? NUM_FRAMES_TO_TIME/seconds : 0.0);
+
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < NUM_FRAMES_TO_TIME; i++)
+      {
+         decodedSamples += pDecoder->decode(pRtpPacket, DECODED_FRAME_MAX_SIZE,
+                                            decoded);
+      }
+      OsDateTime::getCurTime(stop);
+      seconds = toSeconds(stop - start);
+      printf("decode-rate %s;%f frames/sec\n", codecName,
+             seconds > 0 ? decodedSamples/frameSize/seconds : 0.0);
+
+      if (!pEncoder->supportsBatch() || !pDecoder->supportsBatch())
+      {
+         return;
+      }
+
+      // Encode and decode frames of many channels with one call.
+      unsigned char *pBatchEncoded = new unsigned char[NUM_BATCH_CHANNELS*ENCODED_FRAME_MAX_SIZE];
+      MpAudioSample *pBatchDecoded = new MpAudioSample[NUM_BATCH_CHANNELS*frameSize];
+      const MpAudioSample *pAudioFrames[NUM_BATCH_CHANNELS];
+      unsigned char *pCodeBufs[NUM_BATCH_CHANNELS];
+      const uint8_t *pPayloads[NUM_BATCH_CHANNELS];
+      MpAudioSample *pSamplesBuffers[NUM_BATCH_CHANNELS];
+      int encodedSize = 0;
+      for (i = 0; i < NUM_BATCH_CHANNELS; i++)
+      {
+         pAudioFrames[i] = pOriginal;
+         pCodeBufs[i] = pBatchEncoded + i*ENCODED_FRAME_MAX_SIZE;
+         pPayloads[i] = pCodeBufs[i];
+         pSamplesBuffers[i] = pBatchDecoded + i*frameSize;
+      }
+
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < NUM_FRAMES_TO_TIME/NUM_BATCH_CHANNELS; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pEncoder->encodeBatch(NUM_BATCH_CHANNELS,
+                                                    pAudioFrames, frameSize,
+                                                    pCodeBufs,
+                                                    ENCODED_FRAME_MAX_SIZE,
+                                                    encodedSize));
+      }
+      OsDateTime::getCurTime(stop);
+      seconds = toSeconds(stop - start);
+      printf("encode-batch-rate %s;%f frames/sec\n", codecName,
+             seconds > 0 ? NUM_FRAMES_TO_TIME/seconds : 0.0);
+
+      decodedSamples = 0;
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < NUM_FRAMES_TO_TIME/NUM_BATCH_CHANNELS; i++)
+      {
+         decodedSamples += NUM_BATCH_CHANNELS *
+            pDecoder->decodeBatch(NUM_BATCH_CHANNELS, pPayloads, encodedSize,
+                                  frameSize, pSamplesBuffers);
+      }
+      OsDateTime::getCurTime(stop);
+      seconds = toSeconds(stop - start);
+      printf("decode-batch-rate %s;%f frames/sec\n", codecName,
+             seconds > 0 ? decodedSamples/frameSize/seconds : 0.0);
+      CPPUNIT_ASSERT_EQUAL(NUM_FRAMES_TO_TIME*frameSize, decodedSamples);
+
+      delete[] pBatchEncoded;
+      delete[] pBatchDecoded;
+   }
+
    void testOneCodecPreformance(MpCodecFactory *pCodecFactory,
                                 const UtlString &codecMime,
                                 const UtlString &codecFmtp,
@@ -209,6 +433,7 @@ protected:
 
       unsigned char* rtpDataStart = NULL;
       int algorithmicDelaySamplesCount = 0;
+      MpRtpBufPtr pLastRtpPacket;
 
       for (int i=0; i<NUM_PACKETS_TO_TEST; i++)
       {
@@ -356,8 +581,16 @@ protected:
                 i,
                 start.seconds(), start.usecs(),
                 diff.seconds(), diff.usecs());
+
+         pLastRtpPacket = pRtpPacket;
       }
 
+      UtlString codecName;
+      codecName.appendFormat("%s/%d/%d %s", codecMime.data(), sampleRate,
+                             numChannels, codecFmtp.data());
+      testOneCodecThroughput(pEncoder, pDecoder, pOriginal, frameSize,
+                             pLastRtpPacket, codecName.data());
+
       printf("algorithmic-delay %s/%d/%d %s;%d;%f\n",
              codecMime.data(), sampleRate, numChannels, codecFmtp.data(),
              algorithmicDelaySamplesCount, 
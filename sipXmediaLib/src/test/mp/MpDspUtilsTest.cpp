@@ -10,6 +10,7 @@
 
 #include <sipxunittests.h>
 
+#include <os/OsDateTime.h>
 #include <mp/MpDspUtils.h>
 
 /**
@@ -42,6 +43,9 @@ class MpDspUtilsTest : public SIPX_UNIT_BASE_CLASS
    CPPUNIT_TEST(testConvert_int32_int16);
    CPPUNIT_TEST(testConvert_Gain_int32_int16);
    CPPUNIT_TEST(testConvert_Att_int32_int16);
+   CPPUNIT_TEST(testSimdVersions);
+   CPPUNIT_TEST(testSimdCountClippedLong);
+   CPPUNIT_TEST(testSimdPerformance);
 #else  // MP_FIXED_POINT ][
    CPPUNIT_TEST(testConvert_float_int16);
 #endif // MP_FIXED_POINT ]
@@ -323,6 +327,136 @@ public:
 //      printf("};\n");
    }
 
+   void testSimdVersions()
+   {
+      const MpDspSimdLevel savedLevel = MpDspUtils::getSimdLevel();
+      const int lengths[] = {16, 17, 23, 31, 64, 80, 127, 160, 333};
+      const unsigned scales[] = {0, 1, 7, 15, 16, 20};
+      SimdWorkspace *pRef = new SimdWorkspace;
+      SimdWorkspace *pRes = new SimdWorkspace;
+
+      srand(1234);
+      for (int level = MP_DSP_SIMD_NONE+1; level < MP_DSP_SIMD_LEVELS_NUM; level++)
+      {
+         if (!MpDspUtils::isSimdLevelSupported((MpDspSimdLevel)level))
+         {
+            continue;
+         }
+
+         for (unsigned l = 0; l < sizeof(lengths)/sizeof(lengths[0]); l++)
+         {
+            const int len = lengths[l];
+            for (int round = 0; round < 10; round++)
+            {
+               fillSimdWorkspace(*pRef, FALSE);
+               int16_t val = (int16_t)rand();
+               val = (val == 0) ? 1 : val;
+               const int16_t valEnd = (int16_t)rand();
+               const unsigned scale = scales[round % (sizeof(scales)/sizeof(scales[0]))];
+
+               for (int kernel = 0; kernel < SIMD_KERNELS_NUM; kernel++)
+               {
+                  UtlString msg;
+                  msg.appendFormat("%s with %s, length: %d, scale: %u, val: %d, valEnd: %d",
+                                   sSimdKernelNames[kernel],
+                                   MpDspUtils::getSimdLevelName((MpDspSimdLevel)level),
+                                   len, scale, val, valEnd);
+
+                  memcpy(pRes, pRef, sizeof(SimdWorkspace));
+                  CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, MpDspUtils::setSimdLevel(MP_DSP_SIMD_NONE));
+                  runSimdKernel(kernel, *pRef, len, scale, val, valEnd);
+                  CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, MpDspUtils::setSimdLevel((MpDspSimdLevel)level));
+                  runSimdKernel(kernel, *pRes, len, scale, val, valEnd);
+
+                  CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.data(), pRef->result, pRes->result);
+                  for (int i = 0; i < SIMD_TEST_MAX_LENGTH; i++)
+                  {
+                     CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.data(), pRef->src16[i], pRes->src16[i]);
+                     CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.data(), pRef->dst16[i], pRes->dst16[i]);
+                     CPPUNIT_ASSERT_EQUAL_MESSAGE(msg.data(), pRef->dst32[i], pRes->dst32[i]);
+                  }
+               }
+            }
+         }
+      }
+
+      delete pRef;
+      delete pRes;
+      MpDspUtils::setSimdLevel(savedLevel);
+   }
+
+   void testSimdCountClippedLong()
+   {
+      // Long enough to overflow 16-bit counters used by SIMD versions.
+      const int len = 600000;
+      const MpDspSimdLevel savedLevel = MpDspUtils::getSimdLevel();
+      int16_t *pSrc = new int16_t[len];
+      int expected = 0;
+
+      for (int i = 0; i < len; i++)
+      {
+         pSrc[i] = (i%3 == 0) ? INT16_MIN : (i%3 == 1) ? INT16_MAX : 0;
+         expected += (i%3 != 2) ? 1 : 0;
+      }
+
+      for (int level = MP_DSP_SIMD_NONE; level < MP_DSP_SIMD_LEVELS_NUM; level++)
+      {
+         if (MpDspUtils::setSimdLevel((MpDspSimdLevel)level) == OS_SUCCESS)
+         {
+            CPPUNIT_ASSERT_EQUAL_MESSAGE(MpDspUtils::getSimdLevelName((MpDspSimdLevel)level),
+                                         expected,
+                                         (int)MpDspUtils::countClippedValues(pSrc, len));
+         }
+      }
+
+      delete[] pSrc;
+      MpDspUtils::setSimdLevel(savedLevel);
+   }
+
+   void testSimdPerformance()
+   {
+      const MpDspSimdLevel savedLevel = MpDspUtils::getSimdLevel();
+      const int len = SIMD_TEST_MAX_LENGTH; // 20ms at 48kHz
+      const int numFrames = 10000;
+      SimdWorkspace *pWork = new SimdWorkspace;
+
+      printf("MpDspUtils best SIMD level: %s\n",
+             MpDspUtils::getSimdLevelName(MpDspUtils::detectSimdLevel()));
+      srand(1234);
+      for (int level = MP_DSP_SIMD_NONE; level < MP_DSP_SIMD_LEVELS_NUM; level++)
+      {
+         if (MpDspUtils::setSimdLevel((MpDspSimdLevel)level) != OS_SUCCESS)
+         {
+            continue;
+         }
+
+         for (int kernel = 0; kernel < SIMD_KERNELS_NUM; kernel++)
+         {
+            // Small values, so accumulators do not saturate during the test.
+            fillSimdWorkspace(*pWork, TRUE);
+
+            OsTime start;
+            OsTime stop;
+            OsDateTime::getCurTime(start);
+            for (int frame = 0; frame < numFrames; frame++)
+            {
+               runSimdKernel(kernel, *pWork, len, 2, 10, 20);
+            }
+            OsDateTime::getCurTime(stop);
+
+            OsTime diff = stop - start;
+            double usecs = diff.seconds()*1000000.0 + diff.usecs();
+            printf("MpDspUtils %-4s %-20s %9.1f Msamples/sec\n",
+                   MpDspUtils::getSimdLevelName((MpDspSimdLevel)level),
+                   sSimdKernelNames[kernel],
+                   (usecs > 0) ? (double)len*numFrames/usecs : 0.0);
+         }
+      }
+
+      delete pWork;
+      MpDspUtils::setSimdLevel(savedLevel);
+   }
+
 #else  // MP_FIXED_POINT ][
 
    void testConvert_float_int16()
@@ -342,6 +476,169 @@ public:
 
 protected:
 
+#ifdef MP_FIXED_POINT // [
+
+   // Vector functions for SIMD versions tests.
+   enum {
+      SIMD_ADD_I = 0,
+      SIMD_ADD_IGAIN,
+      SIMD_ADD_IATT,
+      SIMD_ADD,
+      SIMD_ADDMUL_I,
+      SIMD_ADDMULLINEAR_I,
+      SIMD_MUL,
+      SIMD_MUL_I,
+      SIMD_MULLINEAR,
+      SIMD_CONVERT_32_16,
+      SIMD_CONVERT_GAIN_32_16,
+      SIMD_CONVERT_ATT_32_16,
+      SIMD_CONVERT_16_32,
+      SIMD_CONVERT_GAIN_16_32,
+      SIMD_CONVERT_ATT_16_32,
+      SIMD_MAXABS,
+      SIMD_MAXIMUM_16,
+      SIMD_MAXIMUM_32,
+      SIMD_MINIMUM_16,
+      SIMD_MINIMUM_32,
+      SIMD_COUNT_CLIPPED,
+
+      SIMD_KERNELS_NUM
+   };
+   static const char *sSimdKernelNames[SIMD_KERNELS_NUM];
+
+   enum {SIMD_TEST_MAX_LENGTH=960};
+   struct SimdWorkspace
+   {
+      int16_t src16[SIMD_TEST_MAX_LENGTH];
+      int32_t src32[SIMD_TEST_MAX_LENGTH];
+      int16_t dst16[SIMD_TEST_MAX_LENGTH];
+      int32_t dst32[SIMD_TEST_MAX_LENGTH];
+      int     result;
+   };
+
+   static int16_t randomInt16(UtlBoolean small)
+   {
+      static const int16_t corners[] = {INT16_MIN, INT16_MIN+1, INT16_MAX,
+                                        INT16_MAX-1, 0, 1, -1};
+      if (small)
+      {
+         return (int16_t)(rand()%2001 - 1000);
+      }
+      if (rand()%4 == 0)
+      {
+         return corners[rand()%(sizeof(corners)/sizeof(corners[0]))];
+      }
+      return (int16_t)rand();
+   }
+
+   static int32_t randomInt32(UtlBoolean small)
+   {
+      static const int32_t corners[] = {INT32_MIN, INT32_MIN+1, INT32_MAX,
+                                        INT32_MAX-1, INT32_MAX-32767,
+                                        INT32_MIN+32768, 0, 1, -1,
+                                        INT16_MAX, -INT16_MAX, INT16_MIN,
+                                        INT16_MAX+1};
+      if (small)
+      {
+         return 0;
+      }
+      switch (rand()%4)
+      {
+      case 0:
+         return corners[rand()%(sizeof(corners)/sizeof(corners[0]))];
+      case 1:
+         // Around 16-bit range to check saturation in conversions.
+         return rand()%200000 - 100000;
+      default:
+         return (int32_t)(((uint32_t)rand()<<16) ^ (uint32_t)rand());
+      }
+   }
+
+   static void fillSimdWorkspace(SimdWorkspace &work, UtlBoolean small)
+   {
+      for (int i = 0; i < SIMD_TEST_MAX_LENGTH; i++)
+      {
+         work.src16[i] = randomInt16(small);
+         work.src32[i] = randomInt32(small);
+         work.dst16[i] = randomInt16(small);
+         work.dst32[i] = randomInt32(small);
+      }
+      work.result = 0;
+   }
+
+   static void runSimdKernel(int kernel, SimdWorkspace &work, int len,
+                             unsigned scale, int16_t val, int16_t valEnd)
+   {
+      switch (kernel)
+      {
+      case SIMD_ADD_I:
+         MpDspUtils::add_I(work.src16, work.dst32, len);
+         break;
+      case SIMD_ADD_IGAIN:
+         MpDspUtils::add_IGain(work.src16, work.dst32, len, scale);
+         break;
+      case SIMD_ADD_IATT:
+         MpDspUtils::add_IAtt(work.src16, work.dst32, len, scale);
+         break;
+      case SIMD_ADD:
+         MpDspUtils::add(work.src32, work.dst32, work.dst32, len);
+         break;
+      case SIMD_ADDMUL_I:
+         MpDspUtils::addMul_I(work.src16, val, work.dst32, len);
+         break;
+      case SIMD_ADDMULLINEAR_I:
+         MpDspUtils::addMulLinear_I(work.src16, val, valEnd, work.dst32, len);
+         break;
+      case SIMD_MUL:
+         MpDspUtils::mul(work.src16, val, work.dst32, len);
+         break;
+      case SIMD_MUL_I:
+         MpDspUtils::mul_I(work.dst16, val, len);
+         break;
+      case SIMD_MULLINEAR:
+         MpDspUtils::mulLinear(work.src16, val, valEnd, work.dst32, len);
+         break;
+      case SIMD_CONVERT_32_16:
+         MpDspUtils::convert(work.src32, work.dst16, len);
+         break;
+      case SIMD_CONVERT_GAIN_32_16:
+         MpDspUtils::convert_Gain(work.src32, work.dst16, len, scale);
+         break;
+      case SIMD_CONVERT_ATT_32_16:
+         MpDspUtils::convert_Att(work.src32, work.dst16, len, scale);
+         break;
+      case SIMD_CONVERT_16_32:
+         MpDspUtils::convert(work.src16, work.dst32, len);
+         break;
+      case SIMD_CONVERT_GAIN_16_32:
+         MpDspUtils::convert_Gain(work.src16, work.dst32, len, scale);
+         break;
+      case SIMD_CONVERT_ATT_16_32:
+         MpDspUtils::convert_Att(work.src16, work.dst32, len, scale);
+         break;
+      case SIMD_MAXABS:
+         work.result = MpDspUtils::maxAbs(work.src16, len);
+         break;
+      case SIMD_MAXIMUM_16:
+         work.result = MpDspUtils::maximum(work.src16, len);
+         break;
+      case SIMD_MAXIMUM_32:
+         work.result = MpDspUtils::maximum(work.src32, len);
+         break;
+      case SIMD_MINIMUM_16:
+         work.result = MpDspUtils::minimum(work.src16, len);
+         break;
+      case SIMD_MINIMUM_32:
+         work.result = MpDspUtils::minimum(work.src32, len);
+         break;
+      case SIMD_COUNT_CLIPPED:
+         work.result = MpDspUtils::countClippedValues(work.src16, len);
+         break;
+      }
+   }
+
+#endif // MP_FIXED_POINT ]
+
    // Data set for 16-bit integer addition test.
    enum {ADD_INT16_TEST_LENGTH=12};
    static const int16_t add_int16_src[ADD_INT16_TEST_LENGTH];
@@ -386,6 +683,33 @@ protected:
 
 };
 
+#ifdef MP_FIXED_POINT // [
+const char *MpDspUtilsTest::sSimdKernelNames[MpDspUtilsTest::SIMD_KERNELS_NUM] =
+{
+   "add_I",
+   "add_IGain",
+   "add_IAtt",
+   "add",
+   "addMul_I",
+   "addMulLinear_I",
+   "mul",
+   "mul_I",
+   "mulLinear",
+   "convert(32->16)",
+   "convert_Gain(32->16)",
+   "convert_Att(32->16)",
+   "convert(16->32)",
+   "convert_Gain(16->32)",
+   "convert_Att(16->32)",
+   "maxAbs",
+   "maximum(16)",
+   "maximum(32)",
+   "minimum(16)",
+   "minimum(32)",
+   "countClippedValues"
+};
+#endif // MP_FIXED_POINT ]
+
 const int16_t MpDspUtilsTest::add_int16_src[ADD_INT16_TEST_LENGTH]
    =  {-32768, -32767, -32766, -16384, -16383,  -8192,      0,   8192,  16383,  16384, 32766, 32767};
 const int16_t MpDspUtilsTest::add_int16_res[ADD_INT16_TEST_LENGTH][ADD_INT16_TEST_LENGTH] 
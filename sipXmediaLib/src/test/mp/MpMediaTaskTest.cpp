@@ -36,6 +36,7 @@ class MpMediaTaskTest : public SIPX_UNIT_BASE_CLASS
     CPPUNIT_TEST(testStartAndStopFlowGraph);
     CPPUNIT_TEST(testTimeLimitAndTimeout);
     CPPUNIT_TEST(testMultipleManagedAndUnmanagedFlowgraph);
+    CPPUNIT_TEST(testWorkerThreads);
     CPPUNIT_TEST_SUITE_END();
 
 /// Number of frames in one frame
@@ -470,6 +471,110 @@ public:
         delete pFlowGraph2;
     }
 
+    void testWorkerThreads()
+    {
+        const int numFlowGraphs = 3;
+        MpFlowGraphBase* pFlowGraphs[numFlowGraphs];
+        OsStatus         res;
+        int              i;
+
+        // Re-create the media task with two worker threads
+        res = mpShutdown();
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        res = mpStartUp(TEST_SAMPLES_PER_SEC, TEST_SAMPLES_PER_FRAME, 
+                        6*10, NULL, sNumCodecPaths, sCodecPaths);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        mpMediaTask = MpMediaTask::createMediaTask(10, TRUE, 2);
+        CPPUNIT_ASSERT(mpMediaTask != NULL);
+        CPPUNIT_ASSERT_EQUAL(2, mpMediaTask->numWorkers());
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getWorkerLimitExceededCnt(0));
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getWorkerLimitExceededCnt(1));
+        CPPUNIT_ASSERT_EQUAL(-1, mpMediaTask->getWorkerLimitExceededCnt(2));
+        res = mpMediaTask->setDebug(TRUE);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+
+        // Test 1: Flow graphs are spread evenly over the workers
+        for (i = 0; i < numFlowGraphs; i++)
+        {
+           pFlowGraphs[i] = new MpFlowGraphBase(30, 30);
+           res = mpMediaTask->manageFlowGraph(*pFlowGraphs[i]);
+           CPPUNIT_ASSERT(res == OS_SUCCESS);
+           res = mpMediaTask->startFlowGraph(*pFlowGraphs[i]);
+           CPPUNIT_ASSERT(res == OS_SUCCESS);
+        }
+        res = MpMediaTask::signalFrameStart();  // signal the media task and
+        CPPUNIT_ASSERT(res == OS_SUCCESS);      // give it a chance to run
+        OsTask::delay(100);
+
+        CPPUNIT_ASSERT_EQUAL(numFlowGraphs, mpMediaTask->numManagedFlowGraphs());
+        CPPUNIT_ASSERT_EQUAL(numFlowGraphs, mpMediaTask->numStartedFlowGraphs());
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getFlowGraphWorker(pFlowGraphs[0]));
+        CPPUNIT_ASSERT_EQUAL(1, mpMediaTask->getFlowGraphWorker(pFlowGraphs[1]));
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getFlowGraphWorker(pFlowGraphs[2]));
+
+        // Test 2: All started flow graphs process every frame, although
+        //         there are more flow graphs than workers
+        int fgFrames[numFlowGraphs];
+        for (i = 0; i < numFlowGraphs; i++)
+        {
+           CPPUNIT_ASSERT(pFlowGraphs[i]->isStarted());
+        }
+        for (int tick = 0; tick < 5; tick++)
+        {
+           for (i = 0; i < numFlowGraphs; i++)
+           {
+              fgFrames[i] = pFlowGraphs[i]->numFramesProcessed();
+           }
+           int frames = mpMediaTask->numProcessedFrames();
+           res = MpMediaTask::signalFrameStart();
+           CPPUNIT_ASSERT(res == OS_SUCCESS);
+           OsTask::delay(20);
+           CPPUNIT_ASSERT_EQUAL(frames + 1, mpMediaTask->numProcessedFrames());
+           for (i = 0; i < numFlowGraphs; i++)
+           {
+              CPPUNIT_ASSERT_EQUAL(fgFrames[i] + 1,
+                                   pFlowGraphs[i]->numFramesProcessed());
+           }
+        }
+
+        // Test 3: A new flow graph goes to the least loaded worker and
+        //         flow graphs stay bound to their workers.
+        res = mpMediaTask->unmanageFlowGraph(*pFlowGraphs[0]);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        res = mpMediaTask->unmanageFlowGraph(*pFlowGraphs[2]);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        res = mpMediaTask->manageFlowGraph(*pFlowGraphs[2]);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        res = mpMediaTask->manageFlowGraph(*pFlowGraphs[0]);
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        res = MpMediaTask::signalFrameStart();
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        OsTask::delay(20);
+        CPPUNIT_ASSERT_EQUAL(numFlowGraphs, mpMediaTask->numManagedFlowGraphs());
+        CPPUNIT_ASSERT_EQUAL(1, mpMediaTask->getFlowGraphWorker(pFlowGraphs[1]));
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getFlowGraphWorker(pFlowGraphs[2]));
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getFlowGraphWorker(pFlowGraphs[0]));
+
+        // Debug mode is on, so time limit should never be checked.
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->getLimitExceededCnt());
+
+        for (i = 0; i < numFlowGraphs; i++)
+        {
+           res = mpMediaTask->unmanageFlowGraph(*pFlowGraphs[i]);
+           CPPUNIT_ASSERT(res == OS_SUCCESS);
+        }
+        res = MpMediaTask::signalFrameStart();
+        CPPUNIT_ASSERT(res == OS_SUCCESS);
+        OsTask::delay(20);
+        CPPUNIT_ASSERT_EQUAL(0, mpMediaTask->numManagedFlowGraphs());
+        CPPUNIT_ASSERT_EQUAL(-1, mpMediaTask->getFlowGraphWorker(pFlowGraphs[0]));
+
+        for (i = 0; i < numFlowGraphs; i++)
+        {
+           delete pFlowGraphs[i];
+        }
+    }
+
 protected:
    MpMediaTask *mpMediaTask;
 };
@@ -0,0 +1,352 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <os/OsDateTime.h>
+#include <os/OsTime.h>
+#include <mp/MpResamplerPolyphase.h>
+
+/// Gives access to the filter of a resampler.
+class MpResamplerPolyphaseTestAccess : public MpResamplerPolyphase
+{
+public:
+   MpResamplerPolyphaseTestAccess(uint32_t inputRate, uint32_t outputRate)
+   : MpResamplerPolyphase(1, inputRate, outputRate)
+   {
+   }
+
+   const void *getFilterTable() const
+   {
+      return mpFilter;
+   }
+};
+
+/**
+ * Unittest for MpResamplerPolyphase
+ */
+class MpResamplerPolyphaseTest : public SIPX_UNIT_BASE_CLASS
+{
+   CPPUNIT_TEST_SUITE(MpResamplerPolyphaseTest);
+   CPPUNIT_TEST(testSupportedRatios);
+   CPPUNIT_TEST(testSharedFilters);
+   CPPUNIT_TEST(testPassband);
+   CPPUNIT_TEST(testStopband);
+   CPPUNIT_TEST(testFrameByFrame);
+   CPPUNIT_TEST(testChannels);
+   CPPUNIT_TEST(testChannelsPerformance);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   void testSupportedRatios()
+   {
+      CPPUNIT_ASSERT(MpResamplerPolyphase::isRatioSupported(8000, 16000));
+      CPPUNIT_ASSERT(MpResamplerPolyphase::isRatioSupported(48000, 8000));
+      CPPUNIT_ASSERT(MpResamplerPolyphase::isRatioSupported(32000, 48000));
+      CPPUNIT_ASSERT(!MpResamplerPolyphase::isRatioSupported(44100, 48000));
+      CPPUNIT_ASSERT(!MpResamplerPolyphase::isRatioSupported(8000, 8000));
+
+      // Other ratios are passed to the base resampler.
+      MpResamplerPolyphase resampler(1, 44100, 48000);
+      MpResamplerBase baseResampler(1, 44100, 48000, 0);
+      MpAudioSample in[441];
+      MpAudioSample out[480];
+      MpAudioSample baseOut[480];
+      uint32_t inProcessed = 0;
+      uint32_t outWritten = 0;
+      uint32_t baseInProcessed = 0;
+      uint32_t baseOutWritten = 0;
+      fillNoise(in, 441, 1);
+      CPPUNIT_ASSERT_EQUAL(baseResampler.resample(0, in, 441, baseInProcessed,
+                                                  baseOut, 480, baseOutWritten),
+                           resampler.resample(0, in, 441, inProcessed,
+                                              out, 480, outWritten));
+      CPPUNIT_ASSERT_EQUAL(baseOutWritten, outWritten);
+      CPPUNIT_ASSERT(memcmp(baseOut, out, outWritten*sizeof(MpAudioSample)) == 0);
+   }
+
+   void testSharedFilters()
+   {
+      MpResamplerPolyphaseTestAccess resampler1(8000, 16000);
+      MpResamplerPolyphaseTestAccess resampler2(8000, 16000);
+      MpResamplerPolyphaseTestAccess resampler3(16000, 32000);
+      MpResamplerPolyphaseTestAccess resampler4(16000, 8000);
+
+      CPPUNIT_ASSERT(resampler1.getFilterTable() != NULL);
+      CPPUNIT_ASSERT(resampler1.getFilterTable() == resampler2.getFilterTable());
+      CPPUNIT_ASSERT(resampler1.getFilterTable() == resampler3.getFilterTable());
+      CPPUNIT_ASSERT(resampler1.getFilterTable() != resampler4.getFilterTable());
+
+      resampler4.setInputRate(8000);
+      resampler4.setOutputRate(16000);
+      CPPUNIT_ASSERT(resampler1.getFilterTable() == resampler4.getFilterTable());
+   }
+
+   void testPassband()
+   {
+      // Tone in the passband of every conversion keeps its level.
+      for (int i = 0; i < NUM_RATES; i++)
+      {
+         for (int j = 0; j < NUM_RATES; j++)
+         {
+            if (i == j)
+            {
+               continue;
+            }
+            double ratio = resampleTone(sRates[i], sRates[j], 1000.0);
+            CPPUNIT_ASSERT(ratio > 0.98 && ratio < 1.02);
+         }
+      }
+   }
+
+   void testStopband()
+   {
+      // Tone above half of the output rate is removed.
+      CPPUNIT_ASSERT(resampleTone(48000, 8000, 6000.0) < 0.01);
+      CPPUNIT_ASSERT(resampleTone(16000, 8000, 5000.0) < 0.01);
+      CPPUNIT_ASSERT(resampleTone(48000, 16000, 10000.0) < 0.01);
+   }
+
+   void testFrameByFrame()
+   {
+      // Resampling in 10ms frames gives the same result as in one call.
+      const int inLength = 16000;
+      const int outLength = 48000;
+      MpAudioSample *pIn = new MpAudioSample[inLength];
+      MpAudioSample *pOutWhole = new MpAudioSample[outLength];
+      MpAudioSample *pOutFrames = new MpAudioSample[outLength];
+      fillNoise(pIn, inLength, 1);
+
+      MpResamplerPolyphase wholeResampler(1, 16000, 48000);
+      MpResamplerPolyphase frameResampler(1, 16000, 48000);
+      uint32_t inProcessed = 0;
+      uint32_t outWritten = 0;
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           wholeResampler.resample(0, pIn, inLength, inProcessed,
+                                                   pOutWhole, outLength, outWritten));
+      CPPUNIT_ASSERT_EQUAL((uint32_t)inLength, inProcessed);
+      CPPUNIT_ASSERT_EQUAL((uint32_t)outLength, outWritten);
+
+      for (int frame = 0; frame < inLength / 160; frame++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              frameResampler.resample(0, pIn + frame*160, 160,
+                                                      inProcessed,
+                                                      pOutFrames + frame*480, 480,
+                                                      outWritten));
+         CPPUNIT_ASSERT_EQUAL(160U, inProcessed);
+         CPPUNIT_ASSERT_EQUAL(480U, outWritten);
+      }
+      CPPUNIT_ASSERT(memcmp(pOutWhole, pOutFrames,
+                            outLength*sizeof(MpAudioSample)) == 0);
+
+      delete[] pIn;
+      delete[] pOutWhole;
+      delete[] pOutFrames;
+   }
+
+   void testChannels()
+   {
+      // Channels resampled together give the same result as one by one.
+      const int numChannels = 4;
+      const int inLength = 960;
+      const int outLength = 320;
+      MpAudioSample in[numChannels][inLength];
+      MpAudioSample outSingle[numChannels][outLength];
+      MpAudioSample outBatch[numChannels][outLength];
+      const MpAudioSample *pInBufs[numChannels];
+      MpAudioSample *pOutBufs[numChannels];
+      int channel;
+      for (channel = 0; channel < numChannels; channel++)
+      {
+         fillNoise(in[channel], inLength, channel + 1);
+         pInBufs[channel] = in[channel];
+         pOutBufs[channel] = outBatch[channel];
+      }
+
+      MpResamplerPolyphase singleResampler(numChannels, 48000, 16000);
+      MpResamplerPolyphase batchResampler(numChannels, 48000, 16000);
+      for (int frame = 0; frame < 3; frame++)
+      {
+         uint32_t inProcessed = 0;
+         uint32_t outWritten = 0;
+         for (channel = 0; channel < numChannels; channel++)
+         {
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                                 singleResampler.resample(channel, in[channel],
+                                                          inLength, inProcessed,
+                                                          outSingle[channel],
+                                                          outLength, outWritten));
+         }
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              batchResampler.resampleChannels(numChannels, pInBufs,
+                                                              inLength, inProcessed,
+                                                              pOutBufs, outLength,
+                                                              outWritten));
+         CPPUNIT_ASSERT_EQUAL((uint32_t)inLength, inProcessed);
+         CPPUNIT_ASSERT_EQUAL((uint32_t)outLength, outWritten);
+         CPPUNIT_ASSERT(memcmp(outSingle, outBatch, sizeof(outSingle)) == 0);
+      }
+
+      // Channels out of step can't be processed together.
+      uint32_t inProcessed = 0;
+      uint32_t outWritten = 0;
+      batchResampler.resample(0, in[0], 1, inProcessed, outSingle[0], 1, outWritten);
+      CPPUNIT_ASSERT_EQUAL(OS_INVALID_STATE,
+                           batchResampler.resampleChannels(numChannels, pInBufs,
+                                                           inLength, inProcessed,
+                                                           pOutBufs, outLength,
+                                                           outWritten));
+      CPPUNIT_ASSERT_EQUAL(OS_INVALID_ARGUMENT,
+                           batchResampler.resampleChannels(numChannels + 1, pInBufs,
+                                                           inLength, inProcessed,
+                                                           pOutBufs, outLength,
+                                                           outWritten));
+   }
+
+   void testChannelsPerformance()
+   {
+      for (int i = 0; i < NUM_RATES; i++)
+      {
+         for (int j = 0; j < NUM_RATES; j++)
+         {
+            if (i != j)
+            {
+               timeResampling(sRates[i], sRates[j]);
+            }
+         }
+      }
+   }
+
+protected:
+
+   enum
+   {
+      NUM_RATES = 3,
+      NUM_PERF_CHANNELS = 50,
+      NUM_PERF_FRAMES = 100 ///< 10ms frames of every channel.
+   };
+
+   static const uint32_t sRates[NUM_RATES];
+
+   static double toSeconds(const OsTime &time)
+   {
+      return time.seconds() + time.usecs()/1000000.0;
+   }
+
+   static void fillNoise(MpAudioSample *pBuf, int length, unsigned seed)
+   {
+      for (int i = 0; i < length; i++)
+      {
+         seed = seed * 1103515245 + 12345;
+         pBuf[i] = (MpAudioSample)((seed >> 16) & 0x3FFF) - 0x2000;
+      }
+   }
+
+     /// Resample 1 second of a tone, return ratio of output and input RMS.
+   double resampleTone(uint32_t inRate, uint32_t outRate, double freq)
+   {
+      MpAudioSample *pIn = new MpAudioSample[inRate];
+      MpAudioSample *pOut = new MpAudioSample[outRate];
+      double inEnergy = 0.0;
+      double outEnergy = 0.0;
+      uint32_t i;
+      for (i = 0; i < inRate; i++)
+      {
+         pIn[i] = (MpAudioSample)(10000.0 * sin(2 * M_PI * freq * i / inRate));
+      }
+
+      MpResamplerPolyphase resampler(1, inRate, outRate);
+      uint32_t inProcessed = 0;
+      uint32_t outWritten = 0;
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           resampler.resample(0, pIn, inRate, inProcessed,
+                                              pOut, outRate, outWritten));
+      CPPUNIT_ASSERT_EQUAL(outRate, outWritten);
+
+      // Skip the filter delay at the start.
+      for (i = inRate/10; i < inRate; i++)
+      {
+         inEnergy += (double)pIn[i] * pIn[i];
+      }
+      for (i = outRate/10; i < outRate; i++)
+      {
+         outEnergy += (double)pOut[i] * pOut[i];
+      }
+
+      delete[] pIn;
+      delete[] pOut;
+      return sqrt((outEnergy / outRate) / (inEnergy / inRate));
+   }
+
+     /// Print time of resampling many channels one by one and together.
+   void timeResampling(uint32_t inRate, uint32_t outRate)
+   {
+      const uint32_t inLength = inRate / 100;
+      const uint32_t outLength = outRate / 100;
+      MpAudioSample *pIn = new MpAudioSample[inLength];
+      MpAudioSample *pOut = new MpAudioSample[NUM_PERF_CHANNELS * outLength];
+      const MpAudioSample *pInBufs[NUM_PERF_CHANNELS];
+      MpAudioSample *pOutBufs[NUM_PERF_CHANNELS];
+      fillNoise(pIn, inLength, 1);
+      int channel;
+      for (channel = 0; channel < NUM_PERF_CHANNELS; channel++)
+      {
+         pInBufs[channel] = pIn;
+         pOutBufs[channel] = pOut + channel * outLength;
+      }
+
+      MpResamplerPolyphase resampler(NUM_PERF_CHANNELS, inRate, outRate);
+      OsTime start;
+      OsTime stop;
+      uint32_t inProcessed = 0;
+      uint32_t outWritten = 0;
+      int frame;
+
+      OsDateTime::getCurTime(start);
+      for (frame = 0; frame < NUM_PERF_FRAMES; frame++)
+      {
+         for (channel = 0; channel < NUM_PERF_CHANNELS; channel++)
+         {
+            resampler.resample(channel, pIn, inLength, inProcessed,
+                               pOutBufs[channel], outLength, outWritten);
+         }
+      }
+      OsDateTime::getCurTime(stop);
+      double singleSeconds = toSeconds(stop - start);
+
+      OsDateTime::getCurTime(start);
+      for (frame = 0; frame < NUM_PERF_FRAMES; frame++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              resampler.resampleChannels(NUM_PERF_CHANNELS,
+                                                         pInBufs, inLength,
+                                                         inProcessed, pOutBufs,
+                                                         outLength, outWritten));
+      }
+      OsDateTime::getCurTime(stop);
+      double batchSeconds = toSeconds(stop - start);
+
+      // Processed audio is NUM_PERF_FRAMES/100 seconds of every channel.
+      const double channelSeconds = NUM_PERF_CHANNELS * NUM_PERF_FRAMES / 100.0;
+      printf("resample %u->%u single;%f usec/channel-second\n", inRate, outRate,
+             singleSeconds * 1000000.0 / channelSeconds);
+      printf("resample %u->%u batch;%f usec/channel-second\n", inRate, outRate,
+             batchSeconds * 1000000.0 / channelSeconds);
+
+      delete[] pIn;
+      delete[] pOut;
+   }
+};
+
+const uint32_t MpResamplerPolyphaseTest::sRates[NUM_RATES] = {8000, 16000, 48000};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MpResamplerPolyphaseTest);
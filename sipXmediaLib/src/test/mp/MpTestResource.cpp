@@ -62,6 +62,7 @@ MpTestResource::MpTestResource(const UtlString& rName,
 , mpSignalPeriod(NULL)
 , mpSignalAmplitude(NULL)
 , mpSpeechType(NULL)
+, mpFrameEnergy(NULL)
 , mpBuffer(NULL)
 , mBufferSize(0)
 {
@@ -70,12 +71,14 @@ MpTestResource::MpTestResource(const UtlString& rName,
    mpSignalPeriod = new float[maxOutputs];
    mpSignalAmplitude = new int[maxOutputs];
    mpSpeechType = new MpSpeechType[maxOutputs];
+   mpFrameEnergy = new int[maxOutputs];
    int outIndex;
    for(outIndex = 0; outIndex < maxOutputs; outIndex++)
    {
       mpSignalPeriod[outIndex] = 0.0;
       mpSignalAmplitude[outIndex] = 0;
       mpSpeechType[outIndex] = MP_SPEECH_UNKNOWN;
+      mpFrameEnergy[outIndex] = -1;
    }
 }
 
@@ -88,6 +91,8 @@ MpTestResource::~MpTestResource()
    if (mLastDoProcessArgs.outBufs != NULL)
       delete[] mLastDoProcessArgs.outBufs;
 
+   delete[] mpFrameEnergy;
+
    if(mpBuffer)
    {
        delete[] mpBuffer;
@@ -152,6 +157,12 @@ void MpTestResource::setSpeechType(int outputIndex, MpSpeechType speech)
    mpSpeechType[outputIndex] = speech;
 }
 
+void MpTestResource::setFrameEnergy(int outputIndex, int energy)
+{
+   assert(outputIndex < maxOutputs());
+   mpFrameEnergy[outputIndex] = energy;
+}
+
 void MpTestResource::setBuffer(const MpAudioSample samples[], int sampleCount)
 {
     if(mpBuffer)
@@ -351,6 +362,7 @@ UtlBoolean MpTestResource::doProcessFrame(MpBufPtr inBufs[],
             }
 
             pBuf->setSpeechType(mpSpeechType[i]);
+            pBuf->setEnergy(mpFrameEnergy[i]);
             outBufs[i] = pBuf;            
          }
       }
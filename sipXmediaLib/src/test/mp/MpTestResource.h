@@ -120,6 +120,9 @@ public:
      /// Set speech type of signal, generated on outputs.
    void setSpeechType(int outputIndex, MpSpeechType speech);
 
+     /// Set frame energy of signal, generated on outputs (-1 if unknown).
+   void setFrameEnergy(int outputIndex, int energy);
+
    /// Set buffer samples
    void setBuffer(const MpAudioSample samples[], int numSamples);
    /**
@@ -174,6 +177,7 @@ protected:
    float*           mpSignalPeriod;   ///< Period of signal if supported (in samples)
    int*           mpSignalAmplitude;  ///< Magnitude of signal if supported
    MpSpeechType*  mpSpeechType;       ///< Speech type of signal
+   int*           mpFrameEnergy;      ///< Frame energy of signal
    MpAudioSample* mpBuffer;           ///< Allocated buffer of samples for output
    int            mBufferSize;        ///< Number of samples in mpBuffer
 
@@ -13,7 +13,15 @@
 #include <mp/MpTestResource.h>
 #include <mp/MpMisc.h>
 #include <mp/MprBridge.h>
+#include <mp/MpBridgeAlgLinear.h>
 #include <mp/MpBufferMsg.h>
+#include <mp/MpEncodedFrameCache.h>
+#include <mp/MprEncode.h>
+#include <mp/MprToNet.h>
+#include <mp/MpCodecFactory.h>
+#include <mp/RtpHeader.h>
+#include <sdp/SdpCodec.h>
+#include <os/OsDatagramSocket.h>
 #include <os/OsDateTime.h>
 
 #include <sipxunittests.h>
@@ -39,6 +47,10 @@ class MprBridgeTest : public MpGenericResourceTest
     CPPUNIT_TEST(testEnabledWithManyActiveInputs);
     CPPUNIT_TEST(testSideBar);
     CPPUNIT_TEST(testMixNormalWeights);
+    CPPUNIT_TEST(testSharedMixBuffers);
+    CPPUNIT_TEST(testSharedMixEncoding);
+    CPPUNIT_TEST(testActiveSpeakerLimit);
+    CPPUNIT_TEST(testActiveSpeakerMixPerformance);
     CPPUNIT_TEST(testSimpleMixPerformance);
     CPPUNIT_TEST(testWBCommonTests);
     CPPUNIT_TEST_SUITE_END();
@@ -459,6 +471,340 @@ public:
 
    } // end testMixNormalWeights()
 
+   void testSharedMixBuffers()
+   {
+       const int         numParticipants = 5;
+       MprBridge*        pBridge    = NULL;
+
+       pBridge = new MprBridge("MprBridge", numParticipants);
+       CPPUNIT_ASSERT(pBridge != NULL);
+
+       setupFramework(pBridge);
+
+       // Inputs 0 and 1 are talking, the others are silent listeners.
+       CPPUNIT_ASSERT(mpSourceResource->enable());
+       mpSourceResource->setOutSignalType(MpTestResource::MP_TEST_SIGNAL_SQUARE);
+       mpSourceResource->setSignalPeriod(0, 2);
+       mpSourceResource->setSignalAmplitude(0, 100);
+       mpSourceResource->setSignalPeriod(1, 4);
+       mpSourceResource->setSignalAmplitude(1, 200);
+       mpSourceResource->setGenOutBufMask(0x03);
+       CPPUNIT_ASSERT(pBridge->enable());
+
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                            mpFlowGraph->processNextFrame());
+
+       // The listeners all get the same mix, in the same buffer.
+       MpAudioBufPtr pMix = mpSinkResource->mLastDoProcessArgs.inBufs[2];
+       CPPUNIT_ASSERT(pMix.isValid());
+       const MpAudioSample* pSamples = pMix->getSamplesPtr();
+       for (unsigned i=0; i<pMix->getSamplesNumber(); i++)
+       {
+          CPPUNIT_ASSERT_EQUAL((MpAudioSample)(
+                                  mpSourceResource->getSquareSampleValue(0, i) +
+                                  mpSourceResource->getSquareSampleValue(1, i)),
+                               pSamples[i]);
+       }
+       for (int output=3; output<numParticipants; output++)
+       {
+          CPPUNIT_ASSERT(mpSinkResource->mLastDoProcessArgs.inBufs[output] == pMix);
+       }
+
+       // The talkers hear each other.
+       CPPUNIT_ASSERT(mpSinkResource->mLastDoProcessArgs.inBufs[0] !=
+                      mpSinkResource->mLastDoProcessArgs.inBufs[1]);
+       CPPUNIT_ASSERT(!(mpSinkResource->mLastDoProcessArgs.inBufs[0] == pMix));
+
+       // Encoders fed the shared mix find the encoding of the first one.
+       MpEncodedFrameCache* pCache = mpFlowGraph->getEncodedFrameCache();
+       const UtlString codecKey("PCMU/8000");
+       const int frameNum = mpFlowGraph->numFramesProcessed();
+       int bytes = 0;
+       CPPUNIT_ASSERT(pCache->find(pMix, codecKey, frameNum, bytes) == NULL);
+       unsigned char* pEncoded = pCache->store(pMix, codecKey, frameNum, 160);
+       CPPUNIT_ASSERT(pEncoded != NULL);
+       for (int output=3; output<numParticipants; output++)
+       {
+          MpBufPtr pIn = mpSinkResource->mLastDoProcessArgs.inBufs[output];
+          CPPUNIT_ASSERT(pCache->find(pIn, codecKey, frameNum, bytes) == pEncoded);
+          CPPUNIT_ASSERT_EQUAL(160, bytes);
+       }
+       CPPUNIT_ASSERT_EQUAL(2, pCache->getHits());
+
+       // Other mixes, codecs and frames are encoded on their own.
+       CPPUNIT_ASSERT(pCache->find(mpSinkResource->mLastDoProcessArgs.inBufs[0],
+                                   codecKey, frameNum, bytes) == NULL);
+       CPPUNIT_ASSERT(pCache->find(pMix, "PCMA/8000", frameNum, bytes) == NULL);
+       CPPUNIT_ASSERT(pCache->find(pMix, codecKey, frameNum+1, bytes) == NULL);
+       pCache->reset();
+       pMix.release();
+
+       // Stop flowgraph
+       haltFramework();
+   }
+
+   void testSharedMixEncoding()
+   {
+       const int         numParticipants = 6;
+       const int         numLegs = 4;
+       const int         legPacketTimes[numLegs] = {20, 20, 20, 30};
+       const int         numFrames = 12;
+       const int         frameSize = TEST_DEFAULT_SAMPLES_PER_FRAME;
+       const int         streamBytes = numFrames*frameSize;
+       OsStatus          res;
+       int               i;
+       int               leg;
+
+       // Talkers 0 and 1 go to the sink, the listeners are encoded and sent
+       // over loopback sockets like call legs.
+       MprBridge* pBridge = new MprBridge("MprBridge", numParticipants);
+       mpSourceResource = new MpTestResource("SourceResource", 0, 0,
+                                             numParticipants, numParticipants);
+       mpSinkResource = new MpTestResource("SinkResource", 2, 2, 0, 0);
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->addResource(*mpSourceResource));
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->addResource(*pBridge));
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->addResource(*mpSinkResource));
+       for (i=0; i<numParticipants; i++)
+       {
+          res = mpFlowGraph->addLink(*mpSourceResource, i, *pBridge, i);
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, res);
+       }
+       for (i=0; i<2; i++)
+       {
+          res = mpFlowGraph->addLink(*pBridge, i, *mpSinkResource, i);
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, res);
+       }
+       mpSourceResource->setProcessInBufMask(0x0);
+       mpSinkResource->setProcessInBufMask(0x03);
+       mpSinkResource->setGenOutBufMask(0x0);
+
+       OsDatagramSocket* pReceivers[numLegs];
+       OsDatagramSocket* pSenders[numLegs];
+       MprToNet* pToNets[numLegs];
+       MprEncode* pEncoders[numLegs];
+       for (leg=0; leg<numLegs; leg++)
+       {
+          pReceivers[leg] = new OsDatagramSocket(0, NULL, 0, "127.0.0.1");
+          CPPUNIT_ASSERT(pReceivers[leg]->isOk());
+          pSenders[leg] = new OsDatagramSocket(pReceivers[leg]->getLocalHostPort(),
+                                               "127.0.0.1", 0, "127.0.0.1");
+          CPPUNIT_ASSERT(pSenders[leg]->isOk());
+          pToNets[leg] = new MprToNet();
+          pToNets[leg]->setSockets(*pSenders[leg], *pSenders[leg]);
+
+          UtlString name;
+          name.appendFormat("Encode%d", leg);
+          pEncoders[leg] = new MprEncode(name);
+          pEncoders[leg]->setMyToNet(pToNets[leg]);
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->addResource(*pEncoders[leg]));
+          res = mpFlowGraph->addLink(*pBridge, 2+leg, *pEncoders[leg], 0);
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, res);
+       }
+
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->start());
+
+       // Packet time is applied when the codec is selected.
+       SdpCodec pcmu(SdpCodec::SDP_CODEC_PCMU,
+                     SdpCodec::SDP_CODEC_PCMU,
+                     MIME_TYPE_AUDIO,
+                     MIME_SUBTYPE_PCMU,
+                     8000,
+                     20000,
+                     1,
+                     "",
+                     SdpCodec::SDP_CODEC_CPU_LOW,
+                     SDP_CODEC_BANDWIDTH_NORMAL);
+       OsMsgQ& fgQ = *mpFlowGraph->getMsgQ();
+       for (leg=0; leg<numLegs; leg++)
+       {
+          UtlString name(pEncoders[leg]->getName());
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+             MprEncode::setMaxPacketTime(name, fgQ, legPacketTimes[leg]));
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+             MprEncode::enableDtx(name, fgQ, FALSE));
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+             MprEncode::selectCodecs(name, fgQ, &pcmu, NULL));
+          CPPUNIT_ASSERT(pEncoders[leg]->enable());
+       }
+
+       CPPUNIT_ASSERT(mpSinkResource->enable());
+       CPPUNIT_ASSERT(mpSourceResource->enable());
+       mpSourceResource->setOutSignalType(MpTestResource::MP_TEST_SIGNAL_SQUARE);
+       mpSourceResource->setSignalPeriod(0, 2);
+       mpSourceResource->setSignalAmplitude(0, 100);
+       mpSourceResource->setSignalPeriod(1, 4);
+       mpSourceResource->setSignalAmplitude(1, 200);
+       mpSourceResource->setGenOutBufMask(0x03);
+       CPPUNIT_ASSERT(pBridge->enable());
+
+       MpEncodedFrameCache* pCache = mpFlowGraph->getEncodedFrameCache();
+       const int hitsBefore = pCache->getHits();
+       const int storesBefore = pCache->getStores();
+       for (i=0; i<numFrames; i++)
+       {
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, mpFlowGraph->processNextFrame());
+       }
+
+       // The legs with the same packet time share one encoding of each
+       // frame, the one with another packet time encodes on its own.
+       CPPUNIT_ASSERT_EQUAL(2*numFrames, pCache->getHits() - hitsBefore);
+       CPPUNIT_ASSERT_EQUAL(2*numFrames, pCache->getStores() - storesBefore);
+
+       // Every frame of the mix, encoded on its own.
+       MpEncoderBase* pEncoder = NULL;
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+          MpCodecFactory::getMpCodecFactory()->createEncoder("PCMU", "", 8000,
+                                                             1, 0, pEncoder));
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pEncoder->initEncode());
+       MpAudioSample mix[frameSize];
+       for (i=0; i<frameSize; i++)
+       {
+          mix[i] = mpSourceResource->getSquareSampleValue(0, i) +
+                   mpSourceResource->getSquareSampleValue(1, i);
+       }
+       unsigned char expected[streamBytes];
+       for (i=0; i<numFrames; i++)
+       {
+          int consumed;
+          int encodedBytes;
+          UtlBoolean isPacketReady;
+          UtlBoolean isPacketSilent;
+          UtlBoolean setMarkerBit;
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                               pEncoder->encode(mix, frameSize, consumed,
+                                                expected + i*frameSize,
+                                                frameSize, encodedBytes,
+                                                isPacketReady, isPacketSilent,
+                                                setMarkerBit));
+          CPPUNIT_ASSERT_EQUAL(frameSize, encodedBytes);
+       }
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pEncoder->freeEncode());
+       delete pEncoder;
+
+       // Each leg sends the stream in packets of its own packet time.
+       for (leg=0; leg<numLegs; leg++)
+       {
+          const int packetBytes = legPacketTimes[leg]*8;
+          unsigned char received[streamBytes];
+          char packet[sizeof(RtpHeader) + streamBytes];
+          int receivedBytes = 0;
+          int numPackets = 0;
+          while (pReceivers[leg]->isReadyToRead(100))
+          {
+             int bytes = pReceivers[leg]->read(packet, sizeof(packet));
+             CPPUNIT_ASSERT_EQUAL((int)sizeof(RtpHeader) + packetBytes, bytes);
+             CPPUNIT_ASSERT(receivedBytes + packetBytes <= streamBytes);
+             memcpy(received + receivedBytes, packet + sizeof(RtpHeader),
+                    packetBytes);
+             receivedBytes += packetBytes;
+             numPackets++;
+          }
+          CPPUNIT_ASSERT_EQUAL(streamBytes/packetBytes, numPackets);
+          CPPUNIT_ASSERT_EQUAL(streamBytes, receivedBytes);
+          CPPUNIT_ASSERT(memcmp(expected, received, streamBytes) == 0);
+       }
+
+       // Stop flowgraph
+       haltFramework();
+       for (leg=0; leg<numLegs; leg++)
+       {
+          pToNets[leg]->resetSockets();
+          delete pToNets[leg];
+          delete pSenders[leg];
+          delete pReceivers[leg];
+       }
+   }
+
+   void testActiveSpeakerLimit()
+   {
+       const int         numParticipants = 6;
+       const int         hangover = MpBridgeAlgLinear::SPEAKER_HANGOVER_FRAMES;
+       MprBridge*        pBridge    = NULL;
+       int               i;
+
+       pBridge = new MprBridge("MprBridge", numParticipants, TRUE,
+                               MprBridge::ALG_LINEAR, 2);
+       CPPUNIT_ASSERT(pBridge != NULL);
+
+       setupFramework(pBridge);
+
+       // As in testMixNormalWeights() each input is 2**N, so the output
+       // is a bit mask of the inputs mixed to it. Inputs 1 and 3 are the
+       // loudest.
+       CPPUNIT_ASSERT(mpSourceResource->enable());
+       mpSourceResource->setOutSignalType(MpTestResource::MP_TEST_SIGNAL_SQUARE);
+       const int energies[numParticipants] = {10, 300, 10, 500, 100, 10};
+       for (i=0; i<numParticipants; i++)
+       {
+          mpSourceResource->setSignalPeriod(i, 2);
+          mpSourceResource->setSignalAmplitude(i, 1<<i);
+          mpSourceResource->setFrameEnergy(i, energies[i]);
+       }
+       CPPUNIT_ASSERT(pBridge->enable());
+
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                            mpFlowGraph->processNextFrame());
+
+       // The talkers hear each other, the others hear both of them.
+       checkOutputMix(1, 1<<3);
+       checkOutputMix(3, 1<<1);
+       checkListenersMix(numParticipants, 1, 3);
+
+       // Input 1 pauses and input 4 starts talking. Input 1 keeps its place
+       // for the hangover time.
+       mpSourceResource->setSpeechType(1, MP_SPEECH_SILENT);
+       mpSourceResource->setFrameEnergy(1, 0);
+       mpSourceResource->setFrameEnergy(4, 1000);
+       for (i=0; i<hangover; i++)
+       {
+          CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                               mpFlowGraph->processNextFrame());
+       }
+       checkOutputMix(1, 1<<3);
+       checkOutputMix(3, 1<<1);
+       checkListenersMix(numParticipants, 1, 3);
+
+       // Then input 4 takes its place.
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                            mpFlowGraph->processNextFrame());
+       checkOutputMix(3, 1<<4);
+       checkOutputMix(4, 1<<3);
+       checkListenersMix(numParticipants, 3, 4);
+
+       // A muted talker gives its place up at once.
+       mpSourceResource->setSpeechType(4, MP_SPEECH_MUTED);
+       mpSourceResource->setSpeechType(1, MP_SPEECH_ACTIVE);
+       mpSourceResource->setFrameEnergy(1, 300);
+       CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                            mpFlowGraph->processNextFrame());
+       checkOutputMix(1, 1<<3);
+       checkOutputMix(3, 1<<1);
+       checkListenersMix(numParticipants, 1, 3);
+
+       // Stop flowgraph
+       haltFramework();
+   }
+
+   void testActiveSpeakerMixPerformance()
+   {
+       const int numParticipants = 30;
+       const int maxActiveSpeakers = 3;
+
+       OsTime allInputs = mixLargeConference(numParticipants, 0);
+
+       tearDown();
+       setUp();
+       OsTime loudestInputs = mixLargeConference(numParticipants,
+                                                 maxActiveSpeakers);
+
+       printf("mix %d participants: all inputs %ld.%06ld, "
+              "%d loudest inputs %ld.%06ld\n",
+              numParticipants,
+              allInputs.seconds(), allInputs.usecs(),
+              maxActiveSpeakers,
+              loudestInputs.seconds(), loudestInputs.usecs());
+   }
+
    void testSimpleMixPerformance()
    {
        const int         numParticipants = 8;
@@ -565,6 +911,112 @@ public:
          testSideBar();
       }
    } // end testWBCommonTests()
+
+protected:
+
+     /// Check that output carries the bit mask of the inputs mixed to it.
+   void checkOutputMix(int output, MpAudioSample mask)
+   {
+      MpAudioBufPtr pBuf = mpSinkResource->mLastDoProcessArgs.inBufs[output];
+      CPPUNIT_ASSERT(pBuf.isValid());
+      const MpAudioSample* pSamples = pBuf->getSamplesPtr();
+      for (unsigned i=0; i<pBuf->getSamplesNumber(); i+=2)
+      {
+         CPPUNIT_ASSERT_EQUAL(mask, pSamples[i]);
+         CPPUNIT_ASSERT_EQUAL((MpAudioSample)-mask, pSamples[i+1]);
+      }
+   }
+
+     /// Check that all but the two talkers get the same mix of both of them.
+   void checkListenersMix(int numParticipants, int talker1, int talker2)
+   {
+      MpBufPtr pMix;
+      for (int output=0; output<numParticipants; output++)
+      {
+         if (output == talker1 || output == talker2)
+         {
+            continue;
+         }
+         checkOutputMix(output, (1<<talker1) + (1<<talker2));
+         if (pMix.isValid())
+         {
+            CPPUNIT_ASSERT(mpSinkResource->mLastDoProcessArgs.inBufs[output] == pMix);
+         }
+         else
+         {
+            pMix = mpSinkResource->mLastDoProcessArgs.inBufs[output];
+         }
+      }
+   }
+
+     /// Mix a conference with three talkers and return time it took.
+   OsTime mixLargeConference(int numParticipants, int maxActiveSpeakers)
+   {
+      const int  talkers[] = {5, 17, 28};
+      const int  framesToProcess = 1000;
+      MprBridge* pBridge = NULL;
+      int        i;
+
+      pBridge = new MprBridge("MprBridge", numParticipants, TRUE,
+                              MprBridge::ALG_LINEAR, maxActiveSpeakers);
+      CPPUNIT_ASSERT(pBridge != NULL);
+
+      setupFramework(pBridge);
+
+      // Everybody sends some noise, three of them talk.
+      CPPUNIT_ASSERT(mpSourceResource->enable());
+      mpSourceResource->setOutSignalType(MpTestResource::MP_TEST_SIGNAL_SQUARE);
+      for (i=0; i<numParticipants; i++)
+      {
+         mpSourceResource->setSignalPeriod(i, 2);
+         mpSourceResource->setSignalAmplitude(i, 1);
+         mpSourceResource->setFrameEnergy(i, 10+i);
+      }
+      for (i=0; i<3; i++)
+      {
+         mpSourceResource->setSignalAmplitude(talkers[i], 64<<i);
+         mpSourceResource->setFrameEnergy(talkers[i], 10000);
+      }
+      CPPUNIT_ASSERT(pBridge->enable());
+
+      // Let flowgraph process all messages before we'll start
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           mpFlowGraph->processNextFrame());
+
+      OsTime start;
+      OsTime end;
+      OsDateTime::getCurTime(start);
+      for (i=0; i<framesToProcess; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              mpFlowGraph->processNextFrame());
+      }
+      OsDateTime::getCurTime(end);
+
+      if (maxActiveSpeakers > 0)
+      {
+         // Talkers hear the other talkers only, the others hear all three.
+         const int allTalkers = 64 + 128 + 256;
+         for (i=0; i<3; i++)
+         {
+            checkOutputMix(talkers[i], allTalkers - (64<<i));
+         }
+         checkOutputMix(0, allTalkers);
+         CPPUNIT_ASSERT(mpSinkResource->mLastDoProcessArgs.inBufs[0] ==
+                        mpSinkResource->mLastDoProcessArgs.inBufs[numParticipants-1]);
+      }
+      else
+      {
+         // Everybody hears everybody else.
+         checkOutputMix(0, 64 + 128 + 256 + numParticipants - 4);
+         checkOutputMix(talkers[0], 128 + 256 + numParticipants - 3);
+      }
+
+      // Stop flowgraph
+      haltFramework();
+
+      return end - start;
+   }
 };
 
 
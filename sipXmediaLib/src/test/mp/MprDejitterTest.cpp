@@ -0,0 +1,209 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <os/OsIntTypes.h>
+
+#include <sipxunittests.h>
+
+#include <mp/MpBuf.h>
+#include <mp/MpArrayBuf.h>
+#include <mp/MpRtpBuf.h>
+#include <mp/MprDejitter.h>
+
+#define RTP_PAYLOAD_SIZE   160
+#define RTP_BUFFERS_NUM    (2*MprDejitter::MAX_RTP_PACKETS)
+
+/**
+ * Unittest for MprDejitter
+ */
+class MprDejitterTest : public SIPX_UNIT_BASE_CLASS
+{
+   CPPUNIT_TEST_SUITE(MprDejitterTest);
+   CPPUNIT_TEST(testReordering);
+   CPPUNIT_TEST(testWrapAround);
+   CPPUNIT_TEST(testLatePackets);
+   CPPUNIT_TEST(testSequenceJump);
+   CPPUNIT_TEST(testTimestampLock);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+   void setUp()
+   {
+      mpPool = new MpBufPool(RTP_PAYLOAD_SIZE + MpArrayBuf::getHeaderSize(),
+                             RTP_BUFFERS_NUM, "MprDejitterTest");
+      CPPUNIT_ASSERT(mpPool != NULL);
+
+      mpHeadersPool = new MpBufPool(sizeof(MpRtpBuf), RTP_BUFFERS_NUM,
+                                    "MprDejitterTestHeaders");
+      CPPUNIT_ASSERT(mpHeadersPool != NULL);
+
+      MpRtpBuf::smpDefaultPool = mpHeadersPool;
+   }
+
+   void tearDown()
+   {
+      if (mpPool != NULL)
+      {
+         delete mpPool;
+      }
+      if (mpHeadersPool != NULL)
+      {
+         delete mpHeadersPool;
+      }
+   }
+
+   void testReordering()
+   {
+      MprDejitter dejitter;
+      const RtpSeq seqs[] = {10, 12, 11, 14, 13, 15};
+      const int numSeqs = sizeof(seqs)/sizeof(seqs[0]);
+
+      for (int i=0; i<numSeqs; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, seqs[i]));
+      }
+      CPPUNIT_ASSERT_EQUAL(numSeqs, dejitter.getNumPackets());
+
+      for (int i=0; i<numSeqs; i++)
+      {
+         UtlBoolean nextAvailable = FALSE;
+         MpRtpBufPtr pRtp = dejitter.pullPacket(0, &nextAvailable, false);
+         CPPUNIT_ASSERT(pRtp.isValid());
+         CPPUNIT_ASSERT_EQUAL(RtpSeq(10+i), pRtp->getRtpSequenceNumber());
+         CPPUNIT_ASSERT_EQUAL(i < numSeqs-1, nextAvailable == TRUE);
+      }
+      CPPUNIT_ASSERT(!dejitter.pullPacket().isValid());
+      CPPUNIT_ASSERT_EQUAL(0, dejitter.getNumPackets());
+   }
+
+   void testWrapAround()
+   {
+      MprDejitter dejitter;
+      RtpSeq firstSeq;
+      RtpTimestamp firstTime;
+
+      CPPUNIT_ASSERT_EQUAL(OS_FAILED,
+                           dejitter.getFirstPacketInfo(firstSeq, firstTime));
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 1));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 65535));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 0));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 65534));
+
+      // First packet info must match the packet pullPacket() will return.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           dejitter.getFirstPacketInfo(firstSeq, firstTime));
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(65534), firstSeq);
+      CPPUNIT_ASSERT_EQUAL(RtpTimestamp(65534*RTP_PAYLOAD_SIZE), firstTime);
+
+      const RtpSeq expected[] = {65534, 65535, 0, 1};
+      for (int i=0; i<4; i++)
+      {
+         MpRtpBufPtr pRtp = dejitter.pullPacket();
+         CPPUNIT_ASSERT(pRtp.isValid());
+         CPPUNIT_ASSERT_EQUAL(expected[i], pRtp->getRtpSequenceNumber());
+      }
+      CPPUNIT_ASSERT(!dejitter.pullPacket().isValid());
+   }
+
+   void testLatePackets()
+   {
+      MprDejitter dejitter;
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 100));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 102));
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(100), dejitter.pullPacket()->getRtpSequenceNumber());
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(102), dejitter.pullPacket()->getRtpSequenceNumber());
+
+      // Packet 101 arrived after 102 was pulled - it is late, but still
+      // delivered to the codec.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 101));
+      CPPUNIT_ASSERT_EQUAL(0, dejitter.getNumPackets());
+      CPPUNIT_ASSERT_EQUAL(1, dejitter.getNumLatePackets());
+
+      // Duplicate is discarded.
+      CPPUNIT_ASSERT_EQUAL(OS_FAILED, pushPacket(dejitter, 101));
+      CPPUNIT_ASSERT_EQUAL(1, dejitter.getNumLatePackets());
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 103));
+      CPPUNIT_ASSERT_EQUAL(1, dejitter.getNumPackets());
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(101), dejitter.pullPacket()->getRtpSequenceNumber());
+      CPPUNIT_ASSERT_EQUAL(0, dejitter.getNumLatePackets());
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(103), dejitter.pullPacket()->getRtpSequenceNumber());
+      CPPUNIT_ASSERT_EQUAL(0, dejitter.getNumPackets());
+   }
+
+   void testSequenceJump()
+   {
+      MprDejitter dejitter;
+      const int numPackets = 8;
+
+      for (int i=0; i<numPackets; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 1000+i));
+      }
+      // Packets after the jump do not fit into the ring window together
+      // with the old ones, but must be ordered properly anyway.
+      for (int i=0; i<numPackets; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 1300+numPackets-i));
+      }
+      // Packet with the same ring index as 1000 and newer overwrites it.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pushPacket(dejitter, 1000+MprDejitter::MAX_RTP_PACKETS));
+      CPPUNIT_ASSERT_EQUAL(2*numPackets, dejitter.getNumPackets());
+
+      RtpSeq prevSeq = 1000;
+      for (int i=0; i<2*numPackets; i++)
+      {
+         MpRtpBufPtr pRtp = dejitter.pullPacket();
+         CPPUNIT_ASSERT(pRtp.isValid());
+         CPPUNIT_ASSERT(pRtp->getRtpSequenceNumber() > prevSeq);
+         prevSeq = pRtp->getRtpSequenceNumber();
+      }
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(1300+numPackets), prevSeq);
+      CPPUNIT_ASSERT(!dejitter.pullPacket().isValid());
+
+      // Ring works normally after it has been drained.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 1310));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 1309));
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(1309), dejitter.pullPacket()->getRtpSequenceNumber());
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(1310), dejitter.pullPacket()->getRtpSequenceNumber());
+   }
+
+   void testTimestampLock()
+   {
+      MprDejitter dejitter;
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 5));
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, pushPacket(dejitter, 6));
+
+      CPPUNIT_ASSERT(!dejitter.pullPacket(5*RTP_PAYLOAD_SIZE-1).isValid());
+      CPPUNIT_ASSERT_EQUAL(2, dejitter.getNumPackets());
+
+      MpRtpBufPtr pRtp = dejitter.pullPacket(5*RTP_PAYLOAD_SIZE);
+      CPPUNIT_ASSERT(pRtp.isValid());
+      CPPUNIT_ASSERT_EQUAL(RtpSeq(5), pRtp->getRtpSequenceNumber());
+      CPPUNIT_ASSERT(!dejitter.pullPacket(5*RTP_PAYLOAD_SIZE).isValid());
+      CPPUNIT_ASSERT(dejitter.pullPacket(6*RTP_PAYLOAD_SIZE).isValid());
+   }
+
+protected:
+   MpBufPool *mpPool;         ///< Pool for data buffers
+   MpBufPool *mpHeadersPool;  ///< Pool for buffers headers
+
+   OsStatus pushPacket(MprDejitter &dejitter, RtpSeq seq)
+   {
+      MpRtpBufPtr pRtp = mpPool->getBuffer();
+      CPPUNIT_ASSERT(pRtp.isValid());
+      pRtp->setRtpSequenceNumber(seq);
+      pRtp->setRtpTimestamp(seq*RTP_PAYLOAD_SIZE);
+      return dejitter.pushPacket(pRtp);
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MprDejitterTest);
@@ -12,8 +12,11 @@
 #include <sipxunittests.h>
 #include <sipxunit/TestUtilities.h>
 
+#include <os/OsFS.h>
+
 #include <mp/MprFromFile.h>
 #include <mp/MpDTMFDetector.h>
+#include <mp/MpPromptCache.h>
 #include "mp/MpGenericResourceTest.h"
 
 // Include static wave data headers.
@@ -21,6 +24,7 @@
 // $ incbin.exe file.raw dtmf5_48kHz_16b_signed.h -n=dtmf5_48kHz_16b_signed -c=13 -d -h
 #include "mp/dtmf5_48khz_16b_signed.h"
 #define DTMF5_FN "dtmf5_48khz_16b_signed.wav"
+#define PROMPT_CACHE_TEST_DIR "promptCacheTest"
 
 /**
 * Unittest for Wide band support in input and output device driver
@@ -30,6 +34,9 @@ class MprFromFileTest : public MpGenericResourceTest
    CPPUNIT_TEST_SUITE(MprFromFileTest);
    CPPUNIT_TEST(testFileToneDetect);
    CPPUNIT_TEST(testBufferToneDetect);
+   CPPUNIT_TEST(testCachedFileToneDetect);
+   CPPUNIT_TEST(testPromptCacheLru);
+   CPPUNIT_TEST(testPromptCacheStore);
    CPPUNIT_TEST_SUITE_END();
 
 
@@ -78,6 +85,147 @@ public:
       }
    }
 
+   // Play file through the prompt cache and check that the second request
+   // for the same file is served from the cache.
+   void testCachedFileToneDetect()
+   {
+      MpPromptCache::setMaxSize(1024*1024);
+
+      int rateIdx;
+      for (rateIdx = 0; rateIdx < sNumRates; rateIdx++)
+      {
+         printf("Test cached playFile %d Hz\n", sSampleRates[rateIdx]);
+         tearDown();
+         setSamplesPerSec(sSampleRates[rateIdx]);
+         setSamplesPerFrame(sSampleRates[rateIdx]/100);
+         setUp();
+         testPlayToneDetectHelper(MpfftFile, sSampleRates[rateIdx], sSampleRates[rateIdx]/100);
+
+         MpPromptCache* pCache = MpPromptCache::getPromptCache();
+         CPPUNIT_ASSERT_EQUAL(1, pCache->getNumMisses());
+         CPPUNIT_ASSERT_EQUAL(1, pCache->getNumPrompts());
+         size_t expectedSize = sSampleRates[rateIdx] *
+                               dtmf5_48khz_16b_signed_in_bytes / 48000;
+         CPPUNIT_ASSERT_EQUAL(expectedSize, pCache->getCachedSize());
+
+         // Loader must not be called again.
+         MpPromptCache::Prompt* pPrompt = NULL;
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pCache->acquire(DTMF5_FN, sSampleRates[rateIdx],
+                                              failingLoader, pPrompt));
+         CPPUNIT_ASSERT_EQUAL(1, pCache->getNumHits());
+         CPPUNIT_ASSERT(pPrompt != NULL);
+         if (pPrompt)
+         {
+            CPPUNIT_ASSERT_EQUAL(expectedSize, (size_t)pPrompt->getDataSize());
+            pPrompt->release();
+         }
+      }
+
+      MpPromptCache::setMaxSize(0);
+   }
+
+   // Check that unreferenced prompts are freed in least recently used order.
+   void testPromptCacheLru()
+   {
+      const int numFiles = 3;
+      const unsigned promptSize = 1000;
+      UtlString fileNames[numFiles];
+      MpPromptCache::Prompt* pPrompts[numFiles];
+      int i;
+
+      MpPromptCache::setMaxSize(promptSize*5/2);
+      MpPromptCache* pCache = MpPromptCache::getPromptCache();
+
+      for (i = 0; i < numFiles; i++)
+      {
+         fileNames[i].appendFormat("promptCacheTest%d.raw", i);
+         createTestFile(fileNames[i]);
+         CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                              pCache->acquire(fileNames[i], 8000,
+                                              fixedSizeLoader, pPrompts[i]));
+      }
+      // Referenced prompts are kept even above the limit.
+      CPPUNIT_ASSERT_EQUAL(numFiles, pCache->getNumPrompts());
+      CPPUNIT_ASSERT_EQUAL((size_t)promptSize*numFiles, pCache->getCachedSize());
+
+      for (i = 0; i < numFiles; i++)
+      {
+         pPrompts[i]->release();
+      }
+      pCache->trim();
+      CPPUNIT_ASSERT_EQUAL(2, pCache->getNumPrompts());
+
+      // File 0 was the oldest one, so it must be loaded again and file 1
+      // is freed instead.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pCache->acquire(fileNames[0], 8000,
+                                           fixedSizeLoader, pPrompts[0]));
+      CPPUNIT_ASSERT_EQUAL(numFiles+1, pCache->getNumMisses());
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           pCache->acquire(fileNames[2], 8000,
+                                           failingLoader, pPrompts[2]));
+      CPPUNIT_ASSERT_EQUAL(1, pCache->getNumHits());
+      CPPUNIT_ASSERT_EQUAL(OS_FAILED,
+                           pCache->acquire(fileNames[1], 8000,
+                                           failingLoader, pPrompts[1]));
+      pPrompts[0]->release();
+      pPrompts[2]->release();
+
+      // Other rate is a different prompt.
+      CPPUNIT_ASSERT_EQUAL(OS_FAILED,
+                           pCache->acquire(fileNames[0], 16000,
+                                           failingLoader, pPrompts[0]));
+
+      MpPromptCache::setMaxSize(0);
+      CPPUNIT_ASSERT_EQUAL(0, pCache->getNumPrompts());
+      CPPUNIT_ASSERT_EQUAL((size_t)0, pCache->getCachedSize());
+      MpPromptCache::destroyPromptCache();
+
+      for (i = 0; i < numFiles; i++)
+      {
+         OsFileSystem::remove(fileNames[i].data());
+      }
+   }
+
+   // Check that converted audio is mapped from the on-disk store after
+   // the cache is recreated.
+   void testPromptCacheStore()
+   {
+      UtlString fileName("promptCacheTestStore.raw");
+      MpPromptCache::Prompt* pPrompt = NULL;
+
+      OsFileSystem::remove(PROMPT_CACHE_TEST_DIR, TRUE, TRUE);
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           OsFileSystem::createDir(PROMPT_CACHE_TEST_DIR));
+      createTestFile(fileName);
+      MpPromptCache::setMaxSize(1024*1024);
+      MpPromptCache::setCacheDirectory(PROMPT_CACHE_TEST_DIR);
+
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           MpPromptCache::getPromptCache()->acquire(fileName, 8000,
+                                                                    fixedSizeLoader,
+                                                                    pPrompt));
+      checkFixedSizePrompt(pPrompt);
+      pPrompt->release();
+      MpPromptCache::destroyPromptCache();
+
+#ifdef __pingtel_on_posix__ // [
+      // Loader must not be called - audio comes from the store.
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                           MpPromptCache::getPromptCache()->acquire(fileName, 8000,
+                                                                    failingLoader,
+                                                                    pPrompt));
+      checkFixedSizePrompt(pPrompt);
+      pPrompt->release();
+      MpPromptCache::destroyPromptCache();
+#endif // __pingtel_on_posix__ ]
+
+      MpPromptCache::setCacheDirectory("");
+      MpPromptCache::setMaxSize(0);
+      OsFileSystem::remove(fileName.data());
+      OsFileSystem::remove(PROMPT_CACHE_TEST_DIR, TRUE, TRUE);
+   }
 
    /**
    *  @brief Test MprFromFile file or buffer playing at a given samples per 
@@ -197,6 +345,42 @@ public:
 
 protected:
 
+   static OsStatus failingLoader(uint32_t sampleRate, UtlString*& pAudioBuffer,
+                                 const char* fileName)
+   {
+      return OS_FAILED;
+   }
+
+   static OsStatus fixedSizeLoader(uint32_t sampleRate, UtlString*& pAudioBuffer,
+                                   const char* fileName)
+   {
+      pAudioBuffer = new UtlString();
+      for (int i = 0; i < 1000; i++)
+      {
+         pAudioBuffer->append((char)i);
+      }
+      return OS_SUCCESS;
+   }
+
+   void checkFixedSizePrompt(MpPromptCache::Prompt* pPrompt)
+   {
+      CPPUNIT_ASSERT(pPrompt != NULL);
+      CPPUNIT_ASSERT_EQUAL(1000u, pPrompt->getDataSize());
+      for (int i = 0; i < 1000; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL((char)i, pPrompt->getData()[i]);
+      }
+   }
+
+   void createTestFile(const UtlString& fileName)
+   {
+      OsFile file(fileName);
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, file.open(OsFile::CREATE));
+      unsigned long bytesWritten = 0;
+      CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, file.write("test", 4, bytesWritten));
+      file.close();
+   }
+
    static int sSampleRates[];
    static int sNumRates;
 
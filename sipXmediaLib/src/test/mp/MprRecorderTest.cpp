@@ -15,8 +15,13 @@
 #include <os/OsFileBase.h>
 #include <mp/MprRecorder.h>
 #include <mp/MprnIntMsg.h>
+#include <mp/MpRecorderWriter.h>
 #include <mp/MpGenericResourceTest.h>
 
+#ifdef __pingtel_on_posix__
+#  include <unistd.h>
+#endif
+
 MprRecorder::RecordFileFormat testFileTypes[] =
 {
      MprRecorder::RAW_PCM_16,
@@ -44,6 +49,10 @@ class MprRecorderTest : public MpGenericResourceTest
     CPPUNIT_TEST(testRecordToFileAppend);
     CPPUNIT_TEST(testRecordChannelToFileAppend);
     CPPUNIT_TEST(testRecordToPauseResumeFile);
+    CPPUNIT_TEST(testRecordToFileAsync);
+#ifdef __pingtel_on_posix__
+    CPPUNIT_TEST(testAsyncCloseOnFullQueue);
+#endif
     CPPUNIT_TEST_SUITE_END();
 
     void testRecordToBadFile()
@@ -1411,6 +1420,240 @@ class MprRecorderTest : public MpGenericResourceTest
 
     } // end testRecordToPauseResumeFile method
 
+    void testRecordToFileAsync()
+    {
+        // GSM is left out as frame sizes do not depend on the writer.
+        MprRecorder::RecordFileFormat asyncFileTypes[] =
+        {
+             MprRecorder::RAW_PCM_16,
+             MprRecorder::WAV_PCM_16,
+             MprRecorder::WAV_ALAW,
+             MprRecorder::WAV_MULAW
+        };
+        int numberOfTestFileTypes = sizeof(asyncFileTypes) / sizeof(MprRecorder::RecordFileFormat);
+        int framesPerSecond = 100; // 10 mSec frames
+        int framesToProcess = 300; // 3 seconds
+
+        MprRecorder::setAsyncFileWrite(TRUE);
+
+        for(int fileTypeIndex = 0; fileTypeIndex < numberOfTestFileTypes; fileTypeIndex++)
+        {
+            MprRecorder::RecordFileFormat fileFormat = asyncFileTypes[fileTypeIndex];
+            unsigned int rateIndex;
+            for(rateIndex = 0; rateIndex < sNumRates; rateIndex++)
+            {
+                UtlString loopLabel;
+                loopLabel.appendFormat("format: %d rate: %d",
+                                       fileFormat,
+                                       sSampleRates[rateIndex]);
+
+                UtlString recordFilename;
+                recordFilename.appendFormat("testRecordToFileAsync%d_%d.%s",
+                                            sSampleRates[rateIndex],
+                                            fileFormat,
+                                            fileFormat == MprRecorder::RAW_PCM_16 ? "raw" : "wav");
+                // Incase prior test left junk around
+                tearDown();
+
+                // Set media sample rate
+                setSamplesPerSec(sSampleRates[rateIndex]);
+                setSamplesPerFrame(sSampleRates[rateIndex]/framesPerSecond);
+                setUp();
+                int32_t overflowCount = MpRecorderWriter::getOverflowCount();
+
+                UtlString recorderResourceName = "MprRecorder";
+                MprRecorder* recorder = new MprRecorder(recorderResourceName);
+                CPPUNIT_ASSERT(recorder);
+
+                // Build flowgraph with source, MprRecorder and sink resources
+                setupFramework(recorder);
+
+                // Add the notifier so that we get resource events
+                OsMsgQ resourceEventQueue;
+                OsMsgDispatcher messageDispatcher(&resourceEventQueue);
+                mpFlowGraph->setNotificationDispatcher(&messageDispatcher);
+
+                // Start recording
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                                     MprRecorder::startFile(recorderResourceName,
+                                                            *mpFlowGraph->getMsgQ(),
+                                                            recordFilename,
+                                                            fileFormat));
+
+                // Enable the source resource and the recorder
+                CPPUNIT_ASSERT(mpSourceResource->enable());
+                CPPUNIT_ASSERT(recorder->enable());
+
+                // Process the frames
+                OsStatus frameStatus;
+                for(int frameIndex = 0; frameIndex < framesToProcess; frameIndex++)
+                {
+                    frameStatus = mpFlowGraph->processNextFrame();
+                    CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, frameStatus);
+                }
+
+                int samplesRecorded = 
+                    sSampleRates[rateIndex] / framesPerSecond * // samples/frame
+                    framesToProcess; // frames
+
+                // Send message to stop the recording
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                                     MprRecorder::stop(recorderResourceName,
+                                                       *mpFlowGraph->getMsgQ()));
+
+                // Process one more frame to be sure recording stop message is handled
+                frameStatus = mpFlowGraph->processNextFrame();
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, frameStatus);
+
+                // Notifications are posted by the writer task, so wait for them.
+                OsTime notificationWait(5, 0);
+                OsMsg* messagePtr = NULL;
+                messageDispatcher.receive(messagePtr, notificationWait);
+                CPPUNIT_ASSERT(messagePtr);
+                if(messagePtr)
+                {
+                    CPPUNIT_ASSERT_EQUAL(messagePtr->getMsgType(), OsMsg::MP_RES_NOTF_MSG);
+                    CPPUNIT_ASSERT_EQUAL(messagePtr->getMsgSubType(), MpResNotificationMsg::MPRNM_RECORDER_STARTED);
+                }
+
+                messagePtr = NULL;
+                messageDispatcher.receive(messagePtr, notificationWait);
+                CPPUNIT_ASSERT(messagePtr);
+                if(messagePtr)
+                {
+                    CPPUNIT_ASSERT_EQUAL(messagePtr->getMsgType(), OsMsg::MP_RES_NOTF_MSG);
+                    CPPUNIT_ASSERT_EQUAL(messagePtr->getMsgSubType(), MpResNotificationMsg::MPRNM_RECORDER_STOPPED);
+                    MprnIntMsg* stopMessage = (MprnIntMsg*) messagePtr;
+                    CPPUNIT_ASSERT_EQUAL(stopMessage->getValue(), samplesRecorded);
+                }
+
+                // Stop notification is posted only after the file has been
+                // written and closed, so it must be complete now.
+                unsigned long headerSize = 0;
+                unsigned long audioDataSize = 0;
+                switch(fileFormat)
+                {
+                    case MprRecorder::WAV_ALAW:
+                    case MprRecorder::WAV_MULAW:
+                        headerSize = 44;
+                        audioDataSize = samplesRecorded * 8000 / sSampleRates[rateIndex];
+                        break;
+
+                    case MprRecorder::WAV_PCM_16:
+                        headerSize = 44;
+                    case MprRecorder::RAW_PCM_16:
+                        audioDataSize = samplesRecorded * sizeof(MpAudioSample);
+                    break;
+
+                    default:
+                        CPPUNIT_ASSERT(0);  // Unsupported record file format type
+                    break;
+                }
+
+                OsFile recordFile(recordFilename);
+                OsFileInfo fileInfo;
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                                     recordFile.getFileInfo(fileInfo));
+                unsigned long recordedFileSize;
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                                     fileInfo.getSize(recordedFileSize));
+                CPPUNIT_ASSERT_EQUAL_MESSAGE(loopLabel.data(), 
+                                             headerSize + audioDataSize, 
+                                             recordedFileSize);
+
+                if(headerSize > 0)
+                {
+                    // WAV header must have been updated with the data length.
+                    unsigned char header[44];
+                    unsigned long bytesRead = 0;
+                    CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, recordFile.open(OsFile::READ_ONLY));
+                    CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, recordFile.read(header, sizeof(header), bytesRead));
+                    CPPUNIT_ASSERT_EQUAL((unsigned long)sizeof(header), bytesRead);
+                    recordFile.close();
+                    unsigned long dataLength = header[40] | (header[41] << 8) |
+                                               (header[42] << 16) | (header[43] << 24);
+                    CPPUNIT_ASSERT_EQUAL_MESSAGE(loopLabel.data(),
+                                                 audioDataSize, dataLength);
+                }
+
+                CPPUNIT_ASSERT_EQUAL(overflowCount, MpRecorderWriter::getOverflowCount());
+
+                // Stop flowgraph
+                haltFramework();
+
+            } // end for iteration over sample rates
+
+        }  // end for iteration over file formats
+
+        MprRecorder::setAsyncFileWrite(FALSE);
+
+    } // end testRecordToFileAsync method
+
+#ifdef __pingtel_on_posix__
+    void testAsyncCloseOnFullQueue()
+    {
+        // A pipe nobody reads from makes the writer block in write(),
+        // so the queue fills up.
+        int fds[2];
+        CPPUNIT_ASSERT_EQUAL(0, pipe(fds));
+
+        MpRecorderWriter::destroyRecorderWriter();
+        MpRecorderWriter::setQueueLength(4);
+        MpRecorderWriter* pWriter = MpRecorderWriter::getRecorderWriter();
+
+        char data[MpRecorderWriter::CELL_DATA_SIZE];
+        memset(data, 0x55, sizeof(data));
+        char* channelData[1] = {data};
+        int32_t overflowCount = MpRecorderWriter::getOverflowCount();
+        int bytesQueued = 0;
+        int failuresInRow = 0;
+        for (int i = 0; i < 10000 && failuresInRow < 50; i++)
+        {
+            if (pWriter->writeData(fds[1], channelData, 1, sizeof(data), 2)
+                == OS_SUCCESS)
+            {
+                bytesQueued += sizeof(data);
+                failuresInRow = 0;
+            }
+            else
+            {
+                failuresInRow++;
+                OsTask::delay(1);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(50, failuresInRow);
+        CPPUNIT_ASSERT(MpRecorderWriter::getOverflowCount() > overflowCount);
+
+        // Close must be queued without waiting for a free cell.
+        OsAtomicInt pendingCnt(0);
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                             pWriter->closeFile(fds[1],
+                                                MprRecorder::RAW_PCM_16,
+                                                &pendingCnt));
+        CPPUNIT_ASSERT_EQUAL(1, (int)pendingCnt);
+
+        // Writer closes the pipe only after all the data queued before.
+        char buffer[4096];
+        int bytesRead = 0;
+        int res;
+        while ((res = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            bytesRead += res;
+        }
+        CPPUNIT_ASSERT_EQUAL(0, res);
+        CPPUNIT_ASSERT_EQUAL(bytesQueued, bytesRead);
+        for (int i = 0; i < 100 && pendingCnt > 0; i++)
+        {
+            OsTask::delay(10);
+        }
+        CPPUNIT_ASSERT_EQUAL(0, (int)pendingCnt);
+
+        close(fds[0]);
+        MpRecorderWriter::destroyRecorderWriter();
+        MpRecorderWriter::setQueueLength(MpRecorderWriter::DEF_QUEUE_LENGTH);
+    }
+#endif
+
 }; // end MprRecorderTest class
            
 
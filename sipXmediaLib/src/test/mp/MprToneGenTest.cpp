@@ -12,8 +12,11 @@
 // SYSTEM INCLUDES
 #include <os/OsIntTypes.h>
 #include <math.h>
+#include <stdio.h>
 
 // APPLICATION INCLUDES
+#include <os/OsDateTime.h>
+#include <os/OsTime.h>
 #include <mp/MpMediaTask.h>
 #include <mp/MpFlowGraphBase.h>
 #include <mp/MpTestResource.h>
@@ -26,6 +29,7 @@ class MprToneGenTest : public MpGenericResourceTest
 {
    CPPUNIT_TEST_SUB_SUITE(MprToneGenTest, MpGenericResourceTest);
    CPPUNIT_TEST(testToneAuthenticity);
+   CPPUNIT_TEST(testDtmfDetectorPerformance);
    CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -134,8 +138,83 @@ public:
       }
    }
 
+   /// Time DTMF detection per sample and per frame on tone and silence.
+   void testDtmfDetectorPerformance()
+   {
+      const int samplesPerSec = 8000;
+      const int samplesPerFrame = 80;
+      const int numProcessSamples = 3*samplesPerFrame;
+      // Every other second of the stream is silence.
+      const int streamSeconds = 60;
+      const int streamSamples = streamSeconds*samplesPerSec;
+      MpAudioSample *pStream = new MpAudioSample[streamSamples];
+      int i;
+
+      // DTMF '4' is 770 Hz + 1209 Hz.
+      for (i = 0; i < streamSamples; i++)
+      {
+         if ((i / samplesPerSec) % 2 == 0)
+         {
+            double t = (double)i / samplesPerSec;
+            pStream[i] = (MpAudioSample)(8000.0*sin(2*M_PI*770*t) +
+                                         8000.0*sin(2*M_PI*1209*t));
+         }
+         else
+         {
+            pStream[i] = 0;
+         }
+      }
+
+      MpDtmfDetector sampleDetector(samplesPerSec, numProcessSamples);
+      MpDtmfDetector frameDetector(samplesPerSec, numProcessSamples);
+      OsTime start;
+      OsTime stop;
+      int sampleDetections = 0;
+      int frameDetections = 0;
+
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < streamSamples; i++)
+      {
+         if (sampleDetector.processSample(pStream[i]) &&
+             sampleDetector.getLastDetectedDTMF() == '4')
+         {
+            sampleDetections++;
+         }
+      }
+      OsDateTime::getCurTime(stop);
+      double sampleSeconds = toSeconds(stop - start);
+
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < streamSamples; i += samplesPerFrame)
+      {
+         if (frameDetector.processFrame(pStream + i, samplesPerFrame) &&
+             frameDetector.getLastDetectedDTMF() == '4')
+         {
+            frameDetections++;
+         }
+      }
+      OsDateTime::getCurTime(stop);
+      double frameSeconds = toSeconds(stop - start);
+
+      printf("dtmf-detect per-sample;%f usec/stream-second\n",
+             sampleSeconds*1000000.0/streamSeconds);
+      printf("dtmf-detect per-frame;%f usec/stream-second\n",
+             frameSeconds*1000000.0/streamSeconds);
+
+      // Both ways must give the same results.
+      CPPUNIT_ASSERT(sampleDetections > 0);
+      CPPUNIT_ASSERT_EQUAL(sampleDetections, frameDetections);
+
+      delete[] pStream;
+   }
+
 private:
 
+   static double toSeconds(const OsTime &time)
+   {
+      return time.seconds() + time.usecs()/1000000.0;
+   }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(MprToneGenTest);
@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <os/OsIntTypes.h>
+
+#include <sipxunittests.h>
+
+// Setup codec paths..
+#include <../test/mp/MpTestCodecPaths.h>
+
+#include <os/OsAtomics.h>
+#include <os/OsDatagramSocket.h>
+#include <os/OsTask.h>
+#include <mp/MpMisc.h>
+#include <mp/MpRtpBuf.h>
+#include <mp/MprFromNet.h>
+#include <mp/MprRtpDispatcher.h>
+#include <mp/NetInTask.h>
+
+/// Number of datagrams in a burst, several receive batches.
+#define NUM_BURST_PACKETS  100
+/// Size of RTP payload of one datagram.
+#define PAYLOAD_SIZE       160
+/// Receive threads used by the test.
+#define NUM_RECEIVE_THREADS 2
+
+/// RTP dispatcher which only counts packets by sequence number.
+class NetInTaskTestDispatcher : public MprRtpDispatcher
+{
+public:
+   NetInTaskTestDispatcher()
+   : MprRtpDispatcher("NetInTaskTestDispatcher", 0)
+   , mNumReceived(0)
+   {
+      memset(mCounts, 0, sizeof(mCounts));
+   }
+
+   OsStatus pushPacket(MpRtpBufPtr &pRtp)
+   {
+      RtpSeq seq = pRtp->getRtpSequenceNumber();
+      if (seq < NUM_BURST_PACKETS)
+      {
+         mCounts[seq]++;
+      }
+      mNumReceived++;
+      return OS_SUCCESS;
+   }
+
+   void checkRtpStreamsActivity() {}
+
+   UtlBoolean connectOutput(int, MpResource*) {return FALSE;}
+
+   UtlBoolean disconnectOutput(int) {return FALSE;}
+
+   OsAtomicInt mNumReceived;
+   int mCounts[NUM_BURST_PACKETS];
+};
+
+/**
+ * Unittest for NetInTask
+ */
+class NetInTaskTest : public SIPX_UNIT_BASE_CLASS
+{
+   CPPUNIT_TEST_SUITE(NetInTaskTest);
+   CPPUNIT_TEST(testBurst);
+   CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   void setUp()
+   {
+      OsStatus res = mpStartUp(8000, 80, 6*10, NULL,
+                                sNumCodecPaths, sCodecPaths);
+      CPPUNIT_ASSERT(res == OS_SUCCESS);
+
+      NetInTask::setNumReceiveThreads(NUM_RECEIVE_THREADS);
+   }
+
+   void tearDown()
+   {
+      NetInTask::getNetInTask()->destroy();
+      NetInTask::setNumReceiveThreads(1);
+
+      OsStatus res = mpShutdown();
+      CPPUNIT_ASSERT(res == OS_SUCCESS);
+   }
+
+   void testBurst()
+   {
+      OsDatagramSocket rtpSocket(0, NULL, 0, "127.0.0.1");
+      OsDatagramSocket rtcpSocket(0, NULL, 0, "127.0.0.1");
+      CPPUNIT_ASSERT(rtpSocket.isOk());
+      CPPUNIT_ASSERT(rtcpSocket.isOk());
+      OsDatagramSocket sender(rtpSocket.getLocalHostPort(), "127.0.0.1",
+                              0, "127.0.0.1");
+      CPPUNIT_ASSERT(sender.isOk());
+
+      NetInTaskTestDispatcher dispatcher;
+      MprFromNet fromNet;
+      fromNet.setRtpDispatcher(&dispatcher);
+      fromNet.setSockets(rtpSocket, rtcpSocket);
+
+      // Send the burst at once. It is longer than a receive batch and than
+      // the whole UdpPool, so it is read in several batches.
+      CPPUNIT_ASSERT(NUM_BURST_PACKETS > (int)MpMisc.UdpPool->getMaxBlocks());
+      char packet[sizeof(RtpHeader) + PAYLOAD_SIZE];
+      memset(packet, 0, sizeof(packet));
+      for (int i = 0; i < NUM_BURST_PACKETS; i++)
+      {
+         RtpHeader* pHeader = (RtpHeader*)packet;
+         pHeader->vpxcc = 2 << 6;
+         pHeader->mpt = 0;
+         pHeader->seq = htons((uint16_t)i);
+         pHeader->timestamp = htonl(i*PAYLOAD_SIZE);
+         pHeader->ssrc = htonl(0x1234);
+         CPPUNIT_ASSERT_EQUAL((int)sizeof(packet),
+                              sender.write(packet, sizeof(packet)));
+      }
+
+      for (int i = 0; i < 500 && dispatcher.mNumReceived < NUM_BURST_PACKETS; i++)
+      {
+         OsTask::delay(10);
+      }
+      fromNet.resetSockets();
+
+      CPPUNIT_ASSERT_EQUAL(NUM_BURST_PACKETS, (int)dispatcher.mNumReceived);
+      for (int i = 0; i < NUM_BURST_PACKETS; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(1, dispatcher.mCounts[i]);
+      }
+
+      // Every buffer went back to the pool.
+      CPPUNIT_ASSERT_EQUAL((int)MpMisc.UdpPool->getNumBlocks(),
+                           MpMisc.UdpPool->getFreeBufferCount());
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NetInTaskTest);
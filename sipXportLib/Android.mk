@@ -129,6 +129,7 @@ LOCAL_SRC_FILES := \
     src/os/OsSysLog.cpp \
     src/os/OsSysLogFacilities.cpp \
     src/os/OsSysLogMsg.cpp \
+    src/os/OsSysLogRing.cpp \
     src/os/OsSysLogTask.cpp \
     src/os/OsTask.cpp \
     src/os/OsTime.cpp \
@@ -313,6 +314,7 @@ LOCAL_SRC_FILES := \
   src/test/os/OsServerTaskTest.cpp \
   src/test/os/OsSharedLibMgrTest.cpp \
   src/test/os/OsSocketTest.cpp \
+  src/test/os/OsSysLogTest.cpp \
   src/test/os/OsTestUtilities.cpp \
   src/test/os/OsTimeTest.cpp \
   src/test/os/OsTimerTaskTest.cpp \
@@ -410,6 +412,7 @@ LOCAL_SRC_FILES := \
   src/test/os/OsServerTaskTest.cpp \
   src/test/os/OsSharedLibMgrTest.cpp \
   src/test/os/OsSocketTest.cpp \
+  src/test/os/OsSysLogTest.cpp \
   src/test/os/OsTestUtilities.cpp \
   src/test/os/OsTimeTest.cpp \
   src/test/os/OsTimerTaskTest.cpp \
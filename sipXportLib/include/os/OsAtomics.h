@@ -44,6 +44,210 @@ typedef enum memory_order {
    memory_order_release, memory_order_acq_rel, memory_order_seq_cst
 } memory_order;
 
+#if defined(__GNUC__) || defined(_MSC_VER) // [
+
+#ifdef _MSC_VER // [
+#  include <intrin.h>
+
+/// Compare-and-swap of 4 and 8 byte words with MSVC intrinsics.
+template<int size> struct OsAtomicWord;
+
+template<> struct OsAtomicWord<4>
+{
+   typedef long Word;
+
+   static Word cas(volatile void *pVal, Word expected, Word desired)
+   {return _InterlockedCompareExchange((volatile long*)pVal, desired, expected);}
+};
+
+template<> struct OsAtomicWord<8>
+{
+   typedef __int64 Word;
+
+   static Word cas(volatile void *pVal, Word expected, Word desired)
+   {return _InterlockedCompareExchange64((volatile __int64*)pVal, desired, expected);}
+};
+#endif // _MSC_VER ]
+
+/**
+*  Lock-free atomic variable of an integer or pointer type of 4 or 8 bytes.
+*
+*  Built on GCC __sync builtins (also provided by clang) or on MSVC
+*  interlocked intrinsics. 8 byte values are atomic on 32-bit x86 too
+*  (cmpxchg8b). The object holds nothing but the value, so it may live in
+*  raw memory which is initialized by assignment.
+*
+*  Read-modify-write operations are full barriers. Loads and stores which
+*  are not relaxed are ordered by a full barrier too.
+*/
+template<class T>
+class OsAtomic
+{
+public:
+   bool is_lock_free() const
+   {return true;}
+
+   void store(T val, ::memory_order mo = memory_order_seq_cst)
+   {
+      if (sizeof(T) > sizeof(void*))
+      {
+         // Plain stores of double words are not atomic on 32-bit platforms.
+         exchange(val, mo);
+         return;
+      }
+      if (mo != memory_order_relaxed)
+         fullFence();
+      mVal = val;
+      if (mo == memory_order_seq_cst)
+         fullFence();
+   }
+
+   T load(::memory_order mo = memory_order_seq_cst) const
+   {
+      if (sizeof(T) > sizeof(void*))
+      {
+         // A CAS which never changes the value gives us an atomic read.
+         return cas(const_cast<volatile T*>(&mVal), (T)0, (T)0);
+      }
+      T val = mVal;
+      if (mo != memory_order_relaxed)
+         fullFence();
+      return val;
+   }
+
+   operator T() const
+   {return load();}
+
+   T exchange(T val, ::memory_order = memory_order_seq_cst)
+   {
+      T old = mVal;
+      T cur;
+      while ((cur = cas(&mVal, old, val)) != old)
+         old = cur;
+      return old;
+   }
+
+   bool compare_exchange(T &expected, T desired, ::memory_order = memory_order_seq_cst)
+   {
+      T old = cas(&mVal, expected, desired);
+      if (old == expected)
+         return true;
+      expected = old;
+      return false;
+   }
+
+   void fence(::memory_order mo) const
+   {if (mo != memory_order_relaxed) fullFence();}
+
+   T fetch_add(T val, ::memory_order = memory_order_seq_cst)
+   {
+#ifdef __GNUC__
+      return __sync_fetch_and_add(&mVal, val);
+#else
+      T old = mVal;
+      T cur;
+      while ((cur = cas(&mVal, old, old + val)) != old)
+         old = cur;
+      return old;
+#endif
+   }
+
+   T fetch_sub(T val, ::memory_order mo = memory_order_seq_cst)
+   {return fetch_add(-val, mo);}
+
+   T fetch_and(T val, ::memory_order = memory_order_seq_cst)
+   {
+      T old = mVal;
+      T cur;
+      while ((cur = cas(&mVal, old, old & val)) != old)
+         old = cur;
+      return old;
+   }
+
+   T fetch_or(T val, ::memory_order = memory_order_seq_cst)
+   {
+      T old = mVal;
+      T cur;
+      while ((cur = cas(&mVal, old, old | val)) != old)
+         old = cur;
+      return old;
+   }
+
+   T fetch_xor(T val, ::memory_order = memory_order_seq_cst)
+   {
+      T old = mVal;
+      T cur;
+      while ((cur = cas(&mVal, old, old ^ val)) != old)
+         old = cur;
+      return old;
+   }
+
+   OsAtomic<T>() {};
+
+   explicit OsAtomic<T>(T val) : mVal(val) {};
+
+   T operator=(T val)
+   {store(val); return val;}
+
+   T operator++(int)
+   {return fetch_add(1);}
+
+   T operator--(int)
+   {return fetch_sub(1);}
+
+   T operator++()
+   {return fetch_add(1) + 1;}
+
+   T operator--()
+   {return fetch_sub(1) - 1;}
+
+   T operator+=(T val)
+   {return fetch_add(val) + val;}
+
+   T operator-=(T val)
+   {return fetch_sub(val) - val;}
+
+   T operator&=(T val)
+   {return fetch_and(val) & val;}
+
+   T operator|=(T val)
+   {return fetch_or(val) | val;}
+
+   T operator^=(T val)
+   {return fetch_xor(val) ^ val;}
+
+private:
+   volatile T mVal;
+
+     /// Set value to desired if it is equal to expected, return old value.
+   static T cas(volatile T *pVal, T expected, T desired)
+   {
+#ifdef __GNUC__
+      return __sync_val_compare_and_swap(pVal, expected, desired);
+#else
+      typedef typename OsAtomicWord<sizeof(T)>::Word Word;
+      return (T)OsAtomicWord<sizeof(T)>::cas(pVal, (Word)expected, (Word)desired);
+#endif
+   }
+
+     /// Full memory barrier.
+   static void fullFence()
+   {
+#ifdef __GNUC__
+      __sync_synchronize();
+#else
+      volatile long barrier = 0;
+      _InterlockedOr(&barrier, 0);
+#endif
+   }
+
+   // Prohibit use of copy constructor and operator=
+   OsAtomic<T>(const OsAtomic<T>&);
+   OsAtomic<T>& operator=(const OsAtomic<T>&);
+};
+
+#else // __GNUC__ || _MSC_VER ][
+
 template<class T>
 class OsAtomic
 {
@@ -60,9 +264,22 @@ public:
    operator T() const
    {return load();}
 
-//   T exchange(T val, ::memory_order = memory_order_seq_cst);
+   T exchange(T val, ::memory_order = memory_order_seq_cst)
+   {OsLock lock(mMutex); T temp = mVal; mVal = val; return temp;}
+
 //   bool compare_exchange(T &, T , ::memory_order, ::memory_order);
-//   bool compare_exchange(T &, T , ::memory_order = memory_order_seq_cst);
+
+   bool compare_exchange(T &expected, T desired, ::memory_order = memory_order_seq_cst)
+   {
+      OsLock lock(mMutex);
+      if (mVal == expected)
+      {
+         mVal = desired;
+         return true;
+      }
+      expected = mVal;
+      return false;
+   }
 
    void fence(::memory_order) const
    {};
@@ -125,6 +342,8 @@ private:
    OsAtomic<T>& operator=(const OsAtomic<T>&);
 };
 
+#endif // __GNUC__ || _MSC_VER ]
+
 typedef OsAtomic<int> OsAtomicInt;
 typedef OsAtomic<unsigned int> OsAtomicUInt;
 typedef OsAtomic<long> OsAtomicLong;
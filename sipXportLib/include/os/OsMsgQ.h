@@ -48,7 +48,8 @@ public:
    enum Options
    {
       Q_FIFO     = 0x0, ///< queue blocked tasks on a first-in, first-out basis
-      Q_PRIORITY = 0x1  ///< queue blocked tasks based on their priority
+      Q_PRIORITY = 0x1, ///< queue blocked tasks based on their priority
+      Q_LOCKFREE = 0x2  ///< use lock-free queue with a single receiving task
    };
 
 
@@ -115,6 +115,16 @@ public:
    virtual OsSocket::IpProtocolSocketType getIpProtocol() const;
    //: Returns the protocol type of this socket
 
+   virtual UtlBoolean isReadyToReadEx(long waitMilliseconds, UtlBoolean &rSocketError) const;
+   //: Poll if there are bytes to read
+   // Bytes already decrypted and buffered by SSL are ready without
+   // waiting, even when the socket itself has nothing left to read.
+   //!param: waitMilliseconds - The maximum number of milliseconds to wait.
+   //!param: rSocketError - Set to TRUE if the socket is in error.
+
+   virtual UtlBoolean isReadyToRead(long waitMilliseconds = 0) const;
+   //: Poll if there are bytes to read, including bytes buffered by SSL
+
    /// Is this connection encrypted using TLS/SSL?
    virtual bool isEncrypted() const;
    
@@ -20,6 +20,7 @@
 #include <os/OsSysLogFacilities.h>
 #include <os/OsSocket.h>
 #include <os/OsDefs.h>
+#include <os/OsIntTypes.h>
 #include <os/OsStatus.h>
 #include <os/OsTime.h>
 #include <os/OsAtomics.h>
@@ -387,6 +388,30 @@ public:
      //:Flushes the in-memory circular buffer log to disk or an unbounded
      //:log file.
 
+   static OsStatus setBinaryLogging(const UtlBoolean enable,
+                                    const int ringSize = 0);
+     //:Enables or disables binary logging mode.
+     // In binary mode log entries are not formatted by the logging thread.
+     // The timestamp, the format string pointer and raw argument values are
+     // stored into a lock-free ring owned by the calling thread and are
+     // rendered to text later by the logger task, oldest first. If the ring
+     // is full, the entry is dropped instead of blocking the caller (see
+     // getNumDroppedEntries()).
+     //
+     // Format strings must live as long as the process, like string
+     // literals. Entries whose format could not be stored in binary form
+     // (%n, wide strings) are added in text mode, as well as all entries on
+     // platforms without per-thread rings. Such entries may get ahead of
+     // binary entries logged before them.
+     //
+     //!param enable - Specify TRUE to enable binary mode or FALSE to
+     //       disable it.  The default is disabled.
+     //!param ringSize - Size of per-thread rings in bytes or 0 to keep the
+     //       current size.  Applies to rings created after this call.
+     //
+     //!returns OS_NOT_SUPPORTED if binary mode is not available on this
+     //         platform.
+
    static void initSysLog(const OsSysLogFacility facility,
            const char* processID,
            const char* logname,
@@ -441,6 +466,10 @@ public:
                                   UtlString& content) ;
    //:Parses a log string into its parts.
 
+   static int getNumDroppedEntries();
+     //:Return the number of entries dropped in binary mode because the
+     //:ring of the logging thread was full.
+
    static OsStatus getPriorityName(OsSysLogPriority priorityId, UtlString& name);
      //: Get the string name for the given priority level
 
@@ -480,6 +509,8 @@ protected:
    static UtlString sProcessId;
    static UtlString sHostname;
    static UtlBoolean bPrioritiesInitialized;
+   static UtlBoolean sBinaryLogging;
+   static OsAtomicInt sDrainPending;
 
    OsSysLog(const OsSysLog& rOsSysLog);
      //:Copy constructor
@@ -502,6 +533,30 @@ protected:
    static void getTaskInfo(UtlString& taskName, OsTaskId_t& taskId);
      //:Get current task name and id
 
+   static OsStatus addBinary(const char*            taskName,
+                             const OsTaskId_t       taskId,
+                             const OsSysLogFacility facility,
+                             const OsSysLogPriority priority,
+                             const char*            format,
+                             va_list                ap);
+     //:Stores a log entry to the ring of the calling thread.
+     // Wakes up the logger task if it is not yet going to drain the rings.
+     //
+     //!param: taskName - The name of the task or NULL to use the name and
+     //        id of the thread owning the ring.
+     //!returns OS_NOT_SUPPORTED if the entry must be added in text mode.
+
+   static void formatEntry(UtlString& logEntry,
+                           const OsTime& time,
+                           const char* taskName,
+                           const OsTaskId_t taskId,
+                           const OsSysLogFacility facility,
+                           const OsSysLogPriority priority,
+                           const UtlString& data);
+     //:Builds the text of a log entry from the (not escaped) message.
+
+   friend class OsSysLogTask;
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
 
@@ -0,0 +1,226 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OsSysLogRing_h_
+#define _OsSysLogRing_h_
+
+// SYSTEM INCLUDES
+#include <stdarg.h>
+
+// APPLICATION INCLUDES
+#include "os/OsAtomics.h"
+#include "os/OsDefs.h"
+#include "os/OsIntTypes.h"
+#include "os/OsMutex.h"
+#include "os/OsStatus.h"
+#include "os/OsSysLog.h"
+#include "os/OsTaskId.h"
+#include "os/OsTime.h"
+#include "utl/UtlString.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Per-thread ring of log entries in binary form.
+*
+*  In binary logging mode OsSysLog does not format log entries on
+*  the logging thread. Instead it stores the timestamp, the format
+*  string pointer and raw values of the arguments to a ring owned by
+*  the calling thread. The format string is parsed only as far as
+*  needed to learn argument types. String arguments are copied, as
+*  they may not outlive the call.
+*
+*  Every ring has a single writer (its thread) and a single reader
+*  (OsSysLogTask), so neither side takes a lock. If the ring is full,
+*  the entry is dropped and the drop counter of the ring is
+*  incremented. The logging thread is never blocked.
+*
+*  OsSysLogTask renders entries of all rings to text later, oldest
+*  first, and passes them on to the regular log outputs.
+*/
+class OsSysLogRing
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      DEF_RING_SIZE = 64*1024,  ///< Default size of a ring in bytes.
+      MAX_ENTRY_SIZE = 2048,    ///< Max size of one entry. Longer string
+                                ///< arguments are truncated.
+      MAX_TASK_NAME = 32        ///< Max stored length of a task name.
+   };
+
+     /// Rendered log entry.
+   struct Entry
+   {
+      OsTime mTime;
+      OsSysLogFacility mFacility;
+      OsSysLogPriority mPriority;
+      UtlString mTaskName;
+      OsTaskId_t mTaskId;
+      UtlString mMessage;       ///< Formatted message, not escaped.
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Return the ring of the calling thread, creating it if needed.
+   static OsSysLogRing* getThreadRing();
+     /**<
+     *  @returns NULL if per-thread rings are not supported on this platform.
+     */
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Set size of rings to be created.
+   static void setRingSize(int ringSize);
+     /**<
+     *  Size is rounded up to a power of 2. Existing rings are not resized.
+     */
+
+     /// Store a log entry.
+   OsStatus record(const OsTime& time,
+                   const char* taskName,
+                   OsTaskId_t taskId,
+                   OsSysLogFacility facility,
+                   OsSysLogPriority priority,
+                   const char* format,
+                   va_list ap);
+     /**<
+     *  Must be called only by the thread owning the ring.
+     *
+     *  @param[in] taskName - name of the logging task or NULL to use
+     *             the name and id of the thread owning the ring.
+     *  @param[in] format - printf-like format. Must be a string which
+     *             lives as long as the process, like a string literal.
+     *
+     *  @returns OS_SUCCESS if the entry has been stored.
+     *  @returns OS_LIMIT_REACHED if the ring is full and the entry is dropped.
+     *  @returns OS_NOT_SUPPORTED if the format has conversions which could
+     *           not be stored in binary form (like %n or wide strings).
+     *           Caller should format the entry itself.
+     */
+
+     /// Render the oldest entry of all rings.
+   static UtlBoolean renderNext(Entry& entry);
+     /**<
+     *  Must be called by a single reader thread only.
+     *
+     *  @returns FALSE if all rings are empty.
+     */
+
+     /// Return number of entries dropped since the previous call.
+   static int takeNewDrops();
+     /**<
+     *  Must be called by the same thread as renderNext().
+     */
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return total number of entries dropped because a ring was full.
+   static int getNumDropped();
+
+     /// Return number of bytes stored in this ring.
+   int getUsedSize() const;
+
+//@}
+
+/* ============================ INQUIRY =================================== */
+///@name Inquiry
+//@{
+
+     /// Are per-thread rings supported on this platform?
+   static UtlBoolean isSupported();
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+     /// Header of a stored entry, followed by task name and arguments.
+   struct EntryHeader
+   {
+      uint32_t mSize;        ///< Size of the entry, including this header.
+      uint8_t mFacility;
+      uint8_t mPriority;
+      uint16_t mNameLength;  ///< Length of the stored task name, if any.
+      int64_t mSeconds;      ///< Timestamp.
+      int32_t mUsecs;
+      OsTaskId_t mTaskId;
+      const char* mpFormat;
+   };
+
+   static OsMutex sLock;            ///< Guard for the list of rings.
+   static OsSysLogRing* spRings;    ///< List of all rings.
+   static int sRingSize;            ///< Size of rings to create.
+   static int sFreedDrops;          ///< Drops of freed rings.
+   static int sUnreportedFreedDrops; ///< Drops of freed rings not yet
+                                    ///< returned by takeNewDrops().
+
+   char* mpBuffer;                  ///< Ring storage.
+   uint32_t mMask;                  ///< Size of mpBuffer minus 1.
+   OsAtomicInt mHead;               ///< Write position.
+   OsAtomicInt mTail;               ///< Read position.
+   OsAtomicInt mDropped;            ///< Number of dropped entries.
+   int32_t mReportedDrops;          ///< Drops returned by takeNewDrops().
+   OsAtomicInt mAbandoned;          ///< Has the owner thread exited?
+   char mTaskName[MAX_TASK_NAME+1]; ///< Name of the owner task.
+   OsTaskId_t mTaskId;              ///< Id of the owner task.
+   OsSysLogRing* mpNext;            ///< Next ring in the list.
+
+     /// Constructor
+   OsSysLogRing(int ringSize);
+
+     /// Destructor
+   ~OsSysLogRing();
+
+     /// Return header of the first entry or NULL if the ring is empty.
+   EntryHeader* peekEntry();
+     /**<
+     *  Skips padding at the end of the buffer.
+     */
+
+     /// Decode and release the first entry returned by peekEntry().
+   void renderEntry(EntryHeader* pHeader, Entry& entry);
+
+     /// Create the key of per-thread ring pointers.
+   static void createThreadKey();
+
+     /// Mark the ring of the exiting thread as abandoned.
+   static void abandonRing(void* pRing);
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   OsSysLogRing(const OsSysLogRing& rOsSysLogRing);
+
+     /// Assignment operator (not implemented for this class)
+   OsSysLogRing& operator=(const OsSysLogRing& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _OsSysLogRing_h_
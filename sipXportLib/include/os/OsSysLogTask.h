@@ -136,6 +136,8 @@ protected:
      //:Process flushing the actual log.
    OsStatus processSetCallback(OsSysLogCallback pCallback);
      //:Process setting a callback function
+   OsStatus processDrainRings();
+     //:Process rendering entries stored in binary logging mode
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
@@ -279,7 +279,9 @@ protected:
    int             mOutstandingMessages; ///< Number of messages for this timer
                                ///< in the timer task's queue.
 
-   OsTimer*        mTimerQueueLink; ///< To chain together timers.
+   int             mTimerQueueIndex; ///< Position in the timer task's queue,
+                               ///< or -1 if the timer is not in the queue.
+   unsigned int    mTimerQueueSeq; ///< Order of insertion into the queue.
 
    /// Start a timer.
    OsStatus startTimer(OsTime start,
@@ -104,18 +104,51 @@ private:
    /// Semaphore used to protect manipulations of spInstance.
    static OsBSem *sLock;
 
+   enum
+   {
+      TIMER_QUEUE_ARITY = 4,       ///< Number of children of a queue node.
+      TIMER_QUEUE_MIN_CAPACITY = 64 ///< Initial size of the queue array.
+   };
+
    /// The queue of timer requests, ordered by increasing firing time.
-   OsTimer* mTimerQueue;
+   /**
+    *  The queue is a 4-ary heap stored in an array, so inserting and
+    *  removing a timer takes O(log n). Every timer keeps its position in
+    *  the array in OsTimer::mTimerQueueIndex, so a stopped timer is
+    *  removed without searching for it.
+    */
+   OsTimer** mpTimerQueue;
+   int mTimerQueueSize;     ///< Number of timers in the queue.
+   int mTimerQueueCapacity; ///< Allocated size of mpTimerQueue.
+   unsigned int mTimerQueueSeq; ///< Counter of inserted timers.
 
    /// Timeout to use when signalling
    OsTime mSignalTimeout;
 
+   /// Return the timer to fire first, or NULL if the queue is empty.
+   inline OsTimer* firstTimer() const;
+
    /// Insert a timer into the timer queue.
    void insertTimer(OsTimer* timer);
 
    /// Remove a timer from the timer queue.
    void removeTimer(OsTimer* timer);
 
+   /// Does timer \p a fire before timer \p b?
+   static inline UtlBoolean firesBefore(const OsTimer* a, const OsTimer* b);
+   /**<
+    *  Timers with equal firing times fire in reverse order of insertion.
+    */
+
+   /// Move timer at \p index towards the queue head until the order is restored.
+   void siftUp(int index);
+
+   /// Move timer at \p index towards the queue tail until the order is restored.
+   void siftDown(int index);
+
+   /// Put timer to the queue position \p index.
+   inline void setQueueEntry(int index, OsTimer* timer);
+
    /// Copy constructor (not implemented for this class)
    OsTimerTask(const OsTimerTask& rOsTimerTask);
 
@@ -126,4 +159,9 @@ private:
 
 /* ============================ INLINE METHODS ============================ */
 
+OsTimer* OsTimerTask::firstTimer() const
+{
+   return mTimerQueueSize > 0 ? mpTimerQueue[0] : NULL;
+}
+
 #endif  // _OsTimerTask_h_
@@ -15,6 +15,8 @@
 // SYSTEM INCLUDES
 
 // APPLICATION INCLUDES
+#include "os/OsAtomics.h"
+#include "os/OsBSem.h"
 #include "os/OsCSem.h"
 #include "os/OsDefs.h"
 #include "os/OsMsg.h"
@@ -76,6 +78,16 @@ class DebugMutex
 *    - a binary semaphore (mGuard) to ensure against concurrent access to
 *      internal object data
 *  </pre>
+*
+*  If the queue is created with the Q_LOCKFREE option, messages are kept
+*  in a bounded ring instead, which producers fill without taking any lock.
+*  The number of queued messages is reserved with a single atomic
+*  operation, and semaphores are touched only when a sender finds
+*  the queue full or the receiver finds it empty. Urgent messages are
+*  pushed onto a lock-free stack which is drained before the ring, so they
+*  are received in the same order as with the default implementation.
+*  Only one task may receive from such a queue, which is the case for
+*  the incoming queue of OsServerTask.
 */
 class OsMsgQShared : public OsMsgQBase
 {
@@ -161,6 +173,31 @@ private:
    int      mHighCnt; ///< High water mark for the number of msgs in the queue.
 #endif
 
+     /// Cell of the lock-free ring.
+   struct Cell
+   {
+      OsAtomicInt mSeq;      ///< Position in the ring this cell is ready for.
+      OsMsg* mpMsg;          ///< Queued message.
+   };
+
+     /// Element of the lock-free stack of urgent messages.
+   struct UrgentNode
+   {
+      UrgentNode* mpNext;
+      OsMsg* mpMsg;
+   };
+
+   Cell*    mpCells;      ///< Lock-free ring or NULL if Q_LOCKFREE is not set.
+   int32_t  mRingMask;    ///< Number of cells in the ring minus 1.
+   OsAtomicInt mEnqueuePos;       ///< Next ring position to send to.
+   int32_t  mDequeuePos;  ///< Next ring position to receive from.
+   OsAtomic<UrgentNode*> mpUrgentHead; ///< Top of the urgent messages stack.
+   OsAtomicInt mMsgCount;         ///< Number of queued and reserved messages.
+   OsAtomicInt mReceiverWaiting;  ///< Is receiver waiting for a message?
+   OsAtomicInt mSendersWaiting;   ///< Number of senders waiting for room.
+   OsBSem   mNotEmpty;    ///< Wakes up the waiting receiver.
+   OsBSem   mNotFull;     ///< Wakes up waiting senders.
+
 #ifdef OS_MSGQ_REPORTING
    int      mIncreaseLevel;   ///< Emit a message to the log when the number
                               ///<  of messages reaches the mIncreaseLevel.
@@ -178,6 +215,19 @@ private:
      /// Helper function for removing a message from the head of the queue
    OsStatus doReceive(OsMsg*& rpMsg, const OsTime& rTimeout);
 
+     /// Lock-free counterpart of doSend().
+   OsStatus doLockFreeSend(const OsMsg& rMsg, const OsTime& rTimeout,
+                           const UtlBoolean isUrgent, const UtlBoolean needCopy);
+
+     /// Lock-free counterpart of doReceive().
+   OsStatus doLockFreeReceive(OsMsg*& rpMsg, const OsTime& rTimeout);
+
+     /// Reserve room for one message in the lock-free queue.
+   UtlBoolean reserveMsg();
+
+     /// Take the first message from the lock-free queue, if there is one.
+   UtlBoolean tryLockFreeReceive(OsMsg*& rpMsg);
+
      /// Copy constructor (not implemented for this class)
    OsMsgQShared(const OsMsgQShared& rOsMsgQShared);
 
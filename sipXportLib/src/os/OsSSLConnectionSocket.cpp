@@ -258,6 +258,25 @@ OsSocket::IpProtocolSocketType OsSSLConnectionSocket::getIpProtocol() const
     return(OsSocket::SSL_SOCKET);
 }
 
+UtlBoolean OsSSLConnectionSocket::isReadyToReadEx(long waitMilliseconds,
+                                                  UtlBoolean &rSocketError) const
+{
+    // SSL_read() pulls a whole record off the socket, so the rest of a
+    // record may wait in SSL's buffer while the socket itself is empty.
+    if (mSSL && SSL_pending(mSSL) > 0)
+    {
+        rSocketError = FALSE;
+        return TRUE;
+    }
+    return OsConnectionSocket::isReadyToReadEx(waitMilliseconds, rSocketError);
+}
+
+UtlBoolean OsSSLConnectionSocket::isReadyToRead(long waitMilliseconds) const
+{
+    UtlBoolean bSocketError = FALSE;
+    return isReadyToReadEx(waitMilliseconds, bSocketError);
+}
+
 /// Is this connection encrypted using TLS/SSL?
 bool OsSSLConnectionSocket::isEncrypted() const
 {
@@ -34,6 +34,7 @@
 #include "utl/UtlDefs.h"
 #include "os/OsSysLog.h"
 #include "os/OsSysLogMsg.h"
+#include "os/OsSysLogRing.h"
 #include "os/OsSysLogTask.h"
 #include "os/OsStatus.h"
 #include "os/OsServerTask.h"
@@ -61,6 +62,8 @@ OsSysLogPriority OsSysLog::spPriorities[FAC_MAX_FACILITY] ;
 // Initial logging level is PRI_ERR.
 OsSysLogPriority OsSysLog::sLoggingPriority = PRI_ERR ;
 UtlBoolean OsSysLog::bPrioritiesInitialized = FALSE ;
+UtlBoolean OsSysLog::sBinaryLogging = FALSE ;
+OsAtomicInt OsSysLog::sDrainPending(0) ;
 
 // A static array of priority names uses for displaying log entries
 const char* OsSysLog::sPriorityNames[] =
@@ -380,9 +383,18 @@ OsStatus OsSysLog::add(const OsSysLogFacility facility,
          va_list ap;
          va_start(ap, format);
 
-         getTaskInfo(taskName, taskId);
+         // Binary mode takes task info from the thread ring.
+         if (!sBinaryLogging ||
+             addBinary(NULL, 0, facility, priority, format, ap) == OS_NOT_SUPPORTED)
+         {
+            getTaskInfo(taskName, taskId);
 
-         rc = vadd(taskName.data(), taskId, facility, priority, format, ap);         
+            rc = vadd(taskName.data(), taskId, facility, priority, format, ap);         
+         }
+         else
+         {
+            rc = OS_SUCCESS;
+         }
          va_end(ap);
       }  
    }
@@ -398,6 +410,12 @@ OsStatus OsSysLog::vadd(const OsSysLogFacility facility,
                         const char*            format,
                         va_list                ap)
 {
+    if (sBinaryLogging && !isTaskPtrNull() && willLog(facility, priority) &&
+        addBinary(NULL, 0, facility, priority, format, ap) != OS_NOT_SUPPORTED)
+    {
+        return OS_SUCCESS;
+    }
+
     UtlString taskName;
     OsTaskId_t taskId = 0;
 
@@ -419,38 +437,20 @@ OsStatus OsSysLog::vadd(const char*            taskName,
    {
       if (willLog(facility, priority))
       {
+         if (sBinaryLogging && strcmp("syslog", taskName) != 0 &&
+             addBinary(taskName, taskId, facility, priority, format, ap) != OS_NOT_SUPPORTED)
+         {
+            return OS_SUCCESS;
+         }
+
          UtlString logData;
          UtlString logEntry;
          myvsprintf(logData, format, ap) ;
-         logData = escape(logData) ;
-
-#ifdef ANDROID
-         __android_log_print(androidPri(priority), "sipXsyslog", "[%s] %s",
-                             OsSysLog::sFacilityNames[facility], logData.data());
-#endif
 
          OsTime timeNow;
          OsDateTime::getCurTime(timeNow); 
-         OsDateTime logTime(timeNow);
-         
-         UtlString   strTime ;
-         logTime.getIsoTimeStringZus(strTime) ;
-         UtlString   taskHex;
-         // TODO: Should get abstracted into a OsTaskBase method
-#ifdef __pingtel_on_posix__
-         OsTaskLinux::getIdString_X(taskHex, taskId);
-#endif
-
-         mysprintf(logEntry, "\"%s\":%d:%s:%s:%s:%s:%s:%s:\"%s\"",
-               strTime.data(),
-               ++sEventCount,
-               OsSysLog::sFacilityNames[facility], 
-               OsSysLog::sPriorityNames[priority],
-               sHostname.data(),
-               (taskName == NULL) ? "" : taskName,
-               taskHex.data(),
-               sProcessId.data(),
-               logData.data()) ;         
+         formatEntry(logEntry, timeNow, taskName, taskId, facility, priority,
+                     logData);
 
          // If the logger for some reason trys to log a message
          // there is a recursive problem.  Drop the message on the
@@ -516,6 +516,32 @@ OsStatus OsSysLog::flush(const OsTime& rTimeout)
    return rc ;
 }
 
+// Enable/disable binary logging mode
+OsStatus OsSysLog::setBinaryLogging(const UtlBoolean enable,
+                                    const int ringSize)
+{
+   if (enable && !OsSysLogRing::isSupported())
+   {
+      return OS_NOT_SUPPORTED ;
+   }
+
+   if (ringSize > 0)
+   {
+      OsSysLogRing::setRingSize(ringSize) ;
+   }
+   sBinaryLogging = enable ;
+
+   // Render whatever is left in the rings.
+   OsSysLogTask *pOsSysLogTask = spOsSysLogTask;
+   if (!enable && pOsSysLogTask != NULL)
+   {
+      OsSysLogMsg msg(OsSysLogMsg::DRAIN_RINGS, NULL) ;
+      pOsSysLogTask->postMessage(msg) ;
+   }
+
+   return OS_SUCCESS ;
+}
+
 // Initialize the OsSysLog priority
 void
 OsSysLog::initSysLog(const OsSysLogFacility facility,
@@ -739,6 +765,12 @@ OsStatus OsSysLog::parseLogString(const char *szSource,
    return OS_SUCCESS ;
 }
 
+// Get the number of entries dropped in binary mode
+int OsSysLog::getNumDroppedEntries()
+{
+   return OsSysLogRing::getNumDropped() ;
+}
+
 OsStatus OsSysLog::getPriorityName(OsSysLogPriority priorityId, UtlString& name)
 {
     OsStatus status = OS_NOT_FOUND;
@@ -992,6 +1024,82 @@ UtlString OsSysLog::unescape(const UtlString& source)
    return results ;
 }
 
+// Store a log entry to the ring of the calling thread
+OsStatus OsSysLog::addBinary(const char*            taskName,
+                             const OsTaskId_t       taskId,
+                             const OsSysLogFacility facility,
+                             const OsSysLogPriority priority,
+                             const char*            format,
+                             va_list                ap)
+{
+   OsSysLogRing* pRing = OsSysLogRing::getThreadRing() ;
+   if (pRing == NULL)
+   {
+      return OS_NOT_SUPPORTED ;
+   }
+
+   OsTime timeNow;
+   OsDateTime::getCurTime(timeNow);
+   OsStatus rc = pRing->record(timeNow, taskName, taskId, facility, priority,
+                               format, ap) ;
+
+   // Only the first entry after the rings were drained wakes up the logger,
+   // so loggers do not contend on its queue.
+   int drainPending = 0 ;
+   if (  rc == OS_SUCCESS
+      && sDrainPending.load(memory_order_acquire) == 0
+      && sDrainPending.compare_exchange(drainPending, 1))
+   {
+      OsSysLogMsg msg(OsSysLogMsg::DRAIN_RINGS, NULL) ;
+      OsSysLogTask *pOsSysLogTask = spOsSysLogTask;
+      if (  pOsSysLogTask == NULL
+         || pOsSysLogTask->postMessage(msg, OsTime::NO_WAIT_TIME) != OS_SUCCESS)
+      {
+         sDrainPending.store(0, memory_order_release) ;
+      }
+   }
+
+   return rc ;
+}
+
+// Build the text of a log entry
+void OsSysLog::formatEntry(UtlString& logEntry,
+                           const OsTime& time,
+                           const char* taskName,
+                           const OsTaskId_t taskId,
+                           const OsSysLogFacility facility,
+                           const OsSysLogPriority priority,
+                           const UtlString& data)
+{
+   UtlString logData = escape(data) ;
+
+#ifdef ANDROID
+   __android_log_print(androidPri(priority), "sipXsyslog", "[%s] %s",
+                       OsSysLog::sFacilityNames[facility], logData.data());
+#endif
+
+   OsDateTime logTime(time);
+
+   UtlString   strTime ;
+   logTime.getIsoTimeStringZus(strTime) ;
+   UtlString   taskHex;
+   // TODO: Should get abstracted into a OsTaskBase method
+#ifdef __pingtel_on_posix__
+   OsTaskLinux::getIdString_X(taskHex, taskId);
+#endif
+
+   mysprintf(logEntry, "\"%s\":%d:%s:%s:%s:%s:%s:%s:\"%s\"",
+         strTime.data(),
+         ++sEventCount,
+         OsSysLog::sFacilityNames[facility], 
+         OsSysLog::sPriorityNames[priority],
+         sHostname.data(),
+         (taskName == NULL) ? "" : taskName,
+         taskHex.data(),
+         sProcessId.data(),
+         logData.data()) ;         
+}
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
 /* ============================ FUNCTIONS ================================= */
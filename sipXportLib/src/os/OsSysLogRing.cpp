@@ -0,0 +1,787 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <ctype.h>
+#include <stddef.h>
+#include <string.h>
+#ifdef __pingtel_on_posix__
+#  include <pthread.h>
+#endif
+
+// APPLICATION INCLUDES
+#include "os/OsSysLogRing.h"
+#include "os/OsLock.h"
+#include "os/OsTask.h"
+
+// DEFINES
+#define WRAP_MARKER  0xFFFFFFFF  // Entry size telling the rest of the buffer
+                                 // is unused.
+#define ALIGN8(x)    (((x) + 7) & ~7)
+
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+OsMutex OsSysLogRing::sLock(OsMutex::Q_FIFO);
+OsSysLogRing* OsSysLogRing::spRings = NULL;
+int OsSysLogRing::sRingSize = OsSysLogRing::DEF_RING_SIZE;
+int OsSysLogRing::sFreedDrops = 0;
+int OsSysLogRing::sUnreportedFreedDrops = 0;
+
+#ifdef __pingtel_on_posix__
+static pthread_key_t sRingKey;
+static pthread_once_t sRingKeyOnce = PTHREAD_ONCE_INIT;
+#endif
+
+// LOCAL FUNCTIONS
+
+enum ArgType
+{
+   ARG_NONE,         // %% - no argument
+   ARG_INT,          // Signed integer
+   ARG_UINT,         // Unsigned integer
+   ARG_DOUBLE,       // double
+   ARG_LONG_DOUBLE,  // long double
+   ARG_POINTER,      // void*
+   ARG_STRING        // char*, copied
+};
+
+enum LengthModifier
+{
+   LEN_NONE,
+   LEN_HH,
+   LEN_H,
+   LEN_L,
+   LEN_LL,
+   LEN_BIG_L,
+   LEN_Z,
+   LEN_J,
+   LEN_T
+};
+
+// Parsed printf conversion specification.
+struct FormatSpec
+{
+   const char* mpStart;      // Points to '%'.
+   const char* mpEnd;        // Points past the conversion character.
+   UtlBoolean mWidthArg;     // Is width passed as an argument?
+   UtlBoolean mPrecisionArg; // Is precision passed as an argument?
+   LengthModifier mLength;
+   ArgType mType;
+};
+
+// Parse conversion specification starting at '%'.
+// Return FALSE if it could not be stored in binary form.
+static UtlBoolean parseSpec(const char* p, FormatSpec& spec)
+{
+   spec.mpStart = p++;
+   spec.mWidthArg = FALSE;
+   spec.mPrecisionArg = FALSE;
+   spec.mLength = LEN_NONE;
+
+   // Flags
+   while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' ||
+          *p == '\'')
+   {
+      p++;
+   }
+
+   // Width
+   if (*p == '*')
+   {
+      spec.mWidthArg = TRUE;
+      p++;
+   }
+   else
+   {
+      while (isdigit(*p)) p++;
+   }
+
+   // Precision
+   if (*p == '.')
+   {
+      p++;
+      if (*p == '*')
+      {
+         spec.mPrecisionArg = TRUE;
+         p++;
+      }
+      else
+      {
+         while (isdigit(*p)) p++;
+      }
+   }
+
+   // Length modifier
+   switch (*p)
+   {
+   case 'h':
+      if (p[1] == 'h')
+      {
+         spec.mLength = LEN_HH;
+         p++;
+      }
+      else
+      {
+         spec.mLength = LEN_H;
+      }
+      p++;
+      break;
+   case 'l':
+      if (p[1] == 'l')
+      {
+         spec.mLength = LEN_LL;
+         p++;
+      }
+      else
+      {
+         spec.mLength = LEN_L;
+      }
+      p++;
+      break;
+   case 'q':
+      spec.mLength = LEN_LL;
+      p++;
+      break;
+   case 'L':
+      spec.mLength = LEN_BIG_L;
+      p++;
+      break;
+   case 'z':
+      spec.mLength = LEN_Z;
+      p++;
+      break;
+   case 'j':
+      spec.mLength = LEN_J;
+      p++;
+      break;
+   case 't':
+      spec.mLength = LEN_T;
+      p++;
+      break;
+   case 'I':
+      if (p[1] == '6' && p[2] == '4')
+      {
+         spec.mLength = LEN_LL;
+         p += 3;
+      }
+      break;
+   }
+
+   // Conversion
+   switch (*p)
+   {
+   case 'd':
+   case 'i':
+      spec.mType = ARG_INT;
+      break;
+   case 'c':
+      if (spec.mLength != LEN_NONE)
+      {
+         return FALSE;
+      }
+      spec.mType = ARG_INT;
+      break;
+   case 'u':
+   case 'o':
+   case 'x':
+   case 'X':
+      spec.mType = ARG_UINT;
+      break;
+   case 'f':
+   case 'F':
+   case 'e':
+   case 'E':
+   case 'g':
+   case 'G':
+   case 'a':
+   case 'A':
+      spec.mType = spec.mLength == LEN_BIG_L ? ARG_LONG_DOUBLE : ARG_DOUBLE;
+      break;
+   case 's':
+      if (spec.mLength != LEN_NONE)
+      {
+         return FALSE;
+      }
+      spec.mType = ARG_STRING;
+      break;
+   case 'p':
+      spec.mType = ARG_POINTER;
+      break;
+   case '%':
+      spec.mType = ARG_NONE;
+      break;
+   default:
+      // %n, wide characters and unknown conversions.
+      return FALSE;
+   }
+   spec.mpEnd = p + 1;
+
+   return TRUE;
+}
+
+// Store fixed size value to the entry. Return FALSE if there is no room.
+static UtlBoolean putValue(char*& pPos, const char* pEnd,
+                           const void* pValue, size_t size)
+{
+   if (pPos + ALIGN8(size) > pEnd)
+   {
+      return FALSE;
+   }
+   memcpy(pPos, pValue, size);
+   pPos += ALIGN8(size);
+   return TRUE;
+}
+
+// Read fixed size value from the entry.
+static void getValue(const char*& pPos, void* pValue, size_t size)
+{
+   memcpy(pValue, pPos, size);
+   pPos += ALIGN8(size);
+}
+
+static int64_t readSignedArg(LengthModifier length, va_list* pAp)
+{
+   switch (length)
+   {
+   case LEN_L:
+      return va_arg(*pAp, long);
+   case LEN_LL:
+      return va_arg(*pAp, long long);
+   case LEN_Z:
+      return (int64_t)va_arg(*pAp, size_t);
+   case LEN_J:
+      return va_arg(*pAp, intmax_t);
+   case LEN_T:
+      return va_arg(*pAp, ptrdiff_t);
+   default:
+      // char and short are promoted to int.
+      return va_arg(*pAp, int);
+   }
+}
+
+static uint64_t readUnsignedArg(LengthModifier length, va_list* pAp)
+{
+   switch (length)
+   {
+   case LEN_L:
+      return va_arg(*pAp, unsigned long);
+   case LEN_LL:
+      return va_arg(*pAp, unsigned long long);
+   case LEN_Z:
+      return va_arg(*pAp, size_t);
+   case LEN_J:
+      return va_arg(*pAp, uintmax_t);
+   case LEN_T:
+      return (uint64_t)va_arg(*pAp, ptrdiff_t);
+   default:
+      return va_arg(*pAp, unsigned int);
+   }
+}
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+OsSysLogRing* OsSysLogRing::getThreadRing()
+{
+#ifdef __pingtel_on_posix__
+   pthread_once(&sRingKeyOnce, createThreadKey);
+
+   OsSysLogRing* pRing = (OsSysLogRing*)pthread_getspecific(sRingKey);
+   if (pRing == NULL)
+   {
+      OsLock lock(sLock);
+
+      pRing = new OsSysLogRing(sRingSize);
+      pRing->mpNext = spRings;
+      spRings = pRing;
+      pthread_setspecific(sRingKey, pRing);
+   }
+   return pRing;
+#else
+   // No portable thread-local storage with cleanup on thread exit.
+   return NULL;
+#endif
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+void OsSysLogRing::setRingSize(int ringSize)
+{
+   int size = 4*MAX_ENTRY_SIZE;
+   while (size < ringSize)
+   {
+      size <<= 1;
+   }
+
+   OsLock lock(sLock);
+   sRingSize = size;
+}
+
+OsStatus OsSysLogRing::record(const OsTime& time,
+                              const char* taskName,
+                              OsTaskId_t taskId,
+                              OsSysLogFacility facility,
+                              OsSysLogPriority priority,
+                              const char* format,
+                              va_list ap)
+{
+   uint32_t head = (uint32_t)mHead.load(memory_order_relaxed);
+   uint32_t tail = (uint32_t)mTail.load(memory_order_acquire);
+   uint32_t offset = head & mMask;
+   uint32_t toEnd = mMask + 1 - offset;
+
+   // Entry must be contiguous, so skip the end of the buffer if the longest
+   // entry would not fit there.
+   uint32_t skip = toEnd < (uint32_t)MAX_ENTRY_SIZE ? toEnd : 0;
+   if (mMask + 1 - (head - tail) < skip + MAX_ENTRY_SIZE)
+   {
+      mDropped++;
+      return OS_LIMIT_REACHED;
+   }
+
+   char* pEntry = mpBuffer + ((head + skip) & mMask);
+   const char* pEnd = pEntry + MAX_ENTRY_SIZE;
+   EntryHeader* pHeader = (EntryHeader*)pEntry;
+   pHeader->mFacility = (uint8_t)facility;
+   pHeader->mPriority = (uint8_t)priority;
+   pHeader->mSeconds = time.seconds();
+   pHeader->mUsecs = time.usecs();
+   pHeader->mpFormat = format;
+
+   char* pPos = pEntry + sizeof(EntryHeader);
+   if (taskName != NULL)
+   {
+      size_t nameLength = strlen(taskName);
+      if (nameLength > MAX_TASK_NAME)
+      {
+         nameLength = MAX_TASK_NAME;
+      }
+      memcpy(pPos, taskName, nameLength);
+      pPos += ALIGN8(nameLength);
+      pHeader->mNameLength = (uint16_t)nameLength;
+      pHeader->mTaskId = taskId;
+   }
+   else
+   {
+      pHeader->mNameLength = 0;
+      pHeader->mTaskId = mTaskId;
+   }
+
+   // Store arguments in the order the format consumes them.
+   va_list args;
+   va_copy(args, ap);
+   const char* p = format;
+   while ((p = strchr(p, '%')) != NULL)
+   {
+      FormatSpec spec;
+      if (!parseSpec(p, spec))
+      {
+         va_end(args);
+         return OS_NOT_SUPPORTED;
+      }
+      p = spec.mpEnd;
+
+      UtlBoolean stored = TRUE;
+      if (spec.mWidthArg)
+      {
+         int64_t width = va_arg(args, int);
+         stored = stored && putValue(pPos, pEnd, &width, sizeof(width));
+      }
+      if (spec.mPrecisionArg)
+      {
+         int64_t precision = va_arg(args, int);
+         stored = stored && putValue(pPos, pEnd, &precision, sizeof(precision));
+      }
+
+      switch (spec.mType)
+      {
+      case ARG_NONE:
+         break;
+      case ARG_INT:
+         {
+            int64_t value = readSignedArg(spec.mLength, &args);
+            stored = stored && putValue(pPos, pEnd, &value, sizeof(value));
+         }
+         break;
+      case ARG_UINT:
+         {
+            uint64_t value = readUnsignedArg(spec.mLength, &args);
+            stored = stored && putValue(pPos, pEnd, &value, sizeof(value));
+         }
+         break;
+      case ARG_DOUBLE:
+         {
+            double value = va_arg(args, double);
+            stored = stored && putValue(pPos, pEnd, &value, sizeof(value));
+         }
+         break;
+      case ARG_LONG_DOUBLE:
+         {
+            long double value = va_arg(args, long double);
+            stored = stored && putValue(pPos, pEnd, &value, sizeof(value));
+         }
+         break;
+      case ARG_POINTER:
+         {
+            void* value = va_arg(args, void*);
+            stored = stored && putValue(pPos, pEnd, &value, sizeof(value));
+         }
+         break;
+      case ARG_STRING:
+         {
+            const char* value = va_arg(args, const char*);
+            if (value == NULL)
+            {
+               value = "(null)";
+            }
+            // Leave some room for the following arguments.
+            ptrdiff_t room = (pEnd - pPos) - (ptrdiff_t)sizeof(uint32_t) - 128;
+            if (room < 0)
+            {
+               stored = FALSE;
+               break;
+            }
+            uint32_t length = (uint32_t)strlen(value);
+            if (length > (uint32_t)room)
+            {
+               length = (uint32_t)room;
+            }
+            memcpy(pPos, &length, sizeof(length));
+            memcpy(pPos + sizeof(length), value, length);
+            pPos += ALIGN8(sizeof(length) + length);
+         }
+         break;
+      }
+
+      if (!stored)
+      {
+         // Too many arguments to fit into one entry.
+         va_end(args);
+         return OS_NOT_SUPPORTED;
+      }
+   }
+   va_end(args);
+
+   pHeader->mSize = (uint32_t)(pPos - pEntry);
+   if (skip > 0)
+   {
+      *(uint32_t*)(mpBuffer + offset) = WRAP_MARKER;
+   }
+   mHead.store(head + skip + pHeader->mSize, memory_order_release);
+
+   return OS_SUCCESS;
+}
+
+UtlBoolean OsSysLogRing::renderNext(Entry& entry)
+{
+   OsLock lock(sLock);
+
+   OsSysLogRing* pOldestRing = NULL;
+   EntryHeader* pOldest = NULL;
+   OsSysLogRing** ppRing = &spRings;
+   while (*ppRing != NULL)
+   {
+      OsSysLogRing* pRing = *ppRing;
+      EntryHeader* pHeader = pRing->peekEntry();
+      if (pHeader == NULL)
+      {
+         if (pRing->mAbandoned.load(memory_order_acquire))
+         {
+            // Owner thread has exited and everything is rendered.
+            *ppRing = pRing->mpNext;
+            sFreedDrops += pRing->mDropped;
+            sUnreportedFreedDrops += pRing->mDropped - pRing->mReportedDrops;
+            delete pRing;
+            continue;
+         }
+      }
+      else if (pOldest == NULL ||
+               pHeader->mSeconds < pOldest->mSeconds ||
+               (pHeader->mSeconds == pOldest->mSeconds &&
+                pHeader->mUsecs < pOldest->mUsecs))
+      {
+         pOldest = pHeader;
+         pOldestRing = pRing;
+      }
+      ppRing = &pRing->mpNext;
+   }
+
+   if (pOldest == NULL)
+   {
+      return FALSE;
+   }
+   pOldestRing->renderEntry(pOldest, entry);
+   return TRUE;
+}
+
+int OsSysLogRing::takeNewDrops()
+{
+   OsLock lock(sLock);
+
+   int drops = sUnreportedFreedDrops;
+   sUnreportedFreedDrops = 0;
+   for (OsSysLogRing* pRing = spRings; pRing != NULL; pRing = pRing->mpNext)
+   {
+      int32_t dropped = pRing->mDropped;
+      drops += dropped - pRing->mReportedDrops;
+      pRing->mReportedDrops = dropped;
+   }
+   return drops;
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int OsSysLogRing::getNumDropped()
+{
+   OsLock lock(sLock);
+
+   int drops = sFreedDrops;
+   for (OsSysLogRing* pRing = spRings; pRing != NULL; pRing = pRing->mpNext)
+   {
+      drops += pRing->mDropped;
+   }
+   return drops;
+}
+
+int OsSysLogRing::getUsedSize() const
+{
+   return (uint32_t)mHead - (uint32_t)mTail;
+}
+
+/* ============================ INQUIRY =================================== */
+
+UtlBoolean OsSysLogRing::isSupported()
+{
+#ifdef __pingtel_on_posix__
+   return TRUE;
+#else
+   return FALSE;
+#endif
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+OsSysLogRing::OsSysLogRing(int ringSize)
+: mpBuffer(new char[ringSize])
+, mMask(ringSize - 1)
+, mHead(0)
+, mTail(0)
+, mDropped(0)
+, mReportedDrops(0)
+, mAbandoned(0)
+, mTaskId(0)
+, mpNext(NULL)
+{
+   // Remember the owner task, so entries do not need to look it up.
+   // Id is taken from the thread itself, as the task object may not know
+   // it yet while the task is starting.
+   const char* taskName = "Anon";
+   OsTaskBase* pTask = OsTask::getCurrentTask();
+   if (pTask != NULL)
+   {
+      taskName = pTask->getName().data();
+   }
+   OsTask::getCurrentTaskId(mTaskId);
+   strncpy(mTaskName, taskName, MAX_TASK_NAME);
+   mTaskName[MAX_TASK_NAME] = '\0';
+}
+
+OsSysLogRing::~OsSysLogRing()
+{
+   delete[] mpBuffer;
+}
+
+OsSysLogRing::EntryHeader* OsSysLogRing::peekEntry()
+{
+   uint32_t tail = (uint32_t)mTail.load(memory_order_relaxed);
+   uint32_t head = (uint32_t)mHead.load(memory_order_acquire);
+   if (tail == head)
+   {
+      return NULL;
+   }
+
+   EntryHeader* pHeader = (EntryHeader*)(mpBuffer + (tail & mMask));
+   if (pHeader->mSize == WRAP_MARKER)
+   {
+      tail += mMask + 1 - (tail & mMask);
+      mTail.store(tail, memory_order_release);
+      if (tail == head)
+      {
+         return NULL;
+      }
+      pHeader = (EntryHeader*)mpBuffer;
+   }
+   return pHeader;
+}
+
+void OsSysLogRing::renderEntry(EntryHeader* pHeader, Entry& entry)
+{
+   const char* pPos = (const char*)pHeader + sizeof(EntryHeader);
+
+   entry.mTime = OsTime((long)pHeader->mSeconds, (long)pHeader->mUsecs);
+   entry.mFacility = (OsSysLogFacility)pHeader->mFacility;
+   entry.mPriority = (OsSysLogPriority)pHeader->mPriority;
+   entry.mTaskId = pHeader->mTaskId;
+   if (pHeader->mNameLength > 0)
+   {
+      entry.mTaskName.remove(0);
+      entry.mTaskName.append(pPos, pHeader->mNameLength);
+      pPos += ALIGN8(pHeader->mNameLength);
+   }
+   else
+   {
+      entry.mTaskName = mTaskName;
+   }
+
+   // Format arguments one by one, substituting width and precision
+   // arguments into the conversion specification.
+   entry.mMessage.remove(0);
+   const char* format = pHeader->mpFormat;
+   const char* p;
+   UtlString specStr;
+   UtlString strArg;
+   while ((p = strchr(format, '%')) != NULL)
+   {
+      entry.mMessage.append(format, p - format);
+
+      FormatSpec spec;
+      parseSpec(p, spec);
+      format = spec.mpEnd;
+
+      specStr.remove(0);
+      int64_t starValue;
+      for (const char* q = spec.mpStart; q < spec.mpEnd; q++)
+      {
+         if (*q == '*')
+         {
+            getValue(pPos, &starValue, sizeof(starValue));
+            specStr.appendFormat("%d", (int)starValue);
+         }
+         else
+         {
+            specStr.append(*q);
+         }
+      }
+
+      switch (spec.mType)
+      {
+      case ARG_NONE:
+         entry.mMessage.append('%');
+         break;
+      case ARG_INT:
+         {
+            int64_t value;
+            getValue(pPos, &value, sizeof(value));
+            switch (spec.mLength)
+            {
+            case LEN_L:
+               entry.mMessage.appendFormat(specStr.data(), (long)value);
+               break;
+            case LEN_LL:
+               entry.mMessage.appendFormat(specStr.data(), (long long)value);
+               break;
+            case LEN_Z:
+               entry.mMessage.appendFormat(specStr.data(), (size_t)value);
+               break;
+            case LEN_J:
+               entry.mMessage.appendFormat(specStr.data(), (intmax_t)value);
+               break;
+            case LEN_T:
+               entry.mMessage.appendFormat(specStr.data(), (ptrdiff_t)value);
+               break;
+            default:
+               entry.mMessage.appendFormat(specStr.data(), (int)value);
+               break;
+            }
+         }
+         break;
+      case ARG_UINT:
+         {
+            uint64_t value;
+            getValue(pPos, &value, sizeof(value));
+            switch (spec.mLength)
+            {
+            case LEN_L:
+               entry.mMessage.appendFormat(specStr.data(), (unsigned long)value);
+               break;
+            case LEN_LL:
+               entry.mMessage.appendFormat(specStr.data(), (unsigned long long)value);
+               break;
+            case LEN_Z:
+               entry.mMessage.appendFormat(specStr.data(), (size_t)value);
+               break;
+            case LEN_J:
+               entry.mMessage.appendFormat(specStr.data(), (uintmax_t)value);
+               break;
+            case LEN_T:
+               entry.mMessage.appendFormat(specStr.data(), (ptrdiff_t)value);
+               break;
+            default:
+               entry.mMessage.appendFormat(specStr.data(), (unsigned int)value);
+               break;
+            }
+         }
+         break;
+      case ARG_DOUBLE:
+         {
+            double value;
+            getValue(pPos, &value, sizeof(value));
+            entry.mMessage.appendFormat(specStr.data(), value);
+         }
+         break;
+      case ARG_LONG_DOUBLE:
+         {
+            long double value;
+            getValue(pPos, &value, sizeof(value));
+            entry.mMessage.appendFormat(specStr.data(), value);
+         }
+         break;
+      case ARG_POINTER:
+         {
+            void* value;
+            getValue(pPos, &value, sizeof(value));
+            entry.mMessage.appendFormat(specStr.data(), value);
+         }
+         break;
+      case ARG_STRING:
+         {
+            uint32_t length;
+            memcpy(&length, pPos, sizeof(length));
+            strArg.remove(0);
+            strArg.append(pPos + sizeof(length), length);
+            pPos += ALIGN8(sizeof(length) + length);
+            entry.mMessage.appendFormat(specStr.data(), strArg.data());
+         }
+         break;
+      }
+   }
+   entry.mMessage.append(format);
+
+   // Release the entry.
+   mTail.store((uint32_t)mTail.load(memory_order_relaxed) + pHeader->mSize,
+               memory_order_release);
+}
+
+void OsSysLogRing::createThreadKey()
+{
+#ifdef __pingtel_on_posix__
+   pthread_key_create(&sRingKey, abandonRing);
+#endif
+}
+
+void OsSysLogRing::abandonRing(void* pRing)
+{
+   // The ring is freed by the reader once it is drained.
+   ((OsSysLogRing*)pRing)->mAbandoned.store(1, memory_order_release);
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
@@ -28,6 +28,7 @@
 // APPLICATION INCLUDES
 #include "os/OsSysLogTask.h"
 #include "os/OsSysLogMsg.h"
+#include "os/OsSysLogRing.h"
 #include "os/OsStatus.h"
 #include "os/OsServerTask.h"
 #include "os/OsDateTime.h"
@@ -309,10 +310,14 @@ UtlBoolean OsSysLogTask::handleMessage(OsMsg& eventMessage)
             case OsSysLogMsg::SET_CALLBACK:
                processSetCallback((OsSysLogCallback) pSysLogMsg->getData());
                break ;
+            case OsSysLogMsg::DRAIN_RINGS:
+               processDrainRings();
+               break ;
             case OsSysLogMsg::SET_FLUSH_PERIOD:
                processSetFlushPeriod((intptr_t) pSysLogMsg->getData()) ;
                break ;
             case OsSysLogMsg::FLUSH_LOG:
+               processDrainRings();
                processFlushLog((OsEvent*) pSysLogMsg->getData());
                break ;
             default:
@@ -877,6 +882,41 @@ OsStatus OsSysLogTask::processSetCallback(OsSysLogCallback fn)
    return status;
 }
 
+// Render entries stored in binary logging mode
+OsStatus OsSysLogTask::processDrainRings()
+{
+   // Entries recorded from now on need a new wakeup.
+   OsSysLog::sDrainPending.store(0, memory_order_release);
+
+   OsSysLogRing::Entry entry;
+   UtlString logEntry;
+   while (OsSysLogRing::renderNext(entry))
+   {
+      OsSysLog::formatEntry(logEntry, entry.mTime, entry.mTaskName.data(),
+                            entry.mTaskId, entry.mFacility, entry.mPriority,
+                            entry.mMessage);
+      processAdd(strdup(logEntry.data()));
+      mLogCount++;
+   }
+
+   int drops = OsSysLogRing::takeNewDrops();
+   if (drops > 0)
+   {
+      OsTime timeNow;
+      OsDateTime::getCurTime(timeNow);
+      OsTaskId_t taskId = 0;
+      id(taskId);
+      UtlString message;
+      message.appendFormat("%d log entries dropped", drops);
+      OsSysLog::formatEntry(logEntry, timeNow, getName().data(), taskId,
+                            FAC_LOG, PRI_WARNING, message);
+      processAdd(strdup(logEntry.data()));
+      mLogCount++;
+   }
+
+   return OS_SUCCESS;
+}
+
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
@@ -98,6 +98,8 @@ OsTimerTask::~OsTimerTask()
    // been added to the incoming queue while we were waiting for the
    // OS_TIMER_SHUTDOWN message to get through the queue, as getTimerTask would
    // have waited for sLock.
+
+   delete[] mpTimerQueue;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -115,7 +117,10 @@ OsTimerTask::OsTimerTask(void)
 : OsServerTask("OsTimer-%d", NULL, TIMER_MAX_REQUEST_MSGS
               , 5 // high priority so that we get reasonable clock heartbeats for media
               )
-, mTimerQueue(0)
+, mpTimerQueue(NULL)
+, mTimerQueueSize(0)
+, mTimerQueueCapacity(0)
+, mTimerQueueSeq(0)
 , mSignalTimeout(0, 50000)
 {
 }
@@ -138,13 +143,13 @@ int OsTimerTask::run(void* pArg)
       // Do not attempt to receive message if a timer has already fired.
       // (This also avoids an edge case if the timeout value is zero
       // or negative.)
-      if (!mTimerQueue || (now < mTimerQueue->mQueuedExpiresAt))
+      if (!firstTimer() || (now < firstTimer()->mQueuedExpiresAt))
       {
          // Set the timeout till the next timer fires.
          OsTime timeout;
-         if (mTimerQueue)
+         if (firstTimer())
          {
-            timeout = mTimerQueue->mQueuedExpiresAt - now;
+            timeout = firstTimer()->mQueuedExpiresAt - now;
          }
          else
          {
@@ -178,15 +183,12 @@ int OsTimerTask::run(void* pArg)
       }
 
       // Now check for timers that have expired.
-      while (mTimerQueue &&
-             now >= mTimerQueue->mQueuedExpiresAt)
+      while (firstTimer() &&
+             now >= firstTimer()->mQueuedExpiresAt)
       {
          // Fire the the timer (and remove it from the queue).
-         OsTimer* timer = mTimerQueue;
-         mTimerQueue = timer->mTimerQueueLink;
-         // Clear the timer's mTimerQueueLink to indicate it is not
-         // in the timer queue.
-         timer->mTimerQueueLink = 0;
+         OsTimer* timer = firstTimer();
+         removeTimer(timer);
          fireTimer(timer);
       }
 
@@ -242,9 +244,10 @@ UtlBoolean OsTimerTask::handleMessage(OsMsg& rMsg)
       assert(getMessageQueue()->isEmpty());
 
       // Stop all the timers in the timer queue.
-      OsTimer* link;
-      for (OsTimer* timer = mTimerQueue; timer; timer = link)
+      for (int i = 0; i < mTimerQueueSize; i++)
       {
+         OsTimer* timer = mpTimerQueue[i];
+
          // This lock should never block, since the application should not
          // be accessing the timer.
          OsLock lock(timer->mBSem);
@@ -256,14 +259,11 @@ UtlBoolean OsTimerTask::handleMessage(OsMsg& rMsg)
          timer->mTaskState =
             timer->mApplicationState = timer->mApplicationState + 1;
 
-         // Get the link field.
-         link = timer->mTimerQueueLink;
-
-         // Clear the link field of the timer.
-         timer->mTimerQueueLink = 0;
+         // Mark the timer as not being in the queue.
+         timer->mTimerQueueIndex = -1;
       }
       // Empty the timer queue.
-      mTimerQueue = 0;
+      mTimerQueueSize = 0;
 
       // Change mState so the main loop will exit.
       requestShutdown();
@@ -443,9 +443,7 @@ void OsTimerTask::fireTimer(OsTimer* timer)
 // Insert a timer into the timer queue.
 void OsTimerTask::insertTimer(OsTimer* timer)
 {
-   OsTimer** previous_ptr;
-   OsTimer* current;
-   assert(timer->mTimerQueueLink == 0);
+   assert(timer->mTimerQueueIndex == -1);
    // Check to see if the firing time is in the past.
    // This is not an error, but is unusual and probably indicates a backlog
    // in processing.
@@ -465,62 +463,142 @@ void OsTimerTask::insertTimer(OsTimer* timer)
       }
    }
 
-   // Scan through the timer queue, looking for the right place to
-   // insert the timer.
-   for (previous_ptr = &mTimerQueue, current = mTimerQueue;
-        current && (timer->mQueuedExpiresAt > current->mQueuedExpiresAt);
-        previous_ptr = &current->mTimerQueueLink,
-           current = current->mTimerQueueLink)
+   // Grow the queue if it is full.
+   if (mTimerQueueSize == mTimerQueueCapacity)
    {
-      /* null */
+      int newCapacity = mTimerQueueCapacity > 0 ? 2*mTimerQueueCapacity
+                                                : TIMER_QUEUE_MIN_CAPACITY;
+      OsTimer** newQueue = new OsTimer*[newCapacity];
+      for (int i = 0; i < mTimerQueueSize; i++)
+      {
+         newQueue[i] = mpTimerQueue[i];
+      }
+      delete[] mpTimerQueue;
+      mpTimerQueue = newQueue;
+      mTimerQueueCapacity = newCapacity;
    }
 
-   // Insert the timer.
-   *previous_ptr = timer;
-   timer->mTimerQueueLink = current;
+   // Add the timer to the tail and move it to its place.
+   timer->mTimerQueueSeq = mTimerQueueSeq++;
+   setQueueEntry(mTimerQueueSize, timer);
+   mTimerQueueSize++;
+   siftUp(timer->mTimerQueueIndex);
 }
 
 // Remove a timer from the timer queue.
 void OsTimerTask::removeTimer(OsTimer* timer)
 {
-   OsTimer** previous_ptr;
-   OsTimer* current;
-
-   // Scan through the timer queue, looking for this timer.
-   for (previous_ptr = &mTimerQueue, current = mTimerQueue;
-        current && current != timer;
-        previous_ptr = &current->mTimerQueueLink,
-           current = current->mTimerQueueLink)
-   {
-      /* null */
-   }
+   int index = timer->mTimerQueueIndex;
 
-   // Remove the timer, if we found it.
-   if (!current)
+   // Check that the timer is really in the queue.
+   if (index < 0 || index >= mTimerQueueSize || mpTimerQueue[index] != timer)
    {
       OsSysLog::add(FAC_KERNEL, PRI_EMERG,
                     "OsTimerTask::removeTimer timer not found in queue");
       // mDeleting is not used if NDEBUG is defined, but we always initialize
       // it to FALSE in the constructors anyway.
       OsSysLog::add(FAC_KERNEL, PRI_EMERG,
-                    "OsTimerTask::removeTimer timer = %p, mApplicationState = %d, mTaskState = %d, mDeleting = %d, mPeriodic = %d, mTimerQueueLink = %p",
+                    "OsTimerTask::removeTimer timer = %p, mApplicationState = %d, mTaskState = %d, mDeleting = %d, mPeriodic = %d, mTimerQueueIndex = %d",
                     timer, timer->mApplicationState, timer->mTaskState, timer->mDeleting,
-                    timer->mPeriodic, timer->mTimerQueueLink);
-      OsTimer* p;
-      for (p = mTimerQueue; p; p = p->mTimerQueueLink)
+                    timer->mPeriodic, timer->mTimerQueueIndex);
+      for (int i = 0; i < mTimerQueueSize; i++)
       {
          OsSysLog::add(FAC_KERNEL, PRI_EMERG,
-                       "OsTimerTask::removeTimer in queue %p", p);
+                       "OsTimerTask::removeTimer in queue %p", mpTimerQueue[i]);
       }
       OsSysLog::add(FAC_KERNEL, PRI_EMERG,
                     "OsTimerTask::removeTimer end of queue");
+      assert(FALSE);
+      return;
+   }
+
+   // Replace the timer with the tail timer and restore the order.
+   mTimerQueueSize--;
+   if (index < mTimerQueueSize)
+   {
+      setQueueEntry(index, mpTimerQueue[mTimerQueueSize]);
+      if (index > 0 &&
+          firesBefore(mpTimerQueue[index],
+                      mpTimerQueue[(index - 1) / TIMER_QUEUE_ARITY]))
+      {
+         siftUp(index);
+      }
+      else
+      {
+         siftDown(index);
+      }
+   }
+   mpTimerQueue[mTimerQueueSize] = NULL;
+
+   // Mark the timer as not being in the queue.
+   timer->mTimerQueueIndex = -1;
+}
+
+UtlBoolean OsTimerTask::firesBefore(const OsTimer* a, const OsTimer* b)
+{
+   if (a->mQueuedExpiresAt != b->mQueuedExpiresAt)
+   {
+      return a->mQueuedExpiresAt < b->mQueuedExpiresAt;
+   }
+   // The later inserted timer fires first. Take wraparound into account.
+   return (int)(a->mTimerQueueSeq - b->mTimerQueueSeq) > 0;
+}
+
+void OsTimerTask::siftUp(int index)
+{
+   OsTimer* timer = mpTimerQueue[index];
+   while (index > 0)
+   {
+      int parent = (index - 1) / TIMER_QUEUE_ARITY;
+      if (!firesBefore(timer, mpTimerQueue[parent]))
+      {
+         break;
+      }
+      setQueueEntry(index, mpTimerQueue[parent]);
+      index = parent;
    }
-   assert(current);
+   setQueueEntry(index, timer);
+}
 
-   *previous_ptr = timer->mTimerQueueLink;
-   // Clear the timer's mTimerQueueLink to indicate it is not in the
-   // timer queue.
-   timer->mTimerQueueLink = 0;
+void OsTimerTask::siftDown(int index)
+{
+   OsTimer* timer = mpTimerQueue[index];
+   for (;;)
+   {
+      // Find the child which fires first.
+      int firstChild = index * TIMER_QUEUE_ARITY + 1;
+      if (firstChild >= mTimerQueueSize)
+      {
+         break;
+      }
+      int lastChild = firstChild + TIMER_QUEUE_ARITY;
+      if (lastChild > mTimerQueueSize)
+      {
+         lastChild = mTimerQueueSize;
+      }
+      int child = firstChild;
+      for (int i = firstChild + 1; i < lastChild; i++)
+      {
+         if (firesBefore(mpTimerQueue[i], mpTimerQueue[child]))
+         {
+            child = i;
+         }
+      }
+
+      if (!firesBefore(mpTimerQueue[child], timer))
+      {
+         break;
+      }
+      setQueueEntry(index, mpTimerQueue[child]);
+      index = child;
+   }
+   setQueueEntry(index, timer);
+}
+
+void OsTimerTask::setQueueEntry(int index, OsTimer* timer)
+{
+   mpTimerQueue[index] = timer;
+   timer->mTimerQueueIndex = index;
 }
 
 /* ============================ FUNCTIONS ================================= */
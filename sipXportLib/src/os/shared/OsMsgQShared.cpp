@@ -26,6 +26,29 @@
 // CONSTANTS
 // STATIC VARIABLE INITIALIZATIONS
 
+// Compute the time left till the end of a wait, which started at the given
+// time. Return FALSE if the timeout has expired.
+static UtlBoolean getTimeLeft(const OsTime& start, const OsTime& rTimeout,
+                              OsTime& timeLeft)
+{
+   if (rTimeout.isInfinite())
+   {
+      timeLeft = rTimeout;
+      return TRUE;
+   }
+
+   OsTime now;
+   OsDateTime::getCurTime(now);
+   OsTime elapsed = now - start;
+   if (!(elapsed < rTimeout))
+   {
+      return FALSE;
+   }
+   timeLeft = rTimeout;
+   timeLeft -= elapsed;
+   return TRUE;
+}
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* ============================ CREATORS ================================== */
@@ -44,9 +67,37 @@ OsMsgQShared::OsMsgQShared(const int maxMsgs, const int maxMsgLen,
 , mOptions(options)
 , mHighCnt(0)
 #endif
+, mpCells(NULL)
+, mRingMask(0)
+, mEnqueuePos(0)
+, mDequeuePos(0)
+, mpUrgentHead(NULL)
+, mMsgCount(0)
+, mReceiverWaiting(0)
+, mSendersWaiting(0)
+, mNotEmpty(OsBSem::Q_PRIORITY, OsBSem::EMPTY)
+, mNotFull(OsBSem::Q_PRIORITY, OsBSem::EMPTY)
 {
    mMaxMsgs = maxMsgs;
 
+   if (options & Q_LOCKFREE)
+   {
+      // Round the ring size up to a power of 2, so positions could be
+      // mapped to cells with a mask.
+      int32_t ringSize = 1;
+      while (ringSize < maxMsgs)
+      {
+         ringSize <<= 1;
+      }
+      mpCells = new Cell[ringSize];
+      for (int32_t i = 0; i < ringSize; i++)
+      {
+         mpCells[i].mSeq = i;
+         mpCells[i].mpMsg = NULL;
+      }
+      mRingMask = ringSize - 1;
+   }
+
 #ifdef OS_MSGQ_REPORTING
    mIncrementLevel = mMaxMsgs / 20;
    if (mIncrementLevel < 1)
@@ -79,6 +130,8 @@ OsMsgQShared::~OsMsgQShared()
 {
     if (numMsgs())
         flush();    // get rid of any messages in the queue
+
+    delete[] mpCells;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -126,6 +179,11 @@ OsStatus OsMsgQShared::receive(OsMsg*& rpMsg, const OsTime& rTimeout)
 // Return the number of messages in the queue
 int OsMsgQShared::numMsgs(void)
 {
+   if (mpCells != NULL)
+   {
+      return mMsgCount;
+   }
+
    OsLock lock(mGuard);
 
    return(mDlist.entries());
@@ -161,6 +219,11 @@ OsStatus OsMsgQShared::doSend(const OsMsg& rMsg, const OsTime& rTimeout,
    OsMsg*   pMsg;
    const void*    insResult;
 
+   if (mpCells != NULL)
+   {
+      return doLockFreeSend(rMsg, rTimeout, isUrgent, needCopy);
+   }
+
 #ifdef MSGQ_IS_VALID_CHECK /* [ */
    int      msgCnt;
 
@@ -345,6 +408,11 @@ OsStatus OsMsgQShared::doReceive(OsMsg*& rpMsg, const OsTime& rTimeout)
 
    rpMsg = NULL;
 
+   if (mpCells != NULL)
+   {
+      return doLockFreeReceive(rpMsg, rTimeout);
+   }
+
 #ifdef MSGQ_IS_VALID_CHECK /* [ */
    ret = mGuard.acquire();         // start critical section
    assert(ret == OS_SUCCESS);
@@ -409,6 +477,184 @@ OsStatus OsMsgQShared::doReceive(OsMsg*& rpMsg, const OsTime& rTimeout)
    return ret;
 }
 
+OsStatus OsMsgQShared::doLockFreeSend(const OsMsg& rMsg, const OsTime& rTimeout,
+                                      const UtlBoolean isUrgent,
+                                      const UtlBoolean needCopy)
+{
+   OsMsg* pMsg;
+
+   if (mSendHookFunc != NULL && mSendHookFunc(rMsg))
+   {
+      // Message has been handled by the hook.
+      return OS_SUCCESS;
+   }
+
+   if (!reserveMsg())
+   {
+      // The queue is full, wait for the receiver to make room.
+      if (rTimeout.isNoWait())
+      {
+         return OS_WAIT_TIMEOUT;
+      }
+
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      // Increment of the waiters count orders it with our reserveMsg()
+      // calls below, the receiver does the opposite.
+      mSendersWaiting++;
+      while (!reserveMsg())
+      {
+         OsTime timeLeft;
+         if (!getTimeLeft(start, rTimeout, timeLeft))
+         {
+            mSendersWaiting--;
+            return OS_WAIT_TIMEOUT;
+         }
+         mNotFull.acquire(timeLeft);
+      }
+      // Binary semaphore may have swallowed a wakeup meant for another
+      // sender, so pass it on if there is still room.
+      if (--mSendersWaiting > 0 && mMsgCount < mMaxMsgs)
+      {
+         mNotFull.release();
+      }
+   }
+
+   if (!needCopy || rMsg.isMsgReusable())
+   {
+      pMsg = (OsMsg*) &rMsg;
+   }
+   else
+   {
+      pMsg = rMsg.createCopy();
+   }
+
+   if (isUrgent)
+   {
+      // Push the message onto the urgent stack, so it is received before
+      // all messages in the ring and before previously sent urgent messages.
+      UrgentNode* pNode = new UrgentNode;
+      pNode->mpMsg = pMsg;
+      UrgentNode* pHead = mpUrgentHead;
+      do
+      {
+         pNode->mpNext = pHead;
+      } while (!mpUrgentHead.compare_exchange(pHead, pNode));
+   }
+   else
+   {
+      int32_t pos = mEnqueuePos++;
+      Cell* pCell = &mpCells[pos & mRingMask];
+      // The cell is free, as we have reserved room for the message. Wait for
+      // the receiver to finish releasing it, if it has not yet.
+      while (pCell->mSeq.load(memory_order_acquire) != pos)
+      {
+         // Spin, the receiver is in the middle of a few instructions.
+      }
+      pCell->mpMsg = pMsg;
+      pCell->mSeq.store((uint32_t)pos + 1, memory_order_release);
+   }
+
+   // Wake up the receiver if it is waiting. Fence orders the message
+   // publication above with the load of the waiting flag, receiver does
+   // the opposite.
+   mReceiverWaiting.fence(memory_order_seq_cst);
+   int32_t waiting = 1;
+   if (mReceiverWaiting.load(memory_order_relaxed) &&
+       mReceiverWaiting.compare_exchange(waiting, 0))
+   {
+      mNotEmpty.release();
+   }
+
+   return OS_SUCCESS;
+}
+
+OsStatus OsMsgQShared::doLockFreeReceive(OsMsg*& rpMsg, const OsTime& rTimeout)
+{
+   if (tryLockFreeReceive(rpMsg))
+   {
+      return OS_SUCCESS;
+   }
+   if (rTimeout.isNoWait())
+   {
+      return OS_WAIT_TIMEOUT;
+   }
+
+   OsTime start;
+   OsDateTime::getCurTime(start);
+   while (TRUE)
+   {
+      // Sequentially consistent store orders the flag with the loads below.
+      mReceiverWaiting = 1;
+      if (tryLockFreeReceive(rpMsg))
+      {
+         mReceiverWaiting = 0;
+         return OS_SUCCESS;
+      }
+
+      OsTime timeLeft;
+      if (!getTimeLeft(start, rTimeout, timeLeft))
+      {
+         mReceiverWaiting = 0;
+         return OS_WAIT_TIMEOUT;
+      }
+      mNotEmpty.acquire(timeLeft);
+   }
+}
+
+UtlBoolean OsMsgQShared::reserveMsg()
+{
+   int32_t count = mMsgCount;
+   while (count < mMaxMsgs)
+   {
+      // On failure count is updated with the current value.
+      if (mMsgCount.compare_exchange(count, count + 1))
+      {
+         return TRUE;
+      }
+   }
+   return FALSE;
+}
+
+UtlBoolean OsMsgQShared::tryLockFreeReceive(OsMsg*& rpMsg)
+{
+   UrgentNode* pHead = mpUrgentHead;
+   if (pHead != NULL)
+   {
+      // Only the receiver pops from the stack, so the top node could not
+      // be freed under us, only new nodes could be pushed on top of it.
+      while (!mpUrgentHead.compare_exchange(pHead, pHead->mpNext))
+      {
+      }
+      rpMsg = pHead->mpMsg;
+      delete pHead;
+   }
+   else
+   {
+      Cell* pCell = &mpCells[mDequeuePos & mRingMask];
+      if (pCell->mSeq.load(memory_order_acquire) != (int32_t)((uint32_t)mDequeuePos + 1))
+      {
+         // Ring is empty or the next message is not completely sent yet.
+         return FALSE;
+      }
+      rpMsg = pCell->mpMsg;
+      pCell->mpMsg = NULL;
+      pCell->mSeq.store((uint32_t)mDequeuePos + mRingMask + 1,
+                        memory_order_release);
+      mDequeuePos = (uint32_t)mDequeuePos + 1;
+   }
+
+   // Wake up a sender if some are waiting for room. Decrement orders
+   // the count update with the load of the waiters count.
+   mMsgCount--;
+   if (mSendersWaiting > 0)
+   {
+      mNotFull.release();
+   }
+
+   return TRUE;
+}
+
 #if defined(MSGQ_IS_VALID_CHECK) && defined(OS_CSEM_DEBUG) /* [ */
 // Test for message queue integrity
 void OsMsgQShared::testMessageQ()
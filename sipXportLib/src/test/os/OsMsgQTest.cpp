@@ -11,13 +11,65 @@
 // $$
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <stdio.h>
+
+#include <os/OsDateTime.h>
 #include <os/OsExcept.h>
+#include <os/OsIntPtrMsg.h>
 #include <os/OsMsg.h>
 #include <os/OsMsgQ.h>
+#include <os/OsTask.h>
 #include <sipxunittests.h>
 
+#define NUM_SENDERS       4
+#define MSGS_PER_SENDER   100000
+
 UtlBoolean gMsgReceived;
 
+/// Task sending numbered messages to a queue.
+class MsgQSenderTask : public OsTask
+{
+public:
+   MsgQSenderTask(OsMsgQ* pQueue, int senderId, int numMsgs)
+   : mpQueue(pQueue)
+   , mSenderId(senderId)
+   , mNumMsgs(numMsgs)
+   , mNumFailed(0)
+   {
+   }
+
+   ~MsgQSenderTask()
+   {
+      waitUntilShutDown();
+   }
+
+   int run(void* pArg)
+   {
+      for (int i = 0; i < mNumMsgs; i++)
+      {
+         OsIntPtrMsg msg(OsMsg::USER_START, 0, mSenderId, i);
+         if (mpQueue->send(msg) != OS_SUCCESS)
+         {
+            mNumFailed++;
+         }
+      }
+      return 0;
+   }
+
+   UtlBoolean waitUntilShutDown()
+   {
+      return OsTask::waitUntilShutDown();
+   }
+
+   int getNumFailed() const { return mNumFailed; }
+
+protected:
+   OsMsgQ* mpQueue;
+   int mSenderId;
+   int mNumMsgs;
+   int mNumFailed;
+};
+
 UtlBoolean msgSendHook(const OsMsg& rOsMsg)
 {
     gMsgReceived = TRUE;
@@ -29,11 +81,56 @@ class OsMsgQTest : public SIPX_UNIT_BASE_CLASS
 {
     CPPUNIT_TEST_SUITE(OsMsgQTest);
     CPPUNIT_TEST(testMessageQueue);
+    CPPUNIT_TEST(testLockFreeMessageQueue);
+    CPPUNIT_TEST(testUrgentOrder);
+    CPPUNIT_TEST(testTimeouts);
+    CPPUNIT_TEST(testThroughput);
     CPPUNIT_TEST_SUITE_END();
 
 public:
 
     void testMessageQueue()
+    {
+        checkMessageQueue(OsMsgQ::Q_PRIORITY);
+    }
+
+    void testLockFreeMessageQueue()
+    {
+        checkMessageQueue(OsMsgQ::Q_PRIORITY | OsMsgQ::Q_LOCKFREE);
+    }
+
+    void testUrgentOrder()
+    {
+        checkUrgentOrder(OsMsgQ::Q_PRIORITY);
+        checkUrgentOrder(OsMsgQ::Q_PRIORITY | OsMsgQ::Q_LOCKFREE);
+    }
+
+    void testTimeouts()
+    {
+        checkTimeouts(OsMsgQ::Q_PRIORITY);
+        checkTimeouts(OsMsgQ::Q_PRIORITY | OsMsgQ::Q_LOCKFREE);
+    }
+
+    void testThroughput()
+    {
+        // Compare both implementations with one and many senders.
+        double lockedRate = measureThroughput(OsMsgQ::Q_PRIORITY, 1);
+        double lockFreeRate = measureThroughput(OsMsgQ::Q_PRIORITY | OsMsgQ::Q_LOCKFREE, 1);
+        printf("OsMsgQTest::testThroughput 1 sender: "
+               "default %.0f msgs/sec, lock-free %.0f msgs/sec\n",
+               lockedRate, lockFreeRate);
+
+        lockedRate = measureThroughput(OsMsgQ::Q_PRIORITY, NUM_SENDERS);
+        lockFreeRate = measureThroughput(OsMsgQ::Q_PRIORITY | OsMsgQ::Q_LOCKFREE,
+                                         NUM_SENDERS);
+        printf("OsMsgQTest::testThroughput %d senders: "
+               "default %.0f msgs/sec, lock-free %.0f msgs/sec\n",
+               NUM_SENDERS, lockedRate, lockFreeRate);
+    }
+
+protected:
+
+    void checkMessageQueue(int options)
     {
         OsMsgQ* pMsgQ1;
         OsMsg* pMsg1;
@@ -41,7 +138,7 @@ public:
         OsMsg* pRecvMsg;
         
         pMsgQ1 = new OsMsgQ(OsMsgQ::DEF_MAX_MSGS, OsMsgQ::DEF_MAX_MSG_LEN,
-                       OsMsgQ::Q_PRIORITY, "MQ1");
+                       options, "MQ1");
 
         pMsg1  = new OsMsg(OsMsg::UNSPECIFIED, 0);
         pMsg2  = new OsMsg(OsMsg::UNSPECIFIED, 0);
@@ -81,6 +178,113 @@ public:
         delete pMsg2;
         delete pMsgQ1;
     }
+
+    void checkUrgentOrder(int options)
+    {
+        OsMsgQ msgQ(10, OsMsgQ::DEF_MAX_MSG_LEN, options);
+        OsMsg* pRecvMsg;
+
+        // Urgent messages are received before normal ones, the latest first.
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.send(OsIntPtrMsg(OsMsg::USER_START, 0, 1)));
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.send(OsIntPtrMsg(OsMsg::USER_START, 0, 2)));
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.sendUrgent(OsIntPtrMsg(OsMsg::USER_START, 0, 3)));
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.send(OsIntPtrMsg(OsMsg::USER_START, 0, 4)));
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.sendUrgent(OsIntPtrMsg(OsMsg::USER_START, 0, 5)));
+        CPPUNIT_ASSERT_EQUAL(5, msgQ.numMsgs());
+
+        const intptr_t expected[] = {5, 3, 1, 2, 4};
+        for (int i = 0; i < 5; i++)
+        {
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.receive(pRecvMsg, OsTime::NO_WAIT_TIME));
+            CPPUNIT_ASSERT_EQUAL(expected[i], ((OsIntPtrMsg*)pRecvMsg)->getData1());
+            pRecvMsg->releaseMsg();
+        }
+        CPPUNIT_ASSERT(msgQ.isEmpty());
+    }
+
+    void checkTimeouts(int options)
+    {
+        const int queueSize = 3;
+        OsMsgQ msgQ(queueSize, OsMsgQ::DEF_MAX_MSG_LEN, options);
+        OsMsg msg(OsMsg::UNSPECIFIED, 0);
+        OsMsg* pRecvMsg;
+        OsTime start;
+        OsTime end;
+
+        // Receive from an empty queue times out.
+        CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT, msgQ.receive(pRecvMsg, OsTime::NO_WAIT_TIME));
+        OsDateTime::getCurTime(start);
+        CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT, msgQ.receive(pRecvMsg, OsTime(0, 100000)));
+        OsDateTime::getCurTime(end);
+        CPPUNIT_ASSERT((end - start).cvtToMsecs() >= 90);
+
+        // Send to a full queue times out, urgent messages included.
+        for (int i = 0; i < queueSize; i++)
+        {
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.send(msg, OsTime::NO_WAIT_TIME));
+        }
+        CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT, msgQ.send(msg, OsTime::NO_WAIT_TIME));
+        CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT, msgQ.sendUrgent(msg, OsTime::NO_WAIT_TIME));
+        OsDateTime::getCurTime(start);
+        CPPUNIT_ASSERT_EQUAL(OS_WAIT_TIMEOUT, msgQ.send(msg, OsTime(0, 100000)));
+        OsDateTime::getCurTime(end);
+        CPPUNIT_ASSERT((end - start).cvtToMsecs() >= 90);
+        CPPUNIT_ASSERT_EQUAL(queueSize, msgQ.numMsgs());
+
+        // Room made by the receiver is available again.
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.receive(pRecvMsg, OsTime::NO_WAIT_TIME));
+        pRecvMsg->releaseMsg();
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.send(msg, OsTime::NO_WAIT_TIME));
+        CPPUNIT_ASSERT_EQUAL(queueSize, msgQ.numMsgs());
+    }
+
+    // Return number of messages passed per second.
+    double measureThroughput(int options, int numSenders)
+    {
+        OsMsgQ msgQ(OsMsgQ::DEF_MAX_MSGS, OsMsgQ::DEF_MAX_MSG_LEN, options);
+        MsgQSenderTask* senders[NUM_SENDERS];
+        intptr_t nextSeq[NUM_SENDERS];
+        int totalMsgs = numSenders * MSGS_PER_SENDER;
+        int i;
+
+        for (i = 0; i < numSenders; i++)
+        {
+            senders[i] = new MsgQSenderTask(&msgQ, i, MSGS_PER_SENDER);
+            nextSeq[i] = 0;
+        }
+
+        OsTime start;
+        OsDateTime::getCurTime(start);
+        for (i = 0; i < numSenders; i++)
+        {
+            senders[i]->start();
+        }
+
+        // Messages of every sender must arrive in order.
+        for (i = 0; i < totalMsgs; i++)
+        {
+            OsMsg* pRecvMsg;
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, msgQ.receive(pRecvMsg, OsTime(10, 0)));
+            OsIntPtrMsg* pMsg = (OsIntPtrMsg*)pRecvMsg;
+            int sender = (int)pMsg->getData1();
+            CPPUNIT_ASSERT(sender >= 0 && sender < numSenders);
+            CPPUNIT_ASSERT_EQUAL(nextSeq[sender], pMsg->getData2());
+            nextSeq[sender]++;
+            pRecvMsg->releaseMsg();
+        }
+        OsTime end;
+        OsDateTime::getCurTime(end);
+
+        for (i = 0; i < numSenders; i++)
+        {
+            senders[i]->waitUntilShutDown();
+            CPPUNIT_ASSERT_EQUAL(0, senders[i]->getNumFailed());
+            delete senders[i];
+        }
+        CPPUNIT_ASSERT(msgQ.isEmpty());
+
+        return totalMsgs / (end - start).getDouble();
+    }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(OsMsgQTest);
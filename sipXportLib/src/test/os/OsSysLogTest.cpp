@@ -0,0 +1,407 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+
+#include <os/OsBSem.h>
+#include <os/OsDateTime.h>
+#include <os/OsLock.h>
+#include <os/OsMutex.h>
+#include <os/OsSysLog.h>
+#include <os/OsSysLogRing.h>
+#include <os/OsTask.h>
+#include <utl/UtlSList.h>
+#include <utl/UtlSListIterator.h>
+#include <utl/UtlString.h>
+#include <sipxunittests.h>
+
+#define NUM_LOG_TASKS        4
+#define ENTRIES_PER_TASK     1000
+#define NUM_FLOOD_ENTRIES    1000
+#define NUM_PERF_ENTRIES     20000
+
+// Log entries passed to the callback, guarded by sEntriesLock.
+static OsMutex sEntriesLock(OsMutex::Q_FIFO);
+static UtlSList* spEntries = NULL;
+// Callback blocks on sBlockSem while sBlockCallback is set.
+static volatile UtlBoolean sBlockCallback = FALSE;
+static OsBSem sBlockSem(OsBSem::Q_PRIORITY, OsBSem::EMPTY);
+
+static void collectEntry(const char* szPriority,
+                         const char* szSource,
+                         const char* szMsg)
+{
+   if (sBlockCallback)
+   {
+      sBlockCallback = FALSE;
+      sBlockSem.acquire();
+   }
+
+   OsLock lock(sEntriesLock);
+   if (spEntries != NULL)
+   {
+      spEntries->append(new UtlString(szMsg));
+   }
+}
+
+/// Task writing numbered log entries.
+class LogTask : public OsTask
+{
+public:
+   LogTask(int taskNum, int numEntries)
+   : mTaskNum(taskNum)
+   , mNumEntries(numEntries)
+   {
+   }
+
+   ~LogTask()
+   {
+      waitUntilShutDown();
+   }
+
+   int run(void* pArg)
+   {
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      for (int i = 0; i < mNumEntries; i++)
+      {
+         OsSysLog::add(FAC_APP, PRI_INFO, "task %d entry %d", mTaskNum, i);
+      }
+      OsDateTime::getCurTime(mElapsed);
+      mElapsed -= start;
+      return 0;
+   }
+
+   UtlBoolean waitUntilShutDown()
+   {
+      return OsTask::waitUntilShutDown();
+   }
+
+   /// Return time spent logging, in seconds.
+   double getElapsed() const
+   {
+      return mElapsed.seconds() + mElapsed.usecs() / 1000000.0;
+   }
+
+protected:
+   int mTaskNum;
+   int mNumEntries;
+   OsTime mElapsed;
+};
+
+class OsSysLogTest : public SIPX_UNIT_BASE_CLASS
+{
+    CPPUNIT_TEST_SUITE(OsSysLogTest);
+    CPPUNIT_TEST(testBinaryFormatting);
+    CPPUNIT_TEST(testBinaryOrdering);
+    CPPUNIT_TEST(testBinaryDrops);
+    CPPUNIT_TEST(testThroughput);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+
+    void setUp()
+    {
+        {
+            OsLock lock(sEntriesLock);
+            spEntries = new UtlSList;
+        }
+        OsSysLog::setCallbackFunction(collectEntry);
+        OsSysLog::flush();
+        clearEntries();
+    }
+
+    void tearDown()
+    {
+        OsSysLog::setBinaryLogging(FALSE, OsSysLogRing::DEF_RING_SIZE);
+        OsSysLog::setCallbackFunction(NULL);
+        OsSysLog::flush();
+
+        OsLock lock(sEntriesLock);
+        spEntries->destroyAll();
+        delete spEntries;
+        spEntries = NULL;
+    }
+
+    void testBinaryFormatting()
+    {
+        if (!OsSysLogRing::isSupported())
+        {
+            return;
+        }
+
+        // Binary entries must be rendered exactly as text mode formats them.
+        UtlSList textEntries;
+        logFormats();
+        OsSysLog::flush();
+        takeEntries("APP", textEntries);
+
+        UtlSList binaryEntries;
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, OsSysLog::setBinaryLogging(TRUE));
+        logFormats();
+        OsSysLog::flush();
+        takeEntries("APP", binaryEntries);
+
+        CPPUNIT_ASSERT(textEntries.entries() > 0);
+        CPPUNIT_ASSERT_EQUAL(textEntries.entries(), binaryEntries.entries());
+        UtlSListIterator textIter(textEntries);
+        UtlSListIterator binaryIter(binaryEntries);
+        UtlString* pText;
+        while ((pText = (UtlString*)textIter()) != NULL)
+        {
+            UtlString* pBinary = (UtlString*)binaryIter();
+            UtlString textFields[9];
+            UtlString binaryFields[9];
+            parseEntry(*pText, textFields);
+            parseEntry(*pBinary, binaryFields);
+
+            // Everything but the date and event count must match.
+            for (int i = 2; i < 9; i++)
+            {
+                CPPUNIT_ASSERT_EQUAL(textFields[i], binaryFields[i]);
+            }
+        }
+        textEntries.destroyAll();
+        binaryEntries.destroyAll();
+
+        // Formats which could not be stored fall back to text mode.
+        OsSysLog::add(FAC_APP, PRI_INFO, "wide %ls", L"text");
+        OsSysLog::flush();
+        takeEntries("APP", binaryEntries);
+        CPPUNIT_ASSERT_EQUAL(1, (int)binaryEntries.entries());
+        UtlString fields[9];
+        parseEntry(*(UtlString*)binaryEntries.first(), fields);
+        CPPUNIT_ASSERT_EQUAL(UtlString("wide text"), fields[8]);
+        binaryEntries.destroyAll();
+
+        // Long strings are truncated to fit into one entry.
+        UtlString longString;
+        for (int i = 0; i < 2*OsSysLogRing::MAX_ENTRY_SIZE; i++)
+        {
+            longString.append('a' + i % 26);
+        }
+        OsSysLog::add(FAC_APP, PRI_INFO, "long %s end", longString.data());
+        OsSysLog::flush();
+        takeEntries("APP", binaryEntries);
+        CPPUNIT_ASSERT_EQUAL(1, (int)binaryEntries.entries());
+        parseEntry(*(UtlString*)binaryEntries.first(), fields);
+        CPPUNIT_ASSERT(fields[8].length() < (size_t)OsSysLogRing::MAX_ENTRY_SIZE);
+        CPPUNIT_ASSERT_EQUAL(0, (int)fields[8].index("long abcdefghij"));
+        CPPUNIT_ASSERT_EQUAL(fields[8].length() - 4, fields[8].index(" end"));
+        binaryEntries.destroyAll();
+    }
+
+    void testBinaryOrdering()
+    {
+        if (!OsSysLogRing::isSupported())
+        {
+            return;
+        }
+
+        // Rings of several threads are merged in timestamp order.
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                             OsSysLog::setBinaryLogging(TRUE, 256*1024));
+        int droppedBefore = OsSysLog::getNumDroppedEntries();
+
+        LogTask* pTasks[NUM_LOG_TASKS];
+        for (int i = 0; i < NUM_LOG_TASKS; i++)
+        {
+            pTasks[i] = new LogTask(i, ENTRIES_PER_TASK);
+            CPPUNIT_ASSERT(pTasks[i]->start());
+        }
+        for (int i = 0; i < NUM_LOG_TASKS; i++)
+        {
+            delete pTasks[i];
+        }
+        OsSysLog::flush();
+        CPPUNIT_ASSERT_EQUAL(droppedBefore, OsSysLog::getNumDroppedEntries());
+
+        UtlSList entries;
+        takeEntries("APP", entries);
+        CPPUNIT_ASSERT_EQUAL(NUM_LOG_TASKS*ENTRIES_PER_TASK,
+                             (int)entries.entries());
+
+        int nextEntry[NUM_LOG_TASKS] = {0};
+        UtlString lastDate;
+        UtlSListIterator iter(entries);
+        UtlString* pEntry;
+        while ((pEntry = (UtlString*)iter()) != NULL)
+        {
+            UtlString fields[9];
+            parseEntry(*pEntry, fields);
+            CPPUNIT_ASSERT(lastDate.compareTo(fields[0]) <= 0);
+            lastDate = fields[0];
+
+            int taskNum = -1;
+            int entryNum = -1;
+            CPPUNIT_ASSERT_EQUAL(2, sscanf(fields[8].data(), "task %d entry %d",
+                                           &taskNum, &entryNum));
+            CPPUNIT_ASSERT(taskNum >= 0 && taskNum < NUM_LOG_TASKS);
+            CPPUNIT_ASSERT_EQUAL(nextEntry[taskNum], entryNum);
+            nextEntry[taskNum]++;
+        }
+        entries.destroyAll();
+    }
+
+    void testBinaryDrops()
+    {
+        if (!OsSysLogRing::isSupported())
+        {
+            return;
+        }
+
+        // Use the smallest rings, so the flood overflows.
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, OsSysLog::setBinaryLogging(TRUE, 1));
+        int droppedBefore = OsSysLog::getNumDroppedEntries();
+
+        // Stall the logger task in the callback, so nothing is drained.
+        sBlockCallback = TRUE;
+        OsSysLog::add(FAC_LOG, PRI_INFO, "stall the logger");
+        while (sBlockCallback)
+        {
+            OsTask::delay(1);
+        }
+
+        LogTask* pTask = new LogTask(0, NUM_FLOOD_ENTRIES);
+        CPPUNIT_ASSERT(pTask->start());
+        delete pTask;
+
+        int dropped = OsSysLog::getNumDroppedEntries() - droppedBefore;
+        CPPUNIT_ASSERT(dropped > 0);
+        CPPUNIT_ASSERT(dropped < NUM_FLOOD_ENTRIES);
+
+        sBlockSem.release();
+        OsSysLog::flush();
+
+        // Entries are dropped only when the ring is full, so the rendered
+        // ones are the first ones. Dropped count also includes entries
+        // logged by the task on exit.
+        UtlSList entries;
+        takeEntries("APP", entries);
+        int numRendered = entries.entries();
+        CPPUNIT_ASSERT(numRendered >= NUM_FLOOD_ENTRIES - dropped);
+        CPPUNIT_ASSERT(numRendered < NUM_FLOOD_ENTRIES);
+        int entryNum = 0;
+        UtlSListIterator floodIter(entries);
+        UtlString* pEntry;
+        while ((pEntry = (UtlString*)floodIter()) != NULL)
+        {
+            UtlString fields[9];
+            parseEntry(*pEntry, fields);
+            UtlString expected;
+            expected.appendFormat("task 0 entry %d", entryNum++);
+            CPPUNIT_ASSERT_EQUAL(expected, fields[8]);
+        }
+        entries.destroyAll();
+
+        takeEntries("LOG", entries);
+        UtlString expected;
+        expected.appendFormat("%d log entries dropped", dropped);
+        UtlBoolean reported = FALSE;
+        UtlSListIterator iter(entries);
+        while ((pEntry = (UtlString*)iter()) != NULL)
+        {
+            UtlString fields[9];
+            parseEntry(*pEntry, fields);
+            if (fields[8] == expected)
+            {
+                CPPUNIT_ASSERT_EQUAL(UtlString("WARNING"), fields[3]);
+                reported = TRUE;
+            }
+        }
+        CPPUNIT_ASSERT(reported);
+        entries.destroyAll();
+    }
+
+    void testThroughput()
+    {
+        if (!OsSysLogRing::isSupported())
+        {
+            return;
+        }
+
+        // Compare cost of a log call on the logging thread in both modes.
+        // Rings are large enough to hold all entries, so nothing is dropped.
+        OsSysLog::setCallbackFunction(NULL);
+        double textRate = measureThroughput(FALSE);
+        int droppedBefore = OsSysLog::getNumDroppedEntries();
+        double binaryRate = measureThroughput(TRUE);
+        CPPUNIT_ASSERT_EQUAL(droppedBefore, OsSysLog::getNumDroppedEntries());
+        printf("OsSysLogTest::testThroughput text %.0f entries/sec, "
+               "binary %.0f entries/sec\n", textRate, binaryRate);
+    }
+
+protected:
+
+    void logFormats()
+    {
+        OsSysLog::add(FAC_APP, PRI_INFO, "plain text");
+        OsSysLog::add(FAC_APP, PRI_WARNING, "int %d %i %5d %-5d| %05d %+d",
+                      -42, 7, 12, 12, 34, 5);
+        OsSysLog::add(FAC_APP, PRI_INFO, "unsigned %u %x %X %#o %hu %hhx",
+                      4000000000u, 0xbeef, 0xBEEF, 8,
+                      (unsigned short)65535, (unsigned char)255);
+        OsSysLog::add(FAC_APP, PRI_INFO, "long %ld %lu %lld %llu %zu",
+                      -1234567890L, 1234567890UL, -9000000000LL,
+                      18000000000ULL, (size_t)77);
+        OsSysLog::add(FAC_APP, PRI_INFO, "double %f %5.2f %e %g %.3G %Lf",
+                      3.14159, 2.5, 1e-10, 1e20, 0.000123, (long double)1.25);
+        OsSysLog::add(FAC_APP, PRI_INFO, "string %s %10s %-10s| %.3s",
+                      "abc", "right", "left", "truncated");
+        OsSysLog::add(FAC_APP, PRI_INFO, "star %*d %-*d| %.*f %*.*s",
+                      6, 42, 4, 7, 2, 1.23456, 8, 3, "abcdef");
+        OsSysLog::add(FAC_APP, PRI_INFO, "char %c%c%c percent %% pointer %p",
+                      'x', 'y', 'z', (void*)0x1234);
+        OsSysLog::add(FAC_APP, PRI_INFO, "quote \"%s\"\nsecond line", "q");
+        OsSysLog::add("ExplicitTask", 0x1234, FAC_APP, PRI_ERR,
+                      "explicit task %d", 1);
+    }
+
+    double measureThroughput(UtlBoolean binary)
+    {
+        OsSysLog::setBinaryLogging(binary, 4*1024*1024);
+
+        LogTask task(0, NUM_PERF_ENTRIES);
+        task.start();
+        task.waitUntilShutDown();
+        OsSysLog::flush();
+
+        return NUM_PERF_ENTRIES / task.getElapsed();
+    }
+
+    static void clearEntries()
+    {
+        OsLock lock(sEntriesLock);
+        spEntries->destroyAll();
+    }
+
+    /// Move collected entries of the facility to the list.
+    static void takeEntries(const char* facility, UtlSList& entries)
+    {
+        OsLock lock(sEntriesLock);
+        UtlSListIterator iter(*spEntries);
+        UtlString* pEntry;
+        while ((pEntry = (UtlString*)iter()) != NULL)
+        {
+            UtlString fields[9];
+            parseEntry(*pEntry, fields);
+            if (fields[2] == facility)
+            {
+                entries.append(spEntries->removeReference(pEntry));
+            }
+        }
+    }
+
+    static void parseEntry(const UtlString& entry, UtlString fields[9])
+    {
+        OsSysLog::parseLogString(entry.data(), fields[0], fields[1],
+                                 fields[2], fields[3], fields[4], fields[5],
+                                 fields[6], fields[7], fields[8]);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OsSysLogTest);
@@ -11,16 +11,44 @@
 // $$
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <stdio.h>
+
 #include <sipxunittests.h>
 #include <os/OsTimerTask.h>
+#include <os/OsTimer.h>
+#include <os/OsCallback.h>
+#include <os/OsDateTime.h>
+
+#define ORDER_TEST_TIMERS    100
+#define ORDER_TEST_SLOT_MS   10
+#define ORDER_TEST_DELAY_MS  500
+#define MANY_TEST_TIMERS     10000
 
 class OsTimerTaskTest : public SIPX_UNIT_BASE_CLASS
 {
     CPPUNIT_TEST_SUITE(OsTimerTaskTest);
     CPPUNIT_TEST(testTimerTask);
+    CPPUNIT_TEST(testFireOrder);
+    CPPUNIT_TEST(testManyTimers);
     CPPUNIT_TEST_SUITE_END();
 
 public:
+    static OsTimer* sFired[ORDER_TEST_TIMERS];
+    static int sNumFired;
+
+    static void recordFired(const intptr_t userData, const intptr_t eventData)
+    {
+        if (sNumFired < ORDER_TEST_TIMERS)
+        {
+            sFired[sNumFired] = (OsTimer*)eventData;
+        }
+        sNumFired++;
+    }
+
+    static void ignoreFired(const intptr_t userData, const intptr_t eventData)
+    {
+    }
+
     void testTimerTask()
     {
         OsTimerTask* pTimerTask;
@@ -38,6 +66,152 @@ public:
 
         pTimerTask->destroyTimerTask();
     }
+
+    void testFireOrder()
+    {
+        OsCallback notifier(0, recordFired);
+        OsTimer* timers[ORDER_TEST_TIMERS];
+        int i;
+
+        sNumFired = 0;
+        for (i = 0; i < ORDER_TEST_TIMERS; i++)
+        {
+            timers[i] = new OsTimer(notifier);
+        }
+
+        // Arm timers in a shuffled order, so every timer fires in its own
+        // time slot, and the timer for slot i is timers[i].
+        // 7 is coprime with ORDER_TEST_TIMERS, so every slot is used once.
+        // Slots are counted from one base time, so expiration times do not
+        // depend on how long arming takes.
+        OsTime base;
+        OsDateTime::getCurTime(base);
+        for (i = 0; i < ORDER_TEST_TIMERS; i++)
+        {
+            int slot = (i * 7) % ORDER_TEST_TIMERS;
+            OsTime expire = base + OsTime(0, (ORDER_TEST_DELAY_MS + slot*ORDER_TEST_SLOT_MS)*1000);
+            OsTime now;
+            OsDateTime::getCurTime(now);
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, timers[slot]->oneshotAfter(expire - now));
+        }
+
+        // Stop some timers, so they are removed from the middle of the queue.
+        int numStopped = 0;
+        for (i = 0; i < ORDER_TEST_TIMERS; i += 5)
+        {
+            CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, timers[i]->stop(TRUE));
+            numStopped++;
+        }
+
+        OsTask::delay(ORDER_TEST_DELAY_MS + ORDER_TEST_TIMERS*ORDER_TEST_SLOT_MS
+                      + 500);
+
+        CPPUNIT_ASSERT_EQUAL(ORDER_TEST_TIMERS - numStopped, sNumFired);
+        int fired = 0;
+        for (i = 0; i < ORDER_TEST_TIMERS; i++)
+        {
+            if (i % 5 != 0)
+            {
+                CPPUNIT_ASSERT(timers[i] == sFired[fired]);
+                fired++;
+            }
+        }
+
+        // Stopped and fired timers could be re-armed. Periodic timer fires
+        // every 100 ms, oneshot timer fires once at 300 ms.
+        sNumFired = 0;
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                             timers[1]->oneshotAfter(OsTime(0, 300000)));
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS,
+                             timers[0]->periodicEvery(OsTime(0, 100000),
+                                                      OsTime(0, 100000)));
+        // Wait for the periodic timer to fire a few times after the oneshot
+        // one, however long it takes.
+        for (i = 0; i < 100 && sNumFired < 6; i++)
+        {
+            OsTask::delay(100);
+        }
+        CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, timers[0]->stop(TRUE));
+        CPPUNIT_ASSERT(sNumFired >= 6);
+        CPPUNIT_ASSERT(timers[0] == sFired[0]);
+        int numOneshot = 0;
+        for (i = 0; i < sNumFired && i < ORDER_TEST_TIMERS; i++)
+        {
+            if (sFired[i] == timers[1])
+            {
+                numOneshot++;
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(1, numOneshot);
+
+        for (i = 0; i < ORDER_TEST_TIMERS; i++)
+        {
+            delete timers[i];
+        }
+    }
+
+    void testManyTimers()
+    {
+        // Arm and stop many timers which never fire, to show that start and
+        // stop cost does not grow with the number of armed timers.
+        OsCallback notifier(0, ignoreFired);
+        const int maxTimers = MANY_TEST_TIMERS;
+        OsTimer** timers = new OsTimer*[maxTimers];
+        OsTime farAway(3600, 0);
+        int i;
+
+        for (i = 0; i < maxTimers; i++)
+        {
+            timers[i] = new OsTimer(notifier);
+        }
+
+        for (int numTimers = 100; numTimers <= maxTimers; numTimers *= 10)
+        {
+            OsTime start;
+            OsTime armed;
+            OsTime stopped;
+
+            OsDateTime::getCurTime(start);
+            for (i = 0; i < numTimers; i++)
+            {
+                CPPUNIT_ASSERT_EQUAL(OS_SUCCESS, timers[i]->oneshotAfter(farAway));
+            }
+            // Wait until the timer task has processed all start requests.
+            timers[numTimers - 1]->stop(TRUE);
+            timers[numTimers - 1]->oneshotAfter(farAway);
+            OsDateTime::getCurTime(armed);
+
+            // Stop in the reverse order, so timers are removed from
+            // the tail as well as from the middle of the queue.
+            for (i = numTimers - 1; i >= 0; i -= 2)
+            {
+                timers[i]->stop(FALSE);
+            }
+            for (i = 0; i < numTimers; i += 2)
+            {
+                timers[i]->stop(FALSE);
+            }
+            // Wait until the timer task has processed all stop requests.
+            timers[0]->oneshotAfter(farAway);
+            timers[0]->stop(TRUE);
+            OsDateTime::getCurTime(stopped);
+
+            double armUsec = (armed - start).getDouble() * 1000000.0 / numTimers;
+            double stopUsec = (stopped - armed).getDouble() * 1000000.0 / numTimers;
+            printf("OsTimerTaskTest::testManyTimers %7d timers: "
+                   "start %.3f usec/timer, stop %.3f usec/timer\n",
+                   numTimers, armUsec, stopUsec);
+        }
+
+        for (i = 0; i < maxTimers; i++)
+        {
+            delete timers[i];
+        }
+        delete[] timers;
+    }
 };
 
+OsTimer* OsTimerTaskTest::sFired[ORDER_TEST_TIMERS];
+int OsTimerTaskTest::sNumFired = 0;
+
 CPPUNIT_TEST_SUITE_REGISTRATION(OsTimerTaskTest);
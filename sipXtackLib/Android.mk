@@ -111,6 +111,8 @@ LOCAL_SRC_FILES := \
   src/net/SipServerBase.cpp \
   src/net/SipServerBroker.cpp \
   src/net/SipSession.cpp \
+  src/net/SipStreamFramer.cpp \
+  src/net/SipStreamReactor.cpp \
   src/net/SipSubscribeClient.cpp \
   src/net/SipSubscribeServer.cpp \
   src/net/SipSubscribeServerEventHandler.cpp \
@@ -212,6 +214,7 @@ LOCAL_SRC_FILES := \
     src/test/net/SipSubscribeServerTest.cpp \
     src/test/net/SipSubscriptionClientTest.cpp \
     src/test/net/SipSubscriptionMgrTest.cpp \
+    src/test/net/SipTransactionListTest.cpp \
     src/test/net/SipUserAgentTest.cpp \
     src/test/net/UrlTest.cpp \
     src/test/SdpHelperTest.cpp \
@@ -311,6 +314,7 @@ LOCAL_SRC_FILES := \
     src/test/net/SipSubscribeServerTest.cpp \
     src/test/net/SipSubscriptionClientTest.cpp \
     src/test/net/SipSubscriptionMgrTest.cpp \
+    src/test/net/SipTransactionListTest.cpp \
     src/test/net/SipUserAgentTest.cpp \
     src/test/net/UrlTest.cpp \
     src/test/SdpHelperTest.cpp \
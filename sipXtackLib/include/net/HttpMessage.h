@@ -345,6 +345,22 @@ public:
                             int messageLength,
                             UtlDList& headerNameValues);
 
+    //! Enable or disable indexed parsing of message headers
+    /*! When enabled a parsed message keeps a single copy of its header
+     * block and a compact table of name and value offsets instead of a
+     * list of NameValuePair objects.  Headers of the same type (the long
+     * and SIP compact forms of a name are one type) are chained, so
+     * lookups of known headers do not compare strings.  The list is built
+     * on the first modification which adds, inserts or removes a header.
+     * Disabled by default.
+     * \note The setting is not synchronized.  Set it once at startup,
+     *       before any task parses messages.
+     */
+    static void setHeaderIndexing(UtlBoolean enable);
+
+    //! Is indexed parsing of message headers enabled?
+    static UtlBoolean isHeaderIndexing();
+
     //! returns: the number of bytes in the message buffer which constitue the message header
     /*! The end of the headers is determined by the first blank line
      */
@@ -539,7 +555,9 @@ public:
     //@}
 
     //! Get the bytes for the compete message
-    /*! Suitable for streaming or sending over a socket
+    /*! Suitable for streaming or sending over a socket.  Does not
+     * modify the message, so a shared message may be serialized by
+     * several threads at once.
      * \param bytes - gets allocated and must be freed
      * \param length - the length of bytes
      */
@@ -714,9 +732,49 @@ protected:
    UtlString mFirstHeaderLine;
    UtlBoolean mHeaderCacheClean;
 
+   //! Move indexed headers to mNameValues
+   /*! Must be called before mNameValues is accessed directly.  Does
+    * nothing if the headers are not indexed.
+    */
+   void materializeHeaders();
+
+   //! Replace SIP compact names of indexed headers with the long names
+   /*! \return FALSE if the headers are not indexed and have to be
+    *          renamed in mNameValues.
+    */
+   UtlBoolean expandIndexedShortNames();
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
 
+   enum
+   {
+      MAX_HEADER_IDS = 64,      ///< Max number of header types in the index.
+      HEADER_REF_COMPACT = 0x01 ///< Header has a SIP compact name.
+   };
+
+   //! Location of a header in the indexed header block
+   struct HeaderRef
+   {
+      int mNameOffset;          ///< Offset of the name in mpIndexedHeaders.
+      int mNameLength;
+      int mValueOffset;         ///< Offset of the NUL terminated value.
+      int mNextSameId;          ///< Next header of this type or -1.
+      UtlString* mpValue;       ///< Value, if it differs from the raw bytes.
+      unsigned char mHeaderId;  ///< Header type, 0 for names not known.
+      unsigned char mFlags;
+   };
+
+   static UtlBoolean sHeaderIndexing;
+
+   char* mpIndexedHeaders;      ///< Copy of the header block or NULL if
+                                ///< the headers are in mNameValues.
+   int mIndexedHeadersSize;     ///< Size of mpIndexedHeaders.
+   HeaderRef* mpHeaderRefs;
+   int mNumHeaderRefs;
+   int mFirstHeaderRef[MAX_HEADER_IDS]; ///< First header of each type or -1.
+   UtlBoolean mShortNamesExpanded;
+
    HttpBody* body;
    long transportTimeStamp;
    int lastResendDuration;
@@ -734,6 +792,45 @@ private:
    //! Internal utility
    NameValuePair* getHeaderField(int index, const char* name = NULL) const;
 
+   //! Parse headers to the index or to mNameValues
+   int parseHeaderBlock(const char* headerBytes, int messageLength);
+
+   //! Parse headers to the index
+   /*! Produces the same headers as parseHeaders().
+    * \return the number of bytes parsed
+    */
+   int indexHeaders(const char* headerBytes, int messageLength);
+
+   //! Copy indexed headers of another message
+   void copyHeaderIndex(const HttpMessage& rHttpMessage);
+
+   //! Free the index
+   void clearHeaderIndex();
+
+   //! Find the position of an indexed header
+   /*! \return index into mpHeaderRefs or -1 if not found
+    */
+   int findHeaderRef(int index, const char* name) const;
+
+   //! Does an indexed header have the name being looked for?
+   /*! \param headerId, isCompact - as returned by the header id lookup
+    *        for the name
+    */
+   UtlBoolean headerRefMatches(const HeaderRef& headerRef,
+                               const char* name,
+                               int nameLength,
+                               int headerId,
+                               UtlBoolean isCompact) const;
+
+   //! Get the name of an indexed header as it would be in mNameValues
+   void getHeaderRefName(const HeaderRef& headerRef, UtlString& name) const;
+
+   //! Get the value of an indexed header
+   const char* getHeaderRefValue(const HeaderRef& headerRef) const;
+
+   //! Set the value of an indexed header
+   void setHeaderRefValue(HeaderRef& headerRef, const char* value);
+
 
 };
 
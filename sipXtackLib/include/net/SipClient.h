@@ -31,6 +31,7 @@
 // TYPEDEFS
 // FORWARD DECLARATIONS
 class SipUserAgentBase;
+class SipStreamFramer;
 class OsEvent;
 
 //:Class short description which may consist of multiple lines (note the ':')
@@ -64,6 +65,13 @@ public:
 
         virtual int run(void* pArg);
 
+    UtlBoolean readStream();
+    //: Read and dispatch the messages ready on a stream socket
+    // Called by SipStreamReactor instead of run() when the socket is
+    // ready to read.  Does not block waiting for more data.
+    //! returns FALSE if the connection failed or was closed, in which
+    //! case the socket has been closed.
+
         UtlBoolean sendInvite(char* toAddress, char* callId, int rtpPort,
                                                                 int numCodecs, int rtpCodecs[],
                                                                 int sequenceNumber = 1);
@@ -89,6 +97,8 @@ public:
     //int getHostPort() const;
     const UtlString& getLocalIp();
 
+    int getSocketDescriptor() const;
+
     void markInUseForWrite();
     void markAvailbleForWrite();
 
@@ -101,6 +111,10 @@ public:
 
     int isInUseForWrite();
 
+    UtlBoolean isStream() const;
+    //: Can readStream() be used instead of starting this client's task?
+    // FALSE for datagram and TLS sockets.
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
@@ -112,6 +126,14 @@ private:
     // Wait until the socket is ready to read (or has an error).
     UtlBoolean waitForReadyToRead();
 
+    void processMessage(SipMessage* message,
+                        const char* messageBytes,
+                        int messageLength,
+                        const UtlString& fromIpAddress,
+                        int fromPort);
+    //: Log a message read from the socket and dispatch it to the user agent
+    // Takes ownership of message.
+
     OsSocket* clientSocket;
     OsSocket::IpProtocolSocketType mSocketType;
     SipUserAgentBase* sipUserAgent;
@@ -128,6 +150,7 @@ private:
     int mInUseForWrite;
     UtlSList* mWaitingList;  // Events waiting until this is available
     UtlBoolean mbSharedSocket; // Shared socket-- do not delete or close (UDP / rport)
+    SipStreamFramer* mpFramer; // Splits messages read from TCP or TLS sockets
 
     SipClient(const SipClient& rSipClient);
      //:disable Copy constructor
@@ -30,6 +30,7 @@
 // FORWARD DECLARATIONS
 class SipMessage;
 class SipDialog;
+class SipDialogStripe;
 
 // TYPEDEFS
 
@@ -38,6 +39,10 @@ class SipDialog;
  *  This class is intended to replace the SipRefreshMgr.
  *
  * \par 
+ *  The dialogs are split into stripes by Call-Id.  Each stripe has its
+ *  own lock, so dialogs of different calls can be looked up and updated
+ *  at the same time.  All the dialogs a handle can match (early and
+ *  established) have the same Call-Id and so are in the same stripe.
  */
 class SipDialogMgr
 {
@@ -134,6 +139,11 @@ public:
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
+    enum
+    {
+        NUM_STRIPES = 16
+    };
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
     //! Copy constructor NOT ALLOWED
@@ -143,14 +153,16 @@ private:
     SipDialogMgr& operator=(const SipDialogMgr& rhs);
 
     //! Find a dialog that matches, optionally look for an early dialog if exact match does not exist
-    /*! Checks tags in both directions
+    /*! Checks tags in both directions.  The stripe of the dialog handle
+     *  must be locked.
      */
     SipDialog* findDialog(UtlString& dialogHandle,
                           UtlBoolean ifHandleEstablishedFindEarlyDialog,
                           UtlBoolean ifHandleEarlyFindEstablishedDialog);
 
     //! Find a dialog that matches, optionally look for an early dialog if exact match does not exist
-    /*! Checks tags in both directions
+    /*! Checks tags in both directions.  The stripe of the Call-Id must
+     *  be locked.
      */
     SipDialog* findDialog(UtlString& callId,
                           UtlString& localTag,
@@ -158,14 +170,13 @@ private:
                           UtlBoolean ifHandleEstablishedFindEarlyDialog,
                           UtlBoolean ifHandleEarlyFindEstablishedDialog);
 
-    //! lock for single thread use
-    void lock();
+    //! Stripe of the dialogs with the given Call-Id
+    SipDialogStripe& getStripe(const UtlString& callId);
 
-    //! unlock for use
-    void unlock();
+    //! Stripe of the dialogs with the Call-Id of the given dialog handle
+    SipDialogStripe& getStripeFor(const UtlString& dialogHandle);
 
-    OsMutex mDialogMgrMutex;
-    UtlHashBag mDialogs; 
+    SipDialogStripe* mpStripes;
 };
 
 /* ============================ INLINE METHODS ============================ */
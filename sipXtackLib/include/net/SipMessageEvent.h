@@ -17,6 +17,8 @@
 // APPLICATION INCLUDES
 #include <net/SipMessage.h>
 #include <os/OsMsg.h>
+#include <os/OsIntTypes.h>
+#include <os/OsAtomics.h>
 
 // DEFINES
 // MACROS
@@ -27,8 +29,12 @@
 // TYPEDEFS
 // FORWARD DECLARATIONS
 
-//:Class short description which may consist of multiple lines (note the ':')
-// Class detailed description which may extend to multiple lines
+//:Message to an observer carrying a received or locally generated SipMessage
+// Copies of an event made by createCopy() (e.g. when it is posted to the
+// queues of several observers) share one SipMessage, which is deleted with
+// the last of them.  The shared message must be treated as read only; use
+// getWritableMessage() to change it, which gives the event its own copy
+// first if the message is shared.
 class SipMessageEvent : public OsMsg
 {
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -56,8 +62,15 @@ public:
      //:Destructor
 
    virtual OsMsg* createCopy(void) const;
+     //:Create a copy of the event which shares the message of this one
+
 /* ============================ MANIPULATORS ============================== */
 
+SipMessage* getWritableMessage();
+     //:Get the message of this event for changing it
+     // If the message is shared with other copies of this event, this
+     // event first gets a copy of the message of its own.
+
 
 /* ============================ ACCESSORS ================================= */
 const SipMessage* getMessage();
@@ -67,6 +80,9 @@ int getMessageStatus() const;
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean isMessageShared() const;
+     //:Is the message shared with other copies of this event?
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
@@ -74,6 +90,12 @@ protected:
 private:
         SipMessage* sipMessage;
         int messageStatus;
+        mutable OsAtomicInt* mpShareCount; // Number of events sharing
+                                           // sipMessage, or NULL if
+                                           // it was never shared
+
+   void releaseMessage();
+     //:Drop this event's reference to the message, deleting it if last
 
    SipMessageEvent(const SipMessageEvent& rSipMessageEvent);
      //:disable Copy constructor
@@ -22,7 +22,9 @@
 #include <os/OsServerTask.h>
 #include <os/OsLockingList.h>
 #include <os/OsRWMutex.h>
+#include <utl/UtlHashBag.h>
 #include <utl/UtlHashMap.h>
+#include <utl/UtlSList.h>
 
 // DEFINES
 // MACROS
@@ -34,6 +36,9 @@
 // FORWARD DECLARATIONS
 class SipUserAgent;
 class SipServerBrokerListener;
+class SipStreamReactor;
+class SipStreamReactorThread;
+class SipClientEntry;
 
 //:Class short description which may consist of multiple lines (note the ':')
 // Class detailed description which may extend to multiple lines
@@ -67,6 +72,12 @@ public:
     virtual int run(void* pArg) = 0;
 
     void removeOldClients(long oldTime);
+    //: Delete clients which have not been used since oldTime
+    // Also deletes the clients whose socket failed.  When the clients
+    // are served by a SipStreamReactor, only the clients which were
+    // last used before oldTime and the ones reported by clientClosed()
+    // are looked at, rather than all of them.  The clients already
+    // removed by deleteClient() are deleted here too.
 
 /* ============================ ACCESSORS ================================= */
 
@@ -81,6 +92,7 @@ public:
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
     friend class SipServerBrokerListener;
+    friend class SipStreamReactorThread;
 
     SipClient* createClient(const char* hostAddress,
                             int hostPort,
@@ -96,6 +108,10 @@ protected:
 
     void addClient(SipClient* client);
 
+    void clientClosed(SipClient* client);
+    //: Note that the socket of the client failed or was closed
+    // The client is deleted by the next removeOldClients().
+
     virtual OsSocket* buildClientSocket(int hostPort, const char* hostAddress, const char* localIp) = 0;
 
     UtlString mProtocolString;
@@ -120,8 +136,33 @@ private:
 
     void deleteClient(SipClient* client);
 
+    void startClient(SipClient* client);
+
+    SipClientEntry* insertClient(SipClient* client);
+
+    SipClientEntry* findEntry(SipClient* client) const;
+
+    void removeEntry(SipClientEntry* entry);
+
+    void indexClient(SipClientEntry* entry, const UtlString& key);
+
+    void unindexKey(const UtlString& key);
+
+    void queueIdleClient(SipClientEntry* entry, long time);
+
+    static void getClientKey(UtlString& key,
+                             const char* hostAddress,
+                             int hostPort,
+                             const char* localIp);
+
         OsRWMutex mClientLock;
-    OsLockingList mClientList;
+    UtlHashBag mClients;       // SipClientEntry of each client
+    UtlHashMap mClientIndex;   // Client (SipClientEntry) by remote "address:port/local IP" (UtlString)
+    UtlHashMap mIdleClients;   // Clients (UtlSList of SipClientEntry) by the time they were last known to be used (UtlInt)
+    long mIdleCheckedTime;     // mIdleClients has no clients used at or before this time
+    UtlSList mClosedClients;   // Clients (UtlVoidPtr) to delete in removeOldClients()
+    UtlSList mDeletedClients;  // Clients (UtlVoidPtr) removed by deleteClient(), deleted in removeOldClients()
+    SipStreamReactor* mpReactor; // Reads TCP clients, if supported
 
         SipProtocolServerBase(const SipProtocolServerBase& rSipProtocolServerBase);
         //: disable Copy constructor
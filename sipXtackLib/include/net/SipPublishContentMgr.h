@@ -32,6 +32,7 @@
 class HttpBody;
 class UtlString;
 class SipPublishContentMgrDefaultConstructor;
+class PublishContentStripe;
 
 // TYPEDEFS
 
@@ -89,6 +90,14 @@ class SipPublishContentMgrDefaultConstructor;
  * This default content is provided in the getContent method if no
  * content was provided for the specific resource Id.  Default content
  * is set via the publishDefault method.
+ *
+ * \par Locking
+ * The content is split into stripes by resourceId and eventTypeKey, and
+ * default content by eventTypeKey.  Each stripe has its own lock, so
+ * content for different resources is published and retrieved at the
+ * same time.  Observers are called with the lock of the stripe of the
+ * changed content held, so the callbacks for one resource are not
+ * called concurrently.
  */
 class SipPublishContentMgr
 {
@@ -323,6 +332,8 @@ public:
     /** Remove the current observer for the eventTypeKey
      *  If the given callbackFunction does not match the existing one,
      *  this method returns FALSE and the existing observer(s) remain.
+     *  Waits for callbacks of the observer which are running, so it must
+     *  not be called from the callback.
      */
     virtual UtlBoolean removeContentChangeObserver(const char* eventType,
                                                    void*& applicationData,
@@ -346,6 +357,11 @@ public:
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
+    enum
+    {
+        NUM_STRIPES = 16
+    };
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
     /// parse the accept header field and create a HashMap with a UtlString for each MIME type
@@ -358,17 +374,32 @@ private:
     /// Assignment operator NOT ALLOWED
     SipPublishContentMgr& operator=(const SipPublishContentMgr& rhs);
 
-    /// lock for single thread use
+    /// Stripe of the content with the given key
+    PublishContentStripe& getStripe(const UtlString& key);
+
+    /// Call the observer for the content change, if any
+    /** The caller holds the lock of the stripe of the content.
+     */
+    void notifyContentChange(const char* resourceId,
+                             const char* eventTypeKey,
+                             const char* eventType,
+                             UtlBoolean isDefaultContent);
+
+    /// lock the callbacks for single thread use
     void lock();
 
     /// unlock for use
     void unlock();
 
+    // Guards mEventContentCallbacks.  Nothing is called with it held, so
+    // it may be taken inside a stripe lock.
     OsMutex mPublishMgrMutex;
-    // Indexed by strings "resourceId\001eventTypeKey".
-    UtlHashMap mContentEntries; 
-    // Indexed by strings "\001eventTypeKey".
-    UtlHashMap mDefaultContentEntries;
+    // Guards mDefaultContentConstructors, held while a constructor
+    // generates content.  Never taken inside a stripe lock.
+    OsMutex mDefaultConstructorMutex;
+    // Content entries indexed by strings "resourceId\001eventTypeKey",
+    // default content entries indexed by strings "\001eventTypeKey".
+    PublishContentStripe* mpStripes;
     UtlHashMap mDefaultContentConstructors;
     // Indexed by strings "eventType".
     UtlHashMap mEventContentCallbacks;
@@ -42,6 +42,7 @@
 
 // FORWARD DECLARATIONS
 class server_t;
+class UtlHashBag;
 typedef struct s_res_response
     res_response;
 
@@ -49,6 +50,12 @@ typedef struct s_res_response
  * A class (with no members) whose 'servers' method implements the RFC
  * 3263 process for determining a list of server entries for a SIP
  * domain name.
+ *
+ * DNS answers are kept in a cache for as long as their TTL allows, and
+ * failed queries are remembered for OptionCodeCacheNegativeTTL seconds.
+ * While one thread is querying for a name, other threads looking up the
+ * same name and RR type wait for its answer instead of sending their own
+ * query.
  */
 class SipSrvLookup
 {
@@ -111,6 +118,9 @@ public:
       OptionCodeCNAMELimit,     ///< Max. number of CNAMEs to follow.
       OptionCodeNoDefaultTCP,   /**< If 1, do not add TCP contacts by default,
                                  *   for better RFC 3263 conformance. */
+      OptionCodeCacheMaxTTL,    /**< Max. number of seconds to cache a DNS
+                                 *   answer.  0 disables the cache. */
+      OptionCodeCacheNegativeTTL, ///< Number of seconds to cache a failed query.
       OptionCodeLast            ///< End of range
    };
    /**<
@@ -193,11 +203,53 @@ public:
     * is non-NULL and != in_response.
     */
 
+   /// Perform a DNS query, using the cache of earlier answers.
+   static int res_query_cached(const char* name,
+                               ///< domain name to look up
+                               int type,
+                               ///< RR type to look up
+                               unsigned char* answer,
+                               ///< buffer for the answer
+                               int anslen
+                               ///< size of the answer buffer
+      );
+   /**<
+    * Same as res_query(name, C_IN, type, answer, anslen).
+    *
+    * @returns length of the answer, or -1 if the query failed.
+    */
+
+   /// Get the number of queries answered from the cache.
+   static int getCacheHits();
+
+   /// Get the number of queries sent to the DNS server.
+   static int getCacheMisses();
+
+   /// Get the number of queries which waited for the same query of another thread.
+   static int getCacheCoalesced();
+
+   /// Forget all cached answers and reset the cache counters.
+   static void clearCache();
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
    /// Mutex to keep the routines thread-safe.
    static OsMutex sMutex;
+   /**<
+    * Only held for a whole lookup where the resolver state is shared by all
+    * threads.  glibc keeps it per thread.
+    */
+
+   /// Mutex for the cache and its counters.
+   static OsMutex sCacheMutex;
+
+   /// Cached answers (SipSrvCacheEntry), keyed by RR type and name.
+   static UtlHashBag* spCache;
+
+   static int sCacheHits;      ///< Queries answered from spCache.
+   static int sCacheMisses;    ///< Queries sent to the DNS server.
+   static int sCacheCoalesced; ///< Queries which waited for another thread.
 
    /// The array of option values.
    static int options[OptionCodeLast+1];
@@ -0,0 +1,171 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SipStreamFramer_h_
+#define _SipStreamFramer_h_
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "os/OsSocket.h"
+#include "utl/UtlDefs.h"
+#include "net/HttpMessage.h"
+
+// DEFINES
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+
+/**
+*  @brief Splits the byte stream of a TCP or TLS connection into messages.
+*
+*  The framer reads from the socket in large chunks into a buffer which
+*  is kept for the life of the connection. A message ends after the blank
+*  line ending its headers plus the number of bytes given in its
+*  Content-Length (or compact "l") header. A complete message is handed
+*  out as a pointer into the buffer, so it can be passed to
+*  HttpMessage::parseMessage() without copying it first. Bytes read past
+*  its end stay in the buffer as the start of the next message.
+*  Whitespace between messages (like CRLF keep-alives) is skipped.
+*
+*  A framer is used by a single reader thread.
+*/
+class SipStreamFramer
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      DEFAULT_MAX_MESSAGE_SIZE = 6000000 ///< Same limit as HttpMessage::read().
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor
+   SipStreamFramer(int chunkSize = HTTP_DEFAULT_SOCKET_BUFFER_SIZE,
+                   int maxMessageSize = DEFAULT_MAX_MESSAGE_SIZE);
+     /**<
+     *  @param[in] chunkSize - minimum number of bytes to ask the socket for
+     *             in one read.
+     *  @param[in] maxMessageSize - larger Content-Length values, or header
+     *             blocks, are treated as an error.
+     */
+
+     /// Destructor
+   ~SipStreamFramer();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Read from the socket until a complete message is buffered.
+   int readMessage(OsSocket& socket, const char*& messageBytes);
+     /**<
+     *  Does not read if a complete message is already buffered. Otherwise
+     *  reads once, and then again as long as the socket has more data
+     *  ready, until a message is complete. It does not wait for data, so
+     *  the caller should only call it when the socket is ready to read
+     *  or hasMessage() is TRUE.
+     *
+     *  If the message is larger than the maximum message size, the socket
+     *  is closed, as HttpMessage::read() does with abusive senders.
+     *
+     *  @param[out] messageBytes - set to the start of the message. It stays
+     *              valid until the next call to any manipulator.
+     *
+     *  @returns length of the message.
+     *  @returns 0 if no complete message is buffered yet.
+     *  @returns -1 if the socket read failed, the connection has been
+     *           closed or the message is too large.
+     */
+
+     /// Get the next complete message without reading from a socket.
+   int nextMessage(const char*& messageBytes);
+     /**<
+     *  @returns same values as readMessage().
+     */
+
+     /// Is a complete message buffered?
+   UtlBoolean hasMessage();
+     /**<
+     *  Releases the message returned by the previous call, like any
+     *  other manipulator.
+     */
+
+     /// Add bytes to the buffer as if they were read from a socket.
+   void append(const char* bytes, int length);
+
+     /// Discard all buffered bytes.
+   void reset();
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return number of buffered bytes, including the last message returned.
+   int getBufferedLength() const;
+
+     /// Return number of socket reads done so far.
+   int getNumReads() const;
+
+     /// Return value of the Content-Length (or "l") header in a header block.
+   static int getContentLength(const char* headerBytes, int headerLength);
+     /**<
+     *  @returns -1 if there is no such header.
+     */
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+     /// Find the length of the message at the start of the buffer.
+   int frameMessage();
+     /**<
+     *  Releases the message returned last and skips whitespace first.
+     *  @returns same values as nextMessage().
+     */
+
+     /// Make sure there is room for at least minFree more bytes.
+   void reserve(int minFree);
+
+   char* mpBuffer;          ///< Buffered bytes.
+   int mCapacity;           ///< Size of mpBuffer.
+   int mStart;              ///< Offset of the first unreleased byte.
+   int mEnd;                ///< Offset past the last buffered byte.
+   int mMessageLength;      ///< Length of the message handed out at mStart.
+   int mHeaderLength;       ///< Header length of the message at mStart
+                            ///< or -1 if its end has not been found yet.
+   int mContentLength;      ///< Content length of the message at mStart.
+   int mChunkSize;          ///< Minimum size of one socket read.
+   int mMaxMessageSize;     ///< Maximum size of a header block or content.
+   int mNumReads;           ///< Number of socket reads done.
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   SipStreamFramer(const SipStreamFramer& rSipStreamFramer);
+
+     /// Assignment operator (not implemented for this class)
+   SipStreamFramer& operator=(const SipStreamFramer& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif  // _SipStreamFramer_h_
@@ -0,0 +1,236 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SipStreamReactor_h_
+#define _SipStreamReactor_h_
+
+// SYSTEM INCLUDES
+// APPLICATION INCLUDES
+#include "os/OsMutex.h"
+#include "os/OsTask.h"
+#include "utl/UtlHashMap.h"
+
+// DEFINES
+#if defined(__linux__) && !defined(SIP_NO_STREAM_REACTOR)
+   // Serve SIP stream connections from a few epoll threads instead of
+   // starting one SipClient task per connection.
+#  define SIP_STREAM_REACTOR
+#endif
+
+#ifdef SIP_STREAM_REACTOR /* [ */
+
+// MACROS
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STRUCTS
+// TYPEDEFS
+// FORWARD DECLARATIONS
+class SipClient;
+class SipProtocolServerBase;
+
+/**
+*  @brief I/O thread of a SipStreamReactor.
+*
+*  Waits on one epoll set for all of the connections assigned to it and
+*  calls SipClient::readStream() for each one which is ready to read.
+*/
+class SipStreamReactorThread : public OsTask
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor
+   SipStreamReactorThread(SipProtocolServerBase* pOwner);
+     /**<
+     *  @param[in] pOwner - server which is told about connections which
+     *             fail or are closed by the remote side.
+     */
+
+     /// Destructor
+   virtual
+   ~SipStreamReactorThread();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Start reading from the socket of the given client.
+   UtlBoolean addClient(SipClient* client);
+
+     /// Stop reading from the socket of the given client.
+   void removeClient(SipClient* client);
+     /**<
+     *  Waits until this thread is done with a read in progress, so the
+     *  client can be deleted when this returns.  Must not be called from
+     *  a reactor thread.
+     */
+
+     /// Stop reading from the client and shut its connection down.
+   void closeClient(SipClient* client);
+     /**<
+     *  Does not wait for a read in progress, so it may be called from
+     *  any thread.  The socket descriptor stays open until the client is
+     *  deleted, which must still be done after removeClient().
+     */
+
+     /// Ask the thread to stop and wake it up.
+   virtual void requestShutdown();
+
+   virtual int run(void* pArg);
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return number of clients served by this thread.
+   int getClientCount();
+
+//@}
+
+/* ============================ INQUIRY =================================== */
+///@name Inquiry
+//@{
+
+     /// Was the epoll set created?
+   UtlBoolean isReady() const;
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   SipProtocolServerBase* mpOwner;
+   int mEpollFd;            ///< Epoll set of the client sockets.
+   int mWakeFds[2];         ///< Pipe which wakes the thread up on shutdown.
+   OsMutex mDispatchLock;   ///< Held while reading from a client.
+   OsMutex mClientsLock;    ///< Guards mClients and mClientIds.
+   UtlHashMap mClients;     ///< Client (UtlVoidPtr) of each registration id (UtlInt).
+   UtlHashMap mClientIds;   ///< Registration id (UtlInt) of each client (UtlVoidPtr).
+   int mLastId;             ///< Last registration id handed out.
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   SipStreamReactorThread(const SipStreamReactorThread& rSipStreamReactorThread);
+
+     /// Assignment operator (not implemented for this class)
+   SipStreamReactorThread& operator=(const SipStreamReactorThread& rhs);
+
+};
+
+/**
+*  @brief Reads the TCP connections of a SIP server with a small, fixed
+*         number of I/O threads.
+*
+*  Without the reactor every connection has its own SipClient task, so a
+*  server with thousands of phones on persistent connections runs
+*  thousands of threads.  The reactor assigns each connection to one of
+*  its threads in turn.  A connection which fails or is closed by the
+*  remote side is dropped from its epoll set and reported to the server
+*  with SipProtocolServerBase::clientClosed().  Clients are only deleted
+*  by the server, after removeClient().
+*
+*  Reading and dispatching a message happens on the I/O thread, just like
+*  it did on the SipClient task.  TLS connections are not added: their
+*  reads block inside the TLS layer, which may also hold decrypted data
+*  that epoll does not report, so they keep their own SipClient task.
+*/
+class SipStreamReactor
+{
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+public:
+
+   enum
+   {
+      DEFAULT_NUM_THREADS = 2
+   };
+
+/* ============================ CREATORS ================================== */
+///@name Creators
+//@{
+
+     /// Constructor, starts the I/O threads.
+   SipStreamReactor(SipProtocolServerBase* pOwner,
+                    int numThreads = DEFAULT_NUM_THREADS);
+
+     /// Destructor, stops the I/O threads.
+   ~SipStreamReactor();
+
+//@}
+
+/* ============================ MANIPULATORS ============================== */
+///@name Manipulators
+//@{
+
+     /// Start reading from the socket of the given client.
+   UtlBoolean addClient(SipClient* client);
+     /**<
+     *  @returns FALSE if the client cannot be served by the reactor, in
+     *           which case the caller should start the client's own task.
+     */
+
+     /// Stop reading from the socket of the given client.
+   void removeClient(SipClient* client);
+     /**<
+     *  @see SipStreamReactorThread::removeClient()
+     */
+
+     /// Stop reading from the client and shut its connection down.
+   void closeClient(SipClient* client);
+     /**<
+     *  @see SipStreamReactorThread::closeClient()
+     */
+
+//@}
+
+/* ============================ ACCESSORS ================================= */
+///@name Accessors
+//@{
+
+     /// Return number of clients served by all threads.
+   int getClientCount();
+
+     /// Return number of I/O threads.
+   int getNumThreads() const;
+
+//@}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+protected:
+
+   SipStreamReactorThread** mpThreads;
+   int mNumThreads;
+   int mNextThread;            ///< Thread which gets the next client.
+   OsMutex mLock;              ///< Guards mNextThread and mClientThreads.
+   UtlHashMap mClientThreads;  ///< Thread (UtlVoidPtr) of each client (UtlVoidPtr).
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+private:
+
+     /// Copy constructor (not implemented for this class)
+   SipStreamReactor(const SipStreamReactor& rSipStreamReactor);
+
+     /// Assignment operator (not implemented for this class)
+   SipStreamReactor& operator=(const SipStreamReactor& rhs);
+
+};
+
+/* ============================ INLINE METHODS ============================ */
+
+#endif /* SIP_STREAM_REACTOR ] */
+
+#endif  // _SipStreamReactor_h_
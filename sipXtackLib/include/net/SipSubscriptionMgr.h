@@ -20,6 +20,7 @@
 // APPLICATION INCLUDES
 
 #include <os/OsDefs.h>
+#include <os/OsAtomics.h>
 #include <os/OsMsgQ.h>
 #include <os/OsMutex.h>
 #include <utl/UtlDefs.h>
@@ -37,6 +38,8 @@
 class SipMessage;
 class UtlString;
 class SipDialogMgr;
+class SubscriptionDialogStripe;
+class SubscriptionResourceStripe;
 
 // TYPEDEFS
 
@@ -44,6 +47,16 @@ class SipDialogMgr;
 /*! 
  *
  * \par 
+ *  The subscription states are split into stripes by the Call-Id of
+ *  their dialog, and the index of the states by resourceId and
+ *  eventTypeKey into stripes by resource.  Each stripe has its own lock,
+ *  so SUBSCRIBE requests of different dialogs and NOTIFY requests for
+ *  different resources are handled at the same time.
+ *
+ * \par 
+ *  Each dialog stripe also queues its states by the second they expire
+ *  in, so removeOldSubscriptions() only looks at the states which have
+ *  expired.
  */
 class SipSubscriptionMgr
 {
@@ -109,6 +122,9 @@ public:
     int dumpOldSubscriptions(long oldEpochTimeSeconds);
 
     //! Remove old subscriptions that expired before given date
+    /*! Only the states queued to expire before the given date are
+     *  looked at, not every subscription.
+     */
     int removeOldSubscriptions(long oldEpochTimeSeconds);
 
     //! Set maximum subscription period in seconds
@@ -139,6 +155,11 @@ public:
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
 
+    enum
+    {
+        NUM_STRIPES = 16
+    };
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
     //! Copy constructor NOT ALLOWED
@@ -147,25 +168,24 @@ private:
     //! Assignment operator NOT ALLOWED
     SipSubscriptionMgr& operator=(const SipSubscriptionMgr& rhs);
 
-    //! lock for single thread use
-    void lock();
+    //! Stripe of the subscription states with the Call-Id of the dialog handle
+    SubscriptionDialogStripe& getDialogStripe(const UtlString& dialogHandle);
 
-    //! unlock for use
-    void unlock();
+    //! Stripe of the index entries with the given resourceId and eventTypeKey
+    SubscriptionResourceStripe& getResourceStripe(const UtlString& resourceKey);
 
-    int mEstablishedDialogCount;
-    OsMutex mSubscriptionMgrMutex;
+    OsAtomicInt mEstablishedDialogCount;
     SipDialogMgr mDialogMgr;
     int mMinExpiration;
     int mDefaultExpiration;
     int mMaxExpiration;
 
-    // Container for the subscritption states
-    UtlHashMap mSubscriptionStatesByDialogHandle;
+    // Containers for the subscritption states, by dialog handle
+    SubscriptionDialogStripe* mpDialogStripes;
 
-    // Index to subscription states in mSubscriptionStatesByDialogHandle
+    // Index to subscription states in mpDialogStripes
     // indexed by the resourceId and eventTypeKey
-    UtlHashBag mSubscriptionStateResourceIndex;
+    SubscriptionResourceStripe* mpResourceStripes;
 };
 
 /* ============================ INLINE METHODS ============================ */
@@ -30,9 +30,19 @@
 // FORWARD DECLARATIONS
 
 class SipMessage;
-
-//:Class short description which may consist of multiple lines (note the ':')
-// Class detailed description which may extend to multiple lines
+class SipTransactionStripe;
+
+//:List of the SIP transactions of a user agent
+// The transactions are split into stripes by Call-Id.  Each stripe has
+// its own lock, so messages of different calls can look up their
+// transactions at the same time.  All the transactions of a transaction
+// tree (e.g. the server transaction of a proxy and its forked client
+// transactions) have the same Call-Id and so are in the same stripe,
+// which protects their busy state.
+//
+// Each stripe also keeps its transactions in queues ordered by the time
+// they were last used, so removeOldTransactions() only looks at the
+// transactions which may have expired.
 class SipTransactionList {
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 public:
@@ -77,8 +87,10 @@ public:
     //: Marks the transaction as available
 
     void removeOldTransactions(long oldTransaction,
-                               long oldTcpTransaction);
+                               long oldInviteTransaction);
     //: Remove transactions not accessed after given time
+    // INVITE transactions are kept until oldInviteTransaction, all others
+    // until the later of the two times.
 
     void stopTransactionTimers();
     void startTransactionTimers();
@@ -93,15 +105,26 @@ public:
                                SipMessage& message,
                                UtlBoolean isOutGoing);
 
+    int getTransactionCount();
+    //: Number of transactions in the list
+
 /* ============================ INQUIRY =================================== */
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 protected:
-    void lock();
-    //: Locks the list for iteration, reading or writing
 
-    void unlock();
-    //: Unlock
+    enum
+    {
+        NUM_STRIPES = 16
+    };
+
+    SipTransactionStripe& getStripe(const UtlString& hash);
+    //: Stripe of the transactions with the given hash
+    // The hash is the one built by SipTransaction::buildHash(), which is
+    // also the string value of the transaction.
+
+    static unsigned getCallIdHash(const UtlString& hash);
+    //: Hash of the Call-Id part of a transaction hash
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
     private:
@@ -111,8 +134,7 @@ protected:
     SipTransactionList& operator=(const SipTransactionList& rhs);
     //:Assignment operator
 
-    UtlHashBag mTransactions;
-    OsMutex mListMutex;
+    SipTransactionStripe* mpStripes;
 
 };
 
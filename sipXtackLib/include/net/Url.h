@@ -513,12 +513,27 @@ protected:
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 private:
+   friend class UrlTest;
+
    /// parse a URL in string form into its component parts
    void parseString(const char* urlString, ///< the raw URL string
                     UtlBoolean isAddrSpec = FALSE  /**< TRUE if this came from a Request URI or
                                                     *   other place where only the addr-spec production
                                                     *   is valid. */
                     );
+   /**<
+    * Uses scanString(), or parseStringRegEx() if URL_REGEX_PARSER is defined.
+    */
+
+   /// parse a URL in string form using the single pass scanner
+   void scanString(const char* urlString, UtlBoolean isAddrSpec);
+   /**<
+    * Produces the same components as parseStringRegEx(), but walks the
+    * string once without running any regular expressions.
+    */
+
+   /// parse a URL in string form using the regular expressions
+   void parseStringRegEx(const char* urlString, UtlBoolean isAddrSpec);
 
    Scheme    mScheme;
 
@@ -61,6 +61,146 @@
 
 // STATIC VARIABLE INITIALIZATIONS
 OsAtomicInt HttpMessage::smHttpMessageCount(0);
+UtlBoolean HttpMessage::sHeaderIndexing = FALSE;
+
+// Header names known to the header index.  The position in the table is
+// the header id, id 0 stands for all other names.  There may be at most
+// HttpMessage::MAX_HEADER_IDS entries.  The compact forms must match the
+// short names SipMessage knows about.
+static const struct
+{
+   const char* mpName;
+   char mCompactForm;
+} sIndexedHeaderNames[] =
+{
+   { "", 0 },
+   { SIP_VIA_FIELD, 'v' },
+   { SIP_TO_FIELD, 't' },
+   { SIP_FROM_FIELD, 'f' },
+   { SIP_CALLID_FIELD, 'i' },
+   { SIP_CSEQ_FIELD, 0 },
+   { SIP_CONTACT_FIELD, 'm' },
+   { HTTP_CONTENT_LENGTH_FIELD, 'l' },
+   { HTTP_CONTENT_TYPE_FIELD, 'c' },
+   { SIP_CONTENT_ENCODING_FIELD, 'e' },
+   { SIP_EVENT_FIELD, 'o' },
+   { SIP_REFER_TO_FIELD, 'r' },
+   { SIP_REFERRED_BY_FIELD, 'b' },
+   { SIP_SUBJECT_FIELD, 's' },
+   { SIP_SUPPORTED_FIELD, 'k' },
+   { SIP_MAX_FORWARDS_FIELD, 0 },
+   { SIP_ROUTE_FIELD, 0 },
+   { SIP_RECORD_ROUTE_FIELD, 0 },
+   { SIP_EXPIRES_FIELD, 0 },
+   { SIP_MIN_EXPIRES_FIELD, 0 },
+   { SIP_ALLOW_FIELD, 0 },
+   { SIP_ACCEPT_FIELD, 0 },
+   { SIP_REQUIRE_FIELD, 0 },
+   { SIP_PROXY_REQUIRE_FIELD, 0 },
+   { SIP_UNSUPPORTED_FIELD, 0 },
+   { SIP_SERVER_FIELD, 0 },
+   { SIP_SESSION_EXPIRES_FIELD, 0 },
+   { SIP_SUBSCRIPTION_STATE_FIELD, 0 },
+   { SIP_REPLACES_FIELD, 0 },
+   { SIP_DIVERSION_FIELD, 0 },
+   { SIP_P_ASSERTED_IDENTITY_FIELD, 0 },
+   { SIP_REASON_FIELD, 0 },
+   { SIP_WARNING_FIELD, 0 },
+   { SIP_ETAG_FIELD, 0 },
+   { SIP_IF_MATCH_FIELD, 0 },
+   { HTTP_USER_AGENT_FIELD, 0 },
+   { HTTP_DATE_FIELD, 0 },
+   { HTTP_AUTHORIZATION_FIELD, 0 },
+   { HTTP_PROXY_AUTHORIZATION_FIELD, 0 },
+   { HTTP_WWW_AUTHENTICATE_FIELD, 0 },
+   { HTTP_PROXY_AUTHENTICATE_FIELD, 0 },
+   { HTTP_ACCEPT_LANGUAGE_FIELD, 0 },
+   { HTTP_ACCEPT_ENCODING_FIELD, 0 },
+   { HTTP_CONTENT_DISPOSITION_FIELD, 0 },
+   { HTTP_CONTENT_TRANSFER_ENCODING_FIELD, 0 },
+   { HTTP_CONTENT_ID_FIELD, 0 },
+   { HTTP_HOST_FIELD, 0 },
+   { HTTP_CONNECTION_FIELD, 0 },
+   { HTTP_LOCATION_FIELD, 0 }
+};
+
+// Case insensitive hash table of sIndexedHeaderNames.
+class HttpHeaderIdTable
+{
+public:
+   enum
+   {
+      TABLE_SIZE = 256 ///< Power of 2, well above the number of names.
+   };
+
+   HttpHeaderIdTable()
+   {
+      int numNames = sizeof(sIndexedHeaderNames)/sizeof(sIndexedHeaderNames[0]);
+      memset(mSlots, 0, sizeof(mSlots));
+      memset(mCompactIds, 0, sizeof(mCompactIds));
+      for (int id = 1; id < numNames; id++)
+      {
+         const char* name = sIndexedHeaderNames[id].mpName;
+         unsigned slot = hash(name, strlen(name));
+         while (mSlots[slot] != 0)
+         {
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+         }
+         mSlots[slot] = id;
+
+         char compactForm = sIndexedHeaderNames[id].mCompactForm;
+         if (compactForm)
+         {
+            mCompactIds[compactForm - 'a'] = id;
+         }
+      }
+   }
+
+   // Return id of the name or 0 if it is not known.
+   int lookup(const char* name, int length, UtlBoolean& isCompact) const
+   {
+      isCompact = FALSE;
+      if (length == 1)
+      {
+         int letter = tolower((unsigned char)name[0]);
+         if (letter >= 'a' && letter <= 'z' && mCompactIds[letter - 'a'])
+         {
+            isCompact = TRUE;
+            return mCompactIds[letter - 'a'];
+         }
+         return 0;
+      }
+
+      unsigned slot = hash(name, length);
+      while (mSlots[slot] != 0)
+      {
+         const char* knownName = sIndexedHeaderNames[mSlots[slot]].mpName;
+         if (strncasecmp(knownName, name, length) == 0 &&
+             knownName[length] == '\0')
+         {
+            return mSlots[slot];
+         }
+         slot = (slot + 1) & (TABLE_SIZE - 1);
+      }
+      return 0;
+   }
+
+protected:
+   static unsigned hash(const char* name, int length)
+   {
+      unsigned h = 2166136261u;
+      for (int i = 0; i < length; i++)
+      {
+         h = (h ^ (unsigned char)toupper((unsigned char)name[i])) * 16777619u;
+      }
+      return h & (TABLE_SIZE - 1);
+   }
+
+   unsigned char mSlots[TABLE_SIZE];
+   unsigned char mCompactIds['z' - 'a' + 1];
+};
+
+static const HttpHeaderIdTable sHeaderIdTable;
 
 // LOCAL MACROS
 #ifdef _VXWORKS
@@ -88,6 +228,11 @@ HttpMessage::HttpMessage(const char* messageBytes, int byteCount)
    mSendPort = PORT_NONE;
    mpResponseListenerQueue = NULL;
    mResponseListenerData = NULL;
+   mpIndexedHeaders = NULL;
+   mIndexedHeadersSize = 0;
+   mpHeaderRefs = NULL;
+   mNumHeaderRefs = 0;
+   mShortNamesExpanded = FALSE;
 #ifdef HTTP_TIMELOG
    mTimeLog.addEvent("CREATED");
 #endif
@@ -112,6 +257,11 @@ HttpMessage::HttpMessage(OsSocket* inSocket, int bufferSize)
    mSendPort = PORT_NONE;
    mpResponseListenerQueue = NULL;
    mResponseListenerData = NULL;
+   mpIndexedHeaders = NULL;
+   mIndexedHeadersSize = 0;
+   mpHeaderRefs = NULL;
+   mNumHeaderRefs = 0;
+   mShortNamesExpanded = FALSE;
 #ifdef HTTP_TIMELOG
    mTimeLog.addEvent("READ FROM SOCKET");
 #endif
@@ -155,6 +305,12 @@ HttpMessage::HttpMessage(const HttpMessage& rHttpMessage)
       mNameValues.append(copiedHeader);
    }
 
+   mpIndexedHeaders = NULL;
+   mIndexedHeadersSize = 0;
+   mpHeaderRefs = NULL;
+   mNumHeaderRefs = 0;
+   copyHeaderIndex(rHttpMessage);
+
 #ifdef HTTP_TIMELOG
    mTimeLog = rHttpMessage.mTimeLog;
 #endif
@@ -183,6 +339,8 @@ HttpMessage::~HttpMessage()
       headerField = NULL;
    }
 
+   clearHeaderIndex();
+
    // This appears to be very slow
    //nameValues.destroyAll();
 
@@ -215,6 +373,7 @@ HttpMessage::operator=(const HttpMessage& rHttpMessage)
       delete headerField;
       headerField = NULL;
    }
+   clearHeaderIndex();
 
    if(body)
    {
@@ -251,6 +410,7 @@ HttpMessage::operator=(const HttpMessage& rHttpMessage)
       copiedHeader = new NameValuePair(*headerField);
       mNameValues.append(copiedHeader);
    }
+   copyHeaderIndex(rHttpMessage);
 
 #ifdef HTTP_TIMELOG
    mTimeLog = rHttpMessage.mTimeLog;
@@ -346,8 +506,8 @@ void HttpMessage::parseMessage(const char* messageBytes, int byteCount)
       bytesConsumed = parseFirstLine(messageBytes, byteCount);
 
       // Parse the headers out and add them to the list
-      bytesConsumed += parseHeaders(messageBytes + bytesConsumed, byteCount - bytesConsumed,
-         mNameValues);
+      bytesConsumed += parseHeaderBlock(messageBytes + bytesConsumed,
+                                        byteCount - bytesConsumed);
 
       // Create the body if there is stuff left
       if(byteCount > bytesConsumed)
@@ -512,6 +672,16 @@ int HttpMessage::parseHeaders(const char* headerBytes, int messageLength,
    return(parser.getProcessedIndex());
 }
 
+void HttpMessage::setHeaderIndexing(UtlBoolean enable)
+{
+   sHeaderIndexing = enable;
+}
+
+UtlBoolean HttpMessage::isHeaderIndexing()
+{
+   return(sHeaderIndexing);
+}
+
 int HttpMessage::get(Url& httpUrl,
                      int maxWaitMilliSeconds,
                      bool bPersistent)
@@ -644,7 +814,7 @@ OsStatus HttpMessage::get(Url& httpUrl,
       {
          mHeaderCacheClean = FALSE;
          int iHeaderLength = parseFirstLine(buffer.data(), iRead) ;
-         parseHeaders(&buffer.data()[iHeaderLength], iRead-iHeaderLength, mNameValues) ;
+         parseHeaderBlock(&buffer.data()[iHeaderLength], iRead-iHeaderLength) ;
 
          int iContentLength = getContentLength() ;
          if (iContentLength > 0)
@@ -964,6 +1134,7 @@ int HttpMessage::get(Url& httpUrl,
                 // Clear out the data in the previous response
                 mHeaderCacheClean = FALSE;
                 mNameValues.destroyAll();
+                clearHeaderIndex();
                     if(body)
                     {
                             delete body;
@@ -1117,6 +1288,7 @@ int HttpMessage::read(OsSocket* inSocket, int bufferSize,
    // Remember to empty the list of parsed header values, as we will use it
    // to parse the headers on the HTTP response we are going to read.
    mNameValues.destroyAll();
+   clearHeaderIndex();
 
    //the following code if enabled will test the effect of messages coming in a
    //fragmented way.  This should NOT be enabled in a released build as
@@ -1244,9 +1416,8 @@ int HttpMessage::read(OsSocket* inSocket, int bufferSize,
                int endOfFirstLine = parseFirstLine(allBytes->data(),
                                                    headerEnd);
                // Parse all of the headers
-               parseHeaders(&(allBytes->data()[endOfFirstLine]),
-                            headerEnd - endOfFirstLine,
-                            mNameValues);
+               parseHeaderBlock(&(allBytes->data()[endOfFirstLine]),
+                                headerEnd - endOfFirstLine);
 
 #ifdef TEST
                // Print out the header values as we have extracted them.
@@ -1940,7 +2111,29 @@ void HttpMessage::setResponseListenerData(void* responseListenerData)
 int HttpMessage::getCountHeaderFields(const char* name) const
 {
         int fieldCount;
-        if(name)
+        if(mpIndexedHeaders && name)
+        {
+            int nameLength = strlen(name);
+            UtlBoolean isCompact;
+            int headerId = sHeaderIdTable.lookup(name, nameLength, isCompact);
+
+            fieldCount = 0;
+            for (int refIndex = mFirstHeaderRef[headerId];
+                 refIndex >= 0;
+                 refIndex = mpHeaderRefs[refIndex].mNextSameId)
+            {
+                if (headerRefMatches(mpHeaderRefs[refIndex], name, nameLength,
+                                     headerId, isCompact))
+                {
+                    fieldCount++;
+                }
+            }
+        }
+        else if(mpIndexedHeaders)
+        {
+                fieldCount = mNumHeaderRefs;
+        }
+        else if(name)
         {
                 UtlString nameString(name);
                 nameString.toUpper();
@@ -2021,11 +2214,23 @@ NameValuePair* HttpMessage::getHeaderField(int index, const char* name) const
 const char* HttpMessage::getHeaderValue(int index, const char* name) const
 {
         const char* value = NULL;
-        NameValuePair* headerField = getHeaderField(index, name);
 
-        if(headerField)
+        if(mpIndexedHeaders)
         {
-                value = headerField->getValue();
+            int refIndex = findHeaderRef(index, name);
+            if(refIndex >= 0)
+            {
+                value = getHeaderRefValue(mpHeaderRefs[refIndex]);
+            }
+        }
+        else
+        {
+            NameValuePair* headerField = getHeaderField(index, name);
+
+            if(headerField)
+            {
+                    value = headerField->getValue();
+            }
         }
 
         return(value);
@@ -2034,6 +2239,21 @@ const char* HttpMessage::getHeaderValue(int index, const char* name) const
 void HttpMessage::setHeaderValue(const char* name, const char* newValue, int index)
 {
     mHeaderCacheClean = FALSE;
+
+    // Values of indexed headers can be replaced in place
+    int refIndex = -1;
+    if(mpIndexedHeaders && newValue)
+    {
+        refIndex = findHeaderRef(index, name);
+    }
+
+    if(refIndex >= 0)
+    {
+        setHeaderRefValue(mpHeaderRefs[refIndex], newValue);
+    }
+    else
+    {
+        materializeHeaders();
         NameValuePair* headerField = getHeaderField(index, name);
 
         if(headerField)
@@ -2044,12 +2264,13 @@ void HttpMessage::setHeaderValue(const char* name, const char* newValue, int ind
         {
                 addHeaderField(name, newValue);
         }
-
+    }
 }
 
 UtlBoolean HttpMessage::removeHeader(const char* name, int index)
 {
    mHeaderCacheClean = FALSE;
+   materializeHeaders();
    UtlBoolean foundHeader = FALSE;
    UtlDListIterator iterator((UtlDList&)mNameValues);
    NameValuePair* headerFieldName = NULL;
@@ -2102,6 +2323,7 @@ UtlBoolean HttpMessage::removeHeader(const char* name, int index)
 void HttpMessage::addHeaderField(const char* name, const char* value)
 {
     mHeaderCacheClean = FALSE;
+    materializeHeaders();
     NameValuePair* headerField =
         new NameValuePair(name ? name : "", value);
     headerField->toUpper();
@@ -2113,6 +2335,7 @@ void HttpMessage::insertHeaderField(const char* name,
                                     int index)
 {
     mHeaderCacheClean = FALSE;
+    materializeHeaders();
     NameValuePair* headerField =
         new NameValuePair(name ? name : "", value);
     headerField->toUpper();
@@ -2372,8 +2595,10 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
         bufferString->append(END_OF_LINE_DELIMITOR);
 
         UtlDListIterator iterator((UtlDList&)mNameValues);
-        NameValuePair* headerField;
+        NameValuePair* headerField = NULL;
+    int headerIndex = 0;
     UtlBoolean foundContentLengthHeader = FALSE;
+    char bodyLengthString[40];
         int bodyLen = 0;
         UtlString bodyBytes;
         if(body)
@@ -2381,42 +2606,30 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
                 body->getBytes(&bodyBytes, &bodyLen);
     }
 
-    int oldLen = 0 ;
-    if(mHeaderCacheClean &&
-        bodyLen == (oldLen = getContentLength()))
-    {
-        // We have a clean serialized cache of the first header line
-        // and headers, use it instead of serializing it
-
-        // Check if the content length is explicitly set
-        //if(oldLen > 0 ||  // avoid getHeaderField call if content length set
-        //   getHeaderField(0, HTTP_CONTENT_LENGTH_FIELD))
-        //{
-        //    foundContentLengthHeader = TRUE;
-        //}
-
-        // dummy code to allow instrumentation and setting of break points
-        oldLen = 0;
-    }
-    else
-    {
-        // we have to serialize the headers and cache the result
-        // This cast is a bit of hack for this instrumention so that
-        // the const signature does not have to change
-        ((HttpMessage*)this)->mHeaderCacheClean = TRUE;
-
-        // dummy code to allow instrumentation and setting of break points
-        oldLen = 0;
-    }
+    // Messages are shared by several threads (e.g. observers get copies of
+    // a SipMessageEvent which share the message), so serializing must not
+    // change the message.  A wrong content length is only corrected in the
+    // output bytes.
 
         // For each name value:
-        while((headerField = (NameValuePair*) iterator()))
+        while(mpIndexedHeaders
+              ? headerIndex < mNumHeaderRefs
+              : (headerField = (NameValuePair*) iterator()) != NULL)
+        {
+        if(mpIndexedHeaders)
+        {
+            getHeaderRefName(mpHeaderRefs[headerIndex], name);
+            value = getHeaderRefValue(mpHeaderRefs[headerIndex]);
+        }
+        else
         {
                 // Do not free up name and data as this are contained
                 // in the NameValuePair
                 name = *headerField;
-        cannonizeToken(name);
                 value = headerField->getValue();
+        }
+        headerIndex++;
+        cannonizeToken(name);
 
         // Keep track while we are looping through if we see a
         // content-length header or not - also test for a SIP short name
@@ -2429,12 +2642,10 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
             int fieldBodyLengthValue = atoi(value ? value : "");
             if(fieldBodyLengthValue != bodyLen)
             {
-                char bodyLengthString[40];
                 sprintf(bodyLengthString, "%d", bodyLen);
                 OsSysLog::add(FAC_SIP, PRI_WARNING, "HttpMessage::getBytes content-length: %s wrong setting to: %s",
                     value ? value : "", bodyLengthString);
-                headerField->setValue(bodyLengthString);
-                value = headerField->getValue();
+                value = bodyLengthString;
             }
         }
 
@@ -2457,7 +2668,6 @@ void HttpMessage::getBytes(UtlString* bufferString, int* length) const
             cannonizeToken(ContentLen);
             bufferString->append(ContentLen);
             bufferString->append(HTTP_NAME_VALUE_DELIMITER);
-            char bodyLengthString[40];
             if (pBody)
                 sprintf(bodyLengthString, " %d", pBody->getLength());
             else
@@ -3564,4 +3774,350 @@ UtlBoolean HttpMessage::isFirstSend() const
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
+void HttpMessage::materializeHeaders()
+{
+   if (mpIndexedHeaders == NULL)
+   {
+      return;
+   }
+
+   UtlString name;
+   for (int refIndex = 0; refIndex < mNumHeaderRefs; refIndex++)
+   {
+      const HeaderRef& headerRef = mpHeaderRefs[refIndex];
+      getHeaderRefName(headerRef, name);
+      mNameValues.append(new NameValuePair(name.data(),
+                                           getHeaderRefValue(headerRef)));
+   }
+
+   clearHeaderIndex();
+}
+
+UtlBoolean HttpMessage::expandIndexedShortNames()
+{
+   if (mpIndexedHeaders == NULL)
+   {
+      return FALSE;
+   }
+
+   if (!mShortNamesExpanded)
+   {
+      mShortNamesExpanded = TRUE;
+      for (int refIndex = 0; refIndex < mNumHeaderRefs; refIndex++)
+      {
+         if (mpHeaderRefs[refIndex].mFlags & HEADER_REF_COMPACT)
+         {
+            mHeaderCacheClean = FALSE;
+            break;
+         }
+      }
+   }
+
+   return TRUE;
+}
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+int HttpMessage::parseHeaderBlock(const char* headerBytes, int messageLength)
+{
+   int bytesParsed;
+
+   if (sHeaderIndexing &&
+       mpIndexedHeaders == NULL &&
+       mNameValues.isEmpty())
+   {
+      bytesParsed = indexHeaders(headerBytes, messageLength);
+   }
+   else
+   {
+      // Headers are being added to existing ones
+      materializeHeaders();
+      bytesParsed = parseHeaders(headerBytes, messageLength, mNameValues);
+   }
+
+   return(bytesParsed);
+}
+
+int HttpMessage::indexHeaders(const char* headerBytes, int messageLength)
+{
+   clearHeaderIndex();
+   mShortNamesExpanded = FALSE;
+
+   // Values are terminated in place, the extra byte is for the value
+   // of a last line with no line terminator.
+   if (messageLength < 0)
+   {
+      messageLength = 0;
+   }
+   mIndexedHeadersSize = messageLength + 1;
+   mpIndexedHeaders = new char[mIndexedHeadersSize];
+   memcpy(mpIndexedHeaders, headerBytes, messageLength);
+   mpIndexedHeaders[messageLength] = '\0';
+   char* bytes = mpIndexedHeaders;
+
+   int lastHeaderRef[MAX_HEADER_IDS];
+   for (int headerId = 0; headerId < MAX_HEADER_IDS; headerId++)
+   {
+      mFirstHeaderRef[headerId] = -1;
+      lastHeaderRef[headerId] = -1;
+   }
+
+   int maxHeaderRefs = 0;
+   int previousRef = -1;
+   int bytesConsumed = 0;
+
+   // Same rules as parseHeaders() and UtlNameValueTokenizer::getNextPair()
+   for (;;)
+   {
+      int lineStart = bytesConsumed;
+      int nextLineOffset;
+      int lineLength =
+         UtlNameValueTokenizer::findNextLineTerminator(&bytes[lineStart],
+                                                       messageLength - lineStart,
+                                                       &nextLineOffset);
+      if (lineLength < 0)
+      {
+         lineLength = messageLength - lineStart;
+      }
+      bytesConsumed += nextLineOffset > 0 ? nextLineOffset : lineLength;
+
+      int nameEnd = 0;
+      while (nameEnd < lineLength &&
+             bytes[lineStart + nameEnd] != HTTP_NAME_VALUE_DELIMITER)
+      {
+         nameEnd++;
+      }
+
+      // If this is a zero length line or a line without a name,
+      // the rest is the body
+      if (nameEnd == 0)
+      {
+         break;
+      }
+
+      int valueStart = nameEnd + 1;
+      while (valueStart < lineLength &&
+             (bytes[lineStart + valueStart] == ' ' ||
+              bytes[lineStart + valueStart] == '\t'))
+      {
+         valueStart++;
+      }
+      int valueLength = lineLength - valueStart;
+
+      // Terminate the value in place of the line terminator
+      bytes[lineStart + lineLength] = '\0';
+
+      // If this is a line continuation, append the line to the
+      // previous header's value
+      if (previousRef >= 0 &&
+          (bytes[lineStart] == ' ' || bytes[lineStart] == '\t'))
+      {
+         HeaderRef& headerRef = mpHeaderRefs[previousRef];
+         if (headerRef.mpValue == NULL)
+         {
+            headerRef.mpValue =
+               new UtlString(&bytes[headerRef.mValueOffset]);
+         }
+         headerRef.mpValue->append(&bytes[lineStart], nameEnd);
+         if (valueLength > 0)
+         {
+            headerRef.mpValue->append(HTTP_NAME_VALUE_DELIMITER);
+            headerRef.mpValue->append(&bytes[lineStart + valueStart],
+                                      valueLength);
+         }
+         continue;
+      }
+
+      // Remove leading white space of the name
+      int nameStart = 0;
+      while (nameStart < nameEnd &&
+             (bytes[lineStart + nameStart] == ' ' ||
+              bytes[lineStart + nameStart] == '\t'))
+      {
+         nameStart++;
+      }
+
+      if (mNumHeaderRefs == maxHeaderRefs)
+      {
+         maxHeaderRefs = maxHeaderRefs ? 2 * maxHeaderRefs : 32;
+         HeaderRef* newHeaderRefs = new HeaderRef[maxHeaderRefs];
+         if (mNumHeaderRefs > 0)
+         {
+            memcpy(newHeaderRefs, mpHeaderRefs,
+                   mNumHeaderRefs * sizeof(HeaderRef));
+         }
+         delete[] mpHeaderRefs;
+         mpHeaderRefs = newHeaderRefs;
+      }
+
+      HeaderRef& headerRef = mpHeaderRefs[mNumHeaderRefs];
+      headerRef.mNameOffset = lineStart + nameStart;
+      headerRef.mNameLength = nameEnd - nameStart;
+      headerRef.mValueOffset = valueLength > 0
+                               ? lineStart + valueStart
+                               : lineStart + lineLength;
+      headerRef.mNextSameId = -1;
+      headerRef.mpValue = NULL;
+
+      UtlBoolean isCompact;
+      int headerId = sHeaderIdTable.lookup(&bytes[headerRef.mNameOffset],
+                                           headerRef.mNameLength,
+                                           isCompact);
+      headerRef.mHeaderId = (unsigned char)headerId;
+      headerRef.mFlags = isCompact ? HEADER_REF_COMPACT : 0;
+
+      if (lastHeaderRef[headerId] < 0)
+      {
+         mFirstHeaderRef[headerId] = mNumHeaderRefs;
+      }
+      else
+      {
+         mpHeaderRefs[lastHeaderRef[headerId]].mNextSameId = mNumHeaderRefs;
+      }
+      lastHeaderRef[headerId] = mNumHeaderRefs;
+
+      previousRef = mNumHeaderRefs;
+      mNumHeaderRefs++;
+   }
+
+   return(bytesConsumed);
+}
+
+void HttpMessage::copyHeaderIndex(const HttpMessage& rHttpMessage)
+{
+   clearHeaderIndex();
+   mShortNamesExpanded = rHttpMessage.mShortNamesExpanded;
+
+   if (rHttpMessage.mpIndexedHeaders)
+   {
+      mIndexedHeadersSize = rHttpMessage.mIndexedHeadersSize;
+      mpIndexedHeaders = new char[mIndexedHeadersSize];
+      memcpy(mpIndexedHeaders, rHttpMessage.mpIndexedHeaders,
+             mIndexedHeadersSize);
+
+      mNumHeaderRefs = rHttpMessage.mNumHeaderRefs;
+      if (mNumHeaderRefs > 0)
+      {
+         mpHeaderRefs = new HeaderRef[mNumHeaderRefs];
+         memcpy(mpHeaderRefs, rHttpMessage.mpHeaderRefs,
+                mNumHeaderRefs * sizeof(HeaderRef));
+         for (int refIndex = 0; refIndex < mNumHeaderRefs; refIndex++)
+         {
+            if (mpHeaderRefs[refIndex].mpValue)
+            {
+               mpHeaderRefs[refIndex].mpValue =
+                  new UtlString(*rHttpMessage.mpHeaderRefs[refIndex].mpValue);
+            }
+         }
+      }
+      memcpy(mFirstHeaderRef, rHttpMessage.mFirstHeaderRef,
+             sizeof(mFirstHeaderRef));
+   }
+}
+
+void HttpMessage::clearHeaderIndex()
+{
+   for (int refIndex = 0; refIndex < mNumHeaderRefs; refIndex++)
+   {
+      delete mpHeaderRefs[refIndex].mpValue;
+   }
+   delete[] mpHeaderRefs;
+   mpHeaderRefs = NULL;
+   mNumHeaderRefs = 0;
+
+   delete[] mpIndexedHeaders;
+   mpIndexedHeaders = NULL;
+   mIndexedHeadersSize = 0;
+}
+
+int HttpMessage::findHeaderRef(int index, const char* name) const
+{
+   if (index < 0)
+   {
+      return -1;
+   }
+
+   if (name == NULL)
+   {
+      return index < mNumHeaderRefs ? index : -1;
+   }
+
+   int nameLength = strlen(name);
+   UtlBoolean isCompact;
+   int headerId = sHeaderIdTable.lookup(name, nameLength, isCompact);
+
+   for (int refIndex = mFirstHeaderRef[headerId];
+        refIndex >= 0;
+        refIndex = mpHeaderRefs[refIndex].mNextSameId)
+   {
+      if (headerRefMatches(mpHeaderRefs[refIndex], name, nameLength,
+                           headerId, isCompact) &&
+          index-- == 0)
+      {
+         return refIndex;
+      }
+   }
+
+   return -1;
+}
+
+UtlBoolean HttpMessage::headerRefMatches(const HeaderRef& headerRef,
+                                         const char* name,
+                                         int nameLength,
+                                         int headerId,
+                                         UtlBoolean isCompact) const
+{
+   UtlBoolean matches;
+
+   if (headerId == 0)
+   {
+      matches = headerRef.mNameLength == nameLength &&
+                strncasecmp(name, mpIndexedHeaders + headerRef.mNameOffset,
+                            nameLength) == 0;
+   }
+   else
+   {
+      // A compact name is a different name until SipMessage expands it,
+      // just as in mNameValues.
+      UtlBoolean refIsCompact =
+         (headerRef.mFlags & HEADER_REF_COMPACT) && !mShortNamesExpanded;
+      matches = headerRef.mHeaderId == headerId && refIsCompact == isCompact;
+   }
+
+   return(matches);
+}
+
+void HttpMessage::getHeaderRefName(const HeaderRef& headerRef,
+                                   UtlString& name) const
+{
+   name.remove(0);
+   if ((headerRef.mFlags & HEADER_REF_COMPACT) && mShortNamesExpanded)
+   {
+      name.append(sIndexedHeaderNames[headerRef.mHeaderId].mpName);
+   }
+   else
+   {
+      name.append(mpIndexedHeaders + headerRef.mNameOffset,
+                  headerRef.mNameLength);
+      name.toUpper();
+   }
+}
+
+const char* HttpMessage::getHeaderRefValue(const HeaderRef& headerRef) const
+{
+   return(headerRef.mpValue
+          ? headerRef.mpValue->data()
+          : mpIndexedHeaders + headerRef.mValueOffset);
+}
+
+void HttpMessage::setHeaderRefValue(HeaderRef& headerRef, const char* value)
+{
+   if (headerRef.mpValue)
+   {
+      *headerRef.mpValue = value;
+   }
+   else
+   {
+      headerRef.mpValue = new UtlString(value);
+   }
+}
@@ -21,6 +21,7 @@
 #include <net/SipUserAgentBase.h>
 #include <net/SipClient.h>
 #include <net/SipMessageEvent.h>
+#include <net/SipStreamFramer.h>
 
 #include <os/OsDateTime.h>
 #include <os/OsDatagramSocket.h>
@@ -73,10 +74,18 @@ SipClient::SipClient(OsSocket* socket) :
    mFirstResendTimeoutMs(SIP_DEFAULT_RTT * 4), // for first transaction time out
    mInUseForWrite(0),
    mWaitingList(NULL),
-   mbSharedSocket(FALSE)
+   mbSharedSocket(FALSE),
+   mpFramer(NULL)
  {
    touch();
 
+   // Stream sockets get a framing buffer which is kept for the life of
+   // the connection.
+   if (mSocketType == OsSocket::TCP || mSocketType == OsSocket::SSL_SOCKET)
+   {
+      mpFramer = new SipStreamFramer();
+   }
+
    if(clientSocket)
    {
        clientSocket->getRemoteHostName(&mRemoteHostName);
@@ -96,7 +105,8 @@ SipClient::SipClient(OsSocket* socket) :
 
 // Copy constructor
 SipClient::SipClient(const SipClient& rSipClient) 
-    : mSocketLock(OsBSem::Q_FIFO, OsBSem::FULL)
+    : mSocketLock(OsBSem::Q_FIFO, OsBSem::FULL),
+      mpFramer(NULL)
 {
 }
 
@@ -177,6 +187,9 @@ SipClient::~SipClient()
         mWaitingList = NULL;
     }
 
+    delete mpFramer;
+    mpFramer = NULL;
+
     // Do not delete the event listers they are not subordinate
 }
 
@@ -186,6 +199,7 @@ int SipClient::run(void* runArg)
 {
     int bytesRead;
     UtlString buffer;
+    const char* messageBytes = NULL;
     SipMessage* message = NULL;
     UtlString remoteHostName;
     UtlString viaProtocol;
@@ -235,8 +249,10 @@ int SipClient::run(void* runArg)
                           readAMessage, buffer.length(), clientSocket);
 #endif
             if(clientSocket 
-                && ((readAMessage
-                     && buffer.length() >= MINIMUM_SIP_MESSAGE_SIZE)
+                && ((mpFramer
+                     ? mpFramer->hasMessage()
+                     : (readAMessage
+                        && buffer.length() >= MINIMUM_SIP_MESSAGE_SIZE))
                     || waitForReadyToRead()))
             {
 #ifdef LOG_TIME
@@ -274,7 +290,22 @@ int SipClient::run(void* runArg)
                     eventTimes.addEvent("reading");
 #endif
                     message->setFromThisSide(false);
-                    bytesRead = message->read(clientSocket, readBufferSize, &buffer);
+                    if (mpFramer)
+                    {
+                        // Parse the message in place in the framing buffer
+                        bytesRead = mpFramer->readMessage(*clientSocket, messageBytes);
+                        if (bytesRead > 0)
+                        {
+                            message->parseMessage(messageBytes, bytesRead);
+                            clientSocket->getRemoteHostIp(&fromIpAddress, &fromPort);
+                            message->setSendAddress(fromIpAddress.data(), fromPort);
+                        }
+                    }
+                    else
+                    {
+                        bytesRead = message->read(clientSocket, readBufferSize, &buffer);
+                        messageBytes = buffer.data();
+                    }
 
                     OsSysLog::add(FAC_SIP, PRI_DEBUG,
                                  "SipClient::run HttpMessage::read returned: %d message size(bytesRead)",
@@ -320,7 +351,8 @@ int SipClient::run(void* runArg)
                    // Not sure why non-Framed (e.g. TCP) sockets get into a mode of reading zero bytes and yet poll
                    // says there is no error and the socket is open, probably due to some connection error.  Need to figure this out
                    // at some point and trap the error.
-                   (!clientSocket->isFramed(clientSocket->getIpProtocol()) && bytesRead == 0) || 
+                   // The framer returns 0 while a message is incomplete, which is not an error.
+                   (!mpFramer && !clientSocket->isFramed(clientSocket->getIpProtocol()) && bytesRead == 0) || 
                     !clientSocket->isOk()))
             {
                 numFailures++;
@@ -346,178 +378,32 @@ int SipClient::run(void* runArg)
                 numFailures = 0;
                     touch();
 #ifdef TEST_PRINT
-               osPrintf("Read SIP message:\n%s====================END====================\n", buffer.data());
+               osPrintf("Read SIP message:\n%.*s====================END====================\n", bytesRead, messageBytes);
 #endif
                 if(sipUserAgent)
                 {
-                    UtlString socketRemoteHost;
-                    UtlString lastAddress;
-                    UtlString lastProtocol;
-                    int lastPort;
-
-                    // Only bother processing if the logs are enabled
-                    if (sipUserAgent->isMessageLoggingEnabled() ||
-                            OsSysLog::willLog(FAC_SIP_INCOMING, PRI_INFO))
-                    {
-                       UtlString logMessage;
-                       logMessage.append("Read SIP message:\n");
-                       logMessage.append("----Remote Host:");
-                       logMessage.append(fromIpAddress);
-                       logMessage.append("---- Port: ");
-                       char buff[10];
-                       sprintf(buff, "%d",
-                               !portIsValid(fromPort) ? 5060 : fromPort);
-                       logMessage.append(buff);
-                       logMessage.append("----\n");
-
-                       logMessage.append(buffer.data(), bytesRead);
-                       UtlString messageString;
-                       logMessage.append(messageString);
-                       logMessage.append("====================END====================\n");
-
-                       sipUserAgent->logMessage(logMessage.data(), logMessage.length());
-                       OsSysLog::add(FAC_SIP_INCOMING, PRI_INFO, "%s", logMessage.data());
-                    }
-
-#ifdef DEBUG_POLL_NO_BYTES
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-#endif
-                    // Set the date field if not present
-                    long epochDate;
-                    if(!message->getDateField(&epochDate))
-                    {
-                        message->setDateField();
-                    }
-
-#ifdef DEBUG_POLL_NO_BYTES
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+#ifdef LOG_TIME
+                    eventTimes.addEvent("dispatching");
 #endif
-                    message->setSendProtocol(mSocketType);
-                    message->setTransportTime(touchedTime);
-                    clientSocket->getRemoteHostIp(&socketRemoteHost);
-
-                    // Keep track of where this message came from
-                    message->setSendAddress(fromIpAddress.data(), fromPort);
-                    
-                    // Keep track of the interface on which this message was
-                    // received.               
-                    message->setLocalIp(clientSocket->getLocalIp());
-
-                    if(mReceivedAddress.isNull())
-                    {
-                        mReceivedAddress = fromIpAddress;
-                        mRemoteReceivedPort = fromPort;
-                    }
-
-#ifdef DEBUG_POLL_NO_BYTES
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+                    processMessage(message, messageBytes, bytesRead,
+                                   fromIpAddress, fromPort);
+                    message = NULL;
+#ifdef LOG_TIME
+                    eventTimes.addEvent("dispatched");
 #endif
-                    // If this is a request
-                    if(!message->isResponse())
-                    {
-                       int receivedPort;
-                       UtlBoolean receivedSet;
-                       UtlBoolean maddrSet;
-                       UtlBoolean receivedPortSet;
-
-                       // fill in 'received' and 'rport' in top via if needed.
-                       message->setReceivedViaParams(fromIpAddress, fromPort);
-
-                       // get the addresses from the topmost via.
-                       message->getLastVia(&lastAddress, &lastPort, &lastProtocol,
-                                           &receivedPort, &receivedSet, &maddrSet,
-                                           &receivedPortSet);
-
-                        if (   (   mSocketType == OsSocket::TCP
-                                || mSocketType == OsSocket::SSL_SOCKET
-                                )
-                            && !receivedPortSet
-                            )
-                        {
-                            // we can use this socket as if it were
-                            // connected to the port specified in the
-                            // via field
-                            mRemoteReceivedPort = lastPort;
-                        }
-
-                        // Keep track of the address the other
-                        // side said they sent from.  Note, this cannot
-                        // be trusted unless this transaction is
-                        // authenticated
-                        if(mRemoteViaAddress.isNull())
-                        {
-                            mRemoteViaAddress = lastAddress;
-                            mRemoteViaPort = portIsValid(lastPort) ? lastPort : 5060;
-                        }
-                    }
 
                     // We read a whole message whether it is a valid one or
                     // not does not matter
                     readAMessage = TRUE;
-
-                    // Check that we have the minimum data to define a transaction
-                    UtlString callId;
-                    UtlString fromField;
-                    UtlString toField;
-                    message->getCallIdField(&callId);
-                    message->getFromField(&fromField);
-                    message->getToField(&toField);
-#ifdef DEBUG_POLL_NO_BYTES
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-                    OsSysLog::flush();
-#endif
-                    if(!(   callId.isNull()
-                         || fromField.isNull()
-                         || toField.isNull()))
-                    {
-#ifdef DEBUG_POLL_NO_BYTES
-                        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-                        OsSysLog::flush();
-#endif
-#ifdef LOG_TIME
-                        eventTimes.addEvent("dispatching");
-#endif
-                        sipUserAgent->dispatch(message);
-#ifdef DEBUG_POLL_NO_BYTES
-                        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-                        OsSysLog::flush();
-#endif
-#ifdef LOG_TIME
-                        eventTimes.addEvent("dispatched");
-#endif
-
-                        message = NULL; // protect the dispatched message from deletion below
-                    }
-                    else
-                    {
-#ifdef DEBUG_POLL_NO_BYTES
-                        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-                        OsSysLog::flush();
-#endif
-                       // Only bother processing if the logs are enabled
-                       if (sipUserAgent->isMessageLoggingEnabled())
-                       {
-                          UtlString msgBytes;
-                                    int msgLen;
-                                    message->getBytes(&msgBytes, &msgLen);
-                                    msgBytes.insert(0, "Received incomplete message (missing To, From or Call-Id header)\n");
-                                    msgBytes.append("++++++++++++++++++++END++++++++++++++++++++\n");
-                                    sipUserAgent->logMessage(msgBytes.data(), msgBytes.length());
-                       }
-#ifdef DEBUG_POLL_NO_BYTES
-                        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
-                        OsSysLog::flush();
-#endif
-
-                       delete message;
-                       message = NULL;
-                    }
-
                 } //if sipuseragent
 
                 // Get rid of the consumed stuff in the buffer so it
-                // contains only bytes which are part of the next message
-                buffer.remove(0, bytesRead);
+                // contains only bytes which are part of the next message.
+                // The framer drops it on its next call.
+                if (!mpFramer)
+                {
+                    buffer.remove(0, bytesRead);
+                }
 
                 if(   mSocketType == OsSocket::UDP
                    && buffer.length()
@@ -568,6 +454,212 @@ int SipClient::run(void* runArg)
     return(0);
 }
 
+UtlBoolean SipClient::readStream()
+{
+    const char* messageBytes = NULL;
+    UtlString fromIpAddress;
+    int fromPort = PORT_NONE;
+
+    // Lock to prevent multi-treaded read or write
+    mSocketLock.acquire();
+    int bytesRead = mpFramer->readMessage(*clientSocket, messageBytes);
+    mSocketLock.release();
+
+    if (bytesRead > 0)
+    {
+        touch();
+        clientSocket->getRemoteHostIp(&fromIpAddress, &fromPort);
+    }
+
+    while (bytesRead > 0)
+    {
+        if (sipUserAgent)
+        {
+            SipMessage* message = new SipMessage();
+            message->setFromThisSide(false);
+            message->parseMessage(messageBytes, bytesRead);
+            message->replaceShortFieldNames();
+            processMessage(message, messageBytes, bytesRead,
+                           fromIpAddress, fromPort);
+        }
+
+        // Messages which arrived together are already buffered
+        bytesRead = mpFramer->nextMessage(messageBytes);
+    }
+
+    if (bytesRead < 0 || !clientSocket->isOk())
+    {
+        OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                      "SipClient::readStream %p closing %s socket to %s:%d",
+                      this, OsSocket::ipProtocolString(mSocketType),
+                      mRemoteSocketAddress.data(), mRemoteHostPort);
+        clientSocket->close();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void SipClient::processMessage(SipMessage* message,
+                               const char* messageBytes,
+                               int messageLength,
+                               const UtlString& fromIpAddress,
+                               int fromPort)
+{
+    UtlString socketRemoteHost;
+    UtlString lastAddress;
+    UtlString lastProtocol;
+    int lastPort;
+
+    // Only bother processing if the logs are enabled
+    if (sipUserAgent->isMessageLoggingEnabled() ||
+            OsSysLog::willLog(FAC_SIP_INCOMING, PRI_INFO))
+    {
+       UtlString logMessage;
+       logMessage.append("Read SIP message:\n");
+       logMessage.append("----Remote Host:");
+       logMessage.append(fromIpAddress);
+       logMessage.append("---- Port: ");
+       char buff[10];
+       sprintf(buff, "%d",
+               !portIsValid(fromPort) ? 5060 : fromPort);
+       logMessage.append(buff);
+       logMessage.append("----\n");
+
+       logMessage.append(messageBytes, messageLength);
+       UtlString messageString;
+       logMessage.append(messageString);
+       logMessage.append("====================END====================\n");
+
+       sipUserAgent->logMessage(logMessage.data(), logMessage.length());
+       OsSysLog::add(FAC_SIP_INCOMING, PRI_INFO, "%s", logMessage.data());
+    }
+
+#ifdef DEBUG_POLL_NO_BYTES
+    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+#endif
+    // Set the date field if not present
+    long epochDate;
+    if(!message->getDateField(&epochDate))
+    {
+        message->setDateField();
+    }
+
+#ifdef DEBUG_POLL_NO_BYTES
+    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+#endif
+    message->setSendProtocol(mSocketType);
+    message->setTransportTime(touchedTime);
+    clientSocket->getRemoteHostIp(&socketRemoteHost);
+
+    // Keep track of where this message came from
+    message->setSendAddress(fromIpAddress.data(), fromPort);
+    
+    // Keep track of the interface on which this message was
+    // received.               
+    message->setLocalIp(clientSocket->getLocalIp());
+
+    if(mReceivedAddress.isNull())
+    {
+        mReceivedAddress = fromIpAddress;
+        mRemoteReceivedPort = fromPort;
+    }
+
+#ifdef DEBUG_POLL_NO_BYTES
+    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+#endif
+    // If this is a request
+    if(!message->isResponse())
+    {
+       int receivedPort;
+       UtlBoolean receivedSet;
+       UtlBoolean maddrSet;
+       UtlBoolean receivedPortSet;
+
+       // fill in 'received' and 'rport' in top via if needed.
+       message->setReceivedViaParams(fromIpAddress, fromPort);
+
+       // get the addresses from the topmost via.
+       message->getLastVia(&lastAddress, &lastPort, &lastProtocol,
+                           &receivedPort, &receivedSet, &maddrSet,
+                           &receivedPortSet);
+
+        if (   (   mSocketType == OsSocket::TCP
+                || mSocketType == OsSocket::SSL_SOCKET
+                )
+            && !receivedPortSet
+            )
+        {
+            // we can use this socket as if it were
+            // connected to the port specified in the
+            // via field
+            mRemoteReceivedPort = lastPort;
+        }
+
+        // Keep track of the address the other
+        // side said they sent from.  Note, this cannot
+        // be trusted unless this transaction is
+        // authenticated
+        if(mRemoteViaAddress.isNull())
+        {
+            mRemoteViaAddress = lastAddress;
+            mRemoteViaPort = portIsValid(lastPort) ? lastPort : 5060;
+        }
+    }
+
+    // Check that we have the minimum data to define a transaction
+    UtlString callId;
+    UtlString fromField;
+    UtlString toField;
+    message->getCallIdField(&callId);
+    message->getFromField(&fromField);
+    message->getToField(&toField);
+#ifdef DEBUG_POLL_NO_BYTES
+    OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+    OsSysLog::flush();
+#endif
+    if(!(   callId.isNull()
+         || fromField.isNull()
+         || toField.isNull()))
+    {
+#ifdef DEBUG_POLL_NO_BYTES
+        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+        OsSysLog::flush();
+#endif
+        sipUserAgent->dispatch(message);
+#ifdef DEBUG_POLL_NO_BYTES
+        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+        OsSysLog::flush();
+#endif
+
+        message = NULL; // protect the dispatched message from deletion below
+    }
+    else
+    {
+#ifdef DEBUG_POLL_NO_BYTES
+        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+        OsSysLog::flush();
+#endif
+       // Only bother processing if the logs are enabled
+       if (sipUserAgent->isMessageLoggingEnabled())
+       {
+          UtlString msgBytes;
+                    int msgLen;
+                    message->getBytes(&msgBytes, &msgLen);
+                    msgBytes.insert(0, "Received incomplete message (missing To, From or Call-Id header)\n");
+                    msgBytes.append("++++++++++++++++++++END++++++++++++++++++++\n");
+                    sipUserAgent->logMessage(msgBytes.data(), msgBytes.length());
+       }
+#ifdef DEBUG_POLL_NO_BYTES
+        OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipClient line: %d", __LINE__);
+        OsSysLog::flush();
+#endif
+
+       delete message;
+       message = NULL;
+    }
+}
+
 // Test whether the socket is ready to read. (Does not block.)
 UtlBoolean SipClient::isReadyToRead()
 {
@@ -931,6 +1023,20 @@ const UtlString& SipClient::getLocalIp()
     return clientSocket->getLocalIp();
 }
 
+int SipClient::getSocketDescriptor() const
+{
+    return clientSocket ? clientSocket->getSocketDescriptor() : -1;
+}
+
+UtlBoolean SipClient::isStream() const
+{
+    // TLS reads block until a whole record has arrived, and data already
+    // decrypted by the TLS layer is not reported by the socket, so TLS
+    // connections keep their own task.
+    return mpFramer != NULL &&
+           clientSocket->getIpProtocol() != OsSocket::SSL_SOCKET;
+}
+
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
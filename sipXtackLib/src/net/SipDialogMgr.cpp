@@ -24,20 +24,48 @@
 // CONSTANTS
 // STATIC VARIABLE INITIALIZATIONS
 
+// Dialogs of a group of Call-Ids and the lock which guards them
+class SipDialogStripe
+{
+public:
+    SipDialogStripe();
+
+    void lock();
+    void unlock();
+
+    UtlHashBag mDialogs;
+    OsMutex mMutex;
+};
+
+SipDialogStripe::SipDialogStripe() :
+mMutex(OsMutex::Q_FIFO)
+{
+}
+
+void SipDialogStripe::lock()
+{
+    mMutex.acquire();
+}
+
+void SipDialogStripe::unlock()
+{
+    mMutex.release();
+}
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* ============================ CREATORS ================================== */
 
 // Constructor
 SipDialogMgr::SipDialogMgr()
-: mDialogMgrMutex(OsMutex::Q_FIFO)
+: mpStripes(new SipDialogStripe[NUM_STRIPES])
 {
 }
 
 
 // Copy constructor NOT IMPLEMENTED
 SipDialogMgr::SipDialogMgr(const SipDialogMgr& rSipDialogMgr)
-: mDialogMgrMutex(OsMutex::Q_FIFO)
+: mpStripes(new SipDialogStripe[NUM_STRIPES])
 {
 }
 
@@ -46,7 +74,11 @@ SipDialogMgr::SipDialogMgr(const SipDialogMgr& rSipDialogMgr)
 SipDialogMgr::~SipDialogMgr()
 {
     // Iterate through and delete all the dialogs
-    // TODO:
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpStripes[i].mDialogs.destroyAll();
+    }
+    delete[] mpStripes;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -73,6 +105,22 @@ UtlBoolean SipDialogMgr::createDialog(const SipMessage& message,
         message.getDialogHandle(handle);
     }
 
+    SipDialog* dialog = new SipDialog(&message, messageIsFromLocalSide);
+
+    // The handle given may not have the Call-Id of the message.  When both
+    // stripes are needed they are locked in the order of the array, so two
+    // threads never wait for each other.
+    SipDialogStripe* pFirstStripe = &getStripeFor(handle);
+    SipDialogStripe* pSecondStripe = &getStripe(*dialog);
+    if(pSecondStripe < pFirstStripe)
+    {
+        SipDialogStripe* pStripe = pFirstStripe;
+        pFirstStripe = pSecondStripe;
+        pSecondStripe = pStripe;
+    }
+    pFirstStripe->lock();
+    if(pSecondStripe != pFirstStripe) pSecondStripe->lock();
+
     // Check to see if the dialog exists
     if(dialogExists(handle) ||
         earlyDialogExistsFor(handle))
@@ -88,12 +136,16 @@ UtlBoolean SipDialogMgr::createDialog(const SipMessage& message,
     else
     {
         createdDialog = TRUE;
-        SipDialog* dialog = new SipDialog(&message, messageIsFromLocalSide);
-        lock();
-        mDialogs.insert(dialog);
-        unlock();
+        getStripe(*dialog).mDialogs.insert(dialog);
+        dialog = NULL;
     }
 
+    if(pSecondStripe != pFirstStripe) pSecondStripe->unlock();
+    pFirstStripe->unlock();
+
+    // The dialog was not needed
+    delete dialog;
+
     return(createdDialog);
 }
 
@@ -107,7 +159,8 @@ UtlBoolean SipDialogMgr::updateDialog(const SipMessage& message,
         message.getDialogHandle(handle);
     }
 
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     
     SipDialog* dialog = findDialog(handle,
                                    TRUE, // if established handle, find early dialog
@@ -131,7 +184,7 @@ UtlBoolean SipDialogMgr::updateDialog(const SipMessage& message,
     }
 
 
-    unlock();
+    stripe.unlock();
 
     return(dialog != NULL);
 }
@@ -147,7 +200,8 @@ UtlBoolean SipDialogMgr::setNextLocalTransactionInfo(SipMessage& request,
         request.getDialogHandle(dialogHandleString);
     }
 
-    lock();
+    SipDialogStripe& stripe = getStripeFor(dialogHandleString);
+    stripe.lock();
     SipDialog* dialog = findDialog(dialogHandleString,
                                    FALSE, // If established only want exact match  dialogs 
                                    TRUE); // If message is from a prior transaction
@@ -175,7 +229,7 @@ UtlBoolean SipDialogMgr::setNextLocalTransactionInfo(SipMessage& request,
                       dialogHandle);
     }
 
-    unlock();
+    stripe.unlock();
 
     return(requestSet);
 }
@@ -188,7 +242,8 @@ UtlBoolean SipDialogMgr::getEarlyDialogHandleFor(const char* establishedDialogHa
     UtlBoolean foundDialog = FALSE;
     UtlString handle(establishedDialogHandle ? establishedDialogHandle : "");
 
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     SipDialog* dialog = findDialog(handle,
                                    TRUE, // if established, match early dialog
                                    FALSE); // if early, match established dialog
@@ -201,7 +256,7 @@ UtlBoolean SipDialogMgr::getEarlyDialogHandleFor(const char* establishedDialogHa
     {
         earlyDialogHandle = "";
     }
-    unlock();
+    stripe.unlock();
 
     return(foundDialog);
 }
@@ -211,7 +266,8 @@ UtlBoolean SipDialogMgr::getEstablishedDialogHandleFor(const char* earlyDialogHa
 {
     UtlBoolean foundDialog = FALSE;
     UtlString handle(earlyDialogHandle ? earlyDialogHandle : "");
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Looking for an dialog that matches this earlyHandle, if there
     // is not an exact match see if there is an established dialog
     // that matches
@@ -227,7 +283,7 @@ UtlBoolean SipDialogMgr::getEstablishedDialogHandleFor(const char* earlyDialogHa
     {
         establishedDialogHandle = "";
     }
-    unlock();
+    stripe.unlock();
 
     return(foundDialog);
 
@@ -235,7 +291,14 @@ UtlBoolean SipDialogMgr::getEstablishedDialogHandleFor(const char* earlyDialogHa
 
 int SipDialogMgr::countDialogs() const
 {
-    return(mDialogs.entries());
+    int dialogCount = 0;
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpStripes[i].lock();
+        dialogCount += mpStripes[i].mDialogs.entries();
+        mpStripes[i].unlock();
+    }
+    return(dialogCount);
 }
 
 int SipDialogMgr::toString(UtlString& dumpString)
@@ -245,18 +308,22 @@ int SipDialogMgr::toString(UtlString& dumpString)
     UtlString oneDialogDump;
     SipDialog* dialog = NULL;
 
-    UtlHashBagIterator iterator(mDialogs);
-    // Look at all the dialogs with the same call-id
-    while((dialog = (SipDialog*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        if(dialogCount)
+        mpStripes[i].lock();
+        UtlHashBagIterator iterator(mpStripes[i].mDialogs);
+        while((dialog = (SipDialog*) iterator()))
         {
-            dumpString.append('\n');
-        }
-        dialog->toString(oneDialogDump);
-        dumpString.append(oneDialogDump);
+            if(dialogCount)
+            {
+                dumpString.append('\n');
+            }
+            dialog->toString(oneDialogDump);
+            dumpString.append(oneDialogDump);
 
-        dialogCount++;
+            dialogCount++;
+        }
+        mpStripes[i].unlock();
     }
 
     return(dialogCount);
@@ -268,7 +335,8 @@ UtlBoolean SipDialogMgr::earlyDialogExists(const char* dialogHandle)
 {
     UtlBoolean foundDialog = FALSE;
     UtlString handle(dialogHandle ? dialogHandle : "");
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Looking for an dialog that matches this handle, if there
     // is not an exact match see if there is an early dialog
     // that matches the given presumably established dialog handle
@@ -282,7 +350,7 @@ UtlBoolean SipDialogMgr::earlyDialogExists(const char* dialogHandle)
         foundDialog = TRUE;
     }
 
-    unlock();
+    stripe.unlock();
 
     return(foundDialog);
 }
@@ -295,7 +363,8 @@ UtlBoolean SipDialogMgr::earlyDialogExistsFor(const char* establishedDialogHandl
     // If we have an established dialog handle
     if(!SipDialog::isEarlyDialog(handle))
     {
-        lock();
+        SipDialogStripe& stripe = getStripeFor(handle);
+        stripe.lock();
         // Looking for an dialog that matches this handle, if there
         // is not an exact match see if there is an early dialog
         // that matches the given presumably established dialog handle
@@ -307,7 +376,7 @@ UtlBoolean SipDialogMgr::earlyDialogExistsFor(const char* establishedDialogHandl
         {
             foundDialog = TRUE;
         }
-        unlock();
+        stripe.unlock();
     }
 
     return(foundDialog);
@@ -317,7 +386,8 @@ UtlBoolean SipDialogMgr::dialogExists(const char* dialogHandle)
 {
     UtlBoolean foundDialog = FALSE;
     UtlString handle(dialogHandle ? dialogHandle : "");
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Looking for an dialog that exactly matches this handle
     SipDialog* dialog = findDialog(handle,
                                    FALSE, // if established, match early dialog
@@ -328,7 +398,7 @@ UtlBoolean SipDialogMgr::dialogExists(const char* dialogHandle)
         foundDialog = TRUE;
     }
 
-    unlock();
+    stripe.unlock();
 
     return(foundDialog);
 }
@@ -349,7 +419,8 @@ UtlBoolean SipDialogMgr::isLastLocalTransaction(const SipMessage& message,
     UtlString toTag;
     SipDialog::parseHandle(handle, callId, fromTag, toTag);
 
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Looking for any dialog that matches this handle
     SipDialog* dialog = findDialog(handle,
                                    TRUE, // if established, match early dialog
@@ -362,7 +433,7 @@ UtlBoolean SipDialogMgr::isLastLocalTransaction(const SipMessage& message,
         matchesTransaction = TRUE;
     }
 
-    unlock();
+    stripe.unlock();
     
     return(matchesTransaction);
 }
@@ -378,7 +449,8 @@ UtlBoolean SipDialogMgr::isNewRemoteTransaction(const SipMessage& message)
     UtlString toTag;
     SipDialog::parseHandle(handle, callId, fromTag, toTag);
 
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Looking for any dialog that matches this handle
     SipDialog* dialog = findDialog(handle,
                                    TRUE, // if established, match early dialog
@@ -391,7 +463,7 @@ UtlBoolean SipDialogMgr::isNewRemoteTransaction(const SipMessage& message)
         matchesTransaction = TRUE;
     }
 
-    unlock();
+    stripe.unlock();
     
     return(matchesTransaction);
 }
@@ -421,7 +493,7 @@ SipDialog* SipDialogMgr::findDialog(UtlString& callId,
                                   UtlBoolean ifHandleEarlyFindEstablishedDialog)
 {
     SipDialog* dialog = NULL;
-    UtlHashBagIterator iterator(mDialogs, &callId);
+    UtlHashBagIterator iterator(getStripe(callId).mDialogs, &callId);
 
     // Look at all the dialogs with the same call-id
     while((dialog = (SipDialog*) iterator()))
@@ -468,7 +540,8 @@ UtlBoolean SipDialogMgr::deleteDialog(const char* dialogHandle)
 {
     UtlBoolean dialogRemoved = FALSE;
     UtlString handle(dialogHandle ? dialogHandle : "");
-    lock();
+    SipDialogStripe& stripe = getStripeFor(handle);
+    stripe.lock();
     // Not sure if it should match all flavors of dialog, especially the
     // last one (i.e. ealy handle matching an established
     SipDialog* dialog = findDialog(handle,
@@ -478,24 +551,29 @@ UtlBoolean SipDialogMgr::deleteDialog(const char* dialogHandle)
     if(dialog)
     {
         dialogRemoved = TRUE;
-        mDialogs.removeReference(dialog);
+        getStripe(*dialog).mDialogs.removeReference(dialog);
         delete dialog;
         dialog = NULL;
     }
 
-    unlock();
+    stripe.unlock();
 
     return(dialogRemoved);
 }
 
-void SipDialogMgr::lock()
+SipDialogStripe& SipDialogMgr::getStripe(const UtlString& callId)
 {
-    mDialogMgrMutex.acquire();
+    return mpStripes[callId.hash() % NUM_STRIPES];
 }
 
-void SipDialogMgr::unlock()
+SipDialogStripe& SipDialogMgr::getStripeFor(const UtlString& dialogHandle)
 {
-    mDialogMgrMutex.release();
+    UtlString callId;
+    UtlString localTag;
+    UtlString remoteTag;
+    SipDialog::parseHandle(dialogHandle, callId, localTag, remoteTag);
+
+    return getStripe(callId);
 }
 
 /* ============================ FUNCTIONS ================================= */
@@ -197,6 +197,12 @@ void SipMessage::replaceShortFieldNames()
    UtlString longName;
    size_t position;
 
+   // Indexed headers get the long names when they are materialized
+   if (expandIndexedShortNames())
+   {
+      return;
+   }
+
    for ( position= 0;
          (nvPair = static_cast<NameValuePair*>(mNameValues.at(position)));
          position++
@@ -224,6 +230,7 @@ void SipMessage::replaceShortFieldNames()
 
 void SipMessage::replaceLongFieldNames()
 {
+   materializeHeaders();
    UtlDListIterator iterator(mNameValues);
    NameValuePair* nvPair;
    UtlString shortName;
@@ -2122,6 +2129,7 @@ void SipMessage::addVia(const char* domainName,
 void SipMessage::addViaField(const char* viaField, UtlBoolean afterOtherVias)
 {
     mHeaderCacheClean = FALSE;
+    materializeHeaders();
 
    NameValuePair* nv = new NameValuePair(SIP_VIA_FIELD, viaField);
     // Look for other via fields
@@ -3095,6 +3103,7 @@ UtlBoolean SipMessage::removeLastVia()
    NameValuePair viaHeaderField(SIP_VIA_FIELD);
 
    //remove whole line
+   materializeHeaders();
    NameValuePair* nv = (NameValuePair*) mNameValues.find(&viaHeaderField);
    if(nv)
    {
@@ -3718,6 +3727,7 @@ void SipMessage::addRecordRouteUri(const char* recordRouteUri)
         recordRouteUriString.data());
 
     mHeaderCacheClean = FALSE;
+   materializeHeaders();
    mNameValues.insertAt(0, headerField);
 }
 
@@ -4481,6 +4491,7 @@ void SipMessage::addDiversionField(const char* diversionField, UtlBoolean afterO
     if(NULL != diversionField)
     {
        mHeaderCacheClean = FALSE;
+       materializeHeaders();
 
        NameValuePair* nv = new NameValuePair(SIP_DIVERSION_FIELD, diversionField);
        // Look for other diversion fields
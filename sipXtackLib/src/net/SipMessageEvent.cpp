@@ -25,7 +25,8 @@
 
 // Constructor
 SipMessageEvent::SipMessageEvent(SipMessage* message, int status) :
-OsMsg(OsMsg::PHONE_APP, SipMessage::NET_SIP_MESSAGE)
+OsMsg(OsMsg::PHONE_APP, SipMessage::NET_SIP_MESSAGE),
+mpShareCount(NULL)
 {
    messageStatus = status;
    sipMessage = message;
@@ -34,24 +35,30 @@ OsMsg(OsMsg::PHONE_APP, SipMessage::NET_SIP_MESSAGE)
 // Destructor
 SipMessageEvent::~SipMessageEvent()
 {
-        if(sipMessage)
-        {
-                delete sipMessage;
-                sipMessage = NULL;
-        }
+        releaseMessage();
 }
 
 OsMsg* SipMessageEvent::createCopy() const
 {
-        // Ineffient but easy coding way to copy message
-        SipMessage* sipMsg = NULL;
+        SipMessageEvent* copy = new SipMessageEvent(NULL, messageStatus);
 
         if(sipMessage)
         {
-                sipMsg = new SipMessage(*sipMessage);
+                // Posting the event to several observers only bumps the
+                // count instead of copying the message for each of them.
+                // The count is only created by the thread owning this
+                // event, before any copy of it exists.
+                if(mpShareCount == NULL)
+                {
+                        mpShareCount = new OsAtomicInt(1);
+                }
+                (*mpShareCount)++;
+
+                copy->sipMessage = sipMessage;
+                copy->mpShareCount = mpShareCount;
         }
 
-        return(new SipMessageEvent(sipMsg, messageStatus));
+        return(copy);
 }
 /* ============================ MANIPULATORS ============================== */
 
@@ -64,11 +71,7 @@ SipMessageEvent::operator=(const SipMessageEvent& rhs)
 
    OsMsg::operator=(rhs);
         messageStatus = rhs.messageStatus;
-        if(sipMessage)
-        {
-                delete sipMessage;
-                sipMessage = NULL;
-        }
+        releaseMessage();
 
         if(rhs.sipMessage)
         {
@@ -78,6 +81,18 @@ SipMessageEvent::operator=(const SipMessageEvent& rhs)
    return *this;
 }
 
+SipMessage* SipMessageEvent::getWritableMessage()
+{
+        if(isMessageShared())
+        {
+                SipMessage* message = new SipMessage(*sipMessage);
+                releaseMessage();
+                sipMessage = message;
+        }
+
+        return(sipMessage);
+}
+
 /* ============================ ACCESSORS ================================= */
 
 const SipMessage* SipMessageEvent::getMessage()
@@ -97,8 +112,32 @@ int SipMessageEvent::getMessageStatus() const
 
 /* ============================ INQUIRY =================================== */
 
+UtlBoolean SipMessageEvent::isMessageShared() const
+{
+        return(mpShareCount != NULL &&
+               *mpShareCount > 1);
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
+void SipMessageEvent::releaseMessage()
+{
+        if(mpShareCount)
+        {
+                if(--(*mpShareCount) == 0)
+                {
+                        delete sipMessage;
+                        delete mpShareCount;
+                }
+                mpShareCount = NULL;
+        }
+        else if(sipMessage)
+        {
+                delete sipMessage;
+        }
+        sipMessage = NULL;
+}
+
 /* ============================ FUNCTIONS ================================= */
@@ -15,8 +15,12 @@
 
 // APPLICATION INCLUDES
 #include <net/SipProtocolServerBase.h>
+#include <net/SipStreamReactor.h>
 #include <net/SipUserAgent.h>
+#include <utl/UtlHashBagIterator.h>
 #include <utl/UtlHashMapIterator.h>
+#include <utl/UtlInt.h>
+#include <utl/UtlSListIterator.h>
 #include <os/OsDateTime.h>
 #include <os/OsEvent.h>
 #include <os/OsLock.h>
@@ -27,6 +31,27 @@
 //#define TEST_PRINT
 // STATIC VARIABLE INITIALIZATIONS
 
+// Book keeping for one client of a SipProtocolServerBase.  It hashes
+// and compares like a UtlVoidPtr to the client, so it can be found with
+// a UtlVoidPtr key.
+class SipClientEntry : public UtlVoidPtr
+{
+public:
+    SipClientEntry(SipClient* client) :
+        UtlVoidPtr(client),
+        mQueuedTime(-1)
+    {
+    }
+
+    SipClient* getClient() const
+    {
+        return (SipClient*) getValue();
+    }
+
+    long mQueuedTime;   // Key of the mIdleClients list holding it, or -1
+    UtlSList mKeys;     // Keys of mClientIndex which refer to this client (owned)
+};
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* ============================ CREATORS ================================== */
@@ -36,35 +61,76 @@ SipProtocolServerBase::SipProtocolServerBase(SipUserAgent* userAgent,
                                              const char* protocolString,
                                              const char* taskName) :
      OsTask(taskName),
-     mClientLock(OsMutex::Q_FIFO)
+     mClientLock(OsMutex::Q_FIFO),
+     mpReactor(NULL)
 {
    mSipUserAgent = userAgent;
    mProtocolString = protocolString;
    mDefaultPort = SIP_PORT;
+
+   // No client can have been used before the server was created
+   OsTime time;
+   OsDateTime::getCurTimeSinceBoot(time);
+   mIdleCheckedTime = time.seconds() - 1;
+
+#ifdef SIP_STREAM_REACTOR
+   // TLS clients keep their own task, see SipClient::isStream()
+   if (mProtocolString.compareTo(SIP_TRANSPORT_TCP, UtlString::ignoreCase) == 0)
+   {
+      mpReactor = new SipStreamReactor(this);
+   }
+#endif
 }
 
 // Copy constructor
 SipProtocolServerBase::SipProtocolServerBase(const SipProtocolServerBase& rSipProtocolServerBase) :
-    mClientLock(OsMutex::Q_FIFO)
+    mClientLock(OsMutex::Q_FIFO),
+    mpReactor(NULL)
 {
 }
 
 // Destructor
 SipProtocolServerBase::~SipProtocolServerBase()
 {
+#ifdef SIP_STREAM_REACTOR
+    // Stop reading before deleting the clients.  This is done before
+    // taking the locks, as a read in progress may need them.
+    delete mpReactor;
+    mpReactor = NULL;
+#endif
+
     mDataGuard.acquire();
     mClientLock.acquireWrite();
 
     waitUntilShutDown();
     
-    int iteratorHandle = mClientList.getIteratorHandle();
-    SipClient* client = NULL;
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
+    // The index keys are owned by the entries
+    mClientIndex.removeAll();
+
+    UtlHashBagIterator clientIterator(mClients);
+    SipClientEntry* entry;
+    while ((entry = (SipClientEntry*) clientIterator()))
+    {
+        delete entry->getClient();
+        entry->mKeys.destroyAll();
+    }
+    mClients.destroyAll();
+
+    UtlHashMapIterator idleIterator(mIdleClients);
+    while (idleIterator())
+    {
+        ((UtlSList*) idleIterator.value())->removeAll();
+    }
+    mIdleClients.destroyAll();
+    mClosedClients.destroyAll();
+
+    UtlVoidPtr* deleted;
+    while ((deleted = (UtlVoidPtr*) mDeletedClients.get()))
     {
-        mClientList.remove(iteratorHandle);
-        delete client;
+        delete (SipClient*) deleted->getValue();
+        delete deleted;
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
+
     mClientLock.releaseWrite();
     mDataGuard.release();
 }
@@ -110,13 +176,12 @@ UtlBoolean SipProtocolServerBase::send(SipMessage* message,
             }
             client->id(clientTaskId);
 
-            if (clientTaskId != callingTaskId)
+            // With the reactor, deleteClient() leaves the actual
+            // delete to removeOldClients(), so it is safe from any task.
+            if (mpReactor || clientTaskId != callingTaskId)
             {
-               // Do not need to clientLock.acquireWrite();
-               // as deleteClient uses the locking list lock
-               // which is all that is needed as the client is
-               // already marked as busy when we called
-               // createClient above.
+               // The client is already marked as busy when we
+               // called createClient above.
                deleteClient(client);
                client = NULL;
             }
@@ -221,7 +286,10 @@ SipClient* SipProtocolServerBase::createClient(const char* hostAddress,
                                                const char* localIp)
 {
     UtlString remoteHostAddr;
-    UtlBoolean clientStarted = FALSE;
+    UtlString key;
+
+    // Before the port gets defaulted, so it is the key getClient() uses
+    getClientKey(key, hostAddress, hostPort, localIp);
 
     mClientLock.acquireWrite();
 
@@ -291,21 +359,15 @@ SipClient* SipProtocolServerBase::createClient(const char* hostAddress,
                 client->setUserAgent(mSipUserAgent);
             }
 
+            indexClient(insertClient(client), key);
+
             if (clientSocket->getIpProtocol() != OsSocket::UDP)
             {
-                //osPrintf("starting client\n");
-                clientStarted = client->start();
-                if(!clientStarted)
-                {
-                    osPrintf("SIP %s client failed to start\n",
-                        mProtocolString.data());
-                }
+                startClient(client);
             }
 
             OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::createClient client: %p %s -> %s:%d",
                 mProtocolString.data(), client, localIp, hostAddress, hostPort);
-
-            mClientList.push(client);
         }
 
         // The socket failed to be connected
@@ -463,7 +525,6 @@ SipClient* SipProtocolServerBase::getClient(const char* hostAddress,
 {
     UtlBoolean isSameHost = FALSE;
     UtlString hostAddressString(hostAddress ? hostAddress : "");
-    int iteratorHandle = mClientList.getIteratorHandle();
     SipClient* client = NULL;
 
 #   if TEST_CLIENT_CREATION
@@ -472,27 +533,51 @@ SipClient* SipProtocolServerBase::getClient(const char* hostAddress,
                   hostAddress, hostPort);
 #   endif
 
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
+    UtlString key;
+    getClientKey(key, hostAddress, hostPort, localIp);
+    SipClientEntry* entry = (SipClientEntry*) mClientIndex.findValue(&key);
+    if (entry)
     {
-        // Are these the same host?
-
-        isSameHost = client->isConnectedTo(hostAddressString, hostPort);
-
-        if(isSameHost && client->isOk() &&
-           0 == strcmp(client->getLocalIp(), localIp))
+        // The addresses a client is known by can change, so check it
+        client = entry->getClient();
+        if (!(   client->isConnectedTo(hostAddressString, hostPort)
+              && client->isOk()
+              && 0 == strcmp(client->getLocalIp(), localIp)))
         {
-            break;
+            unindexKey(key);
+            client = NULL;
         }
-        else if(isSameHost)
+    }
+
+    if (!client)
+    {
+        // Not indexed yet, like the received address of a connection
+        // from the other side.  Look at all of them once.
+        UtlHashBagIterator iterator(mClients);
+        while ((entry = (SipClientEntry*) iterator()))
         {
-            if(!client->isOk())
+            client = entry->getClient();
+
+            // Are these the same host?
+            isSameHost = client->isConnectedTo(hostAddressString, hostPort);
+
+            if(isSameHost && client->isOk() &&
+               0 == strcmp(client->getLocalIp(), localIp))
             {
-                OsSysLog::add(FAC_SIP, PRI_DEBUG, "%s Client matches but is not OK",
-                    mProtocolString.data());
+                indexClient(entry, key);
+                break;
             }
+            else if(isSameHost)
+            {
+                if(!client->isOk())
+                {
+                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "%s Client matches but is not OK",
+                        mProtocolString.data());
+                }
+            }
+            client = NULL;
         }
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
 
 #   ifdef TEST_CLIENT_CREATION
     if (!client)
@@ -508,37 +593,56 @@ SipClient* SipProtocolServerBase::getClient(const char* hostAddress,
 
 void SipProtocolServerBase::deleteClient(SipClient* sipClient)
 {
-    // Find the client in the list of clients and shut it down
-    int iteratorHandle = mClientList.getIteratorHandle();
-    SipClient* client = NULL;
-
 #ifdef TEST_PRINT
 
     OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::deleteClient(%p)",
         mProtocolString.data(), sipClient);
 #endif
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
-    {
-        // Remove this bad client
-                // This used to be a little over zealous and delete any
-                // SipClient that was not ok.  It was not checking if
-                // the SipClient was busy or not so bad things could
-                // happen.  This is now on the conservative side and
-                // deleting only the thing it is supposed to.
-        if(client == sipClient)
+
+#ifdef SIP_STREAM_REACTOR
+    if (mpReactor)
+    {
+        // Nobody gets the client from now on.  A reactor thread may be
+        // reading from it, or this may even be called from its read, so
+        // removeOldClients() deletes it once that read is done.
+        mClientLock.acquireWrite();
+        SipClientEntry* entry = findEntry(sipClient);
+        if (entry)
         {
-#ifdef TEST_PRINT
-            UtlString clientNames;
-            client->getClientNames(clientNames);
-            OsSysLog::add(FAC_SIP, PRI_DEBUG, "Removing %s client %p names:\n%s",
-                mProtocolString.data(), this, clientNames.data());
-#endif
-            mClientList.remove(iteratorHandle);
+            removeEntry(entry);
+            mDeletedClients.append(new UtlVoidPtr(sipClient));
+        }
+        mClientLock.releaseWrite();
 
-            break;
+        if (entry)
+        {
+            mpReactor->closeClient(sipClient);
         }
+        return;
+    }
+#endif
+
+    // Find the client in the list of clients and shut it down
+    mClientLock.acquireWrite();
+    SipClientEntry* entry = findEntry(sipClient);
+    SipClient* client = NULL;
+    if (entry)
+    {
+        // This used to be a little over zealous and delete any
+        // SipClient that was not ok.  It was not checking if
+        // the SipClient was busy or not so bad things could
+        // happen.  This is now on the conservative side and
+        // deleting only the thing it is supposed to.
+        client = entry->getClient();
+#ifdef TEST_PRINT
+        UtlString clientNames;
+        client->getClientNames(clientNames);
+        OsSysLog::add(FAC_SIP, PRI_DEBUG, "Removing %s client %p names:\n%s",
+            mProtocolString.data(), this, clientNames.data());
+#endif
+        removeEntry(entry);
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
+    mClientLock.releaseWrite();
 
     // Delete the client outside the lock on the list as
     // it can create a deadlock.  If the client is doing
@@ -563,62 +667,159 @@ void SipProtocolServerBase::removeOldClients(long oldTime)
 {
     mClientLock.acquireWrite();
     // Find the old clients in the list  and shut them down
-    int iteratorHandle = mClientList.getIteratorHandle();
+    SipClientEntry* entry;
     SipClient* client;
-    int numClients = mClientList.getCount();
+    int numClients = mClients.entries();
+    int numDeleted = mDeletedClients.entries();
     int numDelete = 0;
     int numBusy = 0;
     SipClient** deleteClientArray = NULL;
 
 
     UtlString clientNames;
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
-    {
-        if(client->isInUseForWrite()) numBusy++;
-
-        // Remove any client with a bad socket
-        // With TCP clients let them stay around if they are still
-        // good as the may stay open for the session
-        // The clients opened from this side for sending requests
-        // get closed by the server (i.e. other side).  The clients
-        // opened as servers for requests from the remote side are
-        // explicitly closed on this side when the final response is
-        // sent.
-        if(   ! client->isInUseForWrite() // can't remove it if writing to it...
-           && (   ! client->isOk() // socket is bad
-               || client->getLastTouchedTime() < oldTime // idle for long enough
-               )
-           )
+    if (mpReactor)
+    {
+        // Clients already removed by deleteClient()
+        UtlVoidPtr* deleted;
+        while ((deleted = (UtlVoidPtr*) mDeletedClients.get()))
         {
-            client->getClientNames(clientNames);
+            if(!deleteClientArray) deleteClientArray =
+                new SipClient*[numClients + numDeleted];
+            deleteClientArray[numDelete] = (SipClient*) deleted->getValue();
+            numDelete++;
+            delete deleted;
+        }
+
+        // Clients whose socket failed
+        UtlSList busyClients;
+        UtlVoidPtr* closed;
+        while ((closed = (UtlVoidPtr*) mClosedClients.get()))
+        {
+            entry = findEntry((SipClient*) closed->getValue());
+            if (entry && entry->getClient()->isInUseForWrite())
+            {
+                // Try again next time
+                numBusy++;
+                busyClients.append(closed);
+                continue;
+            }
+            delete closed;
+
+            if (entry)
+            {
+                client = entry->getClient();
+                OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::Removing closed client %p",
+                              mProtocolString.data(), client);
+                removeEntry(entry);
+                if(!deleteClientArray) deleteClientArray =
+                    new SipClient*[numClients + numDeleted];
+                deleteClientArray[numDelete] = client;
+                numDelete++;
+            }
+        }
+        while ((closed = (UtlVoidPtr*) busyClients.get()))
+        {
+            mClosedClients.append(closed);
+        }
+
+        // Clients which have not been used since oldTime can only be in
+        // the lists for the times before it.  Clients which have been
+        // used since they were queued move to the list for that time.
+        for (long time = mIdleCheckedTime + 1; time < oldTime; time++)
+        {
+            UtlInt timeKey(time);
+            UtlSList* idleList = (UtlSList*) mIdleClients.findValue(&timeKey);
+            while (idleList && (entry = (SipClientEntry*) idleList->get()))
+            {
+                entry->mQueuedTime = -1;
+                client = entry->getClient();
+                if(   ! client->isInUseForWrite() // can't remove it if writing to it...
+                   && (   ! client->isOk() // socket is bad
+                       || client->getLastTouchedTime() < oldTime // idle for long enough
+                       )
+                   )
+                {
+                    client->getClientNames(clientNames);
+                    OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::Removing old client %p:\n%s\r",
+                                  mProtocolString.data(), client, clientNames.data());
+                    removeEntry(entry);
+                    if(!deleteClientArray) deleteClientArray =
+                        new SipClient*[numClients + numDeleted];
+                    deleteClientArray[numDelete] = client;
+                    numDelete++;
+                }
+                else
+                {
+                    if(client->isInUseForWrite()) numBusy++;
+                    queueIdleClient(entry, client->getLastTouchedTime() > oldTime
+                                           ? client->getLastTouchedTime()
+                                           : oldTime);
+                }
+            }
+            if (idleList)
+            {
+                mIdleClients.destroy(&timeKey);
+            }
+        }
+        if (oldTime - 1 > mIdleCheckedTime)
+        {
+            mIdleCheckedTime = oldTime - 1;
+        }
+    }
+    else
+    {
+        UtlHashBagIterator iterator(mClients);
+        while ((entry = (SipClientEntry*) iterator()))
+        {
+            client = entry->getClient();
+            if(client->isInUseForWrite()) numBusy++;
+
+            // Remove any client with a bad socket
+            // With TCP clients let them stay around if they are still
+            // good as the may stay open for the session
+            // The clients opened from this side for sending requests
+            // get closed by the server (i.e. other side).  The clients
+            // opened as servers for requests from the remote side are
+            // explicitly closed on this side when the final response is
+            // sent.
+            if(   ! client->isInUseForWrite() // can't remove it if writing to it...
+               && (   ! client->isOk() // socket is bad
+                   || client->getLastTouchedTime() < oldTime // idle for long enough
+                   )
+               )
+            {
+                client->getClientNames(clientNames);
 #ifdef TEST_PRINT
-            osPrintf("Removing %s client names:\n%s\r\n",
-                mProtocolString.data(), clientNames.data());
+                osPrintf("Removing %s client names:\n%s\r\n",
+                    mProtocolString.data(), clientNames.data());
 #endif
-            OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::Removing old client %p:\n%s\r",
-                          mProtocolString.data(), client, clientNames.data());
-
-            mClientList.remove(iteratorHandle);
-            // Delete the clients after releasing the lock
-            if(!deleteClientArray) deleteClientArray =
-                new SipClient*[numClients];
+                OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::Removing old client %p:\n%s\r",
+                              mProtocolString.data(), client, clientNames.data());
 
-            deleteClientArray[numDelete] = client;
-            numDelete++;
+                // Delete the clients after releasing the lock
+                if(!deleteClientArray) deleteClientArray =
+                    new SipClient*[numClients];
 
-            client = NULL;
+                deleteClientArray[numDelete] = client;
+                numDelete++;
+            }
+            else
+            {
+#               ifdef TEST_PRINT
+                UtlString names;
+                client->getClientNames(names);
+                OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::removeOldClients leaving client:\n%s",
+                    mProtocolString.data(), names.data());
+#               endif
+            }
         }
-        else
+
+        // Not while iterating over them
+        for(int clientIndex = 0; clientIndex < numDelete; clientIndex++)
         {
-#           ifdef TEST_PRINT
-            UtlString names;
-            client->getClientNames(names);
-            OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::removeOldClients leaving client:\n%s",
-                mProtocolString.data(), names.data());
-#           endif
+            removeEntry(findEntry(deleteClientArray[clientIndex]));
         }
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
     mClientLock.releaseWrite();
 
     if ( numDelete || numBusy ) // get rid of lots of 'doing nothing when nothing to do' messages in the log
@@ -631,6 +832,13 @@ void SipProtocolServerBase::removeOldClients(long oldTime)
     // after releasing the locks
     for(int clientIndex = 0; clientIndex < numDelete; clientIndex++)
     {
+#ifdef SIP_STREAM_REACTOR
+        if (mpReactor)
+        {
+            // Waits for a read in progress
+            mpReactor->removeClient(deleteClientArray[clientIndex]);
+        }
+#endif
         delete deleteClientArray[clientIndex];
     }
 
@@ -653,71 +861,82 @@ SipProtocolServerBase::operator=(const SipProtocolServerBase& rhs)
 
 void SipProtocolServerBase::startClients()
 {
-        int iteratorHandle = mClientList.getIteratorHandle();
-    SipClient* client = NULL;
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
+    mClientLock.acquireRead();
+    UtlHashBagIterator iterator(mClients);
+    SipClientEntry* entry;
+    while ((entry = (SipClientEntry*) iterator()))
     {
-        client->start();
+        // Clients read by the reactor have no task of their own
+        if (!mpReactor || !entry->getClient()->isStream())
+        {
+            entry->getClient()->start();
+        }
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
+    mClientLock.releaseRead();
 }
 
 void SipProtocolServerBase::shutdownClients()
 {
-        // For each client request shutdown
-    int iteratorHandle = mClientList.getIteratorHandle();
-    SipClient* client = NULL;
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
+    // For each client request shutdown
+    mClientLock.acquireRead();
+    UtlHashBagIterator iterator(mClients);
+    SipClientEntry* entry;
+    while ((entry = (SipClientEntry*) iterator()))
     {
-        client->requestShutdown();
+        entry->getClient()->requestShutdown();
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
+    mClientLock.releaseRead();
+}
+
+void SipProtocolServerBase::clientClosed(SipClient* client)
+{
+    UtlVoidPtr key(client);
+
+    mClientLock.acquireWrite();
+    if (findEntry(client) && !mClosedClients.find(&key))
+    {
+        mClosedClients.append(new UtlVoidPtr(client));
+    }
+    mClientLock.releaseWrite();
 }
 
 /* ============================ ACCESSORS ================================= */
 int SipProtocolServerBase::getClientCount()
 {
-    return(mClientList.getCount());
+    mClientLock.acquireRead();
+    int numClients = mClients.entries();
+    mClientLock.releaseRead();
+
+    return(numClients);
 }
 
 void SipProtocolServerBase::addClient(SipClient* client)
 {
     if(client)
     {
-        mClientList.push(client);
+        mClientLock.acquireWrite();
+        insertClient(client);
+        startClient(client);
+        mClientLock.releaseWrite();
     }
 }
 
 UtlBoolean SipProtocolServerBase::clientExists(SipClient* client)
 {
-    SipClient* listClient;
-    UtlBoolean found = FALSE;
-
-    int iteratorHandle = mClientList.getIteratorHandle();
-    while ((listClient = (SipClient*)mClientList.next(iteratorHandle)))
-    {
-        if(client == listClient)
-        {
-            found = TRUE;
-            break;
-        }
-    }
-
-    mClientList.releaseIteratorHandle(iteratorHandle);
-
-    return(found);
+    return(findEntry(client) != NULL);
 }
 
 void SipProtocolServerBase::printStatus()
 {
-    int numClients = mClientList.getCount();
-    int iteratorHandle = mClientList.getIteratorHandle();
+    mClientLock.acquireRead();
+    int numClients = mClients.entries();
 
     OsTime time;
     OsDateTime::getCurTimeSinceBoot(time);
     long currentTime = time.seconds();
 
     //long currentTime = OsDateTime::getSecsSinceEpoch();
+    SipClientEntry* entry;
     SipClient* client;
     UtlString clientNames;
     long clientTouchedTime;
@@ -726,9 +945,11 @@ void SipProtocolServerBase::printStatus()
     osPrintf("%s %d clients in list at: %ld\n",
         mProtocolString.data(), numClients, currentTime);
 
-    while ((client = (SipClient*)mClientList.next(iteratorHandle)))
+    UtlHashBagIterator iterator(mClients);
+    while ((entry = (SipClientEntry*) iterator()))
     {
         // Remove this or any other bad client
+        client = entry->getClient();
         clientTouchedTime = client->getLastTouchedTime();
         clientOk = client->isOk();
         client->getClientNames(clientNames);
@@ -737,7 +958,7 @@ void SipProtocolServerBase::printStatus()
             mProtocolString.data(), this, clientTouchedTime,
             clientOk, clientNames.data());
     }
-    mClientList.releaseIteratorHandle(iteratorHandle);
+    mClientLock.releaseRead();
 }
 
 /* ============================ INQUIRY =================================== */
@@ -757,11 +978,10 @@ int SipProtocolServerBase::dumpLayout(void *Ths)
       (((int) &(THIS->mSipUserAgent)) - ((int) THIS)));
    printf("  offset(mClientLock) = %d\n",
       (((int) &(THIS->mClientLock)) - ((int) THIS)));
-   printf("  offset(mClientList) = %d\n",
-      (((int) &(THIS->mClientList)) - ((int) THIS)));
+   printf("  offset(mClients) = %d\n",
+      (((int) &(THIS->mClients)) - ((int) THIS)));
    printf("  offset(endOfSipProtocolServerBase) = %d\n",
       (((int) &(THIS->endOfSipProtocolServerBase)) - ((int) THIS)));
-   OsLockingList::dumpLayout(Ths);
    return sizeof(*THIS);
 }
 #endif /* LOOKING_FOR_T220_COMPILER_BUG ] */
@@ -770,4 +990,128 @@ int SipProtocolServerBase::dumpLayout(void *Ths)
 
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
+void SipProtocolServerBase::startClient(SipClient* client)
+{
+#ifdef SIP_STREAM_REACTOR
+    if (mpReactor && mpReactor->addClient(client))
+    {
+        return;
+    }
+#endif
+
+    if(!client->start())
+    {
+        OsSysLog::add(FAC_SIP, PRI_ERR, "SIP %s Client failed to start",
+                      mProtocolString.data());
+    }
+}
+
+SipClientEntry* SipProtocolServerBase::insertClient(SipClient* client)
+{
+    SipClientEntry* entry = new SipClientEntry(client);
+    mClients.insert(entry);
+
+    // Only the reactor reports failed sockets, otherwise all clients
+    // are looked at by removeOldClients()
+    if (mpReactor)
+    {
+        queueIdleClient(entry, client->getLastTouchedTime());
+    }
+
+    return entry;
+}
+
+SipClientEntry* SipProtocolServerBase::findEntry(SipClient* client) const
+{
+    UtlVoidPtr key(client);
+    return (SipClientEntry*) mClients.find(&key);
+}
+
+void SipProtocolServerBase::removeEntry(SipClientEntry* entry)
+{
+    UtlString* key;
+    while ((key = (UtlString*) entry->mKeys.get()))
+    {
+        UtlContainable* value;
+        mClientIndex.removeKeyAndValue(key, value);
+        delete key;
+    }
+
+    if (entry->mQueuedTime >= 0)
+    {
+        UtlInt timeKey(entry->mQueuedTime);
+        UtlSList* idleList = (UtlSList*) mIdleClients.findValue(&timeKey);
+        if (idleList)
+        {
+            idleList->removeReference(entry);
+            if (idleList->isEmpty())
+            {
+                mIdleClients.destroy(&timeKey);
+            }
+        }
+    }
+
+    UtlVoidPtr clientKey(entry->getClient());
+    mClosedClients.destroy(&clientKey);
+
+    mClients.removeReference(entry);
+    delete entry;
+}
+
+void SipProtocolServerBase::indexClient(SipClientEntry* entry,
+                                        const UtlString& key)
+{
+    unindexKey(key);
+
+    UtlString* indexKey = new UtlString(key);
+    mClientIndex.insertKeyAndValue(indexKey, entry);
+    entry->mKeys.append(indexKey);
+}
+
+void SipProtocolServerBase::unindexKey(const UtlString& key)
+{
+    UtlContainable* value;
+    UtlContainable* indexKey = mClientIndex.removeKeyAndValue(&key, value);
+    if (indexKey)
+    {
+        ((SipClientEntry*) value)->mKeys.removeReference(indexKey);
+        delete indexKey;
+    }
+}
+
+void SipProtocolServerBase::queueIdleClient(SipClientEntry* entry, long time)
+{
+    // removeOldClients() is done with the lists up to mIdleCheckedTime
+    if (time <= mIdleCheckedTime)
+    {
+        time = mIdleCheckedTime + 1;
+    }
+
+    UtlInt timeKey(time);
+    UtlSList* idleList = (UtlSList*) mIdleClients.findValue(&timeKey);
+    if (!idleList)
+    {
+        idleList = new UtlSList();
+        mIdleClients.insertKeyAndValue(new UtlInt(time), idleList);
+    }
+    idleList->append(entry);
+    entry->mQueuedTime = time;
+}
+
+void SipProtocolServerBase::getClientKey(UtlString& key,
+                                         const char* hostAddress,
+                                         int hostPort,
+                                         const char* localIp)
+{
+    char portString[20];
+
+    // Same default port as SipClient::isConnectedTo()
+    sprintf(portString, ":%d/", portIsValid(hostPort) ? hostPort : SIP_PORT);
+
+    key = hostAddress ? hostAddress : "";
+    key.toLower();
+    key.append(portString);
+    key.append(localIp ? localIp : "");
+}
+
 /* ============================ FUNCTIONS ================================= */
@@ -62,6 +62,26 @@ private:
 
 };
 
+// Content of a group of keys and the lock which guards it
+class PublishContentStripe
+{
+public:
+    PublishContentStripe();
+
+    void lock();
+    void unlock();
+
+    UtlHashMap mContentEntries;
+    UtlHashMap mDefaultContentEntries;
+    OsMutex mMutex;
+};
+
+// Copy the first body of the container which is of an accepted type
+static UtlBoolean copyAcceptedContent(PublishContentContainer* container,
+                                      UtlBoolean acceptedTypesGiven,
+                                      UtlHashMap& contentTypes,
+                                      HttpBody*& content);
+
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
 // CONSTANTS
@@ -86,9 +106,26 @@ PublishContentContainer::~PublishContentContainer()
 {
 }
 
+PublishContentStripe::PublishContentStripe() :
+mMutex(OsMutex::Q_FIFO)
+{
+}
+
+void PublishContentStripe::lock()
+{
+    mMutex.acquire();
+}
+
+void PublishContentStripe::unlock()
+{
+    mMutex.release();
+}
+
 // Constructor
 SipPublishContentMgr::SipPublishContentMgr()
 : mPublishMgrMutex(OsMutex::Q_FIFO)
+, mDefaultConstructorMutex(OsMutex::Q_FIFO)
+, mpStripes(new PublishContentStripe[NUM_STRIPES])
 {
 }
 
@@ -96,6 +133,8 @@ SipPublishContentMgr::SipPublishContentMgr()
 // Copy constructor NOT IMPLEMENTED
 SipPublishContentMgr::SipPublishContentMgr(const SipPublishContentMgr& rSipPublishContentMgr)
 : mPublishMgrMutex(OsMutex::Q_FIFO)
+, mDefaultConstructorMutex(OsMutex::Q_FIFO)
+, mpStripes(new PublishContentStripe[NUM_STRIPES])
 {
 }
 
@@ -104,8 +143,12 @@ SipPublishContentMgr::SipPublishContentMgr(const SipPublishContentMgr& rSipPubli
 SipPublishContentMgr::~SipPublishContentMgr()
 {
    // Delete the stored information.
-   mContentEntries.destroyAll();
-   mDefaultContentEntries.destroyAll();
+   for (int i = 0; i < NUM_STRIPES; i++)
+   {
+      mpStripes[i].mContentEntries.destroyAll();
+      mpStripes[i].mDefaultContentEntries.destroyAll();
+   }
+   delete[] mpStripes;
    mDefaultContentConstructors.destroyAll();
    mEventContentCallbacks.destroyAll();
 }
@@ -151,13 +194,14 @@ void SipPublishContentMgr::publish(const char* resourceId,
         key.append(eventTypeKey);
     }
 
-    lock();
+    PublishContentStripe& stripe = getStripe(key);
+    stripe.lock();
 
     // Look up the key in the specific or default entries, as appropriate.
     PublishContentContainer* container =
        static_cast <PublishContentContainer*> ((resourceIdProvided ?
-                                                 mContentEntries :
-                                                 mDefaultContentEntries).find(&key));
+                                                 stripe.mContentEntries :
+                                                 stripe.mDefaultContentEntries).find(&key));
 
     // If not found, create a container.
     if(container == NULL)
@@ -166,8 +210,8 @@ void SipPublishContentMgr::publish(const char* resourceId,
         *((UtlString*) container) = key;
 	// Save the container in the appropriate hash.
         (resourceIdProvided ?
-	 mContentEntries :
-	 mDefaultContentEntries).insert(container);
+	 stripe.mContentEntries :
+	 stripe.mDefaultContentEntries).insert(container);
     }
 
     // The content for this event type already existed
@@ -192,25 +236,15 @@ void SipPublishContentMgr::publish(const char* resourceId,
         container->mEventContent.append(eventContent[index]);
         }
 
-    // Don't call the observers if noNotify is set.
+    stripe.unlock();
+
+    // Don't call the observers if noNotify is set.  They are called without
+    // the stripe locked, as they may look up content themselves.
     if (!noNotify)
     {
-       // Call the observer for the content change, if any.
-       UtlString eventTypeString(eventType);
-       PublishCallbackContainer* callbackContainer =
-          static_cast <PublishCallbackContainer*>
-          (mEventContentCallbacks.find(&eventTypeString));
-       if(callbackContainer && callbackContainer->mpCallback)
-        {
-          (callbackContainer->mpCallback)(callbackContainer->mpApplicationData,
-                                          resourceId,
-                                          eventTypeKey,
-                                          eventTypeString,
-                                          !resourceIdProvided);
-        }
+       notifyContentChange(resourceId, eventTypeKey, eventType,
+                           !resourceIdProvided);
     }
-
-    unlock();
     }
 
 void SipPublishContentMgr::publishDefault(const char* eventTypeKey,
@@ -241,33 +275,20 @@ void SipPublishContentMgr::publishDefault(const char* eventTypeKey,
        key.append(eventTypeKey);
             }
 
-    lock();
-
     // Add the default constructor.
     if (defaultConstructor)
                 {
+       mDefaultConstructorMutex.acquire();
        // Remove any old value first.
        mDefaultContentConstructors.destroy(&key);
        UtlString* key_heap = new UtlString(key);
        mDefaultContentConstructors.insertKeyAndValue(key_heap,
                                                      defaultConstructor);
+       mDefaultConstructorMutex.release();
                 }
 
     // Call the observer for the content change, if any.
-    UtlString eventTypeString(eventType);
-    PublishCallbackContainer* callbackContainer =
-       static_cast <PublishCallbackContainer*>
-       (mEventContentCallbacks.find(&eventTypeString));
-    if(callbackContainer && callbackContainer->mpCallback)
-                {
-        (callbackContainer->mpCallback)(callbackContainer->mpApplicationData,
-                                        NULL,
-                                        eventTypeKey,
-                                        eventTypeString,
-                                        TRUE);
-                }
-
-    unlock();
+    notifyContentChange(NULL, eventTypeKey, eventType, TRUE);
             }
 
 void SipPublishContentMgr::unpublish(const char* resourceId,
@@ -291,44 +312,37 @@ void SipPublishContentMgr::unpublish(const char* resourceId,
        key.append(eventTypeKey);
     }
 
-    lock();
+    // Remove any default constructor.
+    if (!resourceIdProvided)
+    {
+       mDefaultConstructorMutex.acquire();
+       mDefaultContentConstructors.destroy(&key);
+       mDefaultConstructorMutex.release();
+    }
+
+    PublishContentStripe& stripe = getStripe(key);
+    stripe.lock();
 
     // Look up the key in the specific or default entries, as appropriate.
     PublishContentContainer* container =
             static_cast <PublishContentContainer*> ((resourceIdProvided ?
-                                                      mContentEntries :
-                                                      mDefaultContentEntries).find(&key));
+                                                      stripe.mContentEntries :
+                                                      stripe.mDefaultContentEntries).find(&key));
 
     // If a container was found, delete it and its contents.
     if (container)
         {
 	container->mEventContent.destroyAll();
         (resourceIdProvided ?
-         mContentEntries :
-         mDefaultContentEntries).destroy(container);
+         stripe.mContentEntries :
+         stripe.mDefaultContentEntries).destroy(container);
         }
 
-    // Remove any default constructor.
-    if (!resourceIdProvided)
-    {
-       mDefaultContentConstructors.destroy(&key);
-    }
+    stripe.unlock();
 
     // Call the observer for the content change, if any.
-        UtlString eventTypeString(eventType);
-    PublishCallbackContainer* callbackContainer =
-       static_cast <PublishCallbackContainer*>
-       (mEventContentCallbacks.find(&eventTypeString));
-        if(callbackContainer && callbackContainer->mpCallback)
-        {
-            (callbackContainer->mpCallback)(callbackContainer->mpApplicationData,
-                                          resourceId,
-                                          eventTypeKey,
-                                          eventTypeString,
-                                          !resourceIdProvided);
-        }
-
-    unlock();
+    notifyContentChange(resourceId, eventTypeKey, eventType,
+                        !resourceIdProvided);
 }
 
 void SipPublishContentMgr::unpublishDefault(const char* eventTypeKey,
@@ -427,6 +441,16 @@ UtlBoolean SipPublishContentMgr::removeContentChangeObserver(const char* eventTy
 
     unlock();
 
+    // Callbacks which are still running hold the lock of their stripe
+    if (callbackRemoved)
+    {
+        for (int i = 0; i < NUM_STRIPES; i++)
+        {
+            mpStripes[i].lock();
+            mpStripes[i].unlock();
+        }
+    }
+
     return(callbackRemoved);
 }
 
@@ -455,10 +479,17 @@ UtlBoolean SipPublishContentMgr::getContent(const char* resourceId,
 
     UtlBoolean acceptedTypesGiven = buildContentTypesContainer(acceptHeaderValue, contentTypes);
 
-    lock();
     // See if resource specific content exists
+    PublishContentStripe& stripe = getStripe(key);
+    stripe.lock();
     container = 
-        static_cast <PublishContentContainer*> (mContentEntries.find(&key));
+        static_cast <PublishContentContainer*> (stripe.mContentEntries.find(&key));
+    if(container)
+    {
+        foundContent = copyAcceptedContent(container, acceptedTypesGiven,
+                                           contentTypes, content);
+    }
+    stripe.unlock();
 
     // There is no resource specific content.  Check if the default
     // constructor exists.
@@ -468,7 +499,7 @@ UtlBoolean SipPublishContentMgr::getContent(const char* resourceId,
        UtlString default_key(eventTypeKey);
 
        // Look up the constructor.
-
+       mDefaultConstructorMutex.acquire();
        SipPublishContentMgrDefaultConstructor* constructor =
           static_cast <SipPublishContentMgrDefaultConstructor*>
           (mDefaultContentConstructors.findValue(&default_key));
@@ -478,54 +509,41 @@ UtlBoolean SipPublishContentMgr::getContent(const char* resourceId,
           constructor->generateDefaultContent(this, resourceId,
                                               eventTypeKey, eventType);
        }
+       mDefaultConstructorMutex.release();
 
        // See if resource specific content exists now.
+       stripe.lock();
         container = 
-          static_cast <PublishContentContainer*> (mContentEntries.find(&key));
+          static_cast <PublishContentContainer*> (stripe.mContentEntries.find(&key));
 
        // If content was found, still mark it as default content.
         if(container)
         {
             isDefaultContent = TRUE;
+            foundContent = copyAcceptedContent(container, acceptedTypesGiven,
+                                               contentTypes, content);
         }
+       stripe.unlock();
+
        // If still no content was found, check if the default exists.
-       else
+       if(container == NULL)
        {
+           PublishContentStripe& defaultStripe = getStripe(default_key);
+           defaultStripe.lock();
            container = 
               static_cast <PublishContentContainer*>
-              (mDefaultContentEntries.find(&default_key));
+              (defaultStripe.mDefaultContentEntries.find(&default_key));
            if(container)
            {
                isDefaultContent = TRUE;
+               foundContent = copyAcceptedContent(container, acceptedTypesGiven,
+                                                  contentTypes, content);
            }
+           defaultStripe.unlock();
        }
     }
 
-    if(container)
-    {
-        HttpBody* bodyPtr = NULL;
-        UtlSListIterator contentIterator(container->mEventContent);
-        while((bodyPtr = (HttpBody*)contentIterator()))
-        {
-            // No MIME types specified, take the first one
-            if(!acceptedTypesGiven)
-            {
-                content = HttpBody::copyBody(*bodyPtr);
-                foundContent = TRUE;
-                break;
-            }
-
-            // Find the first match.  The container has the bodies
-            // in the server's preferred order.
-            if(contentTypes.find(bodyPtr))
-            {
-                content = HttpBody::copyBody(*bodyPtr);
-                foundContent = TRUE;
-                break;
-            }
-        }
-    }
-    else
+    if(container == NULL)
     {
          OsSysLog::add(FAC_SIP, PRI_WARNING,
                      "SipPublishContentMgr::getContent no container is found for acceptHeaderValue '%s', resourceId '%s', eventTypeKey ='%s', eventType '%s'",
@@ -534,8 +552,6 @@ UtlBoolean SipPublishContentMgr::getContent(const char* resourceId,
                      eventTypeKey, eventType);
     }
 
-    unlock();
-
     contentTypes.destroyAll();
     return(foundContent);
 }
@@ -546,10 +562,21 @@ void SipPublishContentMgr::getStats(int& numDefaultContent,
                                     int& numResourceSpecificContent,
                                     int& numCallbacksRegistered)
 {
-    lock();
-    numDefaultContent = mDefaultContentEntries.entries();
+    numDefaultContent = 0;
+    numResourceSpecificContent = 0;
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+       mpStripes[i].lock();
+       numDefaultContent += mpStripes[i].mDefaultContentEntries.entries();
+       numResourceSpecificContent += mpStripes[i].mContentEntries.entries();
+       mpStripes[i].unlock();
+    }
+
+    mDefaultConstructorMutex.acquire();
     numDefaultConstructor = mDefaultContentConstructors.entries();
-    numResourceSpecificContent = mContentEntries.entries();
+    mDefaultConstructorMutex.release();
+
+    lock();
     numCallbacksRegistered = mEventContentCallbacks.entries();
     unlock();
 }
@@ -578,13 +605,14 @@ UtlBoolean SipPublishContentMgr::getPublished(const char* resourceId,
        key.append(eventTypeKey);
     }
 
-    lock();
+    PublishContentStripe& stripe = getStripe(key);
+    stripe.lock();
 
     // Look up the key in the specific or default entries, as appropriate.
     PublishContentContainer* container =
        static_cast <PublishContentContainer*> ((resourceIdProvided ?
-                                                 mContentEntries :
-                                                 mDefaultContentEntries).find(&key));
+                                                 stripe.mContentEntries :
+                                                 stripe.mDefaultContentEntries).find(&key));
 
     // If not found, return zero versions.
     if (container == NULL)
@@ -612,9 +640,12 @@ UtlBoolean SipPublishContentMgr::getPublished(const char* resourceId,
         }
     }
 
+    stripe.unlock();
+
     // Return the default constructor, if any.
     if (pDefaultConstructor)
     {
+       mDefaultConstructorMutex.acquire();
        UtlContainable* defaultConstructor =
           mDefaultContentConstructors.findValue(&key);
        *pDefaultConstructor =
@@ -625,10 +656,9 @@ UtlBoolean SipPublishContentMgr::getPublished(const char* resourceId,
            (defaultConstructor))->copy() :
           // Otherwise, return NULL.
           NULL;
+       mDefaultConstructorMutex.release();
     }
 
-    unlock();
-
     return contentReturned;
 }
 
@@ -636,24 +666,30 @@ int SipPublishContentMgr::dumpContents(UtlString& dumpString)
 {
     int contentCount = 0;
     dumpString="";
-    dumpString.appendFormat("Elements: %d\n", (int)mContentEntries.entries());
-    lock();
+    UtlString contents;
     UtlString* key = NULL;
     PublishContentContainer* contentPtr = NULL;
-    UtlHashMapIterator iterator(mContentEntries);
-    while((key = (UtlString*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        contentCount++;
-        contentPtr = (PublishContentContainer*) mContentEntries.findValue(key);
-        dumpString.append(*key);
-        dumpString.append("=");
-        if(contentPtr)
+        mpStripes[i].lock();
+        UtlHashMapIterator iterator(mpStripes[i].mContentEntries);
+        while((key = (UtlString*) iterator()))
         {
-            dumpString.append(*contentPtr);
+            contentCount++;
+            contentPtr = (PublishContentContainer*)
+                mpStripes[i].mContentEntries.findValue(key);
+            contents.append(*key);
+            contents.append("=");
+            if(contentPtr)
+            {
+                contents.append(*contentPtr);
+            }
+            contents.append('\n');
         }
-        dumpString.append('\n');
+        mpStripes[i].unlock();
     }
-    unlock();
+    dumpString.appendFormat("Elements: %d\n", contentCount);
+    dumpString.append(contents);
 
     return(contentCount);
 }
@@ -685,6 +721,41 @@ SipPublishContentMgr::buildContentTypesContainer(const char* acceptHeaderValue,
     return(containsMimetypes);
 }
 
+PublishContentStripe& SipPublishContentMgr::getStripe(const UtlString& key)
+{
+    return mpStripes[key.hash() % NUM_STRIPES];
+}
+
+void SipPublishContentMgr::notifyContentChange(const char* resourceId,
+                                               const char* eventTypeKey,
+                                               const char* eventType,
+                                               UtlBoolean isDefaultContent)
+{
+    UtlString eventTypeString(eventType);
+    void* applicationData = NULL;
+    SipPublisherContentChangeCallback callback = NULL;
+
+    lock();
+    PublishCallbackContainer* callbackContainer =
+       static_cast <PublishCallbackContainer*>
+       (mEventContentCallbacks.find(&eventTypeString));
+    if(callbackContainer)
+    {
+        applicationData = callbackContainer->mpApplicationData;
+        callback = callbackContainer->mpCallback;
+    }
+    unlock();
+
+    if(callback)
+    {
+        (callback)(applicationData,
+                   resourceId,
+                   eventTypeKey,
+                   eventTypeString,
+                   isDefaultContent);
+    }
+}
+
 void SipPublishContentMgr::lock()
 {
     mPublishMgrMutex.acquire();
@@ -696,3 +767,31 @@ void SipPublishContentMgr::unlock()
 }
 
 /* ============================ FUNCTIONS ================================= */
+
+static UtlBoolean copyAcceptedContent(PublishContentContainer* container,
+                                      UtlBoolean acceptedTypesGiven,
+                                      UtlHashMap& contentTypes,
+                                      HttpBody*& content)
+{
+    HttpBody* bodyPtr = NULL;
+    UtlSListIterator contentIterator(container->mEventContent);
+    while((bodyPtr = (HttpBody*)contentIterator()))
+    {
+        // No MIME types specified, take the first one
+        if(!acceptedTypesGiven)
+        {
+            content = HttpBody::copyBody(*bodyPtr);
+            return(TRUE);
+        }
+
+        // Find the first match.  The container has the bodies
+        // in the server's preferred order.
+        if(contentTypes.find(bodyPtr))
+        {
+            content = HttpBody::copyBody(*bodyPtr);
+            return(TRUE);
+        }
+    }
+
+    return(FALSE);
+}
@@ -1670,8 +1670,14 @@ SipRefreshMgr::queueMessageToObservers(
             OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
             void* observerData = observerCriteria->getObserverData();
 
-            // Cheat a little and set the observer data to be passed back
-            ((SipMessage*) message)->setResponseListenerData(observerData);
+            // Set the observer data to be passed back.  Observers get
+            // copies of the event which share the message, so it only
+            // gets copied when the data differs from the last observer's.
+            if (message->getResponseListenerData() != observerData)
+            {
+                event.getWritableMessage()->setResponseListenerData(observerData);
+                message = event.getMessage();
+            }
 
             // Put the message in the observers queue
             observerQueue->send(event);
@@ -1684,8 +1690,14 @@ SipRefreshMgr::queueMessageToObservers(
             OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
             void* observerData = observerCriteria->getObserverData();
 
-            // Cheat a little and set the observer data to be passed back
-            ((SipMessage*) message)->setResponseListenerData(observerData);
+            // Set the observer data to be passed back.  Observers get
+            // copies of the event which share the message, so it only
+            // gets copied when the data differs from the last observer's.
+            if (message->getResponseListenerData() != observerData)
+            {
+                event.getWritableMessage()->setResponseListenerData(observerData);
+                message = event.getMessage();
+            }
 
             // Put the message in the observers queue
             observerQueue->send(event);
@@ -71,6 +71,10 @@ extern struct __res_state _sip_res;
 #include <os/OsDefs.h>
 #include <os/OsSocket.h>
 #include <os/OsLock.h>
+#include <os/OsDateTime.h>
+#include <utl/UtlHashBag.h>
+#include <utl/UtlHashBagIterator.h>
+#include <utl/UtlSList.h>
 #include <net/SipSrvLookup.h>
 
 #include <os/OsSysLog.h>
@@ -82,6 +86,54 @@ extern struct __res_state _sip_res;
 // The initial value of OptionCodeCNAMELImit.
 #define DEFAULT_CNAME_LIMIT 5
 
+// The initial values of OptionCodeCacheMaxTTL and OptionCodeCacheNegativeTTL.
+#define DEFAULT_CACHE_MAX_TTL 3600
+#define DEFAULT_CACHE_NEGATIVE_TTL 30
+
+// Number of cached answers above which expired ones are purged.
+#define CACHE_PURGE_SIZE 1000
+
+// glibc keeps the resolver state per thread, so a lookup need not hold
+// SipSrvLookup::sMutex while it waits for the DNS server.
+#if defined(__GLIBC__)
+#  define SIP_SRV_THREAD_SAFE_RESOLVER
+#endif
+
+/**
+ * Cached answer to one DNS query.  The string value is the key,
+ * "<RR type>/<lower case domain name>".
+ */
+class SipSrvCacheEntry : public UtlString
+{
+public:
+   SipSrvCacheEntry(const UtlString& key)
+      : UtlString(key)
+      , mQueryMutex(OsMutex::Q_FIFO)
+      , mpAnswer(NULL)
+      , mAnswerLength(-1)
+      , mExpires(0)
+      , mPending(FALSE)
+      , mWaiters(0)
+   {
+   }
+
+   virtual ~SipSrvCacheEntry()
+   {
+      delete[] mpAnswer;
+   }
+
+   OsMutex mQueryMutex;       ///< Held by the thread querying the DNS server.
+   unsigned char* mpAnswer;   ///< Answer as returned by res_query.
+   int mAnswerLength;         ///< Length of mpAnswer, -1 if the query failed.
+   long mExpires;             ///< Seconds since boot when the answer expires.
+   UtlBoolean mPending;       ///< Is a thread querying the DNS server?
+   int mWaiters;              ///< Number of threads waiting for that query.
+
+private:
+   SipSrvCacheEntry(const SipSrvCacheEntry&);
+   SipSrvCacheEntry& operator=(const SipSrvCacheEntry&);
+};
+
 // Forward references
 
 // All of these functions are made forward references here rather than
@@ -220,6 +272,16 @@ static int server_compare(const void* a, const void* b);
 
 static void sort_answers(res_response* response);
 
+/// Get the number of seconds the records in a DNS answer may be cached.
+static int answer_ttl(unsigned char* answer);
+/**<
+ * @returns smallest TTL of the answer and additional RRs, or -1 if
+ * there are none.
+ */
+
+/// Get the current time in seconds for the DNS cache.
+static long cache_now();
+
 static int rr_compare(const void* a, const void* b);
 
 /**
@@ -236,6 +298,8 @@ int SipSrvLookup::options[OptionCodeLast+1] = {
    0,                           // OptionCodePrintAnswers
    DEFAULT_CNAME_LIMIT,         // OptionCodeCNAMELimit
    0,                           // OptionCodeNoDefaultTCP
+   DEFAULT_CACHE_MAX_TTL,       // OptionCodeCacheMaxTTL
+   DEFAULT_CACHE_NEGATIVE_TTL,  // OptionCodeCacheNegativeTTL
    0                            // OptionCodeLast
 };
 
@@ -267,8 +331,10 @@ server_t* SipSrvLookup::servers(const char* domain,
    // Initialize the list of servers.
    server_list_initialize(list, list_length_allocated, list_length_used);
 
+#ifndef SIP_SRV_THREAD_SAFE_RESOLVER
    // Seize the lock.
    OsLock lock(sMutex);
+#endif
 
    // Case 0: Eliminate contradictory combinations of service and type.
    
@@ -459,6 +525,172 @@ void  SipSrvLookup::getDnsSrvTimeouts(int& initialTimeoutInSecs, int& retries)
 #endif
 }
 
+// Perform a DNS query, using the cache of earlier answers.
+int SipSrvLookup::res_query_cached(const char* name,
+                                   int type,
+                                   unsigned char* answer,
+                                   int anslen)
+{
+   int max_ttl = options[OptionCodeCacheMaxTTL];
+   if (max_ttl <= 0)
+   {
+      return res_query(name, C_IN, type, answer, anslen);
+   }
+
+   char type_string[20];
+   sprintf(type_string, "%d/", type);
+   UtlString key(type_string);
+   key.append(name);
+   key.toLower();
+
+   int length;
+
+   sCacheMutex.acquire();
+
+   if (spCache == NULL)
+   {
+      spCache = new UtlHashBag();
+   }
+   SipSrvCacheEntry* entry = (SipSrvCacheEntry*) spCache->find(&key);
+   if (entry != NULL && entry->mPending)
+   {
+      sCacheCoalesced++;
+      // Wait for the thread querying the same name.  An entry is not
+      // deleted while it has waiters.
+      entry->mWaiters++;
+      while (entry->mPending)
+      {
+         sCacheMutex.release();
+         entry->mQueryMutex.acquire();
+         entry->mQueryMutex.release();
+         sCacheMutex.acquire();
+      }
+      entry->mWaiters--;
+   }
+
+   if (entry != NULL && cache_now() < entry->mExpires)
+   {
+      sCacheHits++;
+      length = entry->mAnswerLength;
+      if (length > 0)
+      {
+         memcpy(answer, entry->mpAnswer, length);
+      }
+      sCacheMutex.release();
+      return length;
+   }
+
+   sCacheMisses++;
+   if (entry == NULL)
+   {
+      if (spCache->entries() >= CACHE_PURGE_SIZE)
+      {
+         // Drop the answers which have expired.
+         long now = cache_now();
+         UtlSList expired;
+         UtlHashBagIterator iterator(*spCache);
+         SipSrvCacheEntry* old;
+         while ((old = (SipSrvCacheEntry*) iterator()))
+         {
+            if (!old->mPending && old->mWaiters == 0 && old->mExpires <= now)
+            {
+               expired.append(old);
+            }
+         }
+         while ((old = (SipSrvCacheEntry*) expired.get()))
+         {
+            spCache->removeReference(old);
+            delete old;
+         }
+      }
+      entry = new SipSrvCacheEntry(key);
+      spCache->insert(entry);
+   }
+   entry->mPending = TRUE;
+   entry->mQueryMutex.acquire();
+   sCacheMutex.release();
+
+   length = res_query(name, C_IN, type, answer, anslen);
+   if (length > anslen)
+   {
+      // The answer was truncated to the buffer.
+      length = anslen;
+   }
+   int ttl = length > 0 ? answer_ttl(answer) : -1;
+   if (ttl < 0)
+   {
+      ttl = options[OptionCodeCacheNegativeTTL];
+   }
+   if (ttl > max_ttl)
+   {
+      ttl = max_ttl;
+   }
+
+   sCacheMutex.acquire();
+   delete[] entry->mpAnswer;
+   entry->mpAnswer = NULL;
+   entry->mAnswerLength = length;
+   if (length > 0)
+   {
+      entry->mpAnswer = new unsigned char[length];
+      memcpy(entry->mpAnswer, answer, length);
+   }
+   entry->mExpires = cache_now() + ttl;
+   entry->mPending = FALSE;
+   entry->mQueryMutex.release();
+   sCacheMutex.release();
+
+   return length;
+}
+
+int SipSrvLookup::getCacheHits()
+{
+   OsLock lock(sCacheMutex);
+   return sCacheHits;
+}
+
+int SipSrvLookup::getCacheMisses()
+{
+   OsLock lock(sCacheMutex);
+   return sCacheMisses;
+}
+
+int SipSrvLookup::getCacheCoalesced()
+{
+   OsLock lock(sCacheMutex);
+   return sCacheCoalesced;
+}
+
+void SipSrvLookup::clearCache()
+{
+   OsLock lock(sCacheMutex);
+
+   sCacheHits = 0;
+   sCacheMisses = 0;
+   sCacheCoalesced = 0;
+
+   if (spCache == NULL)
+   {
+      return;
+   }
+
+   UtlSList idle;
+   UtlHashBagIterator iterator(*spCache);
+   SipSrvCacheEntry* entry;
+   while ((entry = (SipSrvCacheEntry*) iterator()))
+   {
+      if (!entry->mPending && entry->mWaiters == 0)
+      {
+         idle.append(entry);
+      }
+   }
+   while ((entry = (SipSrvCacheEntry*) idle.get()))
+   {
+      spCache->removeReference(entry);
+      delete entry;
+   }
+}
+
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 /*
@@ -469,6 +701,14 @@ OsMutex SipSrvLookup::sMutex(OsMutex::Q_PRIORITY |
                              OsMutex::DELETE_SAFE |
                              OsMutex::INVERSION_SAFE);
 
+OsMutex SipSrvLookup::sCacheMutex(OsMutex::Q_FIFO);
+// Created on first use and never deleted, so it does not depend on the
+// order in which static objects are destroyed.
+UtlHashBag* SipSrvLookup::spCache = NULL;
+int SipSrvLookup::sCacheHits = 0;
+int SipSrvLookup::sCacheMisses = 0;
+int SipSrvLookup::sCacheCoalesced = 0;
+
 // Initialize the variables pointing to the list of servers found thus far.
 void server_list_initialize(server_t*& list,
                             int& list_length_allocated,
@@ -605,6 +845,13 @@ void lookup_SRV(server_t*& list,
 #if defined(_WIN32)
    // set the srcIp, and populate the DNS server list
    res_init_ip(srcIp);
+#elif defined(SIP_SRV_THREAD_SAFE_RESOLVER)
+   // res_query reloads a changed resolv.conf by itself, so only
+   // initialize this thread's resolver state once.
+   if (!(_res.options & RES_INIT))
+   {
+      res_init();
+   }
 #else
    res_init();
 #endif
@@ -840,8 +1087,9 @@ void SipSrvLookup::res_query_and_parse(const char* in_name,
       }
       // Use res_query, not res_search, so defaulting rules are not
       // applied to the domain.
-      if (res_query(name, C_IN, type,
-                    (unsigned char*) answer, sizeof (answer)) == -1)
+      if (SipSrvLookup::res_query_cached(name, type,
+                                         (unsigned char*) answer,
+                                         sizeof (answer)) == -1)
       {
          // res_query failed, return.
          break;
@@ -1043,6 +1291,41 @@ OsSocket::IpProtocolSocketType server_t::getProtocolFromServerT()
    return type;
 }
 
+// Get the number of seconds the records in a DNS answer may be cached.
+static int answer_ttl(unsigned char* answer)
+{
+   int ttl = -1;
+   res_response* response = res_parse((char*) answer);
+   if (response != NULL)
+   {
+      unsigned int i;
+      for (i = 0; i < response->header.ancount; i++)
+      {
+         if (ttl < 0 || response->answer[i]->ttl < (u_long) ttl)
+         {
+            ttl = (int) response->answer[i]->ttl;
+         }
+      }
+      for (i = 0; i < response->header.arcount; i++)
+      {
+         if (ttl < 0 || response->additional[i]->ttl < (u_long) ttl)
+         {
+            ttl = (int) response->additional[i]->ttl;
+         }
+      }
+      res_free(response);
+   }
+   return ttl;
+}
+
+// Get the current time in seconds for the DNS cache.
+static long cache_now()
+{
+   OsTime now;
+   OsDateTime::getCurTimeSinceBoot(now);
+   return now.seconds();
+}
+
 /**
  * Post-process the results of res_parse by sorting the lists of "answer" and
  * "additional" RRs, so that responses are reproducible.  (named tends to
@@ -0,0 +1,309 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <string.h>
+
+// APPLICATION INCLUDES
+#include "net/SipStreamFramer.h"
+#include "os/OsSysLog.h"
+
+// DEFINES
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+SipStreamFramer::SipStreamFramer(int chunkSize, int maxMessageSize)
+: mpBuffer(NULL)
+, mCapacity(0)
+, mStart(0)
+, mEnd(0)
+, mMessageLength(0)
+, mHeaderLength(-1)
+, mContentLength(0)
+, mChunkSize(chunkSize > 0 ? chunkSize : HTTP_DEFAULT_SOCKET_BUFFER_SIZE)
+, mMaxMessageSize(maxMessageSize)
+, mNumReads(0)
+{
+}
+
+SipStreamFramer::~SipStreamFramer()
+{
+   delete[] mpBuffer;
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+int SipStreamFramer::readMessage(OsSocket& socket, const char*& messageBytes)
+{
+   int length = nextMessage(messageBytes);
+
+   if (length == 0)
+   {
+      do
+      {
+         // A partial message stays at the start of the buffer, so reading
+         // the rest of it never moves more than the message itself.
+         reserve(mHeaderLength > 0
+                 ? mHeaderLength + mContentLength - (mEnd - mStart)
+                 : mChunkSize);
+
+         int bytesRead = socket.read(mpBuffer + mEnd, mCapacity - mEnd);
+         mNumReads++;
+         if (bytesRead <= 0)
+         {
+            return -1;
+         }
+         mEnd += bytesRead;
+
+         length = nextMessage(messageBytes);
+      } while (length == 0 && socket.isOk() && socket.isReadyToRead(0));
+   }
+
+   if (length < 0)
+   {
+      UtlString remoteHost;
+      int remotePort;
+      socket.getRemoteHostIp(&remoteHost, &remotePort);
+      OsSysLog::add(FAC_SIP, PRI_WARNING,
+                    "SipStreamFramer::readMessage message larger than %d bytes, "
+                    "closing socket type: %d to %s:%d",
+                    mMaxMessageSize, socket.getIpProtocol(),
+                    remoteHost.data(), remotePort);
+      // Shut it all down, because it may be an abusive sender.
+      socket.close();
+      reset();
+   }
+
+   return length;
+}
+
+int SipStreamFramer::nextMessage(const char*& messageBytes)
+{
+   int length = frameMessage();
+   if (length > 0)
+   {
+      messageBytes = mpBuffer + mStart;
+      mMessageLength = length;
+   }
+   return length;
+}
+
+UtlBoolean SipStreamFramer::hasMessage()
+{
+   return frameMessage() > 0;
+}
+
+void SipStreamFramer::append(const char* bytes, int length)
+{
+   frameMessage(); // release the message handed out last
+   reserve(length);
+   memcpy(mpBuffer + mEnd, bytes, length);
+   mEnd += length;
+}
+
+void SipStreamFramer::reset()
+{
+   mStart = 0;
+   mEnd = 0;
+   mMessageLength = 0;
+   mHeaderLength = -1;
+   mContentLength = 0;
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int SipStreamFramer::getBufferedLength() const
+{
+   return mEnd - mStart;
+}
+
+int SipStreamFramer::getNumReads() const
+{
+   return mNumReads;
+}
+
+int SipStreamFramer::getContentLength(const char* headerBytes, int headerLength)
+{
+   static const char longName[] = HTTP_CONTENT_LENGTH_FIELD;
+   static const int longNameLength = sizeof(longName) - 1;
+   int longValue = -1;
+   int shortValue = -1;
+
+   // Skip the first line, then look at the start of every line
+   for (int i = 0; i < headerLength && longValue < 0; i++)
+   {
+      // A line ends with LF, CR LF or a lone CR
+      if (   headerBytes[i] != '\n'
+          && (   headerBytes[i] != '\r'
+              || (i + 1 < headerLength && headerBytes[i+1] == '\n')))
+      {
+         continue;
+      }
+
+      const char* name = headerBytes + i + 1;
+      int remaining = headerLength - (i + 1);
+      int nameLength;
+      if (   remaining > longNameLength
+          && strncasecmp(name, longName, longNameLength) == 0)
+      {
+         nameLength = longNameLength;
+      }
+      else if (   remaining > 1
+               && (name[0] == 'l' || name[0] == 'L')
+               && shortValue < 0)
+      {
+         nameLength = 1;
+      }
+      else
+      {
+         continue;
+      }
+
+      int j = nameLength;
+      while (j < remaining && (name[j] == ' ' || name[j] == '\t'))
+      {
+         j++;
+      }
+      if (j >= remaining || name[j] != ':')
+      {
+         continue;
+      }
+      j++;
+      while (j < remaining && (name[j] == ' ' || name[j] == '\t'))
+      {
+         j++;
+      }
+
+      int value = 0;
+      while (   j < remaining && name[j] >= '0' && name[j] <= '9'
+             && value <= (0x7fffffff - 9) / 10)
+      {
+         value = value * 10 + (name[j] - '0');
+         j++;
+      }
+
+      if (nameLength == 1)
+      {
+         shortValue = value;
+      }
+      else
+      {
+         longValue = value;
+      }
+   }
+
+   // Like HttpMessage::read(), prefer the long form of the header
+   return longValue >= 0 ? longValue : shortValue;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+int SipStreamFramer::frameMessage()
+{
+   if (mMessageLength > 0)
+   {
+      mStart += mMessageLength;
+      mMessageLength = 0;
+      mHeaderLength = -1;
+   }
+
+   if (mHeaderLength < 0)
+   {
+      // Skip whitespace between messages
+      while (mStart < mEnd)
+      {
+         char ch = mpBuffer[mStart];
+         if (ch != ' ' && ch != '\r' && ch != '\n' && ch != '\t')
+         {
+            break;
+         }
+         mStart++;
+      }
+      if (mStart == mEnd)
+      {
+         // Nothing left, so the next read can use the whole buffer
+         mStart = 0;
+         mEnd = 0;
+         return 0;
+      }
+
+      int headerLength =
+         HttpMessage::findHeaderEnd(mpBuffer + mStart, mEnd - mStart);
+      if (   headerLength <= 0
+          // A CR at the end of the buffer may be the first half of CR LF,
+          // so wait for the next byte before ending the headers there.
+          || (   headerLength == mEnd - mStart
+              && mpBuffer[mEnd - 1] == '\r'))
+      {
+         return mEnd - mStart > mMaxMessageSize ? -1 : 0;
+      }
+
+      mContentLength = getContentLength(mpBuffer + mStart, headerLength);
+      if (mContentLength < 0)
+      {
+         OsSysLog::add(FAC_SIP, PRI_ERR,
+                       "SipStreamFramer::frameMessage message has no "
+                       "Content-Length, assuming 0");
+         mContentLength = 0;
+      }
+      else if (mContentLength > mMaxMessageSize)
+      {
+         return -1;
+      }
+      mHeaderLength = headerLength;
+   }
+
+   int length = mHeaderLength + mContentLength;
+   return mEnd - mStart >= length ? length : 0;
+}
+
+void SipStreamFramer::reserve(int minFree)
+{
+   if (minFree < mChunkSize)
+   {
+      minFree = mChunkSize;
+   }
+   if (mCapacity - mEnd >= minFree)
+   {
+      return;
+   }
+
+   int used = mEnd - mStart;
+   if (mCapacity - used >= minFree && used <= mCapacity / 2)
+   {
+      // Move the residual bytes to the front
+      memmove(mpBuffer, mpBuffer + mStart, used);
+   }
+   else
+   {
+      int capacity = mCapacity > 0 ? mCapacity * 2 : mChunkSize * 2;
+      while (capacity - used < minFree)
+      {
+         capacity *= 2;
+      }
+      char* buffer = new char[capacity];
+      if (used > 0)
+      {
+         memcpy(buffer, mpBuffer + mStart, used);
+      }
+      delete[] mpBuffer;
+      mpBuffer = buffer;
+      mCapacity = capacity;
+   }
+   mStart = 0;
+   mEnd = used;
+}
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
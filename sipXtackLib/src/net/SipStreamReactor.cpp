@@ -0,0 +1,402 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+// SYSTEM INCLUDES
+#include <string.h>
+#include <errno.h>
+
+// APPLICATION INCLUDES
+#include "net/SipStreamReactor.h"
+
+#ifdef SIP_STREAM_REACTOR /* [ */
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "net/SipClient.h"
+#include "net/SipProtocolServerBase.h"
+#include "os/OsSysLog.h"
+#include "utl/UtlInt.h"
+#include "utl/UtlVoidPtr.h"
+
+// DEFINES
+// EXTERNAL FUNCTIONS
+// EXTERNAL VARIABLES
+// CONSTANTS
+#define MAX_EPOLL_EVENTS 64
+// Registration id of the wake up pipe
+#define WAKE_ID 0
+// STATIC VARIABLE INITIALIZATIONS
+
+/* //////////////////////////// PUBLIC //////////////////////////////////// */
+
+/* ============================ CREATORS ================================== */
+
+SipStreamReactorThread::SipStreamReactorThread(SipProtocolServerBase* pOwner)
+: OsTask("SipStreamReactor-%d")
+, mpOwner(pOwner)
+, mEpollFd(-1)
+, mDispatchLock(OsMutex::Q_FIFO)
+, mClientsLock(OsMutex::Q_FIFO)
+, mLastId(WAKE_ID)
+{
+   mWakeFds[0] = -1;
+   mWakeFds[1] = -1;
+
+   mEpollFd = epoll_create(MAX_EPOLL_EVENTS);
+   if (mEpollFd >= 0 && pipe(mWakeFds) == 0)
+   {
+      fcntl(mWakeFds[0], F_SETFL, O_NONBLOCK);
+
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      event.events = EPOLLIN;
+      event.data.u64 = WAKE_ID;
+      epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFds[0], &event);
+   }
+   else
+   {
+      OsSysLog::add(FAC_SIP, PRI_ERR,
+                    "SipStreamReactorThread::SipStreamReactorThread "
+                    "cannot create epoll set, errno: %d", errno);
+      if (mEpollFd >= 0)
+      {
+         close(mEpollFd);
+         mEpollFd = -1;
+      }
+   }
+}
+
+SipStreamReactorThread::~SipStreamReactorThread()
+{
+   waitUntilShutDown();
+
+   if (mEpollFd >= 0)
+   {
+      close(mEpollFd);
+      close(mWakeFds[0]);
+      close(mWakeFds[1]);
+   }
+
+   mClients.destroyAll();
+   mClientIds.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+UtlBoolean SipStreamReactorThread::addClient(SipClient* client)
+{
+   int fd = client->getSocketDescriptor();
+   if (!isReady() || fd < 0)
+   {
+      return FALSE;
+   }
+
+   mClientsLock.acquire();
+
+   // Events carry a registration id rather than the client pointer, so
+   // an event which is still queued for a deleted client can never reach
+   // a new client which happens to get the same address.
+   mLastId++;
+   if (mLastId <= WAKE_ID)
+   {
+      mLastId = WAKE_ID + 1;
+   }
+   mClients.insertKeyAndValue(new UtlInt(mLastId), new UtlVoidPtr(client));
+   mClientIds.insertKeyAndValue(new UtlVoidPtr(client), new UtlInt(mLastId));
+
+   struct epoll_event event;
+   memset(&event, 0, sizeof(event));
+   event.events = EPOLLIN;
+   event.data.u64 = mLastId;
+   UtlBoolean added = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+   if (!added)
+   {
+      OsSysLog::add(FAC_SIP, PRI_ERR,
+                    "SipStreamReactorThread::addClient %p cannot add socket %d, "
+                    "errno: %d", client, fd, errno);
+      UtlInt id(mLastId);
+      UtlVoidPtr key(client);
+      mClients.destroy(&id);
+      mClientIds.destroy(&key);
+   }
+
+   mClientsLock.release();
+
+   return added;
+}
+
+void SipStreamReactorThread::removeClient(SipClient* client)
+{
+   // Wait for a read in progress to finish
+   mDispatchLock.acquire();
+   mClientsLock.acquire();
+
+   UtlVoidPtr key(client);
+   UtlInt* id = (UtlInt*) mClientIds.findValue(&key);
+   if (id)
+   {
+      // A closed socket has already left the epoll set by itself
+      int fd = client->getSocketDescriptor();
+      if (fd >= 0)
+      {
+         struct epoll_event event;
+         memset(&event, 0, sizeof(event));
+         epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, &event);
+      }
+
+      mClients.destroy(id);
+      mClientIds.destroy(&key);
+   }
+
+   mClientsLock.release();
+   mDispatchLock.release();
+}
+
+void SipStreamReactorThread::closeClient(SipClient* client)
+{
+   mClientsLock.acquire();
+
+   // Once it is out of mClients, no new read of it is started
+   UtlVoidPtr key(client);
+   UtlInt* id = (UtlInt*) mClientIds.findValue(&key);
+   if (id)
+   {
+      mClients.destroy(id);
+      mClientIds.destroy(&key);
+   }
+
+   int fd = client->getSocketDescriptor();
+   if (fd >= 0)
+   {
+      struct epoll_event event;
+      memset(&event, 0, sizeof(event));
+      epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, &event);
+
+      // Not close(), as a read in progress may still use the descriptor
+      shutdown(fd, SHUT_RDWR);
+   }
+
+   mClientsLock.release();
+}
+
+void SipStreamReactorThread::requestShutdown()
+{
+   OsTask::requestShutdown();
+
+   if (mEpollFd >= 0)
+   {
+      char wake = 0;
+      if (write(mWakeFds[1], &wake, 1) != 1)
+      {
+         OsSysLog::add(FAC_SIP, PRI_ERR,
+                       "SipStreamReactorThread::requestShutdown wake up failed, "
+                       "errno: %d", errno);
+      }
+   }
+}
+
+int SipStreamReactorThread::run(void* pArg)
+{
+   struct epoll_event events[MAX_EPOLL_EVENTS];
+
+   while (isReady() && !isShuttingDown())
+   {
+      int numEvents = epoll_wait(mEpollFd, events, MAX_EPOLL_EVENTS, -1);
+      if (numEvents < 0)
+      {
+         if (errno != EINTR)
+         {
+            OsSysLog::add(FAC_SIP, PRI_ERR,
+                          "SipStreamReactorThread::run epoll_wait failed, "
+                          "errno: %d", errno);
+            break;
+         }
+         continue;
+      }
+
+      for (int i = 0; i < numEvents; i++)
+      {
+         int eventId = (int) events[i].data.u64;
+         if (eventId == WAKE_ID)
+         {
+            char wake[16];
+            while (read(mWakeFds[0], wake, sizeof(wake)) > 0)
+            {
+            }
+            continue;
+         }
+
+         mDispatchLock.acquire();
+
+         // The client may have been removed since epoll_wait() returned
+         mClientsLock.acquire();
+         UtlInt id(eventId);
+         UtlVoidPtr* clientPtr = (UtlVoidPtr*) mClients.findValue(&id);
+         SipClient* client = clientPtr ? (SipClient*) clientPtr->getValue() : NULL;
+         mClientsLock.release();
+
+         if (client && !client->readStream())
+         {
+            // The socket is closed, which took it out of the epoll set
+            mClientsLock.acquire();
+            UtlVoidPtr key(client);
+            mClients.destroy(&id);
+            mClientIds.destroy(&key);
+            mClientsLock.release();
+
+            mpOwner->clientClosed(client);
+         }
+
+         mDispatchLock.release();
+      }
+   }
+
+   return 0;
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int SipStreamReactorThread::getClientCount()
+{
+   mClientsLock.acquire();
+   int count = mClients.entries();
+   mClientsLock.release();
+   return count;
+}
+
+/* ============================ INQUIRY =================================== */
+
+UtlBoolean SipStreamReactorThread::isReady() const
+{
+   return mEpollFd >= 0;
+}
+
+/* ============================ CREATORS ================================== */
+
+SipStreamReactor::SipStreamReactor(SipProtocolServerBase* pOwner,
+                                   int numThreads)
+: mpThreads(NULL)
+, mNumThreads(numThreads > 0 ? numThreads : DEFAULT_NUM_THREADS)
+, mNextThread(0)
+, mLock(OsMutex::Q_FIFO)
+{
+   mpThreads = new SipStreamReactorThread*[mNumThreads];
+   for (int i = 0; i < mNumThreads; i++)
+   {
+      mpThreads[i] = new SipStreamReactorThread(pOwner);
+      mpThreads[i]->start();
+   }
+}
+
+SipStreamReactor::~SipStreamReactor()
+{
+   for (int i = 0; i < mNumThreads; i++)
+   {
+      mpThreads[i]->requestShutdown();
+   }
+   for (int i = 0; i < mNumThreads; i++)
+   {
+      delete mpThreads[i];
+   }
+   delete[] mpThreads;
+
+   mClientThreads.destroyAll();
+}
+
+/* ============================ MANIPULATORS ============================== */
+
+UtlBoolean SipStreamReactor::addClient(SipClient* client)
+{
+   UtlBoolean added = FALSE;
+
+   if (client->isStream())
+   {
+      mLock.acquire();
+      SipStreamReactorThread* thread = mpThreads[mNextThread];
+      mNextThread = (mNextThread + 1) % mNumThreads;
+
+      added = thread->addClient(client);
+      if (added)
+      {
+         mClientThreads.insertKeyAndValue(new UtlVoidPtr(client),
+                                          new UtlVoidPtr(thread));
+      }
+      mLock.release();
+   }
+
+   return added;
+}
+
+void SipStreamReactor::removeClient(SipClient* client)
+{
+   UtlVoidPtr key(client);
+   SipStreamReactorThread* thread = NULL;
+
+   mLock.acquire();
+   UtlVoidPtr* threadPtr = (UtlVoidPtr*) mClientThreads.findValue(&key);
+   if (threadPtr)
+   {
+      thread = (SipStreamReactorThread*) threadPtr->getValue();
+      mClientThreads.destroy(&key);
+   }
+   mLock.release();
+
+   // Outside of mLock, as this waits for a read in progress
+   if (thread)
+   {
+      thread->removeClient(client);
+   }
+}
+
+void SipStreamReactor::closeClient(SipClient* client)
+{
+   UtlVoidPtr key(client);
+   SipStreamReactorThread* thread = NULL;
+
+   // The client stays in mClientThreads until removeClient(), which
+   // waits for a read in progress on its thread.
+   mLock.acquire();
+   UtlVoidPtr* threadPtr = (UtlVoidPtr*) mClientThreads.findValue(&key);
+   if (threadPtr)
+   {
+      thread = (SipStreamReactorThread*) threadPtr->getValue();
+   }
+   mLock.release();
+
+   if (thread)
+   {
+      thread->closeClient(client);
+   }
+}
+
+/* ============================ ACCESSORS ================================= */
+
+int SipStreamReactor::getClientCount()
+{
+   int count = 0;
+   for (int i = 0; i < mNumThreads; i++)
+   {
+      count += mpThreads[i]->getClientCount();
+   }
+   return count;
+}
+
+int SipStreamReactor::getNumThreads() const
+{
+   return mNumThreads;
+}
+
+/* //////////////////////////// PROTECTED ///////////////////////////////// */
+
+/* //////////////////////////// PRIVATE /////////////////////////////////// */
+
+/* ============================ FUNCTIONS ================================= */
+
+#endif /* SIP_STREAM_REACTOR ] */
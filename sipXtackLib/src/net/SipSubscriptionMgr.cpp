@@ -16,6 +16,10 @@
 // APPLICATION INCLUDES
 #include <utl/UtlString.h>
 #include <utl/UtlHashBagIterator.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlLongLongInt.h>
+#include <utl/UtlSList.h>
+#include <utl/UtlSListIterator.h>
 #include <os/OsSysLog.h>
 #include <os/OsTimer.h>
 #include <os/OsDateTime.h>
@@ -25,6 +29,7 @@
 #include <net/SipDialog.h>
 #include <net/NetMd5Codec.h>
 
+class SubscriptionServerStateIndex;
 
 // Private class to contain callback for eventTypeKey
 class SubscriptionServerState : public UtlString
@@ -41,6 +46,7 @@ public:
     long mExpirationDate; // epoch time
     SipMessage* mpLastSubscribeRequest;
     OsTimer* mpExpirationTimer;
+    SubscriptionServerStateIndex* mpIndex;
 
 private:
     //! DISALLOWED accidental copying
@@ -65,6 +71,61 @@ private:
     SubscriptionServerStateIndex& operator=(const SubscriptionServerStateIndex& rhs);
 };
 
+// Subscription states ordered by the second they expire in
+class SubscriptionExpiryQueue
+{
+public:
+    SubscriptionExpiryQueue();
+
+    ~SubscriptionExpiryQueue();
+    // Forgets the queued states, does not delete them
+
+    void add(SubscriptionServerState* state);
+    // Queue a state in the bucket of its expiration date
+
+    void remove(SubscriptionServerState* state);
+    // Take a state off the queue, before its expiration date is changed
+
+    void expire(long oldEpochTimeSeconds, UtlSList& expired);
+    // Move the states which expired before oldEpochTimeSeconds from the
+    // queue to expired
+
+    UtlHashMap mBuckets;   // UtlHashBag of states for each UtlLongLongInt second
+    long mCheckedTime;     // All buckets up to this second are empty
+    UtlHashBag mOverdue;   // States which expire up to mCheckedTime
+};
+
+// The states of a group of dialogs, and the lock which guards them.
+// A state is in the stripe of its dialog handle and its index entry in
+// the resource stripe of its resourceId and eventTypeKey.  Adding,
+// changing or removing a state takes both locks, the dialog stripe
+// first, so either one is enough to read it.
+class SubscriptionDialogStripe
+{
+public:
+    SubscriptionDialogStripe();
+
+    void lock();
+    void unlock();
+
+    UtlHashMap mStates;                   // Keys are the states
+    SubscriptionExpiryQueue mExpiryQueue;
+    OsMutex mMutex;
+};
+
+// Index entries of a group of resources and the lock which guards them
+class SubscriptionResourceStripe
+{
+public:
+    SubscriptionResourceStripe();
+
+    void lock();
+    void unlock();
+
+    UtlHashBag mIndex;                    // SubscriptionServerStateIndex
+    OsMutex mMutex;
+};
+
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
@@ -80,6 +141,7 @@ SubscriptionServerState::SubscriptionServerState()
     mExpirationDate = -1;
     mpLastSubscribeRequest = NULL;
     mpExpirationTimer = NULL;
+    mpIndex = NULL;
 }
 SubscriptionServerState::~SubscriptionServerState()
 {
@@ -110,11 +172,171 @@ SubscriptionServerStateIndex::~SubscriptionServerStateIndex()
     // Do not delete mpState, it is freed else where
 }
 
+SubscriptionExpiryQueue::SubscriptionExpiryQueue()
+{
+    mCheckedTime = OsDateTime::getSecsSinceEpoch() - 1;
+}
+
+SubscriptionExpiryQueue::~SubscriptionExpiryQueue()
+{
+    UtlHashMapIterator iterator(mBuckets);
+    while (iterator())
+    {
+        ((UtlHashBag*) iterator.value())->removeAll();
+    }
+    mBuckets.destroyAll();
+    mOverdue.removeAll();
+}
+
+void SubscriptionExpiryQueue::add(SubscriptionServerState* state)
+{
+    // Buckets are only found by walking forward from mCheckedTime
+    if (state->mExpirationDate <= mCheckedTime)
+    {
+        mOverdue.insert(state);
+        return;
+    }
+
+    UtlLongLongInt key(state->mExpirationDate);
+    UtlHashBag* bucket = (UtlHashBag*) mBuckets.findValue(&key);
+    if (bucket == NULL)
+    {
+        bucket = new UtlHashBag();
+        mBuckets.insertKeyAndValue(new UtlLongLongInt(state->mExpirationDate),
+                                   bucket);
+    }
+    bucket->insert(state);
+}
+
+void SubscriptionExpiryQueue::remove(SubscriptionServerState* state)
+{
+    // Queued states never outlive the check of their bucket, so a date
+    // up to mCheckedTime means the state was overdue when it was queued
+    if (state->mExpirationDate <= mCheckedTime)
+    {
+        mOverdue.removeReference(state);
+        return;
+    }
+
+    UtlLongLongInt key(state->mExpirationDate);
+    UtlHashBag* bucket = (UtlHashBag*) mBuckets.findValue(&key);
+    if (bucket)
+    {
+        bucket->removeReference(state);
+        if (bucket->isEmpty())
+        {
+            mBuckets.destroy(&key);
+        }
+    }
+}
+
+void SubscriptionExpiryQueue::expire(long oldEpochTimeSeconds,
+                                     UtlSList& expired)
+{
+    SubscriptionServerState* state;
+
+    {
+        UtlHashBagIterator iterator(mOverdue);
+        while ((state = (SubscriptionServerState*) iterator()))
+        {
+            if (state->mExpirationDate < oldEpochTimeSeconds)
+            {
+                expired.append(state);
+            }
+        }
+    }
+    {
+        UtlSListIterator iterator(expired);
+        while ((state = (SubscriptionServerState*) iterator()))
+        {
+            mOverdue.removeReference(state);
+        }
+    }
+
+    // Walk the seconds, unless there are fewer buckets than seconds
+    UtlSList dueBuckets;
+    if (oldEpochTimeSeconds - 1 - mCheckedTime > (long) mBuckets.entries())
+    {
+        UtlHashMapIterator iterator(mBuckets);
+        UtlLongLongInt* key;
+        while ((key = (UtlLongLongInt*) iterator()))
+        {
+            if (key->getValue() < oldEpochTimeSeconds)
+            {
+                dueBuckets.append(key);
+            }
+        }
+    }
+    else
+    {
+        for (long time = mCheckedTime + 1; time < oldEpochTimeSeconds; time++)
+        {
+            UtlLongLongInt key(time);
+            UtlContainable* foundKey = mBuckets.find(&key);
+            if (foundKey)
+            {
+                dueBuckets.append(foundKey);
+            }
+        }
+    }
+
+    UtlContainable* key;
+    while ((key = dueBuckets.get()))
+    {
+        UtlHashBag* bucket = (UtlHashBag*) mBuckets.findValue(key);
+        {
+            UtlHashBagIterator iterator(*bucket);
+            while ((state = (SubscriptionServerState*) iterator()))
+            {
+                expired.append(state);
+            }
+        }
+        bucket->removeAll();
+        mBuckets.destroy(key);
+    }
+
+    if (oldEpochTimeSeconds - 1 > mCheckedTime)
+    {
+        mCheckedTime = oldEpochTimeSeconds - 1;
+    }
+}
+
+SubscriptionDialogStripe::SubscriptionDialogStripe() :
+mMutex(OsMutex::Q_FIFO)
+{
+}
+
+void SubscriptionDialogStripe::lock()
+{
+    mMutex.acquire();
+}
+
+void SubscriptionDialogStripe::unlock()
+{
+    mMutex.release();
+}
+
+SubscriptionResourceStripe::SubscriptionResourceStripe() :
+mMutex(OsMutex::Q_FIFO)
+{
+}
+
+void SubscriptionResourceStripe::lock()
+{
+    mMutex.acquire();
+}
+
+void SubscriptionResourceStripe::unlock()
+{
+    mMutex.release();
+}
+
 // Constructor
 SipSubscriptionMgr::SipSubscriptionMgr()
-: mSubscriptionMgrMutex(OsMutex::Q_FIFO)
+: mEstablishedDialogCount(0)
+, mpDialogStripes(new SubscriptionDialogStripe[NUM_STRIPES])
+, mpResourceStripes(new SubscriptionResourceStripe[NUM_STRIPES])
 {
-    mEstablishedDialogCount = 0;
     mMinExpiration = 32;
     mDefaultExpiration = 3600;
     mMaxExpiration = 86400;
@@ -123,7 +345,9 @@ SipSubscriptionMgr::SipSubscriptionMgr()
 
 // Copy constructor NOT IMPLEMENTED
 SipSubscriptionMgr::SipSubscriptionMgr(const SipSubscriptionMgr& rSipSubscriptionMgr)
-: mSubscriptionMgrMutex(OsMutex::Q_FIFO)
+: mEstablishedDialogCount(0)
+, mpDialogStripes(new SubscriptionDialogStripe[NUM_STRIPES])
+, mpResourceStripes(new SubscriptionResourceStripe[NUM_STRIPES])
 {
 }
 
@@ -131,8 +355,15 @@ SipSubscriptionMgr::SipSubscriptionMgr(const SipSubscriptionMgr& rSipSubscriptio
 // Destructor
 SipSubscriptionMgr::~SipSubscriptionMgr()
 {
-    // Iterate through and delete all the dialogs
-    // TODO:
+    // Iterate through and delete all the states, the dialogs go with
+    // the dialog manager
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpResourceStripes[i].mIndex.destroyAll();
+        mpDialogStripes[i].mStates.destroyAll();
+    }
+    delete[] mpResourceStripes;
+    delete[] mpDialogStripes;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -180,10 +411,7 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
         // Should probably add something like the local IP address and SIP port
         toTagClearText.append(dialogHandle);
         char numBuffer[20];
-        lock();
-        mEstablishedDialogCount++;
-        sprintf(numBuffer, "%d", mEstablishedDialogCount);
-        unlock();
+        sprintf(numBuffer, "%d", ++mEstablishedDialogCount);
         toTagClearText.append(numBuffer);
         UtlString toTag;
         NetMd5Codec::encode(toTagClearText, toTag);
@@ -245,6 +473,7 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
             *((UtlString*)stateKey) = resourceId;
             stateKey->append(eventTypeKey);
             stateKey->mpState = state;
+            state->mpIndex = stateKey;
 
             // Set the contact to the same request URI that came in
             UtlString contact;
@@ -262,9 +491,13 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
             subscribeResponse.setExpiresField(expiration);
             subscribeCopy->getDialogHandle(subscribeDialogHandle);
 
-            lock();
-            mSubscriptionStatesByDialogHandle.insert(state);
-            mSubscriptionStateResourceIndex.insert(stateKey);
+            SubscriptionDialogStripe& dialogStripe = getDialogStripe(dialogHandle);
+            SubscriptionResourceStripe& resourceStripe = getResourceStripe(*stateKey);
+            dialogStripe.lock();
+            resourceStripe.lock();
+            dialogStripe.mStates.insert(state);
+            dialogStripe.mExpiryQueue.add(state);
+            resourceStripe.mIndex.insert(stateKey);
 	    if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
 	    {
 	       UtlString requestContact;
@@ -278,7 +511,8 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
             stateKey = NULL;
             state = NULL;
             subscribeCopy = NULL;
-            unlock();
+            resourceStripe.unlock();
+            dialogStripe.unlock();
 
             subscriptionSucceeded = TRUE;
 
@@ -322,16 +556,23 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
 
             // Get the subscription state and update that
             // TODO:  This assumes that no one reuses the same dialog
-            // to subscribe to more than one event type.  mSubscriptionStatesByDialogHandle
+            // to subscribe to more than one event type.  The states by dialog handle
             // will need to be changed to a HashBag and we will need to
             // search through to find a matching event type
-            lock();
+            SubscriptionDialogStripe& dialogStripe = getDialogStripe(dialogHandle);
+            dialogStripe.lock();
             state = (SubscriptionServerState*)
-                mSubscriptionStatesByDialogHandle.find(&dialogHandle);
+                dialogStripe.mStates.find(&dialogHandle);
             if(state)
             {
+                SubscriptionResourceStripe& resourceStripe =
+                    getResourceStripe(*(state->mpIndex));
+                resourceStripe.lock();
+
                 long now = OsDateTime::getSecsSinceEpoch();
+                dialogStripe.mExpiryQueue.remove(state);
                 state->mExpirationDate = now + expiration;
+                dialogStripe.mExpiryQueue.add(state);
                 if(state->mpLastSubscribeRequest)
                 {
                     delete state->mpLastSubscribeRequest;
@@ -339,6 +580,8 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
                 state->mpLastSubscribeRequest = new SipMessage(subscribeRequest);
                 subscribeRequest.getAcceptField(state->mAcceptHeaderValue);
 
+                resourceStripe.unlock();
+
                 // Set the contact to the same request URI that came in
                 UtlString contact;
                 subscribeRequest.getRequestUri(&contact);
@@ -387,8 +630,14 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
                 *((UtlString*)stateKey) = resourceId;
                 stateKey->append(eventTypeKey);
                 stateKey->mpState = state;
-                mSubscriptionStatesByDialogHandle.insert(state);
-                mSubscriptionStateResourceIndex.insert(stateKey);
+                state->mpIndex = stateKey;
+
+                SubscriptionResourceStripe& resourceStripe =
+                    getResourceStripe(*stateKey);
+                resourceStripe.lock();
+                dialogStripe.mStates.insert(state);
+                dialogStripe.mExpiryQueue.add(state);
+                resourceStripe.mIndex.insert(stateKey);
                 if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
 	        {
 		   UtlString requestContact;
@@ -402,6 +651,7 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
                 stateKey = NULL;
                 state = NULL;
                 subscribeCopy = NULL;
+                resourceStripe.unlock();
 
                 // Set the contact to the same request URI that came in
                 UtlString contact;
@@ -429,7 +679,7 @@ UtlBoolean SipSubscriptionMgr::updateDialogInfo(const SipMessage& subscribeReque
                 }
                 subscribeDialogHandle = dialogHandle;
             }
-            unlock();
+            dialogStripe.unlock();
         }
 
         // Expiration too small
@@ -452,9 +702,10 @@ UtlBoolean SipSubscriptionMgr::getNotifyDialogInfo(const UtlString& subscribeDia
                                                    SipMessage& notifyRequest)
 {
     UtlBoolean notifyInfoSet = FALSE;
-    lock();
+    SubscriptionDialogStripe& dialogStripe = getDialogStripe(subscribeDialogHandle);
+    dialogStripe.lock();
     SubscriptionServerState* state = (SubscriptionServerState*)
-        mSubscriptionStatesByDialogHandle.find(&subscribeDialogHandle);
+        dialogStripe.mStates.find(&subscribeDialogHandle);
 
     if(state)
     {
@@ -479,7 +730,7 @@ UtlBoolean SipSubscriptionMgr::getNotifyDialogInfo(const UtlString& subscribeDia
                 expires);
         notifyRequest.setHeaderValue(SIP_SUBSCRIPTION_STATE_FIELD, buffer, 0);
     }
-    unlock();
+    dialogStripe.unlock();
 
     return(notifyInfoSet);
 }
@@ -493,12 +744,14 @@ UtlBoolean SipSubscriptionMgr::createNotifiesDialogInfo(const char* resourceId,
     UtlString contentKey(resourceId);
     contentKey.append(eventTypeKey);
 
+    SubscriptionResourceStripe& resourceStripe = getResourceStripe(contentKey);
+    resourceStripe.lock();
+
     OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                 "SipSubscriptionMgr::createNotifiesDialogInfo try to find contentKey '%s' in mSubscriptionStateResourceIndex (%"PRIuPTR" entries)",
-                 contentKey.data(), mSubscriptionStateResourceIndex.entries());
+                 "SipSubscriptionMgr::createNotifiesDialogInfo try to find contentKey '%s' in resource index (%" PRIuPTR " entries)",
+                 contentKey.data(), resourceStripe.mIndex.entries());
 
-    lock();
-    UtlHashBagIterator iterator(mSubscriptionStateResourceIndex, &contentKey);
+    UtlHashBagIterator iterator(resourceStripe.mIndex, &contentKey);
     int count = 0;
     int index = 0;
     acceptHeaderValuesArray = NULL;
@@ -573,7 +826,7 @@ UtlBoolean SipSubscriptionMgr::createNotifiesDialogInfo(const char* resourceId,
             }
         }
     }
-    unlock();
+    resourceStripe.unlock();
 
     numNotifiesCreated = index;
 
@@ -606,50 +859,37 @@ UtlBoolean SipSubscriptionMgr::endSubscription(const UtlString& dialogHandle)
 {
     UtlBoolean subscriptionFound = FALSE;
 
-    lock();
+    SubscriptionDialogStripe& dialogStripe = getDialogStripe(dialogHandle);
+    dialogStripe.lock();
     SubscriptionServerState* state = (SubscriptionServerState*)
-        mSubscriptionStatesByDialogHandle.find(&dialogHandle);
+        dialogStripe.mStates.find(&dialogHandle);
     if(state)
     {
-        SubscriptionServerStateIndex* stateIndex = NULL;
-        UtlString contentKey(state->mResourceId);
-        contentKey.append(state->mEventTypeKey);
-        UtlHashBagIterator iterator(mSubscriptionStateResourceIndex, &contentKey);
-        while((stateIndex = (SubscriptionServerStateIndex*) iterator()))
+        SubscriptionServerStateIndex* stateIndex = state->mpIndex;
+        SubscriptionResourceStripe& resourceStripe =
+            getResourceStripe(*stateIndex);
+        resourceStripe.lock();
+        resourceStripe.mIndex.removeReference(stateIndex);
+        resourceStripe.unlock();
+
+        dialogStripe.mStates.removeReference(state);
+        dialogStripe.mExpiryQueue.remove(state);
+        if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
         {
-            if(stateIndex->mpState == state)
-            {
-                mSubscriptionStatesByDialogHandle.removeReference(state);
-                mSubscriptionStateResourceIndex.removeReference(stateIndex);
-                if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
-	        {
-		   UtlString requestContact;
-		   state->mpLastSubscribeRequest->getContactField(0, requestContact);
-		   OsSysLog::add(FAC_SIP, PRI_DEBUG,
-				 "SipSubscriptionMgr::endSubscription delete subscription for key '%s', contact '%s', mExpirationDate %ld",
-				 stateIndex->data(), requestContact.data(),
-				 state->mExpirationDate);
-                }
-
-                delete state;
-                delete stateIndex;
-                subscriptionFound = TRUE;
-
-                break;
-            }
+           UtlString requestContact;
+           state->mpLastSubscribeRequest->getContactField(0, requestContact);
+           OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                         "SipSubscriptionMgr::endSubscription delete subscription for key '%s', contact '%s', mExpirationDate %ld",
+                         stateIndex->data(), requestContact.data(),
+                         state->mExpirationDate);
         }
 
-        // Could not find the state index that cooresponded to the state
-        // SHould not happen, there should always be one of each
-        if(!subscriptionFound)
-        {
-            OsSysLog::add(FAC_SIP, PRI_ERR,
-                "SipSubscriptionMgr::endSubscription could not find SubscriptionServerStateIndex for state with dialog: %s",
-                dialogHandle.data());
-        }
+        delete state;
+        delete stateIndex;
+        subscriptionFound = TRUE;
     }
 
-    unlock();
+    dialogStripe.unlock();
 
     // Remove the dialog
     mDialogMgr.deleteDialog(dialogHandle);
@@ -662,46 +902,50 @@ int SipSubscriptionMgr::dumpOldSubscriptions(long oldEpochTimeSeconds)
     int totalStates = 0;
     int oldStates = 0;
     int stateIndicesWithNoState = 0;
-    lock();
-    UtlHashBagIterator iterator(mSubscriptionStateResourceIndex);
-    SubscriptionServerStateIndex* stateIndex = NULL;
-    while((stateIndex = (SubscriptionServerStateIndex*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        totalStates++;
-        if(stateIndex->mpState)
+        SubscriptionResourceStripe& resourceStripe = mpResourceStripes[i];
+        resourceStripe.lock();
+        UtlHashBagIterator iterator(resourceStripe.mIndex);
+        SubscriptionServerStateIndex* stateIndex = NULL;
+        while((stateIndex = (SubscriptionServerStateIndex*) iterator()))
         {
-            OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                    "substate: %s expires: %ld old date: %ld",
-                    stateIndex->mpState->data(), 
-                    stateIndex->mpState->mExpirationDate,
-                    oldEpochTimeSeconds);
-            if(stateIndex->mpState->mExpirationDate < oldEpochTimeSeconds)
+            totalStates++;
+            if(stateIndex->mpState)
             {
-                if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
-	            {
-		            UtlString requestContact;
-		            stateIndex->mpState->mpLastSubscribeRequest->
-		            getContactField(0, requestContact);
-		            OsSysLog::add(FAC_SIP, PRI_DEBUG,
-				        "SipSubscriptionMgr::removeOldSubscriptions old subscription for key '%s', contact '%s', mExpirationDate %ld",
-				    stateIndex->data(), requestContact.data(),
-				    stateIndex->mpState->mExpirationDate);
+                OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                        "substate: %s expires: %ld old date: %ld",
+                        stateIndex->mpState->data(), 
+                        stateIndex->mpState->mExpirationDate,
+                        oldEpochTimeSeconds);
+                if(stateIndex->mpState->mExpirationDate < oldEpochTimeSeconds)
+                {
+                    if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
+                    {
+                        UtlString requestContact;
+                        stateIndex->mpState->mpLastSubscribeRequest->
+                        getContactField(0, requestContact);
+                        OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                            "SipSubscriptionMgr::removeOldSubscriptions old subscription for key '%s', contact '%s', mExpirationDate %ld",
+                            stateIndex->data(), requestContact.data(),
+                            stateIndex->mpState->mExpirationDate);
+                    }
+                    oldStates++;
                 }
-                oldStates++;
+            }
+            else
+            {
+                OsSysLog::add(FAC_SIP, PRI_ERR,
+                    "SipSubscriptionMgr::removeOldSubscriptions SubscriptionServerStateIndex with NULL mpState, should be removed");
+                OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                              "SipSubscriptionMgr::removeOldSubscriptions should remove subscription for key '%s'",
+                              stateIndex->data());
+                stateIndicesWithNoState++;
             }
         }
-        else
-        {
-            OsSysLog::add(FAC_SIP, PRI_ERR,
-                "SipSubscriptionMgr::removeOldSubscriptions SubscriptionServerStateIndex with NULL mpState, should be removed");
-            OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                          "SipSubscriptionMgr::removeOldSubscriptions should remove subscription for key '%s'",
-                          stateIndex->data());
-            stateIndicesWithNoState++;
-        }
+        resourceStripe.unlock();
     }
 
-    unlock();
     OsSysLog::add(FAC_SIP, PRI_DEBUG,
             "SipSubscriptionMgr::removeOldSubscriptions states removed: %d indices w/o state: %d total states: %d",
             oldStates, stateIndicesWithNoState, totalStates);
@@ -710,55 +954,50 @@ int SipSubscriptionMgr::dumpOldSubscriptions(long oldEpochTimeSeconds)
     
 int SipSubscriptionMgr::removeOldSubscriptions(long oldEpochTimeSeconds)
 {
-    int totalStates = 0;
     int removedStates = 0;
-    int stateIndicesWithNoState = 0;
-    lock();
-    UtlHashBagIterator iterator(mSubscriptionStateResourceIndex);
-    SubscriptionServerStateIndex* stateIndex = NULL;
-    while((stateIndex = (SubscriptionServerStateIndex*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        totalStates++;
-        if(stateIndex->mpState)
+        SubscriptionDialogStripe& dialogStripe = mpDialogStripes[i];
+        dialogStripe.lock();
+
+        // Only the states which expired are taken off the queue
+        UtlSList expired;
+        dialogStripe.mExpiryQueue.expire(oldEpochTimeSeconds, expired);
+
+        SubscriptionServerState* state;
+        while((state = (SubscriptionServerState*) expired.get()))
         {
-            if(stateIndex->mpState->mExpirationDate < oldEpochTimeSeconds)
+            SubscriptionServerStateIndex* stateIndex = state->mpIndex;
+            if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
             {
-                if (OsSysLog::willLog(FAC_SIP, PRI_DEBUG))
-                {
-                    UtlString requestContact;
-                    stateIndex->mpState->mpLastSubscribeRequest->
-                    getContactField(0, requestContact);
-                    OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                        "SipSubscriptionMgr::removeOldSubscriptions delete subscription for key '%s', contact '%s', mExpirationDate %ld",
-                        stateIndex->data(), requestContact.data(),
-                        stateIndex->mpState->mExpirationDate);
-                }
-                mDialogMgr.deleteDialog(*(stateIndex->mpState));
-                mSubscriptionStatesByDialogHandle.removeReference(stateIndex->mpState);
-                removedStates++;
-                delete stateIndex->mpState;
-                stateIndex->mpState = NULL;
-                mSubscriptionStateResourceIndex.removeReference(stateIndex);
-                delete stateIndex;
+                UtlString requestContact;
+                state->mpLastSubscribeRequest->
+                getContactField(0, requestContact);
+                OsSysLog::add(FAC_SIP, PRI_DEBUG,
+                    "SipSubscriptionMgr::removeOldSubscriptions delete subscription for key '%s', contact '%s', mExpirationDate %ld",
+                    stateIndex->data(), requestContact.data(),
+                    state->mExpirationDate);
             }
-        }
-        else
-        {
-            OsSysLog::add(FAC_SIP, PRI_ERR,
-                "SipSubscriptionMgr::removeOldSubscriptions SubscriptionServerStateIndex with NULL mpState, deleting");
-            mSubscriptionStateResourceIndex.removeReference(stateIndex);
-            OsSysLog::add(FAC_SIP, PRI_DEBUG,
-                          "SipSubscriptionMgr::removeOldSubscriptions delete subscription for key '%s'",
-                          stateIndex->data());
-            stateIndicesWithNoState++;
+
+            SubscriptionResourceStripe& resourceStripe =
+                getResourceStripe(*stateIndex);
+            resourceStripe.lock();
+            resourceStripe.mIndex.removeReference(stateIndex);
+            resourceStripe.unlock();
+
+            mDialogMgr.deleteDialog(*state);
+            dialogStripe.mStates.removeReference(state);
+            removedStates++;
+            delete state;
             delete stateIndex;
         }
+
+        dialogStripe.unlock();
     }
 
-    unlock();
     OsSysLog::add(FAC_SIP, PRI_DEBUG,
-            "SipSubscriptionMgr::removeOldSubscriptions states removed: %d indices w/o state: %d total states: %d",
-            removedStates, stateIndicesWithNoState, totalStates);
+            "SipSubscriptionMgr::removeOldSubscriptions states removed: %d",
+            removedStates);
     return(removedStates);
 }
 
@@ -780,9 +1019,12 @@ SipDialogMgr* SipSubscriptionMgr::getDialogMgr()
 int SipSubscriptionMgr::getStateCount()
 {
     int count = 0;
-    lock();
-    count = mSubscriptionStatesByDialogHandle.entries();
-    unlock();
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpDialogStripes[i].lock();
+        count += mpDialogStripes[i].mStates.entries();
+        mpDialogStripes[i].unlock();
+    }
     return(count);
 }
 
@@ -792,14 +1034,15 @@ UtlBoolean SipSubscriptionMgr::dialogExists(UtlString& dialogHandle)
 {
     UtlBoolean subscriptionFound = FALSE;
 
-    lock();
+    SubscriptionDialogStripe& dialogStripe = getDialogStripe(dialogHandle);
+    dialogStripe.lock();
     SubscriptionServerState* state = (SubscriptionServerState*)
-        mSubscriptionStatesByDialogHandle.find(&dialogHandle);
+        dialogStripe.mStates.find(&dialogHandle);
     if(state)
     {
         subscriptionFound = TRUE;
     }
-    unlock();
+    dialogStripe.unlock();
 
     return(subscriptionFound);
 }
@@ -808,9 +1051,10 @@ UtlBoolean SipSubscriptionMgr::isExpired(UtlString& dialogHandle)
 {
     UtlBoolean subscriptionExpired = TRUE;
 
-    lock();
+    SubscriptionDialogStripe& dialogStripe = getDialogStripe(dialogHandle);
+    dialogStripe.lock();
     SubscriptionServerState* state = (SubscriptionServerState*)
-        mSubscriptionStatesByDialogHandle.find(&dialogHandle);
+        dialogStripe.mStates.find(&dialogHandle);
     if(state)
     {
         long now = OsDateTime::getSecsSinceEpoch();
@@ -820,7 +1064,7 @@ UtlBoolean SipSubscriptionMgr::isExpired(UtlString& dialogHandle)
             subscriptionExpired = FALSE;
         }
     }
-    unlock();
+    dialogStripe.unlock();
 
     return(subscriptionExpired);
 }
@@ -830,14 +1074,21 @@ UtlBoolean SipSubscriptionMgr::isExpired(UtlString& dialogHandle)
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
 
-void SipSubscriptionMgr::lock()
+SubscriptionDialogStripe&
+SipSubscriptionMgr::getDialogStripe(const UtlString& dialogHandle)
 {
-    mSubscriptionMgrMutex.acquire();
+    UtlString callId;
+    UtlString localTag;
+    UtlString remoteTag;
+    SipDialog::parseHandle(dialogHandle, callId, localTag, remoteTag);
+
+    return mpDialogStripes[callId.hash() % NUM_STRIPES];
 }
 
-void SipSubscriptionMgr::unlock()
+SubscriptionResourceStripe&
+SipSubscriptionMgr::getResourceStripe(const UtlString& resourceKey)
 {
-    mSubscriptionMgrMutex.release();
+    return mpResourceStripes[resourceKey.hash() % NUM_STRIPES];
 }
 
 /* ============================ FUNCTIONS ================================= */
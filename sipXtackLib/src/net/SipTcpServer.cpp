@@ -314,11 +314,7 @@ UtlBoolean SipServerBrokerListener::handleMessage(OsMsg& eventMessage)
             OsSysLog::add(FAC_SIP, PRI_DEBUG, "Sip%sServer::run client: %p %s:%d",
                 mpOwner->mProtocolString.data(), client, hostAddress.data(), hostPort);
 
-            UtlBoolean clientStarted = client->start();
-            if(!clientStarted)
-            {
-                OsSysLog::add(FAC_SIP, PRI_ERR, "SIP %s Client failed to start", mpOwner->mProtocolString.data());
-            }
+            // Starts the client, or has the reactor read from it
             mpOwner->addClient(client);
             bRet = TRUE;
         }
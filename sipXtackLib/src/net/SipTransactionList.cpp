@@ -15,12 +15,17 @@
 // APPLICATION INCLUDES
 #include <utl/UtlString.h>
 #include <utl/UtlHashBagIterator.h>
+#include <utl/UtlHashMap.h>
+#include <utl/UtlHashMapIterator.h>
+#include <utl/UtlInt.h>
+#include <utl/UtlSList.h>
 
 #include <net/SipTransaction.h>
 #include <net/SipTransactionList.h>
 #include <net/SipMessage.h>
 #include <os/OsTask.h>
 #include <os/OsEvent.h>
+#include <os/OsDateTime.h>
 
 // EXTERNAL FUNCTIONS
 // EXTERNAL VARIABLES
@@ -33,27 +38,195 @@
 
 // STATIC VARIABLE INITIALIZATIONS
 
+// Transactions ordered by the second they were last used in
+class SipTransactionQueue
+{
+public:
+    SipTransactionQueue();
+
+    ~SipTransactionQueue();
+    // Forgets the queued transactions, does not delete them
+
+    void add(SipTransaction* transaction, long time);
+    // Queue a transaction in the bucket of the given second
+
+    void expire(long checkUntil,
+                long oldTransaction,
+                long oldInviteTransaction,
+                UtlHashBag& transactions,
+                UtlSList& expired,
+                int& busyCount);
+    // Move the transactions which were queued before checkUntil and have
+    // expired from transactions to expired.  The others are queued again
+    // at the time they were last used.
+
+    UtlHashMap mBuckets;   // UtlSList of transactions for each UtlInt second
+    long mCheckedTime;     // All buckets up to this second are empty
+    UtlSList mPending;     // Due transactions which could not be removed
+                           // yet (e.g. busy), checked on every expire()
+};
+
+// Transactions of a group of Call-Ids and the lock which guards them
+class SipTransactionStripe
+{
+public:
+    SipTransactionStripe();
+
+    void lock();
+    void unlock();
+
+    UtlHashBag mTransactions;
+    SipTransactionQueue mTransactionQueue;  // Transactions other than INVITE
+    SipTransactionQueue mInviteQueue;       // INVITE transactions
+    OsMutex mMutex;
+};
+
+SipTransactionQueue::SipTransactionQueue()
+{
+    OsTime time;
+    OsDateTime::getCurTimeSinceBoot(time);
+    mCheckedTime = time.seconds() - 1;
+}
+
+SipTransactionQueue::~SipTransactionQueue()
+{
+    UtlHashMapIterator iterator(mBuckets);
+    while (iterator())
+    {
+        ((UtlSList*) iterator.value())->removeAll();
+    }
+    mBuckets.destroyAll();
+    mPending.removeAll();
+}
+
+void SipTransactionQueue::add(SipTransaction* transaction, long time)
+{
+    // Transactions are only found by walking forward from mCheckedTime
+    if (time <= mCheckedTime)
+    {
+        time = mCheckedTime + 1;
+    }
+
+    UtlInt key(time);
+    UtlSList* bucket = (UtlSList*) mBuckets.findValue(&key);
+    if (bucket == NULL)
+    {
+        bucket = new UtlSList();
+        mBuckets.insertKeyAndValue(new UtlInt(time), bucket);
+    }
+    bucket->append(transaction);
+}
+
+void SipTransactionQueue::expire(long checkUntil,
+                                 long oldTransaction,
+                                 long oldInviteTransaction,
+                                 UtlHashBag& transactions,
+                                 UtlSList& expired,
+                                 int& busyCount)
+{
+    UtlSList due;
+    SipTransaction* transaction;
+
+    while ((transaction = (SipTransaction*) mPending.get()))
+    {
+        due.append(transaction);
+    }
+
+    for (long time = mCheckedTime + 1; time < checkUntil; time++)
+    {
+        UtlInt key(time);
+        UtlSList* bucket = (UtlSList*) mBuckets.findValue(&key);
+        if (bucket)
+        {
+            while ((transaction = (SipTransaction*) bucket->get()))
+            {
+                due.append(transaction);
+            }
+            mBuckets.destroy(&key);
+        }
+    }
+
+    if (checkUntil - 1 > mCheckedTime)
+    {
+        mCheckedTime = checkUntil - 1;
+    }
+
+    while ((transaction = (SipTransaction*) due.get()))
+    {
+        long transTime = transaction->getTimeStamp();
+        UtlBoolean isBusy = transaction->isBusy();
+        if (isBusy) busyCount++;
+
+        // Invites need to be kept longer than other transactions
+        if (((!transaction->isMethod(SIP_INVITE_METHOD) &&
+              transTime < oldTransaction) ||
+             transTime < oldInviteTransaction) &&
+            ! isBusy)
+        {
+            // Remove it from the list
+            transactions.removeReference(transaction);
+
+            OsSysLog::add(FAC_SIP, PRI_DEBUG, "removing transaction %p\n", transaction);
+
+            expired.append(transaction);
+
+            // Make sure the events waiting for the transaction
+            // to be available are signaled before we delete
+            // any of the transactions or we end up with
+            // incomplete transaction trees (i.e. deleted branches)
+            transaction->signalAllAvailable();
+        }
+        else if (transTime >= checkUntil)
+        {
+            // Used since it was queued
+            add(transaction, transTime);
+        }
+        else
+        {
+            mPending.append(transaction);
+        }
+    }
+}
+
+SipTransactionStripe::SipTransactionStripe() :
+mMutex(OsMutex::Q_FIFO)
+{
+}
+
+void SipTransactionStripe::lock()
+{
+    mMutex.acquire();
+}
+
+void SipTransactionStripe::unlock()
+{
+    mMutex.release();
+}
+
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
 
 /* ============================ CREATORS ================================== */
 
 // Constructor
 SipTransactionList::SipTransactionList() :
-mTransactions(),
-mListMutex(OsMutex::Q_FIFO)
+mpStripes(new SipTransactionStripe[NUM_STRIPES])
 {
 }
 
 // Copy constructor
 SipTransactionList::SipTransactionList(const SipTransactionList& rSipTransactionList) :
-mListMutex(OsMutex::Q_FIFO)
+mpStripes(new SipTransactionStripe[NUM_STRIPES])
 {
 }
 
 // Destructor
 SipTransactionList::~SipTransactionList()
 {
-    mTransactions.destroyAll();
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpStripes[i].mTransactions.destroyAll();
+    }
+    delete[] mpStripes;
 }
 
 /* ============================ MANIPULATORS ============================== */
@@ -71,9 +244,19 @@ SipTransactionList::operator=(const SipTransactionList& rhs)
 void SipTransactionList::addTransaction(SipTransaction* transaction,
                                         UtlBoolean lockList)
 {
-    if(lockList) lock();
+    SipTransactionStripe& stripe = getStripe(*transaction);
 
-    mTransactions.insert(transaction);
+    if(lockList) stripe.lock();
+
+    stripe.mTransactions.insert(transaction);
+    if(transaction->isMethod(SIP_INVITE_METHOD))
+    {
+        stripe.mInviteQueue.add(transaction, transaction->getTimeStamp());
+    }
+    else
+    {
+        stripe.mTransactionQueue.add(transaction, transaction->getTimeStamp());
+    }
 
 #ifdef TEST_PRINT
     osPrintf("***************************************\n");
@@ -81,7 +264,7 @@ void SipTransactionList::addTransaction(SipTransaction* transaction,
     osPrintf("***************************************\n");
 #endif
 
-    if(lockList) unlock();
+    if(lockList) stripe.unlock();
 }
 
 //: Find a transaction for the given message
@@ -94,7 +277,8 @@ SipTransactionList::findTransactionFor(const SipMessage& message,
     UtlString callId;
     SipTransaction::buildHash(message, isOutgoing, callId);
 
-    lock();
+    SipTransactionStripe& stripe = getStripe(callId);
+    stripe.lock();
 
     // See if the message knows its transaction
     // DO NOT TOUCH THE CONTENTS of this transaction as it may no
@@ -103,7 +287,7 @@ SipTransactionList::findTransactionFor(const SipMessage& message,
 
     UtlString matchTransaction(callId);
 
-    UtlHashBagIterator iterator(mTransactions, &matchTransaction);
+    UtlHashBagIterator iterator(stripe.mTransactions, &matchTransaction);
 
     relationship = SipTransaction::MESSAGE_UNKNOWN;
     while ((transactionFound = (SipTransaction*) iterator()))
@@ -157,7 +341,7 @@ SipTransactionList::findTransactionFor(const SipMessage& message,
         }
     }
 
-    unlock();
+    stripe.unlock();
 
     if(transactionFound && isBusy)
     {
@@ -205,8 +389,8 @@ SipTransactionList::findTransactionFor(const SipMessage& message,
 void SipTransactionList::removeOldTransactions(long oldTransaction,
                                                long oldInviteTransaction)
 {
-    SipTransaction** transactionsToBeDeleted = NULL;
-    int deleteCount = 0;
+    UtlSList transactionsToBeDeleted;
+    int numTransactions = 0;
     int busyCount = 0;
 
 #   ifdef TIME_LOG
@@ -214,90 +398,58 @@ void SipTransactionList::removeOldTransactions(long oldTransaction,
     gcTimes.addEvent("start");
 #   endif
 
-    lock();
+    // Transactions other than INVITE expire at the earlier of the two times
+    long transactionCheckUntil = oldTransaction > oldInviteTransaction
+                                 ? oldTransaction : oldInviteTransaction;
 
-    int numTransactions = mTransactions.entries();
-    if(numTransactions > 0)
+    // Only one stripe is locked at a time, and only the transactions which
+    // were last used before the given times are looked at.
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        UtlHashBagIterator iterator(mTransactions);
-        SipTransaction* transactionFound = NULL;
-        long transTime;
-
-
-        // Pull all of the transactions to be deleted out of the list
-        while((transactionFound = (SipTransaction*) iterator()))
-        {
-            if(transactionFound->isBusy()) busyCount++;
-
-            transTime = transactionFound->getTimeStamp();
-            // Invites need to be kept longer than other transactions
-            if(((!transactionFound->isMethod(SIP_INVITE_METHOD) &&
-                transTime < oldTransaction) ||
-                transTime < oldInviteTransaction) &&
-                ! transactionFound->isBusy())
-            {
-                // Remove it from the list
-                mTransactions.removeReference(transactionFound);
-
-                OsSysLog::add(FAC_SIP, PRI_DEBUG, "removing transaction %p\n",transactionFound);
-
-                // Make sure we have a pointer array to hold it
-                if(transactionsToBeDeleted == NULL)
-                {
-                     transactionsToBeDeleted =
-                        new SipTransaction*[numTransactions];
-                }
-
-                // Put it in the pointer array
-                transactionsToBeDeleted[deleteCount] = transactionFound;
-                deleteCount++;
-
-                // Make sure the events waiting for the transaction
-                // to be available are signaled before we delete
-                // any of the transactions or we end up with
-                // incomplete transaction trees (i.e. deleted branches)
-                transactionFound->signalAllAvailable();
-                transactionFound = NULL;
-            }
-        }
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
+
+        numTransactions += stripe.mTransactions.entries();
+        stripe.mTransactionQueue.expire(transactionCheckUntil,
+                                        oldTransaction, oldInviteTransaction,
+                                        stripe.mTransactions,
+                                        transactionsToBeDeleted, busyCount);
+        stripe.mInviteQueue.expire(oldInviteTransaction,
+                                   oldTransaction, oldInviteTransaction,
+                                   stripe.mTransactions,
+                                   transactionsToBeDeleted, busyCount);
+
+        stripe.unlock();
     }
 
-    unlock();
-
     // We do not need the lock if the transactions have been
     // removed from the list
+    int deleteCount = transactionsToBeDeleted.entries();
     if ( deleteCount || busyCount ) // do not log 'doing nothing when nothing to do', even at debug level
     {
         OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipTransactionList::removeOldTransactions deleting %d of %d transactions (%d busy)\n",
                       deleteCount , numTransactions, busyCount);
     }
 
-    // Delete the transactions in the array
-    if (transactionsToBeDeleted)
+    // Delete the expired transactions
+    if (deleteCount)
     {
 #       ifdef TIME_LOG
         gcTimes.addEvent("start delete");
 #       endif
 
-        for(int txIndex = 0; txIndex < deleteCount; txIndex++)
+        SipTransaction* transaction;
+        while ((transaction = (SipTransaction*) transactionsToBeDeleted.get()))
         {
-            delete transactionsToBeDeleted[txIndex];
+            delete transaction;
 #           ifdef TIME_LOG
             gcTimes.addEvent("transaction deleted");
 #           endif
-       }
+        }
 
 #      ifdef TIME_LOG
        gcTimes.addEvent("finish delete");
 #      endif
-/*
-        while((transactionFound = (SipTransaction*) iterator()))
-        {
-            transactionFound->stopTimers();
-        }
-*/
-       delete[] transactionsToBeDeleted;
-       transactionsToBeDeleted = NULL;
     }
 
 #   ifdef TIME_LOG
@@ -311,121 +463,121 @@ void SipTransactionList::removeOldTransactions(long oldTransaction,
 
 void SipTransactionList::stopTransactionTimers()
 {
-    lock();
-
-    int numTransactions = mTransactions.entries();
-    if(numTransactions > 0)
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        UtlHashBagIterator iterator(mTransactions);
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
+
+        UtlHashBagIterator iterator(stripe.mTransactions);
         SipTransaction* transactionFound = NULL;
 
         while((transactionFound = (SipTransaction*) iterator()))
         {
             transactionFound->stopTimers();
         }
-    }
 
-    unlock();
+        stripe.unlock();
+    }
 }
 
 void SipTransactionList::startTransactionTimers()
 {
-    lock();
-
-    int numTransactions = mTransactions.entries();
-    if(numTransactions > 0)
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        UtlHashBagIterator iterator(mTransactions);
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
+
+        UtlHashBagIterator iterator(stripe.mTransactions);
         SipTransaction* transactionFound = NULL;
 
         while((transactionFound = (SipTransaction*) iterator()))
         {
             transactionFound->startTimers();
         }
-    }
 
-    unlock();
+        stripe.unlock();
+    }
 }
 
 void SipTransactionList::deleteTransactionTimers()
 {
-    lock();
-
-    int numTransactions = mTransactions.entries();
-    if(numTransactions > 0)
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        UtlHashBagIterator iterator(mTransactions);
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
+
+        UtlHashBagIterator iterator(stripe.mTransactions);
         SipTransaction* transactionFound = NULL;
 
         while((transactionFound = (SipTransaction*) iterator()))
         {
             transactionFound->deleteTimers();
         }
-    }
 
-    unlock();
+        stripe.unlock();
+    }
 }
 
 void SipTransactionList::toString(UtlString& string)
 {
-    lock();
-
     string.remove(0);
 
-    UtlHashBagIterator iterator(mTransactions);
-    SipTransaction* transactionFound = NULL;
     UtlString oneTransactionString;
 
-    while((transactionFound = (SipTransaction*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        transactionFound->toString(oneTransactionString, FALSE);
-        string.append(oneTransactionString);
-        oneTransactionString.remove(0);
-    }
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
+
+        UtlHashBagIterator iterator(stripe.mTransactions);
+        SipTransaction* transactionFound = NULL;
 
-    unlock();
+        while((transactionFound = (SipTransaction*) iterator()))
+        {
+            transactionFound->toString(oneTransactionString, FALSE);
+            string.append(oneTransactionString);
+            oneTransactionString.remove(0);
+        }
+
+        stripe.unlock();
+    }
 }
 
 void SipTransactionList::toStringWithRelations(UtlString& string,
                                                SipMessage& message,
                                                UtlBoolean isOutGoing)
 {
-    lock();
-
     string.remove(0);
 
-    UtlHashBagIterator iterator(mTransactions);
-    SipTransaction* transactionFound = NULL;
     UtlString oneTransactionString;
     SipTransaction::messageRelationship relation;
     UtlString relationString;
 
-    while((transactionFound = (SipTransaction*) iterator()))
+    for (int i = 0; i < NUM_STRIPES; i++)
     {
-        relation = transactionFound->whatRelation(message, isOutGoing);
-        SipTransaction::getRelationshipString(relation, relationString);
-        string.append(relationString);
-        string.append(" ");
+        SipTransactionStripe& stripe = mpStripes[i];
+        stripe.lock();
 
+        UtlHashBagIterator iterator(stripe.mTransactions);
+        SipTransaction* transactionFound = NULL;
 
-        transactionFound->toString(oneTransactionString, FALSE);
-        string.append(oneTransactionString);
-        oneTransactionString.remove(0);
+        while((transactionFound = (SipTransaction*) iterator()))
+        {
+            relation = transactionFound->whatRelation(message, isOutGoing);
+            SipTransaction::getRelationshipString(relation, relationString);
+            string.append(relationString);
+            string.append(" ");
 
-        string.append("\n");
-    }
 
-    unlock();
-}
+            transactionFound->toString(oneTransactionString, FALSE);
+            string.append(oneTransactionString);
+            oneTransactionString.remove(0);
 
-void SipTransactionList::lock()
-{
-    mListMutex.acquire();
-}
+            string.append("\n");
+        }
 
-void SipTransactionList::unlock()
-{
-    mListMutex.release();
+        stripe.unlock();
+    }
 }
 
 UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
@@ -434,12 +586,13 @@ UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
     UtlBoolean exists;
     UtlBoolean busy = FALSE;
     int numTries = 0;
+    SipTransactionStripe& stripe = getStripe(hash);
 
     do
     {
         numTries++;
 
-        lock();
+        stripe.lock();
         exists = transactionExists(transaction, hash);
 
         if(exists)
@@ -448,7 +601,7 @@ UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
             if(!busy)
             {
                 transaction->markBusy();
-                unlock();
+                stripe.unlock();
 //#ifdef TEST_PRINT
                 OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipTransactionList::waitUntilAvailable %p locked after %d tries\n",
                     transaction, numTries);
@@ -462,7 +615,7 @@ UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
                 transaction->notifyWhenAvailable(waitEvent);
 
                 // Must unlock while we wait or there is a dead lock
-                unlock();
+                stripe.unlock();
 
 //#ifdef TEST_PRINT
                 OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipTransactionList::waitUntilAvailable %p waiting on: %p after %d tries\n",
@@ -521,7 +674,7 @@ UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
         }
         else
         {
-            unlock();
+            stripe.unlock();
 //#ifdef TEST_PRINT
             OsSysLog::add(FAC_SIP, PRI_DEBUG, "SipTransactionList::waitUntilAvailable %p gone after %d tries\n",
                     transaction, numTries);
@@ -535,7 +688,8 @@ UtlBoolean SipTransactionList::waitUntilAvailable(SipTransaction* transaction,
 
 void SipTransactionList::markAvailable(SipTransaction& transaction)
 {
-    lock();
+    SipTransactionStripe& stripe = getStripe(transaction);
+    stripe.lock();
 
     if(!transaction.isBusy())
     {
@@ -549,11 +703,23 @@ void SipTransactionList::markAvailable(SipTransaction& transaction)
         transaction.markAvailable();
     }
 
-    unlock();
+    stripe.unlock();
 }
 
 /* ============================ ACCESSORS ================================= */
 
+int SipTransactionList::getTransactionCount()
+{
+    int count = 0;
+    for (int i = 0; i < NUM_STRIPES; i++)
+    {
+        mpStripes[i].lock();
+        count += mpStripes[i].mTransactions.entries();
+        mpStripes[i].unlock();
+    }
+    return count;
+}
+
 /* ============================ INQUIRY =================================== */
 
 UtlBoolean SipTransactionList::transactionExists(const SipTransaction* transaction,
@@ -562,7 +728,7 @@ UtlBoolean SipTransactionList::transactionExists(const SipTransaction* transacti
     UtlBoolean foundTransaction = FALSE;
     SipTransaction* aTransaction = NULL;
     UtlString matchTransaction(hash);
-    UtlHashBagIterator iterator(mTransactions, &matchTransaction);
+    UtlHashBagIterator iterator(getStripe(hash).mTransactions, &matchTransaction);
 
     while ((aTransaction = (SipTransaction*) iterator()))
     {
@@ -584,6 +750,35 @@ UtlBoolean SipTransactionList::transactionExists(const SipTransaction* transacti
 
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
+SipTransactionStripe& SipTransactionList::getStripe(const UtlString& hash)
+{
+    return mpStripes[getCallIdHash(hash) % NUM_STRIPES];
+}
+
+unsigned SipTransactionList::getCallIdHash(const UtlString& hash)
+{
+    // The hash is the Call-Id, 's' or 'c' and the CSeq number.  Only the
+    // Call-Id is used, so a server transaction and the client transactions
+    // it forwards to stay together.
+    const char* data = hash.data();
+    size_t length = hash.length();
+    while (length > 0 && data[length - 1] >= '0' && data[length - 1] <= '9')
+    {
+        length--;
+    }
+    if (length > 0)
+    {
+        length--;
+    }
+
+    unsigned callIdHash = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        callIdHash = callIdHash * 31 + (unsigned char) data[i];
+    }
+    return callIdHash ^ (callIdHash >> 16);
+}
+
 /* //////////////////////////// PRIVATE /////////////////////////////////// */
 
 /* ============================ FUNCTIONS ================================= */
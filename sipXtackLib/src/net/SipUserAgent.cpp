@@ -2395,8 +2395,14 @@ void SipUserAgent::queueMessageToInterestedObservers(SipMessageEvent& event,
                OsMsgQ* observerQueue = observerCriteria->getObserverQueue();
                void* observerData = observerCriteria->getObserverData();
 
-               // Cheat a little and set the observer data to be passed back
-               ((SipMessage*) message)->setResponseListenerData(observerData);
+               // Set the observer data to be passed back.  Observers get
+               // copies of the event which share the message, so it only
+               // gets copied when the data differs from the last observer's.
+               if (message->getResponseListenerData() != observerData)
+               {
+                  event.getWritableMessage()->setResponseListenerData(observerData);
+                  message = event.getMessage();
+               }
 
                // Put the message in the observers queue
                if (!mbShuttingDown)
@@ -12,6 +12,7 @@
 
 // SYSTEM INCLUDES
 #include <assert.h>
+#include <string.h>
 
 #ifdef __pingtel_on_posix__
 #include <stdlib.h>
@@ -196,6 +197,343 @@ const RegEx AllDigits("^\\+?[0-9*]++$");
 // The end of the value (allowing optional whitespace)
 const RegEx TheEnd("^" SWS "$");
 
+/* =========================================================================
+ * URL scanner
+ *   The following functions are used by Url::scanString instead of the
+ *   regular expressions above.  Each of them matches exactly what the
+ *   regular expression it is named after matches, so that both parsers
+ *   produce the same components.  If you change one, change the other.
+ * ========================================================================= */
+
+// \s
+static inline bool isUrlSpace(char c)
+{
+   return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// [a-zA-Z0-9]
+static inline bool isUrlAlnum(char c)
+{
+   return (   (c >= 'a' && c <= 'z')
+           || (c >= 'A' && c <= 'Z')
+           || (c >= '0' && c <= '9'));
+}
+
+// [0-9a-fA-F]
+static inline bool isUrlHex(char c)
+{
+   return (   (c >= '0' && c <= '9')
+           || (c >= 'a' && c <= 'f')
+           || (c >= 'A' && c <= 'F'));
+}
+
+// SIP_TOKEN characters
+static inline bool isUrlTokenChar(char c)
+{
+   if (isUrlAlnum(c))
+   {
+      return true;
+   }
+   switch (c)
+   {
+   case '.': case '!': case '%': case '*': case '#': case '_':
+   case '+': case '`': case '\'': case '~': case '-':
+      return true;
+   default:
+      return false;
+   }
+}
+
+// Password characters of UsernameAndPassword
+static bool isUrlPasswordChar(char c)
+{
+   if (isUrlAlnum(c))
+   {
+      return true;
+   }
+   switch (c)
+   {
+   case '_': case '.': case '!': case '~': case '*': case '#': case '\'':
+   case '(': case ')': case '&': case '=': case '+': case '$': case ',':
+   case '-':
+      return true;
+   default:
+      return false;
+   }
+}
+
+// User characters of UsernameAndPassword
+static bool isUrlUserChar(char c)
+{
+   return isUrlPasswordChar(c) || c == ';' || c == '?' || c == '/';
+}
+
+static inline int skipUrlSpace(const char* s, int i)
+{
+   while (isUrlSpace(s[i]))
+   {
+      i++;
+   }
+   return i;
+}
+
+// (?:[chars]++|%[0-9a-fA-F]{2})* - returns the offset past the run
+static int skipUrlEscapedRun(const char* s, int i, bool (*isChar)(char))
+{
+   for (;;)
+   {
+      if (isChar(s[i]))
+      {
+         i++;
+      }
+      else if (s[i] == '%' && isUrlHex(s[i+1]) && isUrlHex(s[i+2]))
+      {
+         i += 3;
+      }
+      else
+      {
+         return i;
+      }
+   }
+}
+
+// DisplayName - like the regular expression, this searches the whole string
+//    nameStart and nameEnd delimit the token sequence or the quoted string,
+//    including its quotes.
+//    Note that in the regular expression SLASH DQUOTE is just an escaped
+//    quote, so the quoted string may contain quotes and ends at the last
+//    quote followed by the '<'.
+static bool scanDisplayName(const char* s, int& nameStart, int& nameEnd)
+{
+   bool quoteTried = false;
+   int i = 0;
+   while (s[i])
+   {
+      if (isUrlTokenChar(s[i]))
+      {
+         // SIP_TOKEN (?:LWS SIP_TOKEN)*
+         int start = i;
+         int end;
+         do
+         {
+            while (isUrlTokenChar(s[i]))
+            {
+               i++;
+            }
+            end = i;
+            i = skipUrlSpace(s, i);
+         } while (isUrlTokenChar(s[i]));
+
+         if (s[i] == '<')
+         {
+            nameStart = start;
+            nameEnd = end;
+            return true;
+         }
+
+         // A match starting at any later token of this sequence would
+         // end at the same place, so skip them all.
+         i = end;
+      }
+      else if (s[i] == '"' && !quoteTried)
+      {
+         // If the first quote does not start a match, no later one does.
+         quoteTried = true;
+         int closingQuote = -1;
+         for (int j = i + 1; s[j]; j++)
+         {
+            if (s[j] == '"' && s[skipUrlSpace(s, j + 1)] == '<')
+            {
+               closingQuote = j;
+            }
+         }
+
+         if (closingQuote >= 0)
+         {
+            nameStart = i;
+            nameEnd = closingQuote + 1;
+            return true;
+         }
+         i++;
+      }
+      else
+      {
+         i++;
+      }
+   }
+   return false;
+}
+
+// AngleBrackets - searches from offset 'from'
+//    contentStart is the first character inside the brackets,
+//    afterBrackets is the offset following the '>'
+static bool scanAngleBrackets(const char* s, int from,
+                              int& contentStart, int& afterBrackets)
+{
+   for (const char* lt = strchr(s + from, '<'); lt; lt = strchr(lt + 1, '<'))
+   {
+      if (lt[1] && lt[1] != '>')
+      {
+         const char* gt = strchr(lt + 2, '>');
+         if (gt)
+         {
+            contentStart = lt + 1 - s;
+            afterBrackets = gt + 1 - s;
+            return true;
+         }
+         return false; // no '>' follows any later '<' either
+      }
+   }
+   return false;
+}
+
+// SupportedScheme - anchored at 'from'
+//    returns UnknownUrlScheme if there is no supported scheme,
+//    otherwise sets 'end' to the offset past the ':'
+static Url::Scheme scanScheme(const char* s, int from, int& end)
+{
+   int i = skipUrlSpace(s, from);
+   for (int scheme = Url::SipUrlScheme;
+        scheme < Url::NUM_SUPPORTED_URL_SCHEMES;
+        scheme++)
+   {
+      size_t length = strlen(SchemeName[scheme]);
+      if (strncasecmp(s + i, SchemeName[scheme], length) == 0)
+      {
+         int j = skipUrlSpace(s, i + length);
+         if (s[j] == ':')
+         {
+            end = j + 1;
+            return static_cast<Url::Scheme>(scheme);
+         }
+      }
+   }
+   return Url::UnknownUrlScheme;
+}
+
+// UsernameAndPassword - anchored at 'from'
+//    passwordStart is -1 if there is no ':' password part,
+//    'end' is the offset past the '@'
+static bool scanUserInfo(const char* s, int from, int& userEnd,
+                         int& passwordStart, int& end)
+{
+   int i = skipUrlEscapedRun(s, from, isUrlUserChar);
+   if (i == from)
+   {
+      return false;
+   }
+   userEnd = i;
+
+   passwordStart = -1;
+   if (s[i] == ':')
+   {
+      passwordStart = i + 1;
+      i = skipUrlEscapedRun(s, passwordStart, isUrlPasswordChar);
+   }
+
+   if (s[i] != '@')
+   {
+      return false;
+   }
+   end = i + 1;
+   return true;
+}
+
+// HostAndPort - anchored at 'from'
+//    portStart is -1 if there is no port, 'end' is the offset past the match
+static bool scanHostAndPort(const char* s, int from, int& hostEnd,
+                            int& portStart, int& end)
+{
+   int i = from;
+   if (isUrlAlnum(s[i]))
+   {
+      // DNS name; an IPv4 address is matched by this as well
+      for (;;)
+      {
+         int labelEnd = i; // past the last alphanumeric of the label
+         int j = i;
+         while (isUrlAlnum(s[j]) || s[j] == '-')
+         {
+            j++;
+            if (s[j-1] != '-')
+            {
+               labelEnd = j;
+            }
+         }
+
+         if (labelEnd == j && s[j] == '.')
+         {
+            i = j + 1;
+            if (!isUrlAlnum(s[i]))
+            {
+               break; // the name ends with the '.'
+            }
+         }
+         else
+         {
+            i = labelEnd;
+            break;
+         }
+      }
+   }
+   else if (s[i] == '[')
+   {
+      // IPv6 address
+      int j = i + 1;
+      while (isUrlHex(s[j]) || s[j] == ':' || s[j] == '.')
+      {
+         j++;
+      }
+      if (j == i + 1 || s[j] != ']')
+      {
+         return false;
+      }
+      i = j + 1;
+   }
+   else
+   {
+      return false;
+   }
+   hostEnd = i;
+
+   portStart = -1;
+   if (s[i] == ':' && s[i+1] >= '0' && s[i+1] <= '9')
+   {
+      portStart = ++i;
+      while (i < portStart + 6 && s[i] >= '0' && s[i] <= '9')
+      {
+         i++;
+      }
+   }
+   end = i;
+   return true;
+}
+
+// FieldParams - anchored at 'from'
+//    paramsStart and paramsEnd delimit the parameters without the ';'
+static bool scanFieldParams(const char* s, int from,
+                            int& paramsStart, int& paramsEnd)
+{
+   int i = skipUrlSpace(s, from);
+   if (s[i] != ';')
+   {
+      return false;
+   }
+   int j = ++i;
+   while (s[j] && s[j] != '\n')
+   {
+      j++;
+   }
+   // '.' does not match a newline, but '$' matches before a final one
+   if (j == i || (s[j] == '\n' && s[j+1]))
+   {
+      return false;
+   }
+   paramsStart = i;
+   paramsEnd = j;
+   return true;
+}
+
 // STATIC VARIABLE INITIALIZATIONS
 
 /* //////////////////////////// PUBLIC //////////////////////////////////// */
@@ -1239,6 +1577,206 @@ UtlBoolean Url::isIncludeAngleBracketsSet() const
 /* //////////////////////////// PROTECTED ///////////////////////////////// */
 
 void Url::parseString(const char* urlString, UtlBoolean isAddrSpec)
+{
+#  ifdef URL_REGEX_PARSER
+   parseStringRegEx(urlString, isAddrSpec);
+#  else
+   scanString(urlString, isAddrSpec);
+#  endif
+}
+
+void Url::scanString(const char* urlString, UtlBoolean isAddrSpec)
+{
+   // This follows parseStringRegEx step by step; see the comments there.
+   const char* s = urlString;
+
+   if (isAddrSpec && (s[0] == '<' || s[0] == '"'))
+   {
+      OsSysLog::add(FAC_SIP, PRI_ERR,
+                    "Url::scanString Invalid addr-spec found (probably name-addr format): '%s'",
+                    urlString);
+   }
+
+   int workingOffset = 0;
+   int afterAngleBrackets = -1;
+
+   if (isAddrSpec)
+   {
+      mAngleBracketsIncluded = FALSE;
+   }
+   else
+   {
+      mDisplayName.remove(0);
+      int nameStart;
+      int nameEnd;
+      if (scanDisplayName(s, nameStart, nameEnd))
+      {
+         mDisplayName.append(s + nameStart, nameEnd - nameStart);
+         workingOffset = nameEnd;
+      }
+
+      int contentStart;
+      if (scanAngleBrackets(s, workingOffset, contentStart, afterAngleBrackets))
+      {
+         workingOffset = contentStart;
+      }
+   }
+
+   // Parse the scheme, the same AMBIGUITY applies as in parseStringRegEx
+   mScheme = scanScheme(s, workingOffset, workingOffset);
+
+   switch (mScheme)
+   {
+   case FileUrlScheme:
+   case FtpUrlScheme:
+   case HttpUrlScheme:
+   case HttpsUrlScheme:
+   case RtspUrlScheme:
+      if (s[workingOffset] == '/' && s[workingOffset+1] == '/')
+      {
+         workingOffset += 2;
+      }
+      break;
+
+   default:
+      break;
+   }
+
+   if (FileUrlScheme != mScheme) // no user part in file urls
+   {
+      int userEnd;
+      int passwordStart;
+      int end;
+      if (scanUserInfo(s, workingOffset, userEnd, passwordStart, end))
+      {
+         mUserId.append(s + workingOffset, userEnd - workingOffset);
+         if (passwordStart >= 0)
+         {
+            mPassword.append(s + passwordStart, end - 1 - passwordStart);
+         }
+         workingOffset = end;
+      }
+   }
+
+   // Parse the hostname and port
+   int hostEnd;
+   int portStart;
+   int end;
+   if (scanHostAndPort(s, workingOffset, hostEnd, portStart, end))
+   {
+      mHostAddress.append(s + workingOffset, hostEnd - workingOffset);
+      if (portStart >= 0)
+      {
+         mHostPort = 0;
+         for (int i = portStart; i < end; i++)
+         {
+            mHostPort = mHostPort * 10 + (s[i] - '0');
+         }
+      }
+      workingOffset = end;
+
+      if (UnknownUrlScheme == mScheme)
+      {
+         mScheme = SipUrlScheme;
+      }
+   }
+   else if (FileUrlScheme != mScheme) // no host is ok in a file URL
+   {
+      OsSysLog::add(FAC_SIP, PRI_ERR,
+                    "Url::scanString no valid host found at char %d in '%s', "
+                    "isAddrSpec = %d",
+                    workingOffset, urlString, isAddrSpec
+                    );
+      mScheme = UnknownUrlScheme;
+      mDisplayName.remove(0);
+      mUserId.remove(0);
+      mPassword.remove(0);
+   }
+
+   switch (mScheme)
+   {
+   case FileUrlScheme:
+   case FtpUrlScheme:
+   case HttpUrlScheme:
+   case HttpsUrlScheme:
+   case RtspUrlScheme:
+   {
+      // UrlPath
+      int pathEnd = workingOffset;
+      while (s[pathEnd] && s[pathEnd] != '?' && !isUrlSpace(s[pathEnd]))
+      {
+         pathEnd++;
+      }
+      if (pathEnd > workingOffset)
+      {
+         mPath.append(s + workingOffset, pathEnd - workingOffset);
+         workingOffset = pathEnd;
+      }
+   }
+   break;
+
+   case SipUrlScheme:
+   case SipsUrlScheme:
+      if (isAddrSpec || afterAngleBrackets >= 0)
+      {
+         // UrlParams
+         int i = skipUrlSpace(s, workingOffset);
+         if (s[i] == ';')
+         {
+            int paramsEnd = ++i;
+            while (s[paramsEnd] && s[paramsEnd] != '?' && s[paramsEnd] != '>')
+            {
+               paramsEnd++;
+            }
+            if (paramsEnd > i)
+            {
+               mRawUrlParameters.append(s + i, paramsEnd - i);
+               workingOffset = paramsEnd;
+            }
+         }
+      }
+      break;
+
+   default:
+      break;
+   }
+
+   if (UnknownUrlScheme != mScheme)
+   {
+      // HeaderOrQueryParams
+      int i = skipUrlSpace(s, workingOffset);
+      if (s[i] == '?')
+      {
+         int paramsEnd = ++i;
+         while (s[paramsEnd] && s[paramsEnd] != '>')
+         {
+            paramsEnd++;
+         }
+         if (paramsEnd > i)
+         {
+            mRawHeaderOrQueryParameters.append(s + i, paramsEnd - i);
+            workingOffset = s[paramsEnd] == '>' ? paramsEnd + 1 : paramsEnd;
+         }
+      }
+
+      if (!isAddrSpec) // can't have field parameters in an addrspec
+      {
+         if (afterAngleBrackets >= 0)
+         {
+            workingOffset = afterAngleBrackets;
+         }
+
+         int paramsStart;
+         int paramsEnd;
+         if (scanFieldParams(s, workingOffset, paramsStart, paramsEnd))
+         {
+            mRawFieldParameters.append(s + paramsStart, paramsEnd - paramsStart);
+         }
+      }
+   }
+}
+
+void Url::parseStringRegEx(const char* urlString, UtlBoolean isAddrSpec)
 {
    // If isAddrSpec:
    //                userinfo@hostport;uriParameters?headerParameters
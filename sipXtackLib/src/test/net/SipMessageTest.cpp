@@ -15,13 +15,180 @@
 
 #include <utl/UtlHashMap.h>
 #include <os/OsDefs.h>
+#include <os/OsDateTime.h>
 #include <net/SipMessage.h>
+#include <net/SipMessageEvent.h>
+#include <net/SipStreamFramer.h>
 #include <net/SipUserAgent.h>
 
 #if 0
 #include <stdio.h>
 #endif
 
+#if defined(HAVE_SSL) && !defined(_WIN32)
+#define TEST_STREAM_FRAMING_TLS
+#include <os/OsSSLConnectionSocket.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Stream socket which returns the given bytes in segments of limited size.
+ */
+class StreamTestSocket : public OsSocket
+{
+public:
+   StreamTestSocket(const char* bytes, int length, int segmentSize)
+   : mpBytes(bytes)
+   , mLength(length)
+   , mOffset(0)
+   , mSegmentSize(segmentSize)
+   , mNumReads(0)
+   , mClosed(FALSE)
+   {
+   }
+
+   int read(char* buffer, int bufferLength)
+   {
+      int length = sipx_min(sipx_min(bufferLength, mSegmentSize),
+                            mLength - mOffset);
+      memcpy(buffer, mpBytes + mOffset, length);
+      mOffset += length;
+      mNumReads++;
+      return length;
+   }
+
+   int read(char* buffer, int bufferLength, UtlString* ipAddress, int* port)
+   {
+      getRemoteHostIp(ipAddress, port);
+      return read(buffer, bufferLength);
+   }
+
+   void getRemoteHostIp(UtlString* remoteHostAddress, int* remotePort = NULL)
+   {
+      if (remoteHostAddress)
+      {
+         *remoteHostAddress = "192.0.2.1";
+      }
+      if (remotePort)
+      {
+         *remotePort = 5060;
+      }
+   }
+
+   UtlBoolean isReadyToRead(long waitMilliseconds = 0) const
+   {
+      return !mClosed && mOffset < mLength;
+   }
+
+   UtlBoolean isOk() const
+   {
+      return !mClosed;
+   }
+
+   void close()
+   {
+      mClosed = TRUE;
+   }
+
+   OsSocket::IpProtocolSocketType getIpProtocol() const
+   {
+      return OsSocket::TCP;
+   }
+
+   UtlBoolean reconnect()
+   {
+      return FALSE;
+   }
+
+   int getNumReads() const
+   {
+      return mNumReads;
+   }
+
+private:
+   const char* mpBytes;
+   int mLength;
+   int mOffset;
+   int mSegmentSize;
+   int mNumReads;
+   UtlBoolean mClosed;
+};
+
+#ifdef TEST_STREAM_FRAMING_TLS
+/**
+ * Makes an SSL context with a throwaway self-signed certificate.
+ */
+static SSL_CTX* makeTestServerContext()
+{
+   EVP_PKEY* pkey = NULL;
+   EVP_PKEY_CTX* keyCtx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+   EVP_PKEY_keygen_init(keyCtx);
+   EVP_PKEY_CTX_set_rsa_keygen_bits(keyCtx, 2048);
+   EVP_PKEY_keygen(keyCtx, &pkey);
+   EVP_PKEY_CTX_free(keyCtx);
+
+   X509* cert = X509_new();
+   X509_set_version(cert, 2);
+   ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+   X509_gmtime_adj(X509_get_notBefore(cert), 0);
+   X509_gmtime_adj(X509_get_notAfter(cert), 3600);
+   X509_set_pubkey(cert, pkey);
+   X509_NAME* name = X509_get_subject_name(cert);
+   X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                              (const unsigned char*) "localhost", -1, -1, 0);
+   X509_set_issuer_name(cert, name);
+   X509_sign(cert, pkey, EVP_sha256());
+
+   SSL_CTX* ctx = SSL_CTX_new(SSLv23_method());
+   SSL_CTX_use_certificate(ctx, cert);
+   SSL_CTX_use_PrivateKey(ctx, pkey);
+   X509_free(cert);
+   EVP_PKEY_free(pkey);
+   return ctx;
+}
+
+/**
+ * Runs both ends of a TLS handshake over non-blocking sockets.
+ */
+static bool testHandshake(SSL* client, SSL* server)
+{
+   bool clientDone = false;
+   bool serverDone = false;
+   for (int i = 0; i < 1000 && !(clientDone && serverDone); i++)
+   {
+      if (!clientDone)
+      {
+         int result = SSL_connect(client);
+         if (result == 1)
+         {
+            clientDone = true;
+         }
+         else if (SSL_get_error(client, result) != SSL_ERROR_WANT_READ &&
+                  SSL_get_error(client, result) != SSL_ERROR_WANT_WRITE)
+         {
+            return false;
+         }
+      }
+      if (!serverDone)
+      {
+         int result = SSL_accept(server);
+         if (result == 1)
+         {
+            serverDone = true;
+         }
+         else if (SSL_get_error(server, result) != SSL_ERROR_WANT_READ &&
+                  SSL_get_error(server, result) != SSL_ERROR_WANT_WRITE)
+         {
+            return false;
+         }
+      }
+   }
+   return clientDone && serverDone;
+}
+#endif
+
 /**
  * Unittest for SipMessage
  */
@@ -53,6 +220,15 @@ class SipMessageTest : public SIPX_UNIT_BASE_CLASS
       CPPUNIT_TEST(testCompactNames);
       CPPUNIT_TEST(testHeaderFieldAccessors);
       CPPUNIT_TEST(testApplyTargetUriHeaderParams);
+      CPPUNIT_TEST(testIndexedHeaders);
+      CPPUNIT_TEST(testParsePerformance);
+      CPPUNIT_TEST(testStreamFraming);
+      CPPUNIT_TEST(testStreamFramingLimits);
+      CPPUNIT_TEST(testStreamReadPerformance);
+#ifdef TEST_STREAM_FRAMING_TLS
+      CPPUNIT_TEST(testStreamFramingTls);
+#endif
+      CPPUNIT_TEST(testMessageEventSharing);
       CPPUNIT_TEST_SUITE_END();
 
       public:
@@ -1781,6 +1957,526 @@ Content-Length: 0\n\
           }
           CPPUNIT_ASSERT( messageBytes.compareTo(expectedMessage) == 0);
       }
+
+   void testIndexedHeaders()
+      {
+         const char* rawMessage =
+            "INVITE sip:sipx.local SIP/2.0\r\n"
+            "v: SIP/2.0/UDP sipx.remote:5060;branch=z9hG4bK-1\r\n"
+            "Via: SIP/2.0/UDP sipx.proxy:5060;branch=z9hG4bK-2\r\n"
+            "t: sip:sipx.local\r\n"
+            "From: <sip:sipsend@pingtel.org>;tag=30543f34\r\n"
+            "X-Folded: first\r\n"
+            " second\r\n"
+            "i: f88dfabce84b6a27\r\n"
+            "CSeq: 1 INVITE\r\n"
+            "l: 0\r\n"
+            "\r\n";
+
+         UtlBoolean wasIndexing = HttpMessage::isHeaderIndexing();
+         HttpMessage::setHeaderIndexing(TRUE);
+         HttpMessage httpMsg(rawMessage, strlen(rawMessage));
+
+         // Compact names are distinct names in a plain HTTP message
+         CPPUNIT_ASSERT_EQUAL(1, httpMsg.getCountHeaderFields("VIA"));
+         CPPUNIT_ASSERT_EQUAL(1, httpMsg.getCountHeaderFields("v"));
+         ASSERT_STR_EQUAL("sip:sipx.local", httpMsg.getHeaderValue(0, "T"));
+         CPPUNIT_ASSERT(httpMsg.getHeaderValue(0, SIP_TO_FIELD) == NULL);
+         ASSERT_STR_EQUAL("first second", httpMsg.getHeaderValue(0, "x-folded"));
+
+         SipMessage sipMsg(rawMessage, strlen(rawMessage));
+
+         // SipMessage expands compact names
+         CPPUNIT_ASSERT_EQUAL(8, sipMsg.getCountHeaderFields());
+         CPPUNIT_ASSERT_EQUAL(2, sipMsg.getCountHeaderFields(SIP_VIA_FIELD));
+         CPPUNIT_ASSERT_EQUAL(0, sipMsg.getCountHeaderFields("v"));
+         ASSERT_STR_EQUAL("SIP/2.0/UDP sipx.proxy:5060;branch=z9hG4bK-2",
+                          sipMsg.getHeaderValue(1, "via"));
+         ASSERT_STR_EQUAL("f88dfabce84b6a27",
+                          sipMsg.getHeaderValue(0, SIP_CALLID_FIELD));
+         ASSERT_STR_EQUAL("1 INVITE", sipMsg.getHeaderValue(6));
+         CPPUNIT_ASSERT(sipMsg.getHeaderValue(8) == NULL);
+
+         // Replacing a value keeps the other headers in place
+         sipMsg.setHeaderValue(SIP_CSEQ_FIELD, "2 INVITE");
+         ASSERT_STR_EQUAL("2 INVITE", sipMsg.getHeaderValue(0, SIP_CSEQ_FIELD));
+
+         // Copies and modified messages see the same headers
+         SipMessage copiedMsg(sipMsg);
+         copiedMsg.addViaField("SIP/2.0/TCP sipx.local:5060;branch=z9hG4bK-3");
+         CPPUNIT_ASSERT_EQUAL(3, copiedMsg.getCountHeaderFields(SIP_VIA_FIELD));
+         ASSERT_STR_EQUAL("f88dfabce84b6a27",
+                          copiedMsg.getHeaderValue(0, SIP_CALLID_FIELD));
+         CPPUNIT_ASSERT(copiedMsg.removeHeader(SIP_TO_FIELD, 0));
+         CPPUNIT_ASSERT_EQUAL(0, copiedMsg.getCountHeaderFields(SIP_TO_FIELD));
+         CPPUNIT_ASSERT_EQUAL(1, sipMsg.getCountHeaderFields(SIP_TO_FIELD));
+
+         // Serialization is the same in both modes
+         UtlString indexedBytes;
+         UtlString listBytes;
+         int length;
+         sipMsg.getBytes(&indexedBytes, &length);
+
+         HttpMessage::setHeaderIndexing(FALSE);
+         SipMessage listMsg(rawMessage, strlen(rawMessage));
+         HttpMessage::setHeaderIndexing(wasIndexing);
+         listMsg.setHeaderValue(SIP_CSEQ_FIELD, "2 INVITE");
+         listMsg.getBytes(&listBytes, &length);
+         ASSERT_STR_EQUAL(listBytes.data(), indexedBytes.data());
+      }
+
+   // Parse messages and look up the headers a stack typically reads
+   // when a request arrives.  Return number of messages per second.
+   double parseMessages(const char* rawMessage, int numMessages)
+      {
+         static const char* lookups[] =
+         {
+            SIP_VIA_FIELD, SIP_FROM_FIELD, SIP_TO_FIELD, SIP_CALLID_FIELD,
+            SIP_CSEQ_FIELD, SIP_CONTACT_FIELD, SIP_MAX_FORWARDS_FIELD,
+            SIP_ROUTE_FIELD, SIP_EVENT_FIELD, HTTP_CONTENT_LENGTH_FIELD
+         };
+         int numLookups = sizeof(lookups)/sizeof(lookups[0]);
+         int rawLength = strlen(rawMessage);
+         int found = 0;
+
+         OsTime start;
+         OsTime elapsed;
+         OsDateTime::getCurTime(start);
+         for (int i = 0; i < numMessages; i++)
+         {
+            SipMessage message(rawMessage, rawLength);
+            for (int j = 0; j < numLookups; j++)
+            {
+               if (message.getHeaderValue(0, lookups[j]))
+               {
+                  found++;
+               }
+            }
+         }
+         OsDateTime::getCurTime(elapsed);
+         elapsed -= start;
+
+         CPPUNIT_ASSERT_EQUAL(9 * numMessages, found);
+         double seconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+         return seconds > 0 ? numMessages / seconds : 0;
+      }
+
+   void testParsePerformance()
+      {
+         const char* rawMessage =
+            "INVITE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/UDP pc33.atlanta.example.com;branch=z9hG4bK776asdhds\r\n"
+            "Via: SIP/2.0/UDP proxy.atlanta.example.com;branch=z9hG4bK7e2f1a\r\n"
+            "Max-Forwards: 69\r\n"
+            "To: Bob <sip:bob@biloxi.example.com>\r\n"
+            "From: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+            "CSeq: 314159 INVITE\r\n"
+            "Contact: <sip:alice@pc33.atlanta.example.com>\r\n"
+            "Record-Route: <sip:proxy.atlanta.example.com;lr>\r\n"
+            "Allow: INVITE, ACK, CANCEL, OPTIONS, BYE, REFER, NOTIFY\r\n"
+            "Supported: replaces, timer\r\n"
+            "User-Agent: sipXtapi\r\n"
+            "o: dialog\r\n"
+            "Content-Type: application/sdp\r\n"
+            "Content-Length: 142\r\n"
+            "\r\n"
+            "v=0\r\n"
+            "o=alice 2890844526 2890844526 IN IP4 pc33.atlanta.example.com\r\n"
+            "s=-\r\n"
+            "c=IN IP4 192.0.2.101\r\n"
+            "t=0 0\r\n"
+            "m=audio 49172 RTP/AVP 0\r\n"
+            "a=rtpmap:0 PCMU/8000\r\n";
+         const int numMessages = 20000;
+
+         UtlBoolean wasIndexing = HttpMessage::isHeaderIndexing();
+
+         HttpMessage::setHeaderIndexing(FALSE);
+         double listRate = parseMessages(rawMessage, numMessages);
+         HttpMessage::setHeaderIndexing(TRUE);
+         double indexedRate = parseMessages(rawMessage, numMessages);
+
+         HttpMessage::setHeaderIndexing(wasIndexing);
+
+         printf("SipMessageTest::testParsePerformance "
+                "list %.0f msgs/sec, indexed %.0f msgs/sec\n",
+                listRate, indexedRate);
+      }
+
+   void testStreamFraming()
+      {
+         const char* messages[] =
+         {
+            "OPTIONS sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/TCP pc33.atlanta.example.com;branch=z9hG4bK776asdhds\r\n"
+            "To: <sip:bob@biloxi.example.com>\r\n"
+            "From: <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "Call-ID: a84b4c76e66710\r\n"
+            "CSeq: 1 OPTIONS\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n",
+
+            "MESSAGE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "v: SIP/2.0/TCP pc33.atlanta.example.com;branch=z9hG4bK776asdhdt\r\n"
+            "t: <sip:bob@biloxi.example.com>\r\n"
+            "f: <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "i: a84b4c76e66711\r\n"
+            "CSeq: 2 MESSAGE\r\n"
+            "c: text/plain\r\n"
+            "l: 14\r\n"
+            "\r\n"
+            "Hello\r\n\r\nBob!\n",
+
+            "SIP/2.0 200 OK\n"
+            "Via: SIP/2.0/TCP pc33.atlanta.example.com;branch=z9hG4bK776asdhdt\n"
+            "To: <sip:bob@biloxi.example.com>;tag=abc\n"
+            "From: <sip:alice@atlanta.example.com>;tag=1928301774\n"
+            "Call-ID: a84b4c76e66711\n"
+            "CSeq: 2 MESSAGE\n"
+            "l: 99\n"
+            "content-length  :  3\n"
+            "Content-Type: text/plain\n"
+            "\n"
+            "abc"
+         };
+         const int numMessages = sizeof(messages)/sizeof(messages[0]);
+
+         // Messages are pipelined, with CRLF keep-alives between them
+         UtlString stream("\r\n\r\n");
+         for (int i = 0; i < numMessages; i++)
+         {
+            stream.append(messages[i]);
+            stream.append("\r\n");
+         }
+
+         // Deliver the stream in two parts, split at every possible offset
+         for (size_t split = 0; split <= stream.length(); split++)
+         {
+            SipStreamFramer framer(16);
+            const char* messageBytes;
+            int found = 0;
+
+            framer.append(stream.data(), split);
+            int length;
+            while ((length = framer.nextMessage(messageBytes)) > 0)
+            {
+               ASSERT_STR_EQUAL(messages[found], UtlString(messageBytes, length).data());
+               found++;
+            }
+            CPPUNIT_ASSERT_EQUAL(0, length);
+
+            framer.append(stream.data() + split, stream.length() - split);
+            while ((length = framer.nextMessage(messageBytes)) > 0)
+            {
+               ASSERT_STR_EQUAL(messages[found], UtlString(messageBytes, length).data());
+               found++;
+            }
+            CPPUNIT_ASSERT_EQUAL(0, length);
+            CPPUNIT_ASSERT_EQUAL(numMessages, found);
+            CPPUNIT_ASSERT_EQUAL(0, framer.getBufferedLength());
+         }
+
+         // Read from a socket in small segments and parse in place
+         StreamTestSocket socket(stream.data(), stream.length(), 7);
+         SipStreamFramer framer;
+         const char* messageBytes;
+         int found = 0;
+         while (socket.isReadyToRead())
+         {
+            int length = framer.readMessage(socket, messageBytes);
+            CPPUNIT_ASSERT(length >= 0);
+            if (length > 0)
+            {
+               SipMessage framed;
+               framed.parseMessage(messageBytes, length);
+               framed.replaceShortFieldNames();
+               SipMessage expected(messages[found]);
+
+               UtlString framedBytes;
+               UtlString expectedBytes;
+               int byteCount;
+               framed.getBytes(&framedBytes, &byteCount);
+               expected.getBytes(&expectedBytes, &byteCount);
+               ASSERT_STR_EQUAL(expectedBytes.data(), framedBytes.data());
+               found++;
+            }
+         }
+         CPPUNIT_ASSERT_EQUAL(numMessages, found);
+         CPPUNIT_ASSERT_EQUAL(socket.getNumReads(), framer.getNumReads());
+      }
+
+   void testStreamFramingLimits()
+      {
+         const char* messageBytes;
+
+         // No Content-Length is taken as no body
+         const char* noLength =
+            "BYE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Call-ID: a84b4c76e66710\r\n"
+            "\r\n";
+         SipStreamFramer framer;
+         framer.append(noLength, strlen(noLength));
+         framer.append(noLength, strlen(noLength));
+         CPPUNIT_ASSERT_EQUAL((int) strlen(noLength), framer.nextMessage(messageBytes));
+         CPPUNIT_ASSERT_EQUAL((int) strlen(noLength), framer.nextMessage(messageBytes));
+         CPPUNIT_ASSERT_EQUAL(0, framer.nextMessage(messageBytes));
+
+         // Too large content closes the socket
+         const char* tooLarge =
+            "BYE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Content-Length: 1001\r\n"
+            "\r\n";
+         StreamTestSocket socket(tooLarge, strlen(tooLarge), 1500);
+         SipStreamFramer smallFramer(HTTP_DEFAULT_SOCKET_BUFFER_SIZE, 1000);
+         CPPUNIT_ASSERT_EQUAL(-1, smallFramer.readMessage(socket, messageBytes));
+         CPPUNIT_ASSERT(!socket.isOk());
+         CPPUNIT_ASSERT_EQUAL(0, smallFramer.getBufferedLength());
+
+         // So does a header block which does not end
+         UtlString endless("INVITE sip:bob@biloxi.example.com SIP/2.0\r\n");
+         while (endless.length() <= 1000)
+         {
+            endless.append("X-Filler: 0123456789\r\n");
+         }
+         StreamTestSocket endlessSocket(endless.data(), endless.length(), 1500);
+         CPPUNIT_ASSERT_EQUAL(-1, smallFramer.readMessage(endlessSocket, messageBytes));
+         CPPUNIT_ASSERT(!endlessSocket.isOk());
+
+         // A closed connection is an error
+         StreamTestSocket closedSocket("", 0, 1500);
+         CPPUNIT_ASSERT_EQUAL(-1, smallFramer.readMessage(closedSocket, messageBytes));
+      }
+
+   void testStreamReadPerformance()
+      {
+         const char* rawMessage =
+            "SUBSCRIBE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/TCP pc33.atlanta.example.com;branch=z9hG4bK776asdhds\r\n"
+            "Max-Forwards: 70\r\n"
+            "To: Bob <sip:bob@biloxi.example.com>\r\n"
+            "From: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+            "CSeq: 314159 SUBSCRIBE\r\n"
+            "Contact: <sip:alice@pc33.atlanta.example.com;transport=tcp>\r\n"
+            "Event: dialog\r\n"
+            "Accept: application/dialog-info+xml\r\n"
+            "Expires: 3600\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 32\r\n"
+            "\r\n"
+            "0123456789abcdef0123456789abcdef";
+         const int numMessages = 5000;
+         const int segmentSize = 1460; // typical TCP segment
+
+         UtlString stream;
+         for (int i = 0; i < numMessages; i++)
+         {
+            stream.append(rawMessage);
+         }
+
+         // What SipClient did: HttpMessage::read() into a UtlString,
+         // then remove the message from its front
+         int found = 0;
+         OsTime start;
+         OsTime elapsed;
+         StreamTestSocket readSocket(stream.data(), stream.length(), segmentSize);
+         UtlString buffer;
+         OsDateTime::getCurTime(start);
+         for (int i = 0; i < numMessages; i++)
+         {
+            SipMessage message;
+            int length = message.read(&readSocket, HTTP_DEFAULT_SOCKET_BUFFER_SIZE, &buffer);
+            if (length > 0 && message.getHeaderValue(0, SIP_CSEQ_FIELD))
+            {
+               found++;
+            }
+            buffer.remove(0, length);
+         }
+         OsDateTime::getCurTime(elapsed);
+         elapsed -= start;
+         CPPUNIT_ASSERT_EQUAL(numMessages, found);
+         double readSeconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+
+         found = 0;
+         StreamTestSocket framerSocket(stream.data(), stream.length(), segmentSize);
+         SipStreamFramer framer;
+         OsDateTime::getCurTime(start);
+         while (found < numMessages && framerSocket.isOk())
+         {
+            const char* messageBytes;
+            int length = framer.readMessage(framerSocket, messageBytes);
+            if (length > 0)
+            {
+               SipMessage message;
+               message.parseMessage(messageBytes, length);
+               if (message.getHeaderValue(0, SIP_CSEQ_FIELD))
+               {
+                  found++;
+               }
+            }
+         }
+         OsDateTime::getCurTime(elapsed);
+         elapsed -= start;
+         CPPUNIT_ASSERT_EQUAL(numMessages, found);
+         double framerSeconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+
+         printf("SipMessageTest::testStreamReadPerformance "
+                "read %.0f msgs/sec (%.2f reads/msg), "
+                "framer %.0f msgs/sec (%.2f reads/msg)\n",
+                readSeconds > 0 ? numMessages / readSeconds : 0,
+                readSocket.getNumReads() / (double) numMessages,
+                framerSeconds > 0 ? numMessages / framerSeconds : 0,
+                framerSocket.getNumReads() / (double) numMessages);
+      }
+
+#ifdef TEST_STREAM_FRAMING_TLS
+   void testStreamFramingTls()
+      {
+         // A message sent as one TLS record larger than the framer's first
+         // read: the rest of the record is left decrypted inside SSL, with
+         // nothing more arriving on the socket.
+         UtlString rawMessage(
+            "MESSAGE sip:bob@biloxi.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/TLS pc33.atlanta.example.com;branch=z9hG4bK776asdhds\r\n"
+            "To: <sip:bob@biloxi.example.com>\r\n"
+            "From: <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "Call-ID: a84b4c76e66710\r\n"
+            "CSeq: 1 MESSAGE\r\n"
+            "Content-Type: text/plain\r\n");
+         const int bodyLength = 14000;
+         char lengthHeader[40];
+         sprintf(lengthHeader, "Content-Length: %d\r\n\r\n", bodyLength);
+         rawMessage.append(lengthHeader);
+         for (int i = 0; i < bodyLength; i++)
+         {
+            rawMessage.append((char) ('a' + i % 26));
+         }
+
+         SSL_library_init();
+         SSL_CTX* serverCtx = makeTestServerContext();
+         SSL_CTX* clientCtx = SSL_CTX_new(SSLv23_method());
+         CPPUNIT_ASSERT(serverCtx != NULL && clientCtx != NULL);
+
+         int fds[2];
+         CPPUNIT_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+         fcntl(fds[0], F_SETFL, O_NONBLOCK);
+         fcntl(fds[1], F_SETFL, O_NONBLOCK);
+         SSL* client = SSL_new(clientCtx);
+         SSL* server = SSL_new(serverCtx);
+         SSL_set_fd(client, fds[0]);
+         SSL_set_fd(server, fds[1]);
+         CPPUNIT_ASSERT(testHandshake(client, server));
+         fcntl(fds[0], F_SETFL, 0);
+         fcntl(fds[1], F_SETFL, 0);
+
+         CPPUNIT_ASSERT_EQUAL((int) rawMessage.length(),
+                              SSL_write(client, rawMessage.data(), rawMessage.length()));
+
+         {
+            // The socket takes over the server SSL and descriptor
+            OsSSLConnectionSocket socket(server, fds[1]);
+            SipStreamFramer framer(4096);
+            const char* messageBytes;
+            int length = framer.readMessage(socket, messageBytes);
+            CPPUNIT_ASSERT_EQUAL((int) rawMessage.length(), length);
+            ASSERT_STR_EQUAL(rawMessage.data(),
+                             UtlString(messageBytes, rawMessage.length()).data());
+            CPPUNIT_ASSERT(framer.getNumReads() > 1);
+         }
+
+         SSL_free(client);
+         close(fds[0]);
+         SSL_CTX_free(clientCtx);
+         SSL_CTX_free(serverCtx);
+      }
+#endif
+
+   void testMessageEventSharing()
+      {
+         const char* rawMessage =
+            "NOTIFY sip:alice@pc33.atlanta.example.com SIP/2.0\r\n"
+            "Via: SIP/2.0/UDP biloxi.example.com;branch=z9hG4bK776asdhds\r\n"
+            "To: Alice <sip:alice@atlanta.example.com>;tag=1928301774\r\n"
+            "From: Bob <sip:bob@biloxi.example.com>;tag=a6c85cf\r\n"
+            "Call-ID: a84b4c76e66710@pc33.atlanta.example.com\r\n"
+            "CSeq: 2 NOTIFY\r\n"
+            "Event: dialog\r\n"
+            "Subscription-State: active;expires=3599\r\n"
+            "Content-Type: application/dialog-info+xml\r\n"
+            "Content-Length: 32\r\n"
+            "\r\n"
+            "0123456789abcdef0123456789abcdef";
+         const int numObservers = 3;
+
+         SipMessageEvent event(new SipMessage(rawMessage), SipMessageEvent::APPLICATION);
+         CPPUNIT_ASSERT(!event.isMessageShared());
+
+         // Each observer gets a copy of the event sharing the same message
+         SipMessageEvent* copies[numObservers];
+         int i;
+         for (i = 0; i < numObservers; i++)
+         {
+            copies[i] = (SipMessageEvent*) event.createCopy();
+            CPPUNIT_ASSERT(copies[i]->getMessage() == event.getMessage());
+            CPPUNIT_ASSERT_EQUAL(SipMessageEvent::APPLICATION,
+                                 copies[i]->getMessageStatus());
+         }
+         CPPUNIT_ASSERT(event.isMessageShared());
+
+         // Changing the message of one event does not change the others
+         const SipMessage* sharedMessage = event.getMessage();
+         int observerData = 0;
+         copies[0]->getWritableMessage()->setResponseListenerData(&observerData);
+         CPPUNIT_ASSERT(copies[0]->getMessage() != sharedMessage);
+         CPPUNIT_ASSERT(!copies[0]->isMessageShared());
+         CPPUNIT_ASSERT(copies[0]->getMessage()->getResponseListenerData() == &observerData);
+         CPPUNIT_ASSERT(sharedMessage->getResponseListenerData() == NULL);
+         CPPUNIT_ASSERT(copies[1]->getMessage() == sharedMessage);
+
+         UtlString bytes;
+         UtlString sharedBytes;
+         int length;
+         copies[0]->getMessage()->getBytes(&bytes, &length);
+         sharedMessage->getBytes(&sharedBytes, &length);
+         ASSERT_STR_EQUAL(sharedBytes.data(), bytes.data());
+
+         // The shared message lives until the last event using it is gone
+         delete copies[0];
+         delete copies[1];
+         CPPUNIT_ASSERT(event.isMessageShared());
+         delete copies[2];
+         CPPUNIT_ASSERT(!event.isMessageShared());
+         CPPUNIT_ASSERT(event.getWritableMessage() == sharedMessage);
+
+         // Fan-out cost: sharing against copying the message per observer
+         const int numEvents = 20000;
+         OsTime start;
+         OsTime elapsed;
+         OsDateTime::getCurTime(start);
+         for (i = 0; i < numEvents; i++)
+         {
+            OsMsg* copy = event.createCopy();
+            delete copy;
+         }
+         OsDateTime::getCurTime(elapsed);
+         elapsed -= start;
+         double shareSeconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+
+         OsDateTime::getCurTime(start);
+         for (i = 0; i < numEvents; i++)
+         {
+            SipMessageEvent copy(new SipMessage(*event.getMessage()));
+         }
+         OsDateTime::getCurTime(elapsed);
+         elapsed -= start;
+         double copySeconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+
+         printf("SipMessageTest::testMessageEventSharing "
+                "shared %.0f events/sec, copied %.0f events/sec\n",
+                shareSeconds > 0 ? numEvents / shareSeconds : 0,
+                copySeconds > 0 ? numEvents / copySeconds : 0);
+      }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SipMessageTest);
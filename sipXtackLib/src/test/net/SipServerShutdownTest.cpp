@@ -16,6 +16,7 @@
 #include <os/OsDefs.h>
 #include <os/OsTimerTask.h>
 #include <os/OsProcess.h>
+#include <os/OsConnectionSocket.h>
 #include <net/SipMessage.h>
 #include <net/SipUserAgent.h>
 #include <net/SipLineMgr.h>
@@ -23,6 +24,7 @@
 #include <net/SipTcpServer.h>
 
 #define SIP_SHUTDOWN_ITERATIONS 3
+#define SIP_TCP_TEST_CLIENTS 50
 
 /**
  * Unittest for server shutdown testing
@@ -31,6 +33,7 @@ class SipServerShutdownTest : public SIPX_UNIT_BASE_CLASS
 {
       CPPUNIT_TEST_SUITE(SipServerShutdownTest);
       CPPUNIT_TEST(testTcpShutdown);
+      CPPUNIT_TEST(testTcpClients);
       CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -66,6 +69,70 @@ public:
 
    };
 
+   // Connect many phones to a TCP server and check that the server keeps
+   // track of them and deletes them once they hang up.
+   void testTcpClients()
+   {
+      SipUserAgent sipUA( PORT_NONE
+                         ,PORT_NONE
+                         ,PORT_NONE
+                         ,NULL     // default publicAddress
+                         ,NULL     // default defaultUser
+                         ,"127.0.0.1"     // default defaultSipAddress
+                         ,NULL     // default sipProxyServers
+                         ,NULL     // default sipDirectoryServers
+                         ,NULL     // default sipRegistryServers
+                         ,NULL     // default authenticationScheme
+                         ,NULL     // default authenicateRealm
+                         ,NULL     // default authenticateDb
+                         ,NULL     // default authorizeUserIds
+                         ,NULL     // default authorizePasswords
+         );
+
+      SipTcpServer server(5090, &sipUA, SIP_TRANSPORT_TCP,
+                          "SipTcpServer-%d", false);
+      server.startListener();
+
+      // The server listens on the address of the host, not on loopback
+      UtlString hostIp;
+      OsSocket::getHostIp(&hostIp);
+
+      OsConnectionSocket* sockets[SIP_TCP_TEST_CLIENTS];
+      int i;
+      for (i = 0; i < SIP_TCP_TEST_CLIENTS; i++)
+      {
+         sockets[i] = new OsConnectionSocket(5090, hostIp);
+         CPPUNIT_ASSERT(sockets[i]->isOk());
+         // A keep-alive only, so nothing gets dispatched to the user agent
+         sockets[i]->write("\r\n\r\n", 4);
+      }
+
+      for (i = 0; i < 50 && server.getClientCount() < SIP_TCP_TEST_CLIENTS; i++)
+      {
+         OsTask::delay(100);
+      }
+      CPPUNIT_ASSERT_EQUAL(SIP_TCP_TEST_CLIENTS, server.getClientCount());
+
+      // Clients are still connected, so none of them are removed
+      server.removeOldClients(0);
+      CPPUNIT_ASSERT_EQUAL(SIP_TCP_TEST_CLIENTS, server.getClientCount());
+
+      for (i = 0; i < SIP_TCP_TEST_CLIENTS; i++)
+      {
+         delete sockets[i];
+      }
+
+      // The server finds out about the closed connections on its own
+      for (i = 0; i < 50 && server.getClientCount() > 0; i++)
+      {
+         OsTask::delay(100);
+         server.removeOldClients(0);
+      }
+      CPPUNIT_ASSERT_EQUAL(0, server.getClientCount());
+
+      server.shutdownListener();
+   };
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SipServerShutdownTest);
@@ -12,6 +12,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <sipxunittests.h>
+#include <sipxunit/TestUtilities.h>
 
 #if !defined(_WIN32) && !defined(WINCE)
 #include <sys/types.h>
@@ -35,6 +36,9 @@
 
 #include "net/SipSrvLookup.h"
 #include "os/OsSocket.h"
+#include "os/OsTask.h"
+#include "os/OsMutex.h"
+#include "os/OsLock.h"
 #include <os/OsSysLog.h>
 
 // Defines
@@ -50,11 +54,260 @@
 // Port for the test named to listen on.
 #define NAMED_PORT 13253
 
+#if !defined(_WIN32) && !defined(WINCE) && !defined(_VXWORKS)
+// The DNS cache is tested against StubDnsServer on this port.
+#  define STUB_DNS_PORT 13254
+#endif
+
 // Forward references.
 
 // Get a printable representation of a protocol value.
 const char* printable_proto(OsSocket::IpProtocolSocketType type);
 
+#ifdef STUB_DNS_PORT /* [ */
+
+// Point the resolver of the calling thread at the stub DNS server.
+static void use_stub_dns_server()
+{
+   res_init();
+   _res.nscount = 1;
+   inet_aton("127.0.0.1", &_res.nsaddr_list[0].sin_addr);
+   _res.nsaddr_list[0].sin_port = htons(STUB_DNS_PORT);
+   _res.retrans = 2;
+   _res.retry = 1;
+}
+
+/**
+ * Minimal DNS server answering on 127.0.0.1:STUB_DNS_PORT:
+ *
+ *    cache.stub.test         A    10.1.2.3      TTL 300
+ *    short.stub.test         A    10.1.2.4      TTL 1
+ *    slow.stub.test          A    10.1.2.5      TTL 300, answered after 500 ms
+ *    _sip._udp.srv.stub.test SRV  0 0 5070 cache.stub.test   TTL 300
+ *
+ * Every other query gets NXDOMAIN.  It counts the queries it receives.
+ */
+class StubDnsServer : public OsTask
+{
+public:
+   StubDnsServer()
+      : OsTask("StubDnsServer")
+      , mSocket(-1)
+      , mQueries(0)
+      , mLock(OsMutex::Q_FIFO)
+   {
+      mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+      struct sockaddr_in address;
+      memset(&address, 0, sizeof(address));
+      address.sin_family = AF_INET;
+      address.sin_port = htons(STUB_DNS_PORT);
+      inet_aton("127.0.0.1", &address.sin_addr);
+      if (bind(mSocket, (struct sockaddr*) &address, sizeof(address)) != 0)
+      {
+         close(mSocket);
+         mSocket = -1;
+      }
+   }
+
+   virtual ~StubDnsServer()
+   {
+      requestShutdown();
+      waitUntilShutDown();
+      if (mSocket >= 0)
+      {
+         close(mSocket);
+      }
+   }
+
+   UtlBoolean isListening() const
+   {
+      return mSocket >= 0;
+   }
+
+   int getQueries()
+   {
+      OsLock lock(mLock);
+      return mQueries;
+   }
+
+   virtual int run(void* pArg)
+   {
+      while (!isShuttingDown() && mSocket >= 0)
+      {
+         fd_set readFds;
+         FD_ZERO(&readFds);
+         FD_SET(mSocket, &readFds);
+         struct timeval timeout = { 0, 100000 };
+         if (select(mSocket + 1, &readFds, NULL, NULL, &timeout) <= 0)
+         {
+            continue;
+         }
+
+         unsigned char query[512];
+         struct sockaddr_in from;
+         socklen_t fromLength = sizeof(from);
+         int length = recvfrom(mSocket, query, sizeof(query), 0,
+                               (struct sockaddr*) &from, &fromLength);
+         if (length > 12)
+         {
+            unsigned char response[512];
+            int responseLength = answer(query, length, response);
+            if (responseLength > 0)
+            {
+               sendto(mSocket, response, responseLength, 0,
+                      (struct sockaddr*) &from, fromLength);
+            }
+         }
+      }
+      return 0;
+   }
+
+private:
+
+   // Build the response to a query, returns its length.
+   int answer(const unsigned char* query, int length, unsigned char* response)
+   {
+      // Read the question name.
+      UtlString name;
+      int i = 12;
+      while (i < length && query[i] != 0)
+      {
+         int labelLength = query[i];
+         if (i + 1 + labelLength >= length)
+         {
+            return 0;
+         }
+         if (!name.isNull())
+         {
+            name.append('.');
+         }
+         name.append((const char*) query + i + 1, labelLength);
+         i += 1 + labelLength;
+      }
+      int questionEnd = i + 5;
+      if (questionEnd > length)
+      {
+         return 0;
+      }
+      int type = (query[i + 1] << 8) | query[i + 2];
+      name.toLower();
+
+      {
+         OsLock lock(mLock);
+         mQueries++;
+      }
+
+      // Header: same id, response, recursion available, one question.
+      memset(response, 0, 12);
+      response[0] = query[0];
+      response[1] = query[1];
+      response[2] = 0x81;
+      response[3] = 0x80;
+      response[5] = 1;
+      memcpy(response + 12, query + 12, questionEnd - 12);
+      int end = questionEnd;
+
+      if (type == T_A && name.compareTo("cache.stub.test") == 0)
+      {
+         end = addA(response, end, 300, 10, 1, 2, 3);
+      }
+      else if (type == T_A && name.compareTo("short.stub.test") == 0)
+      {
+         end = addA(response, end, 1, 10, 1, 2, 4);
+      }
+      else if (type == T_A && name.compareTo("slow.stub.test") == 0)
+      {
+         OsTask::delay(500);
+         end = addA(response, end, 300, 10, 1, 2, 5);
+      }
+      else if (type == T_SRV && name.compareTo("_sip._udp.srv.stub.test") == 0)
+      {
+         static const unsigned char target[] =
+            "\005cache\004stub\004test";
+         // priority 0, weight 0, port 5070
+         unsigned char rdata[6 + sizeof(target)] = { 0, 0, 0, 0, 5070 >> 8, 5070 & 0xff };
+         memcpy(rdata + 6, target, sizeof(target));
+         end = addRecord(response, end, T_SRV, 300, rdata, sizeof(rdata));
+      }
+      else
+      {
+         // NXDOMAIN
+         response[3] = 0x83;
+      }
+      return end;
+   }
+
+   int addA(unsigned char* response, int end, int ttl,
+            unsigned char a, unsigned char b, unsigned char c, unsigned char d)
+   {
+      unsigned char rdata[4] = { a, b, c, d };
+      return addRecord(response, end, T_A, ttl, rdata, sizeof(rdata));
+   }
+
+   // Append an answer RR for the question name.
+   int addRecord(unsigned char* response, int end, int type, int ttl,
+                 const unsigned char* rdata, int rdataLength)
+   {
+      unsigned char* rr = response + end;
+      rr[0] = 0xc0;             // pointer to the question name
+      rr[1] = 12;
+      rr[2] = type >> 8;
+      rr[3] = type & 0xff;
+      rr[4] = 0;
+      rr[5] = C_IN;
+      rr[6] = (ttl >> 24) & 0xff;
+      rr[7] = (ttl >> 16) & 0xff;
+      rr[8] = (ttl >> 8) & 0xff;
+      rr[9] = ttl & 0xff;
+      rr[10] = rdataLength >> 8;
+      rr[11] = rdataLength & 0xff;
+      memcpy(rr + 12, rdata, rdataLength);
+      response[7]++;            // ancount
+      return end + 12 + rdataLength;
+   }
+
+   int mSocket;
+   int mQueries;
+   OsMutex mLock;
+};
+
+// Looks up a name through the stub DNS server on its own thread.
+class StubDnsLookupTask : public OsTask
+{
+public:
+   StubDnsLookupTask(const char* domain)
+      : OsTask("StubDnsLookupTask-%d")
+      , mDomain(domain)
+      , mPort(0)
+   {
+   }
+
+   virtual ~StubDnsLookupTask()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void* pArg)
+   {
+      use_stub_dns_server();
+      server_t* servers = SipSrvLookup::servers(mDomain, "sip", OsSocket::UDP,
+                                                5060, NULL);
+      if (servers[0].isValidServerT())
+      {
+         servers[0].getIpAddressFromServerT(mAddress);
+         mPort = servers[0].getPortFromServerT();
+      }
+      delete[] servers;
+      return 0;
+   }
+
+   UtlString mDomain;
+   UtlString mAddress;   ///< Address of the first server found.
+   int mPort;            ///< Port of the first server found.
+};
+
+#endif /* STUB_DNS_PORT ] */
+
 /**
  * Unit test for SipSrvLookup
  */
@@ -63,11 +316,198 @@ class SipSrvLookupTest : public SIPX_UNIT_BASE_CLASS
    CPPUNIT_TEST_SUITE(SipSrvLookupTest);
 #ifndef WIN32
     CPPUNIT_TEST(lookup);
+#endif
+#ifdef STUB_DNS_PORT
+   CPPUNIT_TEST(cacheHit);
+   CPPUNIT_TEST(cacheSrv);
+   CPPUNIT_TEST(cacheNegative);
+   CPPUNIT_TEST(cacheExpiry);
+   CPPUNIT_TEST(cacheDisabled);
+   CPPUNIT_TEST(cacheCoalesced);
 #endif
    CPPUNIT_TEST_SUITE_END();
 
 public:
 
+#ifdef STUB_DNS_PORT /* [ */
+
+   // Look up a domain with an explicit port, which only queries A records.
+   // Returns the number of servers found and the first one.
+   int lookupA(const char* domain, UtlString& address)
+   {
+      server_t* servers = SipSrvLookup::servers(domain, "sip", OsSocket::UDP,
+                                                5060, NULL);
+      int count = 0;
+      address.remove(0);
+      while (servers[count].isValidServerT())
+      {
+         if (count == 0)
+         {
+            servers[0].getIpAddressFromServerT(address);
+         }
+         count++;
+      }
+      delete[] servers;
+      return count;
+   }
+
+   void cacheHit()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      use_stub_dns_server();
+      SipSrvLookup::clearCache();
+
+      UtlString address;
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("cache.stub.test", address));
+      ASSERT_STR_EQUAL("10.1.2.3", address.data());
+      CPPUNIT_ASSERT_EQUAL(1, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(0, SipSrvLookup::getCacheHits());
+      CPPUNIT_ASSERT_EQUAL(1, SipSrvLookup::getCacheMisses());
+
+      // Names are not case sensitive.
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("Cache.Stub.Test", address));
+      ASSERT_STR_EQUAL("10.1.2.3", address.data());
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("cache.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(1, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(2, SipSrvLookup::getCacheHits());
+      CPPUNIT_ASSERT_EQUAL(1, SipSrvLookup::getCacheMisses());
+
+      SipSrvLookup::clearCache();
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("cache.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(2, server.getQueries());
+   }
+
+   void cacheSrv()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      use_stub_dns_server();
+      SipSrvLookup::clearCache();
+
+      for (int i = 0; i < 2; i++)
+      {
+         server_t* servers = SipSrvLookup::servers("srv.stub.test", "sip",
+                                                   OsSocket::UDP, -1, NULL);
+         CPPUNIT_ASSERT(servers[0].isValidServerT());
+         UtlString address;
+         servers[0].getIpAddressFromServerT(address);
+         ASSERT_STR_EQUAL("10.1.2.3", address.data());
+         CPPUNIT_ASSERT_EQUAL(5070, servers[0].getPortFromServerT());
+         CPPUNIT_ASSERT(!servers[1].isValidServerT());
+         delete[] servers;
+      }
+
+      // The SRV query and the A query for its target, once.
+      CPPUNIT_ASSERT_EQUAL(2, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(2, SipSrvLookup::getCacheHits());
+      CPPUNIT_ASSERT_EQUAL(2, SipSrvLookup::getCacheMisses());
+   }
+
+   void cacheNegative()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      use_stub_dns_server();
+      SipSrvLookup::clearCache();
+
+      UtlString address;
+      CPPUNIT_ASSERT_EQUAL(0, lookupA("missing.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(0, lookupA("missing.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(1, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(1, SipSrvLookup::getCacheHits());
+
+      // Without a negative TTL a failure is asked again.
+      int negativeTtl =
+         SipSrvLookup::getOption(SipSrvLookup::OptionCodeCacheNegativeTTL);
+      SipSrvLookup::setOption(SipSrvLookup::OptionCodeCacheNegativeTTL, 0);
+      SipSrvLookup::clearCache();
+      CPPUNIT_ASSERT_EQUAL(0, lookupA("missing.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(0, lookupA("missing.stub.test", address));
+      SipSrvLookup::setOption(SipSrvLookup::OptionCodeCacheNegativeTTL,
+                              negativeTtl);
+      CPPUNIT_ASSERT_EQUAL(3, server.getQueries());
+   }
+
+   void cacheExpiry()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      use_stub_dns_server();
+      SipSrvLookup::clearCache();
+
+      UtlString address;
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("short.stub.test", address));
+      ASSERT_STR_EQUAL("10.1.2.4", address.data());
+      CPPUNIT_ASSERT_EQUAL(1, server.getQueries());
+
+      // The TTL of 1 second has passed.
+      OsTask::delay(2100);
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("short.stub.test", address));
+      ASSERT_STR_EQUAL("10.1.2.4", address.data());
+      CPPUNIT_ASSERT_EQUAL(2, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(2, SipSrvLookup::getCacheMisses());
+   }
+
+   void cacheDisabled()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      use_stub_dns_server();
+      SipSrvLookup::clearCache();
+
+      int maxTtl = SipSrvLookup::getOption(SipSrvLookup::OptionCodeCacheMaxTTL);
+      SipSrvLookup::setOption(SipSrvLookup::OptionCodeCacheMaxTTL, 0);
+      UtlString address;
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("cache.stub.test", address));
+      CPPUNIT_ASSERT_EQUAL(1, lookupA("cache.stub.test", address));
+      SipSrvLookup::setOption(SipSrvLookup::OptionCodeCacheMaxTTL, maxTtl);
+
+      CPPUNIT_ASSERT_EQUAL(2, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(0, SipSrvLookup::getCacheHits());
+      CPPUNIT_ASSERT_EQUAL(0, SipSrvLookup::getCacheMisses());
+   }
+
+   void cacheCoalesced()
+   {
+      StubDnsServer server;
+      CPPUNIT_ASSERT(server.isListening());
+      server.start();
+      SipSrvLookup::clearCache();
+
+      // All threads ask for the name while the first query is answered
+      // slowly, so only one query reaches the server.
+      const int numTasks = 4;
+      StubDnsLookupTask* tasks[numTasks];
+      int i;
+      for (i = 0; i < numTasks; i++)
+      {
+         tasks[i] = new StubDnsLookupTask("slow.stub.test");
+         tasks[i]->start();
+      }
+      for (i = 0; i < numTasks; i++)
+      {
+         while (!tasks[i]->isShutDown())
+         {
+            OsTask::delay(10);
+         }
+         ASSERT_STR_EQUAL("10.1.2.5", tasks[i]->mAddress.data());
+         CPPUNIT_ASSERT_EQUAL(5060, tasks[i]->mPort);
+         delete tasks[i];
+      }
+      CPPUNIT_ASSERT_EQUAL(1, server.getQueries());
+      CPPUNIT_ASSERT_EQUAL(1, SipSrvLookup::getCacheMisses());
+      CPPUNIT_ASSERT_EQUAL(numTasks - 1, SipSrvLookup::getCacheHits());
+      CPPUNIT_ASSERT_EQUAL(numTasks - 1, SipSrvLookup::getCacheCoalesced());
+   }
+
+#endif /* STUB_DNS_PORT ] */
+
    void lookup()
    {
 #ifdef NAMED_PROGRAM
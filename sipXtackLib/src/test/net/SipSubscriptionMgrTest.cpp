@@ -15,15 +15,111 @@
 #include <sipxunittests.h>
 #include <sipxunit/TestUtilities.h>
 
+#include <stdio.h>
 #include <utl/UtlHashMap.h>
 #include <os/OsDefs.h>
 #include <os/OsDateTime.h>
+#include <os/OsTask.h>
 #include <net/SipDialog.h>
 #include <net/SipMessage.h>
 #include <net/SipDialogMgr.h>
 #include <net/SipSubscriptionMgr.h>
 #include <net/SipSubscribeServerEventHandler.h>
 
+#define NUM_PERF_THREADS 4
+#define NUM_PERF_SUBSCRIPTIONS 2000
+#define NUM_PERF_LIVE_SUBSCRIPTIONS 20000
+
+static const char* sPerfSubscribe = "SUBSCRIBE sip:%s SIP/2.0\r\n\
+From: <sip:watcher@example.com>;tag=%d-%d\r\n\
+To: <sip:%s>\r\n\
+Call-Id: perf-%d-%d\r\n\
+Cseq: 1 SUBSCRIBE\r\n\
+Contact: sip:watcher@10.1.2.3\r\n\
+Event: dialog\r\n\
+Accept: application/dialog-info+xml\r\n\
+Expires: 3600\r\n\
+Via: SIP/2.0/UDP 10.1.2.3;branch=z9hG4bK-%d-%d\r\n\
+Content-Length: 0\r\n\
+\r\n";
+
+// Subscribes, notifies and unsubscribes its own resources and dialogs.
+class SubscriptionPerfTask : public OsTask
+{
+public:
+   SubscriptionPerfTask(SipSubscriptionMgr& subMgr, int taskNum, int count)
+      : OsTask("SubscriptionPerfTask-%d")
+      , mSubMgr(subMgr)
+      , mTaskNum(taskNum)
+      , mCount(count)
+      , mFailures(0)
+   {
+   }
+
+   virtual ~SubscriptionPerfTask()
+   {
+      waitUntilShutDown();
+   }
+
+   virtual int run(void* pArg)
+   {
+      UtlString eventTypeKey("dialog");
+      char resource[60];
+      char buffer[1024];
+
+      for (int i = 0; i < mCount; i++)
+      {
+         sprintf(resource, "%d-%d@example.com", mTaskNum, i);
+         sprintf(buffer, sPerfSubscribe, resource, mTaskNum, i, resource,
+                 mTaskNum, i, mTaskNum, i);
+         SipMessage subscribe(buffer);
+         UtlString resourceId(resource);
+
+         UtlString dialogHandle;
+         UtlBoolean isNew;
+         UtlBoolean isExpired;
+         SipMessage response;
+         if (!mSubMgr.updateDialogInfo(subscribe, resourceId, eventTypeKey,
+                                       NULL, dialogHandle, isNew, isExpired,
+                                       response))
+         {
+            mFailures++;
+            continue;
+         }
+
+         int numNotifies = 0;
+         UtlString** acceptHeaderValues = NULL;
+         SipMessage** notifies = NULL;
+         mSubMgr.createNotifiesDialogInfo(resource, "dialog", numNotifies,
+                                          acceptHeaderValues, notifies);
+         if (numNotifies != 1)
+         {
+            mFailures++;
+         }
+         mSubMgr.freeNotifies(numNotifies, acceptHeaderValues, notifies);
+
+         if (!mSubMgr.endSubscription(dialogHandle))
+         {
+            mFailures++;
+         }
+      }
+      return 0;
+   }
+
+   /// Waits for the task to finish and returns its failures.
+   int waitForFailures()
+   {
+      waitUntilShutDown();
+      return mFailures;
+   }
+
+private:
+   SipSubscriptionMgr& mSubMgr;
+   int mTaskNum;
+   int mCount;
+   int mFailures;
+};
+
 
 /**
  * Unittest for SipSubscriptionMgr
@@ -32,6 +128,8 @@ class SipSubscriptionMgrTest : public SIPX_UNIT_BASE_CLASS
 {
       CPPUNIT_TEST_SUITE(SipSubscriptionMgrTest);
       CPPUNIT_TEST(subscriptionTest);
+      CPPUNIT_TEST(testThroughput);
+      CPPUNIT_TEST(testRemoveOldSubscriptions);
       CPPUNIT_TEST_SUITE_END();
 
       public:
@@ -277,6 +375,95 @@ Voice-Message: 0/0 (0/0)\r\n";
 
       }
 
+   // Subscriptions of different dialogs and resources should not wait
+   // for each other.
+   void testThroughput()
+   {
+      SipSubscriptionMgr subMgr;
+      SubscriptionPerfTask* tasks[NUM_PERF_THREADS];
+      int i;
+
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < NUM_PERF_THREADS; i++)
+      {
+         tasks[i] = new SubscriptionPerfTask(subMgr, i,
+                                             NUM_PERF_SUBSCRIPTIONS);
+         tasks[i]->start();
+      }
+      int failures = 0;
+      for (i = 0; i < NUM_PERF_THREADS; i++)
+      {
+         failures += tasks[i]->waitForFailures();
+         delete tasks[i];
+      }
+      OsTime end;
+      OsDateTime::getCurTime(end);
+
+      CPPUNIT_ASSERT_EQUAL(0, failures);
+      CPPUNIT_ASSERT_EQUAL(0, subMgr.getDialogMgr()->countDialogs());
+
+      OsTime elapsed = end - start;
+      double seconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+      printf("%d threads: %d subscribe/notify/unsubscribe in %.3f s, "
+             "%.0f per second\n",
+             NUM_PERF_THREADS, NUM_PERF_THREADS * NUM_PERF_SUBSCRIPTIONS,
+             seconds,
+             seconds > 0 ? NUM_PERF_THREADS * NUM_PERF_SUBSCRIPTIONS / seconds
+                         : 0.0);
+   }
+
+   // Checking for expired subscriptions should not look at the live ones.
+   void testRemoveOldSubscriptions()
+   {
+      SipSubscriptionMgr subMgr;
+      UtlString eventTypeKey("dialog");
+      char resource[60];
+      char buffer[1024];
+      int i;
+
+      for (i = 0; i < NUM_PERF_LIVE_SUBSCRIPTIONS; i++)
+      {
+         sprintf(resource, "live-%d@example.com", i);
+         sprintf(buffer, sPerfSubscribe, resource, 0, i, resource, 0, i, 0, i);
+         SipMessage subscribe(buffer);
+         UtlString resourceId(resource);
+         UtlString dialogHandle;
+         UtlBoolean isNew;
+         UtlBoolean isExpired;
+         SipMessage response;
+         CPPUNIT_ASSERT(subMgr.updateDialogInfo(subscribe, resourceId,
+                                                eventTypeKey, NULL,
+                                                dialogHandle, isNew,
+                                                isExpired, response));
+      }
+      CPPUNIT_ASSERT_EQUAL(NUM_PERF_LIVE_SUBSCRIPTIONS,
+                           subMgr.getDialogMgr()->countDialogs());
+
+      const int numRuns = 1000;
+      long now = OsDateTime::getSecsSinceEpoch();
+
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < numRuns; i++)
+      {
+         CPPUNIT_ASSERT_EQUAL(0, subMgr.removeOldSubscriptions(now));
+      }
+      OsTime end;
+      OsDateTime::getCurTime(end);
+
+      OsTime elapsed = end - start;
+      printf("removeOldSubscriptions with %d live subscriptions: "
+             "%.3f us per call\n",
+             NUM_PERF_LIVE_SUBSCRIPTIONS,
+             (elapsed.seconds() * 1000000.0 + elapsed.usecs()) / numRuns);
+
+      // All of them expire together
+      CPPUNIT_ASSERT_EQUAL(NUM_PERF_LIVE_SUBSCRIPTIONS,
+                           subMgr.removeOldSubscriptions(now + 3700));
+      CPPUNIT_ASSERT_EQUAL(0, subMgr.getDialogMgr()->countDialogs());
+   }
+
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SipSubscriptionMgrTest);
@@ -0,0 +1,162 @@
+//
+// Copyright (C) 2026 SIPez LLC.  All rights reserved.
+// Licensed to SIPfoundry under a Contributor Agreement.
+//
+// $$
+///////////////////////////////////////////////////////////////////////////////
+
+#include <sipxunittests.h>
+
+#include <os/OsDefs.h>
+#include <os/OsDateTime.h>
+#include <net/SipMessage.h>
+#include <net/SipTransaction.h>
+#include <net/SipTransactionList.h>
+
+#define NUM_TEST_TRANSACTIONS 10
+#define NUM_PERF_TRANSACTIONS 20000
+
+/**
+ * Unittest for SipTransactionList
+ */
+class SipTransactionListTest : public SIPX_UNIT_BASE_CLASS
+{
+      CPPUNIT_TEST_SUITE(SipTransactionListTest);
+      CPPUNIT_TEST(testFindTransaction);
+      CPPUNIT_TEST(testRemoveOldTransactions);
+      CPPUNIT_TEST(testRemoveOldTransactionsPerformance);
+      CPPUNIT_TEST_SUITE_END();
+
+public:
+
+   // Build an incoming request and the server transaction for it.
+   SipTransaction* newTransaction(const char* method, int callNum,
+                                  SipMessage& request)
+   {
+      char callId[40];
+      sprintf(callId, "%d-transaction-list-test", callNum);
+
+      request.setRequestData(method, "sip:1@127.0.0.1",
+                             "<sip:2@127.0.0.2>;tag=ft", "<sip:1@127.0.0.1>",
+                             callId, 1);
+      request.addVia("127.0.0.2", 5060, "UDP", "z9hG4bK-test");
+
+      return new SipTransaction(&request, FALSE /* incoming */);
+   }
+
+   long getNow()
+   {
+      OsTime time;
+      OsDateTime::getCurTimeSinceBoot(time);
+      return time.seconds();
+   }
+
+   void testFindTransaction()
+   {
+      SipTransactionList list;
+      SipMessage requests[NUM_TEST_TRANSACTIONS];
+      SipTransaction* transactions[NUM_TEST_TRANSACTIONS];
+      int i;
+
+      for (i = 0; i < NUM_TEST_TRANSACTIONS; i++)
+      {
+         transactions[i] = newTransaction(SIP_INVITE_METHOD, i, requests[i]);
+         list.addTransaction(transactions[i]);
+      }
+      CPPUNIT_ASSERT_EQUAL(NUM_TEST_TRANSACTIONS, list.getTransactionCount());
+
+      for (i = 0; i < NUM_TEST_TRANSACTIONS; i++)
+      {
+         // A transaction which has not sent its request is only found by
+         // messages which point to it.
+         requests[i].setTransaction(transactions[i]);
+
+         SipTransaction::messageRelationship relationship;
+         SipTransaction* found =
+            list.findTransactionFor(requests[i], FALSE, relationship);
+         CPPUNIT_ASSERT(found == transactions[i]);
+         CPPUNIT_ASSERT(found->isBusy());
+
+         list.markAvailable(*found);
+         CPPUNIT_ASSERT(!found->isBusy());
+         CPPUNIT_ASSERT(list.transactionExists(found, *found));
+      }
+   }
+
+   void testRemoveOldTransactions()
+   {
+      SipTransactionList list;
+      SipMessage invites[NUM_TEST_TRANSACTIONS];
+      SipMessage options[NUM_TEST_TRANSACTIONS];
+      SipTransaction* busyTransaction = NULL;
+      int i;
+
+      for (i = 0; i < NUM_TEST_TRANSACTIONS; i++)
+      {
+         list.addTransaction(newTransaction(SIP_INVITE_METHOD, i, invites[i]));
+
+         SipTransaction* transaction =
+            newTransaction(SIP_OPTIONS_METHOD, NUM_TEST_TRANSACTIONS + i,
+                           options[i]);
+         list.addTransaction(transaction);
+         busyTransaction = transaction;
+      }
+      CPPUNIT_ASSERT_EQUAL(2 * NUM_TEST_TRANSACTIONS, list.getTransactionCount());
+
+      long now = getNow();
+
+      // Nothing is old yet
+      list.removeOldTransactions(now - 10, now - 10);
+      CPPUNIT_ASSERT_EQUAL(2 * NUM_TEST_TRANSACTIONS, list.getTransactionCount());
+
+      // A busy transaction is never removed
+      CPPUNIT_ASSERT(list.waitUntilAvailable(busyTransaction, *busyTransaction));
+
+      // Only the other transactions expire, the INVITEs are kept longer
+      list.removeOldTransactions(now + 10, now - 10);
+      CPPUNIT_ASSERT_EQUAL(NUM_TEST_TRANSACTIONS + 1, list.getTransactionCount());
+
+      // Once it is available again it expires with the same times
+      list.markAvailable(*busyTransaction);
+      list.removeOldTransactions(now + 10, now - 10);
+      CPPUNIT_ASSERT_EQUAL(NUM_TEST_TRANSACTIONS, list.getTransactionCount());
+
+      list.removeOldTransactions(now + 10, now + 10);
+      CPPUNIT_ASSERT_EQUAL(0, list.getTransactionCount());
+   }
+
+   // Garbage collection should only cost time for the transactions which
+   // may have expired, not for every transaction in the list.
+   void testRemoveOldTransactionsPerformance()
+   {
+      SipTransactionList list;
+      int i;
+
+      for (i = 0; i < NUM_PERF_TRANSACTIONS; i++)
+      {
+         SipMessage request;
+         list.addTransaction(newTransaction(SIP_INVITE_METHOD, i, request));
+      }
+
+      long now = getNow();
+      const int numRuns = 1000;
+
+      OsTime start;
+      OsDateTime::getCurTime(start);
+      for (i = 0; i < numRuns; i++)
+      {
+         list.removeOldTransactions(now - 60, now - 180);
+      }
+      OsTime end;
+      OsDateTime::getCurTime(end);
+
+      CPPUNIT_ASSERT_EQUAL(NUM_PERF_TRANSACTIONS, list.getTransactionCount());
+
+      OsTime elapsed = end - start;
+      printf("removeOldTransactions with %d live transactions: %ld us per run\n",
+             NUM_PERF_TRANSACTIONS,
+             (elapsed.seconds() * 1000000 + elapsed.usecs()) / numRuns);
+   }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SipTransactionListTest);
@@ -19,6 +19,7 @@
 #include <net/NetMd5Codec.h>
 #include <utl/UtlTokenizer.h>
 
+#include "os/OsDateTime.h"
 #include "os/OsTimeLog.h"
 
 #define MISSING_PARAM  "---missing---"
@@ -114,6 +115,8 @@ class UrlTest : public SIPX_UNIT_BASE_CLASS
     CPPUNIT_TEST(testBigUriUser);
     CPPUNIT_TEST(testBigUriNoSchemeUser);
     CPPUNIT_TEST(testBigUriHost);
+    CPPUNIT_TEST(testScannerMatchesRegEx);
+    CPPUNIT_TEST(testParsePerformance);
     CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -1772,9 +1775,120 @@ public:
          printf("Finish testBigUriHost\n");
       }
 
+   void testScannerMatchesRegEx()
+      {
+         // the scanner must produce the same components as the regular expressions
+         const char* urls[] =
+         {
+            "sip:user@example.com",
+            "Display Name <sip:user:pw@example.com:5060;transport=tcp?a=b&c=d>;tag=1;q=0.5",
+            "\"Quoted \\\"Name\\\"\" <sips:user@[::1]:5061>",
+            "\"a\"b\"\" <sip:x@y>;tag=\"<z>\"",
+            "sip:%61lice;x=y@example.com.;lr?h=v",
+            "  SIP : user@1.2.3.4:1234567 ; maddr=1.2.3.5",
+            "sips:333",
+            "example.com:5060;transport=udp",
+            "user@host-.example.-com",
+            "http://www.example.com:8080/path/file.html?q=1",
+            "https://user:pw@www.example.com/a;b?c>;d",
+            "file:///usr/share/file.wav",
+            "mailto:user@example.com?subject=hi",
+            "rtsp://media.example.com/stream",
+            "<sip:user@example.com>;tag=abc\n",
+            "<sip:user@example.com>;tag=abc\nx",
+            "tel:+1-212-555-0101",
+            "Name \"quoted\" <sip:@example.com>",
+            "<>",
+            ""
+         };
+
+         for (size_t i = 0; i < sizeof(urls)/sizeof(urls[0]); i++)
+         {
+            for (int isAddrSpec = 0; isAddrSpec < 2; isAddrSpec++)
+            {
+               Url scanned;
+               scanned.scanString(urls[i], isAddrSpec);
+               Url matched;
+               matched.parseStringRegEx(urls[i], isAddrSpec);
+
+               char msg[256];
+               sprintf(msg, "'%s' isAddrSpec = %d", urls[i], isAddrSpec);
+               CPPUNIT_ASSERT_EQUAL_MESSAGE(msg, matched.mScheme, scanned.mScheme);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mDisplayName, scanned.mDisplayName);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mUserId, scanned.mUserId);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mPassword, scanned.mPassword);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mHostAddress, scanned.mHostAddress);
+               CPPUNIT_ASSERT_EQUAL_MESSAGE(msg, matched.mHostPort, scanned.mHostPort);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mPath, scanned.mPath);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mRawUrlParameters,
+                                        scanned.mRawUrlParameters);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mRawHeaderOrQueryParameters,
+                                        scanned.mRawHeaderOrQueryParameters);
+               ASSERT_STR_EQUAL_MESSAGE(msg, matched.mRawFieldParameters,
+                                        scanned.mRawFieldParameters);
+            }
+         }
+      }
+
+   void testParsePerformance()
+      {
+         // From, To, Contact and Request-URI values as seen in REGISTER and SUBSCRIBE
+         const char* urls[] =
+         {
+            "\"Alice\" <sip:alice@atlanta.example.com>;tag=1928301774",
+            "Bob <sip:bob@biloxi.example.com>",
+            "<sip:alice@pc33.atlanta.example.com:5060;transport=tcp>;expires=3600;q=0.8",
+            "sip:registrar.biloxi.example.com"
+         };
+         const int numUrls = sizeof(urls)/sizeof(urls[0]);
+         const int numIterations = 20000;
+
+         double regExRate = parseUrls(urls, numUrls, numIterations, TRUE);
+         double scannerRate = parseUrls(urls, numUrls, numIterations, FALSE);
+
+         printf("UrlTest::testParsePerformance "
+                "RegEx %.0f URIs/sec, scanner %.0f URIs/sec\n",
+                regExRate, scannerRate);
+      }
+
     /////////////////////////
     // Helper Methods
 
+    double parseUrls(const char* urls[], int numUrls, int numIterations,
+                     UtlBoolean useRegEx)
+    {
+        int found = 0;
+
+        OsTime start;
+        OsTime elapsed;
+        OsDateTime::getCurTime(start);
+        for (int i = 0; i < numIterations; i++)
+        {
+            for (int j = 0; j < numUrls; j++)
+            {
+                Url url;
+                if (useRegEx)
+                {
+                    url.parseStringRegEx(urls[j], j == numUrls - 1);
+                }
+                else
+                {
+                    url.scanString(urls[j], j == numUrls - 1);
+                }
+                if (url.getScheme() == Url::SipUrlScheme)
+                {
+                    found++;
+                }
+            }
+        }
+        OsDateTime::getCurTime(elapsed);
+        elapsed -= start;
+
+        CPPUNIT_ASSERT_EQUAL(numUrls * numIterations, found);
+        double seconds = elapsed.seconds() + elapsed.usecs() / 1000000.0;
+        return seconds > 0 ? numUrls * numIterations / seconds : 0;
+    }
+
     const char *getParam(const char *szName, Url &url)
     {
         UtlString name(szName);        